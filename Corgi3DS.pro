@@ -10,12 +10,20 @@ QMAKE_CFLAGS_RELEASE -= -O1
 QMAKE_CFLAGS_RELEASE *= -O2
 QMAKE_CFLAGS_RELEASE -= -O3
 
+#Compiles out the debug and trace logging, see src/core/common/log.hpp
+CONFIG(release, debug|release): DEFINES += NDEBUG
+
 SOURCES += src/qt/main.cpp \
     src/core/emulator.cpp \
     src/core/cpu/arm.cpp \
     src/core/cpu/arm_interpret.cpp \
     src/core/cpu/arm_disasm.cpp \
+    src/core/cpu/arm_cached_interpret.cpp \
+    src/core/cpu/arm_code_cache.cpp \
+    src/core/cpu/arm_jit.cpp \
+    src/core/cpu/arm_thread_pool.cpp \
     src/core/cpu/cp15.cpp \
+    src/core/cpu/fastmem.cpp \
     src/core/cpu/thumb_disasm.cpp \
     src/core/cpu/thumb_interpret.cpp \
     src/core/arm9/rsa.cpp \
@@ -24,6 +32,8 @@ SOURCES += src/qt/main.cpp \
     src/core/pxi.cpp \
     src/core/arm11/mpcore_pmr.cpp \
     src/core/arm11/gpu.cpp \
+    src/core/arm11/gpu_thread_pool.cpp \
+    src/core/arm11/shader_jit.cpp \
     src/core/arm9/aes.cpp \
     src/core/arm9/sha.cpp \
     src/core/common/bswp.cpp \
@@ -33,12 +43,16 @@ SOURCES += src/qt/main.cpp \
     src/core/arm9/interrupt9.cpp \
     src/qt/emuwindow.cpp \
     src/core/i2c.cpp \
+    src/core/io_table.cpp \
     src/core/common/exceptions.cpp \
+    src/core/common/log.cpp \
     src/core/cpu/mmu.cpp \
+    src/core/cpu/page_map.cpp \
     src/core/scheduler.cpp \
     src/core/cpu/vfp.cpp \
     src/core/cpu/vfp_disasm.cpp \
     src/core/cpu/vfp_interpreter.cpp \
+    src/core/cpu/x64_emitter.cpp \
     src/core/sha_engine.cpp \
     src/core/arm11/hash.cpp \
     src/core/p9_hle.cpp \
@@ -58,16 +72,24 @@ SOURCES += src/qt/main.cpp \
 HEADERS += \
     src/core/emulator.hpp \
     src/core/cpu/arm.hpp \
+    src/core/cpu/arm_decode.hpp \
     src/core/cpu/arm_disasm.hpp \
     src/core/cpu/arm_interpret.hpp \
+    src/core/cpu/arm_cached_interpret.hpp \
+    src/core/cpu/arm_code_cache.hpp \
+    src/core/cpu/arm_jit.hpp \
+    src/core/cpu/arm_thread_pool.hpp \
     src/core/common/rotr.hpp \
     src/core/cpu/cp15.hpp \
+    src/core/cpu/fastmem.hpp \
     src/core/arm9/rsa.hpp \
     src/core/timers.hpp \
     src/core/arm9/dma9.hpp \
     src/core/pxi.hpp \
     src/core/arm11/mpcore_pmr.hpp \
     src/core/arm11/gpu.hpp \
+    src/core/arm11/gpu_thread_pool.hpp \
+    src/core/arm11/shader_jit.hpp \
     src/core/arm9/aes.hpp \
     src/core/arm9/sha.hpp \
     src/core/common/bswp.hpp \
@@ -77,11 +99,15 @@ HEADERS += \
     src/core/arm9/interrupt9.hpp \
     src/qt/emuwindow.hpp \
     src/core/i2c.hpp \
+    src/core/io_table.hpp \
     src/core/common/common.hpp \
     src/core/common/exceptions.hpp \
+    src/core/common/log.hpp \
     src/core/cpu/mmu.hpp \
+    src/core/cpu/page_map.hpp \
     src/core/scheduler.hpp \
     src/core/cpu/vfp.hpp \
+    src/core/cpu/x64_emitter.hpp \
     src/core/sha_engine.hpp \
     src/core/arm11/hash.hpp \
     src/core/p9_hle.hpp \
@@ -90,6 +116,8 @@ HEADERS += \
     src/core/arm11/dsp_interpreter.hpp \
     src/core/arm11/dsp_reg.hpp \
     src/core/arm11/gpu_floats.hpp \
+    src/core/arm11/gpu_raster.hpp \
+    src/core/arm11/gpu_simd.hpp \
     src/core/arm11/vector_math.hpp \
     src/core/arm11/signextend.hpp \
     src/core/corelink_dma.hpp \
@@ -104,4 +132,4 @@ HEADERS += \
 
 INCLUDEPATH += /usr/local/include
 
-LIBS += -L/usr/local/lib -lgmpxx -lgmp
+LIBS += -L/usr/local/lib -lgmpxx -lgmp -lpthread
@@ -208,7 +208,7 @@ uint16_t DSP::read16(uint32_t addr)
                 default:
                     EmuException::die("[DSP_CPU] Unrecognized READ_FIFO memtype %d", dma.mem_type);
             }
-            printf("[DSP_CPU] READ FIFO: $%04X ($%08X)\n", reg, dma.arm_addr);
+            LOG(LOG_DSP, LOG_TRACE, "[DSP_CPU] READ FIFO: $%04X ($%08X)\n", reg, dma.arm_addr);
             if (dma.cur_fifo_len != 0xFF)
             {
                 dma.cur_fifo_len--;
@@ -247,15 +247,15 @@ uint16_t DSP::read16(uint32_t addr)
             reg = apbp.cpu_sema_recv;
             break;
         case 0x10203024:
-            printf("[DSP_CPU] Read REPLY0: $%04X\n", apbp.reply[0]);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Read REPLY0: $%04X\n", apbp.reply[0]);
             apbp.reply_ready[0] = false;
             return apbp.reply[0];
         case 0x1020302C:
-            printf("[DSP_CPU] Read REPLY1: $%04X\n", apbp.reply[1]);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Read REPLY1: $%04X\n", apbp.reply[1]);
             apbp.reply_ready[1] = false;
             return apbp.reply[1];
         case 0x10203034:
-            printf("[DSP_CPU] Read REPLY2: $%04X\n", apbp.reply[2]);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Read REPLY2: $%04X\n", apbp.reply[2]);
             apbp.reply_ready[2] = false;
             return apbp.reply[2];
         default:
@@ -287,7 +287,7 @@ void DSP::write16(uint32_t addr, uint16_t value)
                 default:
                     EmuException::die("[DSP_CPU] Unrecognized READ_FIFO memtype %d", dma.mem_type);
             }
-            printf("[DSP_CPU] WRITE FIFO: $%04X ($%08X)\n", value, dma.arm_addr);
+            LOG(LOG_DSP, LOG_TRACE, "[DSP_CPU] WRITE FIFO: $%04X ($%08X)\n", value, dma.arm_addr);
             if (dma.cur_fifo_len != 0xFF)
             {
                 dma.cur_fifo_len--;
@@ -298,12 +298,12 @@ void DSP::write16(uint32_t addr, uint16_t value)
                 dma.arm_addr++;
             break;
         case 0x10203004:
-            printf("[DSP_CPU] Write16 PADR: $%04X\n", value);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Write16 PADR: $%04X\n", value);
             dma.arm_addr &= ~0xFFFF;
             dma.arm_addr |= value;
             break;
         case 0x10203008:
-            printf("[DSP_CPU] Write16 PCFG: $%04X\n", value);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Write16 PCFG: $%04X\n", value);
         {
             bool old_start = dma.fifo_started;
             if (!(value & 0x1) && reset_signal)
@@ -346,7 +346,7 @@ void DSP::write16(uint32_t addr, uint16_t value)
         }
             break;
         case 0x10203010:
-            printf("[DSP_CPU] Write16 sema set: $%04X\n", value);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Write16 sema set: $%04X\n", value);
         {
             uint16_t mask = apbp.dsp_sema_mask;
             uint16_t old_sema = apbp.dsp_sema_recv;
@@ -356,15 +356,15 @@ void DSP::write16(uint32_t addr, uint16_t value)
         }
             break;
         case 0x10203014:
-            printf("[DSP_CPU] Write16 sema mask: $%04X\n", value);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Write16 sema mask: $%04X\n", value);
             apbp.cpu_sema_mask = value;
             break;
         case 0x10203018:
-            printf("[DSP_CPU] Write16 sema clear: $%04X\n", value);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Write16 sema clear: $%04X\n", value);
             apbp.cpu_sema_recv &= ~value;
             break;
         case 0x10203030:
-            printf("[DSP_CPU] Write16 CMD2: $%04X\n", value);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP_CPU] Write16 CMD2: $%04X\n", value);
             apbp_send_cmd(2, value);
             break;
         default:
@@ -472,7 +472,7 @@ uint16_t DSP::read_data_word(uint16_t addr)
                 reg |= ((apbp.dsp_sema_recv & ~apbp.dsp_sema_mask) != 0) << 9;
                 reg |= apbp.cmd_ready[1] << 12;
                 reg |= apbp.cmd_ready[2] << 13;
-                printf("[DSP] Read STS: $%04X\n", reg);
+                LOG(LOG_DSP, LOG_TRACE, "[DSP] Read STS: $%04X\n", reg);
                 return reg;
             }
             case 0x0E0:
@@ -609,13 +609,13 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
             switch (reg)
             {
                 case 0:
-                    printf("[DSP_ICU] Write VINT_HI%d: $%04X\n", id, value);
+                    LOG(LOG_DSP, LOG_DEBUG, "[DSP_ICU] Write VINT_HI%d: $%04X\n", id, value);
                     icu.vector_ctx_switch[id] = (value >> 15) & 0x1;
                     icu.vector_addr[id] &= 0xFFFF;
                     icu.vector_addr[id] |= (value & 0x3) << 16;
                     break;
                 case 2:
-                    printf("[DSP_ICU] Write VINT_LO%d: $%04X\n", id, value);
+                    LOG(LOG_DSP, LOG_DEBUG, "[DSP_ICU] Write VINT_LO%d: $%04X\n", id, value);
                     icu.vector_addr[id] &= ~0xFFFF;
                     icu.vector_addr[id] |= value;
                     break;
@@ -628,7 +628,7 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
             case 0x030:
             {
                 int index = (addr - 0x20) / 0x10;
-                printf("[DSP_TIMER%d] Write CTRL: $%04X\n", index, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_TIMER%d] Write CTRL: $%04X\n", index, value);
 
                 timers[index].prescalar = value & 0x3;
                 timers[index].countup_mode = (value >> 2) & 0x7;
@@ -641,27 +641,27 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
             }
                 break;
             case 0x024:
-                printf("[DSP_TIMER0] Write RESTART_L: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_TIMER0] Write RESTART_L: $%04X\n", value);
                 timers[0].restart_value &= ~0xFFFF;
                 timers[0].restart_value |= value;
                 break;
             case 0x026:
-                printf("[DSP_TIMER0] Write RESTART_H: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_TIMER0] Write RESTART_H: $%04X\n", value);
                 timers[0].restart_value &= 0xFFFF;
                 timers[0].restart_value |= value << 16;
                 break;
             case 0x034:
-                printf("[DSP_TIMER1] Write RESTART_L: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_TIMER1] Write RESTART_L: $%04X\n", value);
                 timers[1].restart_value &= ~0xFFFF;
                 timers[1].restart_value |= value;
                 break;
             case 0x036:
-                printf("[DSP_TIMER1] Write RESTART_H: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_TIMER1] Write RESTART_H: $%04X\n", value);
                 timers[1].restart_value &= 0xFFFF;
                 timers[1].restart_value |= value << 16;
                 break;
             case 0x0C0:
-                printf("[DSP_APBP] Write REPLY0: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_APBP] Write REPLY0: $%04X\n", value);
                 apbp.reply[0] = value;
                 apbp.reply_ready[0] = true;
 
@@ -669,7 +669,7 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
                     send_arm_interrupt();
                 break;
             case 0x0C4:
-                printf("[DSP_APBP] Write REPLY1: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_APBP] Write REPLY1: $%04X\n", value);
 
                 apbp.reply[1] = value;
                 apbp.reply_ready[1] = true;
@@ -678,7 +678,7 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
                     send_arm_interrupt();
                 break;
             case 0x0C8:
-                printf("[DSP_APBP] Write REPLY2: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_APBP] Write REPLY2: $%04X\n", value);
                 apbp.reply[2] = value;
                 apbp.reply_ready[2] = true;
 
@@ -686,7 +686,7 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
                     send_arm_interrupt();
                 break;
             case 0x0CC:
-                printf("[DSP_APBP] Write CPU_SEMA_RECV: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_APBP] Write CPU_SEMA_RECV: $%04X\n", value);
             {
                 uint16_t old_sema = apbp.cpu_sema_recv;
                 uint16_t mask = ~apbp.cpu_sema_mask;
@@ -698,7 +698,7 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
             }
                 break;
             case 0x0D0:
-                printf("[DSP_APBP] Write DSP_SEMA_ACK: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_APBP] Write DSP_SEMA_ACK: $%04X\n", value);
                 apbp.dsp_sema_recv &= ~value;
                 break;
             case 0x10E:
@@ -712,7 +712,7 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
                     EmuException::die("[DSP] MIU YPAGE is greater than 1 ($%02X)", miu.ypage);
                 break;
             case 0x114:
-                printf("[DSP_MIU] Write X/YPAGE0CFG: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_MIU] Write X/YPAGE0CFG: $%04X\n", value);
                 miu.x_size[0] = value & 0x3F;
                 miu.y_size[0] = (value >> 8) & 0x7F;
                 break;
@@ -724,84 +724,84 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
                 miu.mmio_base = value & ~0x1FF;
                 break;
             case 0x184:
-                printf("[DSP_DMA] Write chan enable: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write chan enable: $%04X\n", value);
                 dma.chan_enable = value & 0xFF;
                 break;
             case 0x1BE:
-                printf("[DSP_DMA] Write chan: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write chan: $%04X\n", value);
                 dma.channel = value & 0x7;
                 break;
             case 0x1C0:
-                printf("[DSP_DMA] Write SRC_ADDR_LOW_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write SRC_ADDR_LOW_%d: $%04X\n", dma.channel, value);
                 dma.src_addr[dma.channel] &= ~0xFFFF;
                 dma.src_addr[dma.channel] |= value;
                 break;
             case 0x1C2:
-                printf("[DSP_DMA] Write SRC_ADDR_HIGH_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write SRC_ADDR_HIGH_%d: $%04X\n", dma.channel, value);
                 dma.src_addr[dma.channel] &= 0xFFFF;
                 dma.src_addr[dma.channel] |= value << 16;
                 break;
             case 0x1C4:
-                printf("[DSP_DMA] Write DST_ADDR_LOW_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write DST_ADDR_LOW_%d: $%04X\n", dma.channel, value);
                 dma.dest_addr[dma.channel] &= ~0xFFFF;
                 dma.dest_addr[dma.channel] |= value;
                 break;
             case 0x1C6:
-                printf("[DSP_DMA] Write DST_ADDR_HIGH_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write DST_ADDR_HIGH_%d: $%04X\n", dma.channel, value);
                 dma.dest_addr[dma.channel] &= 0xFFFF;
                 dma.dest_addr[dma.channel] |= value << 16;
                 break;
             case 0x1C8:
-                printf("[DSP_DMA] Write SIZE0_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write SIZE0_%d: $%04X\n", dma.channel, value);
                 dma.size[0][dma.channel] = value;
                 break;
             case 0x1CA:
-                printf("[DSP_DMA] Write SIZE1_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write SIZE1_%d: $%04X\n", dma.channel, value);
                 dma.size[1][dma.channel] = value;
                 break;
             case 0x1CC:
-                printf("[DSP_DMA] Write SIZE2_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write SIZE2_%d: $%04X\n", dma.channel, value);
                 dma.size[2][dma.channel] = value;
                 break;
             case 0x1CE:
-                printf("[DSP_DMA] Write SRC_STEP0_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write SRC_STEP0_%d: $%04X\n", dma.channel, value);
                 dma.src_step[0][dma.channel] = value;
                 break;
             case 0x1D0:
-                printf("[DSP_DMA] Write DST_STEP0_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write DST_STEP0_%d: $%04X\n", dma.channel, value);
                 dma.dest_step[0][dma.channel] = value;
                 break;
             case 0x1D2:
-                printf("[DSP_DMA] Write SRC_STEP1_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write SRC_STEP1_%d: $%04X\n", dma.channel, value);
                 dma.src_step[1][dma.channel] = value;
                 break;
             case 0x1D4:
-                printf("[DSP_DMA] Write DST_STEP1_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write DST_STEP1_%d: $%04X\n", dma.channel, value);
                 dma.dest_step[1][dma.channel] = value;
                 break;
             case 0x1D6:
-                printf("[DSP_DMA] Write SRC_STEP2_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write SRC_STEP2_%d: $%04X\n", dma.channel, value);
                 dma.src_step[2][dma.channel] = value;
                 break;
             case 0x1D8:
-                printf("[DSP_DMA] Write DST_STEP2_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write DST_STEP2_%d: $%04X\n", dma.channel, value);
                 dma.dest_step[2][dma.channel] = value;
                 break;
             case 0x1DA:
-                printf("[DSP_DMA] Write 0x1DA_%d: $%04X\n", dma.channel, value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write 0x1DA_%d: $%04X\n", dma.channel, value);
                 dma.src_space[dma.channel] = value & 0xF;
                 dma.dest_space[dma.channel] = (value >> 4) & 0xF;
                 break;
             case 0x1DC:
-                printf("[DSP_DMA] Write 0x1DC: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write 0x1DC: $%04X\n", value);
                 break;
             case 0x1DE:
-                printf("[DSP_DMA] Write 0x1DE: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_DMA] Write 0x1DE: $%04X\n", value);
                 if (value == 0x40C0)
                     do_dma_transfer();
                 break;
             case 0x202:
-                printf("[DSP_ICU] Write int acknowledge: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_ICU] Write int acknowledge: $%04X\n", value);
                 icu.int_pending &= ~value;
 
                 //Disable int pending signals on STT2
@@ -821,7 +821,7 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
                 }
                 break;
             case 0x204:
-                printf("[DSP_ICU] Write SWI: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_ICU] Write SWI: $%04X\n", value);
                 for (int i = 0; i < 16; i++)
                 {
                     if (value & (1 << i))
@@ -829,19 +829,19 @@ void DSP::write_data_word(uint16_t addr, uint16_t value)
                 }
                 break;
             case 0x206:
-                printf("[DSP_ICU] Write int0 connection: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_ICU] Write int0 connection: $%04X\n", value);
                 icu.int_connection[0] = value;
                 break;
             case 0x208:
-                printf("[DSP_ICU] Write int1 connection: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_ICU] Write int1 connection: $%04X\n", value);
                 icu.int_connection[1] = value;
                 break;
             case 0x20A:
-                printf("[DSP_ICU] Write int2 connection: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_ICU] Write int2 connection: $%04X\n", value);
                 icu.int_connection[2] = value;
                 break;
             case 0x20C:
-                printf("[DSP_ICU] Write vint connection: $%04X\n", value);
+                LOG(LOG_DSP, LOG_DEBUG, "[DSP_ICU] Write vint connection: $%04X\n", value);
                 icu.vectored_int_connection = value;
                 break;
             case 0x20E:
@@ -1321,7 +1321,7 @@ void DSP::set_reg16(DSP_REG reg, uint16_t value)
             a1 |= ((value >> 12) & 0xFULL) << 32ULL;
             break;
         case DSP_REG_ST2:
-            printf("[DSP] Write16 ST2: $%04X\n", value);
+            LOG(LOG_DSP, LOG_DEBUG, "[DSP] Write16 ST2: $%04X\n", value);
             st2.s = (value >> 7) & 0x1;
             break;
         case DSP_REG_STT0:
@@ -2315,7 +2315,7 @@ void DSP::set_arp(int index, uint16_t value)
 
 void DSP::assert_dsp_irq(int id)
 {
-    printf("[DSP] Assert IRQ: $%02X\n", id);
+    LOG(LOG_DSP, LOG_DEBUG, "[DSP] Assert IRQ: $%02X\n", id);
     icu.int_pending |= 1 << id;
 }
 
@@ -2355,7 +2355,7 @@ void DSP::int_check()
 
 void DSP::do_irq(uint32_t addr, uint8_t type)
 {
-    printf("[DSP] Processing IRQ: $%08X\n", addr);
+    LOG(LOG_DSP, LOG_DEBUG, "[DSP] Processing IRQ: $%08X\n", addr);
     mod3.master_int_enable = false;
     unhalt();
     push_pc();
@@ -2407,7 +2407,7 @@ void DSP::apbp_send_cmd(int index, uint16_t value)
 
 void DSP::do_dma_transfer()
 {
-    printf("[DSP] Start DMA transfer!\n");
+    LOG(LOG_DSP, LOG_DEBUG, "[DSP] Start DMA transfer!\n");
     //TODO: properly implement. No good way of testing right now, so we just fake the transfer this way.
     assert_dsp_irq(0xF);
 }
@@ -268,6 +268,7 @@ class DSP
         void run(int cycles);
         void halt();
         void unhalt();
+        bool is_idle();
 
         uint16_t read16(uint32_t addr);
         void write16(uint32_t addr, uint16_t value);
@@ -381,6 +382,12 @@ class DSP
         void set_master_int_enable(bool ie);
 };
 
+inline bool DSP::is_idle()
+{
+    //Timers and BTDMP still count while the core is halted
+    return !running || (halted && !timers[0].enabled && !timers[1].enabled && !btdmp.transmit_enabled);
+}
+
 inline uint32_t DSP::get_pc()
 {
     return pc;
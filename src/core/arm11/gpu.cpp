@@ -58,6 +58,147 @@ constexpr uint32_t Convert8To6(uint32_t value) {
     return value >> 2;
 }
 
+//Bytes per pixel of each color and depth buffer format. Zero marks formats the hardware doesn't have.
+static const uint32_t color_format_sizes[8] = {4, 3, 2, 2, 2, 0, 0, 0};
+static const uint32_t depth_format_sizes[4] = {2, 0, 3, 4};
+
+//Bits per texel. Unknown formats are given the most, and fail once they're sampled.
+static const uint32_t tex_format_bits[16] = {32, 24, 16, 16, 16, 16, 16, 8, 8, 8, 4, 4, 4, 8, 32, 32};
+
+//FNV-1a over 64-bit words, with any bytes left over at the end folded in one at a time
+static uint64_t hash_texture(const uint8_t* data, uint32_t size)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint32_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ULL;
+    }
+    for (; i < size; i++)
+        hash = (hash ^ data[i]) * 0x100000001B3ULL;
+    return hash;
+}
+
+//Framebuffer accesses straight to host memory. Colors are unpacked to RGBA8 with red in the low byte.
+static inline uint32_t load_color(uint8_t* ptr, uint8_t format)
+{
+    switch (format)
+    {
+        case 0:
+            return bswp32(*(uint32_t*)ptr);
+        case 1:
+            return ptr[2] | (ptr[1] << 8) | (ptr[0] << 16) | 0xFF000000;
+        case 2:
+        {
+            uint16_t temp = *(uint16_t*)ptr;
+            return Convert5To8(temp >> 11) | (Convert5To8((temp >> 6) & 0x1F) << 8) |
+                   (Convert5To8((temp >> 1) & 0x1F) << 16) | (Convert1To8(temp & 0x1) << 24);
+        }
+        case 3:
+        {
+            uint16_t temp = *(uint16_t*)ptr;
+            return Convert5To8(temp >> 11) | (Convert6To8((temp >> 5) & 0x3F) << 8) |
+                   (Convert5To8(temp & 0x1F) << 16) | 0xFF000000;
+        }
+        case 4:
+        {
+            uint16_t temp = *(uint16_t*)ptr;
+            return Convert4To8(temp >> 12) | (Convert4To8((temp >> 8) & 0xF) << 8) |
+                   (Convert4To8((temp >> 4) & 0xF) << 16) | (Convert4To8(temp & 0xF) << 24);
+        }
+    }
+    return 0;
+}
+
+static inline void store_color(uint8_t* ptr, uint8_t format, RGBA_Color& color)
+{
+    switch (format)
+    {
+        case 0:
+            *(uint32_t*)ptr = bswp32(color.r | (color.g << 8) | (color.b << 16) | (color.a << 24));
+            break;
+        case 1:
+            ptr[2] = color.r;
+            ptr[1] = color.g;
+            ptr[0] = color.b;
+            break;
+        case 2:
+            *(uint16_t*)ptr = (Convert8To5(color.r) << 11) | (Convert8To5(color.g) << 6) |
+                              (Convert8To5(color.b) << 1) | Convert8To1(color.a);
+            break;
+        case 3:
+            *(uint16_t*)ptr = (Convert8To5(color.r) << 11) | (Convert8To6(color.g) << 5) | Convert8To5(color.b);
+            break;
+        case 4:
+            *(uint16_t*)ptr = (Convert8To4(color.r) << 12) | (Convert8To4(color.g) << 8) |
+                              (Convert8To4(color.b) << 4) | Convert8To4(color.a);
+            break;
+    }
+}
+
+//24-bit depth leaves the top byte to the stencil buffer
+static inline uint32_t load_depth(uint8_t* ptr, uint8_t format)
+{
+    if (format == 0)
+        return *(uint16_t*)ptr;
+    return *(uint16_t*)ptr | (ptr[2] << 16);
+}
+
+static inline void store_depth(uint8_t* ptr, uint8_t format, uint32_t depth)
+{
+    if (format == 0)
+    {
+        *(uint16_t*)ptr = depth;
+        return;
+    }
+    ptr[0] = depth & 0xFF;
+    ptr[1] = (depth >> 8) & 0xFF;
+    ptr[2] = (depth >> 16) & 0xFF;
+}
+
+//Vertex attributes straight from host memory. Integer components are converted to floats four at a time.
+template <typename T, int SIZE>
+static void load_attribute(Vec4<float24>& dest, const uint8_t* src)
+{
+    T values[SIZE];
+    memcpy(values, src, sizeof(values));
+
+#if defined(__SSE2__)
+    alignas(16) int32_t lanes[4] = {0, 0, 0, 1};
+    for (int i = 0; i < SIZE; i++)
+        lanes[i] = values[i];
+    _mm_storeu_ps((float*)&dest, _mm_cvtepi32_ps(_mm_load_si128((const __m128i*)lanes)));
+#else
+    for (int i = 0; i < 4; i++)
+    {
+        if (i < SIZE)
+            dest[i] = float24::FromFloat32(values[i]);
+        else
+            dest[i] = float24::FromFloat32((i == 3) ? 1.0f : 0.0f);
+    }
+#endif
+}
+
+//Floats are already in the form float24 keeps them in
+template <int SIZE>
+static void load_float_attribute(Vec4<float24>& dest, const uint8_t* src)
+{
+    float lanes[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    memcpy(lanes, src, SIZE * sizeof(float));
+    memcpy(&dest, lanes, sizeof(lanes));
+}
+
+//Indexed by format (signed byte, unsigned byte, signed short, float) and then by the number of components minus one
+static const AttributeLoader attribute_loaders[4][4] =
+{
+    {load_attribute<int8_t, 1>, load_attribute<int8_t, 2>, load_attribute<int8_t, 3>, load_attribute<int8_t, 4>},
+    {load_attribute<uint8_t, 1>, load_attribute<uint8_t, 2>, load_attribute<uint8_t, 3>, load_attribute<uint8_t, 4>},
+    {load_attribute<int16_t, 1>, load_attribute<int16_t, 2>, load_attribute<int16_t, 3>, load_attribute<int16_t, 4>},
+    {load_float_attribute<1>, load_float_attribute<2>, load_float_attribute<3>, load_float_attribute<4>}
+};
+
 float24 dp4(Vec4<float24> a, Vec4<float24> b)
 {
     float24 dp = float24::Zero();
@@ -73,6 +214,14 @@ GPU::GPU(Emulator* e, Scheduler* scheduler, MPCore_PMR* pmr) : e(e), scheduler(s
     vram = nullptr;
     top_screen = nullptr;
     bottom_screen = nullptr;
+
+    shader_jit_enabled = true;
+
+    transfer_engine_event = scheduler->register_event("GPU transfer engine DMA",
+        [this](uint64_t param) {do_transfer_engine_dma(param);});
+    command_engine_event = scheduler->register_event("GPU command engine DMA",
+        [this](uint64_t param) {do_command_engine_dma(param);});
+    memfill_event = scheduler->register_event("GPU memfill", [this](uint64_t param) {do_memfill(param);});
 }
 
 GPU::~GPU()
@@ -111,6 +260,30 @@ void GPU::reset(uint8_t* vram)
 
     memset(ctx.texcomb_rgb_buffer_update, 0, sizeof(ctx.texcomb_rgb_buffer_update));
     memset(ctx.texcomb_alpha_buffer_update, 0, sizeof(ctx.texcomb_alpha_buffer_update));
+
+    ctx.color_buffer = nullptr;
+    ctx.depth_buffer = nullptr;
+    ctx.framebuffer_dirty = true;
+
+    memset(ctx.tex_data, 0, sizeof(ctx.tex_data));
+    memset(ctx.tex_texels, 0, sizeof(ctx.tex_texels));
+    ctx.textures_dirty = true;
+
+    tex_cache.clear();
+    tex_cache_bytes = 0;
+    tex_cache_epoch = 1;
+
+    binned_tris.clear();
+    for (int bin : active_bins)
+        bins[bin].clear();
+    active_bins.clear();
+
+    shader_jit.reset();
+    ctx.vsh.jit_program = nullptr;
+    ctx.gsh.jit_program = nullptr;
+
+    vtx_cache_stats.hits = 0;
+    vtx_cache_stats.misses = 0;
 }
 
 void GPU::render_frame()
@@ -208,7 +381,7 @@ void GPU::do_transfer_engine_dma(uint64_t param)
 {
     if (dma.flags & (1 << 3))
     {
-        printf("[GPU] Doing TexCopy\n");
+        LOG(LOG_GPU, LOG_DEBUG, "[GPU] Doing TexCopy\n");
 
         for (unsigned int i = 0; i < dma.tc_size; i++)
         {
@@ -221,12 +394,12 @@ void GPU::do_transfer_engine_dma(uint64_t param)
     }
     else
     {
-        printf("[GPU] Doing DisplayCopy\n");
+        LOG(LOG_GPU, LOG_DEBUG, "[GPU] Doing DisplayCopy\n");
 
-        printf("Input addr: $%08X Output addr: $%08X\n", dma.input_addr, dma.output_addr);
-        printf("Input width/height: %d %d\n", dma.disp_input_width, dma.disp_input_height);
-        printf("Output width/height: %d %d\n", dma.disp_output_width, dma.disp_output_height);
-        printf("Flags: $%08X\n", dma.flags);
+        LOG(LOG_GPU, LOG_DEBUG, "Input addr: $%08X Output addr: $%08X\n", dma.input_addr, dma.output_addr);
+        LOG(LOG_GPU, LOG_DEBUG, "Input width/height: %d %d\n", dma.disp_input_width, dma.disp_input_height);
+        LOG(LOG_GPU, LOG_DEBUG, "Output width/height: %d %d\n", dma.disp_output_width, dma.disp_output_height);
+        LOG(LOG_GPU, LOG_DEBUG, "Flags: $%08X\n", dma.flags);
 
         uint32_t input_addr = dma.input_addr;
         uint32_t output_addr = dma.output_addr;
@@ -267,7 +440,7 @@ void GPU::do_transfer_engine_dma(uint64_t param)
 
         for (unsigned int y = 0; y < dma.disp_output_height; y++)
         {
-            printf("input y: %d output y: %d\n", input_y, y);
+            LOG(LOG_GPU, LOG_TRACE, "input y: %d output y: %d\n", input_y, y);
             int input_x = 0;
             for (unsigned int x = 0; x < dma.disp_output_width; x++)
             {
@@ -413,19 +586,30 @@ void GPU::do_transfer_engine_dma(uint64_t param)
 void GPU::start_command_engine_dma(int index)
 {
     cmd_engine_busy = true;
-    scheduler->add_event([this](uint64_t param) { this->do_command_engine_dma(param);},
-        ctx.cmd_engine[index].size, ARM11_CLOCKRATE, index);
+    scheduler->add_event(command_engine_event, ctx.cmd_engine[index].size, ARM11_CLOCKRATE, index);
 }
 
 void GPU::do_command_engine_dma(uint64_t index)
 {
-    cur_cmdlist_ptr = ctx.cmd_engine[index].input_addr;
-    cur_cmdlist_size = ctx.cmd_engine[index].size;
-
     //Set busy to false here, because the command list may trigger another command list DMA.
     cmd_engine_busy = false;
-    printf("[GPU] Doing command engine DMA\n");
-    printf("[GPU] Addr: $%08X Words: $%08X\n", cur_cmdlist_ptr, cur_cmdlist_size);
+    LOG(LOG_GPU, LOG_TRACE, "[GPU] Doing command engine DMA\n");
+    run_command_list(ctx.cmd_engine[index].input_addr, ctx.cmd_engine[index].size);
+}
+
+//Runs a command list straight away, without going through the command engine
+void GPU::run_command_list(uint32_t addr, uint32_t words)
+{
+    cur_cmdlist_ptr = addr;
+    cur_cmdlist_size = words;
+
+    //The CPU, the transfer engine, and DMA may all have written to textures since the last list
+    tex_cache_epoch++;
+    if (!tex_cache_epoch)
+        tex_cache_epoch = 1;
+    ctx.textures_dirty = true;
+
+    LOG(LOG_GPU, LOG_TRACE, "[GPU] Addr: $%08X Words: $%08X\n", cur_cmdlist_ptr, cur_cmdlist_size);
     //NOTE: Here, size is in units of words
     while (cur_cmdlist_size)
     {
@@ -465,14 +649,33 @@ void GPU::do_command_engine_dma(uint64_t index)
             write_cmd_register(cmd_id, extra_params[i], param_mask);
         }
     }
+
+    //The CPU may look at what was drawn as soon as the list is done
+    flush_tris();
+}
+
+void GPU::set_raster_threads(int count)
+{
+    flush_tris();
+    raster_threads.start(count);
+}
+
+void GPU::set_shader_jit(bool enabled)
+{
+    shader_jit_enabled = enabled;
+}
+
+VertexCacheStats GPU::get_vtx_cache_stats()
+{
+    return vtx_cache_stats;
 }
 
 void GPU::do_memfill(int index)
 {
     //TODO: Is the end region inclusive or exclusive? This code assumes exclusive
-    printf("[GPU] Do memfill%d\n", index);
-    printf("Start: $%08X End: $%08X Value: $%08X Width: %d\n",
-           memfill[index].start, memfill[index].end, memfill[index].value, memfill[index].fill_width);
+    LOG(LOG_GPU, LOG_DEBUG, "[GPU] Do memfill%d\n", index);
+    LOG(LOG_GPU, LOG_DEBUG, "Start: $%08X End: $%08X Value: $%08X Width: %d\n",
+        memfill[index].start, memfill[index].end, memfill[index].value, memfill[index].fill_width);
     for (uint32_t i = memfill[index].start; i < memfill[index].end; i++)
     {
         switch (memfill[index].fill_width)
@@ -502,6 +705,12 @@ void GPU::do_memfill(int index)
     pmr->assert_hw_irq(0x28 + index);
 }
 
+//Registers that are read while drawing fragments, rather than while setting up triangles
+bool GPU::affects_fragments(int reg)
+{
+    return reg == 0x04D || reg == 0x04E || reg == 0x06D || (reg >= 0x080 && reg < 0x200);
+}
+
 void GPU::write_cmd_register(int reg, uint32_t param, uint8_t mask)
 {
     if (reg >= 0x300)
@@ -512,12 +721,24 @@ void GPU::write_cmd_register(int reg, uint32_t param, uint8_t mask)
     for (int i = 0; i < 4; i++)
         real_mask |= (mask & (1 << i)) ? (0xFF << (i * 8)) : 0;
 
-    ctx.regs[reg] &= ~real_mask;
-    ctx.regs[reg] |= param & real_mask;
+    uint32_t new_value = (ctx.regs[reg] & ~real_mask) | (param & real_mask);
+
+    //The binned triangles were set up against the current state, so draw them before it changes.
+    //Writes of the same value are common and don't need to wait. The end of list IRQ and the framebuffer flush
+    //registers do, as something is about to look at the framebuffer.
+    if (!binned_tris.empty())
+    {
+        if ((affects_fragments(reg) && new_value != ctx.regs[reg]) || reg == 0x010 || reg == 0x110 || reg == 0x111)
+            flush_tris();
+    }
+
+    if (reg >= 0x080 && reg < 0x0A0)
+        ctx.textures_dirty = true;
 
-    param = ctx.regs[reg];
+    ctx.regs[reg] = new_value;
+    param = new_value;
 
-    printf("[GPU] Write command $%04X ($%08X)\n", reg, param);
+    LOG(LOG_GPU, LOG_TRACE, "[GPU] Write command $%04X ($%08X)\n", reg, param);
 
     //Texture combiner regs
     if ((reg >= 0x0C0 && reg < 0x0E0) || (reg >= 0x0F0 && reg < 0x0FD))
@@ -646,16 +867,14 @@ void GPU::write_cmd_register(int reg, uint32_t param, uint8_t mask)
     //Geometry Shader code upload
     if (reg >= 0x29C && reg < 0x2A4)
     {
-        *(uint32_t*)&ctx.gsh.code[ctx.gsh.code_index] = param;
-        ctx.gsh.code_index += 4;
+        input_shader_code(ctx.gsh, param);
         return;
     }
 
     //Geometry Shader operand descriptor upload
     if (reg >= 0x2A6 && reg < 0x2AE)
     {
-        ctx.gsh.op_desc[ctx.gsh.op_desc_index] = param;
-        ctx.gsh.op_desc_index++;
+        input_shader_op_desc(ctx.gsh, param);
         return;
     }
 
@@ -669,16 +888,14 @@ void GPU::write_cmd_register(int reg, uint32_t param, uint8_t mask)
     //Vertex Shader code upload
     if (reg >= 0x2CC && reg < 0x2D4)
     {
-        *(uint32_t*)&ctx.vsh.code[ctx.vsh.code_index] = param;
-        ctx.vsh.code_index += 4;
+        input_shader_code(ctx.vsh, param);
         return;
     }
 
     //Vertex Shader operand descriptor upload
     if (reg >= 0x2D6 && reg < 0x2DE)
     {
-        ctx.vsh.op_desc[ctx.vsh.op_desc_index] = param;
-        ctx.vsh.op_desc_index++;
+        input_shader_op_desc(ctx.vsh, param);
         return;
     }
 
@@ -860,19 +1077,24 @@ void GPU::write_cmd_register(int reg, uint32_t param, uint8_t mask)
             break;
         case 0x116:
             ctx.depth_format = param & 0x3;
+            ctx.framebuffer_dirty = true;
             break;
         case 0x117:
             ctx.color_format = (param >> 16) & 0x7;
+            ctx.framebuffer_dirty = true;
             break;
         case 0x11C:
             ctx.depth_buffer_base = (param & 0x0FFFFFFF) << 3;
+            ctx.framebuffer_dirty = true;
             break;
         case 0x11D:
             ctx.color_buffer_base = (param & 0x0FFFFFFF) << 3;
+            ctx.framebuffer_dirty = true;
             break;
         case 0x11E:
             ctx.frame_width = param & 0x7FF;
             ctx.frame_height = ((param >> 12) & 0x3FF) + 1;
+            ctx.framebuffer_dirty = true;
             break;
         case 0x200:
             ctx.vtx_buffer_base = (param & 0x1FFFFFFE) << 3;
@@ -1018,7 +1240,7 @@ void GPU::write_cmd_register(int reg, uint32_t param, uint8_t mask)
             ctx.vsh.op_desc_index = param & 0xFFF;
             break;
         default:
-            printf("[GPU] Unrecognized command $%04X ($%08X)\n", reg, param);
+            LOG(LOG_GPU, LOG_WARN, "[GPU] Unrecognized command $%04X ($%08X)\n", reg, param);
             break;
     }
 }
@@ -1056,131 +1278,233 @@ void GPU::input_float_uniform(ShaderUnit &sh, uint32_t param)
     }
 }
 
+void GPU::input_shader_code(ShaderUnit &sh, uint32_t param)
+{
+    uint32_t* word = (uint32_t*)&sh.code[sh.code_index];
+    if (*word != param)
+    {
+        *word = param;
+        sh.jit_program = nullptr;
+    }
+    sh.code_index += 4;
+}
+
+void GPU::input_shader_op_desc(ShaderUnit &sh, uint32_t param)
+{
+    if (sh.op_desc[sh.op_desc_index] != param)
+    {
+        sh.op_desc[sh.op_desc_index] = param;
+        sh.jit_program = nullptr;
+    }
+    sh.op_desc_index++;
+}
+
 void GPU::draw_vtx_array(bool is_indexed)
 {
-    printf("[GPU] DRAW_VTX_ARRAY (indexed: %d)\n", is_indexed);
+    LOG(LOG_GPU, LOG_TRACE, "[GPU] DRAW_VTX_ARRAY (indexed: %d)\n", is_indexed);
+
+    //Looked up again for every draw, as the CPU may have put code in FCRAM the buffers cover since the last one
+    ctx.framebuffer_dirty = true;
+    if (!ctx.vertices)
+        return;
+
     uint32_t index_base = ctx.vtx_buffer_base + ctx.index_buffer_offs;
-    uint32_t index_offs = 0;
+    uint32_t index_size = (ctx.index_buffer_short) ? 2 : 1;
+    uint8_t* index_ptr = nullptr;
+
+    //The range of indices the draw uses, so the buffers can be looked up once
+    uint32_t min_index = 0, max_index = 0xFFFF;
+    if (is_indexed)
+    {
+        index_ptr = e->get_gpu_memory(index_base, ctx.vertices * index_size);
+        if (index_ptr)
+        {
+            min_index = 0xFFFF;
+            max_index = 0;
+            for (unsigned int i = 0; i < ctx.vertices; i++)
+            {
+                uint16_t index = index_ptr[i];
+                if (ctx.index_buffer_short)
+                    memcpy(&index, index_ptr + (i * 2), sizeof(index));
+                min_index = std::min(min_index, (uint32_t)index);
+                max_index = std::max(max_index, (uint32_t)index);
+            }
+        }
+    }
+    else if (ctx.vtx_offset + ctx.vertices <= 0x10000)
+    {
+        min_index = ctx.vtx_offset;
+        max_index = ctx.vtx_offset + ctx.vertices - 1;
+    }
+
+    VertexLayout layout;
+    compile_vtx_layout(layout);
+    for (int i = 0; i < layout.total_buffers; i++)
+    {
+        uint32_t addr = layout.buffer_addr[i] + layout.buffer_stride[i] * min_index;
+        uint32_t size = layout.buffer_stride[i] * (max_index - min_index) + layout.buffer_bytes[i];
+        layout.buffer_ptr[i] = e->get_gpu_memory(addr, size);
+        if (!layout.buffer_ptr[i])
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Attribute buffer %d at $%08X is not in VRAM or FCRAM\n", i, addr);
+    }
+
+    if (is_indexed)
+    {
+        //No index is larger than 0xFFFF, so this matches none of them
+        for (int i = 0; i < VTX_CACHE_SIZE; i++)
+            vtx_cache[i].index = 0xFFFFFFFF;
+        vtx_cache_stats.hits = 0;
+        vtx_cache_stats.misses = 0;
+    }
+
+    //Buffers outside VRAM and FCRAM are copied here a vertex at a time
+    uint8_t bus_vertices[12][256];
 
-    uint64_t vtx_fmts = ctx.attr_buffer_format_low;
-    vtx_fmts |= (uint64_t)ctx.attr_buffer_format_hi << 32ULL;
     for (unsigned int i = 0; i < ctx.vertices; i++)
     {
         uint16_t index;
         if (is_indexed)
         {
-            if (ctx.index_buffer_short)
+            if (index_ptr)
             {
-                index = e->arm11_read16(0, index_base + index_offs);
-                index_offs += 2;
+                index = index_ptr[i];
+                if (ctx.index_buffer_short)
+                    memcpy(&index, index_ptr + (i * 2), sizeof(index));
             }
+            else if (ctx.index_buffer_short)
+                index = e->arm11_read16(0, index_base + (i * 2));
             else
+                index = e->arm11_read8(0, index_base + i);
+
+            //The shader would give the same outputs for an index it has already run on in this draw
+            VertexCacheEntry& entry = vtx_cache[index % VTX_CACHE_SIZE];
+            if (entry.index == index)
             {
-                index = e->arm11_read8(0, index_base + index_offs);
-                index_offs++;
+                vtx_cache_stats.hits++;
+                memcpy(ctx.vsh.output_regs, entry.outputs, sizeof(entry.outputs));
+                output_vsh_vtx();
+                continue;
             }
         }
         else
             index = i + ctx.vtx_offset;
 
         //Initialize variable input attributes
-        int attr = 0;
-        int buffer = 0;
-        while (attr < ctx.total_vtx_attrs)
+        const uint8_t* vertex[12];
+        for (int buffer = 0; buffer < layout.total_buffers; buffer++)
+        {
+            if (layout.buffer_ptr[buffer])
+            {
+                vertex[buffer] = layout.buffer_ptr[buffer] + layout.buffer_stride[buffer] * (index - min_index);
+                continue;
+            }
+
+            uint32_t addr = layout.buffer_addr[buffer] + layout.buffer_stride[buffer] * index;
+            for (uint32_t byte = 0; byte < layout.buffer_bytes[buffer]; byte++)
+                bus_vertices[buffer][byte] = e->arm11_read8(0, addr + byte);
+            vertex[buffer] = bus_vertices[buffer];
+        }
+
+        for (int j = 0; j < layout.total_fetches; j++)
+        {
+            AttributeFetch& fetch = layout.fetches[j];
+            fetch.load(ctx.vsh.input_attrs[fetch.attr], vertex[fetch.buffer] + fetch.offset);
+        }
+
+        if (is_indexed)
+        {
+            exec_shader(ctx.vsh);
+
+            VertexCacheEntry& entry = vtx_cache[index % VTX_CACHE_SIZE];
+            entry.index = index;
+            memcpy(entry.outputs, ctx.vsh.output_regs, sizeof(entry.outputs));
+            vtx_cache_stats.misses++;
+
+            output_vsh_vtx();
+        }
+        else
+            input_vsh_vtx();
+    }
+
+    if (is_indexed)
+    {
+        LOG(LOG_GPU, LOG_DEBUG, "[GPU] Vertex cache: %u hits, %u misses (%.1f%%)\n", vtx_cache_stats.hits,
+            vtx_cache_stats.misses, 100.0 * vtx_cache_stats.hits / ctx.vertices);
+    }
+}
+
+//Walks the attribute buffers the way the hardware does: each buffer fills the next attributes that aren't fixed, in
+//the order of its components, with the formats the components select. Components 12-15 are padding.
+void GPU::compile_vtx_layout(VertexLayout& layout)
+{
+    uint64_t vtx_fmts = ctx.attr_buffer_format_low;
+    vtx_fmts |= (uint64_t)ctx.attr_buffer_format_hi << 32ULL;
+
+    layout.total_fetches = 0;
+    layout.total_buffers = 0;
+
+    int attr = 0;
+    int buffer = 0;
+    while (attr < ctx.total_vtx_attrs && buffer < 12)
+    {
+        if (!(ctx.fixed_attr_mask & (1 << attr)))
         {
-            if (!(ctx.fixed_attr_mask & (1 << attr)))
+            uint64_t cfg = ctx.attr_buffer_cfg1[buffer];
+            cfg |= (uint64_t)ctx.attr_buffer_cfg2[buffer] << 32ULL;
+
+            uint32_t offset = 0;
+            for (unsigned int k = 0; k < ctx.attr_buffer_components[buffer]; k++)
             {
-                uint64_t cfg = ctx.attr_buffer_cfg1[buffer];
-                cfg |= (uint64_t)ctx.attr_buffer_cfg2[buffer] << 32ULL;
+                uint8_t vtx_format = (cfg >> (k * 4)) & 0xF;
 
-                uint32_t addr = ctx.vtx_buffer_base + ctx.attr_buffer_offs[buffer];
-                addr += ctx.attr_buffer_vtx_size[buffer] * index;
-                for (unsigned int k = 0; k < ctx.attr_buffer_components[buffer]; k++)
+                if (vtx_format < 12)
                 {
-                    uint8_t vtx_format = (cfg >> (k * 4)) & 0xF;
+                    vtx_format = (vtx_fmts >> (vtx_format * 4)) & 0xF;
 
-                    if (vtx_format < 12)
-                    {
-                        vtx_format = (vtx_fmts >> (vtx_format * 4)) & 0xF;
-
-                        uint8_t fmt = vtx_format & 0x3;
-                        uint8_t size = ((vtx_format >> 2) & 0x3) + 1;
-
-                        switch (fmt)
-                        {
-                            case 0:
-                                //Signed byte
-                                for (int comp = 0; comp < size; comp++)
-                                {
-                                    int8_t value = (int8_t)e->arm11_read8(0, addr + comp);
-                                    ctx.vsh.input_attrs[attr][comp] = float24::FromFloat32(value);
-                                }
-                                addr += size;
-                                break;
-                            case 1:
-                                //Unsigned byte
-                                for (int comp = 0; comp < size; comp++)
-                                {
-                                    uint8_t value = e->arm11_read8(0, addr + comp);
-                                    ctx.vsh.input_attrs[attr][comp] = float24::FromFloat32(value);
-                                }
-                                addr += size;
-                                break;
-                            case 2:
-                                //Signed short
-                                for (int comp = 0; comp < size; comp++)
-                                {
-                                    int16_t value = (int16_t)e->arm11_read16(0, addr + (comp * 2));
-                                    ctx.vsh.input_attrs[attr][comp] = float24::FromFloat32(value);
-                                }
-                                addr += size * 2;
-                                break;
-                            case 3:
-                                //Float
-                                for (int comp = 0; comp < size; comp++)
-                                {
-                                    uint32_t temp = e->arm11_read32(0, addr + (comp * 4));
-                                    float value;
-                                    memcpy(&value, &temp, sizeof(float));
-                                    ctx.vsh.input_attrs[attr][comp] = float24::FromFloat32(value);
-                                }
-                                addr += size * 4;
-                                break;
-                        }
-
-                        //If some components are missing, initialize them with default values
-                        //w = 1.0f, all others = 0.0f
-                        for (int comp = size; comp < 4; comp++)
-                        {
-                            if (comp == 3)
-                                ctx.vsh.input_attrs[attr][comp] = float24::FromFloat32(1.0f);
-                            else
-                                ctx.vsh.input_attrs[attr][comp] = float24::FromFloat32(0.0f);
-                        }
-
-                        attr++;
-                    }
-                    else
+                    uint8_t fmt = vtx_format & 0x3;
+                    uint8_t size = ((vtx_format >> 2) & 0x3) + 1;
+
+                    constexpr static int fmt_sizes[] = {1, 1, 2, 4};
+                    if (attr < 16)
                     {
-                        constexpr static int sizes[] = {4, 8, 12, 16};
-                        addr += sizes[vtx_format - 12];
+                        AttributeFetch& fetch = layout.fetches[layout.total_fetches];
+                        fetch.load = attribute_loaders[fmt][size - 1];
+                        fetch.offset = offset;
+                        fetch.buffer = buffer;
+                        fetch.attr = attr;
+                        layout.total_fetches++;
                     }
-                }
 
-                buffer++;
+                    offset += size * fmt_sizes[fmt];
+                    attr++;
+                }
+                else
+                {
+                    constexpr static int sizes[] = {4, 8, 12, 16};
+                    offset += sizes[vtx_format - 12];
+                }
             }
-            else
-                attr++;
-        }
 
-        input_vsh_vtx();
+            layout.buffer_addr[buffer] = ctx.vtx_buffer_base + ctx.attr_buffer_offs[buffer];
+            layout.buffer_stride[buffer] = ctx.attr_buffer_vtx_size[buffer];
+            layout.buffer_bytes[buffer] = offset;
+            buffer++;
+        }
+        else
+            attr++;
     }
+    layout.total_buffers = buffer;
 }
 
 void GPU::input_vsh_vtx()
 {
     exec_shader(ctx.vsh);
+    output_vsh_vtx();
+}
 
+//Sends the vertex shader's outputs on to the geometry shader or the primitive assembler
+void GPU::output_vsh_vtx()
+{
     if (ctx.gsh_enabled)
     {
         if (ctx.prim_mode != 3)
@@ -1407,7 +1731,7 @@ void GPU::process_tri(Vertex &v0, Vertex &v1, Vertex &v2)
         v1 = output_list[1 + i];
         v2 = output_list[2 + i];
 
-        rasterize_tri(v0, v1, v2);
+        setup_tri(v0, v1, v2);
     }
 }
 
@@ -1498,12 +1822,166 @@ bool GPU::get_fill_rule_bias(Vertex &vtx, Vertex &line1, Vertex &line2)
                                                        (line2.pos[1] - line1.pos[1]);
 }
 
-void GPU::rasterize_tri(Vertex &v0, Vertex &v1, Vertex &v2)
+//Only counts sources the operation reads, as unused ones are left at 0, which also means the primary color
+static int get_combiner_source_count(uint8_t op)
 {
-    //The triangle rasterization code uses an approach with barycentric coordinates
-    //Clear explanation can be read below:
-    //https://fgiesen.wordpress.com/2013/02/06/the-barycentric-conspirac/
+    switch (op)
+    {
+        case 0:
+            return 1;
+        case 4:
+        case 8:
+        case 9:
+            return 3;
+        default:
+            return 2;
+    }
+}
+
+bool GPU::combiners_use_primary_color()
+{
+    //With no combiners, the primary color is what's drawn
+    if (ctx.texcomb_start >= ctx.texcomb_end)
+        return true;
+
+    for (int i = ctx.texcomb_start; i < ctx.texcomb_end; i++)
+    {
+        int rgb_count = get_combiner_source_count(ctx.texcomb_rgb_op[i]);
+        int alpha_count = get_combiner_source_count(ctx.texcomb_alpha_op[i]);
+        for (int j = 0; j < 3; j++)
+        {
+            uint8_t sources[2] = {ctx.texcomb_rgb_source[i][j], ctx.texcomb_alpha_source[i][j]};
+            for (int k = 0; k < 2; k++)
+            {
+                if (j >= ((k) ? alpha_count : rgb_count))
+                    continue;
+
+                //Fragment lighting isn't emulated, so its sources stand in for the primary color, as does the
+                //previous stage's output in the first stage
+                if (sources[k] <= 0x2 || (sources[k] == 0xF && i == ctx.texcomb_start))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+//Whether a lookup on the texture unit reads a texture, and so needs its coordinates
+bool GPU::tex_unit_samples(int index)
+{
+    return ctx.tex_enable[index] && ctx.tex_addr[index] && ctx.tex_data[index];
+}
+
+void GPU::resolve_framebuffer()
+{
+    ctx.framebuffer_dirty = false;
+
+    uint32_t color_size = color_format_sizes[ctx.color_format];
+    uint32_t depth_size = depth_format_sizes[ctx.depth_format];
+    if (!color_size)
+        EmuException::die("[GPU] Unrecognized color format $%02X\n", ctx.color_format);
+    if (!depth_size)
+        EmuException::die("[GPU] Unrecognized depth format %d\n", ctx.depth_format);
+
+    //Tiles are 8x8, so a partial row of tiles at the edge still takes up a whole one
+    uint32_t pixels = ((ctx.frame_width + 7) & ~0x7) * ((ctx.frame_height + 7) & ~0x7);
+    ctx.color_buffer = e->get_render_target(ctx.color_buffer_base, pixels * color_size);
+    ctx.depth_buffer = e->get_render_target(ctx.depth_buffer_base, pixels * depth_size);
+
+    //The depth buffer is often left pointing anywhere when it isn't used, so that's only a problem once it is
+    if (!ctx.color_buffer)
+        LOG(LOG_GPU, LOG_WARN, "[GPU] Color buffer $%08X is not in VRAM or FCRAM\n", ctx.color_buffer_base);
+    if (!ctx.depth_buffer)
+        LOG(LOG_GPU, LOG_DEBUG, "[GPU] Depth buffer $%08X is not in VRAM or FCRAM\n", ctx.depth_buffer_base);
+}
+
+void GPU::resolve_textures()
+{
+    ctx.textures_dirty = false;
+
+    //Binned triangles may still point into the entries
+    if (tex_cache_bytes > MAX_TEX_CACHE_BYTES)
+    {
+        flush_tris();
+        tex_cache.clear();
+        tex_cache_bytes = 0;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        ctx.tex_data[i] = nullptr;
+        ctx.tex_texels[i] = nullptr;
+        if (!ctx.tex_enable[i] || !ctx.tex_addr[i])
+            continue;
+
+        uint32_t size = (ctx.tex_width[i] * ctx.tex_height[i] * tex_format_bits[ctx.tex_type[i]]) / 8;
+        ctx.tex_data[i] = e->get_gpu_memory(ctx.tex_addr[i], size);
+        if (!ctx.tex_data[i])
+        {
+            LOG(LOG_GPU, LOG_WARN, "[GPU] Texture %d at $%08X is not in VRAM or FCRAM\n", i, ctx.tex_addr[i]);
+            continue;
+        }
+
+        if (ctx.tex_type[i] <= 0xD)
+            ctx.tex_texels[i] = get_decoded_texture(i, size);
+    }
+}
+
+const uint32_t* GPU::get_decoded_texture(int index, uint32_t size)
+{
+    uint32_t width = ctx.tex_width[index];
+    uint32_t height = ctx.tex_height[index];
+    uint64_t key = ((uint64_t)ctx.tex_addr[index] << 32) | (width << 20) | (height << 4) | ctx.tex_type[index];
 
+    auto it = tex_cache.find(key);
+    if (it != tex_cache.end() && it->second.epoch == tex_cache_epoch)
+        return it->second.texels.data();
+
+    uint64_t hash = hash_texture(ctx.tex_data[index], size);
+    if (it != tex_cache.end() && it->second.hash == hash)
+    {
+        it->second.epoch = tex_cache_epoch;
+        return it->second.texels.data();
+    }
+
+    //Binned triangles may still be sampling the old contents
+    flush_tris();
+
+    if (it == tex_cache.end())
+    {
+        it = tex_cache.emplace(key, TextureCacheEntry()).first;
+        it->second.addr = ctx.tex_addr[index];
+        it->second.size = size;
+        it->second.texels.resize(width * height);
+        tex_cache_bytes += width * height * sizeof(uint32_t);
+    }
+
+    TextureCacheEntry& entry = it->second;
+    entry.hash = hash;
+    entry.epoch = tex_cache_epoch;
+    decode_texture(index, entry.texels.data());
+
+    LOG(LOG_GPU, LOG_DEBUG, "[GPU] Decoded %dx%d texture at $%08X, format $%02X\n", width, height, entry.addr,
+        ctx.tex_type[index]);
+    return entry.texels.data();
+}
+
+//Entries in the range are checked again next time they're used
+void GPU::invalidate_textures(uint32_t addr, uint32_t size)
+{
+    for (auto& it : tex_cache)
+    {
+        TextureCacheEntry& entry = it.second;
+        if (entry.addr < addr + size && addr < entry.addr + entry.size)
+        {
+            entry.epoch = 0;
+            ctx.textures_dirty = true;
+        }
+    }
+}
+
+void GPU::setup_tri(Vertex &v0, Vertex &v1, Vertex &v2)
+{
     //Check if texture combiners are unused - this lets us save time by not looping through all six of them
     ctx.texcomb_start = 0;
     for (int i = 0; i < 6; i++)
@@ -1562,391 +2040,402 @@ void GPU::rasterize_tri(Vertex &v0, Vertex &v1, Vertex &v2)
     max_x = (max_x + 0xF) & ~0xF;
     max_y = (max_y + 0xF) & ~0xF;
 
-    Vertex min_corner;
-    min_corner.pos[0] = float24::FromFloat32(min_x);
-    min_corner.pos[1] = float24::FromFloat32(min_y);
+    //Nothing outside the framebuffer is drawn, which also keeps every access within the buffers resolved below
+    min_x = std::max(min_x, 8);
+    min_y = std::max(min_y, 8);
+    max_x = std::min(max_x, (int32_t)ctx.frame_width << 4);
+    max_y = std::min(max_y, (int32_t)ctx.frame_height << 4);
+
+    if (min_x >= max_x || min_y >= max_y)
+        return;
 
     bool can_do_stencil = ctx.stencil_test_enabled && ctx.depth_format == 0x3;
+    bool uses_depth_buffer = can_do_stencil || ctx.depth_test_enabled ||
+                             (ctx.depth_write_enabled && (ctx.allow_stencil_depth_write & 0x2));
+
+    if (ctx.framebuffer_dirty)
+        resolve_framebuffer();
+    if (!ctx.color_buffer || (uses_depth_buffer && !ctx.depth_buffer))
+        return;
+    if (ctx.textures_dirty)
+        resolve_textures();
+
+    RasterTri tri;
+    tri.min_x = min_x;
+    tri.min_y = min_y;
+    tri.max_x = max_x;
+    tri.max_y = max_y;
+
+    int bias[3];
+    bias[0] = get_fill_rule_bias(v0, v1, v2) ? -1 : 0;
+    bias[1] = get_fill_rule_bias(v1, v2, v0) ? -1 : 0;
+    bias[2] = get_fill_rule_bias(v2, v0, v1) ? -1 : 0;
+
+    Vertex* vertices[3] = {&v0, &v1, &v2};
+    int32_t x[3], y[3];
+    for (int i = 0; i < 3; i++)
+    {
+        x[i] = vertices[i]->pos[0].ToFloat32();
+        y[i] = vertices[i]->pos[1].ToFloat32();
+    }
+    setup_edge_functions(tri.edges, x, y, bias, min_x, min_y, max_x, max_y);
+
+    //The edge functions add up to the same value everywhere, twice the area plus the biases. Dividing by that turns
+    //them into barycentric weights, so every plane is worked out in terms of those.
+    int64_t corner[3];
+    int64_t weight_sum = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        corner[i] = (int64_t)tri.edges.a[i] * (min_y - tri.edges.y0[i]) -
+                    (int64_t)tri.edges.b[i] * (min_x - tri.edges.x0[i]) + tri.edges.bias[i];
+        weight_sum += corner[i];
+    }
 
-    /*int32_t w1_row = orient2D(v1, v2, min_corner).ToFloat32();
-    int32_t w2_row = orient2D(v2, v0, min_corner).ToFloat32();
-    int32_t w3_row = orient2D(v0, v1, min_corner).ToFloat32();
+    //No pixel can be inside a triangle without any area
+    if (weight_sum <= 0)
+        return;
 
-    int32_t w1_dx = (v1.pos[1] - v2.pos[1]).ToFloat32() * 0x10;
-    int32_t w2_dx = (v2.pos[1] - v0.pos[1]).ToFloat32() * 0x10;
-    int32_t w3_dx = (v0.pos[1] - v1.pos[1]).ToFloat32() * 0x10;
+    auto make_plane = [&](float24 attr0, float24 attr1, float24 attr2)
+    {
+        double attr[3] = {attr0.ToFloat32(), attr1.ToFloat32(), attr2.ToFloat32()};
+        double origin = 0.0, dx = 0.0, dy = 0.0;
+        for (int i = 0; i < 3; i++)
+        {
+            origin += attr[i] * corner[i];
+            dx -= attr[i] * tri.edges.b[i] * 0x10;
+            dy += attr[i] * tri.edges.a[i] * 0x10;
+        }
+        return AttributePlane{(float)(origin / weight_sum), (float)(dx / weight_sum), (float)(dy / weight_sum)};
+    };
 
-    int32_t w1_dy = (v2.pos[0] - v1.pos[0]).ToFloat32() * 0x10;
-    int32_t w2_dy = (v0.pos[0] - v2.pos[0]).ToFloat32() * 0x10;
-    int32_t w3_dy = (v1.pos[0] - v0.pos[0]).ToFloat32() * 0x10;*/
+    tri.inv_w = make_plane(v0.pos[3], v1.pos[3], v2.pos[3]);
+    tri.z = make_plane(v0.pos[2], v1.pos[2], v2.pos[2]);
 
-    int bias0 = get_fill_rule_bias(v0, v1, v2) ? -1 : 0;
-    int bias1 = get_fill_rule_bias(v1, v2, v0) ? -1 : 0;
-    int bias2 = get_fill_rule_bias(v2, v0, v1) ? -1 : 0;
+    tri.uses_color = combiners_use_primary_color();
+    if (tri.uses_color)
+    {
+        for (int i = 0; i < 4; i++)
+            tri.color[i] = make_plane(v0.color[i], v1.color[i], v2.color[i]);
+    }
 
-    //TODO: Parallelize this
-    for (int32_t y = min_y; y < max_y; y += 0x10)
+    tri.uses_texcoords[0] = ctx.tex0_type == 0 && tex_unit_samples(0);
+    tri.uses_texcoords[1] = tex_unit_samples(1) || (tex_unit_samples(2) && ctx.tex2_uses_tex1_coords);
+    tri.uses_texcoords[2] = tex_unit_samples(2) && !ctx.tex2_uses_tex1_coords;
+    for (int i = 0; i < 3; i++)
     {
-        /*int32_t w1 = w1_row;
-        int32_t w2 = w2_row;
-        int32_t w3 = w3_row;*/
-        for (int32_t x = min_x; x < max_x; x += 0x10)
+        if (!tri.uses_texcoords[i])
+            continue;
+
+        for (int j = 0; j < 2; j++)
+            tri.texcoords[i][j] = make_plane(v0.texcoords[i][j], v1.texcoords[i][j], v2.texcoords[i][j]);
+    }
+
+    uint32_t index = binned_tris.size();
+    binned_tris.push_back(tri);
+
+    //The frame size can't change while triangles are binned, so neither can the layout of the bins
+    int bins_per_row = (ctx.frame_width + BIN_SIZE - 1) >> BIN_SHIFT;
+    int bin_rows = (ctx.frame_height + BIN_SIZE - 1) >> BIN_SHIFT;
+    if (bins.size() < (size_t)(bins_per_row * bin_rows))
+        bins.resize(bins_per_row * bin_rows);
+
+    int first_bin_x = (min_x >> 4) >> BIN_SHIFT;
+    int first_bin_y = (min_y >> 4) >> BIN_SHIFT;
+    int last_bin_x = ((max_x >> 4) - 1) >> BIN_SHIFT;
+    int last_bin_y = ((max_y >> 4) - 1) >> BIN_SHIFT;
+    for (int bin_y = first_bin_y; bin_y <= last_bin_y; bin_y++)
+    {
+        for (int bin_x = first_bin_x; bin_x <= last_bin_x; bin_x++)
         {
-            Vertex temp;
-            temp.pos[0] = float24::FromFloat32(x);
-            temp.pos[1] = float24::FromFloat32(y);
-            int32_t w1 = roundf(orient2D(v1, v2, temp).ToFloat32()) + bias0;
-            int32_t w2 = roundf(orient2D(v2, v0, temp).ToFloat32()) + bias1;
-            int32_t w3 = roundf(orient2D(v0, v1, temp).ToFloat32()) + bias2;
-            //Is inside triangle?
-            if ((w1 | w2 | w3) >= 0)
-            {
-                float24 f1 = float24::FromFloat32(w1);
-                float24 f2 = float24::FromFloat32(w2);
-                float24 f3 = float24::FromFloat32(w3);
-                Vertex vtx;
+            int bin = bin_x + (bin_y * bins_per_row);
+            if (bins[bin].empty())
+                active_bins.push_back(bin);
+            bins[bin].push_back(index);
+        }
+    }
 
-                float24 divider = float24::FromFloat32(1.0f) / (v0.pos[3] * f1 +
-                        v1.pos[3] * f2 + v2.pos[3] * f3);
+    if (binned_tris.size() >= MAX_BINNED_TRIS)
+        flush_tris();
+}
 
-                float24 z = (v0.pos[2] * f1 + v1.pos[2] * f2 + v2.pos[2] * f3) / (f1 + f2 + f3);
+void GPU::flush_tris()
+{
+    if (binned_tris.empty())
+        return;
 
-                float depth = (z * ctx.depth_scale + ctx.depth_offset).ToFloat32();
+    raster_threads.run(active_bins.size(), [this](int job) {rasterize_bin(active_bins[job]);});
 
-                if (!ctx.use_z_for_depth)
-                    depth *= ((f1 + f2 + f3) * divider).ToFloat32();
+    binned_tris.clear();
+    for (int bin : active_bins)
+        bins[bin].clear();
+    active_bins.clear();
 
-                if (depth < 0.0)
-                    depth = 0.0;
-                if (depth > 1.0)
-                    depth = 1.0;
+    //Render to texture
+    if (!tex_cache.empty())
+    {
+        uint32_t pixels = ((ctx.frame_width + 7) & ~0x7) * ((ctx.frame_height + 7) & ~0x7);
+        invalidate_textures(ctx.color_buffer_base, pixels * color_format_sizes[ctx.color_format]);
+        invalidate_textures(ctx.depth_buffer_base, pixels * depth_format_sizes[ctx.depth_format]);
+    }
+}
 
-                for (int i = 0; i < 4; i++)
-                    vtx.color[i] = (v0.color[i] * f1 + v1.color[i] * f2 + v2.color[i] * f3) * divider;
+void GPU::rasterize_bin(int bin)
+{
+    int bins_per_row = (ctx.frame_width + BIN_SIZE - 1) >> BIN_SHIFT;
+    int32_t bin_x = (bin % bins_per_row) << (BIN_SHIFT + 4);
+    int32_t bin_y = (bin / bins_per_row) << (BIN_SHIFT + 4);
 
-                for (int i = 0; i < 2; i++)
-                {
-                    vtx.texcoords[0][i] = (v0.texcoords[0][i] * f1 + v1.texcoords[0][i] * f2 + v2.texcoords[0][i] * f3) * divider;
-                    vtx.texcoords[1][i] = (v0.texcoords[1][i] * f1 + v1.texcoords[1][i] * f2 + v2.texcoords[1][i] * f3) * divider;
-                    vtx.texcoords[2][i] = (v0.texcoords[2][i] * f1 + v1.texcoords[2][i] * f2 + v2.texcoords[2][i] * f3) * divider;
-                }
+    //Pixel centers are sampled, hence the offset of half a pixel at the start
+    for (uint32_t index : bins[bin])
+    {
+        RasterTri& tri = binned_tris[index];
+        rasterize_tri(tri, std::max(tri.min_x, bin_x + 8), std::max(tri.min_y, bin_y + 8),
+                      std::min(tri.max_x, bin_x + (BIN_SIZE << 4)), std::min(tri.max_y, bin_y + (BIN_SIZE << 4)));
+    }
+}
 
-                RGBA_Color source_color, frame_color;
+void GPU::rasterize_tri(RasterTri& tri, int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y)
+{
+    //The triangle rasterization code uses an approach with barycentric coordinates
+    //Clear explanation can be read below:
+    //https://fgiesen.wordpress.com/2013/02/06/the-barycentric-conspirac/
+    scan_edge_functions(tri.edges, min_x, min_y, max_x, max_y, [&](int32_t x, int32_t y,
+                        int32_t, int32_t, int32_t) {draw_fragment(tri, x, y);});
+}
 
-                source_color.r = (uint8_t)roundf((vtx.color[0].ToFloat32() * 255.0));
-                source_color.g = (uint8_t)roundf((vtx.color[1].ToFloat32() * 255.0));
-                source_color.b = (uint8_t)roundf((vtx.color[2].ToFloat32() * 255.0));
-                source_color.a = (uint8_t)roundf((vtx.color[3].ToFloat32() * 255.0));
+void GPU::draw_fragment(RasterTri& tri, int32_t x, int32_t y)
+{
+    bool can_do_stencil = ctx.stencil_test_enabled && ctx.depth_format == 0x3;
+    bool uses_depth_buffer = can_do_stencil || ctx.depth_test_enabled ||
+                             (ctx.depth_write_enabled && (ctx.allow_stencil_depth_write & 0x2));
 
-                combine_textures(source_color, vtx);
+    uint32_t color_size = color_format_sizes[ctx.color_format];
+    uint32_t depth_size = depth_format_sizes[ctx.depth_format];
 
-                if (ctx.alpha_test_enabled)
-                {
-                    bool alpha_pass = true;
-                    switch (ctx.alpha_test_func)
-                    {
-                        case 0:
-                            //NEVER
-                            alpha_pass = false;
-                            break;
-                        case 1:
-                            //ALWAYS
-                            break;
-                        case 2:
-                            //EQUAL
-                            alpha_pass = source_color.a == ctx.alpha_test_ref;
-                            break;
-                        case 3:
-                            //NOT EQUAL
-                            alpha_pass = source_color.a != ctx.alpha_test_ref;
-                            break;
-                        case 4:
-                            //LESS THAN
-                            alpha_pass = source_color.a < ctx.alpha_test_ref;
-                            break;
-                        case 5:
-                            //LESS THAN OR EQUAL
-                            alpha_pass = source_color.a <= ctx.alpha_test_ref;
-                            break;
-                        case 6:
-                            //GREATER THAN
-                            alpha_pass = source_color.a > ctx.alpha_test_ref;
-                            break;
-                        case 7:
-                            //GREATER THAN OR EQUAL
-                            alpha_pass = source_color.a >= ctx.alpha_test_ref;
-                            break;
-                    }
+    float pixel_x = (x - tri.min_x) >> 4;
+    float pixel_y = (y - tri.min_y) >> 4;
+    auto interpolate = [pixel_x, pixel_y](const AttributePlane& plane)
+    {
+        return plane.origin + plane.dx * pixel_x + plane.dy * pixel_y;
+    };
 
-                    if (!alpha_pass)
-                        continue;
-                }
+    //Perspective correction
+    float divider = 1.0f / interpolate(tri.inv_w);
+
+    float depth = interpolate(tri.z) * ctx.depth_scale.ToFloat32() + ctx.depth_offset.ToFloat32();
+
+    if (!ctx.use_z_for_depth)
+        depth *= divider;
+
+    if (depth < 0.0)
+        depth = 0.0;
+    if (depth > 1.0)
+        depth = 1.0;
 
-                uint8_t stencil = 0;
+    Vertex vtx;
+    for (int i = 0; i < 3; i++)
+    {
+        if (!tri.uses_texcoords[i])
+            continue;
+
+        vtx.texcoords[i][0] = float24::FromFloat32(interpolate(tri.texcoords[i][0]) * divider);
+        vtx.texcoords[i][1] = float24::FromFloat32(interpolate(tri.texcoords[i][1]) * divider);
+    }
+
+    RGBA_Color source_color = {0, 0, 0, 0};
+    RGBA_Color frame_color;
+
+    if (tri.uses_color)
+    {
+        source_color.r = (uint8_t)roundf((interpolate(tri.color[0]) * divider * 255.0));
+        source_color.g = (uint8_t)roundf((interpolate(tri.color[1]) * divider * 255.0));
+        source_color.b = (uint8_t)roundf((interpolate(tri.color[2]) * divider * 255.0));
+        source_color.a = (uint8_t)roundf((interpolate(tri.color[3]) * divider * 255.0));
+    }
+
+    combine_textures(source_color, vtx);
+
+    if (ctx.alpha_test_enabled)
+    {
+        bool alpha_pass = true;
+        switch (ctx.alpha_test_func)
+        {
+            case 0:
+                //NEVER
+                alpha_pass = false;
+                break;
+            case 1:
+                //ALWAYS
+                break;
+            case 2:
+                //EQUAL
+                alpha_pass = source_color.a == ctx.alpha_test_ref;
+                break;
+            case 3:
+                //NOT EQUAL
+                alpha_pass = source_color.a != ctx.alpha_test_ref;
+                break;
+            case 4:
+                //LESS THAN
+                alpha_pass = source_color.a < ctx.alpha_test_ref;
+                break;
+            case 5:
+                //LESS THAN OR EQUAL
+                alpha_pass = source_color.a <= ctx.alpha_test_ref;
+                break;
+            case 6:
+                //GREATER THAN
+                alpha_pass = source_color.a > ctx.alpha_test_ref;
+                break;
+            case 7:
+                //GREATER THAN OR EQUAL
+                alpha_pass = source_color.a >= ctx.alpha_test_ref;
+                break;
+        }
 
-                //The stencil test only works on 24-bit depth + 8-bit stencil
-                if (can_do_stencil)
-                {
-                    uint32_t depth_addr = get_swizzled_tile_addr(ctx.depth_buffer_base,
-                                                                 ctx.frame_width, x >> 4, y >> 4, 4);
+        if (!alpha_pass)
+            return;
+    }
 
-                    stencil = e->arm11_read32(0, depth_addr) >> 24;
-                    uint8_t dest = stencil & ctx.stencil_input_mask;
-                    uint8_t ref = ctx.stencil_ref & ctx.stencil_input_mask;
+    uint8_t stencil = 0;
+    uint8_t* depth_ptr = nullptr;
+    if (uses_depth_buffer)
+        depth_ptr = ctx.depth_buffer + get_swizzled_tile_addr(0, ctx.frame_width, x >> 4, y >> 4, depth_size);
 
-                    bool pass = false;
-                    switch (ctx.stencil_test_func)
-                    {
-                        case 0:
-                            //NEVER
-                            break;
-                        case 1:
-                            //ALWAYS
-                            pass = true;
-                            break;
-                        case 2:
-                            //EQUAL
-                            pass = ref == dest;
-                            break;
-                        case 3:
-                            //NEQUAL
-                            pass = ref != dest;
-                            break;
-                        case 4:
-                            //LESS THAN
-                            pass = ref < dest;
-                            break;
-                        case 5:
-                            //LESS THAN OR EQUAL
-                            pass = ref <= dest;
-                            break;
-                        case 6:
-                            //GREATER THAN
-                            pass = ref > dest;
-                            break;
-                        case 7:
-                            //GREATER THAN OR EQUAL
-                            pass = ref >= dest;
-                            break;
-                    }
+    //The stencil test only works on 24-bit depth + 8-bit stencil
+    if (can_do_stencil)
+    {
+        stencil = depth_ptr[3];
+        uint8_t dest = stencil & ctx.stencil_input_mask;
+        uint8_t ref = ctx.stencil_ref & ctx.stencil_input_mask;
 
-                    if (!pass)
-                    {
-                        update_stencil(depth_addr, stencil, ctx.stencil_ref, ctx.stencil_fail_func);
-                        continue;
-                    }
-                }
+        bool pass = false;
+        switch (ctx.stencil_test_func)
+        {
+            case 0:
+                //NEVER
+                break;
+            case 1:
+                //ALWAYS
+                pass = true;
+                break;
+            case 2:
+                //EQUAL
+                pass = ref == dest;
+                break;
+            case 3:
+                //NEQUAL
+                pass = ref != dest;
+                break;
+            case 4:
+                //LESS THAN
+                pass = ref < dest;
+                break;
+            case 5:
+                //LESS THAN OR EQUAL
+                pass = ref <= dest;
+                break;
+            case 6:
+                //GREATER THAN
+                pass = ref > dest;
+                break;
+            case 7:
+                //GREATER THAN OR EQUAL
+                pass = ref >= dest;
+                break;
+        }
 
-                uint32_t depth_addr = 0;
-                uint32_t old_depth = 0;
-                uint32_t new_depth = 0;
+        if (!pass)
+        {
+            update_stencil(depth_ptr, stencil, ctx.stencil_ref, ctx.stencil_fail_func);
+            return;
+        }
+    }
 
-                switch (ctx.depth_format)
-                {
-                    case 0x0:
-                        depth_addr = get_swizzled_tile_addr(ctx.depth_buffer_base,
-                                                             ctx.frame_width, x >> 4, y >> 4, 2);
-                        new_depth = (uint32_t)(depth * 0xFFFF);
-                        break;
-                    case 0x2:
-                        depth_addr = get_swizzled_tile_addr(ctx.depth_buffer_base,
-                                                             ctx.frame_width, x >> 4, y >> 4, 3);
-                        new_depth = (uint32_t)(depth * 0xFFFFFF);
-                        break;
-                    case 0x3:
-                        depth_addr = get_swizzled_tile_addr(ctx.depth_buffer_base,
-                                                             ctx.frame_width, x >> 4, y >> 4, 4);
-                        new_depth = (uint32_t)(depth * 0xFFFFFF);
-                        break;
-                    default:
-                        EmuException::die("[GPU] Unrecognized depth format %d\n", ctx.depth_format);
-                }
+    uint32_t old_depth = 0;
+    uint32_t new_depth = 0;
 
-                bool depth_passed = true;
+    if (ctx.depth_format == 0x0)
+        new_depth = (uint32_t)(depth * 0xFFFF);
+    else
+        new_depth = (uint32_t)(depth * 0xFFFFFF);
 
-                if (ctx.depth_test_enabled)
-                {
-                    switch (ctx.depth_format)
-                    {
-                        case 0:
-                            old_depth = e->arm11_read16(0, depth_addr);
-                            break;
-                        case 2:
-                        case 3:
-                            old_depth = e->arm11_read16(0, depth_addr);
-                            old_depth |= e->arm11_read8(0, depth_addr + 2) << 16;
-                            break;
-                    }
-                    switch (ctx.depth_test_func)
-                    {
-                        case 0x0:
-                            //NEVER
-                            depth_passed = false;
-                            break;
-                        case 0x1:
-                            //ALWAYS
-                            break;
-                        case 0x2:
-                            //EQUAL
-                            depth_passed = new_depth == old_depth;
-                            break;
-                        case 0x3:
-                            //NEQUAL
-                            depth_passed = new_depth != old_depth;
-                            break;
-                        case 0x4:
-                            //LESS THAN
-                            depth_passed = new_depth < old_depth;
-                            break;
-                        case 0x5:
-                            //LESS THAN OR EQUAL
-                            depth_passed = new_depth <= old_depth;
-                            break;
-                        case 0x6:
-                            //GREATER THAN
-                            depth_passed = new_depth > old_depth;
-                            break;
-                        case 0x7:
-                            //GREATER THAN OR EQUAL
-                            depth_passed = new_depth >= old_depth;
-                            break;
-                    }
-                }
+    bool depth_passed = true;
 
-                if (!depth_passed)
-                {
-                    if (can_do_stencil)
-                        update_stencil(depth_addr, stencil, ctx.stencil_ref, ctx.stencil_depth_fail_func);
-                    continue;
-                }
+    if (ctx.depth_test_enabled)
+    {
+        old_depth = load_depth(depth_ptr, ctx.depth_format);
+        switch (ctx.depth_test_func)
+        {
+            case 0x0:
+                //NEVER
+                depth_passed = false;
+                break;
+            case 0x1:
+                //ALWAYS
+                break;
+            case 0x2:
+                //EQUAL
+                depth_passed = new_depth == old_depth;
+                break;
+            case 0x3:
+                //NEQUAL
+                depth_passed = new_depth != old_depth;
+                break;
+            case 0x4:
+                //LESS THAN
+                depth_passed = new_depth < old_depth;
+                break;
+            case 0x5:
+                //LESS THAN OR EQUAL
+                depth_passed = new_depth <= old_depth;
+                break;
+            case 0x6:
+                //GREATER THAN
+                depth_passed = new_depth > old_depth;
+                break;
+            case 0x7:
+                //GREATER THAN OR EQUAL
+                depth_passed = new_depth >= old_depth;
+                break;
+        }
+    }
 
-                //Note that writes to the depth buffer happen even if the depth test is disabled
-                if (ctx.depth_write_enabled && (ctx.allow_stencil_depth_write & 0x2))
-                {
-                    switch (ctx.depth_format)
-                    {
-                        case 0x0:
-                            e->arm11_write16(0, depth_addr, new_depth);
-                            break;
-                        case 0x2:
-                        case 0x3:
-                            e->arm11_write8(0, depth_addr, new_depth & 0xFF);
-                            e->arm11_write8(0, depth_addr + 1, (new_depth >> 8) & 0xFF);
-                            e->arm11_write8(0, depth_addr + 2, (new_depth >> 16) & 0xFF);
-                            break;
-                    }
-                }
+    if (!depth_passed)
+    {
+        if (can_do_stencil)
+            update_stencil(depth_ptr, stencil, ctx.stencil_ref, ctx.stencil_depth_fail_func);
+        return;
+    }
 
-                if (can_do_stencil)
-                    update_stencil(depth_addr, stencil, ctx.stencil_ref, ctx.stencil_depth_pass_func);
+    //Note that writes to the depth buffer happen even if the depth test is disabled
+    if (ctx.depth_write_enabled && (ctx.allow_stencil_depth_write & 0x2))
+        store_depth(depth_ptr, ctx.depth_format, new_depth);
 
-                uint32_t frame_addr = 0, frame = 0;
-                switch (ctx.color_format)
-                {
-                    case 0:
-                        frame_addr = get_swizzled_tile_addr(ctx.color_buffer_base, ctx.frame_width, x >> 4, y >> 4, 4);
-                        frame = bswp32(e->arm11_read32(0, frame_addr));
-                        break;
-                    case 1:
-                        frame_addr = get_swizzled_tile_addr(ctx.color_buffer_base, ctx.frame_width, x >> 4, y >> 4, 3);
-                        frame = e->arm11_read8(0, frame_addr + 2);
-                        frame |= e->arm11_read8(0, frame_addr + 1) << 8;
-                        frame |= e->arm11_read8(0, frame_addr) << 16;
-                        frame |= 0xFF << 24;
-                        break;
-                    case 2:
-                    {
-                        frame_addr = get_swizzled_tile_addr(ctx.color_buffer_base, ctx.frame_width, x >> 4, y >> 4, 2);
-                        uint16_t temp = e->arm11_read16(0, frame_addr);
-                        frame = Convert5To8(temp >> 11);
-                        frame |= Convert5To8((temp >> 6) & 0x1F) << 8;
-                        frame |= Convert5To8((temp >> 1) & 0x1F) << 16;
-                        frame |= Convert1To8(temp & 0x1) << 24;
-                    }
-                        break;
-                    case 3:
-                    {
-                        frame_addr = get_swizzled_tile_addr(ctx.color_buffer_base, ctx.frame_width, x >> 4, y >> 4, 2);
-                        uint16_t temp = e->arm11_read16(0, frame_addr);
-                        frame = Convert5To8(temp >> 11);
-                        frame |= Convert6To8((temp >> 5) & 0x3F) << 8;
-                        frame |= Convert5To8(temp & 0x1F) << 16;
-                        frame |= 0xFF << 24;
-                    }
-                        break;
-                    case 4:
-                    {
-                        frame_addr = get_swizzled_tile_addr(ctx.color_buffer_base, ctx.frame_width, x >> 4, y >> 4, 2);
-                        uint16_t temp = e->arm11_read16(0, frame_addr);
-                        frame = Convert4To8(temp >> 12);
-                        frame |= Convert4To8((temp >> 8) & 0xF) << 8;
-                        frame |= Convert4To8((temp >> 4) & 0xF) << 16;
-                        frame |= Convert4To8(temp & 0xF) << 24;
-                    }
-                        break;
-                    default:
-                        EmuException::die("[GPU] Unrecognized color format $%02X\n", ctx.color_format);
-                }
+    if (can_do_stencil)
+        update_stencil(depth_ptr, stencil, ctx.stencil_ref, ctx.stencil_depth_pass_func);
 
-                frame_color.r = frame & 0xFF;
-                frame_color.g = (frame >> 8) & 0xFF;
-                frame_color.b = (frame >> 16) & 0xFF;
-                frame_color.a = frame >> 24;
+    uint8_t* color_ptr = ctx.color_buffer + get_swizzled_tile_addr(0, ctx.frame_width, x >> 4, y >> 4,
+                                                                   color_size);
+    uint32_t frame = load_color(color_ptr, ctx.color_format);
 
-                blend_fragment(source_color, frame_color);
+    frame_color.r = frame & 0xFF;
+    frame_color.g = (frame >> 8) & 0xFF;
+    frame_color.b = (frame >> 16) & 0xFF;
+    frame_color.a = frame >> 24;
 
-                if (!ctx.rgba_write_enabled[0])
-                    source_color.r = frame & 0xFF;
-                if (!ctx.rgba_write_enabled[1])
-                    source_color.g = (frame >> 8) & 0xFF;
-                if (!ctx.rgba_write_enabled[2])
-                    source_color.b = (frame >> 16) & 0xFF;
-                if (!ctx.rgba_write_enabled[3])
-                    source_color.a = frame >> 24;
+    blend_fragment(source_color, frame_color);
 
-                uint32_t final_color = 0;
+    if (!ctx.rgba_write_enabled[0])
+        source_color.r = frame & 0xFF;
+    if (!ctx.rgba_write_enabled[1])
+        source_color.g = (frame >> 8) & 0xFF;
+    if (!ctx.rgba_write_enabled[2])
+        source_color.b = (frame >> 16) & 0xFF;
+    if (!ctx.rgba_write_enabled[3])
+        source_color.a = frame >> 24;
 
-                switch (ctx.color_format)
-                {
-                    case 0:
-                        final_color = source_color.r | (source_color.g << 8) | (source_color.b << 16) | (source_color.a << 24);
-                        e->arm11_write32(0, frame_addr, bswp32(final_color));
-                        break;
-                    case 1:
-                        e->arm11_write8(0, frame_addr + 2, source_color.r);
-                        e->arm11_write8(0, frame_addr + 1, source_color.g);
-                        e->arm11_write8(0, frame_addr, source_color.b);
-                        break;
-                    case 2:
-                        final_color = Convert8To5(source_color.r) << 11;
-                        final_color |= Convert8To5(source_color.g) << 6;
-                        final_color |= Convert8To5(source_color.b) << 1;
-                        final_color |= Convert8To1(source_color.a);
-                        e->arm11_write16(0, frame_addr, final_color);
-                        break;
-                    case 3:
-                        final_color = Convert8To5(source_color.r) << 11;
-                        final_color |= Convert8To6(source_color.g) << 5;
-                        final_color |= Convert8To5(source_color.b);
-                        e->arm11_write16(0, frame_addr, final_color);
-                        break;
-                    case 4:
-                        final_color = Convert8To4(source_color.r) << 12;
-                        final_color |= Convert8To4(source_color.g) << 8;
-                        final_color |= Convert8To4(source_color.b) << 4;
-                        final_color |= Convert8To4(source_color.a);
-                        e->arm11_write16(0, frame_addr, final_color);
-                        break;
-                }
-            }
-            /*w1 += w1_dx;
-            w2 += w2_dx;
-            w3 += w3_dx;*/
-        }
-        /*w1_row += w1_dy;
-        w2_row += w2_dy;
-        w3_row += w3_dy;*/
-    }
+    store_color(color_ptr, ctx.color_format, source_color);
 }
 
 void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &vtx)
@@ -1957,7 +2446,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
     tex_color.a = 0;
 
     //TODO: A NULL/disabled texture should return the most recently rendered fragment color
-    if (!ctx.tex_enable[index] || !ctx.tex_addr[index])
+    if (!tex_unit_samples(index))
         return;
 
     int height = ctx.tex_height[index];
@@ -2001,7 +2490,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
             v = std::min(height - 1, v);
             break;
         case 1:
-            if (v < 0 || v >= width)
+            if (v < 0 || v >= height)
             {
                 tex_color = ctx.tex_border[index];
                 return;
@@ -2026,15 +2515,48 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
     //Texcoords are vertically flipped
     v = ctx.tex_height[index] - 1 - v;
 
-    uint32_t addr = ctx.tex_addr[index];
+    const uint32_t* texels = ctx.tex_texels[index];
+    if (texels)
+    {
+        uint32_t texel = texels[u + (v * width)];
+        tex_color.r = texel & 0xFF;
+        tex_color.g = (texel >> 8) & 0xFF;
+        tex_color.b = (texel >> 16) & 0xFF;
+        tex_color.a = texel >> 24;
+        return;
+    }
+
+    decode_texel(ctx.tex_data[index], ctx.tex_type[index], width, u, v, tex_color);
+}
+
+//Decodes a whole texture, row by row from v = 0, with red in the low byte
+void GPU::decode_texture(int index, uint32_t* texels)
+{
+    uint32_t width = ctx.tex_width[index];
+    uint32_t height = ctx.tex_height[index];
+    for (uint32_t v = 0; v < height; v++)
+    {
+        for (uint32_t u = 0; u < width; u++)
+        {
+            RGBA_Color color = {0, 0, 0, 0};
+            decode_texel(ctx.tex_data[index], ctx.tex_type[index], width, u, v, color);
+            texels[u + (v * width)] = color.r | (color.g << 8) | (color.b << 16) | ((uint32_t)color.a << 24);
+        }
+    }
+}
+
+//Leaves the components a format doesn't have untouched
+void GPU::decode_texel(const uint8_t* tex, uint8_t format, uint32_t width, int u, int v, RGBA_Color& tex_color)
+{
+    uint32_t addr = 0;
     uint32_t texel;
 
-    switch (ctx.tex_type[index])
+    switch (format)
     {
         case 0x0:
             //RGBA8888
             addr = get_swizzled_tile_addr(addr, width, u, v, 4);
-            texel = bswp32(e->arm11_read32(0, addr));
+            texel = bswp32(*(uint32_t*)&tex[addr]);
 
             tex_color.r = texel & 0xFF;
             tex_color.g = (texel >> 8) & 0xFF;
@@ -2044,15 +2566,15 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
         case 0x1:
             //RGB888
             addr = get_swizzled_tile_addr(addr, width, u, v, 3);
-            tex_color.r = e->arm11_read8(0, addr + 2);
-            tex_color.g = e->arm11_read8(0, addr + 1);
-            tex_color.b = e->arm11_read8(0, addr);
+            tex_color.r = tex[addr + 2];
+            tex_color.g = tex[addr + 1];
+            tex_color.b = tex[addr];
             tex_color.a = 0xFF;
             break;
         case 0x2:
             //RGB5A1
             addr = get_swizzled_tile_addr(addr, width, u, v, 2);
-            texel = e->arm11_read16(0, addr);
+            texel = *(uint16_t*)&tex[addr];
 
             //TODO: When alpha is disabled, it should be 0xFF
             tex_color.r = Convert5To8((texel >> 11) & 0x1F);
@@ -2063,7 +2585,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
         case 0x3:
             //RGB565
             addr = get_swizzled_tile_addr(addr, width, u, v, 2);
-            texel = e->arm11_read16(0, addr);
+            texel = *(uint16_t*)&tex[addr];
 
             tex_color.r = Convert5To8((texel >> 11) & 0x1F);
             tex_color.g = Convert6To8((texel >> 5) & 0x3F);
@@ -2073,7 +2595,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
         case 0x4:
             //RGBA4444
             addr = get_swizzled_tile_addr(addr, width, u, v, 2);
-            texel = e->arm11_read16(0, addr);
+            texel = *(uint16_t*)&tex[addr];
 
             tex_color.r = Convert4To8((texel >> 12) & 0xF);
             tex_color.g = Convert4To8((texel >> 8) & 0xF);
@@ -2083,7 +2605,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
         case 0x5:
             //IA8
             addr = get_swizzled_tile_addr(addr, width, u, v, 2);
-            texel = e->arm11_read16(0, addr);
+            texel = *(uint16_t*)&tex[addr];
 
             //TODO: When alpha is disabled, R should be intensity and G should be alpha
             tex_color.r = texel >> 8;
@@ -2094,7 +2616,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
         case 0x6:
             //RG8/HILO
             addr = get_swizzled_tile_addr(addr, width, u, v, 2);
-            texel = e->arm11_read16(0, addr);
+            texel = *(uint16_t*)&tex[addr];
 
             tex_color.r = texel >> 8;
             tex_color.g = texel & 0xFF;
@@ -2104,7 +2626,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
         case 0x7:
             //I8
             addr = get_swizzled_tile_addr(addr, width, u, v, 1);
-            texel = e->arm11_read8(0, addr);
+            texel = tex[addr];
 
             tex_color.r = texel;
             tex_color.g = texel;
@@ -2114,7 +2636,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
         case 0x8:
             //A8
             addr = get_swizzled_tile_addr(addr, width, u, v, 1);
-            texel = e->arm11_read8(0, addr);
+            texel = tex[addr];
 
             tex_color.a = texel;
             break;
@@ -2122,7 +2644,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
             //IA4
         {
             addr = get_swizzled_tile_addr(addr, width, u, v, 1);
-            texel = e->arm11_read8(0, addr);
+            texel = tex[addr];
             uint8_t i = Convert4To8(texel >> 4);
             uint8_t a = Convert4To8(texel & 0xF);
 
@@ -2137,9 +2659,9 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
             //I4
             addr = get_4bit_swizzled_addr(addr, width, u, v);
             if (u & 0x1)
-                texel = e->arm11_read8(0, addr) >> 4;
+                texel = tex[addr] >> 4;
             else
-                texel = e->arm11_read8(0, addr) & 0xF;
+                texel = tex[addr] & 0xF;
 
             tex_color.r = Convert4To8(texel);
             tex_color.g = Convert4To8(texel);
@@ -2150,9 +2672,9 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
             //A4
             addr = get_4bit_swizzled_addr(addr, width, u, v);
             if (u & 0x1)
-                texel = e->arm11_read8(0, addr) >> 4;
+                texel = tex[addr] >> 4;
             else
-                texel = e->arm11_read8(0, addr) & 0xF;
+                texel = tex[addr] & 0xF;
 
             tex_color.a = Convert4To8(texel);
             break;
@@ -2160,7 +2682,7 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
         case 0xD:
             //ETC1/ETC1A4
         {
-            bool has_alpha = ctx.tex_type[index] & 0x1;
+            bool has_alpha = format & 0x1;
 
             //Get the tile we're on
             uint32_t offs = ((u & ~0x7) * 8) + ((v & ~0x7) * width);
@@ -2177,8 +2699,8 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
 
             if (has_alpha)
             {
-                uint64_t alpha_data = e->arm11_read32(0, addr);
-                alpha_data |= (uint64_t)e->arm11_read32(0, addr + 4) << 32ULL;
+                uint64_t alpha_data = *(uint32_t*)&tex[addr];
+                alpha_data |= (uint64_t)*(uint32_t*)&tex[addr + 4] << 32ULL;
 
                 addr += 8;
                 tex_color.a = (alpha_data >> (4 * (u * 4 + v))) & 0xF;
@@ -2187,13 +2709,13 @@ void GPU::tex_lookup(int index, int coord_index, RGBA_Color &tex_color, Vertex &
             else
                 tex_color.a = 0xFF;
 
-            uint64_t data = e->arm11_read32(0, addr);
-            data |= (uint64_t)e->arm11_read32(0, addr + 4) << 32ULL;
+            uint64_t data = *(uint32_t*)&tex[addr];
+            data |= (uint64_t)*(uint32_t*)&tex[addr + 4] << 32ULL;
             decode_etc1(tex_color, u, v, data);
         }
             break;
         default:
-            EmuException::die("[GPU] Unrecognized tex format $%02X\n", ctx.tex_type[index]);
+            EmuException::die("[GPU] Unrecognized tex format $%02X\n", format);
     }
 }
 
@@ -2943,7 +3465,7 @@ void GPU::do_logic_op(RGBA_Color &source, RGBA_Color &frame)
     }
 }
 
-void GPU::update_stencil(uint32_t addr, uint8_t old, uint8_t ref, uint8_t func)
+void GPU::update_stencil(uint8_t* ptr, uint8_t old, uint8_t ref, uint8_t func)
 {
     uint8_t new_stencil = 0;
     switch (func)
@@ -2989,7 +3511,7 @@ void GPU::update_stencil(uint32_t addr, uint8_t old, uint8_t ref, uint8_t func)
     }
 
     if (ctx.allow_stencil_depth_write & 0x1)
-        e->arm11_write8(0, addr + 3, (new_stencil & ctx.stencil_write_mask) | (old & ~ctx.stencil_write_mask));
+        ptr[3] = (new_stencil & ctx.stencil_write_mask) | (old & ~ctx.stencil_write_mask);
 }
 
 void GPU::exec_shader(ShaderUnit& sh)
@@ -3022,118 +3544,35 @@ void GPU::exec_shader(ShaderUnit& sh)
     sh.if_ptr = 0;
     sh.pc = sh.entry_point * 4;
 
+    ShaderProgram* program = nullptr;
+    if (shader_jit_enabled)
+    {
+        //Only safe to flush here, while neither shader unit is running
+        if (shader_jit.needs_flush())
+        {
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Shader JIT full, flushing\n");
+            shader_jit.reset();
+            ctx.vsh.jit_program = nullptr;
+            ctx.gsh.jit_program = nullptr;
+        }
+
+        if (!sh.jit_program)
+            sh.jit_program = shader_jit.get_program(sh);
+        program = sh.jit_program;
+    }
+
     bool ended = false;
     while (!ended)
     {
-        uint32_t instr = *(uint32_t*)&sh.code[sh.pc];
-        //printf("[GPU] [$%04X] $%08X\n", sh.pc, instr);
-        sh.pc += 4;
+        //Blocks never span a pc the stacks below are waiting on, so checking them after the block is enough
+        ShaderBlockFunc block = nullptr;
+        if (program)
+            block = shader_jit.get_block(*program, sh.pc);
 
-        switch (instr >> 26)
-        {
-            case 0x00:
-                shader_add(sh, instr);
-                break;
-            case 0x01:
-                shader_dp3(sh, instr);
-                break;
-            case 0x02:
-                shader_dp4(sh, instr);
-                break;
-            case 0x03:
-                shader_dph(sh, instr);
-                break;
-            case 0x08:
-                shader_mul(sh, instr);
-                break;
-            case 0x0C:
-                shader_max(sh, instr);
-                break;
-            case 0x0E:
-                shader_rcp(sh, instr);
-                break;
-            case 0x0F:
-                shader_rsq(sh, instr);
-                break;
-            case 0x12:
-                shader_mova(sh, instr);
-                break;
-            case 0x13:
-                shader_mov(sh, instr);
-                break;
-            case 0x1B:
-                shader_slti(sh, instr);
-                break;
-            case 0x20:
-                shader_break(sh, instr);
-                break;
-            case 0x21:
-                //NOP
-                break;
-            case 0x22:
-                ended = true;
-                break;
-            case 0x23:
-                shader_breakc(sh, instr);
-                break;
-            case 0x24:
-                shader_call(sh, instr);
-                break;
-            case 0x25:
-                shader_callc(sh, instr);
-                break;
-            case 0x26:
-                shader_callu(sh, instr);
-                break;
-            case 0x27:
-                shader_ifu(sh, instr);
-                break;
-            case 0x28:
-                shader_ifc(sh, instr);
-                break;
-            case 0x29:
-                shader_loop(sh, instr);
-                break;
-            case 0x2A:
-                shader_emit(sh, instr);
-                break;
-            case 0x2B:
-                shader_setemit(sh, instr);
-                break;
-            case 0x2C:
-                shader_jmpc(sh, instr);
-                break;
-            case 0x2D:
-                shader_jmpu(sh, instr);
-                break;
-            case 0x2E:
-            case 0x2F:
-                shader_cmp(sh, instr);
-                break;
-            case 0x30:
-            case 0x31:
-            case 0x32:
-            case 0x33:
-            case 0x34:
-            case 0x35:
-            case 0x36:
-            case 0x37:
-                shader_madi(sh, instr);
-                break;
-            case 0x38:
-            case 0x39:
-            case 0x3A:
-            case 0x3B:
-            case 0x3C:
-            case 0x3D:
-            case 0x3E:
-            case 0x3F:
-                shader_mad(sh, instr);
-                break;
-            default:
-                EmuException::die("[GPU] Unrecognized shader opcode $%02X (instr:$%08X pc:$%04X)",
-                                  instr >> 26, instr, sh.pc - 4);
-        }
+        if (block)
+            sh.pc = block(&sh);
+        else
+            ended = exec_shader_instr(sh);
 
         if (sh.loop_ptr > 0)
         {
@@ -3177,13 +3616,125 @@ void GPU::exec_shader(ShaderUnit& sh)
     }*/
 }
 
-Vec4<float24> GPU::swizzle_sh_src(Vec4<float24> src, uint32_t op_desc, int src_type)
+//Interprets the instruction at pc, returning true if it ends the program
+bool GPU::exec_shader_instr(ShaderUnit &sh)
+{
+    uint32_t instr = *(uint32_t*)&sh.code[sh.pc];
+    //printf("[GPU] [$%04X] $%08X\n", sh.pc, instr);
+    sh.pc += 4;
+
+    switch (instr >> 26)
+    {
+        case 0x00:
+            shader_add(sh, instr);
+            break;
+        case 0x01:
+            shader_dp3(sh, instr);
+            break;
+        case 0x02:
+            shader_dp4(sh, instr);
+            break;
+        case 0x03:
+            shader_dph(sh, instr);
+            break;
+        case 0x08:
+            shader_mul(sh, instr);
+            break;
+        case 0x0C:
+            shader_max(sh, instr);
+            break;
+        case 0x0E:
+            shader_rcp(sh, instr);
+            break;
+        case 0x0F:
+            shader_rsq(sh, instr);
+            break;
+        case 0x12:
+            shader_mova(sh, instr);
+            break;
+        case 0x13:
+            shader_mov(sh, instr);
+            break;
+        case 0x1B:
+            shader_slti(sh, instr);
+            break;
+        case 0x20:
+            shader_break(sh, instr);
+            break;
+        case 0x21:
+            //NOP
+            break;
+        case 0x22:
+            return true;
+        case 0x23:
+            shader_breakc(sh, instr);
+            break;
+        case 0x24:
+            shader_call(sh, instr);
+            break;
+        case 0x25:
+            shader_callc(sh, instr);
+            break;
+        case 0x26:
+            shader_callu(sh, instr);
+            break;
+        case 0x27:
+            shader_ifu(sh, instr);
+            break;
+        case 0x28:
+            shader_ifc(sh, instr);
+            break;
+        case 0x29:
+            shader_loop(sh, instr);
+            break;
+        case 0x2A:
+            shader_emit(sh, instr);
+            break;
+        case 0x2B:
+            shader_setemit(sh, instr);
+            break;
+        case 0x2C:
+            shader_jmpc(sh, instr);
+            break;
+        case 0x2D:
+            shader_jmpu(sh, instr);
+            break;
+        case 0x2E:
+        case 0x2F:
+            shader_cmp(sh, instr);
+            break;
+        case 0x30:
+        case 0x31:
+        case 0x32:
+        case 0x33:
+        case 0x34:
+        case 0x35:
+        case 0x36:
+        case 0x37:
+            shader_madi(sh, instr);
+            break;
+        case 0x38:
+        case 0x39:
+        case 0x3A:
+        case 0x3B:
+        case 0x3C:
+        case 0x3D:
+        case 0x3E:
+        case 0x3F:
+            shader_mad(sh, instr);
+            break;
+        default:
+            EmuException::die("[GPU] Unrecognized shader opcode $%02X (instr:$%08X pc:$%04X)",
+                              instr >> 26, instr, sh.pc - 4);
+    }
+    return false;
+}
+
+Float24x4 GPU::swizzle_sh_src(const Vec4<float24>& src, uint32_t op_desc, int src_type)
 {
     bool negate;
     uint8_t compsel;
 
-    Vec4<float24> result;
-
     switch (src_type)
     {
         case 1:
@@ -3202,19 +3753,10 @@ Vec4<float24> GPU::swizzle_sh_src(Vec4<float24> src, uint32_t op_desc, int src_t
             EmuException::die("[GPU] Unrecognized src_type %d in swizzle_sh_src", src_type);
     }
 
-    for (int i = 0; i < 4; i++)
-    {
-        int comp = (compsel >> (i * 2)) & 0x3;
-        result[3 - i] = src[comp];
-
-        if (negate)
-            result[3 - i] = -result[3 - i];
-    }
-
-    return result;
+    return Float24x4::load(src).swizzle(compsel, negate);
 }
 
-Vec4<float24> GPU::get_src(ShaderUnit& sh, uint8_t src)
+Vec4<float24>& GPU::get_src(ShaderUnit& sh, uint8_t src)
 {
     if (src < 0x10)
         return sh.input_regs[src];
@@ -3244,13 +3786,16 @@ int GPU::get_idx1(ShaderUnit& sh, uint8_t idx1, uint8_t src1)
     }
 }
 
-void GPU::set_sh_dest(ShaderUnit &sh, uint8_t dst, float24 value, int index)
+void GPU::set_sh_dest(ShaderUnit &sh, uint8_t dst, Float24x4 value, uint8_t dest_mask)
 {
-    //printf("[GPU] Setting sh reg $%02X:%d to %f\n", dst, index, value.ToFloat32());
+    //printf("[GPU] Setting sh reg $%02X:%X to %f\n", dst, dest_mask, value[0].ToFloat32());
+    if (!dest_mask)
+        return;
+
     if (dst < 0x7)
-        sh.output_regs[dst][index] = value;
+        value.store(sh.output_regs[dst], dest_mask);
     else if (dst >= 0x10 && dst < 0x20)
-        sh.temp_regs[dst - 0x10][index] = value;
+        value.store(sh.temp_regs[dst - 0x10], dest_mask);
     else
         EmuException::die("[GPU] Unrecognized dst $%02X in set_sh_dest", dst);
 }
@@ -3297,16 +3842,12 @@ void GPU::shader_add(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[2];
+    Float24x4 src[2];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-            set_sh_dest(sh, dest, src[0][3 - i] + src[1][3 - i], 3 - i);
-    }
+    set_sh_dest(sh, dest, src[0] + src[1], dest_mask);
 }
 
 void GPU::shader_dp3(ShaderUnit &sh, uint32_t instr)
@@ -3324,21 +3865,14 @@ void GPU::shader_dp3(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[2];
+    Float24x4 src[2];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
 
-    float24 dot_product = float24::FromFloat32(0.0f);
+    float24 dot_product = src[0].dot(src[1], 3);
 
-    for (int i = 0; i < 3; i++)
-        dot_product += src[0][i] * src[1][i];
-
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-            set_sh_dest(sh, dest, dot_product, 3 - i);
-    }
+    set_sh_dest(sh, dest, Float24x4::splat(dot_product), dest_mask);
 }
 
 void GPU::shader_dp4(ShaderUnit &sh, uint32_t instr)
@@ -3356,18 +3890,14 @@ void GPU::shader_dp4(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[2];
+    Float24x4 src[2];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
 
-    float24 dot_product = dp4(src[0], src[1]);
+    float24 dot_product = src[0].dot(src[1], 4);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-            set_sh_dest(sh, dest, dot_product, 3 - i);
-    }
+    set_sh_dest(sh, dest, Float24x4::splat(dot_product), dest_mask);
 }
 
 void GPU::shader_dph(ShaderUnit &sh, uint32_t instr)
@@ -3385,20 +3915,16 @@ void GPU::shader_dph(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[2];
+    Float24x4 src[2];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
 
-    src[0][3] = float24::FromFloat32(1.0);
+    src[0] = src[0].with_w(float24::FromFloat32(1.0));
 
-    float24 dot_product = dp4(src[0], src[1]);
+    float24 dot_product = src[0].dot(src[1], 4);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-            set_sh_dest(sh, dest, dot_product, 3 - i);
-    }
+    set_sh_dest(sh, dest, Float24x4::splat(dot_product), dest_mask);
 }
 
 void GPU::shader_mul(ShaderUnit &sh, uint32_t instr)
@@ -3416,16 +3942,12 @@ void GPU::shader_mul(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[2];
+    Float24x4 src[2];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-            set_sh_dest(sh, dest, src[0][3 - i] * src[1][3 - i], 3 - i);
-    }
+    set_sh_dest(sh, dest, src[0] * src[1], dest_mask);
 }
 
 void GPU::shader_max(ShaderUnit &sh, uint32_t instr)
@@ -3443,21 +3965,12 @@ void GPU::shader_max(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[2];
+    Float24x4 src[2];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-        {
-            float24 a = src[0][3 - i];
-            float24 b = src[1][3 - i];
-            float24 value = (a > b) ? a : b;
-            set_sh_dest(sh, dest, value, 3 - i);
-        }
-    }
+    set_sh_dest(sh, dest, src[0].max(src[1]), dest_mask);
 }
 
 void GPU::shader_rcp(ShaderUnit& sh, uint32_t instr)
@@ -3474,19 +3987,12 @@ void GPU::shader_rcp(ShaderUnit& sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src = get_src(sh, src1);
-    src = swizzle_sh_src(src, op_desc, 1);
+    Float24x4 src = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
 
     float24 value = src[0];
     value = float24::FromFloat32(1.0f) / value;
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-        {
-            set_sh_dest(sh, dest, value, 3 - i);
-        }
-    }
+    set_sh_dest(sh, dest, Float24x4::splat(value), dest_mask);
 }
 
 void GPU::shader_rsq(ShaderUnit& sh, uint32_t instr)
@@ -3503,19 +4009,12 @@ void GPU::shader_rsq(ShaderUnit& sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src = get_src(sh, src1);
-    src = swizzle_sh_src(src, op_desc, 1);
+    Float24x4 src = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
 
     float24 value = float24::FromFloat32(sqrtf(src[0].ToFloat32()));
     value = float24::FromFloat32(1.0f) / value;
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-        {
-            set_sh_dest(sh, dest, value, 3 - i);
-        }
-    }
+    set_sh_dest(sh, dest, Float24x4::splat(value), dest_mask);
 }
 
 void GPU::shader_mova(ShaderUnit &sh, uint32_t instr)
@@ -3531,8 +4030,7 @@ void GPU::shader_mova(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src = get_src(sh, src1);
-    src = swizzle_sh_src(src, op_desc, 1);
+    Float24x4 src = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
 
     if (dest_mask & (1 << 3))
         sh.addr_reg[0] = src[0];
@@ -3555,16 +4053,9 @@ void GPU::shader_mov(ShaderUnit& sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src = get_src(sh, src1);
-    src = swizzle_sh_src(src, op_desc, 1);
+    Float24x4 src = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-        {
-            set_sh_dest(sh, dest, src[3 - i], 3 - i);
-        }
-    }
+    set_sh_dest(sh, dest, src, dest_mask);
 }
 
 void GPU::shader_slti(ShaderUnit &sh, uint32_t instr)
@@ -3582,24 +4073,12 @@ void GPU::shader_slti(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[2];
+    Float24x4 src[2];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-        {
-            float24 value;
-            if (src[0][3 - i].ToFloat32() < src[1][3 - i].ToFloat32())
-                value = float24::FromFloat32(1.0);
-            else
-                value = float24::Zero();
-
-            set_sh_dest(sh, dest, value, 3 - i);
-        }
-    }
+    set_sh_dest(sh, dest, src[0].less_than(src[1]), dest_mask);
 }
 
 void GPU::shader_break(ShaderUnit &sh, uint32_t instr)
@@ -3785,7 +4264,7 @@ void GPU::shader_cmp(ShaderUnit &sh, uint32_t instr)
 
     src1 += idx1;
 
-    Vec4<float24> src[2];
+    Float24x4 src[2];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
@@ -3796,26 +4275,29 @@ void GPU::shader_cmp(ShaderUnit &sh, uint32_t instr)
 
     for (int i = 0; i < 2; i++)
     {
-        //printf("[GPU] Comparing %f to %f\n", src[0][i].ToFloat32(), src[1][i].ToFloat32());
+        float24 a = src[0][i];
+        float24 b = src[1][i];
+
+        //printf("[GPU] Comparing %f to %f\n", a.ToFloat32(), b.ToFloat32());
         switch (cmp_ops[i])
         {
             case 0:
-                sh.cmp_regs[i] = src[0][i] == src[1][i];
+                sh.cmp_regs[i] = a == b;
                 break;
             case 1:
-                sh.cmp_regs[i] = src[0][i] != src[1][i];
+                sh.cmp_regs[i] = a != b;
                 break;
             case 2:
-                sh.cmp_regs[i] = src[0][i] < src[1][i];
+                sh.cmp_regs[i] = a < b;
                 break;
             case 3:
-                sh.cmp_regs[i] = src[0][i] <= src[1][i];
+                sh.cmp_regs[i] = a <= b;
                 break;
             case 4:
-                sh.cmp_regs[i] = src[0][i] > src[1][i];
+                sh.cmp_regs[i] = a > b;
                 break;
             case 5:
-                sh.cmp_regs[i] = src[0][i] >= src[1][i];
+                sh.cmp_regs[i] = a >= b;
                 break;
             default:
                 EmuException::die("[GPU] Unrecognized sh CMP op $%02X", cmp_ops[i]);
@@ -3841,20 +4323,13 @@ void GPU::shader_madi(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[3];
+    Float24x4 src[3];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
     src[2] = swizzle_sh_src(get_src(sh, src3), op_desc, 3);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-        {
-            float24 value = src[2][3 - i] + (src[1][3 - i] * src[0][3 - i]);
-            set_sh_dest(sh, dest, value, 3 - i);
-        }
-    }
+    set_sh_dest(sh, dest, src[2] + (src[1] * src[0]), dest_mask);
 }
 
 void GPU::shader_mad(ShaderUnit &sh, uint32_t instr)
@@ -3873,20 +4348,13 @@ void GPU::shader_mad(ShaderUnit &sh, uint32_t instr)
 
     uint8_t dest_mask = op_desc & 0xF;
 
-    Vec4<float24> src[3];
+    Float24x4 src[3];
 
     src[0] = swizzle_sh_src(get_src(sh, src1), op_desc, 1);
     src[1] = swizzle_sh_src(get_src(sh, src2), op_desc, 2);
     src[2] = swizzle_sh_src(get_src(sh, src3), op_desc, 3);
 
-    for (int i = 0; i < 4; i++)
-    {
-        if (dest_mask & (1 << i))
-        {
-            float24 value = src[2][3 - i] + (src[1][3 - i] * src[0][3 - i]);
-            set_sh_dest(sh, dest, value, 3 - i);
-        }
-    }
+    set_sh_dest(sh, dest, src[2] + (src[1] * src[0]), dest_mask);
 }
 
 uint32_t GPU::read32(uint32_t addr)
@@ -3920,7 +4388,7 @@ uint32_t GPU::read32(uint32_t addr)
         case 0x18F0:
             return cmd_engine_busy;
     }
-    printf("[GPU] Unrecognized read32 $%08X\n", addr);
+    LOG(LOG_GPU, LOG_WARN, "[GPU] Unrecognized read32 $%08X\n", addr);
     return 0;
 }
 
@@ -3950,13 +4418,12 @@ void GPU::write32(uint32_t addr, uint32_t value)
                 //Perform memory transfer
                 if (value & 0x1)
                 {
-                    printf("[GPU] Start memfill%d\n", index);
+                    LOG(LOG_GPU, LOG_DEBUG, "[GPU] Start memfill%d\n", index);
                     memfill[index].busy = true;
 
                     //TODO: How long does a memfill take? We just assume a constant value for now
                     uint32_t cycles = memfill[index].end - memfill[index].start;
-                    scheduler->add_event([this](uint64_t param) { this->do_memfill(param);}, cycles,
-                            ARM11_CLOCKRATE, index);
+                    scheduler->add_event(memfill_event, cycles, ARM11_CLOCKRATE, index);
                 }
                 break;
         }
@@ -3976,16 +4443,16 @@ void GPU::write32(uint32_t addr, uint32_t value)
     {
         case 0x0C00:
             dma.input_addr = value << 3;
-            printf("[GPU] DMA input addr: $%08X\n", dma.input_addr);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] DMA input addr: $%08X\n", dma.input_addr);
             break;
         case 0x0C04:
             dma.output_addr = value << 3;
-            printf("[GPU] DMA output addr: $%08X\n", dma.output_addr);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] DMA output addr: $%08X\n", dma.output_addr);
             break;
         case 0x0C08:
             dma.disp_output_width = value & 0xFFFF;
             dma.disp_output_height = value >> 16;
-            printf("[GPU] DMA output width/height: $%08X\n", value);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] DMA output width/height: $%08X\n", value);
             break;
         case 0x0C0C:
             dma.disp_input_width = value & 0xFFFF;
@@ -3993,30 +4460,29 @@ void GPU::write32(uint32_t addr, uint32_t value)
             break;
         case 0x0C10:
             dma.flags = value;
-            printf("[GPU] DMA flags: $%08X\n", dma.flags);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] DMA flags: $%08X\n", dma.flags);
             break;
         case 0x0C18:
             if (value & 0x1)
             {
                 dma.busy = true;
                 dma.finished = false;
-                scheduler->add_event([this](uint64_t param) { this->do_transfer_engine_dma(param);},
-                    1000, ARM11_CLOCKRATE);
+                scheduler->add_event(transfer_engine_event, 1000, ARM11_CLOCKRATE);
             }
             break;
         case 0x0C20:
             dma.tc_size = value;
-            printf("[GPU] TexCopy size: $%08X\n", dma.tc_size);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] TexCopy size: $%08X\n", dma.tc_size);
             break;
         case 0x0C24:
             dma.tc_input_width = (value & 0xFFFF) * 16;
             dma.tc_input_gap = (value >> 16) * 16;
-            printf("[GPU] TexCopy input width/gap: $%08X $%08X\n", dma.tc_input_width, dma.tc_input_gap);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] TexCopy input width/gap: $%08X $%08X\n", dma.tc_input_width, dma.tc_input_gap);
             break;
         case 0x0C28:
             dma.tc_output_width = (value & 0xFFFF) * 16;
             dma.tc_output_gap = (value >> 16) * 16;
-            printf("[GPU] TexCopy output width/gap: $%08X $%08X\n", dma.tc_output_width, dma.tc_output_gap);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] TexCopy output width/gap: $%08X $%08X\n", dma.tc_output_width, dma.tc_output_gap);
             break;
         case 0x18E0:
             //Here, size is in units of words
@@ -4032,7 +4498,7 @@ void GPU::write32(uint32_t addr, uint32_t value)
                 start_command_engine_dma(0);
             break;
         default:
-            printf("[GPU] Unrecognized write32 $%08X: $%08X\n", addr, value);
+            LOG(LOG_GPU, LOG_WARN, "[GPU] Unrecognized write32 $%08X: $%08X\n", addr, value);
     }
 }
 
@@ -4057,7 +4523,7 @@ uint32_t GPU::read32_fb(int index, uint32_t addr)
         case 0x98:
             return fb->right_addr_b;
         default:
-            printf("[GPU] Unrecognized read32 fb%d addr $%08X\n", index, addr);
+            LOG(LOG_GPU, LOG_WARN, "[GPU] Unrecognized read32 fb%d addr $%08X\n", index, addr);
             return 0;
     }
 }
@@ -4069,35 +4535,35 @@ void GPU::write32_fb(int index, uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x68:
-            printf("[GPU] Write fb%d left addr A: $%08X\n", index, value);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write fb%d left addr A: $%08X\n", index, value);
             fb->left_addr_a = value;
             return;
         case 0x6C:
-            printf("[GPU] Write fb%d left addr B: $%08X\n", index, value);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write fb%d left addr B: $%08X\n", index, value);
             fb->left_addr_b = value;
             return;
         case 0x70:
-            printf("[GPU] Write fb%d color format: $%08X\n", index, value);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write fb%d color format: $%08X\n", index, value);
             fb->color_format = value & 0x7;
             return;
         case 0x78:
-            printf("[GPU] Write fb%d buffer select: $%08X\n", index, value);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write fb%d buffer select: $%08X\n", index, value);
             fb->buffer_select = value & 0x1;
             return;
         case 0x90:
-            printf("[GPU] Write fb%d stride: $%08X\n", index, value);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write fb%d stride: $%08X\n", index, value);
             fb->stride = value;
             return;
         case 0x94:
-            printf("[GPU] Write fb%d right addr A: $%08X\n", index, value);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write fb%d right addr A: $%08X\n", index, value);
             fb->right_addr_a = value;
             return;
         case 0x98:
-            printf("[GPU] Write fb%d right addr B: $%08X\n", index, value);
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write fb%d right addr B: $%08X\n", index, value);
             fb->right_addr_b = value;
             return;
         default:
-            printf("[GPU] Unrecognized write32 fb%d addr $%08X: $%08X\n", index, addr, value);
+            LOG(LOG_GPU, LOG_WARN, "[GPU] Unrecognized write32 fb%d addr $%08X: $%08X\n", index, addr, value);
     }
 }
 
@@ -4118,7 +4584,7 @@ void GPU::set_lcd_init(bool init)
 
 void GPU::set_screenfill(int index, uint32_t value)
 {
-    printf("[GPU] Set screenfill%d: $%08X\n", index, value);
+    LOG(LOG_GPU, LOG_DEBUG, "[GPU] Set screenfill%d: $%08X\n", index, value);
     framebuffers[index].screenfill_color = value & 0xFFFFFF;
     framebuffers[index].screenfill_enabled = (value >> 24) & 0x1;
 }
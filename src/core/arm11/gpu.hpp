@@ -1,7 +1,13 @@
 #ifndef GPU_HPP
 #define GPU_HPP
 #include <cstdint>
+#include <unordered_map>
+#include <vector>
 #include "gpu_floats.hpp"
+#include "gpu_raster.hpp"
+#include "gpu_simd.hpp"
+#include "gpu_thread_pool.hpp"
+#include "shader_jit.hpp"
 #include "vector_math.hpp"
 
 struct RGBA_Color
@@ -87,6 +93,9 @@ struct ShaderUnit
     uint32_t op_desc_index;
     uint32_t op_desc[128];
 
+    //Compiled form of code and op_desc, or null if either has changed since it was looked up
+    ShaderProgram* jit_program;
+
     uint16_t loop_cmp_stack[4];
     uint16_t loop_stack[4];
     uint8_t loop_iter_stack[4];
@@ -155,6 +164,79 @@ struct Vertex
     }
 };
 
+//Converts one attribute of a vertex to a Vec4, filling in missing components as (0, 0, 0, 1)
+typedef void (*AttributeLoader)(Vec4<float24>& dest, const uint8_t* src);
+
+struct AttributeFetch
+{
+    AttributeLoader load;
+    uint32_t offset;
+    uint8_t buffer;
+    uint8_t attr;
+};
+
+//The attribute buffer registers, worked out once per draw into what each vertex reads and from where
+struct VertexLayout
+{
+    AttributeFetch fetches[16];
+    int total_fetches;
+
+    int total_buffers;
+    uint32_t buffer_addr[12];
+    uint32_t buffer_stride[12];
+    uint32_t buffer_bytes[12];
+
+    //Host memory for the first vertex the draw uses, or null if a buffer has to be read through the bus
+    uint8_t* buffer_ptr[12];
+};
+
+//Vertex shader outputs kept for an index during an indexed draw, as the post-transform cache on hardware does
+struct VertexCacheEntry
+{
+    uint32_t index;
+    Vec4<float24> outputs[7];
+};
+
+//Counted over the last indexed draw
+struct VertexCacheStats
+{
+    uint32_t hits;
+    uint32_t misses;
+};
+
+//A texture decoded to RGBA8 with red in the low byte, indexed by u + v * width with v already flipped
+struct TextureCacheEntry
+{
+    uint32_t addr;
+    uint32_t size;
+    uint64_t hash;
+
+    //The command list the hash was last checked in. 0 once the texture has been drawn over.
+    uint32_t epoch;
+    std::vector<uint32_t> texels;
+};
+
+//An attribute across a triangle: origin + x * dx + y * dy, with x and y in whole pixels from the top left of the
+//bounding box. Attributes other than z are divided by w, so they're linear across the screen.
+struct AttributePlane
+{
+    float origin, dx, dy;
+};
+
+//A triangle after setup, waiting in the bins to be drawn. Coordinates are in 1/16 pixels.
+struct RasterTri
+{
+    int32_t min_x, min_y, max_x, max_y;
+    EdgeFunctions edges;
+
+    //Only the attributes the texture units and combiners read are set up
+    AttributePlane inv_w, z;
+    AttributePlane color[4];
+    AttributePlane texcoords[3][2];
+    bool uses_color;
+    bool uses_texcoords[3];
+};
+
 struct GPU_Context
 {
     //A generic representation of all registers, used for masking
@@ -187,6 +269,13 @@ struct GPU_Context
     uint32_t tex0_addr[5];
     uint8_t tex_type[3];
 
+    //Host memory behind the textures, looked up like the framebuffer. Null if a texture isn't in RAM.
+    uint8_t* tex_data[3];
+
+    //Decoded copies from the texture cache. Null for formats that aren't cached.
+    const uint32_t* tex_texels[3];
+    bool textures_dirty;
+
     int texcomb_start, texcomb_end;
     uint8_t texcomb_rgb_source[6][3];
     uint8_t texcomb_alpha_source[6][3];
@@ -244,6 +333,11 @@ struct GPU_Context
     uint32_t color_buffer_base;
     uint16_t frame_width, frame_height;
 
+    //Host memory behind the buffers above, looked up when a draw needs them. Null if a buffer isn't in RAM.
+    uint8_t* color_buffer;
+    uint8_t* depth_buffer;
+    bool framebuffer_dirty;
+
     //Geometry pipeline
     Vertex vertex_queue[4];
     int submitted_vertices;
@@ -310,6 +404,7 @@ class GPU
         Emulator* e;
         Scheduler* scheduler;
         MPCore_PMR* pmr;
+        int transfer_engine_event, command_engine_event, memfill_event;
         uint8_t* vram;
 
         uint8_t* top_screen, *bottom_screen;
@@ -327,6 +422,35 @@ class GPU
 
         GPU_Context ctx;
 
+        //Triangles are set up as they come in and then drawn a bin at a time, where a bin is a square of BIN_SIZE
+        //pixels lined up with the 8x8 tiles. A bin keeps its triangles in the order they were submitted and no two
+        //bins share a pixel, so bins can be drawn in any order, or all at once, and give the same result.
+        //The bins are drawn before any state the fragments depend on changes, and at the end of a command list.
+        constexpr static int BIN_SHIFT = 5;
+        constexpr static int BIN_SIZE = 1 << BIN_SHIFT;
+        constexpr static int MAX_BINNED_TRIS = 4096;
+
+        std::vector<RasterTri> binned_tris;
+        std::vector<std::vector<uint32_t>> bins;
+        std::vector<int> active_bins;
+        GPU_ThreadPool raster_threads;
+
+        bool shader_jit_enabled;
+        ShaderJIT shader_jit;
+
+        //Direct-mapped on the vertex index. Emptied at the start of every indexed draw, as uniforms, the shader, and
+        //the buffers may all change between draws.
+        constexpr static int VTX_CACHE_SIZE = 256;
+        VertexCacheEntry vtx_cache[VTX_CACHE_SIZE];
+        VertexCacheStats vtx_cache_stats;
+
+        //Keyed by address, size, and format. Writes to guest memory can't all be seen from here, so an entry is
+        //checked against a hash of its memory the first time it's used in each command list.
+        constexpr static size_t MAX_TEX_CACHE_BYTES = 1024 * 1024 * 64;
+        std::unordered_map<uint64_t, TextureCacheEntry> tex_cache;
+        size_t tex_cache_bytes;
+        uint32_t tex_cache_epoch;
+
         uint32_t read32_fb(int index, uint32_t addr);
         void write32_fb(int index, uint32_t addr, uint32_t value);
 
@@ -340,21 +464,38 @@ class GPU
         void start_command_engine_dma(int index);
 
         void write_cmd_register(int reg, uint32_t param, uint8_t mask);
+        bool affects_fragments(int reg);
         void input_float_uniform(ShaderUnit& sh, uint32_t param);
+        void input_shader_code(ShaderUnit& sh, uint32_t param);
+        void input_shader_op_desc(ShaderUnit& sh, uint32_t param);
 
         void draw_vtx_array(bool is_indexed);
+        void compile_vtx_layout(VertexLayout& layout);
         void input_vsh_vtx();
+        void output_vsh_vtx();
         void map_sh_output_to_vtx(ShaderUnit& sh, Vertex& v);
         void submit_vtx(Vertex& v, bool winding);
         void process_tri(Vertex& v0, Vertex& v1, Vertex& v2);
         void viewport_transform(Vertex& v);
 
         bool get_fill_rule_bias(Vertex& vtx, Vertex& line1, Vertex& line2);
-        void rasterize_tri(Vertex& v0, Vertex& v1, Vertex& v2);
+        void resolve_framebuffer();
+        void resolve_textures();
+        const uint32_t* get_decoded_texture(int index, uint32_t size);
+        void invalidate_textures(uint32_t addr, uint32_t size);
+        void setup_tri(Vertex& v0, Vertex& v1, Vertex& v2);
+        void flush_tris();
+        void rasterize_bin(int bin);
+        void rasterize_tri(RasterTri& tri, int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y);
+        void draw_fragment(RasterTri& tri, int32_t x, int32_t y);
+        bool combiners_use_primary_color();
+        bool tex_unit_samples(int index);
         void rasterize_half_tri(float24 x0, float24 x1, int y0, int y1, Vertex &x_step,
                                 Vertex &y_step, Vertex &init, float24 step_x0, float24 step_x1);
 
         void tex_lookup(int index, int coord_index, RGBA_Color& tex_color, Vertex& vtx);
+        void decode_texture(int index, uint32_t* texels);
+        void decode_texel(const uint8_t* tex, uint8_t format, uint32_t width, int u, int v, RGBA_Color& tex_color);
         void decode_etc1(RGBA_Color& tex_color, int u, int v, uint64_t data);
         void get_tex0(RGBA_Color& tex_color, Vertex& vtx);
         void get_tex1(RGBA_Color& tex_color, Vertex& vtx);
@@ -364,14 +505,15 @@ class GPU
         void blend_fragment(RGBA_Color& source, RGBA_Color& frame);
         void do_alpha_blending(RGBA_Color& source, RGBA_Color& frame);
         void do_logic_op(RGBA_Color& source, RGBA_Color& frame);
-        void update_stencil(uint32_t addr, uint8_t old, uint8_t ref, uint8_t func);
+        void update_stencil(uint8_t* ptr, uint8_t old, uint8_t ref, uint8_t func);
 
         //Shader ops
         void exec_shader(ShaderUnit& sh);
-        Vec4<float24> swizzle_sh_src(Vec4<float24> src, uint32_t op_desc, int src_type);
-        Vec4<float24> get_src(ShaderUnit& sh, uint8_t src);
+        bool exec_shader_instr(ShaderUnit& sh);
+        Float24x4 swizzle_sh_src(const Vec4<float24>& src, uint32_t op_desc, int src_type);
+        Vec4<float24>& get_src(ShaderUnit& sh, uint8_t src);
         int get_idx1(ShaderUnit& sh, uint8_t idx1, uint8_t src1);
-        void set_sh_dest(ShaderUnit& sh, uint8_t dst, float24 value, int index);
+        void set_sh_dest(ShaderUnit& sh, uint8_t dst, Float24x4 value, uint8_t dest_mask);
 
         bool shader_meets_cond(ShaderUnit& sh, uint32_t instr);
         void shader_add(ShaderUnit& sh, uint32_t instr);
@@ -408,6 +550,10 @@ class GPU
 
         void reset(uint8_t* vram);
         void render_frame();
+        void run_command_list(uint32_t addr, uint32_t words);
+        void set_raster_threads(int count);
+        void set_shader_jit(bool enabled);
+        VertexCacheStats get_vtx_cache_stats();
 
         template <typename T> T read_vram(uint32_t addr);
         template <typename T> void write_vram(uint32_t addr, T value);
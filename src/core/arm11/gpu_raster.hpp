@@ -0,0 +1,196 @@
+#ifndef GPU_RASTER_HPP
+#define GPU_RASTER_HPP
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/***
+ * The three edge functions of a triangle, w = a * (y - y0) - b * (x - x0) + bias, matching orient2D plus the fill
+ * rule bias. Coordinates are in 1/16 pixels. Vertex positions are always whole numbers of those, as
+ * viewport_transform rounds them.
+ *
+ * orient2D and the bias used to be evaluated in floats, which are only exact while the values fit in the 24-bit
+ * mantissa. That holds for everything but large triangles. Triangles where it holds are stepped across with integers. The rest repeat the
+ * float math a row at a time, so every pixel gets the same w either way.
+ *
+ * Pixels are tested several at a time. Each covered pixel is then handed to the fragment stage.
+***/
+struct EdgeFunctions
+{
+    int32_t a[3], b[3];
+    int32_t x0[3], y0[3];
+    int32_t bias[3];
+    bool exact;
+};
+
+#if defined(__AVX2__)
+struct RasterLanes
+{
+    constexpr static int COUNT = 8;
+    typedef __m256i Int;
+
+    static Int set(int32_t value, int32_t step)
+    {
+        return _mm256_setr_epi32(value, value + step, value + step * 2, value + step * 3, value + step * 4,
+                                 value + step * 5, value + step * 6, value + step * 7);
+    }
+    static Int add(Int a, int32_t b) {return _mm256_add_epi32(a, _mm256_set1_epi32(b));}
+    static Int sub_mul_add(float a, Int b, float c, float d)
+    {
+        __m256 product = _mm256_mul_ps(_mm256_cvtepi32_ps(b), _mm256_set1_ps(c));
+        __m256 sum = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(a), product), _mm256_set1_ps(d));
+        return _mm256_cvttps_epi32(sum);
+    }
+    static int covered(Int w1, Int w2, Int w3)
+    {
+        Int any_negative = _mm256_or_si256(_mm256_or_si256(w1, w2), w3);
+        return ~_mm256_movemask_ps(_mm256_castsi256_ps(any_negative)) & 0xFF;
+    }
+    static void store(int32_t* dest, Int value) {_mm256_store_si256((Int*)dest, value);}
+};
+#elif defined(__SSE2__)
+struct RasterLanes
+{
+    constexpr static int COUNT = 4;
+    typedef __m128i Int;
+
+    static Int set(int32_t value, int32_t step)
+    {
+        return _mm_setr_epi32(value, value + step, value + step * 2, value + step * 3);
+    }
+    static Int add(Int a, int32_t b) {return _mm_add_epi32(a, _mm_set1_epi32(b));}
+    static Int sub_mul_add(float a, Int b, float c, float d)
+    {
+        __m128 product = _mm_mul_ps(_mm_cvtepi32_ps(b), _mm_set1_ps(c));
+        __m128 sum = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(a), product), _mm_set1_ps(d));
+        return _mm_cvttps_epi32(sum);
+    }
+    static int covered(Int w1, Int w2, Int w3)
+    {
+        Int any_negative = _mm_or_si128(_mm_or_si128(w1, w2), w3);
+        return ~_mm_movemask_ps(_mm_castsi128_ps(any_negative)) & 0xF;
+    }
+    static void store(int32_t* dest, Int value) {_mm_store_si128((Int*)dest, value);}
+};
+#else
+struct RasterLanes
+{
+    constexpr static int COUNT = 1;
+    typedef int32_t Int;
+
+    static Int set(int32_t value, int32_t) {return value;}
+    static Int add(Int a, int32_t b) {return a + b;}
+    static Int sub_mul_add(float a, Int b, float c, float d)
+    {
+        float product = b * c;
+        float difference = a - product;
+        return (int32_t)(difference + d);
+    }
+    static int covered(Int w1, Int w2, Int w3) {return (w1 | w2 | w3) >= 0;}
+    static void store(int32_t* dest, Int value) {*dest = value;}
+};
+#endif
+
+inline void setup_edge_functions(EdgeFunctions& edges, const int32_t x[3], const int32_t y[3], const int bias[3],
+                                 int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y)
+{
+    //w1 is the edge from v1 to v2, w2 from v2 to v0, and w3 from v0 to v1
+    const static int start[3] = {1, 2, 0};
+    const static int end[3] = {2, 0, 1};
+
+    edges.exact = true;
+    for (int i = 0; i < 3; i++)
+    {
+        edges.a[i] = x[end[i]] - x[start[i]];
+        edges.b[i] = y[end[i]] - y[start[i]];
+        edges.x0[i] = x[start[i]];
+        edges.y0[i] = y[start[i]];
+        edges.bias[i] = bias[i];
+
+        //A bound on both products, their difference, and the bias added on, anywhere in the bounding box
+        int64_t dx = std::max(std::abs(min_x - edges.x0[i]), std::abs(max_x - edges.x0[i]));
+        int64_t dy = std::max(std::abs(min_y - edges.y0[i]), std::abs(max_y - edges.y0[i]));
+        if (std::abs(edges.a[i]) * dy + std::abs(edges.b[i]) * dx >= (1 << 24))
+            edges.exact = false;
+    }
+}
+
+//Calls func(x, y, w1, w2, w3) for every pixel center in the box covered by the triangle, in rows from the top
+template <typename Func>
+void scan_edge_functions(const EdgeFunctions& edges, int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y,
+                         Func func)
+{
+    typedef RasterLanes Lanes;
+    const int32_t block_width = Lanes::COUNT << 4;
+    alignas(32) int32_t w[3][Lanes::COUNT];
+
+    Lanes::Int row[3];
+    for (int i = 0; i < 3; i++)
+    {
+        int32_t start = 0;
+        if (edges.exact)
+            start = edges.a[i] * (min_y - edges.y0[i]) - edges.b[i] * (min_x - edges.x0[i]) + edges.bias[i];
+        row[i] = Lanes::set(start, -edges.b[i] * 0x10);
+    }
+
+    for (int32_t y = min_y; y < max_y; y += 0x10)
+    {
+        Lanes::Int block[3];
+        float row_term[3];
+        for (int i = 0; i < 3; i++)
+        {
+            block[i] = row[i];
+
+            //Rounded on its own, as orient2D does
+            if (!edges.exact)
+                row_term[i] = (float)edges.a[i] * (float)(y - edges.y0[i]);
+        }
+
+        for (int32_t x = min_x; x < max_x; x += block_width)
+        {
+            if (!edges.exact)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    Lanes::Int dx = Lanes::set(x - edges.x0[i], 0x10);
+                    block[i] = Lanes::sub_mul_add(row_term[i], dx, (float)edges.b[i], (float)edges.bias[i]);
+                }
+            }
+
+            int mask = Lanes::covered(block[0], block[1], block[2]);
+            if (max_x - x < block_width)
+                mask &= (1 << ((max_x - x + 0xF) >> 4)) - 1;
+
+            if (mask)
+            {
+                for (int i = 0; i < 3; i++)
+                    Lanes::store(w[i], block[i]);
+
+                for (int lane = 0; lane < Lanes::COUNT; lane++)
+                {
+                    if (mask & (1 << lane))
+                        func(x + (lane << 4), y, w[0][lane], w[1][lane], w[2][lane]);
+                }
+            }
+
+            if (edges.exact)
+            {
+                for (int i = 0; i < 3; i++)
+                    block[i] = Lanes::add(block[i], -edges.b[i] * block_width);
+            }
+        }
+
+        if (edges.exact)
+        {
+            for (int i = 0; i < 3; i++)
+                row[i] = Lanes::add(row[i], edges.a[i] * 0x10);
+        }
+    }
+}
+
+#endif // GPU_RASTER_HPP
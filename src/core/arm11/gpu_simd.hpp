@@ -0,0 +1,197 @@
+#ifndef GPU_SIMD_HPP
+#define GPU_SIMD_HPP
+#include <cmath>
+#include <cstdint>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "gpu_floats.hpp"
+#include "vector_math.hpp"
+
+/***
+ * A shader register as the interpreter works on it: the four float24 lanes of a Vec4, x to w, kept together in one
+ * SSE register. Builds without SSE2 keep them as plain floats.
+ *
+ * The operations are those of float24, lane by lane. Multiplication gives 0 where the product is NaN but neither input
+ * is, and max(a, b) is (a > b) ? a : b. Write masks are in the shader's order, with bit 3 for x down to bit 0 for w.
+ * SSE2 has no shuffle with a variable selector, so swizzles other than xyzw gather the lanes through memory.
+***/
+static_assert(sizeof(Vec4<float24>) == 4 * sizeof(float), "Vec4<float24> must be four packed floats");
+
+#if defined(__SSE2__)
+struct Float24x4
+{
+    __m128 v;
+
+    static Float24x4 load(const Vec4<float24>& vec)
+    {
+        return {_mm_loadu_ps((const float*)&vec)};
+    }
+
+    static Float24x4 splat(float24 value)
+    {
+        return {_mm_set1_ps(value.ToFloat32())};
+    }
+
+    void store(Vec4<float24>& vec, uint8_t mask) const
+    {
+        float* dest = (float*)&vec;
+        if (mask == 0xF)
+        {
+            _mm_storeu_ps(dest, v);
+            return;
+        }
+
+        __m128 lanes = _mm_castsi128_ps(_mm_setr_epi32(-((mask >> 3) & 0x1), -((mask >> 2) & 0x1),
+                                                       -((mask >> 1) & 0x1), -(mask & 0x1)));
+        _mm_storeu_ps(dest, _mm_or_ps(_mm_and_ps(lanes, v), _mm_andnot_ps(lanes, _mm_loadu_ps(dest))));
+    }
+
+    float24 operator[](int lane) const
+    {
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, v);
+        return float24::FromFloat32(lanes[lane]);
+    }
+
+    //compsel lists the source lanes from w down to x
+    Float24x4 swizzle(uint8_t compsel, bool negate) const
+    {
+        __m128 result = v;
+        if (compsel != 0x1B)
+        {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, v);
+            result = _mm_setr_ps(lanes[(compsel >> 6) & 0x3], lanes[(compsel >> 4) & 0x3],
+                                 lanes[(compsel >> 2) & 0x3], lanes[compsel & 0x3]);
+        }
+
+        if (negate)
+            result = _mm_xor_ps(result, _mm_set1_ps(-0.0f));
+        return {result};
+    }
+
+    Float24x4 with_w(float24 value) const
+    {
+        __m128 zw = _mm_unpackhi_ps(v, _mm_set1_ps(value.ToFloat32()));
+        return {_mm_shuffle_ps(v, zw, _MM_SHUFFLE(1, 0, 1, 0))};
+    }
+
+    Float24x4 operator+(const Float24x4& other) const
+    {
+        return {_mm_add_ps(v, other.v)};
+    }
+
+    Float24x4 operator*(const Float24x4& other) const
+    {
+        __m128 product = _mm_mul_ps(v, other.v);
+        __m128 new_nan = _mm_and_ps(_mm_cmpunord_ps(product, product), _mm_cmpord_ps(v, other.v));
+        return {_mm_andnot_ps(new_nan, product)};
+    }
+
+    Float24x4 max(const Float24x4& other) const
+    {
+        return {_mm_max_ps(v, other.v)};
+    }
+
+    //1.0 where this is less than other, 0.0 elsewhere
+    Float24x4 less_than(const Float24x4& other) const
+    {
+        return {_mm_and_ps(_mm_cmplt_ps(v, other.v), _mm_set1_ps(1.0f))};
+    }
+
+    //Summed in order from x, starting from 0
+    float24 dot(const Float24x4& other, int components) const
+    {
+        alignas(16) float products[4];
+        _mm_store_ps(products, (*this * other).v);
+
+        float sum = 0.0f;
+        for (int i = 0; i < components; i++)
+            sum += products[i];
+        return float24::FromFloat32(sum);
+    }
+};
+#else
+struct Float24x4
+{
+    float24 v[4];
+
+    static Float24x4 load(const Vec4<float24>& vec)
+    {
+        return {{vec.x, vec.y, vec.z, vec.w}};
+    }
+
+    static Float24x4 splat(float24 value)
+    {
+        return {{value, value, value, value}};
+    }
+
+    void store(Vec4<float24>& vec, uint8_t mask) const
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (mask & (1 << (3 - i)))
+                vec[i] = v[i];
+        }
+    }
+
+    float24 operator[](int lane) const
+    {
+        return v[lane];
+    }
+
+    Float24x4 swizzle(uint8_t compsel, bool negate) const
+    {
+        Float24x4 result;
+        for (int i = 0; i < 4; i++)
+        {
+            result.v[i] = v[(compsel >> ((3 - i) * 2)) & 0x3];
+            if (negate)
+                result.v[i] = -result.v[i];
+        }
+        return result;
+    }
+
+    Float24x4 with_w(float24 value) const
+    {
+        return {{v[0], v[1], v[2], value}};
+    }
+
+    Float24x4 operator+(const Float24x4& other) const
+    {
+        return {{v[0] + other.v[0], v[1] + other.v[1], v[2] + other.v[2], v[3] + other.v[3]}};
+    }
+
+    Float24x4 operator*(const Float24x4& other) const
+    {
+        return {{v[0] * other.v[0], v[1] * other.v[1], v[2] * other.v[2], v[3] * other.v[3]}};
+    }
+
+    Float24x4 max(const Float24x4& other) const
+    {
+        Float24x4 result;
+        for (int i = 0; i < 4; i++)
+            result.v[i] = (v[i] > other.v[i]) ? v[i] : other.v[i];
+        return result;
+    }
+
+    Float24x4 less_than(const Float24x4& other) const
+    {
+        Float24x4 result;
+        for (int i = 0; i < 4; i++)
+            result.v[i] = float24::FromFloat32((v[i] < other.v[i]) ? 1.0f : 0.0f);
+        return result;
+    }
+
+    float24 dot(const Float24x4& other, int components) const
+    {
+        float24 sum = float24::Zero();
+        for (int i = 0; i < components; i++)
+            sum += v[i] * other.v[i];
+        return sum;
+    }
+};
+#endif
+
+#endif // GPU_SIMD_HPP
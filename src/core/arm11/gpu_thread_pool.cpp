@@ -0,0 +1,104 @@
+#include "gpu_thread_pool.hpp"
+
+GPU_ThreadPool::GPU_ThreadPool() : job_count(0), next_job(0), workers_busy(0), batch_id(0), quit(false)
+{
+
+}
+
+GPU_ThreadPool::~GPU_ThreadPool()
+{
+    stop();
+}
+
+void GPU_ThreadPool::start(int thread_count)
+{
+    stop();
+
+    quit = false;
+    for (int i = 1; i < thread_count; i++)
+        workers.emplace_back(&GPU_ThreadPool::worker_loop, this, batch_id);
+}
+
+void GPU_ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+    }
+    work_ready.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void GPU_ThreadPool::run(int count, std::function<void(int)> func)
+{
+    job = func;
+    job_count = count;
+    next_job.store(0);
+    error = nullptr;
+
+    if (workers.empty())
+    {
+        run_jobs();
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            workers_busy = workers.size();
+            batch_id++;
+        }
+        work_ready.notify_all();
+
+        run_jobs();
+
+        std::unique_lock<std::mutex> wait_lock(lock);
+        work_done.wait(wait_lock, [this] {return workers_busy == 0;});
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void GPU_ThreadPool::run_jobs()
+{
+    int index;
+    while ((index = next_job.fetch_add(1)) < job_count)
+    {
+        try
+        {
+            job(index);
+        }
+        catch (...)
+        {
+            //Keep the first one, and stop handing out the jobs that are left
+            std::lock_guard<std::mutex> guard(lock);
+            if (!error)
+                error = std::current_exception();
+            next_job.store(job_count);
+        }
+    }
+}
+
+void GPU_ThreadPool::worker_loop(uint64_t last_batch)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> wait_lock(lock);
+            work_ready.wait(wait_lock, [&] {return quit || batch_id != last_batch;});
+            if (quit)
+                return;
+            last_batch = batch_id;
+        }
+
+        run_jobs();
+
+        std::lock_guard<std::mutex> guard(lock);
+        workers_busy--;
+        if (!workers_busy)
+            work_done.notify_one();
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef GPU_THREAD_POOL_HPP
+#define GPU_THREAD_POOL_HPP
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***
+ * Worker threads for the rasterizer.
+ *
+ * run() hands out job indices to the workers and the calling thread until none are left, and returns once every job
+ * has finished. Jobs are taken in no particular order, so they must not depend on each other. An exception thrown by
+ * a job is passed on to the caller of run() once the others are done.
+ *
+ * Draws come in bursts with the rest of the system running in between, so idle workers sleep rather than spin.
+***/
+class GPU_ThreadPool
+{
+    private:
+        std::vector<std::thread> workers;
+        std::mutex lock;
+        std::condition_variable work_ready, work_done;
+
+        std::function<void(int)> job;
+        int job_count;
+        std::atomic<int> next_job;
+        int workers_busy;
+        uint64_t batch_id;
+        bool quit;
+        std::exception_ptr error;
+
+        void worker_loop(uint64_t last_batch);
+        void run_jobs();
+    public:
+        GPU_ThreadPool();
+        ~GPU_ThreadPool();
+
+        void start(int thread_count);
+        void stop();
+        int get_thread_count();
+        void run(int count, std::function<void(int)> func);
+};
+
+//Includes the thread calling run()
+inline int GPU_ThreadPool::get_thread_count()
+{
+    return workers.size() + 1;
+}
+
+#endif // GPU_THREAD_POOL_HPP
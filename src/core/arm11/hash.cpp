@@ -1,8 +1,6 @@
 #include "../common/common.hpp"
 #include "hash.hpp"
 
-#define printf(fmt,...) (void)(0)
-
 HASH::HASH()
 {
 
@@ -17,7 +15,7 @@ uint32_t HASH::read32(uint32_t addr)
         uint32_t value = *(uint32_t*)&eng.hash[index];
         if (eng.SHA_CNT.out_big_endian)
             value = bswp32(value);
-        printf("[HASH] Read32 hash $%08X: $%08X\n", addr, value);
+        LOG(LOG_HASH, LOG_TRACE, "[HASH] Read32 hash $%08X: $%08X\n", addr, value);
         return value;
     }
     switch (addr)
@@ -27,13 +25,13 @@ uint32_t HASH::read32(uint32_t addr)
             reg |= eng.SHA_CNT.out_big_endian << 3;
             reg |= eng.SHA_CNT.mode << 4;
             reg |= eng.SHA_CNT.out_dma_enable << 10;
-            printf("[HASH] Read32 HASH_CNT: $%08X\n", reg);
+            LOG(LOG_HASH, LOG_TRACE, "[HASH] Read32 HASH_CNT: $%08X\n", reg);
             break;
         case 0x10101004:
             reg = eng.message_len << 2;
             break;
         default:
-            printf("[HASH] Unrecognized read32 $%08X\n", addr);
+            LOG(LOG_HASH, LOG_TRACE, "[HASH] Unrecognized read32 $%08X\n", addr);
     }
     return reg;
 }
@@ -43,7 +41,7 @@ void HASH::write32(uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x10101000:
-            printf("[HASH] Write32 HASH_CNT: $%08X\n", value);
+            LOG(LOG_HASH, LOG_TRACE, "[HASH] Write32 HASH_CNT: $%08X\n", value);
             eng.SHA_CNT.busy = value & 0x1;
             eng.SHA_CNT.in_dma_enable = value & (1 << 2);
             eng.SHA_CNT.out_big_endian = value & (1 << 3);
@@ -72,7 +70,7 @@ void HASH::write32(uint32_t addr, uint32_t value)
                 eng.do_hash(true);
             break;
         default:
-            printf("[HASH] Unrecognized write32 $%08X: $%08X\n", addr, value);
+            LOG(LOG_HASH, LOG_TRACE, "[HASH] Unrecognized write32 $%08X: $%08X\n", addr, value);
     }
 }
 
@@ -85,7 +83,7 @@ void HASH::write_fifo(uint32_t value)
         std::queue<uint32_t> empty;
         eng.read_fifo.swap(empty);
     }
-    printf("[HASH] Write FIFO: $%08X\n", value);
+    LOG(LOG_HASH, LOG_TRACE, "[HASH] Write FIFO: $%08X\n", value);
     eng.in_fifo.push(value);
     eng.read_fifo.push(value);
     eng.message_len++;
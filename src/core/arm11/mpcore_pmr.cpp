@@ -142,7 +142,7 @@ void MPCore_PMR::check_if_can_assert_irq(int core)
 
 void MPCore_PMR::set_pending_irq(int core, int int_id, int id_of_requester)
 {
-    printf("[PMR%d] Set pending int%d\n", core, int_id);
+    LOG(LOG_MPCORE, LOG_TRACE, "[PMR%d] Set pending int%d\n", core, int_id);
     int index = int_id / 32;
     int bit = int_id & 0x1F;
     private_int_pending[core][index] |= 1 << bit;
@@ -161,7 +161,7 @@ uint8_t MPCore_PMR::read8(int core, uint32_t addr)
             return global_int_targets[addr - 0x17E01820];
         return 0;
     }
-    printf("[PMR%d] Unrecognized read8 $%08X\n", core, addr);
+    LOG(LOG_MPCORE, LOG_WARN, "[PMR%d] Unrecognized read8 $%08X\n", core, addr);
     return regs[addr & 0x1FFF];
 }
 
@@ -194,7 +194,7 @@ uint32_t MPCore_PMR::read32(int core, uint32_t addr)
             case 0x2C:
                 return timers->arm11_get_int_status(timer_id);
             default:
-                printf("[PMR] Unrecognized timer%d read32 $%08X\n", timer_id, addr);
+                LOG(LOG_MPCORE, LOG_WARN, "[PMR] Unrecognized timer%d read32 $%08X\n", timer_id, addr);
                 return 0;
         }
     }
@@ -249,7 +249,7 @@ uint32_t MPCore_PMR::read32(int core, uint32_t addr)
         {
             //Reading returns the cause of the IRQ and acknowledges it
             uint32_t cause = local_irq_ctrl[core].irq_cause;
-            printf("[PMR%d] Acknowledge pending IRQ: $%08X\n", core, cause);
+            LOG(LOG_MPCORE, LOG_DEBUG, "[PMR%d] Acknowledge pending IRQ: $%08X\n", core, cause);
 
             int int_id = cause & 0x3FF;
             private_int_pending[core][int_id / 32] &= ~(1 << (int_id & 0x1F));
@@ -263,7 +263,7 @@ uint32_t MPCore_PMR::read32(int core, uint32_t addr)
         case 0x17E01004:
             return ((core_count - 1) << 5) | 0x3;
     }
-    printf("[PMR%d] Unrecognized read32 $%08X\n", core, addr);
+    LOG(LOG_MPCORE, LOG_WARN, "[PMR%d] Unrecognized read32 $%08X\n", core, addr);
     return *(uint32_t*)&regs[addr & 0x1FFF];
 }
 
@@ -284,17 +284,17 @@ void MPCore_PMR::write8(int core, uint32_t addr, uint8_t value)
     }
     if (addr >= 0x17E01820 && addr < 0x17E01880)
     {
-        printf("[PMR%d] Write8 int%d target: $%02X\n", core, addr - 0x17E01800, value);
+        LOG(LOG_MPCORE, LOG_DEBUG, "[PMR%d] Write8 int%d target: $%02X\n", core, addr - 0x17E01800, value);
         global_int_targets[addr - 0x17E01820] = value & 0xF;
         return;
     }
-    printf("[PMR%d] Unrecognized write8 $%08X: $%02X\n", core, addr, value);
+    LOG(LOG_MPCORE, LOG_WARN, "[PMR%d] Unrecognized write8 $%08X: $%02X\n", core, addr, value);
     regs[addr & 0x1FFF] = value;
 }
 
 void MPCore_PMR::write16(int core, uint32_t addr, uint16_t value)
 {
-    printf("[PMR%d] Unrecognized write16 $%08X: $%04X\n", core, addr, value);
+    LOG(LOG_MPCORE, LOG_WARN, "[PMR%d] Unrecognized write16 $%08X: $%04X\n", core, addr, value);
     *(uint16_t*)&regs[addr & 0x1FFF] = value;
 }
 
@@ -331,7 +331,7 @@ void MPCore_PMR::write32(int core, uint32_t addr, uint32_t value)
                 timers->arm11_set_int_status(timer_id, value);
                 break;
             default:
-                printf("[PMR] Unrecognized timer%d write32 $%08X: $%08X\n", timer_id, addr, value);
+                LOG(LOG_MPCORE, LOG_WARN, "[PMR] Unrecognized timer%d write32 $%08X: $%08X\n", timer_id, addr, value);
                 break;
         }
         return;
@@ -359,7 +359,7 @@ void MPCore_PMR::write32(int core, uint32_t addr, uint32_t value)
     }
     if (addr >= 0x17E01280 && addr < 0x17E012A0)
     {
-        printf("[PMR%d] Clear global int $%08X: $%08X\n", core, addr, value);
+        LOG(LOG_MPCORE, LOG_DEBUG, "[PMR%d] Clear global int $%08X: $%08X\n", core, addr, value);
 
         int index = (addr / 4) & 0x7;
         bool is_aliased = index == 0;
@@ -384,15 +384,15 @@ void MPCore_PMR::write32(int core, uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x17E00100:
-            printf("[PMR%d] Set local IRQ enable: $%08X\n", core, value);
+            LOG(LOG_MPCORE, LOG_DEBUG, "[PMR%d] Set local IRQ enable: $%08X\n", core, value);
             local_irq_ctrl[core].enabled = value & 0x1;
             return;
         case 0x17E00104:
-            printf("[PMR%d] Set local priority mask: $%08X\n", core, value);
+            LOG(LOG_MPCORE, LOG_DEBUG, "[PMR%d] Set local priority mask: $%08X\n", core, value);
             local_irq_ctrl[core].priority_mask = (value >> 4) & 0xF;
             return;
         case 0x17E00108:
-            printf("[PMR%d] Set local preemption mask: $%08X\n", core, value);
+            LOG(LOG_MPCORE, LOG_DEBUG, "[PMR%d] Set local preemption mask: $%08X\n", core, value);
             local_irq_ctrl[core].preemption_mask = value & 0x7;
             if (local_irq_ctrl[core].preemption_mask < 0x3)
                 local_irq_ctrl[core].preemption_mask = 0x3;
@@ -407,7 +407,7 @@ void MPCore_PMR::write32(int core, uint32_t addr, uint32_t value)
         }
             return;
         case 0x17E01F00:
-            printf("[PMR%d] Send SWI: $%08X\n", core, value);
+            LOG(LOG_MPCORE, LOG_DEBUG, "[PMR%d] Send SWI: $%08X\n", core, value);
         {
             uint32_t int_id = value & 0x3FF;
             if (int_id < 32)
@@ -439,7 +439,7 @@ void MPCore_PMR::write32(int core, uint32_t addr, uint32_t value)
         }
             return;
     }
-    printf("[PMR%d] Unrecognized write32 $%08X: $%08X\n", core, addr, value);
+    LOG(LOG_MPCORE, LOG_WARN, "[PMR%d] Unrecognized write32 $%08X: $%08X\n", core, addr, value);
     *(uint32_t*)&regs[addr & 0x1FFF] = value;
 }
 
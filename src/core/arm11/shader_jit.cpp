@@ -0,0 +1,496 @@
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "gpu.hpp"
+#include "shader_jit.hpp"
+#include "../common/common.hpp"
+
+static_assert(sizeof(Vec4<float24>) == 16, "Shader registers must be four packed floats");
+
+//The first argument of a block, holding the ShaderUnit pointer throughout
+constexpr static X64_REG SH = ABI_PARAM1;
+
+//Operand fields of an arithmetic instruction, decoded the same way as the shader_* functions in gpu.cpp
+struct ShaderOperands
+{
+    int count;
+    uint8_t src[3];
+
+    //Relative addressing mode, applied to src[relative]
+    uint8_t idx;
+    int relative;
+
+    uint8_t dest;
+    uint32_t op_desc;
+};
+
+static bool decode_operands(const ShaderProgram& program, uint32_t instr, ShaderOperands& ops)
+{
+    uint8_t opcode = instr >> 26;
+    ops.relative = 0;
+    ops.dest = (instr >> 21) & 0x1F;
+    ops.op_desc = program.op_desc[instr & 0x7F];
+
+    switch (opcode)
+    {
+        case 0x00:
+        case 0x01:
+        case 0x02:
+        case 0x03:
+        case 0x08:
+        case 0x0C:
+        case 0x2E:
+        case 0x2F:
+            ops.count = 2;
+            ops.src[0] = (instr >> 12) & 0x7F;
+            ops.src[1] = (instr >> 7) & 0x1F;
+            ops.idx = (instr >> 19) & 0x3;
+            return true;
+        case 0x0E:
+        case 0x0F:
+        case 0x12:
+        case 0x13:
+            ops.count = 1;
+            ops.src[0] = (instr >> 12) & 0x7F;
+            ops.idx = (instr >> 19) & 0x3;
+            return true;
+        case 0x1B:
+            ops.count = 2;
+            ops.src[0] = (instr >> 14) & 0x1F;
+            ops.src[1] = (instr >> 7) & 0x7F;
+            ops.idx = (instr >> 19) & 0x3;
+            ops.relative = 1;
+            return true;
+        default:
+            break;
+    }
+
+    //MADI and MAD
+    if (opcode >= 0x30)
+    {
+        bool madi = opcode < 0x38;
+        ops.count = 3;
+        ops.src[0] = (instr >> 17) & 0x1F;
+        ops.src[1] = (madi) ? (instr >> 12) & 0x1F : (instr >> 10) & 0x7F;
+        ops.src[2] = (madi) ? (instr >> 5) & 0x7F : (instr >> 5) & 0x1F;
+        ops.idx = (instr >> 22) & 0x3;
+        ops.relative = (madi) ? 2 : 1;
+        ops.dest = (instr >> 24) & 0x1F;
+        ops.op_desc = program.op_desc[instr & 0x1F];
+        return true;
+    }
+    return false;
+}
+
+ShaderJIT::ShaderJIT()
+{
+#ifdef _WIN32
+    code_buffer = (uint8_t*)VirtualAlloc(nullptr, CODE_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    code_buffer = (uint8_t*)mmap(nullptr, CODE_BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code_buffer == MAP_FAILED)
+        code_buffer = nullptr;
+#endif
+    if (!code_buffer)
+        EmuException::die("[ShaderJIT] Failed to allocate code buffer");
+
+    for (int i = 0; i < 4; i++)
+    {
+        constants.sign[i] = 0x80000000;
+        constants.one[i] = 1.0f;
+        constants.xyz[i] = (i < 3) ? 0xFFFFFFFF : 0;
+        constants.w_one[i] = (i < 3) ? 0.0f : 1.0f;
+
+        //Bit 3 of a destination mask is x
+        for (int mask = 0; mask < 16; mask++)
+            constants.lane_masks[mask][i] = (mask & (1 << (3 - i))) ? 0xFFFFFFFF : 0;
+    }
+
+    reset();
+}
+
+ShaderJIT::~ShaderJIT()
+{
+#ifdef _WIN32
+    VirtualFree(code_buffer, 0, MEM_RELEASE);
+#else
+    munmap(code_buffer, CODE_BUFFER_SIZE);
+#endif
+}
+
+void ShaderJIT::reset()
+{
+    code_pos = code_buffer;
+    programs.clear();
+}
+
+ShaderProgram* ShaderJIT::get_program(const ShaderUnit &sh)
+{
+    const uint8_t* base = (const uint8_t*)&sh;
+    input_offset = (const uint8_t*)&sh.input_regs[0] - base;
+    temp_offset = (const uint8_t*)&sh.temp_regs[0] - base;
+    output_offset = (const uint8_t*)&sh.output_regs[0] - base;
+    uniform_offset = (const uint8_t*)&sh.float_uniform[0] - base;
+    addr_offset = (const uint8_t*)&sh.addr_reg[0] - base;
+    loop_ctr_offset = (const uint8_t*)&sh.loop_ctr_reg - base;
+    cmp_offset = (const uint8_t*)&sh.cmp_regs[0] - base;
+    pc_offset = (const uint8_t*)&sh.pc - base;
+
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < sizeof(sh.code); i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, &sh.code[i], sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ULL;
+    }
+    for (uint32_t desc : sh.op_desc)
+        hash = (hash ^ desc) * 0x100000001B3ULL;
+
+    auto range = programs.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++)
+    {
+        ShaderProgram* program = it->second.get();
+        if (!memcmp(program->code, sh.code, sizeof(sh.code)) && !memcmp(program->op_desc, sh.op_desc, sizeof(sh.op_desc)))
+            return program;
+    }
+
+    std::unique_ptr<ShaderProgram> program(new ShaderProgram);
+    memcpy(program->code, sh.code, sizeof(sh.code));
+    memcpy(program->op_desc, sh.op_desc, sizeof(sh.op_desc));
+    memset(program->flow_end, 0, sizeof(program->flow_end));
+    memset(program->blocks, 0, sizeof(program->blocks));
+
+    //Any word may be reached as an instruction, so all of them are scanned
+    for (int i = 0; i < ShaderProgram::CODE_WORDS; i++)
+    {
+        uint32_t instr;
+        memcpy(&instr, &sh.code[i * 4], sizeof(instr));
+
+        uint16_t dst = (instr >> 10) & 0xFFF;
+        uint8_t num = instr & 0xFF;
+        int end;
+        switch (instr >> 26)
+        {
+            case 0x24:
+            case 0x25:
+            case 0x26:
+                end = dst + num;
+                break;
+            case 0x27:
+            case 0x28:
+                end = dst;
+                break;
+            case 0x29:
+                end = dst + 1;
+                break;
+            default:
+                continue;
+        }
+
+        if (end <= ShaderProgram::CODE_WORDS)
+            program->flow_end[end] = true;
+    }
+
+    ShaderProgram* result = program.get();
+    programs.emplace(hash, std::move(program));
+    return result;
+}
+
+ShaderBlockFunc ShaderJIT::compile_block(ShaderProgram &program, uint16_t pc)
+{
+    //Left to the interpreter until GPU flushes the JIT
+    if (code_pos + MAX_BLOCK_SIZE > code_buffer + CODE_BUFFER_SIZE)
+        return nullptr;
+
+    ShaderBlock& block = program.blocks[pc >> 2];
+    block.compiled = true;
+    block.code = nullptr;
+
+    emitter.set_block_pos(code_pos);
+
+    uint32_t addr = pc;
+    int count = 0;
+    while (addr < sizeof(program.code) && count < MAX_BLOCK_INSTRS)
+    {
+        uint32_t instr;
+        memcpy(&instr, &program.code[addr], sizeof(instr));
+        if (!can_compile(program, instr))
+            break;
+
+        emit_instr(program, instr, addr);
+        addr += 4;
+        count++;
+
+        if (program.flow_end[addr >> 2])
+            break;
+    }
+
+    if (!count)
+        return nullptr;
+
+    emitter.mov32_reg_imm(REG_RAX, addr);
+    emitter.ret();
+
+    block.code = (ShaderBlockFunc)emitter.get_block_pos();
+    code_pos = (uint8_t*)(((uint64_t)emitter.get_code_pos() + 15) & ~15ULL);
+    return block.code;
+}
+
+bool ShaderJIT::can_compile(const ShaderProgram &program, uint32_t instr)
+{
+    uint8_t opcode = instr >> 26;
+    if (opcode == 0x21)
+        return true;
+
+    ShaderOperands ops;
+    if (!decode_operands(program, instr, ops))
+        return false;
+
+    if (opcode == 0x2E || opcode == 0x2F)
+    {
+        //Unknown comparisons stop emulation in the interpreter
+        return ((instr >> 24) & 0x7) <= 5 && ((instr >> 21) & 0x7) <= 5;
+    }
+
+    if (opcode == 0x12)
+        return true;
+
+    //Same for writes to registers that can't be written
+    bool valid_dest = ops.dest < 0x7 || (ops.dest >= 0x10 && ops.dest < 0x20);
+    return valid_dest || !(ops.op_desc & 0xF);
+}
+
+void ShaderJIT::emit_instr(const ShaderProgram &program, uint32_t instr, uint16_t pc)
+{
+    uint8_t opcode = instr >> 26;
+    if (opcode == 0x21)
+        return;
+
+    ShaderOperands ops;
+    decode_operands(program, instr, ops);
+
+    const static X64_XMM src_regs[3] = {REG_XMM0, REG_XMM1, REG_XMM2};
+    for (int i = 0; i < ops.count; i++)
+    {
+        uint8_t idx = (i == ops.relative) ? ops.idx : 0;
+        emit_load_src(src_regs[i], ops.src[i], idx, ops.op_desc, i + 1, pc);
+    }
+
+    uint8_t dest_mask = ops.op_desc & 0xF;
+    switch (opcode)
+    {
+        case 0x00:
+            emitter.addps(REG_XMM0, REG_XMM1);
+            emit_store_dest(REG_XMM0, ops.dest, dest_mask);
+            break;
+        case 0x01:
+            emit_dot_product(3);
+            emit_store_dest(REG_XMM2, ops.dest, dest_mask);
+            break;
+        case 0x02:
+            emit_dot_product(4);
+            emit_store_dest(REG_XMM2, ops.dest, dest_mask);
+            break;
+        case 0x03:
+            //w of the first source becomes 1
+            emit_load_constant(REG_XMM4, constants.xyz);
+            emitter.andps(REG_XMM0, REG_XMM4);
+            emit_load_constant(REG_XMM4, constants.w_one);
+            emitter.orps(REG_XMM0, REG_XMM4);
+            emit_dot_product(4);
+            emit_store_dest(REG_XMM2, ops.dest, dest_mask);
+            break;
+        case 0x08:
+            emit_mul(REG_XMM0, REG_XMM1);
+            emit_store_dest(REG_XMM0, ops.dest, dest_mask);
+            break;
+        case 0x0C:
+            //MAXPS returns the second operand unless the first is greater, the same as (a > b) ? a : b
+            emitter.maxps(REG_XMM0, REG_XMM1);
+            emit_store_dest(REG_XMM0, ops.dest, dest_mask);
+            break;
+        case 0x0E:
+        case 0x0F:
+            if (opcode == 0x0F)
+                emitter.sqrtss(REG_XMM0, REG_XMM0);
+            emit_load_constant(REG_XMM1, constants.one);
+            emitter.divss(REG_XMM1, REG_XMM0);
+            emitter.shufps(REG_XMM1, REG_XMM1, 0);
+            emit_store_dest(REG_XMM1, ops.dest, dest_mask);
+            break;
+        case 0x12:
+            if (dest_mask & (1 << 3))
+                emitter.movss_mem_reg(SH, addr_offset, REG_XMM0);
+            if (dest_mask & (1 << 2))
+            {
+                emitter.shufps(REG_XMM0, REG_XMM0, 0x55);
+                emitter.movss_mem_reg(SH, addr_offset + sizeof(float24), REG_XMM0);
+            }
+            break;
+        case 0x13:
+            emit_store_dest(REG_XMM0, ops.dest, dest_mask);
+            break;
+        case 0x1B:
+            emitter.cmpps(REG_XMM0, REG_XMM1, FCMP_LT);
+            emit_load_constant(REG_XMM1, constants.one);
+            emitter.andps(REG_XMM0, REG_XMM1);
+            emit_store_dest(REG_XMM0, ops.dest, dest_mask);
+            break;
+        case 0x2E:
+        case 0x2F:
+        {
+            //Greater than is done as less than with the operands swapped, so NaNs still compare false
+            const static X64_FCMP preds[6] = {FCMP_EQ, FCMP_NEQ, FCMP_LT, FCMP_LE, FCMP_LT, FCMP_LE};
+            const static bool swapped[6] = {false, false, false, false, true, true};
+            uint8_t cmp_ops[2] = {(uint8_t)((instr >> 24) & 0x7), (uint8_t)((instr >> 21) & 0x7)};
+            for (int i = 0; i < 2; i++)
+            {
+                uint8_t op = cmp_ops[i];
+                emitter.movaps_reg_reg(REG_XMM2, (swapped[op]) ? REG_XMM1 : REG_XMM0);
+                emitter.cmpps(REG_XMM2, (swapped[op]) ? REG_XMM0 : REG_XMM1, preds[op]);
+                emitter.movmskps(REG_RAX, REG_XMM2);
+                emitter.bt32_imm(REG_RAX, i);
+                emitter.setcc_mem(COND_B, SH, cmp_offset + i);
+            }
+            break;
+        }
+        default:
+            //MADI and MAD: src3 + (src2 * src1)
+            emit_mul(REG_XMM1, REG_XMM0);
+            emitter.addps(REG_XMM2, REG_XMM1);
+            emit_store_dest(REG_XMM2, ops.dest, dest_mask);
+            break;
+    }
+}
+
+void ShaderJIT::emit_load_src(X64_XMM dest, uint8_t src, uint8_t idx, uint32_t op_desc, int src_type, uint16_t pc)
+{
+    if (idx && src >= 0x20)
+    {
+        //The index is added to the 8-bit register number, so it can wrap around into the other register files
+        if (idx == 3)
+            emitter.mov32_reg_mem(REG_RAX, SH, loop_ctr_offset);
+        else
+            emitter.cvttss2si_reg_mem(REG_RAX, SH, addr_offset + (idx - 1) * sizeof(float24));
+        emitter.mov32_reg_imm(REG_RDX, src);
+        emitter.add32_reg_reg(REG_RAX, REG_RDX);
+        emitter.shl32_imm(REG_RAX, 24);
+        emitter.shr32_imm(REG_RAX, 24);
+
+        emitter.cmp32_reg_imm(REG_RAX, 0x20);
+        uint8_t* not_uniform = emitter.jcc(COND_B);
+
+        //Indices past the last uniform read on into the rest of ShaderUnit, as they do in the interpreter.
+        //That includes pc, which the interpreter has already moved past the instruction.
+        emitter.cmp32_reg_imm(REG_RAX, 0x20 + 96);
+        uint8_t* in_range = emitter.jcc(COND_B);
+        emitter.mov16_mem_imm(SH, pc_offset, pc + 4);
+        emitter.set_jump_dest(in_range, emitter.get_code_pos());
+
+        emitter.shl32_imm(REG_RAX, 4);
+        emitter.add64_reg_reg(REG_RAX, SH);
+        emitter.movups_reg_mem(dest, REG_RAX, uniform_offset - 0x20 * 16);
+        uint8_t* uniform_done = emitter.jmp();
+
+        emitter.set_jump_dest(not_uniform, emitter.get_code_pos());
+        emitter.cmp32_reg_imm(REG_RAX, 0x10);
+        uint8_t* input = emitter.jcc(COND_B);
+        emitter.shl32_imm(REG_RAX, 4);
+        emitter.add64_reg_reg(REG_RAX, SH);
+        emitter.movups_reg_mem(dest, REG_RAX, temp_offset - 0x10 * 16);
+        uint8_t* temp_done = emitter.jmp();
+
+        emitter.set_jump_dest(input, emitter.get_code_pos());
+        emitter.shl32_imm(REG_RAX, 4);
+        emitter.add64_reg_reg(REG_RAX, SH);
+        emitter.movups_reg_mem(dest, REG_RAX, input_offset);
+
+        emitter.set_jump_dest(uniform_done, emitter.get_code_pos());
+        emitter.set_jump_dest(temp_done, emitter.get_code_pos());
+    }
+    else if (src < 0x10)
+        emitter.movups_reg_mem(dest, SH, input_offset + src * 16);
+    else if (src < 0x20)
+        emitter.movups_reg_mem(dest, SH, temp_offset + (src - 0x10) * 16);
+    else
+        emitter.movups_reg_mem(dest, SH, uniform_offset + (src - 0x20) * 16);
+
+    const static int compsel_shift[3] = {5, 14, 23};
+    int shift = compsel_shift[src_type - 1];
+    uint8_t compsel = (op_desc >> shift) & 0xFF;
+    bool negate = (op_desc >> (shift - 1)) & 0x1;
+
+    //compsel lists the components from w down to x
+    uint8_t select = 0;
+    for (int i = 0; i < 4; i++)
+        select |= ((compsel >> ((3 - i) * 2)) & 0x3) << (i * 2);
+
+    if (select != 0xE4)
+        emitter.shufps(dest, dest, select);
+
+    if (negate)
+    {
+        emit_load_constant(REG_XMM5, constants.sign);
+        emitter.xorps(dest, REG_XMM5);
+    }
+}
+
+void ShaderJIT::emit_store_dest(X64_XMM value, uint8_t dest, uint8_t dest_mask)
+{
+    if (!dest_mask)
+        return;
+
+    int32_t offset;
+    if (dest < 0x7)
+        offset = output_offset + dest * 16;
+    else
+        offset = temp_offset + (dest - 0x10) * 16;
+
+    if (dest_mask != 0xF)
+    {
+        emitter.movups_reg_mem(REG_XMM5, SH, offset);
+        emit_load_constant(REG_XMM4, constants.lane_masks[dest_mask]);
+        emitter.andps(value, REG_XMM4);
+        emitter.andnps(REG_XMM4, REG_XMM5);
+        emitter.orps(value, REG_XMM4);
+    }
+    emitter.movups_mem_reg(SH, offset, value);
+}
+
+//a = a * b, giving 0 where the product is NaN but neither input is. Uses XMM4 and XMM5.
+void ShaderJIT::emit_mul(X64_XMM a, X64_XMM b)
+{
+    emitter.movaps_reg_reg(REG_XMM4, a);
+    emitter.mulps(REG_XMM4, b);
+    emitter.movaps_reg_reg(REG_XMM5, REG_XMM4);
+    emitter.cmpps(REG_XMM5, REG_XMM5, FCMP_UNORD);
+    emitter.cmpps(a, b, FCMP_ORD);
+    emitter.andps(REG_XMM5, a);
+    emitter.andnps(REG_XMM5, REG_XMM4);
+    emitter.movaps_reg_reg(a, REG_XMM5);
+}
+
+//Dot product of XMM0 and XMM1 into every lane of XMM2, summed in order from x like dp4 in gpu.cpp
+void ShaderJIT::emit_dot_product(int components)
+{
+    emit_mul(REG_XMM0, REG_XMM1);
+    emitter.xorps(REG_XMM2, REG_XMM2);
+    emitter.addss(REG_XMM2, REG_XMM0);
+    for (int i = 1; i < components; i++)
+    {
+        emitter.movaps_reg_reg(REG_XMM3, REG_XMM0);
+        emitter.shufps(REG_XMM3, REG_XMM3, i * 0x55);
+        emitter.addss(REG_XMM2, REG_XMM3);
+    }
+    emitter.shufps(REG_XMM2, REG_XMM2, 0);
+}
+
+void ShaderJIT::emit_load_constant(X64_XMM dest, const void *constant)
+{
+    emitter.mov64_reg_imm(REG_RAX, (uint64_t)constant);
+    emitter.movups_reg_mem(dest, REG_RAX, 0);
+}
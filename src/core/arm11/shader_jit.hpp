@@ -0,0 +1,112 @@
+#ifndef SHADER_JIT_HPP
+#define SHADER_JIT_HPP
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include "../cpu/x64_emitter.hpp"
+
+struct ShaderUnit;
+
+//Runs a block of shader instructions and returns the pc following it
+typedef uint32_t (*ShaderBlockFunc)(ShaderUnit* sh);
+
+struct ShaderBlock
+{
+    bool compiled;
+    ShaderBlockFunc code;
+};
+
+struct ShaderProgram
+{
+    constexpr static int CODE_WORDS = 4096;
+
+    //Copies of what the program was compiled from, so hash collisions can be told apart
+    uint8_t code[CODE_WORDS * sizeof(uint32_t)];
+    uint32_t op_desc[128];
+
+    //Set for every pc LOOP, IF, or CALL may end at, as exec_shader has to check its stacks there
+    bool flow_end[CODE_WORDS + 1];
+
+    //Indexed by pc / 4. A block that was compiled with no code starts with an instruction left to the interpreter.
+    ShaderBlock blocks[CODE_WORDS];
+};
+
+/***
+ * Recompiles PICA200 shader programs into x86-64 SSE code.
+ *
+ * A program is looked up by a hash of its code and operand descriptors, which covers every swizzle and mask. The
+ * entry point isn't part of the key: blocks are compiled lazily from whatever pc execution reaches, so one program
+ * serves every entry point.
+ *
+ * Blocks are runs of arithmetic instructions. Flow control, and anything that would make the interpreter bail out,
+ * is left to exec_shader. Blocks also end at every pc the flow control stacks could be waiting for, so exec_shader
+ * only has to check them between blocks. The generated code follows the float24 operations exactly, multiplication
+ * giving 0 for inf * 0 included, so results match the interpreter's. Only which NaN comes out of an operation on
+ * NaNs may differ, as that already depends on how the compiler ordered the interpreter's operands.
+***/
+class ShaderJIT
+{
+    private:
+        constexpr static uint64_t CODE_BUFFER_SIZE = 1024 * 1024 * 8;
+        constexpr static uint64_t MAX_BLOCK_SIZE = 1024 * 64;
+        constexpr static int MAX_BLOCK_INSTRS = 128;
+        constexpr static size_t MAX_PROGRAMS = 256;
+
+        uint8_t* code_buffer;
+        uint8_t* code_pos;
+        X64Emitter emitter;
+
+        std::unordered_multimap<uint64_t, std::unique_ptr<ShaderProgram>> programs;
+
+        //Read by generated code through their absolute addresses
+        struct
+        {
+            uint32_t sign[4];
+            float one[4];
+            uint32_t xyz[4];
+            float w_one[4];
+            uint32_t lane_masks[16][4];
+        } constants;
+
+        //Offsets into ShaderUnit used by generated code
+        int32_t input_offset, temp_offset, output_offset, uniform_offset;
+        int32_t addr_offset, loop_ctr_offset, cmp_offset, pc_offset;
+
+        ShaderBlockFunc compile_block(ShaderProgram& program, uint16_t pc);
+        bool can_compile(const ShaderProgram& program, uint32_t instr);
+        void emit_instr(const ShaderProgram& program, uint32_t instr, uint16_t pc);
+
+        void emit_load_src(X64_XMM dest, uint8_t src, uint8_t idx, uint32_t op_desc, int src_type, uint16_t pc);
+        void emit_store_dest(X64_XMM value, uint8_t dest, uint8_t dest_mask);
+        void emit_mul(X64_XMM a, X64_XMM b);
+        void emit_dot_product(int components);
+        void emit_load_constant(X64_XMM dest, const void* constant);
+    public:
+        ShaderJIT();
+        ~ShaderJIT();
+
+        void reset();
+        bool needs_flush();
+
+        ShaderProgram* get_program(const ShaderUnit& sh);
+        ShaderBlockFunc get_block(ShaderProgram& program, uint16_t pc);
+};
+
+//Checked between shader runs, when no program is executing
+inline bool ShaderJIT::needs_flush()
+{
+    return code_pos + MAX_BLOCK_SIZE > code_buffer + CODE_BUFFER_SIZE || programs.size() >= MAX_PROGRAMS;
+}
+
+inline ShaderBlockFunc ShaderJIT::get_block(ShaderProgram &program, uint16_t pc)
+{
+    if (pc >= sizeof(program.code))
+        return nullptr;
+
+    ShaderBlock& block = program.blocks[pc >> 2];
+    if (!block.compiled)
+        return compile_block(program, pc);
+    return block.code;
+}
+
+#endif // SHADER_JIT_HPP
@@ -152,6 +152,8 @@ WiFi::WiFi(Corelink_DMA* cdma, Scheduler* scheduler) :
     send_sdio_interrupt = nullptr;
     ROM = nullptr;
     RAM = nullptr;
+
+    regdomain_event = scheduler->register_event("WiFi regdomain", [this](uint64_t param) {send_regdomain();});
 }
 
 WiFi::~WiFi()
@@ -250,18 +252,18 @@ void WiFi::run(int cycles)
 
     if ((xtensa_mbox_tx_ctrl[0] & 0x4) && mbox[0].size() == 0x80)
     {
-        printf("[WiFi] Start ARM->Xtensa DMA\n");
+        LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Start ARM->Xtensa DMA\n");
         uint32_t addr = xtensa_mbox_tx_ptr[0];
-        printf("Blorp $%08X $%08X\n", addr, read32_xtensa(addr));
+        LOG(LOG_WIFI, LOG_TRACE, "Blorp $%08X $%08X\n", addr, read32_xtensa(addr));
         if (read32_xtensa(addr) == 0x80608000)
         {
             write32_xtensa(addr, 0x40608000 | 0x80);
             uint32_t pkt_addr = read32_xtensa(addr + 4);
-            printf("Packet addr: $%08X\n", pkt_addr);
+            LOG(LOG_WIFI, LOG_DEBUG, "Packet addr: $%08X\n", pkt_addr);
             for (int i = 0; i < 0x80; i++)
             {
                 uint8_t value = read8_mbox(mbox[0]);
-                printf("Pop $%02X from MBOX0\n", value);
+                LOG(LOG_WIFI, LOG_TRACE, "Pop $%02X from MBOX0\n", value);
                 write8_xtensa(pkt_addr + i, value);
             }
             addr = read32_xtensa(addr + 8);
@@ -275,10 +277,19 @@ void WiFi::run(int cycles)
 #endif
 }
 
+bool WiFi::is_idle()
+{
+#ifdef LLE_WIFI
+    return false;
+#else
+    return true;
+#endif
+}
+
 void WiFi::do_sdio_cmd(uint8_t cmd)
 {
-    printf("[WiFi] CMD%d\n", cmd);
-    printf("Arg: $%08X\n", argument);
+    LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] CMD%d\n", cmd);
+    LOG(LOG_WIFI, LOG_DEBUG, "Arg: $%08X\n", argument);
     switch (cmd)
     {
         case 52:
@@ -301,8 +312,8 @@ void WiFi::sdio_io_direct()
     uint32_t addr = (argument >> 9) & 0x1FFFF;
     uint8_t data;
 
-    printf("[WiFi] Single transfer - addr: %d:%05X\n", func, addr);
-    printf("Is write: %d RAW: %d\n", is_write, read_after_write);
+    LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Single transfer - addr: %d:%05X\n", func, addr);
+    LOG(LOG_WIFI, LOG_DEBUG, "Is write: %d RAW: %d\n", is_write, read_after_write);
 
     if (is_write)
     {
@@ -328,7 +339,7 @@ uint8_t WiFi::sdio_read_io(uint8_t func, uint32_t addr)
         case 1:
             return sdio_read_f1(addr);
         default:
-            printf("[WiFi] Unrecognized IO read %d:%05X\n", func, addr);
+            LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized IO read %d:%05X\n", func, addr);
             return 0;
     }
 }
@@ -393,7 +404,7 @@ uint8_t WiFi::sdio_read_f0(uint32_t addr)
             value = 0;
             break;
         default:
-            printf("[WiFi] Unrecognized F0 read $%05X\n", addr);
+            LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized F0 read $%05X\n", addr);
     }
     return value;
 }
@@ -417,12 +428,12 @@ uint8_t WiFi::sdio_read_f1(uint32_t addr)
     {
         case 0x00400:
             value = irq_f1_stat;
-            printf("[WiFi] IRQ status: $%02X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] IRQ status: $%02X\n", value);
             break;
         case 0x00405:
             for (int i = 0; i < 4; i++)
                 value |= (mbox[i + 4].size() >= 4) << i;
-            printf("[WiFi] Mbox status: $%02X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Mbox status: $%02X\n", value);
             break;
         case 0x00408:
         case 0x00409:
@@ -430,7 +441,7 @@ uint8_t WiFi::sdio_read_f1(uint32_t addr)
         case 0x0040B:
             if (mbox[4].size() >= 4)
                 value = *(&mbox[4].front() + (addr - 0x00408));
-            printf("[WiFi] Peek0: $%02X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Peek0: $%02X\n", value);
             break;
         case 0x00418:
             value = irq_f1_mask;
@@ -444,7 +455,7 @@ uint8_t WiFi::sdio_read_f1(uint32_t addr)
         case 0x00477:
             return window_data >> 24;
         default:
-            printf("[WiFi] Unrecognized F1 read $%05X\n", addr);
+            LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized F1 read $%05X\n", addr);
     }
     return value;
 }
@@ -460,7 +471,7 @@ void WiFi::sdio_write_io(uint8_t func, uint32_t addr, uint8_t value)
             sdio_write_f1(addr, value);
             break;
         default:
-            printf("[WiFi] Unrecognized IO write %d:%05X: $%02X\n", func, addr, value);
+            LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized IO write %d:%05X: $%02X\n", func, addr, value);
     }
 }
 
@@ -469,12 +480,12 @@ void WiFi::sdio_write_f0(uint32_t addr, uint8_t value)
     switch (addr)
     {
         case 0x00004:
-            printf("[WiFi] Set F0 IRQ mask: $%02X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Set F0 IRQ mask: $%02X\n", value);
             irq_f0_mask = value;
             check_f0_irq();
             break;
         default:
-            printf("[WiFi] Unrecognized F0 write $%05X: $%02X\n", addr, value);
+            LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized F0 write $%05X: $%02X\n", addr, value);
     }
 }
 
@@ -499,7 +510,7 @@ void WiFi::sdio_write_f1(uint32_t addr, uint8_t value)
     switch (addr)
     {
         case 0x00418:
-            printf("[WiFi] Set F1 IRQ mask: $%02X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Set F1 IRQ mask: $%02X\n", value);
             irq_f1_mask = value;
             check_f1_irq();
             break;
@@ -542,7 +553,7 @@ void WiFi::sdio_write_f1(uint32_t addr, uint8_t value)
             window_read_addr = (window_read_addr & 0x00FFFFFF) | (value << 24);
             break;
         default:
-            printf("[WiFi] Unrecognized F1 write $%05X: $%02X\n", addr, value);
+            LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized F1 write $%05X: $%02X\n", addr, value);
     }
 }
 
@@ -556,8 +567,8 @@ void WiFi::sdio_io_extended()
     block.count = argument & 0x1FF;
     block.active = true;
 
-    printf("[WiFi] Block transfer - Addr: %d:%05X Count: $%04X\n", block.func, block.addr, block.count);
-    printf("Is write: %d Block mode: %d Inc addr: %d\n", block.is_write, block.block_mode, block.inc_addr);
+    LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Block transfer - Addr: %d:%05X Count: $%04X\n", block.func, block.addr, block.count);
+    LOG(LOG_WIFI, LOG_DEBUG, "Is write: %d Block mode: %d Inc addr: %d\n", block.is_write, block.block_mode, block.inc_addr);
 
     response[0] = 0x2000;
 
@@ -629,7 +640,7 @@ uint16_t WiFi::read_fifo16()
             transfer_amount++;
         }
 
-        printf("[WiFi] Read FIFO16: $%04X (%d)\n", value, block.count);
+        LOG(LOG_WIFI, LOG_TRACE, "[WiFi] Read FIFO16: $%04X (%d)\n", value, block.count);
 
         block.addr += offset * transfer_amount;
         block.count -= transfer_amount;
@@ -649,7 +660,7 @@ uint16_t WiFi::read_fifo16()
 void WiFi::do_wifi_cmd()
 {
 #ifdef LLE_WIFI
-    printf("[WiFi] MBOX ARM->Xtensa transfer finished\n");
+    LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] MBOX ARM->Xtensa transfer finished\n");
     xtensa_mbox_irq_stat |= 1 << 12;
 #else
     switch (boot_status)
@@ -682,7 +693,7 @@ void WiFi::do_bmi_cmd()
         case 0x1:
             //DONE
         {
-            printf("[WiFi] BMI_DONE\n");
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_DONE\n");
             boot_status = 1;
 
             uint8_t ready[] = {0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00};
@@ -695,7 +706,7 @@ void WiFi::do_bmi_cmd()
             uint32_t addr = read32_mbox(mbox[0]);
             uint32_t len = read32_mbox(mbox[0]);
 
-            printf("[WiFi] BMI_READ_MEMORY $%08X $%08X\n", addr, len);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_READ_MEMORY $%08X $%08X\n", addr, len);
 
             addr &= MEMMAP_MASK;
             addr -= RAM_BASE;
@@ -714,7 +725,7 @@ void WiFi::do_bmi_cmd()
             uint32_t addr = read32_mbox(mbox[0]);
             uint32_t len = read32_mbox(mbox[0]);
 
-            printf("[WiFi] BMI_WRITE_MEMORY $%08X $%08X\n", addr, len);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_WRITE_MEMORY $%08X $%08X\n", addr, len);
 
             addr &= MEMMAP_MASK;
             addr -= RAM_BASE;
@@ -734,7 +745,7 @@ void WiFi::do_bmi_cmd()
             uint32_t addr = read32_mbox(mbox[0]);
             uint32_t arg = read32_mbox(mbox[0]);
 
-            printf("[WiFi] BMI_EXECUTE $%08X $%08X\n", addr, arg);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_EXECUTE $%08X $%08X\n", addr, arg);
 
             //Return value
             write32_mbox(mbox[4], 0);
@@ -750,7 +761,7 @@ void WiFi::do_bmi_cmd()
             //READ_SOC_REGISTER
         {
             uint32_t addr = read32_mbox(mbox[0]);
-            printf("[WiFi] BMI_READ_SOC_REGISTER $%08X\n", addr);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_READ_SOC_REGISTER $%08X\n", addr);
             write32_mbox(mbox[4], read_window(addr));
         }
             break;
@@ -759,13 +770,13 @@ void WiFi::do_bmi_cmd()
         {
             uint32_t addr = read32_mbox(mbox[0]);
             uint32_t value = read32_mbox(mbox[0]);
-            printf("[WiFi] BMI_WRITE_SOC_REGISTER $%08X: $%08X\n", addr, value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_WRITE_SOC_REGISTER $%08X: $%08X\n", addr, value);
             write_window(addr, value);
         }
             break;
         case 0x8:
             //GET_TARGET_INFO
-            printf("[WiFi] BMI_GET_TARGET_INFO\n");
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_GET_TARGET_INFO\n");
             write32_mbox(mbox[4], 0xFFFFFFFF);
             write32_mbox(mbox[4], 0x0000000C);
             write32_mbox(mbox[4], 0x230000B3);
@@ -777,27 +788,27 @@ void WiFi::do_bmi_cmd()
             lz_addr = read32_mbox(mbox[0]);
             lz_addr &= MEMMAP_MASK;
             lz_addr -= RAM_BASE;
-            printf("[WiFi] BMI_LZ_STREAM_START: $%08X\n", lz_addr);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_LZ_STREAM_START: $%08X\n", lz_addr);
             doing_lz = false;
         }
             break;
         case 0xE:
         {
             uint32_t len = read32_mbox(mbox[0]);
-            printf("[WiFi] BMI_LZ_STREAM_DATA: $%08X\n", len);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] BMI_LZ_STREAM_DATA: $%08X\n", len);
 
             if (!doing_lz)
             {
                 doing_lz = true;
                 lz_tag = read8_mbox(mbox[0]);
-                printf("Tag: $%02X\n", lz_tag);
+                LOG(LOG_WIFI, LOG_TRACE, "Tag: $%02X\n", lz_tag);
                 len--;
             }
 
             while (len)
             {
                 uint8_t value = read8_mbox(mbox[0]);
-                printf("Read LZ stream: $%02X ($%08X)\n", value, lz_addr);
+                LOG(LOG_WIFI, LOG_TRACE, "Read LZ stream: $%02X ($%08X)\n", value, lz_addr);
                 if (value == lz_tag)
                 {
                     uint8_t temp = read8_mbox(mbox[0]);
@@ -821,7 +832,7 @@ void WiFi::do_bmi_cmd()
                         offset |= temp;
                         len--;
                     }
-                    printf("Decompress $%08X $%08X\n", bytes, offset);
+                    LOG(LOG_WIFI, LOG_TRACE, "Decompress $%08X $%08X\n", bytes, offset);
                     len -= 3;
                     if (bytes == 0)
                     {
@@ -880,7 +891,7 @@ void WiFi::do_htc_cmd()
             *(uint16_t*)&reply[8] = 0x0001;
 
             send_wmi_reply(reply, sizeof(reply), 0, 0, 0);
-            printf("[WiFi] HTC_CONNECT_TO_SERVICE: $%04X $%04X\n", service, flags);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] HTC_CONNECT_TO_SERVICE: $%04X $%04X\n", service, flags);
         }
             break;
         case 0x0004:
@@ -899,22 +910,11 @@ void WiFi::do_htc_cmd()
 
             send_wmi_reply(reply, sizeof(reply), 1, 0, 0);
 
-            auto blorp = [=](uint64_t param)
-            {
-                uint8_t regdomain[6];
-                memset(regdomain, 0, sizeof(regdomain));
-
-                *(uint16_t*)&reply[0] = 0x1006; //WMI_REGDOMAIN event
-                *(uint32_t*)&reply[2] = 0x80000348;
-
-                send_wmi_reply(regdomain, sizeof(regdomain), 1, 0, 0);
-            };
-
-            scheduler->add_event(blorp, 10000, XTENSA_CLOCKRATE, 0);
+            scheduler->add_event(regdomain_event, 10000, XTENSA_CLOCKRATE);
 
             boot_status = 2;
 
-            printf("[WiFi] HTC_SETUP_COMPLETE\n");
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] HTC_SETUP_COMPLETE\n");
         }
             break;
         default:
@@ -938,7 +938,7 @@ void WiFi::do_wmi_cmd()
     {
         case 0x0008:
             //SET_SCAN_PARAMS
-            printf("[WiFi] WMI_SET_SCAN_PARAMS\n");
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] WMI_SET_SCAN_PARAMS\n");
             break;
         case 0x000E:
             //GET_CHANNEL_LIST
@@ -953,11 +953,11 @@ void WiFi::do_wmi_cmd()
             send_wmi_reply(reply, sizeof(reply), 1, 0, 0);
 
             check_f1_irq();
-            printf("[WiFi] WMI_GET_CHANNEL_LIST\n");
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] WMI_GET_CHANNEL_LIST\n");
             break;
         }
         case 0x0049:
-            printf("[WiFi] WMI_HOST_EXIT_NOTIFY\n");
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] WMI_HOST_EXIT_NOTIFY\n");
             break;
         default:
             EmuException::die("[WiFi] Unrecognized WMI command $%02X", cmd);
@@ -968,6 +968,15 @@ void WiFi::do_wmi_cmd()
     mbox[0].swap(empty);
 }
 
+void WiFi::send_regdomain()
+{
+    //TODO: This should carry the WMI_REGDOMAIN event ($1006, $80000348), but a zeroed one is what has been sent so far
+    uint8_t regdomain[6];
+    memset(regdomain, 0, sizeof(regdomain));
+
+    send_wmi_reply(regdomain, sizeof(regdomain), 1, 0, 0);
+}
+
 void WiFi::send_wmi_reply(uint8_t *reply, uint32_t len, uint8_t eid, uint8_t flag, uint16_t ctrl)
 {
     uint32_t total_len = len + 6;
@@ -1017,7 +1026,7 @@ void WiFi::check_card_irq()
     bool new_card_irq = card_irq_stat && !card_irq_mask;
     if (!old_card_irq && new_card_irq)
     {
-        printf("[WiFi] Card IRQ!\n");
+        LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Card IRQ!\n");
         send_sdio_interrupt();
     }
 
@@ -1051,7 +1060,7 @@ void WiFi::write_fifo16(uint16_t value)
 {
     if (block.active)
     {
-        printf("[WiFi] Write FIFO16: $%04X\n", value);
+        LOG(LOG_WIFI, LOG_TRACE, "[WiFi] Write FIFO16: $%04X\n", value);
         int offset = (block.inc_addr) ? 1 : 0;
         int transfer_amount = 1;
         sdio_write_io(block.func, block.addr, value & 0xFF);
@@ -1064,7 +1073,7 @@ void WiFi::write_fifo16(uint16_t value)
 
         block.addr += offset * transfer_amount;
         block.count -= transfer_amount;
-        printf("[WiFi] Count left: %d\n", block.count);
+        LOG(LOG_WIFI, LOG_TRACE, "[WiFi] Count left: %d\n", block.count);
         if (!block.count)
         {
             transfer_end();
@@ -1080,13 +1089,13 @@ void WiFi::write_fifo16(uint16_t value)
 
 uint32_t WiFi::read_window(uint32_t addr)
 {
-    printf("[WiFi] Read window $%08X\n", addr);
+    LOG(LOG_WIFI, LOG_TRACE, "[WiFi] Read window $%08X\n", addr);
     return read32_xtensa(addr);
 }
 
 void WiFi::write_window(uint32_t addr, uint32_t value)
 {
-    printf("[WiFi] Write window $%08X: $%08X\n", addr, value);
+    LOG(LOG_WIFI, LOG_TRACE, "[WiFi] Write window $%08X: $%08X\n", addr, value);
     if (addr == 2)
         return;
     write32_xtensa(addr, value);
@@ -1101,7 +1110,7 @@ uint16_t WiFi::read16(uint32_t addr)
 {
     addr &= 0xFFF;
     uint16_t reg = 0;
-    printf("[WiFi] Read16 $%08X\n", addr);
+    LOG(LOG_WIFI, LOG_TRACE, "[WiFi] Read16 $%08X\n", addr);
     if (addr >= 0x00C && addr < 0x01C)
     {
         int index = ((addr - 0x00C) / 4) & 0x3;
@@ -1116,11 +1125,11 @@ uint16_t WiFi::read16(uint32_t addr)
         case 0x01C:
             reg = istat & 0xFFFF;
             reg |= 1 << 5; //always inserted
-            printf("[WiFi] Read ISTAT_L: $%04X\n", reg);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Read ISTAT_L: $%04X\n", reg);
             break;
         case 0x01E:
             reg = istat >> 16;
-            printf("[WiFi] Read ISTAT_H: $%04X\n", reg);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Read ISTAT_H: $%04X\n", reg);
             break;
         case 0x020:
             reg = imask & 0xFFFF;
@@ -1147,7 +1156,7 @@ uint16_t WiFi::read16(uint32_t addr)
             reg |= data32_irq.tx32rq_irq_enable << 12;
             break;
         default:
-            printf("[WiFi] Unrecognized read16 $%08X\n", addr);
+            LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized read16 $%08X\n", addr);
     }
     return reg;
 }
@@ -1177,12 +1186,12 @@ void WiFi::write16(uint32_t addr, uint16_t value)
         case 0x020:
             imask &= ~0xFFFF;
             imask |= value;
-            printf("[WiFi] Write IMASK_L: $%04X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write IMASK_L: $%04X\n", value);
             break;
         case 0x022:
             imask &= 0xFFFF;
             imask |= value << 16;
-            printf("[WiFi] Write IMASK_H: $%04X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write IMASK_H: $%04X\n", value);
             break;
         case 0x026:
             block16_len = value;
@@ -1197,7 +1206,7 @@ void WiFi::write16(uint32_t addr, uint16_t value)
             old_card_irq = false;
             break;
         case 0x038:
-            printf("[WiFi] Card IRQ mask: $%04X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Card IRQ mask: $%04X\n", value);
             card_irq_mask = value & 0x1;
             check_card_irq();
             break;
@@ -1205,10 +1214,10 @@ void WiFi::write16(uint32_t addr, uint16_t value)
             data32_irq.data32_mode = (value >> 1) & 0x1;
             data32_irq.rx32rdy_irq_enable = (value >> 11) & 0x1;
             data32_irq.tx32rq_irq_enable = (value >> 12) & 0x1;
-            printf("[WiFi] Set SD_DATA32_IRQ: $%04X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Set SD_DATA32_IRQ: $%04X\n", value);
             break;
         default:
-            printf("[WiFi] Unrecognized write16 $%08X: $%04X\n", addr, value);
+            LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized write16 $%08X: $%04X\n", addr, value);
     }
 }
 
@@ -1250,7 +1259,7 @@ uint32_t WiFi::read32_xtensa(uint32_t addr)
 
     if (addr >= 0x18080 && addr < 0x180A0)
     {
-        printf("[WiFi] Read32 Xtensa WLAN_LOCAL_COUNT $%08X\n", addr);
+        LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Read32 Xtensa WLAN_LOCAL_COUNT $%08X\n", addr);
         return 0;
     }
 
@@ -1336,7 +1345,7 @@ uint32_t WiFi::read32_xtensa(uint32_t addr)
             //GPIO
             return 0;
         case 0x14048:
-            printf("[WiFi] Read32 Xtensa GPIO_PIN8\n");
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Read32 Xtensa GPIO_PIN8\n");
             return 0;
         case 0x18000:
             return mbox_tpop[0];
@@ -1357,7 +1366,7 @@ uint32_t WiFi::read32_xtensa(uint32_t addr)
             return 0;
     }
 
-    printf("[WiFi] Unrecognized Xtensa read32 $%08X\n", addr);
+    LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized Xtensa read32 $%08X\n", addr);
     return 0;
 }
 
@@ -1396,26 +1405,26 @@ void WiFi::write32_xtensa(uint32_t addr, uint32_t value)
 
     if (addr >= 0x8000 && addr < 0x8080)
     {
-        printf("[WiFi] Write32 Xtensa MC_TCAM_VALID $%08X: $%08X\n", addr, value);
+        LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa MC_TCAM_VALID $%08X: $%08X\n", addr, value);
         return;
     }
 
     if (addr >= 0x18080 && addr < 0x180A0)
     {
-        printf("[WiFi] Write32 Xtensa WLAN_LOCAL_COUNT $%08X: $%08X\n", addr, value);
+        LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa WLAN_LOCAL_COUNT $%08X: $%08X\n", addr, value);
         return;
     }
 
     if (addr >= 0x180A0 && addr < 0x180C0)
     {
-        printf("[WiFi] Write32 Xtensa WLAN_COUNT_INC $%08X: $%08X\n", addr, value);
+        LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa WLAN_COUNT_INC $%08X: $%08X\n", addr, value);
         return;
     }
 
     switch (addr)
     {
         case 0x04000:
-            printf("[WiFi] Write32 Xtensa SOC_RESET_CONTROL: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa SOC_RESET_CONTROL: $%08X\n", value);
             //reset();
             return;
         case 0x04014:
@@ -1423,7 +1432,7 @@ void WiFi::write32_xtensa(uint32_t addr, uint32_t value)
             return;
         case 0x04018:
             //PLL_SETTLE
-            printf("[WiFi] Write32 Xtensa PLL_SETTLE: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa PLL_SETTLE: $%08X\n", value);
             return;
         case 0x04020:
             //SOC_CPU_CLOCK
@@ -1465,19 +1474,19 @@ void WiFi::write32_xtensa(uint32_t addr, uint32_t value)
             timers.write_int_status(4, value);
             return;
         case 0x040C4:
-            printf("[WiFi] Write32 Xtensa SOC_SYSTEM_SLEEP: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa SOC_SYSTEM_SLEEP: $%08X\n", value);
             return;
         case 0x040CC:
             //MAC_SLEEP_CONTROL
             return;
         case 0x040D4:
-            printf("[WiFi] Write32 Xtensa SOC_LPO_CAL_TIME: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa SOC_LPO_CAL_TIME: $%08X\n", value);
             return;
         case 0x040D8:
-            printf("[WiFi] Write32 Xtensa SOC_LPO_INIT_DIVIDEND_INT: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa SOC_LPO_INIT_DIVIDEND_INT: $%08X\n", value);
             return;
         case 0x040DC:
-            printf("[WiFi] Write32 Xtensa SOC_LPO_INIT_DIVIDENT_FRACTION: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa SOC_LPO_INIT_DIVIDENT_FRACTION: $%08X\n", value);
             return;
         case 0x040F0:
             //More clock control
@@ -1492,34 +1501,34 @@ void WiFi::write32_xtensa(uint32_t addr, uint32_t value)
             //I2C config
             return;
         case 0x10004:
-            printf("[WiFi] Write32 Xtensa SI_CS: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa SI_CS: $%08X\n", value);
             if (value & (1 << 8))
             {
                 //Start a transfer
                 uint32_t addr = ((xtensa_i2c_tx[0] >> 1) & 0x3) * 0x100;
                 addr |= xtensa_i2c_tx[1];
 
-                printf("[WiFi] EEPROM read $%08X\n", addr);
+                LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] EEPROM read $%08X\n", addr);
                 memcpy(xtensa_i2c_rx, &eeprom[addr], 8);
                 xtensa_i2c_done = true;
             }
             return;
         case 0x10008:
-            printf("[WiFi] Write32 Xtensa SI_TX_DATA0: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa SI_TX_DATA0: $%08X\n", value);
             *(uint32_t*)&xtensa_i2c_tx[0] = value;
             return;
         case 0x14010:
-            printf("[WiFi] Write32 Xtensa WLAN_GPIO_ENABLE_W1TS: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa WLAN_GPIO_ENABLE_W1TS: $%08X\n", value);
             return;
         case 0x14030:
         case 0x14034:
             //GPIO
             return;
         case 0x14048:
-            printf("[WiFi] Write32 Xtensa GPIO_PIN8: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa GPIO_PIN8: $%08X\n", value);
             return;
         case 0x18000:
-            printf("[WiFi] Write32 Xtensa MBOX reply: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa MBOX reply: $%08X\n", value);
             write8_mbox(mbox[4], value & 0xFF);
             check_f1_irq();
             return;
@@ -1527,29 +1536,29 @@ void WiFi::write32_xtensa(uint32_t addr, uint32_t value)
         case 0x18028:
         case 0x18038:
         case 0x18048:
-            printf("[WiFi] Write32 Xtensa MBOX%d RX DMA base: $%08X\n", ((addr & 0xF0) >> 4) - 1, value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa MBOX%d RX DMA base: $%08X\n", ((addr & 0xF0) >> 4) - 1, value);
             xtensa_mbox_rx_ptr[((addr & 0xF0) >> 4) - 1] = value;
             return;
         case 0x1801C:
         case 0x1802C:
         case 0x1803C:
         case 0x1804C:
-            printf("[WiFi] Write32 Xtensa MBOX%d RX DMA control: $%08X\n", ((addr & 0xF0) >> 4) - 1, value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa MBOX%d RX DMA control: $%08X\n", ((addr & 0xF0) >> 4) - 1, value);
             if (value & 0x4)
             {
                 int index = ((addr & 0xF0) >> 4) - 1;
                 uint32_t addr = xtensa_mbox_rx_ptr[index];
-                printf("Blorp $%08X $%08X\n", addr, read32_xtensa(addr));
+                LOG(LOG_WIFI, LOG_TRACE, "Blorp $%08X $%08X\n", addr, read32_xtensa(addr));
                 while (read32_xtensa(addr) == 0xC0000080)
                 {
                     write32_xtensa(addr, 0x40000080);
                     uint32_t pkt_addr = read32_xtensa(addr + 4);
-                    printf("[WiFi] Starting MBOX%d RX DMA at $%08X\n", index, addr);
-                    printf("Packet addr: $%08X\n", pkt_addr);
+                    LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Starting MBOX%d RX DMA at $%08X\n", index, addr);
+                    LOG(LOG_WIFI, LOG_DEBUG, "Packet addr: $%08X\n", pkt_addr);
                     for (int i = 0; i < 0x80; i++)
                     {
                         uint8_t value = read8_xtensa(pkt_addr + i);
-                        printf("Push $%02X to MBOX%d\n", value, index);
+                        LOG(LOG_WIFI, LOG_TRACE, "Push $%02X to MBOX%d\n", value, index);
                         write8_mbox(mbox[index + 4], value);
                     }
                     addr = read32_xtensa(addr + 8);
@@ -1563,28 +1572,28 @@ void WiFi::write32_xtensa(uint32_t addr, uint32_t value)
         case 0x18030:
         case 0x18040:
         case 0x18050:
-            printf("[WiFi] Write32 Xtensa MBOX%d TX DMA base: $%08X\n", ((addr & 0xF0) >> 4) - 2, value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa MBOX%d TX DMA base: $%08X\n", ((addr & 0xF0) >> 4) - 2, value);
             xtensa_mbox_tx_ptr[((addr & 0xF0) >> 4) - 2] = value;
             return;
         case 0x18024:
         case 0x18034:
         case 0x18044:
         case 0x18054:
-            printf("[WiFi] Write32 Xtensa MBOX%d TX DMA control: $%08X\n", ((addr & 0xF0) >> 4) - 2, value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa MBOX%d TX DMA control: $%08X\n", ((addr & 0xF0) >> 4) - 2, value);
             xtensa_mbox_tx_ctrl[((addr & 0xF0) >> 4) - 2] = value;
             return;
         case 0x18058:
-            printf("[WiFi] Write32 Xtensa WLAN_MBOX_INT_STATUS: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa WLAN_MBOX_INT_STATUS: $%08X\n", value);
             xtensa_mbox_irq_stat &= ~value;
             if (!mbox[0].empty())
                 xtensa_mbox_irq_stat |= 1 << 12;
             return;
         case 0x1805C:
-            printf("[WiFi] Write32 Xtensa WLAN_MBOX_INT_ENABLE: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa WLAN_MBOX_INT_ENABLE: $%08X\n", value);
             xtensa_mbox_irq_enable = value;
             return;
         case 0x180C0:
-            printf("[WiFi] Write32 Xtensa LOCAL_SCRATCH[0]: $%08X\n", value);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Write32 Xtensa LOCAL_SCRATCH[0]: $%08X\n", value);
             return;
         case 0x180E4:
             //Some sort of SDIO config?
@@ -1596,14 +1605,14 @@ void WiFi::write32_xtensa(uint32_t addr, uint32_t value)
             if (!mbox[0].empty())
                 mbox_tpop[0] |= read8_mbox(mbox[0]);
 
-            printf("[WiFi] Xtensa MBOX read: $%08X\n", mbox_tpop[0]);
+            LOG(LOG_WIFI, LOG_DEBUG, "[WiFi] Xtensa MBOX read: $%08X\n", mbox_tpop[0]);
             return;
         case 0x28048:
             //MAC_PCU_DIAG_SW
             return;
     }
 
-    printf("[WiFi] Unrecognized Xtensa write32 $%08X: $%08X\n", addr, value);
+    LOG(LOG_WIFI, LOG_WARN, "[WiFi] Unrecognized Xtensa write32 $%08X: $%08X\n", addr, value);
 }
 
 uint32_t WiFi::read_fifo32()
@@ -32,6 +32,7 @@ class WiFi
     private:
         Corelink_DMA* cdma;
         Scheduler* scheduler;
+        int regdomain_event;
 
         WiFi_Timers timers;
         Xtensa xtensa;
@@ -105,6 +106,7 @@ class WiFi
         void do_wmi_cmd();
 
         void send_wmi_reply(uint8_t* reply, uint32_t len, uint8_t eid, uint8_t flag, uint16_t ctrl);
+        void send_regdomain();
         void send_xtensa_soc_irq(int id);
         void clear_xtensa_soc_irq(int id);
 
@@ -123,6 +125,7 @@ class WiFi
 
         void reset();
         void run(int cycles);
+        bool is_idle();
         void set_sdio_interrupt_handler(std::function<void()> func);
 
         uint16_t read16(uint32_t addr);
@@ -1,5 +1,6 @@
 #include <cstring>
 #include <cstdio>
+#include "../common/log.hpp"
 #include "wifi_timers.hpp"
 
 WiFi_Timers::WiFi_Timers()
@@ -62,13 +63,13 @@ uint32_t WiFi_Timers::read_int_status(int index)
 
 void WiFi_Timers::write_int_status(int index, uint32_t value)
 {
-    printf("[WiFi_Timing] Write int_status%d: $%08X\n", index, value);
+    LOG(LOG_WIFI, LOG_DEBUG, "[WiFi_Timing] Write int_status%d: $%08X\n", index, value);
     timers[index].int_status &= value & 0x1;
 }
 
 void WiFi_Timers::write_target(int index, uint32_t value)
 {
-    printf("[WiFi_Timing] Write target%d: $%08X\n", index, value);
+    LOG(LOG_WIFI, LOG_DEBUG, "[WiFi_Timing] Write target%d: $%08X\n", index, value);
 
     if (index == 4)
         value >>= 12;
@@ -77,7 +78,7 @@ void WiFi_Timers::write_target(int index, uint32_t value)
 
 void WiFi_Timers::write_ctrl(int index, uint32_t value)
 {
-    printf("[WiFi_Timing] Write ctrl%d: $%08X\n", index, value);
+    LOG(LOG_WIFI, LOG_DEBUG, "[WiFi_Timing] Write ctrl%d: $%08X\n", index, value);
 
     if (value & 0x1)
         timers[index].count = 0;
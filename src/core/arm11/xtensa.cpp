@@ -58,7 +58,7 @@ uint16_t Xtensa::fetch_word()
 
 uint8_t Xtensa::read8(uint32_t addr)
 {
-    printf("[Xtensa] Read8 $%08X\n", addr);
+    LOG(LOG_XTENSA, LOG_TRACE, "[Xtensa] Read8 $%08X\n", addr);
     return wifi->read8_xtensa(addr);
 }
 
@@ -66,7 +66,7 @@ uint16_t Xtensa::read16(uint32_t addr)
 {
     if (addr & 0x1)
         EmuException::die("[Xtensa] Invalid read16 $%08X", addr);
-    printf("[Xtensa] Read16 $%08X\n", addr);
+    LOG(LOG_XTENSA, LOG_TRACE, "[Xtensa] Read16 $%08X\n", addr);
     return wifi->read16_xtensa(addr);
 }
 
@@ -74,13 +74,13 @@ uint32_t Xtensa::read32(uint32_t addr)
 {
     if (addr & 0x3)
         EmuException::die("[Xtensa] Invalid read32 $%08X", addr);
-    printf("[Xtensa] Read32 $%08X\n", addr);
+    LOG(LOG_XTENSA, LOG_TRACE, "[Xtensa] Read32 $%08X\n", addr);
     return wifi->read32_xtensa(addr);
 }
 
 void Xtensa::write8(uint32_t addr, uint8_t value)
 {
-    printf("[Xtensa] Write8 $%08X: $%02X\n", addr, value);
+    LOG(LOG_XTENSA, LOG_TRACE, "[Xtensa] Write8 $%08X: $%02X\n", addr, value);
     wifi->write8_xtensa(addr, value);
 }
 
@@ -88,7 +88,7 @@ void Xtensa::write16(uint32_t addr, uint16_t value)
 {
     if (addr & 0x1)
         EmuException::die("[Xtensa] Invalid write16 $%08X: $%04X", addr, value);
-    printf("[Xtensa] Write16 $%08X: $%04X\n", addr, value);
+    LOG(LOG_XTENSA, LOG_TRACE, "[Xtensa] Write16 $%08X: $%04X\n", addr, value);
     wifi->write16_xtensa(addr, value);
 }
 
@@ -97,7 +97,7 @@ void Xtensa::write32(uint32_t addr, uint32_t value)
     if (addr & 0x3)
         EmuException::die("[Xtensa] Invalid write32 $%08X: $%08X", addr, value);
     if (addr >= 0x520000)
-        printf("[Xtensa] Write32 $%08X: $%08X\n", addr, value);
+        LOG(LOG_XTENSA, LOG_TRACE, "[Xtensa] Write32 $%08X: $%08X\n", addr, value);
     wifi->write32_xtensa(addr, value);
 }
 
@@ -189,14 +189,14 @@ uint32_t Xtensa::get_xsr(int index)
             reg = excsave[index - 209];
             break;
         case 226:
-            printf("Interrupt: $%08X\n", interrupt);
+            LOG(LOG_XTENSA, LOG_DEBUG, "Interrupt: $%08X\n", interrupt);
             return interrupt;
         case 228:
             return intenable;
         case 230:
             return get_ps();
         default:
-            printf("[Xtensa] Unrecognized XSR %d in get_xsr\n", index);
+            LOG(LOG_XTENSA, LOG_WARN, "[Xtensa] Unrecognized XSR %d in get_xsr\n", index);
     }
     return reg;
 }
@@ -237,18 +237,18 @@ void Xtensa::set_xsr(int index, uint32_t value)
             excsave[index - 209] = value;
             break;
         case 227:
-            printf("[Xtensa] Write interrupt $%08X\n", value);
+            LOG(LOG_XTENSA, LOG_DEBUG, "[Xtensa] Write interrupt $%08X\n", value);
             interrupt &= ~value;
             break;
         case 228:
-            printf("[Xtensa] Int enable: $%08X\n", value);
+            LOG(LOG_XTENSA, LOG_DEBUG, "[Xtensa] Int enable: $%08X\n", value);
             intenable = value;
             break;
         case 230:
             set_ps(value);
             break;
         default:
-            printf("[Xtensa] Unrecognized XSR %d in set_xsr ($%08X)\n", index, value);
+            LOG(LOG_XTENSA, LOG_WARN, "[Xtensa] Unrecognized XSR %d in set_xsr ($%08X)\n", index, value);
     }
 }
 
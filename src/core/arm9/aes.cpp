@@ -116,10 +116,10 @@ void AES::gen_normal_key(int slot)
     n128_add((uint8_t*)normal, (uint8_t*)key_const);
     n128_rrot((uint8_t*)normal, 41);
 
-    printf("[AES] Generated key: ");
+    LOG(LOG_AES, LOG_DEBUG, "[AES] Generated key: ");
     for (int i = 0; i < 16; i++)
-        printf("%02x", normal[i]);
-    printf("\n");
+        LOG(LOG_AES, LOG_DEBUG, "%02x", normal[i]);
+    LOG(LOG_AES, LOG_DEBUG, "\n");
 
     memcpy(keys[slot].normal, normal, 16);
 }
@@ -135,10 +135,10 @@ void AES::gen_dsi_key(int slot)
     n128_add((uint8_t*)normal, (uint8_t*)dsi_const);
     n128_lrot((uint8_t*)normal, 42);
 
-    printf("[AES] Generated DSi key: ");
+    LOG(LOG_AES, LOG_DEBUG, "[AES] Generated DSi key: ");
     for (int i = 0; i < 16; i++)
-        printf("%02x", normal[i]);
-    printf("\n");
+        LOG(LOG_AES, LOG_DEBUG, "%02x", normal[i]);
+    LOG(LOG_AES, LOG_DEBUG, "\n");
 
     memcpy(keys[slot].normal, normal, 16);
 }
@@ -226,7 +226,7 @@ void AES::write_input_fifo(uint32_t value)
 
 void AES::decrypt_ccm()
 {
-    printf("[AES] Decrypt CCM\n");
+    LOG(LOG_AES, LOG_TRACE, "[AES] Decrypt CCM\n");
 
     for (int i = 0; i < 4; i++)
     {
@@ -252,7 +252,7 @@ void AES::crypt_ctr()
 
 void AES::decrypt_cbc()
 {
-    printf("[AES] Decrypt CBC\n");
+    LOG(LOG_AES, LOG_TRACE, "[AES] Decrypt CBC\n");
     for (int i = 0; i < 4; i++)
     {
         *(uint32_t*)&crypt_results[i * 4] = input_fifo.front();
@@ -264,7 +264,7 @@ void AES::decrypt_cbc()
 
 void AES::encrypt_cbc()
 {
-    printf("[AES] Encrypt CBC\n");
+    LOG(LOG_AES, LOG_TRACE, "[AES] Encrypt CBC\n");
     for (int i = 0; i < 4; i++)
     {
         *(uint32_t*)&crypt_results[i * 4] = input_fifo.front();
@@ -276,7 +276,7 @@ void AES::encrypt_cbc()
 
 void AES::decrypt_ecb()
 {
-    printf("[AES] Decrypt ECB\n");
+    LOG(LOG_AES, LOG_TRACE, "[AES] Decrypt ECB\n");
     for (int i = 0; i < 4; i++)
     {
         *(uint32_t*)&crypt_results[i * 4] = input_fifo.front();
@@ -323,32 +323,32 @@ uint32_t AES::read32(uint32_t addr)
             //printf("[AES] Read RDFIFO: $%08X\n", reg);
             break;
         default:
-            printf("[AES] Unrecognized read32 $%08X\n", addr);
+            LOG(LOG_AES, LOG_WARN, "[AES] Unrecognized read32 $%08X\n", addr);
     }
     return reg;
 }
 
 void AES::write_mac_count(uint16_t value)
 {
-    printf("[AES] MAC count: $%04X\n", value);
+    LOG(LOG_AES, LOG_DEBUG, "[AES] MAC count: $%04X\n", value);
     mac_count = value;
 }
 
 void AES::write_block_count(uint16_t value)
 {
-    printf("[AES] Block count: $%04X\n", value);
+    LOG(LOG_AES, LOG_DEBUG, "[AES] Block count: $%04X\n", value);
     block_count = value;
 }
 
 void AES::write_keysel(uint8_t value)
 {
-    printf("[AES] KEYSEL: $%02X\n", value);
+    LOG(LOG_AES, LOG_DEBUG, "[AES] KEYSEL: $%02X\n", value);
     KEYSEL = value;
 }
 
 void AES::write_keycnt(uint8_t value)
 {
-    printf("[AES] KEYCNT: $%02X\n", value);
+    LOG(LOG_AES, LOG_DEBUG, "[AES] KEYCNT: $%02X\n", value);
     KEYCNT = value;
 }
 
@@ -356,7 +356,7 @@ void AES::write32(uint32_t addr, uint32_t value)
 {
     if (addr >= 0x10009020 && addr < 0x10009030)
     {
-        printf("[AES] Write CTR $%08X: $%08X\n", addr, value);
+        LOG(LOG_AES, LOG_DEBUG, "[AES] Write CTR $%08X: $%08X\n", addr, value);
 
         input_vector((uint8_t*)AES_CTR, 3 - ((addr / 4) & 0x3), value, 4, true);
         AES_ctx_set_iv(&lib_aes_ctx, (uint8_t*)AES_CTR);
@@ -374,29 +374,29 @@ void AES::write32(uint32_t addr, uint32_t value)
         switch (fifo_id)
         {
             case 0:
-                printf("[AES] Write DSi KEY%d NORMAL: $%08X\n", key, value);
+                LOG(LOG_AES, LOG_DEBUG, "[AES] Write DSi KEY%d NORMAL: $%08X\n", key, value);
                 input_vector((uint8_t*)keys[key].normal, offset, value, 4, true);
                 break;
             case 1:
-                printf("[AES] Write DSi KEY%d X: $%08X\n", key, value);
+                LOG(LOG_AES, LOG_DEBUG, "[AES] Write DSi KEY%d X: $%08X\n", key, value);
                 input_vector((uint8_t*)keys[key].x, offset, value, 4, true);
                 break;
             case 2:
-                printf("[AES] Write DSi KEY%d Y: $%08X\n", key, value);
+                LOG(LOG_AES, LOG_DEBUG, "[AES] Write DSi KEY%d Y: $%08X\n", key, value);
                 input_vector((uint8_t*)keys[key].y, offset, value, 4, true);
 
                 //Keygen is done every time the keyslot is updated
                 gen_dsi_key(key);
                 break;
         }
-        printf("Addr: $%08X\n", addr + 0x10009040);
+        LOG(LOG_AES, LOG_DEBUG, "Addr: $%08X\n", addr + 0x10009040);
         return;
     }
 
     switch (addr)
     {
         case 0x10009000:
-            printf("[AES] Write CNT: $%08X\n", value);
+            LOG(LOG_AES, LOG_DEBUG, "[AES] Write CNT: $%08X\n", value);
             if ((AES_CNT.in_word_order << 25) ^ (value & (1 << 25)))
             {
                 //Flush key FIFOs
@@ -428,14 +428,14 @@ void AES::write32(uint32_t addr, uint32_t value)
         case 0x10009004:
             mac_count = value & 0xFFFF;
             block_count = (value >> 16);
-            printf("[AES] MAC count: $%08X\n", mac_count);
+            LOG(LOG_AES, LOG_DEBUG, "[AES] MAC count: $%08X\n", mac_count);
             return;
         case 0x10009008:
             //printf("[AES] Write WRFIFO: $%08X\n", value);
             write_input_fifo(value);
             return;
         case 0x10009100:
-            printf("[AES] Write KEYFIFO: $%08X\n", value);
+            LOG(LOG_AES, LOG_DEBUG, "[AES] Write KEYFIFO: $%08X\n", value);
             input_vector((uint8_t*)normal_fifo, normal_ctr, value, 4);
             normal_ctr++;
 
@@ -447,7 +447,7 @@ void AES::write32(uint32_t addr, uint32_t value)
             }
             return;
         case 0x10009104:
-            printf("[AES] Write XFIFO: $%08X\n", value);
+            LOG(LOG_AES, LOG_DEBUG, "[AES] Write XFIFO: $%08X\n", value);
             input_vector((uint8_t*)x_fifo, x_ctr, value, 4);
             x_ctr++;
 
@@ -458,7 +458,7 @@ void AES::write32(uint32_t addr, uint32_t value)
             }
             return;
         case 0x10009108:
-            printf("[AES] Write YFIFO: $%08X\n", value);
+            LOG(LOG_AES, LOG_DEBUG, "[AES] Write YFIFO: $%08X\n", value);
             input_vector((uint8_t*)y_fifo, y_ctr, value, 4);
             y_ctr++;
 
@@ -471,7 +471,7 @@ void AES::write32(uint32_t addr, uint32_t value)
             }
             return;
     }
-    printf("[AES] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    LOG(LOG_AES, LOG_WARN, "[AES] Unrecognized write32 $%08X: $%08X\n", addr, value);
 }
 
 void AES::input_vector(uint8_t *vector, int index, uint32_t value, int max_words, bool force_order)
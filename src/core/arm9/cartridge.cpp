@@ -49,7 +49,7 @@ void Cartridge::save_check()
 {
     if (card_inserted() && save_dirty)
     {
-        printf("Save check!");
+        LOG(LOG_CART, LOG_DEBUG, "Save check!");
         std::ofstream save_file(save_file_name, std::ios::binary);
         save_file.write((char*)save_data, save_size);
         save_file.close();
@@ -100,7 +100,7 @@ bool Cartridge::mount(std::string file_name)
 
         cart_id |= SIZE_BYTES[size_index] << 8;
         cart_id |= is_card2 << 27;
-        printf("[Cartridge] Calculated cart ID: $%08X\n", cart_id);
+        LOG(LOG_CART, LOG_DEBUG, "[Cartridge] Calculated cart ID: $%08X\n", cart_id);
         return true;
     }
     return false;
@@ -114,7 +114,7 @@ void Cartridge::init_card1_save(std::string file_name)
         extension_start--;
 
     save_file_name = file_name.substr(0, extension_start) + ".sav";
-    printf("Save name: %s\n", save_file_name.c_str());
+    LOG(LOG_CART, LOG_DEBUG, "Save name: %s\n", save_file_name.c_str());
 
     //Attempt to load a save, if possible
     save_data = new uint8_t[1024 * 1024 * 8];
@@ -137,7 +137,7 @@ void Cartridge::init_card1_save(std::string file_name)
         else if (save_size == 1024 * 1024 * 8)
             save_id |= 0x17 << 16;
         else
-            printf("[SPICARD] WARNING: Save size is not 128 KB, 512 KB, or 8 MB and thus will not be loaded");
+            LOG(LOG_CART, LOG_WARN, "[SPICARD] WARNING: Save size is not 128 KB, 512 KB, or 8 MB and thus will not be loaded");
 
         if (save_id & 0x00FF0000)
         {
@@ -230,7 +230,7 @@ void Cartridge::process_ctr_cmd()
         case 0xBF:
             //Read
             read_addr = bswp32(*(uint32_t*)&cmd_buffer[4]);
-            printf("[CTRCARD] Reading from $%08X\n", read_addr);
+            LOG(LOG_CART, LOG_DEBUG, "[CTRCARD] Reading from $%08X\n", read_addr);
             ctr_romctrl.data_ready = true;
             card.seekg(read_addr);
             data_bytes_left = read_block_count * 0x200;
@@ -249,7 +249,7 @@ void Cartridge::process_ctr_cmd()
             ctr_romctrl.busy = false;
             card2_active = true;
             card.seekg(card2_write_addr);
-            printf("[CTRCARD] Card2 start write (addr: $%llX, bytes: $%08X)\n", card2_write_addr, data_bytes_left);
+            LOG(LOG_CART, LOG_DEBUG, "[CTRCARD] Card2 start write (addr: $%llX, bytes: $%08X)\n", (unsigned long long)card2_write_addr, data_bytes_left);
             break;
         case 0xC4:
             //Card2: Unknown
@@ -269,7 +269,7 @@ void Cartridge::process_ctr_cmd()
             break;
         case 0xC7:
             //Card2: Get write status? Sent after 0x200 bytes have been transferred for 0xC3
-            printf("[CTRCARD] Card2 flush\n");
+            LOG(LOG_CART, LOG_DEBUG, "[CTRCARD] Card2 flush\n");
             data_pos = 0;
             data_bytes_left += 4;
             data_buffer[0] = card2_active;
@@ -287,7 +287,7 @@ void Cartridge::process_spicard_cmd()
     switch (spi_state)
     {
         case SPICARD_STATE::IDLE:
-            printf("[SPICARD] Selected!\n");
+            LOG(LOG_CART, LOG_DEBUG, "[SPICARD] Selected!\n");
             spi_state = SPICARD_STATE::SELECTED;
             break;
         case SPICARD_STATE::SELECTED:
@@ -302,7 +302,7 @@ void Cartridge::process_spicard_cmd()
                     spi_save_addr |= spi_input_buffer[2] << 8;
                     spi_save_addr |= spi_input_buffer[3];
 
-                    printf("[SPICARD] Writing $%08X\n", spi_save_addr);
+                    LOG(LOG_CART, LOG_DEBUG, "[SPICARD] Writing $%08X\n", spi_save_addr);
                     break;
                 case 0x03:
                     spi_state = SPICARD_STATE::SELECTED;
@@ -311,7 +311,7 @@ void Cartridge::process_spicard_cmd()
                     spi_save_addr |= spi_input_buffer[3];
                     memcpy(spi_output_buffer, save_data + spi_save_addr,
                            std::min(spi_block_len, (int)sizeof(spi_output_buffer)));
-                    printf("[SPICARD] Reading from $%08X\n", spi_save_addr);
+                    LOG(LOG_CART, LOG_DEBUG, "[SPICARD] Reading from $%08X\n", spi_save_addr);
                     break;
                 case 0x05:
                     //Read status register
@@ -342,7 +342,7 @@ void Cartridge::process_spicard_cmd()
                     spi_save_addr = spi_input_buffer[0] << 16;
                     spi_save_addr |= spi_input_buffer[1] << 8;
                     spi_save_addr |= spi_input_buffer[2];
-                    printf("[SPICARD] Reading from $%08X\n", spi_save_addr);
+                    LOG(LOG_CART, LOG_DEBUG, "[SPICARD] Reading from $%08X\n", spi_save_addr);
                     memcpy(spi_output_buffer, save_data + spi_save_addr,
                            std::min(spi_block_len, (int)sizeof(spi_output_buffer)));
                     break;
@@ -365,7 +365,7 @@ uint16_t Cartridge::read16_ntr(uint32_t addr)
         case 0x10164000:
             return ntr_enable;
         default:
-            printf("[NTRCARD] Unrecognized read16 $%08X\n", addr);
+            LOG(LOG_CART, LOG_WARN, "[NTRCARD] Unrecognized read16 $%08X\n", addr);
     }
     return reg;
 }
@@ -391,7 +391,7 @@ uint32_t Cartridge::read32_ntr(uint32_t addr)
             }
             break;
         default:
-            printf("[NTRCARD] Unrecognized read32 $%08X\n", addr);
+            LOG(LOG_CART, LOG_WARN, "[NTRCARD] Unrecognized read32 $%08X\n", addr);
     }
     return reg;
 }
@@ -410,7 +410,7 @@ uint32_t Cartridge::read32_ctr(uint32_t addr)
             break;
         case 0x10004008:
             reg = ctr_secctrl | (1 << 14);
-            printf("[CTRCARD] Read32 SECCTRL: $%08X\n", reg);
+            LOG(LOG_CART, LOG_DEBUG, "[CTRCARD] Read32 SECCTRL: $%08X\n", reg);
             break;
         case 0x10004030:
             reg = *(uint32_t*)&data_buffer[data_pos];
@@ -436,7 +436,7 @@ uint32_t Cartridge::read32_ctr(uint32_t addr)
             //printf("[CTRCARD] Read32 output FIFO: $%08X\n", reg);
             break;
         default:
-            printf("[CTRCARD] Unrecognized read32 $%08X\n", addr);
+            LOG(LOG_CART, LOG_WARN, "[CTRCARD] Unrecognized read32 $%08X\n", addr);
     }
     return reg;
 }
@@ -473,7 +473,7 @@ uint32_t Cartridge::read32_spicard(uint32_t addr)
             //printf("[SPICARD] Read32 NSPI_FIFO: $%08X\n", reg);
             break;
         default:
-            printf("[SPICARD] Unrecognized read32 $%08X\n", addr);
+            LOG(LOG_CART, LOG_WARN, "[SPICARD] Unrecognized read32 $%08X\n", addr);
     }
     return reg;
 }
@@ -482,14 +482,14 @@ void Cartridge::write8_ntr(uint32_t addr, uint8_t value)
 {
     if (addr >= 0x10164008 && addr < 0x10164010)
     {
-        printf("[NTRCARD] Write cmd $%08X: $%02X\n", addr, value);
+        LOG(LOG_CART, LOG_DEBUG, "[NTRCARD] Write cmd $%08X: $%02X\n", addr, value);
         cmd_buffer[addr & 0x7] = value;
         return;
     }
     switch (addr)
     {
         default:
-            printf("[NTRCARD] Unrecognized write8 $%08X: $%02X\n", addr, value);
+            LOG(LOG_CART, LOG_WARN, "[NTRCARD] Unrecognized write8 $%08X: $%02X\n", addr, value);
     }
 }
 
@@ -498,11 +498,11 @@ void Cartridge::write16_ntr(uint32_t addr, uint16_t value)
     switch (addr)
     {
         case 0x10164000:
-            printf("[NTRCARD] Write16 CARDMCNT: $%04X\n", value);
+            LOG(LOG_CART, LOG_DEBUG, "[NTRCARD] Write16 CARDMCNT: $%04X\n", value);
             ntr_enable = value;
             break;
         default:
-            printf("[NTRCARD] Unrecognized write16 $%08X: $%08X\n", addr, value);
+            LOG(LOG_CART, LOG_WARN, "[NTRCARD] Unrecognized write16 $%08X: $%08X\n", addr, value);
     }
 }
 
@@ -511,7 +511,7 @@ void Cartridge::write32_ntr(uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x10164004:
-            printf("[NTRCARD] Write32 ROMCTRL: $%08X\n", value);
+            LOG(LOG_CART, LOG_DEBUG, "[NTRCARD] Write32 ROMCTRL: $%08X\n", value);
             if (!ntr_romctrl.busy && (value & (1 << 31)))
             {
                 ntr_romctrl.busy = true;
@@ -519,15 +519,15 @@ void Cartridge::write32_ntr(uint32_t addr, uint32_t value)
             }
             break;
         case 0x10164008:
-            printf("[NTRCARD] Write32 cmd $%08X: $%08X\n", addr, value);
+            LOG(LOG_CART, LOG_DEBUG, "[NTRCARD] Write32 cmd $%08X: $%08X\n", addr, value);
             *(uint32_t*)&cmd_buffer[0] = value;
             break;
         case 0x1016400C:
-            printf("[NTRCARD] Write32 cmd $%08X: $%08X\n", addr, value);
+            LOG(LOG_CART, LOG_DEBUG, "[NTRCARD] Write32 cmd $%08X: $%08X\n", addr, value);
             *(uint32_t*)&cmd_buffer[4] = value;
             break;
         default:
-            printf("[NTRCARD] Unrecognized write32 $%08X: $%08X\n", addr, value);
+            LOG(LOG_CART, LOG_WARN, "[NTRCARD] Unrecognized write32 $%08X: $%08X\n", addr, value);
     }
 }
 
@@ -536,7 +536,7 @@ void Cartridge::write8_ctr(uint32_t addr, uint8_t value)
     switch (addr)
     {
         default:
-            printf("[CTRCARD] Unrecognized write8 $%08X: $%02X\n", addr, value);
+            LOG(LOG_CART, LOG_WARN, "[CTRCARD] Unrecognized write8 $%08X: $%02X\n", addr, value);
     }
 }
 
@@ -544,7 +544,7 @@ void Cartridge::write32_ctr(uint32_t addr, uint32_t value)
 {
     if (addr >= 0x10004020 && addr < 0x10004030)
     {
-        printf("[CTRCARD] Write cmd $%08X: $%08X\n", addr, value);
+        LOG(LOG_CART, LOG_DEBUG, "[CTRCARD] Write cmd $%08X: $%08X\n", addr, value);
 
         value = bswp32(value);
         int index = 12 - (addr & 0xF);
@@ -554,7 +554,7 @@ void Cartridge::write32_ctr(uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x10004000:
-            printf("[CTRCARD] Write32 ROMCTRL: $%08X\n", value);
+            LOG(LOG_CART, LOG_DEBUG, "[CTRCARD] Write32 ROMCTRL: $%08X\n", value);
             ctr_romctrl.write_mode = value & (1 << 29);
             ctr_romctrl.irq_enable = value & (1 << 30);
 
@@ -565,14 +565,14 @@ void Cartridge::write32_ctr(uint32_t addr, uint32_t value)
             }
             break;
         case 0x10004004:
-            printf("[CTRCARD] BLKCNT: $%08X\n", value);
+            LOG(LOG_CART, LOG_DEBUG, "[CTRCARD] BLKCNT: $%08X\n", value);
             read_block_count = (value & 0xFFFF) + 1;
             break;
         case 0x10004008:
             ctr_secctrl = value;
             break;
         case 0x10004030:
-            printf("[CTRCARD] Write Card2: $%08X\n", value);
+            LOG(LOG_CART, LOG_DEBUG, "[CTRCARD] Write Card2: $%08X\n", value);
             if (card2_active)
             {
                 *(uint32_t*)&data_buffer[data_pos] = value;
@@ -588,7 +588,7 @@ void Cartridge::write32_ctr(uint32_t addr, uint32_t value)
             }
             break;
         default:
-            printf("[CTRCARD] Unrecognized write32 $%08X: $%08X\n", addr, value);
+            LOG(LOG_CART, LOG_WARN, "[CTRCARD] Unrecognized write32 $%08X: $%08X\n", addr, value);
     }
 }
 
@@ -599,7 +599,7 @@ void Cartridge::write32_spicard(uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x1000D800:
-            printf("[SPICARD] Write32 NSPI_CNT: $%08X\n", value);
+            LOG(LOG_CART, LOG_DEBUG, "[SPICARD] Write32 NSPI_CNT: $%08X\n", value);
             if (value & (1 << 15))
             {
                 spi_input_pos = 0;
@@ -608,7 +608,7 @@ void Cartridge::write32_spicard(uint32_t addr, uint32_t value)
             }
             break;
         case 0x1000D804:
-            printf("[SPICARD] Clear chip select\n");
+            LOG(LOG_CART, LOG_DEBUG, "[SPICARD] Clear chip select\n");
 
             switch (spi_state)
             {
@@ -629,7 +629,7 @@ void Cartridge::write32_spicard(uint32_t addr, uint32_t value)
             spi_state = SPICARD_STATE::IDLE;
             break;
         case 0x1000D808:
-            printf("[SPICARD] Block len: $%08X\n", value);
+            LOG(LOG_CART, LOG_DEBUG, "[SPICARD] Block len: $%08X\n", value);
             spi_block_len = value;
             break;
         case 0x1000D80C:
@@ -640,6 +640,6 @@ void Cartridge::write32_spicard(uint32_t addr, uint32_t value)
                 EmuException::die("[SPICARD] Input pos exceeds size of input buffer!");
             break;
         default:
-            printf("[SPICARD] Unrecognized write32 $%08X: $%08X\n", addr, value);
+            LOG(LOG_CART, LOG_WARN, "[SPICARD] Unrecognized write32 $%08X: $%08X\n", addr, value);
     }
 }
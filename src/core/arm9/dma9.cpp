@@ -6,7 +6,8 @@
 
 DMA9::DMA9(Emulator* e, Interrupt9* int9, Scheduler* scheduler) : e(e), int9(int9), scheduler(scheduler)
 {
-
+    ndma_req_event = scheduler->register_event("NDMA request",
+        [this](uint64_t param) {try_ndma_transfer_event((NDMA_Request)param);});
 }
 
 void DMA9::reset()
@@ -46,14 +47,19 @@ void DMA9::run_xdma()
     xdma.run();
 }
 
+bool DMA9::is_active()
+{
+    for (int i = 0; i < 8; i++)
+    {
+        if (ndma_chan[i].busy && pending_ndma_reqs[ndma_chan[i].startup_mode])
+            return true;
+    }
+    return xdma.is_active();
+}
+
 void DMA9::try_ndma_transfer(NDMA_Request req)
 {
-    scheduler->add_event(
-                [this](uint64_t param) { this->try_ndma_transfer_event((NDMA_Request)param); },
-                1,
-                ARM9_CLOCKRATE,
-                (uint64_t)req
-                );
+    scheduler->add_event(ndma_req_event, 1, ARM9_CLOCKRATE, (uint64_t)req);
 }
 
 void DMA9::try_ndma_transfer_event(NDMA_Request req)
@@ -154,7 +160,7 @@ void DMA9::run_ndma(int chan)
     if (ndma_chan[chan].imm_mode)
     {
         ndma_chan[chan].busy = false;
-        printf("[NDMA] Chan%d finished!\n", chan);
+        LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Chan%d finished!\n", chan);
 
         if (ndma_chan[chan].irq_enable)
             int9->assert_irq(chan);
@@ -165,7 +171,7 @@ void DMA9::run_ndma(int chan)
         if (!ndma_chan[chan].transfer_count)
         {
             ndma_chan[chan].busy = false;
-            printf("[NDMA] Chan%d finished!\n", chan);
+            LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Chan%d finished!\n", chan);
 
             if (ndma_chan[chan].irq_enable)
                 int9->assert_irq(chan);
@@ -211,12 +217,12 @@ uint32_t DMA9::read32_ndma(uint32_t addr)
                 reg |= ndma_chan[index].repeating_mode << 29;
                 reg |= ndma_chan[index].irq_enable << 30;
                 reg |= ndma_chan[index].busy << 31;
-                printf("[NDMA] Read chan%d ctrl: $%08X\n", index, reg);
+                LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Read chan%d ctrl: $%08X\n", index, reg);
                 return reg;
             }
         }
     }
-    printf("[NDMA] Unrecognized read32 $%08X\n", addr);
+    LOG(LOG_DMA, LOG_WARN, "[NDMA] Unrecognized read32 $%08X\n", addr);
     return 0;
 }
 
@@ -231,7 +237,7 @@ void DMA9::write32_ndma(uint32_t addr, uint32_t value)
 
     if (addr == 0x0)
     {
-        printf("[NDMA] Write global control: $%08X\n", value);
+        LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Write global control: $%08X\n", value);
         global_ndma_ctrl = value;
         return;
     }
@@ -247,31 +253,31 @@ void DMA9::write32_ndma(uint32_t addr, uint32_t value)
         switch (reg)
         {
             case 0x00:
-                printf("[NDMA] Write chan%d source addr: $%08X\n", index, value);
+                LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Write chan%d source addr: $%08X\n", index, value);
                 ndma_chan[index].source_addr = value & 0xFFFFFFFC;
                 break;
             case 0x04:
-                printf("[NDMA] Write chan%d dest addr: $%08X\n", index, value);
+                LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Write chan%d dest addr: $%08X\n", index, value);
                 ndma_chan[index].dest_addr = value & 0xFFFFFFFC;
                 break;
             case 0x08:
-                printf("[NDMA] Write chan%d transfer count: $%08X\n", index, value);
+                LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Write chan%d transfer count: $%08X\n", index, value);
                 ndma_chan[index].transfer_count = value & 0x0FFFFFFF;
                 break;
             case 0x0C:
-                printf("[NDMA] Write chan%d write count: $%08X\n", index, value);
+                LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Write chan%d write count: $%08X\n", index, value);
                 ndma_chan[index].write_count = value & 0x00FFFFFF;
                 break;
             case 0x10:
-                printf("[NDMA] Write chan%d block interval: $%08X\n", index, value);
+                LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Write chan%d block interval: $%08X\n", index, value);
                 break;
             case 0x14:
-                printf("[NDMA] Write chan%d fill: $%08X\n", index, value);
+                LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Write chan%d fill: $%08X\n", index, value);
                 ndma_chan[index].fill_data = value;
                 break;
             case 0x18:
             {
-                printf("[NDMA] Write chan%d control: $%08X\n", index, value);
+                LOG(LOG_DMA, LOG_DEBUG, "[NDMA] Write chan%d control: $%08X\n", index, value);
 
                 ndma_chan[index].dest_update_method = (value >> 10) & 0x3;
                 ndma_chan[index].dest_reload = value & (1 << 12);
@@ -300,7 +306,7 @@ void DMA9::write32_ndma(uint32_t addr, uint32_t value)
 
         return;
     }
-    printf("[NDMA] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    LOG(LOG_DMA, LOG_WARN, "[NDMA] Unrecognized write32 $%08X: $%08X\n", addr, value);
 }
 
 void DMA9::write32_xdma(uint32_t addr, uint32_t value)
@@ -52,6 +52,7 @@ class DMA9
         Emulator* e;
         Interrupt9* int9;
         Scheduler* scheduler;
+        int ndma_req_event;
 
         uint32_t global_ndma_ctrl;
 
@@ -67,6 +68,7 @@ class DMA9
         void reset();
         void process_ndma_reqs();
         void run_xdma();
+        bool is_active();
 
         void try_ndma_transfer(NDMA_Request req);
         void try_ndma_transfer_event(NDMA_Request req);
@@ -188,7 +188,7 @@ uint16_t EMMC::read16(uint32_t addr)
             reg = data32_block_len;
             break;
         default:
-            printf("[EMMC] Unrecognized read16 $%08X\n", addr);
+            LOG(LOG_EMMC, LOG_WARN, "[EMMC] Unrecognized read16 $%08X\n", addr);
             break;
     }
     return reg;
@@ -219,14 +219,14 @@ void EMMC::write16(uint32_t addr, uint16_t value)
     switch (addr)
     {
         case 0x10006000:
-            printf("[EMMC] Send command, arg: $%08X\n", argument);
+            LOG(LOG_EMMC, LOG_DEBUG, "[EMMC] Send command, arg: $%08X\n", argument);
             if (app_command)
                 send_acmd(value & 0x3F);
             else
                 send_cmd(value & 0x3F);
             break;
         case 0x10006002:
-            printf("[EMMC] Port select: $%04X\n", value);
+            LOG(LOG_EMMC, LOG_DEBUG, "[EMMC] Port select: $%04X\n", value);
             port_select = value;
             break;
         case 0x10006004:
@@ -286,7 +286,7 @@ void EMMC::write16(uint32_t addr, uint16_t value)
             data32_blocks = value;
             break;
         default:
-            printf("[EMMC] Unrecognized write16 $%08X: $%04X\n", addr, value);
+            LOG(LOG_EMMC, LOG_WARN, "[EMMC] Unrecognized write16 $%08X: $%04X\n", addr, value);
             break;
     }
 }
@@ -307,7 +307,7 @@ void EMMC::write32(uint32_t addr, uint32_t value)
 
 void EMMC::send_cmd(int command)
 {
-    printf("[EMMC] CMD%d\n", command);
+    LOG(LOG_EMMC, LOG_DEBUG, "[EMMC] CMD%d\n", command);
     switch (command)
     {
         case 0:
@@ -402,8 +402,8 @@ void EMMC::send_cmd(int command)
                 cur_transfer_drive = &sd;
                 transfer_start_addr *= data_block_len;
             }
-            printf("[EMMC] Read multiple blocks (start: $%lX blocks: $%08X)\n", transfer_start_addr, data_blocks);
-            printf("Reading from %s\n", (nand_selected()) ? "NAND" : "SD");
+            LOG(LOG_EMMC, LOG_DEBUG, "[EMMC] Read multiple blocks (start: $%lX blocks: $%08X)\n", transfer_start_addr, data_blocks);
+            LOG(LOG_EMMC, LOG_DEBUG, "Reading from %s\n", (nand_selected()) ? "NAND" : "SD");
 
             if (cur_transfer_drive->eof())
                 cur_transfer_drive->clear();
@@ -433,11 +433,11 @@ void EMMC::send_cmd(int command)
                 cur_transfer_drive = &sd;
                 transfer_start_addr *= data_block_len;
             }
-            printf("[EMMC] Write multiple blocks (start: $%lX blocks: $%08X)\n", transfer_start_addr, data_blocks);
+            LOG(LOG_EMMC, LOG_DEBUG, "[EMMC] Write multiple blocks (start: $%lX blocks: $%08X)\n", transfer_start_addr, data_blocks);
 
             if (argument >= 0x0DD80000 && argument < 0x0DD80000 + 0x64C00)
             {
-                printf("Write to title.db: $%08X\n", argument - 0x0DD80000);
+                LOG(LOG_EMMC, LOG_DEBUG, "Write to title.db: $%08X\n", argument - 0x0DD80000);
             }
 
             if (cur_transfer_drive->eof())
@@ -461,7 +461,7 @@ void EMMC::send_cmd(int command)
 
 void EMMC::send_acmd(int command)
 {
-    printf("[EMMC] ACMD%d\n", command);
+    LOG(LOG_EMMC, LOG_DEBUG, "[EMMC] ACMD%d\n", command);
 
     istat &= ~0x1;
 
@@ -532,7 +532,7 @@ uint32_t EMMC::get_sdr1_reply()
     reg |= state << 9;
     if (!transfer_size)
         reg |= 1 << 8; //ready for data
-    printf("R1: $%08X State: %d\n", reg, reg >> 9);
+    LOG(LOG_EMMC, LOG_DEBUG, "R1: $%08X State: %d\n", reg, reg >> 9);
     return reg;
 }
 
@@ -565,7 +565,7 @@ void EMMC::set_istat(uint32_t field)
     uint32_t old_istat = istat;
     istat |= field;
 
-    printf("ISTAT: $%08X IMSK: $%08X COMB: $%08X\n", istat, imask, istat & imask);
+    LOG(LOG_EMMC, LOG_DEBUG, "ISTAT: $%08X IMSK: $%08X COMB: $%08X\n", istat, imask, istat & imask);
 
     if (!(old_istat & imask & field) && (istat & imask & field))
         int9->assert_irq(16);
@@ -576,7 +576,7 @@ uint16_t EMMC::read_fifo()
     if (transfer_size)
     {
         uint16_t value = *(uint16_t*)&transfer_buffer[transfer_pos];
-        printf("[EMMC] Read FIFO16: $%04X\n", value);
+        LOG(LOG_EMMC, LOG_TRACE, "[EMMC] Read FIFO16: $%04X\n", value);
         transfer_pos += 2;
         transfer_size -= 2;
 
@@ -629,7 +629,7 @@ void EMMC::write_fifo32(uint32_t value)
     if (transfer_size)
     {
         *(uint32_t*)&transfer_buffer[transfer_pos] = value;
-        printf("[EMMC] Write FIFO32: $%08X\n", value);
+        LOG(LOG_EMMC, LOG_TRACE, "[EMMC] Write FIFO32: $%08X\n", value);
         transfer_pos += 4;
         transfer_size -= 4;
 
@@ -666,7 +666,7 @@ void EMMC::transfer_end()
     transfer_buffer = nullptr;
     block_transfer = false;
     sd_data32.rd32rdy_irq_pending = false;
-    printf("[EMMC] Transfer end\n");
+    LOG(LOG_EMMC, LOG_DEBUG, "[EMMC] Transfer end\n");
     switch (state)
     {
         case MMC_Data:
@@ -1,4 +1,5 @@
 #include <cstdio>
+#include "../common/log.hpp"
 #include "../cpu/arm.hpp"
 #include "interrupt9.hpp"
 
@@ -20,21 +21,21 @@ uint32_t Interrupt9::read_if()
 
 void Interrupt9::write_ie(uint32_t value)
 {
-    printf("[Int9] IE: $%08X\n", value);
+    LOG(LOG_IRQ, LOG_DEBUG, "[Int9] IE: $%08X\n", value);
     IE = value;
     arm9->set_int_signal(IE & IF);
 }
 
 void Interrupt9::write_if(uint32_t value)
 {
-    printf("[Int9] IF: $%08X\n", value);
+    LOG(LOG_IRQ, LOG_DEBUG, "[Int9] IF: $%08X\n", value);
     IF &= ~value;
     arm9->set_int_signal(IE & IF);
 }
 
 void Interrupt9::assert_irq(int id)
 {
-    printf("[Int9] Assert IRQ: %d\n", id);
+    LOG(LOG_IRQ, LOG_TRACE, "[Int9] Assert IRQ: %d\n", id);
     IF |= 1 << id;
     arm9->set_int_signal(IE & IF);
 }
@@ -5,8 +5,6 @@
 #include "interrupt9.hpp"
 #include "rsa.hpp"
 
-#define printf(fmt,...) (void)(0)
-
 RSA::RSA(Interrupt9* int9) : int9(int9)
 {
 
@@ -28,7 +26,7 @@ uint8_t RSA::read8(uint32_t addr)
             index = 0xFF - index;
         return msg[index];
     }
-    printf("[RSA] Unrecognized read8 $%08X\n", addr);
+    LOG(LOG_RSA, LOG_TRACE, "[RSA] Unrecognized read8 $%08X\n", addr);
     return 0;
 }
 
@@ -46,10 +44,10 @@ uint32_t RSA::read32(uint32_t addr)
                 //reg |= keys[index].key_set;
                 reg = 1;
                 reg |= keys[index].write_protect << 1;
-                printf("[RSA] Read key%d cnt\n", index);
+                LOG(LOG_RSA, LOG_TRACE, "[RSA] Read key%d cnt\n", index);
                 return reg;
             case 1:
-                printf("[RSA] Read key%d size\n", index);
+                LOG(LOG_RSA, LOG_TRACE, "[RSA] Read key%d size\n", index);
                 return 0x40;
         }
     }
@@ -62,7 +60,7 @@ uint32_t RSA::read32(uint32_t addr)
         uint32_t value = *(uint32_t*)&msg[index];
         if (!RSA_CNT.big_endian)
             value = bswp32(value);
-        printf("[RSA] Read TXT $%08X: $%08X\n", addr, value);
+        LOG(LOG_RSA, LOG_TRACE, "[RSA] Read TXT $%08X: $%08X\n", addr, value);
         return value;
     }
 
@@ -72,10 +70,10 @@ uint32_t RSA::read32(uint32_t addr)
             reg |= RSA_CNT.keyslot << 4;
             reg |= RSA_CNT.big_endian << 8;
             reg |= RSA_CNT.word_order << 9;
-            printf("[RSA] Read CNT: $%08X\n", reg);
+            LOG(LOG_RSA, LOG_TRACE, "[RSA] Read CNT: $%08X\n", reg);
             break;
         default:
-            printf("[RSA] Unrecognized read32 $%08X\n", addr);
+            LOG(LOG_RSA, LOG_TRACE, "[RSA] Unrecognized read32 $%08X\n", addr);
             return 0;
     }
     return reg;
@@ -85,7 +83,7 @@ void RSA::write8(uint32_t addr, uint8_t value)
 {
     if (addr >= 0x1000B200 && addr < 0x1000B300)
     {
-        printf("[RSA] Write8 key%d exp: $%02X\n", RSA_CNT.keyslot, value);
+        LOG(LOG_RSA, LOG_TRACE, "[RSA] Write8 key%d exp: $%02X\n", RSA_CNT.keyslot, value);
         RSA_KeySlot* key = &keys[RSA_CNT.keyslot];
         //if (RSA_CNT.big_endian)
             //value = bswp32(value);
@@ -101,7 +99,7 @@ void RSA::write8(uint32_t addr, uint8_t value)
 
     if (addr >= 0x1000B400 && addr < 0x1000B500)
     {
-        printf("[RSA] Write8 key%d mod: $%02X\n", RSA_CNT.keyslot, value);
+        LOG(LOG_RSA, LOG_TRACE, "[RSA] Write8 key%d mod: $%02X\n", RSA_CNT.keyslot, value);
         RSA_KeySlot* key = &keys[RSA_CNT.keyslot];
         //if (RSA_CNT.big_endian)
             //value = bswp32(value);
@@ -121,7 +119,7 @@ void RSA::write8(uint32_t addr, uint8_t value)
 
     if (addr >= 0x1000B800 && addr < 0x1000B900)
     {
-        printf("[RSA] Write TXT: $%02X (%d)\n", value, msg_ctr);
+        LOG(LOG_RSA, LOG_TRACE, "[RSA] Write TXT: $%02X (%d)\n", value, msg_ctr);
         if (!RSA_CNT.word_order)
             msg[0xFF - msg_ctr] = value;
         else
@@ -133,7 +131,7 @@ void RSA::write8(uint32_t addr, uint8_t value)
         return;
     }
 
-    printf("[RSA] Unrecognized write8 $%08X\n", addr);
+    LOG(LOG_RSA, LOG_TRACE, "[RSA] Unrecognized write8 $%08X\n", addr);
 }
 
 void RSA::write32(uint32_t addr, uint32_t value)
@@ -146,7 +144,7 @@ void RSA::write32(uint32_t addr, uint32_t value)
         switch (reg)
         {
             case 0:
-                printf("[RSA] Write32 key%d cnt: $%08X\n", index, value);
+                LOG(LOG_RSA, LOG_TRACE, "[RSA] Write32 key%d cnt: $%08X\n", index, value);
                 keys[index].write_protect = value & (1 << 1);
                 return;
         }
@@ -154,7 +152,7 @@ void RSA::write32(uint32_t addr, uint32_t value)
 
     if (addr >= 0x1000B200 && addr < 0x1000B300)
     {
-        printf("[RSA] Write32 key%d exp: $%08X\n", RSA_CNT.keyslot, value);
+        LOG(LOG_RSA, LOG_TRACE, "[RSA] Write32 key%d exp: $%08X\n", RSA_CNT.keyslot, value);
         RSA_KeySlot* key = &keys[RSA_CNT.keyslot];
         if (!RSA_CNT.big_endian)
             value = bswp32(value);
@@ -170,7 +168,7 @@ void RSA::write32(uint32_t addr, uint32_t value)
 
     if (addr >= 0x1000B400 && addr < 0x1000B500)
     {
-        printf("[RSA] Write32 key%d mod: $%08X\n", RSA_CNT.keyslot, value);
+        LOG(LOG_RSA, LOG_TRACE, "[RSA] Write32 key%d mod: $%08X\n", RSA_CNT.keyslot, value);
         RSA_KeySlot* key = &keys[RSA_CNT.keyslot];
         if (!RSA_CNT.big_endian)
             value = bswp32(value);
@@ -190,7 +188,7 @@ void RSA::write32(uint32_t addr, uint32_t value)
 
     if (addr >= 0x1000B800 && addr < 0x1000B900)
     {
-        printf("[RSA] Write TXT: $%08X (%d)\n", value, msg_ctr);
+        LOG(LOG_RSA, LOG_TRACE, "[RSA] Write TXT: $%08X (%d)\n", value, msg_ctr);
         if (!RSA_CNT.big_endian)
             value = bswp32(value);
         if (!RSA_CNT.word_order)
@@ -207,7 +205,7 @@ void RSA::write32(uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x1000B000:
-            printf("[RSA] Write CNT: $%08X\n", value);
+            LOG(LOG_RSA, LOG_TRACE, "[RSA] Write CNT: $%08X\n", value);
             RSA_CNT.keyslot = (value >> 4) & 0x3;
             RSA_CNT.big_endian = (value >> 8) & 0x1;
             RSA_CNT.word_order = (value >> 9) & 0x1;
@@ -216,7 +214,7 @@ void RSA::write32(uint32_t addr, uint32_t value)
                 do_rsa_op();
             break;
         default:
-            printf("[RSA] Unrecognized write32 $%08X: $%08X\n", addr, value);
+            LOG(LOG_RSA, LOG_TRACE, "[RSA] Unrecognized write32 $%08X: $%08X\n", addr, value);
     }
 }
 
@@ -246,12 +244,12 @@ void RSA::do_rsa_op()
     convert_to_bignum((uint8_t*)key->exp, gmp_e);
     convert_to_bignum((uint8_t*)key->mod, gmp_m);
 
-    printf("Msg: %s\n", mpz_get_str(NULL, 16, gmp_b));
-    printf("Exp: %s\n", mpz_get_str(NULL, 16, gmp_e));
-    printf("Mod: %s\n", mpz_get_str(NULL, 16, gmp_m));
+    LOG(LOG_RSA, LOG_TRACE, "Msg: %s\n", mpz_get_str(NULL, 16, gmp_b));
+    LOG(LOG_RSA, LOG_TRACE, "Exp: %s\n", mpz_get_str(NULL, 16, gmp_e));
+    LOG(LOG_RSA, LOG_TRACE, "Mod: %s\n", mpz_get_str(NULL, 16, gmp_m));
 
     mpz_powm(gmp_msg, gmp_b, gmp_e, gmp_m);
-    printf("Result: %s\n", mpz_get_str(NULL, 16, gmp_msg));
+    LOG(LOG_RSA, LOG_TRACE, "Result: %s\n", mpz_get_str(NULL, 16, gmp_msg));
 
     convert_from_bignum(gmp_msg, msg);
     int9->assert_irq(22);
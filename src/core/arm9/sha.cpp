@@ -22,7 +22,7 @@ uint8_t SHA::read_hash(uint32_t addr)
     int offset = addr & 0x3;
     if (eng.SHA_CNT.out_big_endian)
         offset = 3 - offset;
-    printf("[SHA] Read hash: $%08X $%02X\n", addr, (eng.hash[index] >> (offset * 8)) & 0xFF);
+    LOG(LOG_SHA, LOG_TRACE, "[SHA] Read hash: $%08X $%02X\n", addr, (eng.hash[index] >> (offset * 8)) & 0xFF);
     return (eng.hash[index] >> (offset * 8)) & 0xFF;
 }
 
@@ -35,7 +35,7 @@ uint32_t SHA::read32(uint32_t addr)
         uint32_t value = *(uint32_t*)&eng.hash[index];
         if (eng.SHA_CNT.out_big_endian)
             value = bswp32(value);
-        printf("[SHA] Read32 hash $%08X: $%08X\n", addr, value);
+        LOG(LOG_SHA, LOG_DEBUG, "[SHA] Read32 hash $%08X: $%08X\n", addr, value);
         return value;
     }
     if (addr >= 0x1000A080 && addr < 0x1000A0C0)
@@ -68,7 +68,7 @@ uint32_t SHA::read32(uint32_t addr)
             reg = eng.message_len * 4;
             break;
         default:
-            printf("[SHA] Unrecognized read32 $%08X\n", addr);
+            LOG(LOG_SHA, LOG_WARN, "[SHA] Unrecognized read32 $%08X\n", addr);
     }
     return reg;
 }
@@ -79,7 +79,7 @@ void SHA::write32(uint32_t addr, uint32_t value)
     {
         int index = (addr / 4) & 0x7;
         *(uint32_t*)&eng.hash[index] = bswp32(value);
-        printf("[SHA] Write32 hash $%08X: $%08X\n", addr, value);
+        LOG(LOG_SHA, LOG_DEBUG, "[SHA] Write32 hash $%08X: $%08X\n", addr, value);
         return;
     }
     if (addr >= 0x1000A080 && addr < 0x1000A0C0)
@@ -90,7 +90,7 @@ void SHA::write32(uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x1000A000:
-            printf("[SHA] Write32 SHA_CNT: $%08X\n", value);
+            LOG(LOG_SHA, LOG_DEBUG, "[SHA] Write32 SHA_CNT: $%08X\n", value);
             eng.SHA_CNT.busy = value & 0x1;
             eng.SHA_CNT.in_dma_enable = value & (1 << 2);
             eng.SHA_CNT.out_big_endian = value & (1 << 3);
@@ -119,11 +119,11 @@ void SHA::write32(uint32_t addr, uint32_t value)
                 eng.do_hash(true);
             return;
         case 0x1000A004:
-            printf("[SHA] Write message len: $%08X\n", value);
+            LOG(LOG_SHA, LOG_DEBUG, "[SHA] Write message len: $%08X\n", value);
             eng.message_len = value / 4;
             return;
     }
-    printf("[SHA] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    LOG(LOG_SHA, LOG_WARN, "[SHA] Unrecognized write32 $%08X: $%08X\n", addr, value);
 }
 
 void SHA::write_fifo(uint32_t value)
@@ -3,6 +3,7 @@
 
 #include "bswp.hpp"
 #include "exceptions.hpp"
+#include "log.hpp"
 #include "rotr.hpp"
 
 #endif // COMMON_HPP
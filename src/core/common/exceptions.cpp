@@ -1,19 +1,14 @@
 #include <cstdarg>
 #include "exceptions.hpp"
+#include "log.hpp"
 
 namespace EmuException
 {
 
-ARMDataAbort::ARMDataAbort(uint32_t vaddr, bool is_write) : std::runtime_error("ARM data abort"), vaddr(vaddr),
-    is_write(is_write)
-{}
-
-ARMPrefetchAbort::ARMPrefetchAbort(uint32_t vaddr) : std::runtime_error("ARM prefetch abort"), vaddr(vaddr)
-{}
-
 void die(const char* format, ...)
 {
-    //Display a message box and forcibly terminate emulation
+    //Display a message box and forcibly terminate emulation. Print what led up to it first.
+    Log::flush();
     char output[ERROR_STRING_MAX_LENGTH];
     va_list args;
     va_start(args, format);
@@ -24,7 +19,7 @@ void die(const char* format, ...)
 
 void reboot()
 {
-    printf("Reboot signal sent to MCU!\n");
+    LOG(LOG_EMU, LOG_INFO, "Reboot signal sent to MCU!\n");
     throw RebootException("Reboot");
 }
 
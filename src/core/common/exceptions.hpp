@@ -17,26 +17,7 @@ namespace EmuException
         using std::runtime_error::runtime_error;
     };
 
-    class ARMDataAbort : public std::runtime_error
-    {
-        using std::runtime_error::runtime_error;
-
-        public:
-            ARMDataAbort(uint32_t vaddr, bool is_write);
-            uint32_t vaddr;
-            bool is_write;
-    };
-
-    class ARMPrefetchAbort : public std::runtime_error
-    {
-        using std::runtime_error::runtime_error;
-
-        public:
-            ARMPrefetchAbort(uint32_t vaddr);
-            uint32_t vaddr;
-    };
-
-    void die(const char* format, ...);
+    [[noreturn]] void die(const char* format, ...);
     void reboot();
 };
 
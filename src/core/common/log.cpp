@@ -0,0 +1,253 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "log.hpp"
+
+namespace Log
+{
+
+constexpr static int RING_SIZE = 4096;
+constexpr static int MESSAGE_SIZE = 256;
+
+//A slot is free for the writer at position pos when its sequence is pos, and ready to print when it is pos + 1
+struct Slot
+{
+    std::atomic<uint64_t> sequence;
+    char text[MESSAGE_SIZE];
+};
+
+static const char* subsystem_names[LOG_SUBSYSTEM_COUNT] =
+{
+    "emu", "io", "arm", "mmu", "mpcore", "irq", "timer", "pxi", "dma", "gpu", "dsp", "wifi", "xtensa",
+    "aes", "rsa", "sha", "hash", "emmc", "cart", "i2c", "spi"
+};
+
+static const char* level_names[] = {"error", "warn", "info", "debug", "trace"};
+
+uint8_t levels[LOG_SUBSYSTEM_COUNT];
+
+static Slot ring[RING_SIZE];
+static std::atomic<uint64_t> write_pos;
+static uint64_t read_pos;
+static std::mutex flush_lock;
+static FILE* output;
+
+class Flusher
+{
+    private:
+        std::thread thread;
+        std::mutex lock;
+        std::condition_variable wake;
+        bool quit;
+
+        void loop();
+    public:
+        std::atomic<bool> async;
+        std::atomic<bool> started;
+
+        Flusher();
+        ~Flusher();
+
+        void start();
+        void stop();
+};
+
+static Flusher flusher;
+
+static bool init_ring()
+{
+    for (int i = 0; i < RING_SIZE; i++)
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+    set_all_levels(LOG_INFO);
+    return true;
+}
+
+static bool ring_init = init_ring();
+
+Flusher::Flusher() : quit(false), async(true), started(false)
+{
+
+}
+
+Flusher::~Flusher()
+{
+    stop();
+}
+
+void Flusher::start()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (thread.joinable() || quit)
+        return;
+    thread = std::thread(&Flusher::loop, this);
+    started = true;
+}
+
+void Flusher::stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+    }
+    wake.notify_one();
+    if (thread.joinable())
+        thread.join();
+
+    //Anything logged during static destruction goes straight out
+    async = false;
+    flush();
+}
+
+void Flusher::loop()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while (!quit)
+    {
+        guard.unlock();
+        flush();
+        guard.lock();
+        wake.wait_for(guard, std::chrono::milliseconds(5));
+    }
+}
+
+void set_level(LOG_SUBSYSTEM subsystem, LOG_LEVEL level)
+{
+    levels[subsystem] = level;
+}
+
+void set_all_levels(LOG_LEVEL level)
+{
+    for (int i = 0; i < LOG_SUBSYSTEM_COUNT; i++)
+        levels[i] = level;
+}
+
+//Takes a comma separated list such as "gpu=debug,arm=trace". A name of "all" sets every subsystem.
+bool parse_levels(const char* spec)
+{
+    std::string list(spec);
+    size_t start = 0;
+    while (start < list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+
+        std::string entry = list.substr(start, end - start);
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos)
+            return false;
+
+        std::string name = entry.substr(0, equals);
+        std::string level_name = entry.substr(equals + 1);
+
+        int level = -1;
+        for (int i = 0; i <= LOG_TRACE; i++)
+        {
+            if (level_name == level_names[i])
+                level = i;
+        }
+        if (level < 0)
+            return false;
+
+        if (name == "all")
+            set_all_levels((LOG_LEVEL)level);
+        else
+        {
+            int subsystem = -1;
+            for (int i = 0; i < LOG_SUBSYSTEM_COUNT; i++)
+            {
+                if (name == subsystem_names[i])
+                    subsystem = i;
+            }
+            if (subsystem < 0)
+                return false;
+            set_level((LOG_SUBSYSTEM)subsystem, (LOG_LEVEL)level);
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+void set_async(bool async)
+{
+    flush();
+    flusher.async = async;
+}
+
+//Defaults to stdout when null
+void set_output(FILE* file)
+{
+    flush();
+    std::lock_guard<std::mutex> guard(flush_lock);
+    output = file;
+}
+
+void write(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    if (!flusher.async)
+    {
+        vfprintf(output ? output : stdout, format, args);
+        va_end(args);
+        return;
+    }
+
+    if (!flusher.started.load(std::memory_order_relaxed))
+        flusher.start();
+
+    Slot* slot;
+    uint64_t pos = write_pos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        slot = &ring[pos & (RING_SIZE - 1)];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)(sequence - pos);
+        if (diff == 0)
+        {
+            if (write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            //Full. Better to stall than to lose the messages leading up to a crash.
+            flush();
+            pos = write_pos.load(std::memory_order_relaxed);
+        }
+        else
+            pos = write_pos.load(std::memory_order_relaxed);
+    }
+
+    vsnprintf(slot->text, MESSAGE_SIZE, format, args);
+    va_end(args);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void flush()
+{
+    std::lock_guard<std::mutex> guard(flush_lock);
+    FILE* file = output ? output : stdout;
+    bool printed = false;
+    while (true)
+    {
+        //Stops at the first slot still being written, which keeps the output in order
+        Slot* slot = &ring[read_pos & (RING_SIZE - 1)];
+        if (slot->sequence.load(std::memory_order_acquire) != read_pos + 1)
+            break;
+
+        fputs(slot->text, file);
+        slot->sequence.store(read_pos + RING_SIZE, std::memory_order_release);
+        read_pos++;
+        printed = true;
+    }
+    if (printed)
+        fflush(file);
+}
+
+};
@@ -0,0 +1,82 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+#include <cstdint>
+#include <cstdio>
+
+enum LOG_LEVEL
+{
+    LOG_ERROR,
+    LOG_WARN,
+    LOG_INFO,
+    LOG_DEBUG,
+    LOG_TRACE
+};
+
+enum LOG_SUBSYSTEM
+{
+    LOG_EMU,
+    LOG_IO,
+    LOG_ARM,
+    LOG_MMU,
+    LOG_MPCORE,
+    LOG_IRQ,
+    LOG_TIMER,
+    LOG_PXI,
+    LOG_DMA,
+    LOG_GPU,
+    LOG_DSP,
+    LOG_WIFI,
+    LOG_XTENSA,
+    LOG_AES,
+    LOG_RSA,
+    LOG_SHA,
+    LOG_HASH,
+    LOG_EMMC,
+    LOG_CART,
+    LOG_I2C,
+    LOG_SPI,
+    LOG_SUBSYSTEM_COUNT
+};
+
+//Messages above this level are compiled out entirely, arguments included.
+//Release builds stop at INFO, so per-access and per-draw messages cost nothing there.
+#ifndef CORGI_LOG_LEVEL
+#ifdef NDEBUG
+#define CORGI_LOG_LEVEL LOG_INFO
+#else
+#define CORGI_LOG_LEVEL LOG_TRACE
+#endif
+#endif
+
+#define LOG_COMPILED(level) ((level) <= CORGI_LOG_LEVEL)
+#define LOG_ENABLED(subsystem, level) (LOG_COMPILED(level) && (level) <= Log::levels[subsystem])
+
+#define LOG(subsystem, level, ...) \
+    do \
+    { \
+        if (LOG_ENABLED(subsystem, level)) \
+            Log::write(__VA_ARGS__); \
+    } while (0)
+
+/***
+ * Messages are formatted into a fixed ring of slots and written out by a background thread, so logging never waits
+ * on the console. Writers claim slots with a compare-and-swap and never block each other. If the ring fills up, the
+ * writer drains it itself instead of dropping messages.
+ * Messages are printed exactly as formatted, so a line may be built from several calls like with printf.
+***/
+
+namespace Log
+{
+    extern uint8_t levels[LOG_SUBSYSTEM_COUNT];
+
+    void set_level(LOG_SUBSYSTEM subsystem, LOG_LEVEL level);
+    void set_all_levels(LOG_LEVEL level);
+    bool parse_levels(const char* spec);
+    void set_async(bool async);
+    void set_output(FILE* file);
+
+    void write(const char* format, ...) __attribute__((format(printf, 1, 2)));
+    void flush();
+};
+
+#endif // LOG_HPP
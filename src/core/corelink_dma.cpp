@@ -2,8 +2,6 @@
 #include "common/common.hpp"
 #include "corelink_dma.hpp"
 
-#define printf(fmt, ...) (void)(0)
-
 void Corelink_Chan::push8(uint8_t value)
 {
     fifo.push(value);
@@ -85,6 +83,18 @@ void Corelink_DMA::run()
     }
 }
 
+bool Corelink_DMA::is_active()
+{
+    for (int i = 0; i < 8; i++)
+    {
+        if (dma[i].state == Corelink_Chan::Status::EXEC)
+            return true;
+        if (dma[i].state == Corelink_Chan::Status::WFP && pending_reqs[dma[i].peripheral])
+            return true;
+    }
+    return false;
+}
+
 void Corelink_DMA::set_pending(int index)
 {
     pending_reqs[index] = true;
@@ -153,16 +163,16 @@ uint32_t Corelink_DMA::read32(uint32_t addr)
     switch (addr)
     {
         case 0x020:
-            printf("[Corelink] Read IE: $%08X\n", int_enable);
+            LOG(LOG_DMA, LOG_TRACE, "[Corelink] Read IE: $%08X\n", int_enable);
             return int_enable;
         case 0x024:
-            printf("[Corelink] Read SEV IF: $%08X\n", sev_flag);
+            LOG(LOG_DMA, LOG_TRACE, "[Corelink] Read SEV IF: $%08X\n", sev_flag);
             return sev_flag;
         case 0x028:
-            printf("[Corelink] Read IF: $%08X\n", int_flag);
+            LOG(LOG_DMA, LOG_TRACE, "[Corelink] Read IF: $%08X\n", int_flag);
             return int_flag;
     }
-    printf("[Corelink] Unrecognized read32 $%08X\n", addr);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] Unrecognized read32 $%08X\n", addr);
     return 0;
 }
 
@@ -172,11 +182,11 @@ void Corelink_DMA::write32(uint32_t addr, uint32_t value)
     switch (addr)
     {
         case 0x020:
-            printf("[Corelink] Write IE: $%08X\n", value);
+            LOG(LOG_DMA, LOG_TRACE, "[Corelink] Write IE: $%08X\n", value);
             int_enable = value;
             return;
         case 0x02C:
-            printf("[Corelink] Write IF: $%08X\n", value);
+            LOG(LOG_DMA, LOG_TRACE, "[Corelink] Write IF: $%08X\n", value);
             sev_flag &= ~value;
             int_flag &= ~value;
             return;
@@ -193,12 +203,12 @@ void Corelink_DMA::write32(uint32_t addr, uint32_t value)
             debug_instrs[1] = value;
             return;
     }
-    printf("[Corelink] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] Unrecognized write32 $%08X: $%08X\n", addr, value);
 }
 
 void Corelink_DMA::exec_debug()
 {
-    printf("Instr: $%08X $%08X\n", debug_instrs[0], debug_instrs[1]);
+    LOG(LOG_DMA, LOG_TRACE, "Instr: $%08X $%08X\n", debug_instrs[0], debug_instrs[1]);
     int chan = 0;
     if (debug_instrs[0] & 0x1)
         chan = (debug_instrs[0] >> 8) & 0x7;
@@ -231,32 +241,32 @@ void Corelink_DMA::exec_instr(uint8_t byte, int chan)
         switch (command)
         {
             case 0x00:
-                printf("[Corelink] DMAEND\n");
+                LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMAEND\n");
                 dma[chan].state = Corelink_Chan::Status::STOP;
                 break;
             case 0x01:
-                printf("[Corelink] DMAKILL\n");
+                LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMAKILL\n");
                 dma[chan].state = Corelink_Chan::Status::STOP;
                 break;
             case 0x04:
-                printf("[Corelink] DMALD: chan%d\n", chan);
+                LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMALD: chan%d\n", chan);
                 instr_ld(chan, command & 0x3);
                 break;
             case 0x08:
             case 0x0B:
-                printf("[Corelink] DMAST: chan%d\n", chan);
+                LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMAST: chan%d\n", chan);
                 instr_st(chan, command & 0x3);
                 break;
             case 0x12:
                 //Don't need to do anything here, since all memory accesses are done instantly
-                printf("[Corelink] DMARMB\n");
+                LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMARMB\n");
                 break;
             case 0x13:
                 //Same as DMARMB
-                printf("[Corelink] DMAWMB\n");
+                LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMAWMB\n");
                 break;
             case 0x18:
-                printf("[Corelink] DMANOP\n");
+                LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMANOP\n");
                 break;
             case 0x20:
             case 0x22:
@@ -433,7 +443,7 @@ void Corelink_DMA::instr_lp(int chan, int loop_ctr_index)
 {
     uint16_t iterations = params[0];
     dma[chan].loop_ctr[loop_ctr_index] = iterations;
-    printf("[Corelink] DMALP%d: chan%d iterations: %d\n", loop_ctr_index, chan, iterations);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMALP%d: chan%d iterations: %d\n", loop_ctr_index, chan, iterations);
 }
 
 void Corelink_DMA::instr_ldp(int chan, bool burst)
@@ -451,7 +461,7 @@ void Corelink_DMA::instr_ldp(int chan, bool burst)
         EmuException::die("[Corelink] Load size not word aligned for LDP");
 
     //There is a peripheral byte here, but we ignore it
-    printf("[Corelink] LDP: chan%d\n", chan);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] LDP: chan%d\n", chan);
 
     int multiplier = (int)dma[chan].ctrl.inc_src;
     uint32_t addr = dma[chan].source_addr;
@@ -494,14 +504,14 @@ void Corelink_DMA::instr_wfp(int chan)
     dma[chan].state = Corelink_Chan::Status::WFP;
     dma[chan].peripheral = peripheral;
 
-    printf("[Corelink] DMAWFP: chan%d, peripheral %d\n", chan, peripheral);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMAWFP: chan%d, peripheral %d\n", chan, peripheral);
 }
 
 void Corelink_DMA::instr_sev(int chan)
 {
     int event = params[0] >> 3;
 
-    printf("[Corelink] DMASEV: chan%d event%d\n", chan, event);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMASEV: chan%d event%d\n", chan, event);
 
     event = 1 << event;
 
@@ -522,7 +532,7 @@ void Corelink_DMA::instr_flushp()
     //TODO: We need to check with the peripheral so it can resend a DMA request
     pending_reqs[peripheral] = false;
 
-    printf("[Corelink] DMAFLUSHP: peripheral: %d\n", peripheral);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMAFLUSHP: peripheral: %d\n", peripheral);
 }
 
 void Corelink_DMA::instr_lpend(int chan)
@@ -532,18 +542,18 @@ void Corelink_DMA::instr_lpend(int chan)
 
     if (!loop_finite)
     {
-        printf("[Corelink] DMALPFE!\n");
+        LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMALPFE!\n");
         return;
     }
 
     //Add +2 to account for two bytes of the instruction
     uint16_t jump = params[0] + 2;
-    printf("[Corelink] DMALPEND: chan%d, jump offset: $%02X\n", chan, jump);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMALPEND: chan%d, jump offset: $%02X\n", chan, jump);
 
     if (dma[chan].loop_ctr[index])
     {
         dma[chan].loop_ctr[index]--;
-        printf("New loop: %d\n", dma[chan].loop_ctr[index]);
+        LOG(LOG_DMA, LOG_TRACE, "New loop: %d\n", dma[chan].loop_ctr[index]);
         dma[chan].PC -= jump;
     }
 }
@@ -558,7 +568,7 @@ void Corelink_DMA::instr_dmago()
     dma[chan].state = Corelink_Chan::Status::EXEC;
     dma[chan].PC = start;
 
-    printf("[Corelink] DMAGO: chan%d, PC: $%08X\n", chan, start);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMAGO: chan%d, PC: $%08X\n", chan, start);
 }
 
 void Corelink_DMA::instr_mov(int chan)
@@ -568,7 +578,7 @@ void Corelink_DMA::instr_mov(int chan)
     for (int i = 0; i < 4; i++)
         value |= (params[i + 1] & 0xFF) << (i * 8);
 
-    printf("[Corelink] DMAMOV reg%d: $%08X\n", reg, value);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] DMAMOV reg%d: $%08X\n", reg, value);
 
     switch (reg)
     {
@@ -588,7 +598,7 @@ void Corelink_DMA::instr_mov(int chan)
 
 void Corelink_DMA::write_chan_ctrl(int chan, uint32_t value)
 {
-    printf("[Corelink] Write chan%d ctrl: $%08X\n", chan, value);
+    LOG(LOG_DMA, LOG_TRACE, "[Corelink] Write chan%d ctrl: $%08X\n", chan, value);
 
     dma[chan].ctrl.inc_src = value & 0x1;
     dma[chan].ctrl.src_burst_size = 1 << ((value >> 1) & 0x7);
@@ -598,10 +608,10 @@ void Corelink_DMA::write_chan_ctrl(int chan, uint32_t value)
     dma[chan].ctrl.dest_burst_len = ((value >> 18) & 0xF) + 1;
     dma[chan].ctrl.endian_swap_size = (value >> 28) & 0x7;
 
-    printf("Inc src: %d Inc dest: %d\n", dma[chan].ctrl.inc_src, dma[chan].ctrl.inc_dest);
-    printf("Src burst size: %d\n", dma[chan].ctrl.src_burst_size);
-    printf("Src burst len: %d\n", dma[chan].ctrl.src_burst_len);
-    printf("Dest burst size: %d\n", dma[chan].ctrl.dest_burst_size);
-    printf("Dest burst len: %d\n", dma[chan].ctrl.dest_burst_len);
-    printf("Endian swap size: %d\n", dma[chan].ctrl.endian_swap_size);
+    LOG(LOG_DMA, LOG_TRACE, "Inc src: %d Inc dest: %d\n", dma[chan].ctrl.inc_src, dma[chan].ctrl.inc_dest);
+    LOG(LOG_DMA, LOG_TRACE, "Src burst size: %d\n", dma[chan].ctrl.src_burst_size);
+    LOG(LOG_DMA, LOG_TRACE, "Src burst len: %d\n", dma[chan].ctrl.src_burst_len);
+    LOG(LOG_DMA, LOG_TRACE, "Dest burst size: %d\n", dma[chan].ctrl.dest_burst_size);
+    LOG(LOG_DMA, LOG_TRACE, "Dest burst len: %d\n", dma[chan].ctrl.dest_burst_len);
+    LOG(LOG_DMA, LOG_TRACE, "Endian swap size: %d\n", dma[chan].ctrl.endian_swap_size);
 }
@@ -99,6 +99,7 @@ class Corelink_DMA
 
         void reset();
         void run();
+        bool is_active();
 
         void set_pending(int index);
         void clear_pending(int index);
@@ -2,6 +2,7 @@
 #include "arm.hpp"
 #include "arm_disasm.hpp"
 #include "arm_interpret.hpp"
+#include "arm_code_cache.hpp"
 #include "vfp.hpp"
 #include "../common/common.hpp"
 #include "../emulator.hpp"
@@ -9,6 +10,10 @@
 uint64_t ARM_CPU::global_exclusive_start[4];
 uint64_t ARM_CPU::global_exclusive_end[4];
 
+bool ARM_CPU::parallel_quantum = false;
+thread_local ARM_CPU* ARM_CPU::thread_cpu = nullptr;
+std::recursive_mutex ARM_CPU::exclusive_lock;
+
 void get_hos_process_info(ARM_CPU& cpu, int& pid, std::string& name)
 {
     //This is kinda complicated. The PID and Codeset pointer are stored in different locations in KProcess
@@ -16,40 +21,41 @@ void get_hos_process_info(ARM_CPU& cpu, int& pid, std::string& name)
     //until we find one that doesn't data abort.
     static int offs = 16;
     uint32_t process_ptr;
-    try
-    {
-        process_ptr = cpu.read32(0xFFFF9004);
-    }
-    catch (EmuException::ARMDataAbort)
-    {
+    if (!cpu.try_read32(0xFFFF9004, process_ptr))
         process_ptr = 0;
-    }
     if (!process_ptr)
         return;
     while (offs >= 0)
     {
-        try
+        name = "";
+        uint32_t pid_value, codeset_ptr;
+        bool found = cpu.try_read32(process_ptr + 0xAC + offs, pid_value);
+        found &= cpu.try_read32(process_ptr + 0xA8 + offs, codeset_ptr);
+        for (int i = 0; i < 8 && found; i++)
         {
-            name = "";
-            pid = cpu.read32(process_ptr + 0xAC + offs);
-            uint32_t codeset_ptr = cpu.read32(process_ptr + 0xA8 + offs);
-            for (int i = 0; i < 8; i++)
-                name += (char)cpu.read8(codeset_ptr + 0x50 + i);
+            uint8_t c = 0;
+            found &= cpu.try_read8(codeset_ptr + 0x50 + i, c);
+            name += (char)c;
+        }
+
+        if (found)
+        {
+            pid = pid_value;
             return;
         }
-        catch (EmuException::ARMDataAbort)
+
+        offs -= 8;
+        if (offs < 0)
         {
-            offs -= 8;
-            if (offs < 0)
-            {
-                EmuException::die("[ARM] Unable to find process info!");
-            }
+            EmuException::die("[ARM] Unable to find process info!");
         }
     }
 }
 
 uint32_t PSR_Flags::get()
 {
+    resolve_flags();
+
     uint32_t reg = 0;
     reg |= negative << 31;
     reg |= zero << 30;
@@ -69,6 +75,8 @@ uint32_t PSR_Flags::get()
 
 void PSR_Flags::set(uint32_t value)
 {
+    lazy_nz = false;
+    lazy_cv = LAZY_CV_NONE;
     negative = value & (1 << 31);
     zero = value & (1 << 30);
     carry = value & (1 << 29);
@@ -86,7 +94,10 @@ void PSR_Flags::set(uint32_t value)
 
 ARM_CPU::ARM_CPU(Emulator* e, int id, CP15* cp15, VFP* vfp) : e(e), id(id), cp15(cp15), vfp(vfp)
 {
-
+    core_type = (id == 9) ? ARM_CORE_ARM9 : ARM_CORE_ARM11;
+    code_cache = nullptr;
+    fastmem = nullptr;
+    fastmem_base = nullptr;
 }
 
 std::string ARM_CPU::get_reg_name(int id)
@@ -123,8 +134,12 @@ void ARM_CPU::reset()
     CPSR.mode = PSR_SUPERVISOR;
     CPSR.fiq_disable = true;
     CPSR.irq_disable = true;
+    CPSR.lazy_nz = false;
+    CPSR.lazy_cv = LAZY_CV_NONE;
 
     tlb_map = cp15->get_tlb_mapping();
+    if (fastmem)
+        fastmem->unmap_all();
 
     if (id == 9)
         jp(0xFFFF0000, true);
@@ -132,11 +147,15 @@ void ARM_CPU::reset()
         jp(0, true);
 
     prefetch_abort_occurred = false;
+    data_abort_pending = false;
     can_disassemble = false;
     event_pending = false;
     halted = false;
     waiting_for_event = false;
     int_pending = false;
+    deferred_int_signal_set = false;
+    deferred_int_signal = false;
+    deferred_event = false;
 
     local_exclusive_start = 0;
     local_exclusive_end = 0;
@@ -147,59 +166,77 @@ void ARM_CPU::run(int cycles)
     if (halted)
         return;
 
-    try
+    thread_cpu = this;
+    cycles_ran = 0;
+
+    //Disassembly needs to see every instruction, so it always runs on the interpreter
+    if (code_cache && !can_disassemble)
     {
-        cycles_ran = 0;
-        while (!halted && cycles_ran < cycles)
+        code_cache->run(*this, cycles);
+        fetch_new_instr_ptr(gpr[15] - ((CPSR.thumb) ? 2 : 4));
+    }
+
+    if (core_type == ARM_CORE_ARM9)
+        run_interpreter<ARM_CORE_ARM9>(cycles);
+    else
+        run_interpreter<ARM_CORE_ARM11>(cycles);
+
+    if (int_pending)
+        int_check();
+}
+
+template <ARM_CORE_TYPE core>
+void ARM_CPU::run_interpreter(int cycles)
+{
+    while (!halted && cycles_ran < cycles)
+    {
+        if (CPSR.thumb)
         {
-            if (CPSR.thumb)
+            if (prefetch_abort_occurred)
             {
-                if (prefetch_abort_occurred)
-                    throw EmuException::ARMPrefetchAbort(gpr[15] - 2);
-                uint16_t instr = *(uint16_t*)&instr_ptr[(gpr[15] - 2) & 0xFFF];
-                if ((gpr[15] & 0xFFF) == 0)
-                    fetch_new_instr_ptr(gpr[15]);
-                gpr[15] += 2;
-                if (can_disassemble)
-                {
-                    printf("[$%08X] $%04X  %s\n", gpr[15] - 4, instr, ARM_Disasm::disasm_thumb(*this, instr).c_str());
-                    //print_state();
-                }
-                ARM_Interpreter::interpret_thumb(*this, instr);
+                prefetch_abort(gpr[15] - 2);
+                cycles_ran++;
+                continue;
             }
-            else
+            uint16_t instr = *(uint16_t*)&instr_ptr[(gpr[15] - 2) & 0xFFF];
+            if ((gpr[15] & 0xFFF) == 0)
+                fetch_new_instr_ptr(gpr[15]);
+            gpr[15] += 2;
+            if (LOG_COMPILED(LOG_TRACE) && can_disassemble)
             {
-                if (prefetch_abort_occurred)
-                    throw EmuException::ARMPrefetchAbort(gpr[15] - 4);
-                uint32_t instr = *(uint32_t*)&instr_ptr[(gpr[15] - 4) & 0xFFF];
-                if ((gpr[15] & 0xFFF) == 0)
-                    fetch_new_instr_ptr(gpr[15]);
-                gpr[15] += 4;
-                if (can_disassemble)
-                {
-                    printf("[$%08X] $%08X  %s\n", gpr[15] - 8, instr, ARM_Disasm::disasm_arm(*this, instr).c_str());
-                    //print_state();
-                }
-                ARM_Interpreter::interpret_arm(*this, instr);
+                LOG(LOG_ARM, LOG_TRACE, "[$%08X] $%04X  %s\n", gpr[15] - 4, instr, ARM_Disasm::disasm_thumb(*this, instr).c_str());
+                //print_state();
             }
-            cycles_ran++;
+            ARM_Interpreter::interpret_thumb<core>(*this, instr);
         }
+        else
+        {
+            if (prefetch_abort_occurred)
+            {
+                prefetch_abort(gpr[15] - 4);
+                cycles_ran++;
+                continue;
+            }
+            uint32_t instr = *(uint32_t*)&instr_ptr[(gpr[15] - 4) & 0xFFF];
+            if ((gpr[15] & 0xFFF) == 0)
+                fetch_new_instr_ptr(gpr[15]);
+            gpr[15] += 4;
+            if (LOG_COMPILED(LOG_TRACE) && can_disassemble)
+            {
+                LOG(LOG_ARM, LOG_TRACE, "[$%08X] $%08X  %s\n", gpr[15] - 8, instr, ARM_Disasm::disasm_arm(*this, instr).c_str());
+                //print_state();
+            }
+            ARM_Interpreter::interpret_arm<core>(*this, instr);
+        }
+        if (data_abort_pending)
+            take_data_abort();
+        cycles_ran++;
     }
-    catch (EmuException::ARMDataAbort& a)
-    {
-        data_abort(a.vaddr, a.is_write);
-    }
-    catch (EmuException::ARMPrefetchAbort& p)
-    {
-        prefetch_abort(p.vaddr);
-    }
-
-    if (int_pending)
-        int_check();
 }
 
 void ARM_CPU::print_state()
 {
+    Log::flush();
     for (int i = 0; i < 16; i++)
     {
         printf("%s:$%08X", get_reg_name(i).c_str(), gpr[i]);
@@ -240,9 +277,26 @@ void ARM_CPU::jp(uint32_t addr, bool change_thumb_state)
     }
 }
 
+void ARM_CPU::signal_data_abort(uint32_t addr, bool is_write)
+{
+    //Only the first fault of an instruction is reported
+    if (data_abort_pending)
+        return;
+
+    data_abort_pending = true;
+    data_abort_vaddr = addr;
+    data_abort_is_write = is_write;
+}
+
+void ARM_CPU::take_data_abort()
+{
+    data_abort_pending = false;
+    data_abort(data_abort_vaddr, data_abort_is_write);
+}
+
 void ARM_CPU::data_abort(uint32_t addr, bool is_write)
 {
-    printf("[ARM%d] Data abort at vaddr $%08X\n", id, addr);
+    LOG(LOG_ARM, LOG_DEBUG, "[ARM%d] Data abort at vaddr $%08X\n", id, addr);
 
     cp15->set_data_abort_regs(addr, is_write);
 
@@ -266,7 +320,7 @@ void ARM_CPU::prefetch_abort(uint32_t addr)
     if (id == 9)
         EmuException::die("[ARM%d] Prefetch abort at vaddr $%08X\n", id, addr);
 
-    printf("[ARM%d] Prefetch abort at vaddr $%08X\n", id, addr);
+    LOG(LOG_ARM, LOG_DEBUG, "[ARM%d] Prefetch abort at vaddr $%08X\n", id, addr);
 
     cp15->set_prefetch_abort_regs(addr);
 
@@ -310,7 +364,7 @@ void ARM_CPU::swi()
     {
         //uint32_t process_ptr = read32(0xFFFF9004);
         //printf("SVC $%02X, PID%d\n", op, read32(process_ptr + 0xB4));
-        printf("[ARM%d] SVC $%02X!\n", id, op);
+        LOG(LOG_ARM, LOG_TRACE, "[ARM%d] SVC $%02X!\n", id, op);
         //printf("SVC $%04X!\n", gpr[7]);
         if (op == 0x32)
         {
@@ -321,7 +375,7 @@ void ARM_CPU::swi()
             std::string procname;
             get_hos_process_info(*this, pid, procname);
             
-            printf("(PID%d[%s]) SendSyncRequest: $%08X\n", pid, procname.c_str(), header);
+            LOG(LOG_ARM, LOG_DEBUG, "(PID%d[%s]) SendSyncRequest: $%08X\n", pid, procname.c_str(), header);
         }
     }
     if (op == 0x3C)
@@ -370,7 +424,7 @@ void ARM_CPU::int_check()
     //printf("[ARM%d] Interrupt check\n", id);
     if (!CPSR.irq_disable)
     {
-        printf("[ARM%d] Interrupt!\n", id);
+        LOG(LOG_ARM, LOG_TRACE, "[ARM%d] Interrupt!\n", id);
         uint32_t value = CPSR.get();
         SPSR[PSR_IRQ].set(value);
 
@@ -391,6 +445,14 @@ void ARM_CPU::int_check()
 
 void ARM_CPU::set_int_signal(bool pending)
 {
+    //Taking the IRQ changes our registers, which only our own thread may do mid-quantum
+    if (is_foreign_thread())
+    {
+        deferred_int_signal_set = true;
+        deferred_int_signal = pending;
+        return;
+    }
+
     if (!int_pending && pending)
     {
         unhalt();
@@ -418,7 +480,7 @@ void ARM_CPU::wfe()
 {
     if (!event_pending)
     {
-        printf("[ARM%d] WFE\n", id);
+        LOG(LOG_ARM, LOG_TRACE, "[ARM%d] WFE\n", id);
         waiting_for_event = true;
         halted = true;
     }
@@ -435,9 +497,14 @@ void ARM_CPU::send_event(int id)
 {
     if (this->id == id)
         return;
+    if (is_foreign_thread())
+    {
+        deferred_event = true;
+        return;
+    }
     if (waiting_for_event)
     {
-        printf("[ARM%d] WFE cancelled\n", id);
+        LOG(LOG_ARM, LOG_TRACE, "[ARM%d] WFE cancelled\n", id);
         halted = false;
         waiting_for_event = false;
     }
@@ -445,23 +512,18 @@ void ARM_CPU::send_event(int id)
         event_pending = true;
 }
 
-void ARM_CPU::set_zero_neg_flags(uint32_t value)
+void ARM_CPU::apply_deferred_signals()
 {
-    CPSR.negative = value & (1 << 31);
-    CPSR.zero = !value;
-}
-
-//Code here from melonDS's ALU core (my original implementation was incorrect in many ways)
-void ARM_CPU::set_CV_add_flags(uint32_t a, uint32_t b, uint32_t result)
-{
-    CPSR.carry = ((0xFFFFFFFF-a) < b);
-    CPSR.overflow = ADD_OVERFLOW(a, b, result);
-}
-
-void ARM_CPU::set_CV_sub_flags(uint32_t a, uint32_t b, uint32_t result)
-{
-    CPSR.carry = a >= b;
-    CPSR.overflow = SUB_OVERFLOW(a, b, result);
+    if (deferred_int_signal_set)
+    {
+        deferred_int_signal_set = false;
+        set_int_signal(deferred_int_signal);
+    }
+    if (deferred_event)
+    {
+        deferred_event = false;
+        send_event(-1);
+    }
 }
 
 void ARM_CPU::update_reg_mode(PSR_MODE mode)
@@ -547,6 +609,11 @@ void ARM_CPU::spsr_to_cpsr()
 
 bool ARM_CPU::meets_condition(int cond)
 {
+    //AL, and the unconditional space where some instructions require 0xF, never need the flags
+    if (cond >= 0xE)
+        return true;
+
+    CPSR.resolve_flags();
     switch (cond)
     {
         case 0x0:
@@ -591,12 +658,6 @@ bool ARM_CPU::meets_condition(int cond)
         case 0xD:
             //LE - less than or equal to
             return CPSR.zero || (CPSR.negative != CPSR.overflow);
-        case 0xE:
-            //AL - always
-            return true;
-        case 0xF:
-            //Some instructions have the 0xF condition required, so let them pass
-            return true;
         default:
             EmuException::die("[ARM_CPU] Unrecognized condition %d\n", cond);
             return false;
@@ -605,11 +666,11 @@ bool ARM_CPU::meets_condition(int cond)
 
 void ARM_CPU::fetch_new_instr_ptr(uint32_t addr)
 {
-    uint64_t mem = (uint64_t)tlb_map[addr / 4096];
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
     if (!(mem & (1ULL << 60ULL)))
     {
         cp15->reload_tlb(addr);
-        mem = (uint64_t)tlb_map[addr / 4096];
+        mem = (uint64_t)tlb_map->get(addr / 4096);
         if (!(mem & (1ULL << 60ULL)))
             prefetch_abort_occurred = true;
     }
@@ -619,16 +680,83 @@ void ARM_CPU::fetch_new_instr_ptr(uint32_t addr)
     instr_ptr = (uint8_t*)mem;
 }
 
-uint8_t ARM_CPU::read8(uint32_t addr)
+void ARM_CPU::set_fastmem(FastmemSpace *fastmem)
 {
-    uint64_t mem = (uint64_t)tlb_map[addr / 4096];
+    this->fastmem = fastmem;
+    fastmem_base = nullptr;
+    if (fastmem)
+    {
+        fastmem->unmap_all();
+        fastmem_base = fastmem->get_base();
+    }
+}
+
+void ARM_CPU::map_fastmem_page(uint32_t addr)
+{
+    //Only RAM is mapped, so MMIO, unmapped pages and aborting accesses keep faulting into the TLB path
+    if (data_abort_pending)
+        return;
+
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
+    if ((mem >> 62ULL) != 0x1)
+        return;
+
+    bool writable = mem & (1ULL << 61ULL);
+    fastmem->map_page(addr & ~0xFFF, (uint8_t*)(mem & ~(0xFULL << 60ULL)), writable);
+}
+
+uint8_t fastmem_read8_fault(uint8_t*, uint64_t addr, ARM_CPU* cpu)
+{
+    uint8_t value = cpu->read8_tlb(addr);
+    cpu->map_fastmem_page(addr);
+    return value;
+}
+
+uint16_t fastmem_read16_fault(uint8_t*, uint64_t addr, ARM_CPU* cpu)
+{
+    uint16_t value = cpu->read16_tlb(addr);
+    cpu->map_fastmem_page(addr);
+    return value;
+}
+
+uint32_t fastmem_read32_fault(uint8_t*, uint64_t addr, ARM_CPU* cpu)
+{
+    uint32_t value = cpu->read32_tlb(addr);
+    cpu->map_fastmem_page(addr);
+    return value;
+}
+
+void fastmem_write8_fault(uint8_t*, uint64_t addr, uint8_t value, ARM_CPU* cpu)
+{
+    cpu->write8_tlb(addr, value);
+    cpu->map_fastmem_page(addr);
+}
+
+void fastmem_write16_fault(uint8_t*, uint64_t addr, uint16_t value, ARM_CPU* cpu)
+{
+    cpu->write16_tlb(addr, value);
+    cpu->map_fastmem_page(addr);
+}
+
+void fastmem_write32_fault(uint8_t*, uint64_t addr, uint32_t value, ARM_CPU* cpu)
+{
+    cpu->write32_tlb(addr, value);
+    cpu->map_fastmem_page(addr);
+}
+
+uint8_t ARM_CPU::read8_slow(uint32_t addr)
+{
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
     if (!(mem & (1ULL << 62ULL)))
     {
         //TLB miss - reload and check the vaddr again
         cp15->reload_tlb(addr);
-        mem = (uint64_t)tlb_map[addr / 4096];
+        mem = (uint64_t)tlb_map->get(addr / 4096);
         if (!(mem & (1ULL << 62ULL)))
-            throw EmuException::ARMDataAbort(addr, false);
+        {
+            signal_data_abort(addr, false);
+            return 0;
+        }
     }
     if (!(mem & (1ULL << 63ULL)))
     {
@@ -637,13 +765,13 @@ uint8_t ARM_CPU::read8(uint32_t addr)
         return ptr[addr & 0xFFF];
     }
     else
-        addr = (mem & 0xFFFFF000) + (addr & 0xFFF);
+        addr += (uint32_t)mem;
     if (id == 9)
         return e->arm9_read8(addr);
     return e->arm11_read8(id - 11, addr);
 }
 
-uint16_t ARM_CPU::read16(uint32_t addr)
+uint16_t ARM_CPU::read16_slow(uint32_t addr)
 {
     if (id == 9 && (addr & 0x1))
         EmuException::die("[ARM9] Unaligned read16 $%08X", addr);
@@ -652,14 +780,17 @@ uint16_t ARM_CPU::read16(uint32_t addr)
         uint16_t value = read8(addr) | (read8(addr + 1) << 8);
         return value;
     }
-    uint64_t mem = (uint64_t)tlb_map[addr / 4096];
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
     if (!(mem & (1ULL << 62ULL)))
     {
         //TLB miss - reload and check the vaddr again
         cp15->reload_tlb(addr);
-        mem = (uint64_t)tlb_map[addr / 4096];
+        mem = (uint64_t)tlb_map->get(addr / 4096);
         if (!(mem & (1ULL << 62ULL)))
-            throw EmuException::ARMDataAbort(addr, false);
+        {
+            signal_data_abort(addr, false);
+            return 0;
+        }
     }
     if (!(mem & (1ULL << 63ULL)))
     {
@@ -668,13 +799,13 @@ uint16_t ARM_CPU::read16(uint32_t addr)
         return *(uint16_t*)&ptr[addr & 0xFFF];
     }
     else
-        addr = (mem & 0xFFFFF000) + (addr & 0xFFF);
+        addr += (uint32_t)mem;
     if (id == 9)
         return e->arm9_read16(addr);
     return e->arm11_read16(id - 11, addr);
 }
 
-uint32_t ARM_CPU::read32(uint32_t addr)
+uint32_t ARM_CPU::read32_slow(uint32_t addr)
 {
     if (id == 9 && (addr & 0x3))
         EmuException::die("[ARM9] Unaligned read32 $%08X", addr);
@@ -690,14 +821,17 @@ uint32_t ARM_CPU::read32(uint32_t addr)
         word |= word2 << ((4 - low_bits) * 8);
         return word;
     }
-    uint64_t mem = (uint64_t)tlb_map[addr / 4096];
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
     if (!(mem & (1ULL << 62ULL)))
     {
         //TLB miss - reload and check the vaddr again
         cp15->reload_tlb(addr);
-        mem = (uint64_t)tlb_map[addr / 4096];
+        mem = (uint64_t)tlb_map->get(addr / 4096);
         if (!(mem & (1ULL << 62ULL)))
-            throw EmuException::ARMDataAbort(addr, false);
+        {
+            signal_data_abort(addr, false);
+            return 0;
+        }
     }
     if (!(mem & (1ULL << 63ULL)))
     {
@@ -706,13 +840,46 @@ uint32_t ARM_CPU::read32(uint32_t addr)
         return *(uint32_t*)&ptr[addr & 0xFFF];
     }
     else
-        addr = (mem & 0xFFFFF000) + (addr & 0xFFF);
+        addr += (uint32_t)mem;
 
     if (id == 9)
         return e->arm9_read32(addr);
     return e->arm11_read32(id - 11, addr);
 }
 
+bool ARM_CPU::try_read8(uint32_t addr, uint8_t &value)
+{
+    value = read8(addr);
+    if (data_abort_pending)
+    {
+        data_abort_pending = false;
+        return false;
+    }
+    return true;
+}
+
+bool ARM_CPU::try_read16(uint32_t addr, uint16_t &value)
+{
+    value = read16(addr);
+    if (data_abort_pending)
+    {
+        data_abort_pending = false;
+        return false;
+    }
+    return true;
+}
+
+bool ARM_CPU::try_read32(uint32_t addr, uint32_t &value)
+{
+    value = read32(addr);
+    if (data_abort_pending)
+    {
+        data_abort_pending = false;
+        return false;
+    }
+    return true;
+}
+
 uint64_t ARM_CPU::read64(uint32_t addr)
 {
     uint64_t value = read32(addr + 4);
@@ -720,69 +887,79 @@ uint64_t ARM_CPU::read64(uint32_t addr)
     return value | read32(addr);
 }
 
-void ARM_CPU::write8(uint32_t addr, uint8_t value)
+void ARM_CPU::write8_slow(uint32_t addr, uint8_t value)
 {
-    uint64_t mem = (uint64_t)tlb_map[addr / 4096];
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
     if (!(mem & (1ULL << 61ULL)))
     {
         //TLB miss - reload and check the vaddr again
         cp15->reload_tlb(addr);
-        mem = (uint64_t)tlb_map[addr / 4096];
+        mem = (uint64_t)tlb_map->get(addr / 4096);
         if (!(mem & (1ULL << 62ULL)))
-            throw EmuException::ARMDataAbort(addr, true);
+        {
+            signal_data_abort(addr, true);
+            return;
+        }
     }
     if (!(mem & (1ULL << 63ULL)))
     {
         mem &= ~(0xFULL << 60ULL);
         uint8_t* ptr = (uint8_t*)mem;
         ptr[addr & 0xFFF] = value;
+        if (code_cache)
+            code_cache->check_code_write(ptr);
         return;
     }
     else
-        addr = (mem & 0xFFFFF000) + (addr & 0xFFF);
+        addr += (uint32_t)mem;
     if (id == 9)
         e->arm9_write8(addr, value);
     else
         e->arm11_write8(id - 11, addr, value);
 }
 
-void ARM_CPU::write16(uint32_t addr, uint16_t value)
+void ARM_CPU::write16_slow(uint32_t addr, uint16_t value)
 {
     if (id == 9 && (addr & 0x1))
         EmuException::die("[ARM9] Unaligned write16 $%08X: $%04X", addr, value);
     if ((addr & 0xFFF) > 0xFFE)
         EmuException::die("[ARM%d] Unaligned write16 on page boundary $%08X: $%08X", id, addr, value);
-    uint64_t mem = (uint64_t)tlb_map[addr / 4096];
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
     if (!(mem & (1ULL << 61ULL)))
     {
         //TLB miss - reload and check the vaddr again
         cp15->reload_tlb(addr);
-        mem = (uint64_t)tlb_map[addr / 4096];
+        mem = (uint64_t)tlb_map->get(addr / 4096);
         if (!(mem & (1ULL << 62ULL)))
-            throw EmuException::ARMDataAbort(addr, true);
+        {
+            signal_data_abort(addr, true);
+            return;
+        }
     }
     if (!(mem & (1ULL << 63ULL)))
     {
         mem &= ~(0xFULL << 60ULL);
         uint8_t* ptr = (uint8_t*)mem;
         *(uint16_t*)&ptr[addr & 0xFFF] = value;
+        if (code_cache)
+            code_cache->check_code_write(ptr);
         return;
     }
     else
-        addr = (mem & 0xFFFFF000) + (addr & 0xFFF);
+        addr += (uint32_t)mem;
     if (id == 9)
         e->arm9_write16(addr, value);
     else
         e->arm11_write16(id - 11, addr, value);
 }
 
-void ARM_CPU::write32(uint32_t addr, uint32_t value)
+void ARM_CPU::write32_slow(uint32_t addr, uint32_t value)
 {
     if (id == 9 && (addr & 0x3))
         EmuException::die("[ARM9] Unaligned write32 $%08X: $%08X", addr, value);
     if ((addr & 0xFFF) > 0xFFC)
     {
-        printf("[ARM%d] Unaligned write32 $%08X: $%08X\n", id, addr, value);
+        LOG(LOG_ARM, LOG_WARN, "[ARM%d] Unaligned write32 $%08X: $%08X\n", id, addr, value);
         const static uint32_t mask[] = {0xFF, 0xFFFF, 0xFFFFFF, 0xFFFFFFFF};
         const static uint32_t read_mask[] = {0, 0xFF, 0xFFFF, 0xFFFFFF};
         int low_bits = addr & 0x3;
@@ -792,37 +969,42 @@ void ARM_CPU::write32(uint32_t addr, uint32_t value)
         word1 <<= (low_bits * 8);
         word2 >>= ((4 - low_bits) * 8);
 
-        printf("Word1: $%08X Word2: $%08X\n", word1, word2);
+        LOG(LOG_ARM, LOG_DEBUG, "Word1: $%08X Word2: $%08X\n", word1, word2);
 
         word1 |= read32(addr & ~0x3) & read_mask[low_bits];
         word2 |= read32((addr & ~0x3) + 4) & read_mask[3 - low_bits];
 
-        printf("New1: $%08X New2: $%08X\n", word1, word2);
+        LOG(LOG_ARM, LOG_DEBUG, "New1: $%08X New2: $%08X\n", word1, word2);
 
         write32(addr & ~0x3, word1);
         write32((addr & ~0x3) + 4, word2);
         //EmuException::die("Unaligned write32 on page boundary");
     }
-    uint64_t mem = (uint64_t)tlb_map[addr / 4096];
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
     if (!(mem & (1ULL << 61ULL)))
     {
         //TLB miss - reload and check the vaddr again
         if (id == 9 && (addr & 0xF0000000) == 0xC0000000)
             return;
         cp15->reload_tlb(addr);
-        mem = (uint64_t)tlb_map[addr / 4096];
+        mem = (uint64_t)tlb_map->get(addr / 4096);
         if (!(mem & (1ULL << 61ULL)))
-            throw EmuException::ARMDataAbort(addr, true);
+        {
+            signal_data_abort(addr, true);
+            return;
+        }
     }
     if (!(mem & (1ULL << 63ULL)))
     {
         mem &= ~(0xFULL << 60ULL);
         uint8_t* ptr = (uint8_t*)mem;
         *(uint32_t*)&ptr[addr & 0xFFF] = value;
+        if (code_cache)
+            code_cache->check_code_write(ptr);
         return;
     }
     else
-        addr = (mem & 0xFFFFF000) + (addr & 0xFFF);
+        addr += (uint32_t)mem;
     if (id == 9)
         e->arm9_write32(addr, value);
     else
@@ -835,10 +1017,18 @@ void ARM_CPU::write64(uint32_t addr, uint64_t value)
     write32(addr + 4, value >> 32);
 }
 
+//RAM is tracked by host address and MMIO by guest physical address, so every core agrees on the address
+uint64_t ARM_CPU::get_exclusive_addr(uint32_t addr)
+{
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
+    if (mem & (1ULL << 63ULL))
+        return (uint32_t)(mem + addr);
+    return (mem & ~(0xFULL << 60ULL)) + (addr & 0xFFF);
+}
+
 bool ARM_CPU::has_exclusive(uint32_t addr)
 {
-    uint64_t paddr = (uint64_t)tlb_map[addr / 4096] + (addr & 0xFFF);
-    paddr &= ~(0xFFULL << 56ULL);
+    uint64_t paddr = get_exclusive_addr(addr);
 
     if (paddr < local_exclusive_start || paddr > local_exclusive_end)
         return false;
@@ -853,9 +1043,8 @@ bool ARM_CPU::has_exclusive(uint32_t addr)
 
 void ARM_CPU::set_exclusive(uint32_t addr, uint32_t size)
 {
-    uint64_t paddr = (uint64_t)tlb_map[addr / 4096] + (addr & 0xFFF);
-
-    paddr &= ~(0xFFULL << 56ULL);
+    std::unique_lock<std::recursive_mutex> lock = lock_exclusives();
+    uint64_t paddr = get_exclusive_addr(addr);
     local_exclusive_start = paddr;
     local_exclusive_end = paddr + size;
 
@@ -863,13 +1052,11 @@ void ARM_CPU::set_exclusive(uint32_t addr, uint32_t size)
     global_exclusive_end[id - 11] = local_exclusive_end;
 }
 
+//ARM11 only. Handlers shared with the ARM9 go through the templated wrapper.
 void ARM_CPU::clear_global_exclusives(uint32_t addr)
 {
-    if (id < 11)
-        return;
-    uint64_t paddr = (uint64_t)tlb_map[addr / 4096] + (addr & 0xFFF);
-
-    paddr &= ~(0xFFULL << 56ULL);
+    std::unique_lock<std::recursive_mutex> lock = lock_exclusives();
+    uint64_t paddr = get_exclusive_addr(addr);
 
     for (int i = 0; i < 4; i++)
     {
@@ -883,6 +1070,7 @@ void ARM_CPU::clear_global_exclusives(uint32_t addr)
 
 void ARM_CPU::clear_exclusive()
 {
+    std::unique_lock<std::recursive_mutex> lock = lock_exclusives();
     local_exclusive_start = 0;
     local_exclusive_end = 0;
     global_exclusive_start[id - 11] = 0;
@@ -960,27 +1148,29 @@ void ARM_CPU::sub(uint32_t destination, uint32_t source, uint32_t operand, bool
 
 void ARM_CPU::adc(uint32_t destination, uint32_t source, uint32_t operand, bool set_condition_codes)
 {
+    CPSR.resolve_cv();
     uint8_t carry = (CPSR.carry) ? 1 : 0;
     add(destination, source + carry, operand, set_condition_codes);
     if (set_condition_codes)
     {
         uint32_t temp = source + operand;
         uint32_t res = temp + carry;
-        CPSR.carry = CARRY_ADD(source, operand) | CARRY_ADD(temp, carry);
-        CPSR.overflow = ADD_OVERFLOW(source, operand, temp) | ADD_OVERFLOW(temp, carry, res);
+        CPSR.set_CV(CARRY_ADD(source, operand) | CARRY_ADD(temp, carry),
+                    ADD_OVERFLOW(source, operand, temp) | ADD_OVERFLOW(temp, carry, res));
     }
 }
 
 void ARM_CPU::sbc(uint32_t destination, uint32_t source, uint32_t operand, bool set_condition_codes)
 {
+    CPSR.resolve_cv();
     unsigned int borrow = (CPSR.carry) ? 0 : 1;
     sub(destination, source, operand + borrow, set_condition_codes);
     if (set_condition_codes)
     {
         uint32_t temp = source - operand;
         uint32_t res = temp - borrow;
-        CPSR.carry = CARRY_SUB(source, operand) & CARRY_SUB(temp, borrow);
-        CPSR.overflow = SUB_OVERFLOW(source, operand, temp) | SUB_OVERFLOW(temp, borrow, res);
+        CPSR.set_CV(CARRY_SUB(source, operand) & CARRY_SUB(temp, borrow),
+                    SUB_OVERFLOW(source, operand, temp) | SUB_OVERFLOW(temp, borrow, res));
     }
 }
 
@@ -998,14 +1188,14 @@ void ARM_CPU::cmn(uint32_t x, uint32_t y)
 {
     uint32_t result = x + y;
     set_zero_neg_flags(result);
-    set_CV_add_flags(x, y, result);
+    set_CV_add_flags(x, y);
 }
 
 void ARM_CPU::cmp(uint32_t x, uint32_t y)
 {
     uint32_t result = x - y;
     set_zero_neg_flags(result);
-    set_CV_sub_flags(x, y, result);
+    set_CV_sub_flags(x, y);
 }
 
 void ARM_CPU::mov(uint32_t destination, uint32_t operand, bool alter_flags)
@@ -1195,7 +1385,7 @@ void ARM_CPU::srs(uint32_t instr)
         }
     }
 
-    if (is_writing_back)
+    if (is_writing_back && !data_abort_pending)
         set_register(REG_SP, banked_addr + (offset * 2));
 
     //Restore previous state
@@ -1245,6 +1435,9 @@ void ARM_CPU::rfe(uint32_t instr)
         }
     }
 
+    if (data_abort_pending)
+        return;
+
     if (is_writing_back)
         set_register(base, addr + (offset * 2));
 
@@ -1258,7 +1451,7 @@ void ARM_CPU::rfe(uint32_t instr)
         std::string procname;
         int pid;
         get_hos_process_info(*this, pid, procname);
-        printf("Jumping to PID%d[%s] (addr: $%08X)\n", pid, procname.c_str(), PC);
+        LOG(LOG_ARM, LOG_TRACE, "Jumping to PID%d[%s] (addr: $%08X)\n", pid, procname.c_str(), PC);
         if (addr & 0xFFFFF)
         {
             uint32_t prev_instr = read32(addr - 4);
@@ -1266,12 +1459,12 @@ void ARM_CPU::rfe(uint32_t instr)
             {
                 uint32_t error = read32(cp15->mrc(0, 0xD, 3, 0) + 0x84);
                 if (error & (1 << 31))
-                    printf("Error: $%08X\n", error);
+                    LOG(LOG_ARM, LOG_WARN, "Error: $%08X\n", error);
             }
             else if ((prev_instr & 0x0F000000) == 0x0F000000 && (prev_instr & 0xFF) != 0x28)
             {
                 if (gpr[0] & (1 << 31))
-                   printf("Error: $%08X\n", gpr[0]);
+                   LOG(LOG_ARM, LOG_WARN, "Error: $%08X\n", gpr[0]);
             }
         }
         if (pid == 7)
@@ -1321,10 +1514,20 @@ void ARM_CPU::mcr(int coprocessor_id, int operation_mode,
     switch (coprocessor_id)
     {
         case 15:
+        {
             cp15->mcr(operation_mode, CP_reg, coprocessor_info, coprocessor_operand, value);
 
-            tlb_map = cp15->get_tlb_mapping();
+            //Turning the MMU on or off swaps the whole mapping out
+            PageMap* new_tlb_map = cp15->get_tlb_mapping();
+            if (fastmem && new_tlb_map != tlb_map)
+                fastmem->unmap_all();
+            tlb_map = new_tlb_map;
+
+            //Virtual to physical translation may have changed
+            if (code_cache)
+                code_cache->flush_lookup(*this);
             break;
+        }
     }
 }
 
@@ -1341,7 +1544,7 @@ uint32_t ARM_CPU::lsl(uint32_t value, int shift, bool alter_flags)
         if (alter_flags)
         {
             set_zero_neg_flags(0);
-            CPSR.carry = false;
+            CPSR.set_carry(false);
         }
         return 0;
     }
@@ -1350,7 +1553,7 @@ uint32_t ARM_CPU::lsl(uint32_t value, int shift, bool alter_flags)
         if (alter_flags)
         {
             set_zero_neg_flags(0);
-            CPSR.carry = value & (1 << 0);
+            CPSR.set_carry(value & (1 << 0));
         }
         return 0;
     }
@@ -1358,7 +1561,7 @@ uint32_t ARM_CPU::lsl(uint32_t value, int shift, bool alter_flags)
     if (alter_flags)
     {
         set_zero_neg_flags(result);
-        CPSR.carry = value & (1 << (32 - shift));
+        CPSR.set_carry(value & (1 << (32 - shift)));
     }
     return value << shift;
 }
@@ -1370,7 +1573,7 @@ uint32_t ARM_CPU::lsr(uint32_t value, int shift, bool alter_flags)
         if (alter_flags)
         {
             set_zero_neg_flags(0);
-            CPSR.carry = false;
+            CPSR.set_carry(false);
         }
         return 0;
     }
@@ -1381,7 +1584,7 @@ uint32_t ARM_CPU::lsr(uint32_t value, int shift, bool alter_flags)
     {
         set_zero_neg_flags(result);
         if (shift)
-            CPSR.carry = value & (1 << (shift - 1));
+            CPSR.set_carry(value & (1 << (shift - 1)));
     }
     return result;
 }
@@ -1391,7 +1594,7 @@ uint32_t ARM_CPU::lsr_32(uint32_t value, bool alter_flags)
     if (alter_flags)
     {
         set_zero_neg_flags(0);
-        CPSR.carry = value & (1 << 31);
+        CPSR.set_carry(value & (1 << 31));
     }
     return 0;
 }
@@ -1405,7 +1608,7 @@ uint32_t ARM_CPU::asr(uint32_t value, int shift, bool alter_flags)
     {
         set_zero_neg_flags(result);
         if (shift)
-            CPSR.carry = value & (1 << (shift - 1));
+            CPSR.set_carry(value & (1 << (shift - 1)));
     }
     return result;
 }
@@ -1416,7 +1619,7 @@ uint32_t ARM_CPU::asr_32(uint32_t value, bool alter_flags)
     if (alter_flags)
     {
         set_zero_neg_flags(result);
-        CPSR.carry = value & (1 << 31);
+        CPSR.set_carry(value & (1 << 31));
     }
     return result;
 }
@@ -1425,11 +1628,12 @@ uint32_t ARM_CPU::rrx(uint32_t value, bool alter_flags)
 {
     uint32_t result = value;
     result >>= 1;
+    CPSR.resolve_cv();
     result |= (CPSR.carry) ? (1 << 31) : 0;
     if (alter_flags)
     {
         set_zero_neg_flags(result);
-        CPSR.carry = value & 0x1;
+        CPSR.set_carry(value & 0x1);
     }
     return result;
 }
@@ -1441,9 +1645,9 @@ uint32_t ARM_CPU::rotr32(uint32_t n, unsigned int c, bool alter_flags)
     if (alter_flags && c)
     {
         if (c & 0x1F)
-            CPSR.carry = n & (1 << (c - 1));
+            CPSR.set_carry(n & (1 << (c - 1)));
         else
-            CPSR.carry = n & (1 << 31);
+            CPSR.set_carry(n & (1 << 31));
     }
     c &= mask;
 
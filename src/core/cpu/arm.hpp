@@ -1,8 +1,13 @@
 #ifndef ARM_HPP
 #define ARM_HPP
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include "../common/log.hpp"
+#include "arm_code_cache.hpp"
 #include "cp15.hpp"
+#include "fastmem.hpp"
+#include "page_map.hpp"
 
 #define REG_SP 13
 #define REG_LR 14
@@ -25,12 +30,36 @@ enum PSR_MODE
     PSR_SYSTEM = 0x1F
 };
 
+//The ARM9 is an ARM946E-S (ARMv5TE) and the ARM11s are MPCore (ARMv6K). Interpreter paths that differ between
+//them are templated on this, with the type fixed by the core ID when the Emulator constructs the CPU.
+enum ARM_CORE_TYPE
+{
+    ARM_CORE_ARM9,
+    ARM_CORE_ARM11
+};
+
+enum CPU_BACKEND
+{
+    BACKEND_INTERPRETER,
+    BACKEND_CACHED_INTERPRETER,
+    BACKEND_JIT
+};
+
+enum LAZY_CV_OP
+{
+    LAZY_CV_NONE,
+    LAZY_CV_ADD,
+    LAZY_CV_SUB
+};
+
 struct PSR_Flags
 {
     PSR_MODE mode;
     bool thumb;
     bool fiq_disable, irq_disable;
 
+    //NZCV are evaluated lazily. Flag-setting ALU ops only record their result and operands, and the bools below
+    //are brought up to date by resolve_flags() when something reads them.
     bool negative;
     bool zero;
     bool carry;
@@ -38,43 +67,168 @@ struct PSR_Flags
     bool q_overflow;
     bool ge[4];
 
+    bool lazy_nz;
+    LAZY_CV_OP lazy_cv;
+    uint32_t lazy_result;
+    uint32_t lazy_a, lazy_b;
+
     uint32_t get();
     void set(uint32_t value);
+
+    void resolve_nz();
+    void resolve_cv();
+    void resolve_flags();
+    void set_carry(bool value);
+    void set_CV(bool c, bool v);
 };
 
+inline void PSR_Flags::resolve_nz()
+{
+    if (lazy_nz)
+    {
+        negative = lazy_result & (1 << 31);
+        zero = !lazy_result;
+        lazy_nz = false;
+    }
+}
+
+//Code here from melonDS's ALU core (my original implementation was incorrect in many ways)
+inline void PSR_Flags::resolve_cv()
+{
+    if (lazy_cv == LAZY_CV_ADD)
+    {
+        uint32_t result = lazy_a + lazy_b;
+        carry = CARRY_ADD(lazy_a, lazy_b);
+        overflow = ADD_OVERFLOW(lazy_a, lazy_b, result);
+    }
+    else if (lazy_cv == LAZY_CV_SUB)
+    {
+        uint32_t result = lazy_a - lazy_b;
+        carry = CARRY_SUB(lazy_a, lazy_b);
+        overflow = SUB_OVERFLOW(lazy_a, lazy_b, result);
+    }
+    lazy_cv = LAZY_CV_NONE;
+}
+
+inline void PSR_Flags::resolve_flags()
+{
+    resolve_nz();
+    resolve_cv();
+}
+
+//V may still be pending from an earlier add/sub, so it has to be evaluated before C is overwritten
+inline void PSR_Flags::set_carry(bool value)
+{
+    resolve_cv();
+    carry = value;
+}
+
+inline void PSR_Flags::set_CV(bool c, bool v)
+{
+    lazy_cv = LAZY_CV_NONE;
+    carry = c;
+    overflow = v;
+}
+
 class Emulator;
 class VFP;
+class ARM_CodeCache;
 
 class ARM_CPU
 {
     private:
+        friend class ARM_CodeCache;
+        friend class ARM_CachedInterpreter;
+        friend class ARM_JIT;
+
         Emulator* e;
         int id;
+        ARM_CORE_TYPE core_type;
         uint32_t gpr[16];
         bool prefetch_abort_occurred;
+
+        //Set by a faulting load/store instead of unwinding. The instruction returns without committing anything
+        //further, and the abort is taken once it does.
+        bool data_abort_pending;
+        uint32_t data_abort_vaddr;
+        bool data_abort_is_write;
+
         bool halted;
         bool waiting_for_event;
         bool can_disassemble;
         bool int_pending;
         bool event_pending;
+
+        //Signals raised by another core's thread during a parallel quantum, applied once the quantum ends
+        bool deferred_int_signal_set;
+        bool deferred_int_signal;
+        bool deferred_event;
+
         int cycles_ran;
         uint64_t local_exclusive_start, local_exclusive_end;
 
         CP15* cp15;
         VFP* vfp;
 
+        //Null when running on the interpreter
+        ARM_CodeCache* code_cache;
+
+        //Null unless fastmem is enabled for this core
+        FastmemSpace* fastmem;
+        uint8_t* fastmem_base;
+
         uint32_t fiq_regs[5];
         uint32_t SP_und, SP_irq, SP_svc, SP_fiq, SP_abt;
         uint32_t LR_und, LR_irq, LR_svc, LR_fiq, LR_abt;
 
         PSR_Flags CPSR, SPSR[0x20];
 
-        uint8_t** tlb_map;
+        PageMap* tlb_map;
         uint8_t* instr_ptr;
 
         void fetch_new_instr_ptr(uint32_t addr);
+
+        template <ARM_CORE_TYPE core> void run_interpreter(int cycles);
+
+        bool is_foreign_thread();
+
+        uint64_t get_exclusive_addr(uint32_t addr);
+
+        void signal_data_abort(uint32_t addr, bool is_write);
+        void take_data_abort();
+
+        //Accesses through tlb_map, used when fastmem is off and when a fastmem access faults
+        uint8_t read8_tlb(uint32_t addr);
+        uint16_t read16_tlb(uint32_t addr);
+        uint32_t read32_tlb(uint32_t addr);
+        void write8_tlb(uint32_t addr, uint8_t value);
+        void write16_tlb(uint32_t addr, uint16_t value);
+        void write32_tlb(uint32_t addr, uint32_t value);
+        void map_fastmem_page(uint32_t addr);
+
+        friend uint8_t (::fastmem_read8_fault)(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+        friend uint16_t (::fastmem_read16_fault)(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+        friend uint32_t (::fastmem_read32_fault)(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+        friend void (::fastmem_write8_fault)(uint8_t* base, uint64_t addr, uint8_t value, ARM_CPU* cpu);
+        friend void (::fastmem_write16_fault)(uint8_t* base, uint64_t addr, uint16_t value, ARM_CPU* cpu);
+        friend void (::fastmem_write32_fault)(uint8_t* base, uint64_t addr, uint32_t value, ARM_CPU* cpu);
+
+        //TLB misses, MMIO, unaligned accesses and aborts
+        uint8_t read8_slow(uint32_t addr);
+        uint16_t read16_slow(uint32_t addr);
+        uint32_t read32_slow(uint32_t addr);
+        void write8_slow(uint32_t addr, uint8_t value);
+        void write16_slow(uint32_t addr, uint16_t value);
+        void write32_slow(uint32_t addr, uint32_t value);
     public:
         static uint64_t global_exclusive_start[4], global_exclusive_end[4];
+
+        //Set while the ARM11 cores run a quantum on separate host threads. Cross-core state is only locked then.
+        static bool parallel_quantum;
+        static thread_local ARM_CPU* thread_cpu;
+        static std::recursive_mutex exclusive_lock;
+        static std::unique_lock<std::recursive_mutex> lock_exclusives();
+
         ARM_CPU(Emulator* e, int id, CP15* cp15, VFP* vfp);
 
         static std::string get_reg_name(int id);
@@ -83,6 +237,7 @@ class ARM_CPU
         void run(int cycles);
         void print_state();
         int get_id();
+        ARM_CORE_TYPE get_core_type();
         int get_cycles_ran();
         void inc_cycle_count(int delta);
 
@@ -100,9 +255,17 @@ class ARM_CPU
         void write32(uint32_t addr, uint32_t value);
         void write64(uint32_t addr, uint64_t value);
 
+        bool is_data_abort_pending();
+
+        //Debug reads that report a fault instead of raising an abort
+        bool try_read8(uint32_t addr, uint8_t& value);
+        bool try_read16(uint32_t addr, uint16_t& value);
+        bool try_read32(uint32_t addr, uint32_t& value);
+
         bool has_exclusive(uint32_t addr);
         void set_exclusive(uint32_t addr, uint32_t size);
         void clear_global_exclusives(uint32_t addr);
+        template <ARM_CORE_TYPE core> void clear_global_exclusives(uint32_t addr);
         void clear_exclusive();
 
         uint32_t get_register(int id);
@@ -119,14 +282,17 @@ class ARM_CPU
         void wfe();
         void sev();
         void send_event(int id);
+        void apply_deferred_signals();
         void set_disassembly(bool dis);
+        void set_code_cache(ARM_CodeCache* code_cache);
+        void set_fastmem(FastmemSpace* fastmem);
 
         void jp(uint32_t addr, bool change_thumb_state);
         void set_zero_neg_flags(uint32_t value);
         void set_zero(bool flag);
         void set_neg(bool flag);
-        void set_CV_add_flags(uint32_t a, uint32_t b, uint32_t result);
-        void set_CV_sub_flags(uint32_t a, uint32_t b, uint32_t result);
+        void set_CV_add_flags(uint32_t a, uint32_t b);
+        void set_CV_sub_flags(uint32_t a, uint32_t b);
         void update_reg_mode(PSR_MODE mode);
         void spsr_to_cpsr();
         bool meets_condition(int cond);
@@ -170,6 +336,155 @@ class ARM_CPU
         uint32_t rotr32(uint32_t n, unsigned int c, bool alter_flags);
 };
 
+//Fast paths for aligned accesses to RAM with a valid TLB entry; everything else goes through the slow paths
+inline uint8_t ARM_CPU::read8_tlb(uint32_t addr)
+{
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
+    if ((mem >> 62ULL) == 0x1)
+        return ((uint8_t*)(mem & ~(0xFULL << 60ULL)))[addr & 0xFFF];
+    return read8_slow(addr);
+}
+
+inline uint16_t ARM_CPU::read16_tlb(uint32_t addr)
+{
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
+    if ((mem >> 62ULL) == 0x1 && !(addr & 0x1))
+        return *(uint16_t*)&((uint8_t*)(mem & ~(0xFULL << 60ULL)))[addr & 0xFFF];
+    return read16_slow(addr);
+}
+
+inline uint32_t ARM_CPU::read32_tlb(uint32_t addr)
+{
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
+    if ((mem >> 62ULL) == 0x1 && !(addr & 0x3))
+        return *(uint32_t*)&((uint8_t*)(mem & ~(0xFULL << 60ULL)))[addr & 0xFFF];
+    return read32_slow(addr);
+}
+
+inline void ARM_CPU::write8_tlb(uint32_t addr, uint8_t value)
+{
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
+    if ((mem & (0x5ULL << 61ULL)) == (1ULL << 61ULL))
+    {
+        uint8_t* ptr = (uint8_t*)(mem & ~(0xFULL << 60ULL));
+        ptr[addr & 0xFFF] = value;
+        if (code_cache)
+            code_cache->check_code_write(ptr);
+        return;
+    }
+    write8_slow(addr, value);
+}
+
+inline void ARM_CPU::write16_tlb(uint32_t addr, uint16_t value)
+{
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
+    if ((mem & (0x5ULL << 61ULL)) == (1ULL << 61ULL) && !(addr & 0x1))
+    {
+        uint8_t* ptr = (uint8_t*)(mem & ~(0xFULL << 60ULL));
+        *(uint16_t*)&ptr[addr & 0xFFF] = value;
+        if (code_cache)
+            code_cache->check_code_write(ptr);
+        return;
+    }
+    write16_slow(addr, value);
+}
+
+inline void ARM_CPU::write32_tlb(uint32_t addr, uint32_t value)
+{
+    uint64_t mem = (uint64_t)tlb_map->get(addr / 4096);
+    if ((mem & (0x5ULL << 61ULL)) == (1ULL << 61ULL) && !(addr & 0x3))
+    {
+        uint8_t* ptr = (uint8_t*)(mem & ~(0xFULL << 60ULL));
+        *(uint32_t*)&ptr[addr & 0xFFF] = value;
+        if (code_cache)
+            code_cache->check_code_write(ptr);
+        return;
+    }
+    write32_slow(addr, value);
+}
+
+//With fastmem, aligned accesses are a single host load or store. The alignment checks keep unaligned accesses,
+//which have their own ARM rules, on the slow path.
+inline uint8_t ARM_CPU::read8(uint32_t addr)
+{
+#ifdef FASTMEM_SUPPORTED
+    if (fastmem_base)
+        return fastmem_read8(fastmem_base, addr, this);
+#endif
+    return read8_tlb(addr);
+}
+
+inline uint16_t ARM_CPU::read16(uint32_t addr)
+{
+#ifdef FASTMEM_SUPPORTED
+    if (fastmem_base && !(addr & 0x1))
+        return fastmem_read16(fastmem_base, addr, this);
+#endif
+    return read16_tlb(addr);
+}
+
+inline uint32_t ARM_CPU::read32(uint32_t addr)
+{
+#ifdef FASTMEM_SUPPORTED
+    if (fastmem_base && !(addr & 0x3))
+        return fastmem_read32(fastmem_base, addr, this);
+#endif
+    return read32_tlb(addr);
+}
+
+inline void ARM_CPU::write8(uint32_t addr, uint8_t value)
+{
+#ifdef FASTMEM_SUPPORTED
+    if (fastmem_base)
+    {
+        fastmem_write8(fastmem_base, addr, value, this);
+        return;
+    }
+#endif
+    write8_tlb(addr, value);
+}
+
+inline void ARM_CPU::write16(uint32_t addr, uint16_t value)
+{
+#ifdef FASTMEM_SUPPORTED
+    if (fastmem_base && !(addr & 0x1))
+    {
+        fastmem_write16(fastmem_base, addr, value, this);
+        return;
+    }
+#endif
+    write16_tlb(addr, value);
+}
+
+inline void ARM_CPU::write32(uint32_t addr, uint32_t value)
+{
+#ifdef FASTMEM_SUPPORTED
+    if (fastmem_base && !(addr & 0x3))
+    {
+        fastmem_write32(fastmem_base, addr, value, this);
+        return;
+    }
+#endif
+    write32_tlb(addr, value);
+}
+
+inline bool ARM_CPU::is_data_abort_pending()
+{
+    return data_abort_pending;
+}
+
+inline bool ARM_CPU::is_foreign_thread()
+{
+    return parallel_quantum && thread_cpu != this;
+}
+
+inline std::unique_lock<std::recursive_mutex> ARM_CPU::lock_exclusives()
+{
+    if (parallel_quantum)
+        return std::unique_lock<std::recursive_mutex>(exclusive_lock);
+    return std::unique_lock<std::recursive_mutex>();
+}
+
 inline bool ARM_CPU::is_halted()
 {
     return halted;
@@ -180,6 +495,19 @@ inline int ARM_CPU::get_id()
     return id;
 }
 
+inline ARM_CORE_TYPE ARM_CPU::get_core_type()
+{
+    return core_type;
+}
+
+//Stores have to break the other cores' exclusive reservations, which only exist on the ARM11
+template <ARM_CORE_TYPE core>
+inline void ARM_CPU::clear_global_exclusives(uint32_t addr)
+{
+    if (core == ARM_CORE_ARM11)
+        clear_global_exclusives(addr);
+}
+
 inline int ARM_CPU::get_cycles_ran()
 {
     return cycles_ran;
@@ -197,8 +525,8 @@ inline uint32_t ARM_CPU::get_register(int id)
 
 inline void ARM_CPU::set_register(int id, uint32_t value)
 {
-    if (can_disassemble)
-        printf("[ARM%d] Set reg%d: $%08X\n", this->id, id, value);
+    if (LOG_COMPILED(LOG_TRACE) && can_disassemble)
+        LOG(LOG_ARM, LOG_TRACE, "[ARM%d] Set reg%d: $%08X\n", this->id, id, value);
     gpr[id] = value;
 }
 
@@ -212,19 +540,48 @@ inline PSR_Flags* ARM_CPU::get_CPSR()
     return &CPSR;
 }
 
+inline void ARM_CPU::set_zero_neg_flags(uint32_t value)
+{
+    CPSR.lazy_result = value;
+    CPSR.lazy_nz = true;
+}
+
 inline void ARM_CPU::set_zero(bool flag)
 {
+    CPSR.resolve_nz();
     CPSR.zero = flag;
 }
 
 inline void ARM_CPU::set_neg(bool flag)
 {
+    CPSR.resolve_nz();
     CPSR.negative = flag;
 }
 
+inline void ARM_CPU::set_CV_add_flags(uint32_t a, uint32_t b)
+{
+    CPSR.lazy_a = a;
+    CPSR.lazy_b = b;
+    CPSR.lazy_cv = LAZY_CV_ADD;
+}
+
+inline void ARM_CPU::set_CV_sub_flags(uint32_t a, uint32_t b)
+{
+    CPSR.lazy_a = a;
+    CPSR.lazy_b = b;
+    CPSR.lazy_cv = LAZY_CV_SUB;
+}
+
 inline void ARM_CPU::set_disassembly(bool dis)
 {
     can_disassemble = dis;
+    if (dis)
+        Log::set_level(LOG_ARM, LOG_TRACE);
+}
+
+inline void ARM_CPU::set_code_cache(ARM_CodeCache *code_cache)
+{
+    this->code_cache = code_cache;
 }
 
 #endif // ARM_HPP
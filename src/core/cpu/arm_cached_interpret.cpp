@@ -0,0 +1,1035 @@
+#include <cstring>
+#include "arm.hpp"
+#include "arm_cached_interpret.hpp"
+#include "arm_disasm.hpp"
+
+enum CACHED_OPERAND
+{
+    OPERAND_IMM,
+    OPERAND_REG,
+    OPERAND_SHIFTED_REG
+};
+
+enum CACHED_INDEXING
+{
+    INDEX_OFFSET,
+    INDEX_PRE_WRITEBACK,
+    INDEX_POST
+};
+
+static void interpret_arm_instr(ARM_CPU &cpu, const CachedArmInstr &instr)
+{
+    instr.interpret(cpu, instr.instr);
+}
+
+static void interpret_thumb_instr(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    instr.interpret(cpu, instr.instr);
+}
+
+//Immediate shifts that leave the flags alone
+static inline uint32_t shift_reg(ARM_CPU &cpu, const CachedArmInstr &instr)
+{
+    uint32_t value = cpu.get_register(instr.rm);
+    int shift = instr.shift;
+    switch (instr.shift_type)
+    {
+        case 0:
+            return value << shift;
+        case 1:
+            return (shift) ? value >> shift : 0;
+        case 2:
+            return static_cast<int32_t>(value) >> ((shift) ? shift : 31);
+        default:
+            if (!shift)
+                return cpu.rrx(value, false);
+            return (value >> shift) | (value << (32 - shift));
+    }
+}
+
+//The same shifts through ARM_CPU's shifter, which also sets the carry out
+static inline uint32_t shift_reg_carry(ARM_CPU &cpu, const CachedArmInstr &instr)
+{
+    uint32_t value = cpu.get_register(instr.rm);
+    int shift = instr.shift;
+    switch (instr.shift_type)
+    {
+        case 0:
+            return cpu.lsl(value, shift, true);
+        case 1:
+            return (shift) ? cpu.lsr(value, shift, true) : cpu.lsr_32(value, true);
+        case 2:
+            return (shift) ? cpu.asr(value, shift, true) : cpu.asr_32(value, true);
+        default:
+            return (shift) ? cpu.rotr32(value, shift, true) : cpu.rrx(value, true);
+    }
+}
+
+template <int opcode, bool set_flags, CACHED_OPERAND operand>
+static void arm_data_processing(ARM_CPU &cpu, const CachedArmInstr &instr)
+{
+    constexpr bool logical = opcode <= 0x1 || (opcode >= 0x8 && opcode <= 0x9) || opcode >= 0xC;
+    constexpr bool set_carry = logical && set_flags;
+
+    uint32_t a = cpu.get_register(instr.rn);
+    uint32_t b;
+    if (operand == OPERAND_IMM)
+    {
+        b = instr.imm;
+
+        //A rotated immediate's carry out is its top bit
+        if (set_carry && instr.shift)
+            cpu.get_CPSR()->set_carry(b >> 31);
+    }
+    else if (operand == OPERAND_REG)
+        b = cpu.get_register(instr.rm);
+    else if (set_carry)
+        b = shift_reg_carry(cpu, instr);
+    else
+        b = shift_reg(cpu, instr);
+
+    uint32_t result;
+    switch (opcode)
+    {
+        case 0x0:
+            result = a & b;
+            break;
+        case 0x1:
+            result = a ^ b;
+            break;
+        case 0x2:
+            result = a - b;
+            if (set_flags)
+                cpu.set_CV_sub_flags(a, b);
+            break;
+        case 0x3:
+            result = b - a;
+            if (set_flags)
+                cpu.set_CV_sub_flags(b, a);
+            break;
+        case 0x4:
+            result = a + b;
+            if (set_flags)
+                cpu.set_CV_add_flags(a, b);
+            break;
+        case 0x5:
+            cpu.adc(instr.rd, a, b, set_flags);
+            return;
+        case 0x6:
+            cpu.sbc(instr.rd, a, b, set_flags);
+            return;
+        case 0x7:
+            cpu.sbc(instr.rd, b, a, set_flags);
+            return;
+        case 0x8:
+            cpu.set_zero_neg_flags(a & b);
+            return;
+        case 0x9:
+            cpu.set_zero_neg_flags(a ^ b);
+            return;
+        case 0xA:
+            cpu.cmp(a, b);
+            return;
+        case 0xB:
+            cpu.cmn(a, b);
+            return;
+        case 0xC:
+            result = a | b;
+            break;
+        case 0xD:
+            result = b;
+            break;
+        case 0xE:
+            result = a & ~b;
+            break;
+        default:
+            result = ~b;
+            break;
+    }
+
+    cpu.set_register(instr.rd, result);
+    if (set_flags)
+        cpu.set_zero_neg_flags(result);
+}
+
+template <int opcode>
+static CachedArmHandler get_data_processing_handler(bool set_flags, CACHED_OPERAND operand)
+{
+    switch (operand)
+    {
+        case OPERAND_IMM:
+            return (set_flags) ? arm_data_processing<opcode, true, OPERAND_IMM>
+                               : arm_data_processing<opcode, false, OPERAND_IMM>;
+        case OPERAND_REG:
+            return (set_flags) ? arm_data_processing<opcode, true, OPERAND_REG>
+                               : arm_data_processing<opcode, false, OPERAND_REG>;
+        default:
+            return (set_flags) ? arm_data_processing<opcode, true, OPERAND_SHIFTED_REG>
+                               : arm_data_processing<opcode, false, OPERAND_SHIFTED_REG>;
+    }
+}
+
+static CachedArmHandler get_data_processing_handler(int opcode, bool set_flags, CACHED_OPERAND operand)
+{
+    switch (opcode)
+    {
+        case 0x0: return get_data_processing_handler<0x0>(set_flags, operand);
+        case 0x1: return get_data_processing_handler<0x1>(set_flags, operand);
+        case 0x2: return get_data_processing_handler<0x2>(set_flags, operand);
+        case 0x3: return get_data_processing_handler<0x3>(set_flags, operand);
+        case 0x4: return get_data_processing_handler<0x4>(set_flags, operand);
+        case 0x5: return get_data_processing_handler<0x5>(set_flags, operand);
+        case 0x6: return get_data_processing_handler<0x6>(set_flags, operand);
+        case 0x7: return get_data_processing_handler<0x7>(set_flags, operand);
+        case 0x8: return get_data_processing_handler<0x8>(true, operand);
+        case 0x9: return get_data_processing_handler<0x9>(true, operand);
+        case 0xA: return get_data_processing_handler<0xA>(true, operand);
+        case 0xB: return get_data_processing_handler<0xB>(true, operand);
+        case 0xC: return get_data_processing_handler<0xC>(set_flags, operand);
+        case 0xD: return get_data_processing_handler<0xD>(set_flags, operand);
+        case 0xE: return get_data_processing_handler<0xE>(set_flags, operand);
+        default: return get_data_processing_handler<0xF>(set_flags, operand);
+    }
+}
+
+//LDR, LDRB, STR and STRB, in the order the interpreter does them. Loads into the PC never get here.
+template <ARM_CORE_TYPE core, bool load, bool byte, CACHED_INDEXING indexing, bool reg_offset>
+static void arm_load_store(ARM_CPU &cpu, const CachedArmInstr &instr)
+{
+    uint32_t offset = instr.imm;
+    if (reg_offset)
+    {
+        offset = shift_reg(cpu, instr);
+        if (instr.subtract)
+            offset = -offset;
+    }
+
+    uint32_t address = cpu.get_register(instr.rn);
+    if (indexing != INDEX_POST)
+        address += offset;
+
+    if (load)
+    {
+        uint32_t value;
+        if (byte)
+            value = cpu.read8(address);
+        else if (core == ARM_CORE_ARM9 && (address & 0x3))
+            value = cpu.rotr32(cpu.read32(address & ~0x3), (address & 0x3) * 8, false);
+        else
+            value = cpu.read32(address);
+
+        if (cpu.is_data_abort_pending())
+            return;
+
+        cpu.set_register(instr.rd, value);
+        if (indexing != INDEX_OFFSET && instr.rn != instr.rd)
+            cpu.set_register(instr.rn, (indexing == INDEX_POST) ? address + offset : address);
+    }
+    else
+    {
+        uint32_t value = cpu.get_register(instr.rd);
+        if (byte)
+            cpu.write8(address, value & 0xFF);
+        else
+        {
+            if (core == ARM_CORE_ARM9)
+                address &= ~0x3;
+            cpu.write32(address, value);
+        }
+
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
+
+        if (indexing != INDEX_OFFSET)
+            cpu.set_register(instr.rn, (indexing == INDEX_POST) ? address + offset : address);
+    }
+}
+
+template <ARM_CORE_TYPE core, bool load, bool byte, CACHED_INDEXING indexing>
+static CachedArmHandler get_load_store_handler(bool reg_offset)
+{
+    if (reg_offset)
+        return arm_load_store<core, load, byte, indexing, true>;
+    return arm_load_store<core, load, byte, indexing, false>;
+}
+
+template <ARM_CORE_TYPE core, bool load, bool byte>
+static CachedArmHandler get_load_store_handler(CACHED_INDEXING indexing, bool reg_offset)
+{
+    switch (indexing)
+    {
+        case INDEX_OFFSET:
+            return get_load_store_handler<core, load, byte, INDEX_OFFSET>(reg_offset);
+        case INDEX_PRE_WRITEBACK:
+            return get_load_store_handler<core, load, byte, INDEX_PRE_WRITEBACK>(reg_offset);
+        default:
+            return get_load_store_handler<core, load, byte, INDEX_POST>(reg_offset);
+    }
+}
+
+template <ARM_CORE_TYPE core>
+static CachedArmHandler get_load_store_handler(bool load, bool byte, CACHED_INDEXING indexing, bool reg_offset)
+{
+    if (load)
+    {
+        if (byte)
+            return get_load_store_handler<core, true, true>(indexing, reg_offset);
+        return get_load_store_handler<core, true, false>(indexing, reg_offset);
+    }
+    if (byte)
+        return get_load_store_handler<core, false, true>(indexing, reg_offset);
+    return get_load_store_handler<core, false, false>(indexing, reg_offset);
+}
+
+//Targets are aligned when the block is decoded. Setting the PC directly skips jp's lookup of the new code page,
+//which the block lookup does anyway.
+static void arm_b(ARM_CPU &cpu, const CachedArmInstr &instr)
+{
+    cpu.set_register(REG_PC, instr.imm + 4);
+}
+
+static void arm_bl(ARM_CPU &cpu, const CachedArmInstr &instr)
+{
+    cpu.set_register(REG_LR, cpu.get_PC() - 4);
+    cpu.set_register(REG_PC, instr.imm + 4);
+}
+
+template <int opcode>
+static void thumb_move_shift(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t value = cpu.get_register(instr.rm);
+    int shift = (instr.imm) ? instr.imm : 32;
+    switch (opcode)
+    {
+        case 0:
+            value = cpu.lsl(value, instr.imm, true);
+            break;
+        case 1:
+            value = cpu.lsr(value, shift, true);
+            break;
+        default:
+            value = cpu.asr(value, shift, true);
+            break;
+    }
+    cpu.set_register(instr.rd, value);
+}
+
+template <bool sub, bool reg>
+static void thumb_add_sub(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t a = cpu.get_register(instr.rn);
+    uint32_t b = (reg) ? cpu.get_register(instr.rm) : instr.imm;
+    uint32_t result = (sub) ? a - b : a + b;
+
+    cpu.set_register(instr.rd, result);
+    cpu.set_zero_neg_flags(result);
+    if (sub)
+        cpu.set_CV_sub_flags(a, b);
+    else
+        cpu.set_CV_add_flags(a, b);
+}
+
+static void thumb_mov(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.set_register(instr.rd, instr.imm);
+    cpu.set_zero_neg_flags(instr.imm);
+}
+
+static void thumb_cmp(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.cmp(cpu.get_register(instr.rd), instr.imm);
+}
+
+template <int opcode>
+static void thumb_alu(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t a = cpu.get_register(instr.rd);
+    uint32_t b = cpu.get_register(instr.rm);
+    uint32_t result;
+    switch (opcode)
+    {
+        case 0x0:
+            result = a & b;
+            break;
+        case 0x1:
+            result = a ^ b;
+            break;
+        case 0x2:
+            cpu.set_register(instr.rd, cpu.lsl(a, b, true));
+            return;
+        case 0x3:
+            cpu.set_register(instr.rd, cpu.lsr(a, b, true));
+            return;
+        case 0x4:
+            cpu.set_register(instr.rd, cpu.asr(a, b, true));
+            return;
+        case 0x5:
+            cpu.adc(instr.rd, a, b, true);
+            return;
+        case 0x6:
+            cpu.sbc(instr.rd, a, b, true);
+            return;
+        case 0x7:
+            cpu.set_register(instr.rd, cpu.rotr32(a, b, true));
+            return;
+        case 0x8:
+            cpu.set_zero_neg_flags(a & b);
+            return;
+        case 0x9:
+            result = 0 - b;
+            cpu.set_CV_sub_flags(0, b);
+            break;
+        case 0xA:
+            cpu.cmp(a, b);
+            return;
+        case 0xB:
+            cpu.cmn(a, b);
+            return;
+        case 0xC:
+            result = a | b;
+            break;
+        case 0xD:
+            result = a * b;
+            break;
+        case 0xE:
+            result = a & ~b;
+            break;
+        default:
+            result = ~b;
+            break;
+    }
+
+    cpu.set_register(instr.rd, result);
+    cpu.set_zero_neg_flags(result);
+}
+
+static const CachedThumbHandler thumb_alu_handlers[16] =
+{
+    thumb_alu<0x0>, thumb_alu<0x1>, thumb_alu<0x2>, thumb_alu<0x3>,
+    thumb_alu<0x4>, thumb_alu<0x5>, thumb_alu<0x6>, thumb_alu<0x7>,
+    thumb_alu<0x8>, thumb_alu<0x9>, thumb_alu<0xA>, thumb_alu<0xB>,
+    thumb_alu<0xC>, thumb_alu<0xD>, thumb_alu<0xE>, thumb_alu<0xF>
+};
+
+//High register ADD and MOV, which never set the flags. Writes to the PC are left to the interpreter.
+static void thumb_hi_add(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.set_register(instr.rd, cpu.get_register(instr.rd) + cpu.get_register(instr.rm));
+}
+
+static void thumb_hi_cmp(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.cmp(cpu.get_register(instr.rd), cpu.get_register(instr.rm));
+}
+
+static void thumb_hi_mov(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.set_register(instr.rd, cpu.get_register(instr.rm));
+}
+
+template <ARM_CORE_TYPE core, bool byte, bool reg_offset>
+static void thumb_load(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t address = cpu.get_register(instr.rn) + ((reg_offset) ? cpu.get_register(instr.rm) : instr.imm);
+    uint32_t value;
+    if (byte)
+        value = cpu.read8(address);
+    else if (core == ARM_CORE_ARM9)
+        value = cpu.rotr32(cpu.read32(address & ~0x3), (address & 0x3) * 8, false);
+    else
+        value = cpu.read32(address);
+
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(instr.rd, value);
+}
+
+template <ARM_CORE_TYPE core, bool byte, bool reg_offset>
+static void thumb_store(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t address = cpu.get_register(instr.rn) + ((reg_offset) ? cpu.get_register(instr.rm) : instr.imm);
+    if (byte)
+        cpu.write8(address, cpu.get_register(instr.rd) & 0xFF);
+    else
+        cpu.write32(address, cpu.get_register(instr.rd));
+    cpu.clear_global_exclusives<core>(address);
+}
+
+static void thumb_load_halfword(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint16_t value = cpu.read16(cpu.get_register(instr.rn) + instr.imm);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(instr.rd, value);
+}
+
+template <ARM_CORE_TYPE core>
+static void thumb_store_halfword(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t address = cpu.get_register(instr.rn) + instr.imm;
+    cpu.write16(address, cpu.get_register(instr.rd) & 0xFFFF);
+    cpu.clear_global_exclusives<core>(address);
+}
+
+//SP- and PC-relative loads never rotate unaligned words, even on the ARM9
+static void thumb_sp_rel_load(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t value = cpu.read32(cpu.get_register(instr.rn) + instr.imm);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(instr.rd, value);
+}
+
+//The address is resolved when the block is decoded
+static void thumb_pc_rel_load(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t value = cpu.read32(instr.imm);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(instr.rd, value);
+}
+
+//ADD Rd, SP, #imm and ADD Rd, PC, #imm, the latter with the aligned PC already added in
+static void thumb_load_sp_addr(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.set_register(instr.rd, cpu.get_register(REG_SP) + instr.imm);
+}
+
+static void thumb_load_pc_addr(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.set_register(instr.rd, instr.imm);
+}
+
+static void thumb_offset_sp(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.set_register(REG_SP, cpu.get_register(REG_SP) + instr.imm);
+}
+
+static void thumb_branch(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.set_register(REG_PC, instr.imm + 2);
+}
+
+static void thumb_cond_branch(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    if (cpu.meets_condition(instr.cond))
+        cpu.set_register(REG_PC, instr.imm + 2);
+}
+
+static void thumb_long_branch_prep(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    cpu.set_register(REG_LR, instr.imm);
+}
+
+static void thumb_long_branch(ARM_CPU &cpu, const CachedThumbInstr &instr)
+{
+    uint32_t address = cpu.get_register(REG_LR) + instr.imm;
+    cpu.set_register(REG_LR, (cpu.get_PC() - 2) | 0x1);
+    cpu.set_register(REG_PC, (address & ~0x1) + 2);
+}
+
+ARM_CachedInterpreter::ARM_CachedInterpreter()
+{
+    lookup = new CachedLookupEntry[LOOKUP_SIZE * LOOKUP_TABLES];
+    flush_all_lookups();
+}
+
+ARM_CachedInterpreter::~ARM_CachedInterpreter()
+{
+    reset();
+    delete[] lookup;
+}
+
+void ARM_CachedInterpreter::reset()
+{
+    for (auto& it : blocks)
+        delete it.second;
+    blocks.clear();
+    free_retired_blocks();
+
+    clear_code_pages();
+    flush_all_lookups();
+}
+
+void ARM_CachedInterpreter::flush_lookup(ARM_CPU &cpu)
+{
+    memset(&lookup[get_lookup_index(cpu) * LOOKUP_SIZE], 0, LOOKUP_SIZE * sizeof(CachedLookupEntry));
+}
+
+void ARM_CachedInterpreter::flush_all_lookups()
+{
+    memset(lookup, 0, LOOKUP_SIZE * LOOKUP_TABLES * sizeof(CachedLookupEntry));
+}
+
+void ARM_CachedInterpreter::invalidate_code_page(uint8_t *page)
+{
+    std::vector<uint64_t> keys;
+    if (!remove_code_page(page, keys))
+        return;
+
+    for (uint64_t key : keys)
+    {
+        auto it = blocks.find(key);
+        if (it != blocks.end())
+        {
+            unlink_block(it->second);
+            retired_blocks.push_back(it->second);
+            blocks.erase(it);
+        }
+    }
+}
+
+void ARM_CachedInterpreter::run(ARM_CPU &cpu, int cycles)
+{
+    CachedLookupEntry* table = &lookup[get_lookup_index(cpu) * LOOKUP_SIZE];
+
+    //Translation is done here instead of through the interpreter's prefetch
+    cpu.prefetch_abort_occurred = false;
+    while (!cpu.halted && cpu.cycles_ran < cycles)
+    {
+        if (retired_blocks.size())
+            free_retired_blocks();
+
+        bool thumb = cpu.CPSR.thumb;
+        uint32_t pc = cpu.gpr[15] - ((thumb) ? 2 : 4);
+        uint32_t tag = pc | thumb;
+
+        CachedLookupEntry& entry = table[(pc >> 1) & (LOOKUP_SIZE - 1)];
+        if (entry.tag != tag || !entry.block)
+        {
+            CachedBlock* block = get_block(cpu, pc, thumb);
+            if (!block)
+            {
+                //Prefetch abort, the CPU is now at the vector
+                cpu.cycles_ran++;
+                continue;
+            }
+            entry.tag = tag;
+            entry.block = block;
+        }
+
+        code_invalidated = false;
+        if (thumb)
+            run_thumb_block(cpu, entry.block);
+        else
+            run_arm_block(cpu, entry.block);
+    }
+}
+
+void ARM_CachedInterpreter::run_arm_block(ARM_CPU &cpu, CachedBlock *block)
+{
+    uint32_t pc = block->vaddr + 8;
+    for (const CachedArmInstr& instr : block->arm_instrs)
+    {
+        cpu.gpr[15] = pc;
+        if (instr.cond == 0xE || cpu.meets_condition(instr.cond))
+            instr.handler(cpu, instr);
+        cpu.cycles_ran++;
+
+        if (cpu.data_abort_pending)
+        {
+            cpu.take_data_abort();
+            return;
+        }
+
+        //Leave on a branch, a halt, or a write to a page holding code
+        if (cpu.gpr[15] != pc || cpu.halted || code_invalidated)
+            return;
+        pc += 4;
+    }
+}
+
+void ARM_CachedInterpreter::run_thumb_block(ARM_CPU &cpu, CachedBlock *block)
+{
+    uint32_t pc = block->vaddr + 4;
+    for (const CachedThumbInstr& instr : block->thumb_instrs)
+    {
+        cpu.gpr[15] = pc;
+        instr.handler(cpu, instr);
+        cpu.cycles_ran++;
+
+        if (cpu.data_abort_pending)
+        {
+            cpu.take_data_abort();
+            return;
+        }
+
+        if (cpu.gpr[15] != pc || cpu.halted || code_invalidated)
+            return;
+        pc += 2;
+    }
+}
+
+CachedBlock* ARM_CachedInterpreter::get_block(ARM_CPU &cpu, uint32_t pc, bool thumb)
+{
+    uint8_t* page = translate_pc(cpu, pc);
+    if (!page)
+        return nullptr;
+    uint64_t key = get_block_key(cpu, page, pc, thumb);
+
+    auto it = blocks.find(key);
+    if (it != blocks.end())
+    {
+        if (it->second->vaddr == pc)
+            return it->second;
+
+        //Same physical code reached through a different virtual address. PC-relative handlers depend on the vaddr,
+        //so the block has to be decoded again.
+        unlink_block(it->second);
+        retired_blocks.push_back(it->second);
+        blocks.erase(it);
+    }
+
+    CachedBlock* block = decode_block(cpu.get_core_type(), pc, page, thumb);
+    blocks[key] = block;
+    register_code_page(page, key);
+    return block;
+}
+
+CachedBlock* ARM_CachedInterpreter::decode_block(ARM_CORE_TYPE core, uint32_t pc, uint8_t *page, bool thumb)
+{
+    CachedBlock* block = new CachedBlock;
+    block->vaddr = pc;
+    block->thumb = thumb;
+
+    uint32_t addr = pc;
+    bool block_end = false;
+    for (int i = 0; i < MAX_BLOCK_INSTRS && !block_end; i++)
+    {
+        if (thumb)
+        {
+            uint16_t instr = *(uint16_t*)&page[addr & 0xFFF];
+            block->thumb_instrs.push_back(decode_thumb_instr(core, addr, instr));
+            block_end = is_thumb_block_end(instr);
+            addr += 2;
+        }
+        else
+        {
+            uint32_t instr = *(uint32_t*)&page[addr & 0xFFF];
+            block->arm_instrs.push_back(decode_arm_instr(core, addr, instr));
+            block_end = is_arm_block_end(instr);
+            addr += 4;
+        }
+
+        //Never let a block cross a page, as the next page may not be contiguous in host memory
+        if ((addr & 0xFFF) == 0)
+            break;
+    }
+    return block;
+}
+
+CachedArmInstr ARM_CachedInterpreter::decode_arm_instr(ARM_CORE_TYPE core, uint32_t addr, uint32_t instr)
+{
+    CachedArmInstr cached = {};
+    cached.handler = interpret_arm_instr;
+    cached.instr = instr;
+    cached.cond = instr >> 28;
+
+    //The unconditional space has special cases that depend on the core, so leave those to the interpreter
+    if (cached.cond == 0xF)
+    {
+        cached.interpret = (core == ARM_CORE_ARM9) ? ARM_Interpreter::interpret_arm<ARM_CORE_ARM9>
+                                                   : ARM_Interpreter::interpret_arm<ARM_CORE_ARM11>;
+        cached.cond = 0xE;
+        return cached;
+    }
+    cached.interpret = ARM_Interpreter::get_arm_handler(core, instr);
+
+    cached.rd = (instr >> 12) & 0xF;
+    cached.rn = (instr >> 16) & 0xF;
+    cached.rm = instr & 0xF;
+    cached.shift_type = (instr >> 5) & 0x3;
+    cached.shift = (instr >> 7) & 0x1F;
+
+    switch (decode_arm(instr))
+    {
+        case ARM_DATA_PROCESSING:
+        {
+            int opcode = (instr >> 21) & 0xF;
+            bool set_flags = instr & (1 << 20);
+            bool is_test = opcode >= 0x8 && opcode <= 0xB;
+
+            //MRS/MSR, and writes to the PC
+            if (is_test && !set_flags)
+                break;
+            if (!is_test && cached.rd == REG_PC)
+                break;
+
+            CACHED_OPERAND operand;
+            if (instr & (1 << 25))
+            {
+                cached.shift = (instr >> 7) & 0x1E;
+                cached.imm = instr & 0xFF;
+                if (cached.shift)
+                    cached.imm = (cached.imm >> cached.shift) | (cached.imm << (32 - cached.shift));
+                operand = OPERAND_IMM;
+            }
+            else if (instr & (1 << 4))
+                break; //Shifts by a register stay on the interpreter
+            else if (cached.shift_type == 0 && cached.shift == 0)
+                operand = OPERAND_REG;
+            else
+                operand = OPERAND_SHIFTED_REG;
+
+            cached.handler = get_data_processing_handler(opcode, set_flags, operand);
+            break;
+        }
+        case ARM_B:
+        case ARM_BL:
+        {
+            int32_t offset = (instr & 0xFFFFFF) << 8;
+            cached.imm = addr + 8 + (offset >> 6);
+            cached.handler = (instr & (1 << 24)) ? arm_bl : arm_b;
+            break;
+        }
+        case ARM_LOAD_WORD:
+        case ARM_STORE_WORD:
+        case ARM_LOAD_BYTE:
+        case ARM_STORE_BYTE:
+        {
+            bool load = instr & (1 << 20);
+            bool byte = instr & (1 << 22);
+            bool reg_offset = instr & (1 << 25);
+
+            CACHED_INDEXING indexing;
+            if (!(instr & (1 << 24)))
+                indexing = INDEX_POST;
+            else if (instr & (1 << 21))
+                indexing = INDEX_PRE_WRITEBACK;
+            else
+                indexing = INDEX_OFFSET;
+
+            if (load && cached.rd == REG_PC)
+                break;
+            if (indexing != INDEX_OFFSET && cached.rn == REG_PC)
+                break;
+
+            cached.subtract = !(instr & (1 << 23));
+            if (!reg_offset)
+            {
+                cached.imm = instr & 0xFFF;
+                if (cached.subtract)
+                    cached.imm = -cached.imm;
+            }
+
+            if (core == ARM_CORE_ARM9)
+                cached.handler = get_load_store_handler<ARM_CORE_ARM9>(load, byte, indexing, reg_offset);
+            else
+                cached.handler = get_load_store_handler<ARM_CORE_ARM11>(load, byte, indexing, reg_offset);
+            break;
+        }
+        default:
+            break;
+    }
+    return cached;
+}
+
+template <ARM_CORE_TYPE core>
+static void decode_thumb_load_store(CachedThumbInstr &cached, bool load, bool byte, bool reg_offset)
+{
+    if (load)
+    {
+        if (byte)
+            cached.handler = (reg_offset) ? thumb_load<core, true, true> : thumb_load<core, true, false>;
+        else
+            cached.handler = (reg_offset) ? thumb_load<core, false, true> : thumb_load<core, false, false>;
+    }
+    else
+    {
+        if (byte)
+            cached.handler = (reg_offset) ? thumb_store<core, true, true> : thumb_store<core, true, false>;
+        else
+            cached.handler = (reg_offset) ? thumb_store<core, false, true> : thumb_store<core, false, false>;
+    }
+}
+
+CachedThumbInstr ARM_CachedInterpreter::decode_thumb_instr(ARM_CORE_TYPE core, uint32_t addr, uint16_t instr)
+{
+    CachedThumbInstr cached = {};
+    cached.handler = interpret_thumb_instr;
+    cached.interpret = ARM_Interpreter::get_thumb_handler(core, instr);
+    cached.instr = instr;
+
+    //Most formats keep Rd in bits 0-2 and Rn in bits 3-5
+    cached.rd = instr & 0x7;
+    cached.rn = (instr >> 3) & 0x7;
+    cached.rm = (instr >> 6) & 0x7;
+
+    uint32_t pc = addr + 4;
+    THUMB_INSTR type = decode_thumb(instr);
+    switch (type)
+    {
+        case THUMB_MOV_SHIFT:
+            cached.rm = cached.rn;
+            cached.imm = (instr >> 6) & 0x1F;
+            switch ((instr >> 11) & 0x3)
+            {
+                case 0:
+                    cached.handler = thumb_move_shift<0>;
+                    break;
+                case 1:
+                    cached.handler = thumb_move_shift<1>;
+                    break;
+                case 2:
+                    cached.handler = thumb_move_shift<2>;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case THUMB_ADD_REG:
+        case THUMB_SUB_REG:
+        {
+            bool sub = type == THUMB_SUB_REG;
+            if (instr & (1 << 10))
+            {
+                cached.imm = cached.rm;
+                cached.handler = (sub) ? thumb_add_sub<true, false> : thumb_add_sub<false, false>;
+            }
+            else
+                cached.handler = (sub) ? thumb_add_sub<true, true> : thumb_add_sub<false, true>;
+            break;
+        }
+        case THUMB_MOV_IMM:
+        case THUMB_CMP_IMM:
+        case THUMB_ADD_IMM:
+        case THUMB_SUB_IMM:
+            cached.rd = (instr >> 8) & 0x7;
+            cached.rn = cached.rd;
+            cached.imm = instr & 0xFF;
+            if (type == THUMB_MOV_IMM)
+                cached.handler = thumb_mov;
+            else if (type == THUMB_CMP_IMM)
+                cached.handler = thumb_cmp;
+            else if (type == THUMB_ADD_IMM)
+                cached.handler = thumb_add_sub<false, false>;
+            else
+                cached.handler = thumb_add_sub<true, false>;
+            break;
+        case THUMB_ALU_OP:
+            cached.rm = cached.rn;
+            cached.handler = thumb_alu_handlers[(instr >> 6) & 0xF];
+            break;
+        case THUMB_HI_REG_OP:
+        {
+            int opcode = (instr >> 8) & 0x3;
+            cached.rd |= (instr >> 4) & 0x8;
+            cached.rm = (instr >> 3) & 0xF;
+            if (opcode == 0x0 && cached.rd != REG_PC)
+                cached.handler = thumb_hi_add;
+            else if (opcode == 0x1)
+                cached.handler = thumb_hi_cmp;
+            else if (opcode == 0x2 && cached.rd != REG_PC)
+                cached.handler = thumb_hi_mov;
+            break;
+        }
+        case THUMB_PC_REL_LOAD:
+            cached.rd = (instr >> 8) & 0x7;
+            cached.imm = (pc + ((instr & 0xFF) << 2)) & ~0x3;
+            cached.handler = thumb_pc_rel_load;
+            break;
+        case THUMB_LOAD_REG_OFFSET:
+        case THUMB_STORE_REG_OFFSET:
+        case THUMB_LOAD_IMM_OFFSET:
+        case THUMB_STORE_IMM_OFFSET:
+        {
+            bool load = type == THUMB_LOAD_REG_OFFSET || type == THUMB_LOAD_IMM_OFFSET;
+            bool reg_offset = type == THUMB_LOAD_REG_OFFSET || type == THUMB_STORE_REG_OFFSET;
+            bool byte = instr & (1 << ((reg_offset) ? 10 : 12));
+            if (!reg_offset)
+                cached.imm = ((instr >> 6) & 0x1F) << ((byte) ? 0 : 2);
+
+            if (core == ARM_CORE_ARM9)
+                decode_thumb_load_store<ARM_CORE_ARM9>(cached, load, byte, reg_offset);
+            else
+                decode_thumb_load_store<ARM_CORE_ARM11>(cached, load, byte, reg_offset);
+            break;
+        }
+        case THUMB_LOAD_HALFWORD:
+        case THUMB_STORE_HALFWORD:
+            cached.imm = ((instr >> 6) & 0x1F) << 1;
+            if (type == THUMB_LOAD_HALFWORD)
+                cached.handler = thumb_load_halfword;
+            else if (core == ARM_CORE_ARM9)
+                cached.handler = thumb_store_halfword<ARM_CORE_ARM9>;
+            else
+                cached.handler = thumb_store_halfword<ARM_CORE_ARM11>;
+            break;
+        case THUMB_SP_REL_LOAD:
+        case THUMB_SP_REL_STORE:
+            cached.rd = (instr >> 8) & 0x7;
+            cached.rn = REG_SP;
+            cached.imm = (instr & 0xFF) << 2;
+            if (type == THUMB_SP_REL_LOAD)
+                cached.handler = thumb_sp_rel_load;
+            else if (core == ARM_CORE_ARM9)
+                cached.handler = thumb_store<ARM_CORE_ARM9, false, false>;
+            else
+                cached.handler = thumb_store<ARM_CORE_ARM11, false, false>;
+            break;
+        case THUMB_LOAD_ADDRESS:
+            cached.rd = (instr >> 8) & 0x7;
+            cached.imm = (instr & 0xFF) << 2;
+            if (instr & (1 << 11))
+                cached.handler = thumb_load_sp_addr;
+            else
+            {
+                cached.imm += pc & ~0x2;
+                cached.handler = thumb_load_pc_addr;
+            }
+            break;
+        case THUMB_OFFSET_SP:
+            cached.imm = (instr & 0x7F) << 2;
+            if (instr & (1 << 7))
+                cached.imm = -cached.imm;
+            cached.handler = thumb_offset_sp;
+            break;
+        case THUMB_BRANCH:
+        {
+            int32_t offset = (instr & 0x7FF) << 21;
+            cached.imm = pc + (offset >> 20);
+            cached.handler = thumb_branch;
+            break;
+        }
+        case THUMB_COND_BRANCH:
+            cached.cond = (instr >> 8) & 0xF;
+            if (cached.cond == 0xF)
+                break; //SWI
+            cached.imm = pc + (static_cast<int32_t>(instr << 24) >> 23);
+            cached.handler = thumb_cond_branch;
+            break;
+        case THUMB_LONG_BRANCH_PREP:
+        {
+            int32_t offset = (instr & 0x7FF) << 21;
+            cached.imm = pc + (offset >> 9);
+            cached.handler = thumb_long_branch_prep;
+            break;
+        }
+        case THUMB_LONG_BRANCH:
+            cached.imm = (instr & 0x7FF) << 1;
+            cached.handler = thumb_long_branch;
+            break;
+        default:
+            break;
+    }
+    return cached;
+}
+
+void ARM_CachedInterpreter::unlink_block(CachedBlock *block)
+{
+    uint32_t tag = block->vaddr | block->thumb;
+    for (int i = 0; i < LOOKUP_TABLES; i++)
+    {
+        CachedLookupEntry& entry = lookup[(i * LOOKUP_SIZE) + ((block->vaddr >> 1) & (LOOKUP_SIZE - 1))];
+        if (entry.tag == tag && entry.block == block)
+            entry.block = nullptr;
+    }
+}
+
+void ARM_CachedInterpreter::free_retired_blocks()
+{
+    for (CachedBlock* block : retired_blocks)
+        delete block;
+    retired_blocks.clear();
+}
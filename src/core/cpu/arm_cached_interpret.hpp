@@ -0,0 +1,96 @@
+#ifndef ARM_CACHED_INTERPRET_HPP
+#define ARM_CACHED_INTERPRET_HPP
+#include <unordered_map>
+#include <vector>
+#include "arm_code_cache.hpp"
+#include "arm_interpret.hpp"
+
+struct CachedArmInstr;
+struct CachedThumbInstr;
+
+typedef void (*CachedArmHandler)(ARM_CPU& cpu, const CachedArmInstr& instr);
+typedef void (*CachedThumbHandler)(ARM_CPU& cpu, const CachedThumbInstr& instr);
+
+//Operands are extracted when the block is decoded, and PC-relative targets are resolved against its vaddr.
+//Instructions without a handler of their own go through interpret, which gets the raw opcode.
+struct CachedArmInstr
+{
+    CachedArmHandler handler;
+    ARM_Interpreter::ARM_Handler interpret;
+    uint32_t instr;
+
+    //Rotated immediate, load/store offset (negated when subtracted), or branch target
+    uint32_t imm;
+    uint8_t cond;
+    uint8_t rd, rn, rm;
+
+    //Immediate shift of rm. LSR and ASR by 32 are kept as 0, as in the opcode, and ROR by 0 is RRX.
+    //Data processing immediates keep their rotation here, as it decides whether the carry is set.
+    uint8_t shift_type, shift;
+    bool subtract;
+};
+
+struct CachedThumbInstr
+{
+    CachedThumbHandler handler;
+    ARM_Interpreter::THUMB_Handler interpret;
+    uint32_t imm;
+    uint16_t instr;
+    uint8_t cond;
+    uint8_t rd, rn, rm;
+};
+
+struct CachedBlock
+{
+    uint32_t vaddr;
+    bool thumb;
+    std::vector<CachedArmInstr> arm_instrs;
+    std::vector<CachedThumbInstr> thumb_instrs;
+};
+
+struct CachedLookupEntry
+{
+    //Virtual address of the block, with bit 0 set for Thumb blocks
+    uint32_t tag;
+    CachedBlock* block;
+};
+
+/***
+ * Interpreter that decodes each guest basic block once into an array of records, then runs straight from that array.
+ * Data processing, single loads and stores, and branches get handlers specialized on their opcode and addressing
+ * mode, which take the register numbers and immediates from the record. They follow ARM_Interpreter's handlers step
+ * for step, flags and data aborts included. Everything else, and the forms that write the PC through the ALU or a
+ * load, is handed to ARM_Interpreter's handler for the instruction.
+***/
+class ARM_CachedInterpreter : public ARM_CodeCache
+{
+    private:
+        std::unordered_map<uint64_t, CachedBlock*> blocks;
+        CachedLookupEntry* lookup;
+
+        //Blocks invalidated while one of them may still be running, freed on the next dispatch
+        std::vector<CachedBlock*> retired_blocks;
+
+        CachedBlock* get_block(ARM_CPU& cpu, uint32_t pc, bool thumb);
+        CachedBlock* decode_block(ARM_CORE_TYPE core, uint32_t pc, uint8_t* page, bool thumb);
+        CachedArmInstr decode_arm_instr(ARM_CORE_TYPE core, uint32_t addr, uint32_t instr);
+        CachedThumbInstr decode_thumb_instr(ARM_CORE_TYPE core, uint32_t addr, uint16_t instr);
+        void unlink_block(CachedBlock* block);
+        void free_retired_blocks();
+
+        void run_arm_block(ARM_CPU& cpu, CachedBlock* block);
+        void run_thumb_block(ARM_CPU& cpu, CachedBlock* block);
+    public:
+        ARM_CachedInterpreter();
+        ~ARM_CachedInterpreter();
+
+        void reset();
+        void run(ARM_CPU& cpu, int cycles);
+
+        void flush_lookup(ARM_CPU& cpu);
+        void flush_all_lookups();
+
+        void invalidate_code_page(uint8_t* page);
+};
+
+#endif // ARM_CACHED_INTERPRET_HPP
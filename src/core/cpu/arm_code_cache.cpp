@@ -0,0 +1,138 @@
+#include <cstring>
+#include "arm.hpp"
+#include "arm_code_cache.hpp"
+#include "arm_disasm.hpp"
+#include "../common/common.hpp"
+
+ARM_CodeCache::ARM_CodeCache()
+{
+    code_page_filter = new uint16_t[CODE_PAGE_FILTER_SIZE];
+    clear_code_pages();
+}
+
+ARM_CodeCache::~ARM_CodeCache()
+{
+    delete[] code_page_filter;
+}
+
+int ARM_CodeCache::get_lookup_index(ARM_CPU &cpu)
+{
+    //One table for each ARM11 core, followed by the ARM9
+    if (cpu.id == 9)
+        return 4;
+    return cpu.id - 11;
+}
+
+uint64_t ARM_CodeCache::get_block_key(ARM_CPU &cpu, uint8_t *page, uint32_t pc, bool thumb)
+{
+    //Both cores can run from the same memory but decode it differently, so the core type is part of the key.
+    //Bit 0 stays the Thumb bit.
+    uint64_t arm11 = cpu.get_core_type() == ARM_CORE_ARM11;
+    return ((uint64_t)&page[pc & 0xFFF] << 2ULL) | (arm11 << 1ULL) | thumb;
+}
+
+uint8_t* ARM_CodeCache::translate_pc(ARM_CPU &cpu, uint32_t pc)
+{
+    uint64_t mem = (uint64_t)cpu.tlb_map->get(pc / 4096);
+    if (!(mem & (1ULL << 60ULL)))
+    {
+        cpu.cp15->reload_tlb(pc);
+        mem = (uint64_t)cpu.tlb_map->get(pc / 4096);
+        if (!(mem & (1ULL << 60ULL)))
+        {
+            cpu.prefetch_abort(pc);
+            return nullptr;
+        }
+    }
+    if (mem & (1ULL << 63ULL))
+        EmuException::die("[ARM%d] PC points to MMIO $%08X", cpu.id, pc);
+    mem &= ~(0xFULL << 60ULL);
+    return (uint8_t*)mem;
+}
+
+void ARM_CodeCache::register_code_page(uint8_t *page, uint64_t key)
+{
+    std::vector<uint64_t>& keys = code_pages[(uint64_t)page];
+    if (keys.empty())
+        code_page_filter[((uint64_t)page >> 12) & (CODE_PAGE_FILTER_SIZE - 1)]++;
+    keys.push_back(key);
+}
+
+bool ARM_CodeCache::remove_code_page(uint8_t *page, std::vector<uint64_t> &keys)
+{
+    auto it = code_pages.find((uint64_t)page);
+
+    //The filter can give false positives when two pages alias
+    if (it == code_pages.end())
+        return false;
+
+    keys.swap(it->second);
+    code_pages.erase(it);
+    code_page_filter[((uint64_t)page >> 12) & (CODE_PAGE_FILTER_SIZE - 1)]--;
+    code_invalidated = true;
+    return true;
+}
+
+void ARM_CodeCache::clear_code_pages()
+{
+    code_pages.clear();
+    memset(code_page_filter, 0, CODE_PAGE_FILTER_SIZE * sizeof(uint16_t));
+    code_invalidated = false;
+}
+
+bool ARM_CodeCache::is_arm_block_end(uint32_t instr)
+{
+    //Unconditional space (BLX imm, CPS, SRS, RFE) can all change control flow or state
+    if ((instr >> 28) == 0xF)
+        return true;
+
+    switch (decode_arm(instr))
+    {
+        case ARM_UNDEFINED:
+        case ARM_B:
+        case ARM_BL:
+        case ARM_BX:
+        case ARM_BLX:
+        case ARM_SWI:
+        case ARM_BKPT:
+        case ARM_WFE:
+        case ARM_WFI:
+        case ARM_RFE:
+            return true;
+        case ARM_COP_REG_TRANSFER:
+        {
+            //CP15 writes can change the address space and VFP transfers can't
+            int coprocessor_id = (instr >> 8) & 0xF;
+            return coprocessor_id != 10 && coprocessor_id != 11;
+        }
+        case ARM_LOAD_BLOCK:
+            return instr & (1 << 15);
+        default:
+            return ((instr >> 12) & 0xF) == REG_PC;
+    }
+}
+
+bool ARM_CodeCache::is_thumb_block_end(uint16_t instr)
+{
+    switch (decode_thumb(instr))
+    {
+        case THUMB_UNDEFINED:
+        case THUMB_BRANCH:
+        case THUMB_COND_BRANCH:
+        case THUMB_LONG_BRANCH:
+        case THUMB_LONG_BLX:
+        case THUMB_SWI:
+            return true;
+        case THUMB_POP:
+            return instr & (1 << 8);
+        case THUMB_HI_REG_OP:
+        {
+            //BX/BLX, or anything writing to PC
+            int opcode = (instr >> 8) & 0x3;
+            int destination = (instr & 0x7) | ((instr >> 4) & 0x8);
+            return opcode == 0x3 || (opcode != 0x1 && destination == REG_PC);
+        }
+        default:
+            return false;
+    }
+}
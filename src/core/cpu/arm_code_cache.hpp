@@ -0,0 +1,65 @@
+#ifndef ARM_CODE_CACHE_HPP
+#define ARM_CODE_CACHE_HPP
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class ARM_CPU;
+
+/***
+ * Common base for the CPU backends that translate guest code a block at a time (the JIT and the cached interpreter).
+ * One instance is shared by every ARM core in the system, so a block translated by one core can be reused by another.
+ *
+ * Blocks are keyed by the host pointer of their first instruction, making the cache physically indexed.
+ * Each backend also keeps a small virtually indexed lookup table per core in front of it; that table depends on the
+ * current address translation and is flushed on any CP15 write (TLB maintenance, ASID or page table changes).
+ *
+ * The base class tracks which guest pages have had code translated from them, so that a write to such a page
+ * (self-modifying code, loaders, DMA) drops every block built from it.
+***/
+class ARM_CodeCache
+{
+    protected:
+        constexpr static int MAX_BLOCK_INSTRS = 32;
+        constexpr static int LOOKUP_SIZE = 4096;
+        constexpr static int LOOKUP_TABLES = 5;
+        constexpr static int CODE_PAGE_FILTER_SIZE = 1024 * 1024;
+
+        //Maps the host pointer of a guest page to all blocks built from it.
+        //The filter is a cheap, possibly aliased count so that guest writes to non-code pages can skip the map.
+        std::unordered_map<uint64_t, std::vector<uint64_t>> code_pages;
+        uint16_t* code_page_filter;
+
+        //Set when a page is invalidated, so a block can stop if it may have just overwritten itself
+        bool code_invalidated;
+
+        static int get_lookup_index(ARM_CPU& cpu);
+        static uint64_t get_block_key(ARM_CPU& cpu, uint8_t* page, uint32_t pc, bool thumb);
+        static bool is_arm_block_end(uint32_t instr);
+        static bool is_thumb_block_end(uint16_t instr);
+
+        uint8_t* translate_pc(ARM_CPU& cpu, uint32_t pc);
+        void register_code_page(uint8_t* page, uint64_t key);
+        bool remove_code_page(uint8_t* page, std::vector<uint64_t>& keys);
+        void clear_code_pages();
+    public:
+        ARM_CodeCache();
+        virtual ~ARM_CodeCache();
+
+        virtual void reset() = 0;
+        virtual void run(ARM_CPU& cpu, int cycles) = 0;
+
+        virtual void flush_lookup(ARM_CPU& cpu) = 0;
+        virtual void flush_all_lookups() = 0;
+
+        virtual void invalidate_code_page(uint8_t* page) = 0;
+        void check_code_write(uint8_t* page);
+};
+
+inline void ARM_CodeCache::check_code_write(uint8_t* page)
+{
+    if (code_page_filter[((uint64_t)page >> 12) & (CODE_PAGE_FILTER_SIZE - 1)])
+        invalidate_code_page(page);
+}
+
+#endif // ARM_CODE_CACHE_HPP
@@ -0,0 +1,303 @@
+#ifndef ARM_DECODE_HPP
+#define ARM_DECODE_HPP
+#include <cstdint>
+#include "arm_disasm.hpp"
+
+/***
+ * Compile-time tables behind decode_arm and decode_thumb.
+ *
+ * ARM instructions are described by an ordered list of mask/value rules, where the first match wins.
+ * The table is indexed by bits 27-20 and 7-4, which is enough to tell nearly every instruction apart.
+ * For the few keys where a rule also looks at other bits (BX, CLZ, NOP hints, exclusives, some media instructions),
+ * the entry instead holds the index of the first rule that could match, and only those rules are scanned.
+ * The table is only valid for cond != 0xF; the unconditional space always scans the full list.
+ *
+ * Thumb instructions are fully decoded by their top 10 bits, so that table needs no fallback.
+***/
+
+struct ARM_DecodeRule
+{
+    uint32_t mask;
+    uint32_t value;
+    ARM_INSTR instr;
+};
+
+constexpr ARM_DecodeRule arm_decode_rules[] =
+{
+    {0xFE5D0F00, 0xF84D0500, ARM_SRS},
+    {0xFE500F00, 0xF8100A00, ARM_RFE},
+    {0xFFFFFFFF, 0xF57FF01F, ARM_CLREX},
+    {0x0F000000, 0x0A000000, ARM_B},
+    {0x0F000000, 0x0B000000, ARM_BL},
+    {0x0FFFFFFF, 0x0320F000, ARM_NOP},
+    {0x0FFFFFFF, 0x0320F001, ARM_YIELD},
+    {0x0FFFFFFF, 0x0320F002, ARM_WFE},
+    {0x0FFFFFFF, 0x0320F003, ARM_WFI},
+    {0x0FFFFFFF, 0x0320F004, ARM_SEV},
+    {0x0FFFFFF0, 0x012FFF10, ARM_BX},
+    {0x0FFFFFF0, 0x012FFF30, ARM_BLX},
+    {0x0F000000, 0x0F000000, ARM_SWI},
+    {0x0FFF0FF0, 0x016F0F10, ARM_CLZ},
+    {0x0F900FF0, 0x01000050, ARM_SATURATED_OP},
+    {0xFFF000F0, 0xE1200070, ARM_BKPT},
+
+    //Media instructions
+    {0x0FFF00F0, 0x06AF0070, ARM_SXTB},
+    {0x0FF000F0, 0x06A00070, ARM_SXTAB},
+    {0x0FFF00F0, 0x06BF0070, ARM_SXTH},
+    {0x0FF000F0, 0x06B00070, ARM_SXTAH},
+    {0x0FFF00F0, 0x06EF0070, ARM_UXTB},
+    {0x0FF000F0, 0x06E00070, ARM_UXTAB},
+    {0x0FFF00F0, 0x06FF0070, ARM_UXTH},
+    {0x0FF000F0, 0x06F00070, ARM_UXTAH},
+    {0x0FFF0FF0, 0x06BF0F30, ARM_REV},
+    {0x0FFF0FF0, 0x06BF0FB0, ARM_REV16},
+    {0x0FF00070, 0x06800010, ARM_PKHBT},
+    {0x0FF00070, 0x06800050, ARM_PKHTB},
+    {0x0FE00030, 0x06E00010, ARM_USAT},
+    {0x0FE00030, 0x06A00010, ARM_SSAT},
+    {0x0FF00FF0, 0x06800FB0, ARM_SEL},
+    {0x0FF00FF0, 0x06500F90, ARM_UADD8},
+    {0x0FF00FF0, 0x06700F90, ARM_UHADD8},
+    {0x0FF00FF0, 0x06500FF0, ARM_USUB8},
+    {0x0FF00FF0, 0x06200FF0, ARM_QSUB8},
+    {0x0FF00FF0, 0x06600F90, ARM_UQADD8},
+    {0x0FF00FF0, 0x06600FF0, ARM_UQSUB8},
+    {0x0E000010, 0x06000010, ARM_UNDEFINED},
+
+    {0xFD70F000, 0xF550F000, ARM_PLD},
+
+    {0x0FF00FFF, 0x01D00F9F, ARM_LOAD_EX_BYTE},
+    {0x0FF00FF0, 0x01C00F90, ARM_STORE_EX_BYTE},
+    {0x0FF00FFF, 0x01F00F9F, ARM_LOAD_EX_HALFWORD},
+    {0x0FF00FF0, 0x01E00F90, ARM_STORE_EX_HALFWORD},
+    {0x0FF00FFF, 0x01900F9F, ARM_LOAD_EX_WORD},
+    {0x0FF00FF0, 0x01800F90, ARM_STORE_EX_WORD},
+    {0x0FF00FFF, 0x01B00F9F, ARM_LOAD_EX_DOUBLEWORD},
+    {0x0FF00FF0, 0x01A00F90, ARM_STORE_EX_DOUBLEWORD},
+
+    //Multiplies and extra load/stores
+    {0x0FB00FF0, 0x01000090, ARM_SWAP},
+    {0x0F900090, 0x01000080, ARM_SIGNED_HALFWORD_MULTIPLY},
+    {0x0FC000F0, 0x00000090, ARM_MULTIPLY},
+    {0x0F8000F0, 0x00800090, ARM_MULTIPLY_LONG},
+    {0x0E0000F0, 0x00000090, ARM_UNDEFINED},
+    {0x0E1000F0, 0x001000B0, ARM_LOAD_HALFWORD},
+    {0x0E1000F0, 0x000000B0, ARM_STORE_HALFWORD},
+    {0x0E1000F0, 0x001000D0, ARM_LOAD_SIGNED_BYTE},
+    {0x0E1000F0, 0x000000D0, ARM_LOAD_DOUBLEWORD},
+    {0x0E1000F0, 0x001000F0, ARM_LOAD_SIGNED_HALFWORD},
+    {0x0E1000F0, 0x000000F0, ARM_STORE_DOUBLEWORD},
+
+    {0x0E000000, 0x02000000, ARM_DATA_PROCESSING},
+    {0x0E000010, 0x00000000, ARM_DATA_PROCESSING},
+    {0x0E000090, 0x00000010, ARM_DATA_PROCESSING},
+    {0x0C000000, 0x00000000, ARM_UNDEFINED},
+
+    {0x0C500000, 0x04000000, ARM_STORE_WORD},
+    {0x0C500000, 0x04400000, ARM_STORE_BYTE},
+    {0x0C500000, 0x04100000, ARM_LOAD_WORD},
+    {0x0C500000, 0x04500000, ARM_LOAD_BYTE},
+    {0x0E100000, 0x08000000, ARM_STORE_BLOCK},
+    {0x0E100000, 0x08100000, ARM_LOAD_BLOCK},
+    {0x0E000000, 0x0C000000, ARM_COP_LOAD_STORE},
+    {0x0F000010, 0x0E000010, ARM_COP_REG_TRANSFER},
+    {0x0F000010, 0x0E000000, ARM_COP_DATA_OP},
+
+    {0x00000000, 0x00000000, ARM_UNDEFINED}
+};
+
+constexpr int ARM_DECODE_RULE_COUNT = sizeof(arm_decode_rules) / sizeof(ARM_DecodeRule);
+
+//Bits 27-20 and 7-4
+constexpr uint32_t ARM_DECODE_KEY_BITS = 0x0FF000F0;
+constexpr int ARM_DECODE_TABLE_SIZE = 4096;
+constexpr int THUMB_DECODE_TABLE_SIZE = 1024;
+
+//Set in an ARM table entry when the low bits are a rule index rather than an ARM_INSTR
+constexpr uint8_t ARM_DECODE_SCAN = 0x80;
+
+static_assert(ARM_DECODE_RULE_COUNT < ARM_DECODE_SCAN, "Too many ARM decode rules for the table encoding");
+static_assert(ARM_CLREX < ARM_DECODE_SCAN, "Too many ARM instruction types for the table encoding");
+
+struct ARM_DecodeTable
+{
+    uint8_t entries[ARM_DECODE_TABLE_SIZE];
+};
+
+struct THUMB_DecodeTable
+{
+    uint8_t entries[THUMB_DECODE_TABLE_SIZE];
+};
+
+constexpr int get_arm_decode_key(uint32_t instr)
+{
+    return ((instr >> 16) & 0xFF0) | ((instr >> 4) & 0xF);
+}
+
+constexpr ARM_INSTR scan_arm_decode_rules(uint32_t instr, int first_rule)
+{
+    for (int i = first_rule; i < ARM_DECODE_RULE_COUNT; i++)
+    {
+        if ((instr & arm_decode_rules[i].mask) == arm_decode_rules[i].value)
+            return arm_decode_rules[i].instr;
+    }
+    return ARM_UNDEFINED;
+}
+
+constexpr uint8_t make_arm_decode_entry(int key)
+{
+    uint32_t instr = ((key & 0xFF0) << 16) | ((key & 0xF) << 4);
+    for (int i = 0; i < ARM_DECODE_RULE_COUNT; i++)
+    {
+        uint32_t mask = arm_decode_rules[i].mask;
+        uint32_t value = arm_decode_rules[i].value;
+
+        //Rules for the unconditional space can never match an instruction looked up in the table
+        if ((mask >> 28) == 0xF && (value >> 28) == 0xF)
+            continue;
+
+        if ((instr & mask & ARM_DECODE_KEY_BITS) != (value & ARM_DECODE_KEY_BITS))
+            continue;
+
+        //If the rule looks at anything outside the key, whether it matches depends on the full instruction
+        if (mask & ~ARM_DECODE_KEY_BITS)
+            return ARM_DECODE_SCAN | i;
+        return arm_decode_rules[i].instr;
+    }
+    return ARM_UNDEFINED;
+}
+
+constexpr ARM_DecodeTable make_arm_decode_table()
+{
+    ARM_DecodeTable table = {};
+    for (int key = 0; key < ARM_DECODE_TABLE_SIZE; key++)
+        table.entries[key] = make_arm_decode_entry(key);
+    return table;
+}
+
+constexpr THUMB_INSTR decode_thumb_bits(uint16_t instr)
+{
+    if ((instr & 0xFF00) == 0xBA00)
+    {
+        switch ((instr >> 6) & 0x3)
+        {
+            case 0x00:
+                return THUMB_REV;
+            case 0x01:
+                return THUMB_REV16;
+            default:
+                return THUMB_UNDEFINED;
+        }
+    }
+    uint16_t instr13 = instr >> 13;
+    uint16_t instr12 = instr >> 12;
+    uint16_t instr11 = instr >> 11;
+    uint16_t instr10 = instr >> 10;
+    switch (instr11)
+    {
+        case 0x4:
+            return THUMB_MOV_IMM;
+        case 0x5:
+            return THUMB_CMP_IMM;
+        case 0x6:
+            return THUMB_ADD_IMM;
+        case 0x7:
+            return THUMB_SUB_IMM;
+        case 0x9:
+            return THUMB_PC_REL_LOAD;
+        case 0x10:
+            return THUMB_STORE_HALFWORD;
+        case 0x11:
+            return THUMB_LOAD_HALFWORD;
+        case 0x12:
+            return THUMB_SP_REL_STORE;
+        case 0x13:
+            return THUMB_SP_REL_LOAD;
+        case 0x18:
+            return THUMB_STORE_MULTIPLE;
+        case 0x19:
+            return THUMB_LOAD_MULTIPLE;
+        case 0x1C:
+            return THUMB_BRANCH;
+        case 0x1D:
+            return THUMB_LONG_BLX;
+    }
+    if (instr13 == 0)
+    {
+        if ((instr11 & 0x3) != 0x3)
+            return THUMB_MOV_SHIFT;
+        else
+        {
+            if ((instr & (1 << 9)) != 0)
+                return THUMB_SUB_REG;
+            return THUMB_ADD_REG;
+        }
+    }
+    if (instr10 == 0x10)
+        return THUMB_ALU_OP;
+    if (instr10 == 0x11)
+        return THUMB_HI_REG_OP;
+    if (instr12 == 0x5)
+    {
+        if ((instr & (1 << 9)) == 0)
+        {
+            if ((instr & (1 << 11)) == 0)
+                return THUMB_STORE_REG_OFFSET;
+            return THUMB_LOAD_REG_OFFSET;
+        }
+        return THUMB_LOAD_STORE_SIGN_HALFWORD;
+    }
+    if (instr13 == 0x3)
+    {
+        if ((instr & (1 << 11)) == 0)
+            return THUMB_STORE_IMM_OFFSET;
+        return THUMB_LOAD_IMM_OFFSET;
+    }
+    if (instr12 == 0xA)
+        return THUMB_LOAD_ADDRESS;
+    if (instr12 == 0xB)
+    {
+        if (((instr >> 9) & 0x3) == 0x2)
+        {
+            if ((instr & (1 << 11)) != 0)
+                return THUMB_POP;
+            return THUMB_PUSH;
+        }
+        if (instr & (1 << 9))
+        {
+            int op = (instr >> 6) & 0x3;
+            switch (op)
+            {
+                case 0:
+                    return THUMB_SXTH;
+                case 1:
+                    return THUMB_SXTB;
+                case 2:
+                    return THUMB_UXTH;
+                case 3:
+                    return THUMB_UXTB;
+            }
+        }
+        return THUMB_OFFSET_SP;
+    }
+    if (instr12 == 0xD)
+        return THUMB_COND_BRANCH;
+    if (instr12 == 0xF)
+    {
+        if ((instr & (1 << 11)) == 0)
+            return THUMB_LONG_BRANCH_PREP;
+        return THUMB_LONG_BRANCH;
+    }
+    return THUMB_UNDEFINED;
+}
+
+constexpr THUMB_DecodeTable make_thumb_decode_table()
+{
+    THUMB_DecodeTable table = {};
+    for (int i = 0; i < THUMB_DECODE_TABLE_SIZE; i++)
+        table.entries[i] = decode_thumb_bits(i << 6);
+    return table;
+}
+
+#endif // ARM_DECODE_HPP
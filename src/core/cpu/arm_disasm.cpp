@@ -1,269 +1,22 @@
 #include <sstream>
+#include "arm_decode.hpp"
 #include "arm_disasm.hpp"
 #include "arm.hpp"
 #include "../common/common.hpp"
 
 using namespace std;
 
+static constexpr ARM_DecodeTable arm_decode_table = make_arm_decode_table();
+
 ARM_INSTR decode_arm(uint32_t instr)
 {
-    if ((instr & 0xFE5D0F00) == 0xF84D0500)
-        return ARM_SRS;
-
-    if ((instr & 0xFE500F00) == 0xF8100A00)
-        return ARM_RFE;
-
-    if (instr == 0xF57FF01F)
-        return ARM_CLREX;
-
-    if ((instr & 0x0F000000) == 0x0A000000)
-        return ARM_B;
-
-    if ((instr & 0x0F000000) == 0x0B000000)
-        return ARM_BL;
-
-    if ((instr & 0x0FFFFFFF) == 0x0320F000)
-        return ARM_NOP;
-
-    if ((instr & 0x0FFFFFFF) == 0x0320F001)
-        return ARM_YIELD;
-
-    if ((instr & 0x0FFFFFFF) == 0x0320F002)
-        return ARM_WFE;
-
-    if ((instr & 0x0FFFFFFF) == 0x0320F003)
-        return ARM_WFI;
-
-    if ((instr & 0x0FFFFFFF) == 0x0320F004)
-        return ARM_SEV;
-
-    if (((instr >> 4) & 0x0FFFFFF) == 0x12FFF1)
-        return ARM_BX;
-
-    if (((instr >> 4) & 0x0FFFFFF) == 0x12FFF3)
-        return ARM_BLX;
+    if ((instr >> 28) == 0xF)
+        return scan_arm_decode_rules(instr, 0);
 
-    if ((instr & 0x0F000000) == 0x0F000000)
-        return ARM_SWI;
-
-    if (((instr >> 16) & 0xFFF) == 0x16F)
-    {
-        if (((instr >> 4) & 0xFF) == 0xF1)
-            return ARM_CLZ;
-    }
-
-    if (((instr >> 4) & 0xFF) == 0x05)
-    {
-        if (((instr >> 24) & 0xF) == 0x1)
-        {
-            int op = (instr >> 20) & 0xF;
-            if (op == 0 || op == 2 || op == 4 || op == 6)
-                return ARM_SATURATED_OP;
-        }
-    }
-
-    if ((instr & 0xFFF000F0) == 0xE1200070)
-        return ARM_BKPT;
-
-    if ((instr & 0x0E000010) == 0x06000010)
-    {
-        if ((instr & 0x0FF000F0) == 0x06A00070)
-        {
-            if ((instr & 0x0FFF00F0) == 0x06AF0070)
-                return ARM_SXTB;
-            return ARM_SXTAB;
-        }
-
-        if ((instr & 0x0FF000F0) == 0x06B00070)
-        {
-            if ((instr & 0x0FFF00F0) == 0x06BF0070)
-                return ARM_SXTH;
-            return ARM_SXTAH;
-        }
-
-        if ((instr & 0x0FF000F0) == 0x06E00070)
-        {
-            if ((instr & 0x0FFF00F0) == 0x06EF0070)
-                return ARM_UXTB;
-            return ARM_UXTAB;
-        }
-
-        if ((instr & 0x0FF000F0) == 0x06F00070)
-        {
-            if ((instr & 0x0FFF00F0) == 0x06FF0070)
-                return ARM_UXTH;
-            return ARM_UXTAH;
-        }
-
-        if ((instr & 0x0FFF0FF0) == 0x06BF0F30)
-            return ARM_REV;
-
-        if ((instr & 0x0FFF0FF0) == 0x06BF0FB0)
-            return ARM_REV16;
-
-        if ((instr & 0x0FF00070) == 0x06800010)
-            return ARM_PKHBT;
-
-        if ((instr & 0x0FF00070) == 0x06800050)
-            return ARM_PKHTB;
-
-        if ((instr & 0x0FE00030) == 0x06E00010)
-            return ARM_USAT;
-
-        if ((instr & 0x0FE00030) == 0x06A00010)
-            return ARM_SSAT;
-
-        if ((instr & 0x0FF00FF0) == 0x06800FB0)
-            return ARM_SEL;
-
-        if ((instr & 0x0FF00FF0) == 0x06500F90)
-            return ARM_UADD8;
-
-        if ((instr & 0x0FF00FF0) == 0x06700F90)
-            return ARM_UHADD8;
-
-        if ((instr & 0x0FF00FF0) == 0x06500FF0)
-            return ARM_USUB8;
-
-        if ((instr & 0x0FF00FF0) == 0x06200FF0)
-            return ARM_QSUB8;
-
-        if ((instr & 0x0FF00F00) == 0x06600F00)
-        {
-            switch (instr & 0xF0)
-            {
-                case 0x90:
-                    return ARM_UQADD8;
-                case 0xF0:
-                    return ARM_UQSUB8;
-                default:
-                    return ARM_UNDEFINED;
-            }
-        }
-
-        return ARM_UNDEFINED;
-    }
-
-    if ((instr & 0xFD70F000) == 0xF550F000)
-        return ARM_PLD;
-
-    if ((instr & 0x0FF00FFF) == 0x01D00F9F)
-        return ARM_LOAD_EX_BYTE;
-
-    if ((instr & 0x0FF00FF0) == 0x01C00F90)
-        return ARM_STORE_EX_BYTE;
-
-    if ((instr & 0x0FF00FFF) == 0x01F00F9F)
-        return ARM_LOAD_EX_HALFWORD;
-
-    if ((instr & 0x0FF00FF0) == 0x01E00F90)
-        return ARM_STORE_EX_HALFWORD;
-
-    if ((instr & 0x0FF00FFF) == 0x01900F9F)
-        return ARM_LOAD_EX_WORD;
-
-    if ((instr & 0x0FF00FF0) == 0x01800F90)
-        return ARM_STORE_EX_WORD;
-
-    if ((instr & 0x0FF00FFF) == 0x01B00F9F)
-        return ARM_LOAD_EX_DOUBLEWORD;
-
-    if ((instr & 0x0FF00FF0) == 0x01A00F90)
-        return ARM_STORE_EX_DOUBLEWORD;
-
-    if (((instr >> 26) & 0x3) == 0)
-    {
-        if ((instr & (1 << 25)) == 0)
-        {
-            if (((instr >> 4) & 0xFF) == 0x9)
-            {
-                if (((instr >> 23) & 0x1F) == 0x2 && (((instr >> 20) & 0x3) == 0))
-                    return ARM_SWAP;
-            }
-            if ((instr & (1 << 7)) != 0 && (instr & (1 << 4)) == 0)
-            {
-                if ((instr & (1 << 20)) == 0 && ((instr >> 23) & 0x3) == 0x2)
-                    return ARM_SIGNED_HALFWORD_MULTIPLY;
-            }
-            if ((instr & (1 << 7)) != 0 && (instr & (1 << 4)) != 0)
-            {
-                if (((instr >> 4) & 0xF) == 0x9)
-                {
-                    if (((instr >> 22) & 0x3F) == 0)
-                        return ARM_MULTIPLY;
-                    else if (((instr >> 23) & 0x1F) == 1)
-                        return ARM_MULTIPLY_LONG;
-                    return ARM_UNDEFINED;
-                }
-                else if ((instr & (1 << 6)) == 0 && ((instr & (1 << 5)) != 0))
-                {
-                    if ((instr & (1 << 20)) != 0)
-                        return ARM_LOAD_HALFWORD;
-                    else
-                        return ARM_STORE_HALFWORD;
-                }
-                else if ((instr & (1 << 6)) != 0 && ((instr & (1 << 5))) == 0)
-                {
-                    if ((instr & (1 << 20)) != 0)
-                        return ARM_LOAD_SIGNED_BYTE;
-                    else
-                        return ARM_LOAD_DOUBLEWORD;
-                }
-                else if ((instr & (1 << 6)) != 0 && ((instr & (1 << 5))) != 0)
-                {
-                    if ((instr & (1 << 20)) != 0)
-                        return ARM_LOAD_SIGNED_HALFWORD;
-                    else
-                        return ARM_STORE_DOUBLEWORD;
-                }
-            }
-        }
-
-        if ((instr & 0x0E000000) == 0x02000000)
-            return ARM_DATA_PROCESSING;
-
-        if ((instr & 0x0E000010) == 0x00000000 || (instr & 0x0E000090) == 0x00000010)
-            return ARM_DATA_PROCESSING;
-
-        return ARM_UNDEFINED;
-    }
-
-    if ((instr & (0x0F000000)) >> 26 == 0x1)
-    {
-        if ((instr & (1 << 20)) == 0)
-        {
-            if ((instr & (1 << 22)) == 0)
-                return ARM_STORE_WORD;
-            else
-                return ARM_STORE_BYTE;
-        }
-        else
-        {
-            if ((instr & (1 << 22)) == 0)
-                return ARM_LOAD_WORD;
-            else
-                return ARM_LOAD_BYTE;
-        }
-    }
-    if (((instr >> 25) & 0x7) == 0x4)
-    {
-        if ((instr & (1 << 20)) == 0)
-            return ARM_STORE_BLOCK;
-        else
-            return ARM_LOAD_BLOCK;
-    }
-    if ((instr & 0x0E000000) == 0x0C000000)
-    {
-        return ARM_COP_LOAD_STORE;
-    }
-    if (((instr >> 24) & 0xF) == 0xE)
-    {
-        if ((instr & (1 << 4)) != 0)
-            return ARM_COP_REG_TRANSFER;
-        else
-            return ARM_COP_DATA_OP;
-    }
-    return ARM_UNDEFINED;
+    uint8_t entry = arm_decode_table.entries[get_arm_decode_key(instr)];
+    if (entry & ARM_DECODE_SCAN)
+        return scan_arm_decode_rules(instr, entry & ~ARM_DECODE_SCAN);
+    return (ARM_INSTR)entry;
 }
 
 namespace ARM_Disasm
@@ -1177,8 +930,11 @@ string arm_load_store(ARM_CPU& cpu, uint32_t instr)
             literal += instr & 0xFFF;
         else
             literal -= instr & 0xFFF;
+        //Disassembly must not fault, so unmapped literals are shown as zero
+        uint32_t value = 0;
+        cpu.try_read32(literal, value);
         output << " " << ARM_CPU::get_reg_name(reg) << ", =0x";
-        output << std::hex << cpu.read32(literal);
+        output << std::hex << value;
         return output.str();
     }
     string sub_str;
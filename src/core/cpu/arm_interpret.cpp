@@ -1,5 +1,6 @@
 #include <cstdio>
 #include "arm.hpp"
+#include "arm_decode.hpp"
 #include "arm_disasm.hpp"
 #include "arm_interpret.hpp"
 #include "../common/common.hpp"
@@ -7,240 +8,345 @@
 namespace ARM_Interpreter
 {
 
-void interpret_arm(ARM_CPU &cpu, uint32_t instr)
+template <ARM_CORE_TYPE core>
+static constexpr ARM_Handler get_handler_for(ARM_INSTR type)
 {
-    int cond = instr >> 28;
-
-    if (cond == 0xF)
+    if (core == ARM_CORE_ARM9)
     {
-        if ((instr & 0xFE000000) == 0xFA000000)
+        //ARMv6 instructions are undefined on the ARM9. The ARMv6K hints are MSRs with no fields there, so they do nothing.
+        switch (type)
         {
-            arm_blx(cpu, instr);
-            return;
-        }
-        if (cpu.get_id() != 9 && (instr >> 20) == 0xF10)
-        {
-            cpu.cps(instr);
-            return;
+            case ARM_SRS:
+            case ARM_RFE:
+            case ARM_SXTAB:
+            case ARM_SXTB:
+            case ARM_SXTAH:
+            case ARM_SXTH:
+            case ARM_UXTB:
+            case ARM_UXTAB:
+            case ARM_UXTH:
+            case ARM_UXTAH:
+            case ARM_REV:
+            case ARM_REV16:
+            case ARM_PKHBT:
+            case ARM_PKHTB:
+            case ARM_USAT:
+            case ARM_SSAT:
+            case ARM_SEL:
+            case ARM_UADD8:
+            case ARM_UHADD8:
+            case ARM_USUB8:
+            case ARM_QSUB8:
+            case ARM_UQADD8:
+            case ARM_UQSUB8:
+            case ARM_LOAD_EX_BYTE:
+            case ARM_STORE_EX_BYTE:
+            case ARM_LOAD_EX_HALFWORD:
+            case ARM_STORE_EX_HALFWORD:
+            case ARM_LOAD_EX_WORD:
+            case ARM_STORE_EX_WORD:
+            case ARM_LOAD_EX_DOUBLEWORD:
+            case ARM_STORE_EX_DOUBLEWORD:
+            case ARM_CLREX:
+                return arm_undefined;
+            case ARM_YIELD:
+            case ARM_WFE:
+            case ARM_SEV:
+            case ARM_WFI:
+                return arm_nop;
+            default:
+                break;
         }
     }
 
-    if (!cpu.meets_condition(cond))
-        return;
-
-    switch (decode_arm(instr))
+    switch (type)
     {
         case ARM_SRS:
-            cpu.srs(instr);
-            break;
+            return arm_srs;
         case ARM_RFE:
-            cpu.rfe(instr);
-            break;
+            return arm_rfe;
         case ARM_B:
         case ARM_BL:
-            arm_b(cpu, instr);
-            break;
+            return arm_b;
         case ARM_BX:
-            arm_bx(cpu, instr);
-            break;
+            return arm_bx;
         case ARM_BLX:
-            arm_blx_reg(cpu, instr);
-            break;
+            return arm_blx_reg;
         case ARM_SWI:
-            cpu.swi();
-            break;
+            return arm_swi;
         case ARM_CLZ:
-            arm_clz(cpu, instr);
-            break;
+            return arm_clz;
         case ARM_SWAP:
-            arm_swp(cpu, instr);
-            break;
+            return arm_swp;
         case ARM_SXTAB:
-            arm_sxtab(cpu, instr);
-            break;
+            return arm_sxtab;
         case ARM_SXTB:
-            arm_sxtb(cpu, instr);
-            break;
+            return arm_sxtb;
         case ARM_SXTAH:
-            arm_sxtah(cpu, instr);
-            break;
+            return arm_sxtah;
         case ARM_SXTH:
-            arm_sxth(cpu, instr);
-            break;
+            return arm_sxth;
         case ARM_UXTB:
-            arm_uxtb(cpu, instr);
-            break;
+            return arm_uxtb;
         case ARM_UXTAB:
-            arm_uxtab(cpu, instr);
-            break;
+            return arm_uxtab;
         case ARM_UXTH:
-            arm_uxth(cpu, instr);
-            break;
+            return arm_uxth;
         case ARM_UXTAH:
-            arm_uxtah(cpu, instr);
-            break;
+            return arm_uxtah;
         case ARM_REV:
-            arm_rev(cpu, instr);
-            break;
+            return arm_rev;
         case ARM_REV16:
-            arm_rev16(cpu, instr);
-            break;
+            return arm_rev16;
         case ARM_PKHBT:
-            arm_pkhbt(cpu, instr);
-            break;
+            return arm_pkhbt;
         case ARM_PKHTB:
-            arm_pkhtb(cpu, instr);
-            break;
+            return arm_pkhtb;
         case ARM_USAT:
-            arm_usat(cpu, instr);
-            break;
+            return arm_usat;
         case ARM_SSAT:
-            arm_ssat(cpu, instr);
-            break;
+            return arm_ssat;
         case ARM_DATA_PROCESSING:
-            arm_data_processing(cpu, instr);
-            break;
+            return arm_data_processing;
         case ARM_SIGNED_HALFWORD_MULTIPLY:
-            arm_signed_halfword_multiply(cpu, instr);
-            break;
+            return arm_signed_halfword_multiply;
         case ARM_MULTIPLY:
-            arm_mul(cpu, instr);
-            break;
+            return arm_mul;
         case ARM_MULTIPLY_LONG:
-            arm_mul_long(cpu, instr);
-            break;
+            return arm_mul_long;
         case ARM_SEL:
-            arm_sel(cpu, instr);
-            break;
+            return arm_sel;
         case ARM_UADD8:
-            arm_uadd8(cpu, instr);
-            break;
+            return arm_uadd8;
         case ARM_UHADD8:
-            arm_uhadd8(cpu, instr);
-            break;
+            return arm_uhadd8;
         case ARM_USUB8:
-            arm_usub8(cpu, instr);
-            break;
+            return arm_usub8;
         case ARM_QSUB8:
-            arm_qsub8(cpu, instr);
-            break;
+            return arm_qsub8;
         case ARM_UQADD8:
-            arm_uqadd8(cpu, instr);
-            break;
+            return arm_uqadd8;
         case ARM_UQSUB8:
-            arm_uqsub8(cpu, instr);
-            break;
+            return arm_uqsub8;
         case ARM_LOAD_BYTE:
-            arm_load_byte(cpu, instr);
-            break;
+            return arm_load_byte;
         case ARM_STORE_BYTE:
-            arm_store_byte(cpu, instr);
-            break;
+            return arm_store_byte<core>;
         case ARM_LOAD_WORD:
-            arm_load_word(cpu, instr);
-            break;
+            return arm_load_word<core>;
         case ARM_STORE_WORD:
-            arm_store_word(cpu, instr);
-            break;
-        case ARM_PLD:
-            //We don't emulate cache, so ignore
-            break;
+            return arm_store_word<core>;
         case ARM_LOAD_HALFWORD:
-            arm_load_halfword(cpu, instr);
-            break;
+            return arm_load_halfword;
         case ARM_STORE_HALFWORD:
-            arm_store_halfword(cpu, instr);
-            break;
+            return arm_store_halfword<core>;
         case ARM_LOAD_SIGNED_BYTE:
-            arm_load_signed_byte(cpu, instr);
-            break;
+            return arm_load_signed_byte;
         case ARM_LOAD_SIGNED_HALFWORD:
-            arm_load_signed_halfword(cpu, instr);
-            break;
+            return arm_load_signed_halfword;
         case ARM_LOAD_DOUBLEWORD:
-            arm_load_doubleword(cpu, instr);
-            break;
+            return arm_load_doubleword;
         case ARM_STORE_DOUBLEWORD:
-            arm_store_doubleword(cpu, instr);
-            break;
+            return arm_store_doubleword<core>;
         case ARM_LOAD_BLOCK:
-            arm_load_block(cpu, instr);
-            break;
+            return arm_load_block;
         case ARM_STORE_BLOCK:
-            arm_store_block(cpu, instr);
-            break;
+            return arm_store_block<core>;
         case ARM_LOAD_EX_BYTE:
-            arm_load_ex_byte(cpu, instr);
-            break;
+            return arm_load_ex_byte;
         case ARM_STORE_EX_BYTE:
-            arm_store_ex_byte(cpu, instr);
-            break;
+            return arm_store_ex_byte;
         case ARM_LOAD_EX_HALFWORD:
-            arm_load_ex_halfword(cpu, instr);
-            break;
+            return arm_load_ex_halfword;
         case ARM_STORE_EX_HALFWORD:
-            arm_store_ex_halfword(cpu, instr);
-            break;
+            return arm_store_ex_halfword;
         case ARM_LOAD_EX_WORD:
-            arm_load_ex_word(cpu, instr);
-            break;
+            return arm_load_ex_word;
         case ARM_STORE_EX_WORD:
-            arm_store_ex_word(cpu, instr);
-            break;
+            return arm_store_ex_word;
         case ARM_LOAD_EX_DOUBLEWORD:
-            arm_load_ex_doubleword(cpu, instr);
-            break;
+            return arm_load_ex_doubleword;
         case ARM_STORE_EX_DOUBLEWORD:
-            arm_store_ex_doubleword(cpu, instr);
-            break;
+            return arm_store_ex_doubleword;
         case ARM_COP_LOAD_STORE:
-        {
-            int id = (instr >> 8) & 0xF;
-            if (id == 10 || id == 11)
-                cpu.vfp_load_store(instr);
-            else
-                EmuException::die("[ARM_Interpreter] Undefined instr $%08X\n", instr);
-        }
-            break;
+            return arm_cop_load_store;
         case ARM_COP_REG_TRANSFER:
-        {
-            int id = (instr >> 8) & 0xF;
-            if (id == 10 || id == 11)
-                cpu.vfp_single_transfer(instr);
-            else
-                arm_cop_transfer(cpu, instr);
-        }
-            break;
+            return arm_cop_reg_transfer;
         case ARM_COP_DATA_OP:
-        {
-            int id = (instr >> 8) & 0xF;
-            if (id == 10 || id == 11)
-                cpu.vfp_data_processing(instr);
-            else
-                EmuException::die("[ARM_Interpreter] Undefined instr $%08X\n", instr);
-        }
-            break;
+            return arm_cop_data_op;
+        case ARM_PLD:
+            //We don't emulate cache, so ignore
         case ARM_NOP:
         case ARM_YIELD:
-            break;
+            return arm_nop;
         case ARM_WFE:
-            cpu.wfe();
-            break;
+            return arm_wfe;
         case ARM_SEV:
-            cpu.sev();
-            break;
+            return arm_sev;
         case ARM_WFI:
-            cpu.halt();
-            break;
+            return arm_wfi;
         case ARM_CLREX:
-            cpu.clear_exclusive();
-            break;
+            return arm_clrex;
         case ARM_BKPT:
-            EmuException::die("[ARM_Interpreter] BKPT called\n");
-            break;
+            return arm_bkpt;
         default:
-            EmuException::die("[ARM_Interpreter] Undefined instr $%08X\n", instr);
+            return arm_undefined;
+    }
+}
+
+struct ARM_HandlerTable
+{
+    ARM_Handler entries[ARM_DECODE_TABLE_SIZE];
+};
+
+template <ARM_CORE_TYPE core>
+static constexpr ARM_HandlerTable make_arm_handler_table()
+{
+    ARM_HandlerTable table = {};
+    for (int key = 0; key < ARM_DECODE_TABLE_SIZE; key++)
+    {
+        //Keys that need the full instruction to decode are left null
+        uint8_t entry = make_arm_decode_entry(key);
+        if (!(entry & ARM_DECODE_SCAN))
+            table.entries[key] = get_handler_for<core>((ARM_INSTR)entry);
+    }
+    return table;
+}
+
+static constexpr ARM_HandlerTable arm9_handler_table = make_arm_handler_table<ARM_CORE_ARM9>();
+static constexpr ARM_HandlerTable arm11_handler_table = make_arm_handler_table<ARM_CORE_ARM11>();
+
+template <ARM_CORE_TYPE core>
+static inline ARM_Handler lookup_arm_handler(uint32_t instr)
+{
+    const ARM_HandlerTable& table = (core == ARM_CORE_ARM9) ? arm9_handler_table : arm11_handler_table;
+    if ((instr >> 28) != 0xF)
+    {
+        ARM_Handler handler = table.entries[get_arm_decode_key(instr)];
+        if (handler)
+            return handler;
     }
+    return get_handler_for<core>(decode_arm(instr));
+}
+
+ARM_Handler get_arm_handler(ARM_CORE_TYPE core, uint32_t instr)
+{
+    if (core == ARM_CORE_ARM9)
+        return lookup_arm_handler<ARM_CORE_ARM9>(instr);
+    return lookup_arm_handler<ARM_CORE_ARM11>(instr);
+}
+
+template <ARM_CORE_TYPE core>
+void interpret_arm(ARM_CPU &cpu, uint32_t instr)
+{
+    int cond = instr >> 28;
+
+    if (cond == 0xF)
+    {
+        if ((instr & 0xFE000000) == 0xFA000000)
+        {
+            arm_blx(cpu, instr);
+            return;
+        }
+        if (core == ARM_CORE_ARM11 && (instr >> 20) == 0xF10)
+        {
+            cpu.cps(instr);
+            return;
+        }
+    }
+
+    if (!cpu.meets_condition(cond))
+        return;
+
+    lookup_arm_handler<core>(instr)(cpu, instr);
+}
+
+void interpret_arm(ARM_CPU &cpu, uint32_t instr)
+{
+    if (cpu.get_core_type() == ARM_CORE_ARM9)
+        interpret_arm<ARM_CORE_ARM9>(cpu, instr);
+    else
+        interpret_arm<ARM_CORE_ARM11>(cpu, instr);
+}
+
+template void interpret_arm<ARM_CORE_ARM9>(ARM_CPU &cpu, uint32_t instr);
+template void interpret_arm<ARM_CORE_ARM11>(ARM_CPU &cpu, uint32_t instr);
+
+void arm_srs(ARM_CPU &cpu, uint32_t instr)
+{
+    cpu.srs(instr);
+}
+
+void arm_rfe(ARM_CPU &cpu, uint32_t instr)
+{
+    cpu.rfe(instr);
+}
+
+void arm_swi(ARM_CPU &cpu, uint32_t)
+{
+    cpu.swi();
+}
+
+void arm_nop(ARM_CPU&, uint32_t)
+{
+
+}
+
+void arm_cop_load_store(ARM_CPU &cpu, uint32_t instr)
+{
+    int id = (instr >> 8) & 0xF;
+    if (id == 10 || id == 11)
+        cpu.vfp_load_store(instr);
+    else
+        EmuException::die("[ARM_Interpreter] Undefined instr $%08X\n", instr);
+}
+
+void arm_cop_reg_transfer(ARM_CPU &cpu, uint32_t instr)
+{
+    int id = (instr >> 8) & 0xF;
+    if (id == 10 || id == 11)
+        cpu.vfp_single_transfer(instr);
+    else
+        arm_cop_transfer(cpu, instr);
+}
+
+void arm_cop_data_op(ARM_CPU &cpu, uint32_t instr)
+{
+    int id = (instr >> 8) & 0xF;
+    if (id == 10 || id == 11)
+        cpu.vfp_data_processing(instr);
+    else
+        EmuException::die("[ARM_Interpreter] Undefined instr $%08X\n", instr);
+}
+
+void arm_wfe(ARM_CPU &cpu, uint32_t)
+{
+    cpu.wfe();
+}
+
+void arm_sev(ARM_CPU &cpu, uint32_t)
+{
+    cpu.sev();
+}
+
+void arm_wfi(ARM_CPU &cpu, uint32_t)
+{
+    cpu.halt();
+}
+
+void arm_clrex(ARM_CPU &cpu, uint32_t)
+{
+    cpu.clear_exclusive();
+}
+
+void arm_bkpt(ARM_CPU&, uint32_t)
+{
+    EmuException::die("[ARM_Interpreter] BKPT called\n");
+}
+
+void arm_undefined(ARM_CPU&, uint32_t instr)
+{
+    EmuException::die("[ARM_Interpreter] Undefined instr $%08X\n", instr);
 }
 
 void arm_b(ARM_CPU &cpu, uint32_t instr)
@@ -330,7 +436,11 @@ void arm_swp(ARM_CPU &cpu, uint32_t instr)
     if (is_byte)
     {
         uint8_t byte = cpu.read8(address);
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.write8(address, cpu.get_register(source) & 0xFF);
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.set_register(destination, byte);
 
         //cpu.add_n16_data(address, 2);
@@ -338,7 +448,11 @@ void arm_swp(ARM_CPU &cpu, uint32_t instr)
     else
     {
         uint32_t word = cpu.rotr32(cpu.read32(address & ~0x3), (address & 0x3) * 8, false);
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.write32(address, cpu.get_register(source));
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.set_register(destination, word);
 
         //cpu.add_n32_data(address, 2);
@@ -726,7 +840,7 @@ void arm_data_processing(ARM_CPU &cpu, uint32_t instr)
             cpu.mvn(destination, second_operand, set_condition_codes);
             break;
         default:
-            printf("Data processing opcode $%01X not recognized\n", opcode);
+            LOG(LOG_ARM, LOG_WARN, "Data processing opcode $%01X not recognized\n", opcode);
     }
 }
 
@@ -917,7 +1031,7 @@ uint32_t load_store_shift_reg(ARM_CPU& cpu, uint32_t instr)
                 reg = cpu.rotr32(reg, shift, false);
             break;
         default:
-            printf("[ARM_Interpreter] Invalid load/store shift: %d\n", shift_type);
+            LOG(LOG_ARM, LOG_WARN, "[ARM_Interpreter] Invalid load/store shift: %d\n", shift_type);
     }
 
     return reg;
@@ -1123,14 +1237,20 @@ void arm_load_byte(ARM_CPU &cpu, uint32_t instr)
         else
             address -= offset;
 
-        cpu.set_register(destination, cpu.read8(address));
+        uint8_t byte = cpu.read8(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.set_register(destination, byte);
 
         if (is_writing_back && base != destination)
             cpu.set_register(base, address);
     }
     else
     {
-        cpu.set_register(destination, cpu.read8(address));
+        uint8_t byte = cpu.read8(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.set_register(destination, byte);
 
         if (is_adding_offset)
             address += offset;
@@ -1142,6 +1262,7 @@ void arm_load_byte(ARM_CPU &cpu, uint32_t instr)
     }
 }
 
+template <ARM_CORE_TYPE core>
 void arm_store_byte(ARM_CPU &cpu, uint32_t instr)
 {
     uint32_t base = (instr >> 16) & 0xF;
@@ -1171,14 +1292,18 @@ void arm_store_byte(ARM_CPU &cpu, uint32_t instr)
             address -= offset;
 
         cpu.write8(address, value);
-        cpu.clear_global_exclusives(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
         if (is_writing_back)
             cpu.set_register(base, address);
     }
     else
     {
         cpu.write8(address, value);
-        cpu.clear_global_exclusives(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
 
         if (is_adding_offset)
             address += offset;
@@ -1189,6 +1314,7 @@ void arm_store_byte(ARM_CPU &cpu, uint32_t instr)
     }
 }
 
+template <ARM_CORE_TYPE core>
 void arm_load_word(ARM_CPU &cpu, uint32_t instr)
 {
     uint32_t base = (instr >> 16) & 0xF;
@@ -1218,11 +1344,14 @@ void arm_load_word(ARM_CPU &cpu, uint32_t instr)
         uint32_t word;
 
         //Split unaligned accesses into two reads to prevent issues if physical pages are not contiguous
-        if (cpu.get_id() < 11 && (address & 0x3))
+        if (core == ARM_CORE_ARM9 && (address & 0x3))
             word = cpu.rotr32(cpu.read32(address & ~0x3), (address & 0x3) * 8, false);
         else
             word = cpu.read32(address);
 
+        if (cpu.is_data_abort_pending())
+            return;
+
         if (is_writing_back && base != destination)
             cpu.set_register(base, address);
 
@@ -1234,11 +1363,14 @@ void arm_load_word(ARM_CPU &cpu, uint32_t instr)
     else
     {
         uint32_t word;
-        if (cpu.get_id() < 11 && (address & 0x3))
+        if (core == ARM_CORE_ARM9 && (address & 0x3))
             word = cpu.rotr32(cpu.read32(address & ~0x3), (address & 0x3) * 8, false);
         else
             word = cpu.read32(address);
 
+        if (cpu.is_data_abort_pending())
+            return;
+
         if (destination == REG_PC)
             cpu.jp(word, true);
         else
@@ -1254,6 +1386,7 @@ void arm_load_word(ARM_CPU &cpu, uint32_t instr)
     }
 }
 
+template <ARM_CORE_TYPE core>
 void arm_store_word(ARM_CPU &cpu, uint32_t instr)
 {
     uint32_t base = (instr >> 16) & 0xF;
@@ -1281,20 +1414,24 @@ void arm_store_word(ARM_CPU &cpu, uint32_t instr)
             address -= offset;
 
         //cpu.add_n32_data(address, 1);
-        if (cpu.get_id() < 11)
+        if (core == ARM_CORE_ARM9)
             address &= ~0x3;
         cpu.write32(address, value);
-        cpu.clear_global_exclusives(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
         if (is_writing_back)
             cpu.set_register(base, address);
     }
     else
     {
         //cpu.add_n32_data(address, 1);
-        if (cpu.get_id() < 11)
+        if (core == ARM_CORE_ARM9)
             address &= ~0x3;
         cpu.write32(address, value);
-        cpu.clear_global_exclusives(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
 
         if (is_adding_offset)
             address += offset;
@@ -1331,13 +1468,19 @@ void arm_load_halfword(ARM_CPU &cpu, uint32_t instr)
         else
             address -= offset;
 
-        cpu.set_register(destination, cpu.read16(address));
+        uint16_t halfword = cpu.read16(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.set_register(destination, halfword);
         if (is_writing_back && base != destination)
             cpu.set_register(base, address);
     }
     else
     {
-        cpu.set_register(destination, cpu.read16(address));
+        uint16_t halfword = cpu.read16(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.set_register(destination, halfword);
         if (is_adding_offset)
             address += offset;
         else
@@ -1350,6 +1493,7 @@ void arm_load_halfword(ARM_CPU &cpu, uint32_t instr)
     //cpu.add_n16_data(address, 1);
 }
 
+template <ARM_CORE_TYPE core>
 void arm_store_halfword(ARM_CPU &cpu, uint32_t instr)
 {
     bool is_preindexing = (instr & (1 << 24)) != 0;
@@ -1377,14 +1521,18 @@ void arm_store_halfword(ARM_CPU &cpu, uint32_t instr)
         else
             address -= offset;
         cpu.write16(address, halfword);
-        cpu.clear_global_exclusives(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
         if (is_writing_back)
             cpu.set_register(base, address);
     }
     else
     {
         cpu.write16(address, halfword);
-        cpu.clear_global_exclusives(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
         if (is_adding_offset)
             address += offset;
         else
@@ -1422,6 +1570,8 @@ void arm_load_signed_byte(ARM_CPU &cpu, uint32_t instr)
             address -= offset;
 
         uint32_t word = (int32_t)(int8_t)(cpu.read8(address));
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.set_register(destination, word);
         if (is_writing_back)
             cpu.set_register(base, address);
@@ -1429,6 +1579,8 @@ void arm_load_signed_byte(ARM_CPU &cpu, uint32_t instr)
     else
     {
         uint32_t word = (int32_t)(int8_t)(cpu.read8(address));
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.set_register(destination, word);
 
         if (is_adding_offset)
@@ -1470,6 +1622,8 @@ void arm_load_signed_halfword(ARM_CPU &cpu, uint32_t instr)
             address -= offset;
 
         uint32_t word = (int32_t)(int16_t)(cpu.read16(address));
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.set_register(destination, word);
         if (is_writing_back)
             cpu.set_register(base, address);
@@ -1477,6 +1631,8 @@ void arm_load_signed_halfword(ARM_CPU &cpu, uint32_t instr)
     else
     {
         uint32_t word = (int32_t)(int16_t)(cpu.read16(address));
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.set_register(destination, word);
 
         if (is_adding_offset)
@@ -1518,16 +1674,24 @@ void arm_load_doubleword(ARM_CPU &cpu, uint32_t instr)
         else
             address -= offset;
 
-        cpu.set_register(dest, cpu.read32(address));
-        cpu.set_register(dest + 1, cpu.read32(address + 4));
+        uint32_t low = cpu.read32(address);
+        uint32_t high = cpu.read32(address + 4);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.set_register(dest, low);
+        cpu.set_register(dest + 1, high);
 
         if (write_back)
             cpu.set_register(base, address);
     }
     else
     {
-        cpu.set_register(dest, cpu.read32(address));
-        cpu.set_register(dest + 1, cpu.read32(address + 4));
+        uint32_t low = cpu.read32(address);
+        uint32_t high = cpu.read32(address + 4);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.set_register(dest, low);
+        cpu.set_register(dest + 1, high);
 
         if (add_offset)
             address += offset;
@@ -1537,6 +1701,7 @@ void arm_load_doubleword(ARM_CPU &cpu, uint32_t instr)
     }
 }
 
+template <ARM_CORE_TYPE core>
 void arm_store_doubleword(ARM_CPU &cpu, uint32_t instr)
 {
     bool is_preindexing = instr & (1 << 24);
@@ -1566,8 +1731,10 @@ void arm_store_doubleword(ARM_CPU &cpu, uint32_t instr)
 
         cpu.write32(address, cpu.get_register(source));
         cpu.write32(address + 4, cpu.get_register(source + 1));
-        cpu.clear_global_exclusives(address);
-        cpu.clear_global_exclusives(address + 4);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
+        cpu.clear_global_exclusives<core>(address + 4);
 
         if (write_back)
             cpu.set_register(base, address);
@@ -1576,8 +1743,10 @@ void arm_store_doubleword(ARM_CPU &cpu, uint32_t instr)
     {
         cpu.write32(address, cpu.get_register(source));
         cpu.write32(address + 4, cpu.get_register(source + 1));
-        cpu.clear_global_exclusives(address);
-        cpu.clear_global_exclusives(address + 4);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.clear_global_exclusives<core>(address);
+        cpu.clear_global_exclusives<core>(address + 4);
 
         if (add_offset)
             address += offset;
@@ -1600,6 +1769,7 @@ void arm_load_block(ARM_CPU &cpu, uint32_t instr)
     bool change_cpsr = load_PSR && (reg_list & (1 << 15));
 
     uint32_t address = cpu.get_register(base);
+    uint32_t old_base = address;
     int offset;
     if (is_adding_offset)
         offset = 4;
@@ -1620,6 +1790,8 @@ void arm_load_block(ARM_CPU &cpu, uint32_t instr)
         for (int i = 0; i < 15; i++)
         {
             int bit = 1 << i;
+            if (cpu.is_data_abort_pending())
+                break;
             if (reg_list & bit)
             {
                 regs++;
@@ -1641,12 +1813,14 @@ void arm_load_block(ARM_CPU &cpu, uint32_t instr)
             {
                 address += offset;
                 uint32_t new_PC = cpu.read32(address);
-                cpu.jp(new_PC, true);
+                if (!cpu.is_data_abort_pending())
+                    cpu.jp(new_PC, true);
             }
             else
             {
                 uint32_t new_PC = cpu.read32(address);
-                cpu.jp(new_PC, true);
+                if (!cpu.is_data_abort_pending())
+                    cpu.jp(new_PC, true);
                 address += offset;
             }
             regs++;
@@ -1660,12 +1834,14 @@ void arm_load_block(ARM_CPU &cpu, uint32_t instr)
             {
                 address += offset;
                 uint32_t new_PC = cpu.read32(address);
-                cpu.jp(new_PC, true);
+                if (!cpu.is_data_abort_pending())
+                    cpu.jp(new_PC, true);
             }
             else
             {
                 uint32_t new_PC = cpu.read32(address);
-                cpu.jp(new_PC, true);
+                if (!cpu.is_data_abort_pending())
+                    cpu.jp(new_PC, true);
                 address += offset;
             }
             regs++;
@@ -1673,6 +1849,8 @@ void arm_load_block(ARM_CPU &cpu, uint32_t instr)
         for (int i = 14; i >= 0; i--)
         {
             int bit = 1 << i;
+            if (cpu.is_data_abort_pending())
+                break;
             if (reg_list & bit)
             {
                 regs++;
@@ -1696,6 +1874,13 @@ void arm_load_block(ARM_CPU &cpu, uint32_t instr)
         cpsr->mode = old_mode;
     }
 
+    //Registers loaded before the fault may keep their new values, but the base is restored
+    if (cpu.is_data_abort_pending())
+    {
+        cpu.set_register(base, old_base);
+        return;
+    }
+
     //if (regs > 1)
         //cpu.add_s32_data(address, regs - 1);
     //cpu.add_n32_data(address, 1);
@@ -1708,6 +1893,7 @@ void arm_load_block(ARM_CPU &cpu, uint32_t instr)
         cpu.spsr_to_cpsr();
 }
 
+template <ARM_CORE_TYPE core>
 void arm_store_block(ARM_CPU &cpu, uint32_t instr)
 {
     uint16_t reg_list = instr & 0xFFFF;
@@ -1740,6 +1926,8 @@ void arm_store_block(ARM_CPU &cpu, uint32_t instr)
         for (int i = 0; i < 16; i++)
         {
             int bit = 1 << i;
+            if (cpu.is_data_abort_pending())
+                break;
             if (reg_list & bit)
             {
                 regs++;
@@ -1747,12 +1935,12 @@ void arm_store_block(ARM_CPU &cpu, uint32_t instr)
                 {
                     address += offset;
                     cpu.write32(address, cpu.get_register(i));
-                    cpu.clear_global_exclusives(address);
+                    cpu.clear_global_exclusives<core>(address);
                 }
                 else
                 {
                     cpu.write32(address, cpu.get_register(i));
-                    cpu.clear_global_exclusives(address);
+                    cpu.clear_global_exclusives<core>(address);
                     address += offset;
                 }
             }
@@ -1763,6 +1951,8 @@ void arm_store_block(ARM_CPU &cpu, uint32_t instr)
         for (int i = 15; i >= 0; i--)
         {
             int bit = 1 << i;
+            if (cpu.is_data_abort_pending())
+                break;
             if (reg_list & bit)
             {
                 regs++;
@@ -1770,12 +1960,12 @@ void arm_store_block(ARM_CPU &cpu, uint32_t instr)
                 {
                     address += offset;
                     cpu.write32(address, cpu.get_register(i));
-                    cpu.clear_global_exclusives(address);
+                    cpu.clear_global_exclusives<core>(address);
                 }
                 else
                 {
                     cpu.write32(address, cpu.get_register(i));
-                    cpu.clear_global_exclusives(address);
+                    cpu.clear_global_exclusives<core>(address);
                     address += offset;
                 }
             }
@@ -1788,6 +1978,9 @@ void arm_store_block(ARM_CPU &cpu, uint32_t instr)
         cpsr->mode = old_mode;
     }
 
+    if (cpu.is_data_abort_pending())
+        return;
+
     //if (regs > 2)
         //cpu.add_s32_data(address, regs - 1);
     //cpu.add_n32_data(address, 2);
@@ -1797,18 +1990,23 @@ void arm_store_block(ARM_CPU &cpu, uint32_t instr)
 
 void arm_load_ex_byte(ARM_CPU &cpu, uint32_t instr)
 {
+    std::unique_lock<std::recursive_mutex> lock = ARM_CPU::lock_exclusives();
     uint32_t base = (instr >> 16) & 0xF;
     uint32_t dest = (instr >> 12) & 0xF;
 
     uint32_t addr = cpu.get_register(base);
 
-    cpu.set_register(dest, cpu.read8(addr));
+    uint8_t value = cpu.read8(addr);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(dest, value);
 
     cpu.set_exclusive(addr, 1);
 }
 
 void arm_store_ex_byte(ARM_CPU &cpu, uint32_t instr)
 {
+    std::unique_lock<std::recursive_mutex> lock = ARM_CPU::lock_exclusives();
     uint32_t base = (instr >> 16) & 0xF;
     uint32_t dest = (instr >> 12) & 0xF;
     uint32_t source = instr & 0xF;
@@ -1818,6 +2016,8 @@ void arm_store_ex_byte(ARM_CPU &cpu, uint32_t instr)
     if (cpu.has_exclusive(addr))
     {
         cpu.write8(addr, cpu.get_register(source) & 0xFF);
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.clear_global_exclusives(addr);
         cpu.set_register(dest, 0);
     }
@@ -1829,18 +2029,23 @@ void arm_store_ex_byte(ARM_CPU &cpu, uint32_t instr)
 
 void arm_load_ex_halfword(ARM_CPU &cpu, uint32_t instr)
 {
+    std::unique_lock<std::recursive_mutex> lock = ARM_CPU::lock_exclusives();
     uint32_t base = (instr >> 16) & 0xF;
     uint32_t dest = (instr >> 12) & 0xF;
 
     uint32_t addr = cpu.get_register(base);
 
-    cpu.set_register(dest, cpu.read16(addr));
+    uint16_t value = cpu.read16(addr);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(dest, value);
 
     cpu.set_exclusive(addr, 2);
 }
 
 void arm_store_ex_halfword(ARM_CPU &cpu, uint32_t instr)
 {
+    std::unique_lock<std::recursive_mutex> lock = ARM_CPU::lock_exclusives();
     uint32_t base = (instr >> 16) & 0xF;
     uint32_t dest = (instr >> 12) & 0xF;
     uint32_t source = instr & 0xF;
@@ -1850,6 +2055,8 @@ void arm_store_ex_halfword(ARM_CPU &cpu, uint32_t instr)
     if (cpu.has_exclusive(addr))
     {
         cpu.write16(addr, cpu.get_register(source) & 0xFFFF);
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.clear_global_exclusives(addr);
         cpu.set_register(dest, 0);
     }
@@ -1861,18 +2068,23 @@ void arm_store_ex_halfword(ARM_CPU &cpu, uint32_t instr)
 
 void arm_load_ex_word(ARM_CPU &cpu, uint32_t instr)
 {
+    std::unique_lock<std::recursive_mutex> lock = ARM_CPU::lock_exclusives();
     uint32_t base = (instr >> 16) & 0xF;
     uint32_t dest = (instr >> 12) & 0xF;
 
     uint32_t addr = cpu.get_register(base);
 
-    cpu.set_register(dest, cpu.read32(addr));
+    uint32_t value = cpu.read32(addr);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(dest, value);
 
     cpu.set_exclusive(addr, 4);
 }
 
 void arm_store_ex_word(ARM_CPU &cpu, uint32_t instr)
 {
+    std::unique_lock<std::recursive_mutex> lock = ARM_CPU::lock_exclusives();
     uint32_t base = (instr >> 16) & 0xF;
     uint32_t dest = (instr >> 12) & 0xF;
     uint32_t source = instr & 0xF;
@@ -1882,6 +2094,8 @@ void arm_store_ex_word(ARM_CPU &cpu, uint32_t instr)
     if (cpu.has_exclusive(addr))
     {
         cpu.write32(addr, cpu.get_register(source));
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.clear_global_exclusives(addr);
         cpu.set_register(dest, 0);
     }
@@ -1893,19 +2107,25 @@ void arm_store_ex_word(ARM_CPU &cpu, uint32_t instr)
 
 void arm_load_ex_doubleword(ARM_CPU &cpu, uint32_t instr)
 {
+    std::unique_lock<std::recursive_mutex> lock = ARM_CPU::lock_exclusives();
     uint32_t base = (instr >> 16) & 0xF;
     uint32_t dest = (instr >> 12) & 0xF;
 
     uint32_t addr = cpu.get_register(base);
 
-    cpu.set_register(dest, cpu.read32(addr));
-    cpu.set_register(dest + 1, cpu.read32(addr + 4));
+    uint32_t low = cpu.read32(addr);
+    uint32_t high = cpu.read32(addr + 4);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(dest, low);
+    cpu.set_register(dest + 1, high);
 
     cpu.set_exclusive(addr, 8);
 }
 
 void arm_store_ex_doubleword(ARM_CPU &cpu, uint32_t instr)
 {
+    std::unique_lock<std::recursive_mutex> lock = ARM_CPU::lock_exclusives();
     uint32_t base = (instr >> 16) & 0xF;
     uint32_t dest = (instr >> 12) & 0xF;
     uint32_t source = instr & 0xF;
@@ -1916,6 +2136,8 @@ void arm_store_ex_doubleword(ARM_CPU &cpu, uint32_t instr)
     {
         cpu.write32(addr, cpu.get_register(source));
         cpu.write32(addr + 4, cpu.get_register(source + 1));
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.clear_global_exclusives(addr);
         cpu.clear_global_exclusives(addr + 4);
         cpu.set_register(dest, 0);
@@ -1,13 +1,19 @@
 #ifndef ARM_INTERPRET_HPP
 #define ARM_INTERPRET_HPP
 #include <cstdint>
+#include "arm.hpp"
 
-class ARM_CPU;
 class VFP;
 
 namespace ARM_Interpreter
 {
+    typedef void (*ARM_Handler)(ARM_CPU& cpu, uint32_t instr);
+    typedef void (*THUMB_Handler)(ARM_CPU& cpu, uint16_t instr);
+
+    //The untemplated versions dispatch on the CPU's core type
+    template <ARM_CORE_TYPE core> void interpret_arm(ARM_CPU& cpu, uint32_t instr);
     void interpret_arm(ARM_CPU& cpu, uint32_t instr);
+    ARM_Handler get_arm_handler(ARM_CORE_TYPE core, uint32_t instr);
     void arm_b(ARM_CPU& cpu, uint32_t instr);
     void arm_bx(ARM_CPU& cpu, uint32_t instr);
     void arm_blx(ARM_CPU& cpu, uint32_t instr);
@@ -40,15 +46,15 @@ namespace ARM_Interpreter
     void arm_mul(ARM_CPU& cpu, uint32_t instr);
     void arm_mul_long(ARM_CPU& cpu, uint32_t instr);
     void arm_load_byte(ARM_CPU& cpu, uint32_t instr);
-    void arm_store_byte(ARM_CPU& cpu, uint32_t instr);
-    void arm_load_word(ARM_CPU& cpu, uint32_t instr);
-    void arm_store_word(ARM_CPU& cpu, uint32_t instr);
+    template <ARM_CORE_TYPE core> void arm_store_byte(ARM_CPU& cpu, uint32_t instr);
+    template <ARM_CORE_TYPE core> void arm_load_word(ARM_CPU& cpu, uint32_t instr);
+    template <ARM_CORE_TYPE core> void arm_store_word(ARM_CPU& cpu, uint32_t instr);
     void arm_load_halfword(ARM_CPU& cpu, uint32_t instr);
-    void arm_store_halfword(ARM_CPU& cpu, uint32_t instr);
+    template <ARM_CORE_TYPE core> void arm_store_halfword(ARM_CPU& cpu, uint32_t instr);
     void arm_load_signed_byte(ARM_CPU& cpu, uint32_t instr);
     void arm_load_signed_halfword(ARM_CPU& cpu, uint32_t instr);
     void arm_load_doubleword(ARM_CPU& cpu, uint32_t instr);
-    void arm_store_doubleword(ARM_CPU& cpu, uint32_t instr);
+    template <ARM_CORE_TYPE core> void arm_store_doubleword(ARM_CPU& cpu, uint32_t instr);
     void arm_load_ex_byte(ARM_CPU& cpu, uint32_t instr);
     void arm_store_ex_byte(ARM_CPU& cpu, uint32_t instr);
     void arm_load_ex_halfword(ARM_CPU& cpu, uint32_t instr);
@@ -58,8 +64,21 @@ namespace ARM_Interpreter
     void arm_load_ex_doubleword(ARM_CPU& cpu, uint32_t instr);
     void arm_store_ex_doubleword(ARM_CPU& cpu, uint32_t instr);
     void arm_load_block(ARM_CPU& cpu, uint32_t instr);
-    void arm_store_block(ARM_CPU& cpu, uint32_t instr);
+    template <ARM_CORE_TYPE core> void arm_store_block(ARM_CPU& cpu, uint32_t instr);
     void arm_cop_transfer(ARM_CPU& cpu, uint32_t instr);
+    void arm_srs(ARM_CPU& cpu, uint32_t instr);
+    void arm_rfe(ARM_CPU& cpu, uint32_t instr);
+    void arm_swi(ARM_CPU& cpu, uint32_t instr);
+    void arm_nop(ARM_CPU& cpu, uint32_t instr);
+    void arm_cop_load_store(ARM_CPU& cpu, uint32_t instr);
+    void arm_cop_reg_transfer(ARM_CPU& cpu, uint32_t instr);
+    void arm_cop_data_op(ARM_CPU& cpu, uint32_t instr);
+    void arm_wfe(ARM_CPU& cpu, uint32_t instr);
+    void arm_sev(ARM_CPU& cpu, uint32_t instr);
+    void arm_wfi(ARM_CPU& cpu, uint32_t instr);
+    void arm_clrex(ARM_CPU& cpu, uint32_t instr);
+    void arm_bkpt(ARM_CPU& cpu, uint32_t instr);
+    void arm_undefined(ARM_CPU& cpu, uint32_t instr);
 
     void vfp_single_transfer(ARM_CPU& cpu, VFP& vfp, uint32_t instr);
     void vfp_mov_fpr_gpr(ARM_CPU& cpu, VFP& vfp, uint32_t instr);
@@ -98,7 +117,9 @@ namespace ARM_Interpreter
     void vfp_ftoui(ARM_CPU& cpu, VFP& vfp, uint32_t instr);
     void vfp_ftosi(ARM_CPU& cpu, VFP& vfp, uint32_t instr);
 
+    template <ARM_CORE_TYPE core> void interpret_thumb(ARM_CPU& cpu, uint16_t instr);
     void interpret_thumb(ARM_CPU& cpu, uint16_t instr);
+    THUMB_Handler get_thumb_handler(ARM_CORE_TYPE core, uint16_t instr);
     void thumb_move_shift(ARM_CPU& cpu, uint16_t instr);
     void thumb_add_reg(ARM_CPU& cpu, uint16_t instr);
     void thumb_sub_reg(ARM_CPU& cpu, uint16_t instr);
@@ -108,21 +129,21 @@ namespace ARM_Interpreter
     void thumb_sub(ARM_CPU& cpu, uint16_t instr);
     void thumb_alu(ARM_CPU& cpu, uint16_t instr);
     void thumb_hi_reg_op(ARM_CPU& cpu, uint16_t instr);
-    void thumb_load_imm(ARM_CPU& cpu, uint16_t instr);
-    void thumb_store_imm(ARM_CPU& cpu, uint16_t instr);
-    void thumb_load_reg(ARM_CPU& cpu, uint16_t instr);
-    void thumb_store_reg(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_load_imm(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_store_imm(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_load_reg(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_store_reg(ARM_CPU& cpu, uint16_t instr);
     void thumb_load_halfword(ARM_CPU& cpu, uint16_t instr);
-    void thumb_store_halfword(ARM_CPU& cpu, uint16_t instr);
-    void thumb_load_store_signed(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_store_halfword(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_load_store_signed(ARM_CPU& cpu, uint16_t instr);
     void thumb_load_block(ARM_CPU& cpu, uint16_t instr);
-    void thumb_store_block(ARM_CPU& cpu, uint16_t instr);
-    void thumb_push(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_store_block(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_push(ARM_CPU& cpu, uint16_t instr);
     void thumb_pop(ARM_CPU& cpu, uint16_t instr);
     void thumb_pc_rel_load(ARM_CPU& cpu, uint16_t instr);
     void thumb_load_addr(ARM_CPU& cpu, uint16_t instr);
     void thumb_sp_rel_load(ARM_CPU& cpu, uint16_t instr);
-    void thumb_sp_rel_store(ARM_CPU& cpu, uint16_t instr);
+    template <ARM_CORE_TYPE core> void thumb_sp_rel_store(ARM_CPU& cpu, uint16_t instr);
     void thumb_offset_sp(ARM_CPU& cpu, uint16_t instr);
     void thumb_sxth(ARM_CPU& cpu, uint16_t instr);
     void thumb_sxtb(ARM_CPU& cpu, uint16_t instr);
@@ -135,6 +156,7 @@ namespace ARM_Interpreter
     void thumb_long_branch_prep(ARM_CPU& cpu, uint16_t instr);
     void thumb_long_branch(ARM_CPU& cpu, uint16_t instr);
     void thumb_long_blx(ARM_CPU& cpu, uint16_t instr);
+    void thumb_undefined(ARM_CPU& cpu, uint16_t instr);
 };
 
 #endif // ARM_INTERPRET_HPP
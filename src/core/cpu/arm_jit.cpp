@@ -0,0 +1,785 @@
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include "arm.hpp"
+#include "arm_disasm.hpp"
+#include "arm_interpret.hpp"
+#include "arm_jit.hpp"
+#include "../common/common.hpp"
+
+ARM_JIT::ARM_JIT()
+{
+#ifdef _WIN32
+    code_buffer = (uint8_t*)VirtualAlloc(nullptr, CODE_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    code_buffer = (uint8_t*)mmap(nullptr, CODE_BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code_buffer == MAP_FAILED)
+        code_buffer = nullptr;
+#endif
+    if (!code_buffer)
+        EmuException::die("[ARM_JIT] Failed to allocate code buffer");
+
+    lookup = new JitLookupEntry[LOOKUP_SIZE * LOOKUP_TABLES];
+
+    reset();
+}
+
+ARM_JIT::~ARM_JIT()
+{
+#ifdef _WIN32
+    VirtualFree(code_buffer, 0, MEM_RELEASE);
+#else
+    munmap(code_buffer, CODE_BUFFER_SIZE);
+#endif
+    delete[] lookup;
+}
+
+void ARM_JIT::reset()
+{
+    code_pos = code_buffer;
+    blocks.clear();
+    clear_code_pages();
+    flush_all_lookups();
+
+    pending_exception = nullptr;
+}
+
+void ARM_JIT::flush_lookup(ARM_CPU &cpu)
+{
+    memset(&lookup[get_lookup_index(cpu) * LOOKUP_SIZE], 0, LOOKUP_SIZE * sizeof(JitLookupEntry));
+}
+
+void ARM_JIT::flush_all_lookups()
+{
+    memset(lookup, 0, LOOKUP_SIZE * LOOKUP_TABLES * sizeof(JitLookupEntry));
+}
+
+void ARM_JIT::invalidate_code_page(uint8_t *page)
+{
+    std::vector<uint64_t> keys;
+    if (!remove_code_page(page, keys))
+        return;
+
+    for (uint64_t key : keys)
+    {
+        auto block = blocks.find(key);
+        if (block != blocks.end())
+        {
+            unlink_block(key, block->second);
+            blocks.erase(block);
+        }
+    }
+}
+
+void ARM_JIT::run(ARM_CPU &cpu, int cycles)
+{
+    JitLookupEntry* table = &lookup[get_lookup_index(cpu) * LOOKUP_SIZE];
+
+    //Translation is done here instead of through the interpreter's prefetch
+    cpu.prefetch_abort_occurred = false;
+
+    //Compiled code reads and writes the flag bools directly
+    cpu.CPSR.resolve_flags();
+    while (!cpu.halted && cpu.cycles_ran < cycles)
+    {
+        bool thumb = cpu.CPSR.thumb;
+        uint32_t pc = cpu.gpr[15] - ((thumb) ? 2 : 4);
+        uint32_t tag = pc | thumb;
+
+        JitLookupEntry& entry = table[(pc >> 1) & (LOOKUP_SIZE - 1)];
+        if (entry.tag != tag || !entry.code)
+        {
+            JitBlockFunc code = get_block(cpu, pc, thumb);
+            if (!code)
+            {
+                //Prefetch abort, the CPU is now at the vector
+                cpu.cycles_ran++;
+                continue;
+            }
+            entry.tag = tag;
+            entry.code = code;
+        }
+
+        entry.code(&cpu);
+
+        if (pending_exception)
+        {
+            std::exception_ptr e = pending_exception;
+            pending_exception = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+int32_t ARM_JIT::reg_offset(int id)
+{
+    return gpr_offset + (id * sizeof(uint32_t));
+}
+
+JitBlockFunc ARM_JIT::get_block(ARM_CPU &cpu, uint32_t pc, bool thumb)
+{
+    uint8_t* page = translate_pc(cpu, pc);
+    if (!page)
+        return nullptr;
+    uint64_t key = get_block_key(cpu, page, pc, thumb);
+
+    auto it = blocks.find(key);
+    if (it != blocks.end())
+    {
+        if (it->second.vaddr == pc)
+            return it->second.code;
+
+        //Same physical code reached through a different virtual address. PC-relative code depends on the vaddr,
+        //so the block has to be compiled again.
+        unlink_block(key, it->second);
+    }
+
+    return compile_block(cpu, pc, page, thumb);
+}
+
+void ARM_JIT::unlink_block(uint64_t key, const JitBlock &block)
+{
+    uint32_t tag = block.vaddr | (key & 0x1);
+    for (int i = 0; i < LOOKUP_TABLES; i++)
+    {
+        JitLookupEntry& entry = lookup[(i * LOOKUP_SIZE) + ((block.vaddr >> 1) & (LOOKUP_SIZE - 1))];
+        if (entry.tag == tag && entry.code == block.code)
+            entry.code = nullptr;
+    }
+}
+
+JitBlockFunc ARM_JIT::compile_block(ARM_CPU &cpu, uint32_t pc, uint8_t *page, bool thumb)
+{
+    if (code_pos + MAX_BLOCK_SIZE > code_buffer + CODE_BUFFER_SIZE)
+    {
+        LOG(LOG_ARM, LOG_DEBUG, "[ARM_JIT] Code buffer full, flushing\n");
+        reset();
+    }
+
+    uint8_t* cpu_base = (uint8_t*)&cpu;
+    gpr_offset = (uint8_t*)&cpu.gpr[0] - cpu_base;
+    negative_offset = (uint8_t*)&cpu.CPSR.negative - cpu_base;
+    zero_offset = (uint8_t*)&cpu.CPSR.zero - cpu_base;
+    carry_offset = (uint8_t*)&cpu.CPSR.carry - cpu_base;
+    overflow_offset = (uint8_t*)&cpu.CPSR.overflow - cpu_base;
+    cycles_offset = (uint8_t*)&cpu.cycles_ran - cpu_base;
+
+    emitter.set_block_pos(code_pos);
+    exit_jumps.clear();
+
+    //RBX holds the ARM_CPU pointer for the whole block. Pushing it also aligns the stack for calls.
+    emitter.push(REG_RBX);
+    if (ABI_SHADOW_SPACE)
+        emitter.sub64_reg_imm8(REG_RSP, ABI_SHADOW_SPACE);
+    emitter.mov64_reg_reg(REG_RBX, ABI_PARAM1);
+
+    int instr_size = (thumb) ? 2 : 4;
+    uint32_t addr = pc;
+    int count = 0;
+    bool block_end = false;
+    while (!block_end && count < MAX_BLOCK_INSTRS)
+    {
+        if (thumb)
+            block_end = emit_thumb_instr(*(uint16_t*)&page[addr & 0xFFF], addr, count);
+        else
+            block_end = emit_arm_instr(*(uint32_t*)&page[addr & 0xFFF], addr, count);
+        count++;
+        addr += instr_size;
+
+        //Never let a block cross a page, as the next page may not be contiguous in host memory
+        if ((addr & 0xFFF) == 0)
+            break;
+    }
+
+    emitter.mov32_mem_imm(REG_RBX, reg_offset(REG_PC), addr + instr_size);
+    emitter.add32_mem_imm(REG_RBX, cycles_offset, count);
+
+    for (uint8_t* jump : exit_jumps)
+        emitter.set_jump_dest(jump, emitter.get_code_pos());
+
+    if (ABI_SHADOW_SPACE)
+        emitter.add64_reg_imm8(REG_RSP, ABI_SHADOW_SPACE);
+    emitter.pop(REG_RBX);
+    emitter.ret();
+
+    JitBlockFunc code = (JitBlockFunc)emitter.get_block_pos();
+    code_pos = (uint8_t*)(((uint64_t)emitter.get_code_pos() + 15) & ~15ULL);
+
+    uint64_t key = get_block_key(cpu, page, pc, thumb);
+    blocks[key] = {pc, code};
+    register_code_page(page, key);
+    return code;
+}
+
+void ARM_JIT::emit_exit(int instrs_ran)
+{
+    emitter.add32_mem_imm(REG_RBX, cycles_offset, instrs_ran);
+    exit_jumps.push_back(emitter.jmp());
+}
+
+uint8_t* ARM_JIT::emit_cond_check(int cond)
+{
+    //Returns a jump taken when the condition fails, or nullptr if the instruction is unconditional
+    switch (cond)
+    {
+        case 0x0:
+            emitter.cmp8_mem_imm(REG_RBX, zero_offset, 0);
+            return emitter.jcc(COND_E);
+        case 0x1:
+            emitter.cmp8_mem_imm(REG_RBX, zero_offset, 0);
+            return emitter.jcc(COND_NE);
+        case 0x2:
+            emitter.cmp8_mem_imm(REG_RBX, carry_offset, 0);
+            return emitter.jcc(COND_E);
+        case 0x3:
+            emitter.cmp8_mem_imm(REG_RBX, carry_offset, 0);
+            return emitter.jcc(COND_NE);
+        case 0x4:
+            emitter.cmp8_mem_imm(REG_RBX, negative_offset, 0);
+            return emitter.jcc(COND_E);
+        case 0x5:
+            emitter.cmp8_mem_imm(REG_RBX, negative_offset, 0);
+            return emitter.jcc(COND_NE);
+        case 0x6:
+            emitter.cmp8_mem_imm(REG_RBX, overflow_offset, 0);
+            return emitter.jcc(COND_E);
+        case 0x7:
+            emitter.cmp8_mem_imm(REG_RBX, overflow_offset, 0);
+            return emitter.jcc(COND_NE);
+        case 0xE:
+        case 0xF:
+            return nullptr;
+        default:
+            emitter.mov64_reg_reg(ABI_PARAM1, REG_RBX);
+            emitter.mov32_reg_imm(ABI_PARAM2, cond);
+            emitter.mov64_reg_imm(REG_RAX, (uint64_t)&check_condition);
+            emitter.call_reg(REG_RAX);
+            emitter.test32_reg_reg(REG_RAX, REG_RAX);
+            return emitter.jcc(COND_E);
+    }
+}
+
+void ARM_JIT::emit_arith_flags(bool is_sub)
+{
+    //x86 sets CF on borrow, while ARM clears C
+    emitter.setcc_mem(COND_S, REG_RBX, negative_offset);
+    emitter.setcc_mem(COND_E, REG_RBX, zero_offset);
+    emitter.setcc_mem((is_sub) ? COND_AE : COND_B, REG_RBX, carry_offset);
+    emitter.setcc_mem(COND_O, REG_RBX, overflow_offset);
+}
+
+void ARM_JIT::emit_logical_flags(X64_REG result)
+{
+    emitter.test32_reg_reg(result, result);
+    emitter.setcc_mem(COND_S, REG_RBX, negative_offset);
+    emitter.setcc_mem(COND_E, REG_RBX, zero_offset);
+}
+
+void ARM_JIT::emit_fallback(uint32_t instr, uint32_t pc, int index, bool thumb)
+{
+    uint32_t pipeline_pc = pc + ((thumb) ? 4 : 8);
+    emitter.mov32_mem_imm(REG_RBX, reg_offset(REG_PC), pipeline_pc);
+
+    emitter.mov64_reg_reg(ABI_PARAM1, REG_RBX);
+    emitter.mov32_reg_imm(ABI_PARAM2, instr);
+    emitter.mov32_reg_imm(ABI_PARAM3, pipeline_pc);
+    if (thumb)
+        emitter.mov64_reg_imm(REG_RAX, (uint64_t)&fallback_thumb);
+    else
+        emitter.mov64_reg_imm(REG_RAX, (uint64_t)&fallback_arm);
+    emitter.call_reg(REG_RAX);
+
+    emitter.test32_reg_reg(REG_RAX, REG_RAX);
+    uint8_t* cont = emitter.jcc(COND_E);
+    emit_exit(index + 1);
+    emitter.set_jump_dest(cont, emitter.get_code_pos());
+}
+
+bool ARM_JIT::emit_arm_instr(uint32_t instr, uint32_t pc, int index)
+{
+    if ((instr >> 28) != 0xF)
+    {
+        switch (decode_arm(instr))
+        {
+            case ARM_B:
+            case ARM_BL:
+                emit_arm_branch(instr, pc, index);
+                return true;
+            case ARM_DATA_PROCESSING:
+                if (emit_arm_data_processing(instr))
+                    return false;
+                break;
+            default:
+                break;
+        }
+    }
+
+    emit_fallback(instr, pc, index, false);
+    return is_arm_block_end(instr);
+}
+
+bool ARM_JIT::emit_arm_data_processing(uint32_t instr)
+{
+    int opcode = (instr >> 21) & 0xF;
+    bool set_flags = instr & (1 << 20);
+    int first_operand = (instr >> 16) & 0xF;
+    int destination = (instr >> 12) & 0xF;
+    bool is_operand_imm = instr & (1 << 25);
+    bool is_test = opcode >= 0x8 && opcode <= 0xB;
+    bool uses_first_operand = opcode != 0xD && opcode != 0xF;
+
+    //MRS/MSR, anything with a carry input, register-specified shifts and PC accesses go through the interpreter
+    if (is_test && !set_flags)
+        return false;
+    if (opcode >= 0x5 && opcode <= 0x7)
+        return false;
+    if (!is_test && destination == REG_PC)
+        return false;
+    if (uses_first_operand && first_operand == REG_PC)
+        return false;
+    if (!is_operand_imm && ((instr & (1 << 4)) || (instr & 0xF) == REG_PC))
+        return false;
+
+    bool set_carry;
+    switch (opcode)
+    {
+        case 0x0:
+        case 0x1:
+        case 0x8:
+        case 0x9:
+        case 0xC:
+        case 0xD:
+        case 0xE:
+        case 0xF:
+            set_carry = set_flags;
+            break;
+        default:
+            set_carry = false;
+            break;
+    }
+
+    uint8_t* skip = emit_cond_check(instr >> 28);
+
+    //Second operand goes into ECX, with the shifter carry taken directly from the host CF
+    if (is_operand_imm)
+    {
+        int shift = (instr & 0xF00) >> 7;
+        uint32_t value = rotr32(instr & 0xFF, shift);
+        emitter.mov32_reg_imm(REG_RCX, value);
+        if (set_carry && shift)
+            emitter.mov8_mem_imm(REG_RBX, carry_offset, value >> 31);
+    }
+    else
+    {
+        int shift = (instr >> 7) & 0x1F;
+        int shift_type = (instr >> 5) & 0x3;
+        emitter.mov32_reg_mem(REG_RCX, REG_RBX, reg_offset(instr & 0xF));
+
+        switch (shift_type)
+        {
+            case 0:
+                if (shift)
+                {
+                    emitter.shl32_imm(REG_RCX, shift);
+                    if (set_carry)
+                        emitter.setcc_mem(COND_B, REG_RBX, carry_offset);
+                }
+                break;
+            case 1:
+                if (shift)
+                {
+                    emitter.shr32_imm(REG_RCX, shift);
+                    if (set_carry)
+                        emitter.setcc_mem(COND_B, REG_RBX, carry_offset);
+                }
+                else
+                {
+                    //LSR #32
+                    if (set_carry)
+                    {
+                        emitter.bt32_imm(REG_RCX, 31);
+                        emitter.setcc_mem(COND_B, REG_RBX, carry_offset);
+                    }
+                    emitter.xor32_reg_reg(REG_RCX, REG_RCX);
+                }
+                break;
+            case 2:
+                if (shift)
+                {
+                    emitter.sar32_imm(REG_RCX, shift);
+                    if (set_carry)
+                        emitter.setcc_mem(COND_B, REG_RBX, carry_offset);
+                }
+                else
+                {
+                    //ASR #32
+                    if (set_carry)
+                    {
+                        emitter.bt32_imm(REG_RCX, 31);
+                        emitter.setcc_mem(COND_B, REG_RBX, carry_offset);
+                    }
+                    emitter.sar32_imm(REG_RCX, 31);
+                }
+                break;
+            case 3:
+                if (shift)
+                {
+                    emitter.ror32_imm(REG_RCX, shift);
+                    if (set_carry)
+                        emitter.setcc_mem(COND_B, REG_RBX, carry_offset);
+                }
+                else
+                {
+                    //RRX - load the old carry into CF and rotate through it
+                    emitter.movzx8_reg_mem(REG_RDX, REG_RBX, carry_offset);
+                    emitter.bt32_imm(REG_RDX, 0);
+                    emitter.rcr32_1(REG_RCX);
+                    if (set_carry)
+                        emitter.setcc_mem(COND_B, REG_RBX, carry_offset);
+                }
+                break;
+        }
+    }
+
+    if (uses_first_operand)
+        emitter.mov32_reg_mem(REG_RAX, REG_RBX, reg_offset(first_operand));
+
+    X64_REG result = REG_RAX;
+    switch (opcode)
+    {
+        case 0x0:
+        case 0x8:
+            emitter.and32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0x1:
+        case 0x9:
+            emitter.xor32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0x2:
+            emitter.sub32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0x3:
+            emitter.sub32_reg_reg(REG_RCX, REG_RAX);
+            result = REG_RCX;
+            break;
+        case 0x4:
+            emitter.add32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xA:
+            emitter.cmp32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xB:
+            emitter.add32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xC:
+            emitter.or32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xD:
+            result = REG_RCX;
+            break;
+        case 0xE:
+            emitter.not32(REG_RCX);
+            emitter.and32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xF:
+            emitter.not32(REG_RCX);
+            result = REG_RCX;
+            break;
+    }
+
+    //MOV doesn't touch the host flags, so the flags of the previous op survive until they're stored
+    if (!is_test)
+        emitter.mov32_mem_reg(REG_RBX, reg_offset(destination), result);
+
+    if (set_flags)
+    {
+        switch (opcode)
+        {
+            case 0x2:
+            case 0x3:
+            case 0xA:
+                emit_arith_flags(true);
+                break;
+            case 0x4:
+            case 0xB:
+                emit_arith_flags(false);
+                break;
+            default:
+                emit_logical_flags(result);
+                break;
+        }
+    }
+
+    if (skip)
+        emitter.set_jump_dest(skip, emitter.get_code_pos());
+    return true;
+}
+
+void ARM_JIT::emit_arm_branch(uint32_t instr, uint32_t pc, int index)
+{
+    int32_t offset = (instr & 0xFFFFFF) << 2;
+
+    //Sign extend 26-bit offset
+    offset <<= 6;
+    offset >>= 6;
+
+    uint32_t target = pc + 8 + offset;
+
+    uint8_t* skip = emit_cond_check(instr >> 28);
+    if (instr & (1 << 24))
+        emitter.mov32_mem_imm(REG_RBX, reg_offset(REG_LR), pc + 4);
+    emitter.mov32_mem_imm(REG_RBX, reg_offset(REG_PC), (target & ~0x3) + 4);
+    emit_exit(index + 1);
+
+    if (skip)
+        emitter.set_jump_dest(skip, emitter.get_code_pos());
+}
+
+bool ARM_JIT::emit_thumb_instr(uint16_t instr, uint32_t pc, int index)
+{
+    switch (decode_thumb(instr))
+    {
+        case THUMB_ADD_REG:
+        case THUMB_SUB_REG:
+        {
+            int destination = instr & 0x7;
+            int source = (instr >> 3) & 0x7;
+            int operand = (instr >> 6) & 0x7;
+            bool is_sub = decode_thumb(instr) == THUMB_SUB_REG;
+
+            emitter.mov32_reg_mem(REG_RAX, REG_RBX, reg_offset(source));
+            if (instr & (1 << 10))
+                emitter.mov32_reg_imm(REG_RCX, operand);
+            else
+                emitter.mov32_reg_mem(REG_RCX, REG_RBX, reg_offset(operand));
+
+            if (is_sub)
+                emitter.sub32_reg_reg(REG_RAX, REG_RCX);
+            else
+                emitter.add32_reg_reg(REG_RAX, REG_RCX);
+            emitter.mov32_mem_reg(REG_RBX, reg_offset(destination), REG_RAX);
+            emit_arith_flags(is_sub);
+            return false;
+        }
+        case THUMB_MOV_IMM:
+        {
+            int reg = (instr >> 8) & 0x7;
+            emitter.mov32_reg_imm(REG_RAX, instr & 0xFF);
+            emitter.mov32_mem_reg(REG_RBX, reg_offset(reg), REG_RAX);
+            emit_logical_flags(REG_RAX);
+            return false;
+        }
+        case THUMB_CMP_IMM:
+        case THUMB_ADD_IMM:
+        case THUMB_SUB_IMM:
+        {
+            int reg = (instr >> 8) & 0x7;
+            THUMB_INSTR op = decode_thumb(instr);
+
+            emitter.mov32_reg_mem(REG_RAX, REG_RBX, reg_offset(reg));
+            emitter.mov32_reg_imm(REG_RCX, instr & 0xFF);
+            if (op == THUMB_ADD_IMM)
+                emitter.add32_reg_reg(REG_RAX, REG_RCX);
+            else if (op == THUMB_SUB_IMM)
+                emitter.sub32_reg_reg(REG_RAX, REG_RCX);
+            else
+                emitter.cmp32_reg_reg(REG_RAX, REG_RCX);
+
+            if (op != THUMB_CMP_IMM)
+                emitter.mov32_mem_reg(REG_RBX, reg_offset(reg), REG_RAX);
+            emit_arith_flags(op != THUMB_ADD_IMM);
+            return false;
+        }
+        case THUMB_ALU_OP:
+            if (emit_thumb_alu(instr))
+                return false;
+            break;
+        case THUMB_BRANCH:
+            emit_thumb_branch(instr, pc, index);
+            return true;
+        case THUMB_COND_BRANCH:
+            if (((instr >> 8) & 0xF) < 0xE)
+            {
+                emit_thumb_branch(instr, pc, index);
+                return true;
+            }
+            break;
+        default:
+            break;
+    }
+
+    emit_fallback(instr, pc, index, true);
+    return is_thumb_block_end(instr);
+}
+
+bool ARM_JIT::emit_thumb_alu(uint16_t instr)
+{
+    int destination = instr & 0x7;
+    int source = (instr >> 3) & 0x7;
+    int opcode = (instr >> 6) & 0xF;
+
+    //Shifts, ADC/SBC, and MUL go through the interpreter
+    switch (opcode)
+    {
+        case 0x0:
+        case 0x1:
+        case 0x8:
+        case 0x9:
+        case 0xA:
+        case 0xB:
+        case 0xC:
+        case 0xE:
+        case 0xF:
+            break;
+        default:
+            return false;
+    }
+
+    emitter.mov32_reg_mem(REG_RAX, REG_RBX, reg_offset(destination));
+    emitter.mov32_reg_mem(REG_RCX, REG_RBX, reg_offset(source));
+
+    X64_REG result = REG_RAX;
+    switch (opcode)
+    {
+        case 0x0:
+        case 0x8:
+            emitter.and32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0x1:
+            emitter.xor32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0x9:
+            //NEG is the same thing as RSBS Rd, Rs, #0
+            emitter.xor32_reg_reg(REG_RAX, REG_RAX);
+            emitter.sub32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xA:
+            emitter.cmp32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xB:
+            emitter.add32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xC:
+            emitter.or32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xE:
+            emitter.not32(REG_RCX);
+            emitter.and32_reg_reg(REG_RAX, REG_RCX);
+            break;
+        case 0xF:
+            emitter.not32(REG_RCX);
+            result = REG_RCX;
+            break;
+    }
+
+    if (opcode != 0x8 && opcode != 0xA && opcode != 0xB)
+        emitter.mov32_mem_reg(REG_RBX, reg_offset(destination), result);
+
+    switch (opcode)
+    {
+        case 0x9:
+        case 0xA:
+            emit_arith_flags(true);
+            break;
+        case 0xB:
+            emit_arith_flags(false);
+            break;
+        default:
+            emit_logical_flags(result);
+            break;
+    }
+    return true;
+}
+
+void ARM_JIT::emit_thumb_branch(uint16_t instr, uint32_t pc, int index)
+{
+    uint8_t* skip = nullptr;
+    int32_t offset;
+    if (decode_thumb(instr) == THUMB_COND_BRANCH)
+    {
+        skip = emit_cond_check((instr >> 8) & 0xF);
+        offset = static_cast<int8_t>(instr & 0xFF) << 1;
+    }
+    else
+    {
+        //Sign extend 12-bit offset
+        offset = (instr & 0x7FF) << 1;
+        offset <<= 20;
+        offset >>= 20;
+    }
+
+    uint32_t target = pc + 4 + offset;
+    emitter.mov32_mem_imm(REG_RBX, reg_offset(REG_PC), (target & ~0x1) + 2);
+    emit_exit(index + 1);
+
+    if (skip)
+        emitter.set_jump_dest(skip, emitter.get_code_pos());
+}
+
+int ARM_JIT::fallback_arm(ARM_CPU *cpu, uint32_t instr, uint32_t pc)
+{
+    ARM_JIT* jit = static_cast<ARM_JIT*>(cpu->code_cache);
+    try
+    {
+        ARM_Interpreter::interpret_arm(*cpu, instr);
+    }
+    catch (...)
+    {
+        jit->pending_exception = std::current_exception();
+        return 1;
+    }
+
+    cpu->CPSR.resolve_flags();
+
+    if (cpu->data_abort_pending)
+    {
+        cpu->take_data_abort();
+        return 1;
+    }
+
+    //Leave the block if it may have just overwritten itself
+    if (jit->code_invalidated)
+    {
+        jit->code_invalidated = false;
+        return 1;
+    }
+    return cpu->gpr[15] != pc || cpu->halted;
+}
+
+int ARM_JIT::fallback_thumb(ARM_CPU *cpu, uint32_t instr, uint32_t pc)
+{
+    ARM_JIT* jit = static_cast<ARM_JIT*>(cpu->code_cache);
+    try
+    {
+        ARM_Interpreter::interpret_thumb(*cpu, instr & 0xFFFF);
+    }
+    catch (...)
+    {
+        jit->pending_exception = std::current_exception();
+        return 1;
+    }
+
+    cpu->CPSR.resolve_flags();
+
+    if (cpu->data_abort_pending)
+    {
+        cpu->take_data_abort();
+        return 1;
+    }
+
+    if (jit->code_invalidated)
+    {
+        jit->code_invalidated = false;
+        return 1;
+    }
+    return cpu->gpr[15] != pc || cpu->halted;
+}
+
+int ARM_JIT::check_condition(ARM_CPU *cpu, int cond)
+{
+    return cpu->meets_condition(cond);
+}
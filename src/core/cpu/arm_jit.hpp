@@ -0,0 +1,90 @@
+#ifndef ARM_JIT_HPP
+#define ARM_JIT_HPP
+#include <cstdint>
+#include <exception>
+#include <unordered_map>
+#include <vector>
+#include "arm_code_cache.hpp"
+#include "x64_emitter.hpp"
+
+typedef void (*JitBlockFunc)(ARM_CPU* cpu);
+
+struct JitBlock
+{
+    uint32_t vaddr;
+    JitBlockFunc code;
+};
+
+struct JitLookupEntry
+{
+    //Virtual address of the block, with bit 0 set for Thumb blocks
+    uint32_t tag;
+    JitBlockFunc code;
+};
+
+/***
+ * Dynamic recompiler translating guest ARM/Thumb basic blocks into x86-64 code.
+ *
+ * Only simple ALU operations and branches are translated natively. Everything else is handed to ARM_Interpreter
+ * through a call from the generated code, which keeps the JIT exactly as accurate as the interpreter.
+***/
+class ARM_JIT : public ARM_CodeCache
+{
+    private:
+        constexpr static uint64_t CODE_BUFFER_SIZE = 1024 * 1024 * 32;
+        constexpr static uint64_t MAX_BLOCK_SIZE = 1024 * 16;
+
+        uint8_t* code_buffer;
+        uint8_t* code_pos;
+        X64Emitter emitter;
+
+        std::unordered_map<uint64_t, JitBlock> blocks;
+        JitLookupEntry* lookup;
+
+        //Exceptions thrown by the interpreter can't unwind through generated code.
+        //They are caught at the call boundary and rethrown by the dispatcher once the block has returned.
+        std::exception_ptr pending_exception;
+
+        //Offsets into ARM_CPU used by generated code
+        int32_t gpr_offset;
+        int32_t negative_offset, zero_offset, carry_offset, overflow_offset;
+        int32_t cycles_offset;
+
+        std::vector<uint8_t*> exit_jumps;
+
+        JitBlockFunc get_block(ARM_CPU& cpu, uint32_t pc, bool thumb);
+        JitBlockFunc compile_block(ARM_CPU& cpu, uint32_t pc, uint8_t* page, bool thumb);
+        void unlink_block(uint64_t key, const JitBlock& block);
+        int32_t reg_offset(int id);
+
+        void emit_exit(int instrs_ran);
+        uint8_t* emit_cond_check(int cond);
+        void emit_arith_flags(bool is_sub);
+        void emit_logical_flags(X64_REG result);
+        void emit_fallback(uint32_t instr, uint32_t pc, int index, bool thumb);
+
+        bool emit_arm_instr(uint32_t instr, uint32_t pc, int index);
+        bool emit_arm_data_processing(uint32_t instr);
+        void emit_arm_branch(uint32_t instr, uint32_t pc, int index);
+
+        bool emit_thumb_instr(uint16_t instr, uint32_t pc, int index);
+        bool emit_thumb_alu(uint16_t instr);
+        void emit_thumb_branch(uint16_t instr, uint32_t pc, int index);
+
+        static int fallback_arm(ARM_CPU* cpu, uint32_t instr, uint32_t pc);
+        static int fallback_thumb(ARM_CPU* cpu, uint32_t instr, uint32_t pc);
+        static int check_condition(ARM_CPU* cpu, int cond);
+    public:
+        ARM_JIT();
+        ~ARM_JIT();
+
+        void reset();
+        void run(ARM_CPU& cpu, int cycles);
+
+        void flush_lookup(ARM_CPU& cpu);
+        void flush_all_lookups();
+
+        void invalidate_code_page(uint8_t* page);
+};
+
+#endif // ARM_JIT_HPP
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include "arm.hpp"
+#include "arm_thread_pool.hpp"
+
+ARM_ThreadPool::ARM_ThreadPool() : cores(nullptr), core_count(0), quantum_id(0), cores_running(0), quit(false)
+{
+
+}
+
+ARM_ThreadPool::~ARM_ThreadPool()
+{
+    stop();
+}
+
+void ARM_ThreadPool::start(ARM_CPU *cores, int core_count)
+{
+    stop();
+
+    this->cores = cores;
+    this->core_count = core_count;
+    errors.assign(core_count, nullptr);
+    quit.store(false);
+
+    uint64_t id = quantum_id.load();
+    for (int i = 1; i < core_count; i++)
+        workers.emplace_back(&ARM_ThreadPool::worker_loop, this, i, id);
+}
+
+void ARM_ThreadPool::stop()
+{
+    quit.store(true);
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void ARM_ThreadPool::run(int cycles)
+{
+    this->cycles = cycles;
+    cores_running.store(core_count - 1, std::memory_order_relaxed);
+    ARM_CPU::parallel_quantum = true;
+    quantum_id.fetch_add(1, std::memory_order_release);
+
+    try
+    {
+        cores[0].run(cycles);
+    }
+    catch (...)
+    {
+        errors[0] = std::current_exception();
+    }
+
+    int spins = 0;
+    while (cores_running.load(std::memory_order_acquire))
+    {
+        if (++spins > SPINS_BEFORE_YIELD)
+            std::this_thread::yield();
+    }
+
+    ARM_CPU::parallel_quantum = false;
+
+    //Apply in core order so the result doesn't depend on which thread got there first
+    for (int i = 0; i < core_count; i++)
+        cores[i].apply_deferred_signals();
+
+    //Each core only writes its own slot, and the workers are done with them by now
+    for (int i = 0; i < core_count; i++)
+    {
+        if (errors[i])
+        {
+            std::exception_ptr error = errors[i];
+            std::fill(errors.begin(), errors.end(), nullptr);
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+void ARM_ThreadPool::worker_loop(int core, uint64_t last_quantum)
+{
+    while (true)
+    {
+        int spins = 0;
+        uint64_t id;
+        while ((id = quantum_id.load(std::memory_order_acquire)) == last_quantum)
+        {
+            if (quit.load(std::memory_order_relaxed))
+                return;
+            if (++spins > SPINS_BEFORE_YIELD)
+                std::this_thread::yield();
+        }
+        last_quantum = id;
+
+        try
+        {
+            cores[core].run(cycles);
+        }
+        catch (...)
+        {
+            errors[core] = std::current_exception();
+        }
+        cores_running.fetch_sub(1, std::memory_order_release);
+    }
+}
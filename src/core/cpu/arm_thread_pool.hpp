@@ -0,0 +1,52 @@
+#ifndef ARM_THREAD_POOL_HPP
+#define ARM_THREAD_POOL_HPP
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+class ARM_CPU;
+
+/***
+ * Runs the ARM11 cores on their own host threads in lock-step quanta.
+ *
+ * The calling thread runs core 0 and each other core gets a worker. run() starts every core on the same cycle count
+ * and returns once all of them have finished, which acts as the barrier between quanta. Anything a core does to
+ * another core during the quantum (IRQ lines, SEV) is held by the target and applied here, after the barrier.
+ * An exception thrown by any core is passed on to the caller of run() once the quantum is over.
+ *
+ * Quanta are only a few hundred cycles long, so the workers spin on the quantum counter rather than sleeping.
+***/
+class ARM_ThreadPool
+{
+    private:
+        constexpr static int SPINS_BEFORE_YIELD = 4096;
+
+        std::vector<std::thread> workers;
+        std::vector<std::exception_ptr> errors;
+        ARM_CPU* cores;
+        int core_count;
+
+        std::atomic<uint64_t> quantum_id;
+        std::atomic<int> cores_running;
+        std::atomic<bool> quit;
+        int cycles;
+
+        void worker_loop(int core, uint64_t last_quantum);
+    public:
+        ARM_ThreadPool();
+        ~ARM_ThreadPool();
+
+        void start(ARM_CPU* cores, int core_count);
+        void stop();
+        bool is_running();
+        void run(int cycles);
+};
+
+inline bool ARM_ThreadPool::is_running()
+{
+    return !workers.empty();
+}
+
+#endif // ARM_THREAD_POOL_HPP
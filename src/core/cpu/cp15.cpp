@@ -48,7 +48,7 @@ void CP15::reload_tlb(uint32_t addr)
     }
 }
 
-uint8_t** CP15::get_tlb_mapping()
+PageMap* CP15::get_tlb_mapping()
 {
     if (!mmu_enabled)
         return mmu->get_direct_mapping();
@@ -154,7 +154,7 @@ uint32_t CP15::mrc(int operation_mode, int CP_reg, int coprocessor_info, int cop
         case 0xD04:
             return thread_regs[op - 0xD02];
         default:
-            printf("[CP15_%d] Unrecognized MRC op $%04X\n", id, op);
+            LOG(LOG_MMU, LOG_WARN, "[CP15_%d] Unrecognized MRC op $%04X\n", id, op);
     }
     return 0;
 }
@@ -231,7 +231,7 @@ void CP15::mcr(int operation_mode, int CP_reg, int coprocessor_info, int coproce
         case 0x870:
             if (id != 9)
             {
-                printf("[CP15_%d] TLB invalidate\n", id);
+                LOG(LOG_MMU, LOG_TRACE, "[CP15_%d] TLB invalidate\n", id);
                 mmu->invalidate_tlb();
             }
             break;
@@ -240,7 +240,7 @@ void CP15::mcr(int operation_mode, int CP_reg, int coprocessor_info, int coproce
         case 0x871:
             if (id != 9)
             {
-                printf("[CP15_%d] TLB invalidate by addr: $%08X\n", id, value);
+                LOG(LOG_MMU, LOG_TRACE, "[CP15_%d] TLB invalidate by addr: $%08X\n", id, value);
                 mmu->invalidate_tlb_by_addr(value);
             }
             break;
@@ -249,11 +249,8 @@ void CP15::mcr(int operation_mode, int CP_reg, int coprocessor_info, int coproce
         case 0x872:
             if (id != 9)
             {
-                printf("[CP15_%d] TLB invalidate by ASID: $%08X\n", id, value);
-
-                //Bit of a hack. We can assume that nonglobal entries only exist in table 0
-                mmu->invalidate_tlb_by_table(0);
-                //mmu->invalidate_tlb_by_asid(value & 0xFF);
+                LOG(LOG_MMU, LOG_TRACE, "[CP15_%d] TLB invalidate by ASID: $%08X\n", id, value);
+                mmu->invalidate_tlb_by_asid(value & 0xFF);
             }
             break;
         case 0x853:
@@ -261,7 +258,7 @@ void CP15::mcr(int operation_mode, int CP_reg, int coprocessor_info, int coproce
         case 0x873:
             if (id != 9)
             {
-                printf("[CP15_%d] TLB invalidate by MVA: $%08X\n", id, value);
+                LOG(LOG_MMU, LOG_TRACE, "[CP15_%d] TLB invalidate by MVA: $%08X\n", id, value);
 
                 mmu->invalidate_tlb_by_addr(value);
             }
@@ -294,6 +291,6 @@ void CP15::mcr(int operation_mode, int CP_reg, int coprocessor_info, int coproce
         case 0xF30:
             break;
         default:
-            printf("[CP15_%d] Unrecognized MCR op $%04X ($%08X)\n", id, op, value);
+            LOG(LOG_MMU, LOG_WARN, "[CP15_%d] Unrecognized MCR op $%04X ($%08X)\n", id, op, value);
     }
 }
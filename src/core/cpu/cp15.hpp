@@ -4,6 +4,7 @@
 
 class ARM_CPU;
 class MMU;
+class PageMap;
 
 class CP15
 {
@@ -33,7 +34,7 @@ class CP15
         void reset(bool has_tcm);
         void reload_tlb(uint32_t addr);
 
-        uint8_t** get_tlb_mapping();
+        PageMap* get_tlb_mapping();
 
         bool has_high_exceptions();
 
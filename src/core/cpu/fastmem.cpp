@@ -0,0 +1,275 @@
+#include <cstdio>
+#include "fastmem.hpp"
+
+#ifdef FASTMEM_SUPPORTED
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+//Each stub must fault on its first instruction, before anything is pushed, for the tail call trick to work
+asm(
+    ".text\n"
+    ".globl fastmem_read8\n"
+    ".type fastmem_read8, @function\n"
+    "fastmem_read8:\n"
+    "    movzbl (%rdi,%rsi), %eax\n"
+    "    ret\n"
+    ".globl fastmem_read16\n"
+    ".type fastmem_read16, @function\n"
+    "fastmem_read16:\n"
+    "    movzwl (%rdi,%rsi), %eax\n"
+    "    ret\n"
+    ".globl fastmem_read32\n"
+    ".type fastmem_read32, @function\n"
+    "fastmem_read32:\n"
+    "    movl (%rdi,%rsi), %eax\n"
+    "    ret\n"
+    ".globl fastmem_write8\n"
+    ".type fastmem_write8, @function\n"
+    "fastmem_write8:\n"
+    "    movb %dl, (%rdi,%rsi)\n"
+    "    ret\n"
+    ".globl fastmem_write16\n"
+    ".type fastmem_write16, @function\n"
+    "fastmem_write16:\n"
+    "    movw %dx, (%rdi,%rsi)\n"
+    "    ret\n"
+    ".globl fastmem_write32\n"
+    ".type fastmem_write32, @function\n"
+    "fastmem_write32:\n"
+    "    movl %edx, (%rdi,%rsi)\n"
+    "    ret\n"
+);
+
+struct FastmemStub
+{
+    uint64_t stub;
+    uint64_t fault;
+};
+
+static const FastmemStub stubs[] =
+{
+    {(uint64_t)fastmem_read8, (uint64_t)fastmem_read8_fault},
+    {(uint64_t)fastmem_read16, (uint64_t)fastmem_read16_fault},
+    {(uint64_t)fastmem_read32, (uint64_t)fastmem_read32_fault},
+    {(uint64_t)fastmem_write8, (uint64_t)fastmem_write8_fault},
+    {(uint64_t)fastmem_write16, (uint64_t)fastmem_write16_fault},
+    {(uint64_t)fastmem_write32, (uint64_t)fastmem_write32_fault}
+};
+
+static struct sigaction old_segv_action;
+
+static void fastmem_segv_handler(int, siginfo_t*, void* raw_context)
+{
+    ucontext_t* context = (ucontext_t*)raw_context;
+    greg_t& rip = context->uc_mcontext.gregs[REG_RIP];
+    for (const FastmemStub& stub : stubs)
+    {
+        if ((uint64_t)rip == stub.stub)
+        {
+            rip = stub.fault;
+            return;
+        }
+    }
+
+    //Not a fastmem access. Put the old handler back so the access faults again into it.
+    sigaction(SIGSEGV, &old_segv_action, nullptr);
+}
+
+bool install_fastmem_handler()
+{
+    static bool installed = false;
+    if (installed)
+        return true;
+
+    struct sigaction action = {};
+    action.sa_sigaction = fastmem_segv_handler;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGSEGV, &action, &old_segv_action) != 0)
+        return false;
+    installed = true;
+    return true;
+}
+
+FastmemRAM::~FastmemRAM()
+{
+    while (blocks.size())
+        free(blocks.back().mem);
+}
+
+uint8_t* FastmemRAM::alloc(uint64_t size)
+{
+    int fd = memfd_create("corgi3ds_ram", 0);
+    if (fd < 0 || ftruncate(fd, size) != 0)
+    {
+        if (fd >= 0)
+            close(fd);
+        return new uint8_t[size];
+    }
+
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED)
+    {
+        close(fd);
+        return new uint8_t[size];
+    }
+
+    blocks.push_back({(uint8_t*)mem, size, fd});
+    return (uint8_t*)mem;
+}
+
+void FastmemRAM::free(uint8_t *mem)
+{
+    if (!mem)
+        return;
+
+    for (auto it = blocks.begin(); it != blocks.end(); it++)
+    {
+        if (it->mem == mem)
+        {
+            munmap(it->mem, it->size);
+            close(it->fd);
+            blocks.erase(it);
+            return;
+        }
+    }
+
+    //Allocation fell back to the heap
+    delete[] mem;
+}
+
+bool FastmemRAM::find(uint8_t *ptr, int &fd, uint64_t &offset)
+{
+    for (Block& block : blocks)
+    {
+        if (ptr >= block.mem && ptr < block.mem + block.size)
+        {
+            fd = block.fd;
+            offset = ptr - block.mem;
+            return true;
+        }
+    }
+    return false;
+}
+
+FastmemSpace::FastmemSpace() : ram(nullptr), base(nullptr)
+{
+
+}
+
+FastmemSpace::~FastmemSpace()
+{
+    shutdown();
+}
+
+bool FastmemSpace::init(FastmemRAM *ram)
+{
+    if (base)
+        return true;
+
+    if (!install_fastmem_handler())
+        return false;
+
+    void* mem = mmap(nullptr, SPACE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED)
+        return false;
+
+    this->ram = ram;
+    base = (uint8_t*)mem;
+    return true;
+}
+
+void FastmemSpace::shutdown()
+{
+    if (base)
+        munmap(base, SPACE_SIZE);
+    base = nullptr;
+}
+
+void FastmemSpace::map_page(uint32_t vaddr, uint8_t *host_page, bool writable)
+{
+    int fd;
+    uint64_t offset;
+    if (!ram->find(host_page, fd, offset))
+        return;
+
+    int prot = PROT_READ;
+    if (writable)
+        prot |= PROT_WRITE;
+    mmap(base + vaddr, 4096, prot, MAP_SHARED | MAP_FIXED, fd, offset);
+}
+
+void FastmemSpace::unmap(uint32_t vaddr, uint64_t size)
+{
+    mmap(base + vaddr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+}
+
+void FastmemSpace::unmap_all()
+{
+    unmap(0, SPACE_SIZE);
+}
+
+#else
+
+bool install_fastmem_handler()
+{
+    return false;
+}
+
+FastmemRAM::~FastmemRAM()
+{
+
+}
+
+uint8_t* FastmemRAM::alloc(uint64_t size)
+{
+    return new uint8_t[size];
+}
+
+void FastmemRAM::free(uint8_t *mem)
+{
+    delete[] mem;
+}
+
+bool FastmemRAM::find(uint8_t*, int&, uint64_t&)
+{
+    return false;
+}
+
+FastmemSpace::FastmemSpace() : ram(nullptr), base(nullptr)
+{
+
+}
+
+FastmemSpace::~FastmemSpace()
+{
+
+}
+
+bool FastmemSpace::init(FastmemRAM*)
+{
+    return false;
+}
+
+void FastmemSpace::shutdown()
+{
+
+}
+
+void FastmemSpace::map_page(uint32_t, uint8_t*, bool)
+{
+
+}
+
+void FastmemSpace::unmap(uint32_t, uint64_t)
+{
+
+}
+
+void FastmemSpace::unmap_all()
+{
+
+}
+
+#endif
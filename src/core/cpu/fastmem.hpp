@@ -0,0 +1,90 @@
+#ifndef FASTMEM_HPP
+#define FASTMEM_HPP
+#include <cstdint>
+#include <vector>
+
+#if defined(__linux__) && defined(__x86_64__)
+#define FASTMEM_SUPPORTED
+#endif
+
+class ARM_CPU;
+
+/***
+ * Fastmem turns guest loads and stores into plain host loads and stores.
+ *
+ * Guest RAM is allocated from memfds (FastmemRAM), so the same memory can be mapped a second time into a 4 GB host
+ * reservation mirroring a core's virtual address space (FastmemSpace). Pages are filled in lazily: the first access
+ * to a page faults, the fault is redirected to the normal TLB path, and that path maps the page if it is plain RAM.
+ * MMIO and unmapped pages are never mapped, so accesses to them keep going through the slow path.
+ * The MMU unmaps any range whose translation changes.
+ *
+ * Accesses go through the fastmem_* stubs, each a single load or store followed by ret. When one faults, the signal
+ * handler points RIP at the matching fastmem_*_fault function. That function takes the same arguments, and nothing
+ * has been pushed yet, so the stub simply becomes a tail call to it.
+***/
+
+class FastmemRAM
+{
+    private:
+        struct Block
+        {
+            uint8_t* mem;
+            uint64_t size;
+            int fd;
+        };
+
+        std::vector<Block> blocks;
+    public:
+        ~FastmemRAM();
+
+        uint8_t* alloc(uint64_t size);
+        void free(uint8_t* mem);
+        bool find(uint8_t* ptr, int& fd, uint64_t& offset);
+};
+
+class FastmemSpace
+{
+    private:
+        FastmemRAM* ram;
+        uint8_t* base;
+    public:
+        constexpr static uint64_t SPACE_SIZE = 1ULL << 32ULL;
+
+        FastmemSpace();
+        ~FastmemSpace();
+
+        bool init(FastmemRAM* ram);
+        void shutdown();
+        uint8_t* get_base();
+
+        void map_page(uint32_t vaddr, uint8_t* host_page, bool writable);
+        void unmap(uint32_t vaddr, uint64_t size);
+        void unmap_all();
+};
+
+inline uint8_t* FastmemSpace::get_base()
+{
+    return base;
+}
+
+bool install_fastmem_handler();
+
+extern "C"
+{
+    uint8_t fastmem_read8(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+    uint16_t fastmem_read16(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+    uint32_t fastmem_read32(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+    void fastmem_write8(uint8_t* base, uint64_t addr, uint8_t value, ARM_CPU* cpu);
+    void fastmem_write16(uint8_t* base, uint64_t addr, uint16_t value, ARM_CPU* cpu);
+    void fastmem_write32(uint8_t* base, uint64_t addr, uint32_t value, ARM_CPU* cpu);
+
+    //Defined by ARM_CPU. These run the access through the TLB and map the page if they can.
+    uint8_t fastmem_read8_fault(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+    uint16_t fastmem_read16_fault(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+    uint32_t fastmem_read32_fault(uint8_t* base, uint64_t addr, ARM_CPU* cpu);
+    void fastmem_write8_fault(uint8_t* base, uint64_t addr, uint8_t value, ARM_CPU* cpu);
+    void fastmem_write16_fault(uint8_t* base, uint64_t addr, uint16_t value, ARM_CPU* cpu);
+    void fastmem_write32_fault(uint8_t* base, uint64_t addr, uint32_t value, ARM_CPU* cpu);
+}
+
+#endif // FASTMEM_HPP
@@ -1,50 +1,43 @@
 #include <cstring>
 #include <cstdio>
+#include "../common/log.hpp"
 #include "mmu.hpp"
 
 MMU::MMU()
 {
-    user_mapping = nullptr;
-    privileged_mapping = nullptr;
-    direct_mapping = nullptr;
+    fastmem = nullptr;
 }
 
 MMU::~MMU()
 {
-    delete[] user_mapping;
-    delete[] privileged_mapping;
-    delete[] direct_mapping;
+
 }
 
 void MMU::reset()
 {
-    if (!user_mapping)
-        user_mapping = new uint8_t*[1024 * 1024];
-    if (!privileged_mapping)
-        privileged_mapping = new uint8_t*[1024 * 1024];
-    if (!direct_mapping)
-        direct_mapping = new uint8_t*[1024 * 1024];
-
     whole_tlb_invalidated = true;
 
     domain_control = 0;
 
-    memset(user_mapping, 0, 1024 * 1024 * sizeof(uint8_t*));
-    memset(privileged_mapping, 0, 1024 * 1024 * sizeof(uint8_t*));
-
-    for (uint64_t i = 0; i < 1024 * 1024; i++)
-    {
-        uint64_t addr = i * 4096;
-        addr |= 0xFULL << 60ULL;
-        direct_mapping[i] = (uint8_t*)addr;
-    }
+    user_mapping.reset(PageMap::LEAF_UNMAPPED);
+    privileged_mapping.reset(PageMap::LEAF_UNMAPPED);
+    direct_mapping.reset(PageMap::LEAF_MMIO);
 
     l1_table_base[0] = 0;
     l1_table_base[1] = 0;
     set_l1_table_control(0);
     asid = 0;
 
+    global_entries.clear();
+    for (int i = 0; i < 256; i++)
+        asid_entries[i].clear();
+    memset(asid_generation, 0, sizeof(asid_generation));
+    tlb_generation = 1;
+    reset_tlb_stats();
+
     memset(pu_regions, 0, sizeof(pu_regions));
+
+    unmap_fastmem(0, 1ULL << 32ULL);
 }
 
 void MMU::add_physical_mapping(uint8_t *mem, uint32_t base, uint32_t size)
@@ -57,9 +50,12 @@ void MMU::add_physical_mapping(uint8_t *mem, uint32_t base, uint32_t size)
     size /= 4096;
     for (unsigned int i = base; i < base + size; i++)
     {
-        direct_mapping[i] = (uint8_t*)addr;
+        direct_mapping.set(i, (uint8_t*)addr);
         addr += 4096;
     }
+
+    //Virtual pages anywhere may point at this range
+    unmap_fastmem(0, 1ULL << 32ULL);
 }
 
 void MMU::remove_physical_mapping(uint32_t base, uint32_t size)
@@ -67,59 +63,159 @@ void MMU::remove_physical_mapping(uint32_t base, uint32_t size)
     base /= 4096;
     size /= 4096;
 
-    for (unsigned int i = base; i < base + size; i++)
-    {
-        uint64_t addr = i * 4096;
-        addr |= 0xFULL << 60ULL;
-        direct_mapping[i] = (uint8_t*)addr;
-    }
+    //Back to MMIO at the same address
+    direct_mapping.fill(base, size, (uint8_t*)(0xFULL << 60ULL));
+
+    unmap_fastmem(0, 1ULL << 32ULL);
 }
 
-uint8_t** MMU::get_direct_mapping()
+PageMap* MMU::get_direct_mapping()
 {
-    return direct_mapping;
+    return &direct_mapping;
 }
 
-uint8_t** MMU::get_privileged_mapping()
+PageMap* MMU::get_privileged_mapping()
 {
-    return privileged_mapping;
+    return &privileged_mapping;
 }
 
-uint8_t** MMU::get_user_mapping()
+PageMap* MMU::get_user_mapping()
 {
-    return user_mapping;
+    return &user_mapping;
 }
 
 void MMU::invalidate_tlb()
 {
     whole_tlb_invalidated = true;
-    memset(privileged_mapping, 0, 1024 * 1024 * sizeof(uint8_t*));
-    memset(user_mapping, 0, 1024 * 1024 * sizeof(uint8_t*));
+
+    //Only the global entries and the current ASID's are in the mapping. Every other ASID goes stale.
+    clear_tlb_entries(global_entries);
+    clear_tlb_entries(get_asid_entries(asid));
+    tlb_generation++;
+    asid_generation[asid] = tlb_generation;
+    tlb_stats.flushes++;
 }
 
-void MMU::invalidate_tlb_by_table(int index)
+void MMU::invalidate_tlb_by_asid(uint8_t asid)
 {
-    uint32_t start = 0;
-    uint32_t size = 0;
-    uint32_t cutoff = l1_table_cutoff * 64;
-    if (index == 0)
-        size = cutoff;
+    std::vector<TLB_Entry>& entries = get_asid_entries(asid);
+    if (asid == this->asid)
+        clear_tlb_entries(entries);
     else
+        entries.clear();
+}
+
+void MMU::invalidate_tlb_by_addr(uint32_t value)
+{
+    uint32_t addr = value / 4096;
+
+    privileged_mapping.set(addr, nullptr);
+    user_mapping.set(addr, nullptr);
+    unmap_fastmem(addr * 4096, 4096);
+
+    //The ASID in the low bits is ignored, so this drops the page from every ASID
+    forget_tlb_range(global_entries, addr, 1, true);
+    forget_tlb_range(get_asid_entries(asid), addr, 1, true);
+    for (int i = 0; i < 256; i++)
+    {
+        if (i != asid && asid_generation[i] == tlb_generation)
+            forget_tlb_range(asid_entries[i], addr, 1, false);
+    }
+}
+
+std::vector<TLB_Entry>& MMU::get_asid_entries(uint8_t asid)
+{
+    if (asid_generation[asid] != tlb_generation)
     {
-        start = cutoff;
-        size = (1024 * 1024) - cutoff;
+        asid_entries[asid].clear();
+        asid_generation[asid] = tlb_generation;
     }
+    return asid_entries[asid];
+}
+
+void MMU::add_tlb_entry(const TLB_Entry &entry, bool global)
+{
+    std::vector<TLB_Entry>& entries = global ? global_entries : get_asid_entries(asid);
 
-    memset(privileged_mapping + start, 0, size * sizeof(uint8_t*));
-    memset(user_mapping + start, 0, size * sizeof(uint8_t*));
+    //Consecutive pages of an L2 table usually continue each other
+    if (entries.size())
+    {
+        TLB_Entry& last = entries.back();
+        if (last.base + last.size == entry.base && last.paddr + last.size == entry.paddr &&
+                last.apx == entry.apx && last.exec_never == entry.exec_never)
+        {
+            last.size += entry.size;
+            return;
+        }
+    }
+
+    //Like a real TLB running out of space, throw everything out
+    if (entries.size() >= MAX_TLB_ENTRIES)
+        clear_tlb_entries(entries);
+
+    entries.push_back(entry);
 }
 
-void MMU::invalidate_tlb_by_addr(uint32_t value)
+void MMU::fill_tlb_entry(const TLB_Entry &entry)
 {
-    uint32_t addr = value / 4096;
+    unmap_fastmem(entry.base * 4096, (uint64_t)entry.size * 4096);
+
+    uint64_t priv_perm = get_privileged_apx_perms(entry.apx);
+    if (entry.exec_never)
+        priv_perm &= ~0x1;
+
+    priv_perm <<= 60ULL;
+
+    for (unsigned int i = 0; i < entry.size; i++)
+    {
+        uint64_t mapping = (uint64_t)direct_mapping.get(entry.paddr + i);
+
+        if (mapping & (1ULL << 63ULL))
+        {
+            //MMIO offsets are relative to the physical page here, and need to be relative to the virtual page
+            uint32_t paddr = (uint32_t)mapping + (entry.paddr + i) * 4096;
+            mapping = (1ULL << 63ULL) | (uint32_t)(paddr - (entry.base + i) * 4096);
+        }
+        else
+        {
+            //Strip permission bits off
+            mapping &= ~(0x7ULL << 60ULL);
+        }
+
+        privileged_mapping.set(entry.base + i, (uint8_t*)(mapping | priv_perm));
+    }
+}
 
-    privileged_mapping[addr] = nullptr;
-    user_mapping[addr] = nullptr;
+void MMU::clear_tlb_entry(const TLB_Entry &entry)
+{
+    privileged_mapping.fill(entry.base, entry.size, nullptr);
+    user_mapping.fill(entry.base, entry.size, nullptr);
+    unmap_fastmem(entry.base * 4096, (uint64_t)entry.size * 4096);
+}
+
+void MMU::clear_tlb_entries(std::vector<TLB_Entry> &entries)
+{
+    for (TLB_Entry& entry : entries)
+        clear_tlb_entry(entry);
+    entries.clear();
+}
+
+void MMU::forget_tlb_range(std::vector<TLB_Entry> &entries, uint32_t base, uint32_t size, bool in_mapping)
+{
+    unsigned int i = 0;
+    while (i < entries.size())
+    {
+        TLB_Entry& entry = entries[i];
+        if (entry.base < base + size && base < entry.base + entry.size)
+        {
+            if (in_mapping)
+                clear_tlb_entry(entry);
+            entry = entries.back();
+            entries.pop_back();
+        }
+        else
+            i++;
+    }
 }
 
 void MMU::reload_tlb_section(uint32_t addr)
@@ -135,33 +231,36 @@ void MMU::reload_tlb_section(uint32_t addr)
     uint32_t l1_addr = base + table_index;
     uint32_t page = addr / 4096;
 
-    uint64_t mem = (uint64_t)direct_mapping[l1_addr / 4096];
+    uint64_t mem = (uint64_t)direct_mapping.get(l1_addr / 4096);
     mem &= ~(0xFULL << 60ULL);
     uint8_t* ptr = (uint8_t*)mem;
     uint32_t entry = *(uint32_t*)&ptr[l1_addr & 0xFFF];
     addr &= ~0xFFFFF;
 
+    //Anything recorded for this section is about to be replaced
+    forget_tlb_range(global_entries, addr / 4096, 256, true);
+    forget_tlb_range(get_asid_entries(asid), addr / 4096, 256, true);
+
     uint32_t type = entry & 0x3;
 
     if (type == 0 || type == 3)
     {
-        for (int j = 0; j < 256; j++)
-        {
-            privileged_mapping[page + j] = nullptr;
-            user_mapping[page + j] = nullptr;
-        }
+        privileged_mapping.fill(page, 256, nullptr);
+        user_mapping.fill(page, 256, nullptr);
+        unmap_fastmem(page * 4096, 1024 * 1024);
     }
     else if (type == 2)
     {
         uint32_t paddr;
         bool exec_never = (entry & (1 << 4)) != 0;
+        bool global = !(entry & (1 << 17));
         uint8_t apx = (entry >> 10) & 0x3;
         if (entry & (1 << 18))
         {
             addr &= ~0xFFFFFF;
             paddr = entry & 0xFF000000;
 
-            remap_mmu_region(addr, 1024 * 1024 * 16, paddr, apx, exec_never);
+            remap_mmu_region(addr, 1024 * 1024 * 16, paddr, apx, exec_never, global);
         }
         else
         {
@@ -170,7 +269,7 @@ void MMU::reload_tlb_section(uint32_t addr)
                 apx |= 1 << 2;
             paddr = entry & 0xFFF00000;
 
-            remap_mmu_region(addr, 1024 * 1024, paddr, apx, exec_never);
+            remap_mmu_region(addr, 1024 * 1024, paddr, apx, exec_never, global);
         }
     }
     else
@@ -179,7 +278,7 @@ void MMU::reload_tlb_section(uint32_t addr)
         //printf("L2 table at $%08X\n", l2_addr);
         for (int i = 0; i < 1024; i += 4)
         {
-            uint64_t l2_mem = (uint64_t)direct_mapping[(l2_addr + i) / 4096];
+            uint64_t l2_mem = (uint64_t)direct_mapping.get((l2_addr + i) / 4096);
             l2_mem &= ~(0xFULL << 60ULL);
             uint8_t* l2_ptr = (uint8_t*)l2_mem;
             uint32_t l2_entry = *(uint32_t*)&l2_ptr[(l2_addr + i) & 0xFFF];
@@ -188,14 +287,16 @@ void MMU::reload_tlb_section(uint32_t addr)
             uint8_t apx = (l2_entry >> 4) & 0x3;
             if (l2_entry & (1 << 9))
                 apx |= 1 << 2;
+            bool global = !(l2_entry & (1 << 11));
 
             //printf("[$%08X] $%08X - ", addr, l2_entry);
 
             if (!type)
             {
                 //printf("Unmapped\n");
-                privileged_mapping[page] = nullptr;
-                user_mapping[page] = nullptr;
+                privileged_mapping.set(page, nullptr);
+                user_mapping.set(page, nullptr);
+                unmap_fastmem(page * 4096, 4096);
                 page++;
                 addr += 1024 * 4;
             }
@@ -204,7 +305,7 @@ void MMU::reload_tlb_section(uint32_t addr)
                 uint32_t paddr = l2_entry & 0xFFFF0000;
 
                 //printf("64 KB $%08X (APX=%d)\n", paddr, apx);
-                remap_mmu_region(addr, 1024 * 64, paddr, apx, false);
+                remap_mmu_region(addr, 1024 * 64, paddr, apx, false, global);
 
                 i += 60;
                 page += 16;
@@ -215,7 +316,7 @@ void MMU::reload_tlb_section(uint32_t addr)
                 uint32_t paddr = l2_entry & ~0xFFF;
                 bool exec_never = (l2_entry & 0x1) != 0;
                 //printf("4 KB $%08X (XN=%d) (APX=%d) (nG=%d)\n", paddr, exec_never, apx);
-                remap_mmu_region(addr, 1024 * 4, paddr, apx, exec_never);
+                remap_mmu_region(addr, 1024 * 4, paddr, apx, exec_never, global);
                 page++;
                 addr += 1024 * 4;
             }
@@ -248,7 +349,7 @@ void MMU::reload_tlb_by_table(int index)
 
     while (addr < l1_table_base[index] + size)
     {
-        uint64_t mem = (uint64_t)direct_mapping[addr / 4096];
+        uint64_t mem = (uint64_t)direct_mapping.get(addr / 4096);
         mem &= ~(0xFULL << 60ULL);
         uint8_t* ptr = (uint8_t*)mem;
         uint32_t entry = *(uint32_t*)&ptr[addr & 0xFFF];
@@ -259,24 +360,23 @@ void MMU::reload_tlb_by_table(int index)
         {
             //printf("Unmapped\n");
 
-            for (int j = 0; j < 256; j++)
-            {
-                privileged_mapping[(pc / 4096) + j] = nullptr;
-                user_mapping[(pc / 4096) + j] = nullptr;
-            }
+            privileged_mapping.fill(pc / 4096, 256, nullptr);
+            user_mapping.fill(pc / 4096, 256, nullptr);
+            unmap_fastmem(pc, 1024 * 1024);
             pc += 1024 * 1024;
         }
         else if (type == 2)
         {
             uint32_t paddr;
             bool exec_never = (entry & (1 << 4)) != 0;
+            bool global = !(entry & (1 << 17));
             uint8_t apx = (entry >> 10) & 0x3;
             if (entry & (1 << 18))
             {
                 paddr = entry & 0xFF000000;
                 //printf("Supersection $%08X (XN=%d) (APX=%d)\n", paddr, exec_never, apx);
 
-                remap_mmu_region(pc, 1024 * 1024 * 16, paddr, apx, exec_never);
+                remap_mmu_region(pc, 1024 * 1024 * 16, paddr, apx, exec_never, global);
 
                 pc += 1024 * 1024 * 16;
                 addr += 64 - 4;
@@ -288,7 +388,7 @@ void MMU::reload_tlb_by_table(int index)
                 paddr = entry & 0xFFF00000;
                 //printf("Section $%08X (XN=%d) (APX=%d) (nG=%d)\n", paddr, exec_never, apx);
 
-                remap_mmu_region(pc, 1024 * 1024, paddr, apx, exec_never);
+                remap_mmu_region(pc, 1024 * 1024, paddr, apx, exec_never, global);
                 pc += 1024 * 1024;
             }
         }
@@ -298,7 +398,7 @@ void MMU::reload_tlb_by_table(int index)
             //printf("L2 table at $%08X\n", l2_addr);
             for (int i = 0; i < 1024; i += 4)
             {
-                uint64_t l2_mem = (uint64_t)direct_mapping[(l2_addr + i) / 4096];
+                uint64_t l2_mem = (uint64_t)direct_mapping.get((l2_addr + i) / 4096);
                 l2_mem &= ~(0xFULL << 60ULL);
                 uint8_t* l2_ptr = (uint8_t*)l2_mem;
                 uint32_t l2_entry = *(uint32_t*)&l2_ptr[(l2_addr + i) & 0xFFF];
@@ -308,12 +408,14 @@ void MMU::reload_tlb_by_table(int index)
                 uint8_t apx = (l2_entry >> 4) & 0x3;
                 if (l2_entry & (1 << 9))
                     apx |= 1 << 2;
+                bool global = !(l2_entry & (1 << 11));
 
                 if (!type)
                 {
                     //printf("Unmapped\n");
-                    privileged_mapping[pc / 4096] = nullptr;
-                    user_mapping[pc / 4096] = nullptr;
+                    privileged_mapping.set(pc / 4096, nullptr);
+                    user_mapping.set(pc / 4096, nullptr);
+                    unmap_fastmem(pc, 4096);
                     pc += 1024 * 4;
                 }
                 else if (type == 1)
@@ -321,7 +423,7 @@ void MMU::reload_tlb_by_table(int index)
                     uint32_t paddr = l2_entry & 0xFFFF0000;
                     //printf("64 KB $%08X (APX=%d) (nG=%d)\n", paddr, apx);
 
-                    remap_mmu_region(pc, 1024 * 64, paddr, apx, false);
+                    remap_mmu_region(pc, 1024 * 64, paddr, apx, false, global);
 
                     pc += 1024 * 64;
                     i += 60;
@@ -331,7 +433,7 @@ void MMU::reload_tlb_by_table(int index)
                     uint32_t paddr = l2_entry & ~0xFFF;
                     bool exec_never = (l2_entry & 0x1) != 0;
                     //printf("4 KB $%08X (XN=%d) (APX=%d) (nG=%d)\n", paddr, exec_never, apx);
-                    remap_mmu_region(pc, 1024 * 4, paddr, apx, exec_never);
+                    remap_mmu_region(pc, 1024 * 4, paddr, apx, exec_never, global);
                     pc += 1024 * 4;
                 }
             }
@@ -342,6 +444,7 @@ void MMU::reload_tlb_by_table(int index)
 
 void MMU::reload_tlb(uint32_t addr)
 {
+    tlb_stats.reloads++;
     /*if (whole_tlb_invalidated)
     {
         reload_tlb_by_table(0);
@@ -353,27 +456,23 @@ void MMU::reload_tlb(uint32_t addr)
 }
 
 void MMU::remap_mmu_region(uint32_t base, uint32_t size, uint64_t paddr,
-                           uint8_t apx, bool exec_never)
+                           uint8_t apx, bool exec_never, bool global)
 {
-    base /= 4096;
-    size /= 4096;
-    paddr /= 4096;
-
-    uint64_t priv_perm = get_privileged_apx_perms(apx);
-    if (exec_never)
-        priv_perm &= ~0x1;
-
-    priv_perm <<= 60ULL;
-
-    for (unsigned int i = 0; i < size; i++)
-    {
-        uint64_t mapping = (uint64_t)direct_mapping[paddr + i];
-
-        //Strip permission bits off
-        mapping &= ~(0x7ULL << 60ULL);
+    TLB_Entry entry;
+    entry.base = base / 4096;
+    entry.size = size / 4096;
+    entry.paddr = paddr / 4096;
+    entry.apx = apx;
+    entry.exec_never = exec_never;
+
+    add_tlb_entry(entry, global);
+    fill_tlb_entry(entry);
+}
 
-        privileged_mapping[base + i] = (uint8_t*)(mapping | priv_perm);
-    }
+void MMU::unmap_fastmem(uint32_t base, uint64_t size)
+{
+    if (fastmem)
+        fastmem->unmap(base, size);
 }
 
 uint32_t MMU::get_l1_table_base(int index)
@@ -397,13 +496,14 @@ void MMU::set_l1_table_base(int index, uint32_t value)
     uint32_t mask = 0x3FFF;
     mask >>= l1_table_control;
     l1_table_base[index] = value & ~mask;
-    invalidate_tlb_by_table(index);
+
+    //As on hardware, this doesn't flush anything. Old translations are either global or tagged with another ASID.
 }
 
 void MMU::set_l1_table_control(uint32_t value)
 {
     //If control is 0, translation table 0 will cover all of memory.
-    printf("[MMU] Set control: $%08X\n", value);
+    LOG(LOG_MMU, LOG_DEBUG, "[MMU] Set control: $%08X\n", value);
     l1_table_control = value;
     l1_table_cutoff = 1ULL << 32UL;
     l1_table_cutoff >>= value & 0x7;
@@ -417,13 +517,54 @@ void MMU::set_domain_control(uint32_t value)
 
 void MMU::set_asid(uint32_t value)
 {
-    printf("[MMU] Set ASID: $%08X\n", value);
-    asid = value & 0xFF;
+    LOG(LOG_MMU, LOG_DEBUG, "[MMU] Set ASID: $%08X\n", value);
+    uint8_t new_asid = value & 0xFF;
+    if (new_asid == asid)
+        return;
+
+    //Swap the old ASID's entries out of the mapping, keeping them recorded, and the new ASID's back in
+    for (TLB_Entry& entry : get_asid_entries(asid))
+        clear_tlb_entry(entry);
+
+    asid = new_asid;
+    for (TLB_Entry& entry : get_asid_entries(asid))
+    {
+        fill_tlb_entry(entry);
+        tlb_stats.restored_pages += entry.size;
+    }
+    tlb_stats.asid_switches++;
+}
+
+uint64_t MMU::get_memory_usage()
+{
+    uint64_t usage = user_mapping.get_memory_usage() + privileged_mapping.get_memory_usage();
+    usage += direct_mapping.get_memory_usage();
+
+    usage += global_entries.capacity() * sizeof(TLB_Entry);
+    for (int i = 0; i < 256; i++)
+        usage += asid_entries[i].capacity() * sizeof(TLB_Entry);
+    return usage;
+}
+
+TLB_Stats MMU::get_tlb_stats()
+{
+    return tlb_stats;
+}
+
+void MMU::reset_tlb_stats()
+{
+    memset(&tlb_stats, 0, sizeof(tlb_stats));
+}
+
+void MMU::set_fastmem(FastmemSpace *fastmem)
+{
+    this->fastmem = fastmem;
+    unmap_fastmem(0, 1ULL << 32ULL);
 }
 
 void MMU::set_pu_permissions_ex(bool is_data, uint32_t value)
 {
-    printf("[MMU] Set PU permissions (data=%d): $%08X\n", is_data, value);
+    LOG(LOG_MMU, LOG_DEBUG, "[MMU] Set PU permissions (data=%d): $%08X\n", is_data, value);
     for (int i = 0; i < 8; i++)
     {
         uint8_t type = (value >> (i * 4)) & 0xF;
@@ -459,12 +600,12 @@ void MMU::set_pu_permissions_ex(bool is_data, uint32_t value)
 
 void MMU::set_pu_region(int index, uint32_t value)
 {
-    printf("[MMU] Set PU%d region: $%08X\n", index, value);
+    LOG(LOG_MMU, LOG_DEBUG, "[MMU] Set PU%d region: $%08X\n", index, value);
     pu_regions[index].enabled = value & 0x1;
     pu_regions[index].size = 2 << ((value >> 1) & 0x1F);
     pu_regions[index].base = (value >> 12) * 4096;
 
-    printf("Size: $%08X Base: $%08X\n", pu_regions[index].size, pu_regions[index].base);
+    LOG(LOG_MMU, LOG_DEBUG, "Size: $%08X Base: $%08X\n", pu_regions[index].size, pu_regions[index].base);
 
     unmap_pu_region(index);
     if (pu_regions[index].enabled)
@@ -494,8 +635,8 @@ void MMU::unmap_pu_region(int index)
 
     while (start < end)
     {
-        privileged_mapping[start] = nullptr;
-        user_mapping[start] = nullptr;
+        privileged_mapping.set(start, nullptr);
+        user_mapping.set(start, nullptr);
         start++;
     }
 }
@@ -523,7 +664,7 @@ void MMU::remap_pu_region(int index)
 
     while (start < end)
     {
-        uint64_t addr = (uint64_t)direct_mapping[start];
+        uint64_t addr = (uint64_t)direct_mapping.get(start);
 
         //Strip RWX permissions from the address
         addr &= ~(0x7ULL << 60ULL);
@@ -536,8 +677,8 @@ void MMU::remap_pu_region(int index)
         user_addr |= (uint64_t)(pu_regions[index].instr_user_perm) << 60ULL;
         user_addr |= (uint64_t)(pu_regions[index].data_user_perm) << 60ULL;
 
-        privileged_mapping[start] = (uint8_t*)privileged_addr;
-        user_mapping[start] = (uint8_t*)user_addr;
+        privileged_mapping.set(start, (uint8_t*)privileged_addr);
+        user_mapping.set(start, (uint8_t*)user_addr);
 
         start++;
     }
@@ -1,6 +1,9 @@
 #ifndef MMU_HPP
 #define MMU_HPP
 #include <cstdint>
+#include <vector>
+#include "fastmem.hpp"
+#include "page_map.hpp"
 
 enum MMU_Perm
 {
@@ -14,6 +17,23 @@ enum MMU_Perm
     MMU_RWX
 };
 
+//A run of pages filled in from one page table descriptor
+struct TLB_Entry
+{
+    uint32_t base, size; //In virtual pages
+    uint32_t paddr; //Physical page
+    uint8_t apx;
+    bool exec_never;
+};
+
+struct TLB_Stats
+{
+    uint64_t reloads; //Page table walks
+    uint64_t restored_pages; //Pages refilled from saved entries on an ASID switch
+    uint64_t asid_switches;
+    uint64_t flushes;
+};
+
 struct PU_Region
 {
     uint32_t base, size;
@@ -25,27 +45,43 @@ struct PU_Region
 class MMU
 {
     private:
+        constexpr static int MAX_TLB_ENTRIES = 4096;
+
         /***
          * MMU-based mappings for user and privileged modes.
          * Every entry is a 4 KB page, totalling to 1 million pages for every mapping.
          * Privileges and other useful modes are set in the upper bits of a 64-bit address, as follows:
          * Bit 63 - When set, indicates the page is not a direct pointer to host memory, but rather a guest address.
-         *          The address is masked with 0xFFFFF000 and passed to an emulator read/write method.
+         *          The low 32 bits are the offset from the virtual address to the guest physical address, which is
+         *          passed to an emulator read/write method. Identity-mapped MMIO is then the same for every page.
          * Bit 62 - When set, indicates the page is readable.
          * Bit 61 - ... writable
          * Bit 60 - ... executable
          * An all-zero entry means the page is unmapped.
         ***/
-        uint8_t** user_mapping;
-        uint8_t** privileged_mapping;
+        PageMap user_mapping;
+        PageMap privileged_mapping;
 
         //Direct virtual->physical mapping.
         //Follows the same rules as above, except permissions are set to RWX.
-        uint8_t** direct_mapping;
+        PageMap direct_mapping;
 
         //Current ASID
         uint8_t asid;
 
+        /***
+         * Record of what has been loaded into privileged_mapping, tagged by ASID. The mapping itself only ever holds
+         * the global entries and those of the current ASID. Switching ASIDs clears the old ASID's entries out and
+         * refills the new one's, so a process's translations survive the other processes running in between.
+         * A full flush bumps tlb_generation rather than clearing every list; a list with an older generation is
+         * treated as empty.
+        ***/
+        std::vector<TLB_Entry> global_entries;
+        std::vector<TLB_Entry> asid_entries[256];
+        uint32_t asid_generation[256];
+        uint32_t tlb_generation;
+        TLB_Stats tlb_stats;
+
         bool whole_tlb_invalidated;
 
         uint32_t l1_table_base[2];
@@ -55,13 +91,25 @@ class MMU
 
         PU_Region pu_regions[8];
 
+        //Host mirror of privileged_mapping/direct_mapping, if any. Ranges are unmapped whenever they change.
+        FastmemSpace* fastmem;
+
+        void unmap_fastmem(uint32_t base, uint64_t size);
+
         void unmap_pu_region(int index);
         void remap_pu_region(int index);
 
         void reload_tlb_section(uint32_t addr);
         void reload_tlb_by_table(int index);
         void remap_mmu_region(uint32_t base, uint32_t size, uint64_t paddr,
-                              uint8_t apx, bool exec_never);
+                              uint8_t apx, bool exec_never, bool global);
+
+        std::vector<TLB_Entry>& get_asid_entries(uint8_t asid);
+        void add_tlb_entry(const TLB_Entry& entry, bool global);
+        void fill_tlb_entry(const TLB_Entry& entry);
+        void clear_tlb_entry(const TLB_Entry& entry);
+        void clear_tlb_entries(std::vector<TLB_Entry>& entries);
+        void forget_tlb_range(std::vector<TLB_Entry>& entries, uint32_t base, uint32_t size, bool in_mapping);
 
         MMU_Perm get_user_apx_perms(uint8_t apx);
         MMU_Perm get_privileged_apx_perms(uint8_t apx);
@@ -73,12 +121,12 @@ class MMU
         void add_physical_mapping(uint8_t* mem, uint32_t base, uint32_t size);
         void remove_physical_mapping(uint32_t base, uint32_t size);
 
-        uint8_t** get_user_mapping();
-        uint8_t** get_privileged_mapping();
-        uint8_t** get_direct_mapping();
+        PageMap* get_user_mapping();
+        PageMap* get_privileged_mapping();
+        PageMap* get_direct_mapping();
 
         void invalidate_tlb();
-        void invalidate_tlb_by_table(int index);
+        void invalidate_tlb_by_asid(uint8_t asid);
         void invalidate_tlb_by_addr(uint32_t value);
         void reload_tlb(uint32_t addr);
         void reload_pu();
@@ -90,6 +138,11 @@ class MMU
         void set_l1_table_control(uint32_t value);
         void set_domain_control(uint32_t value);
         void set_asid(uint32_t value);
+        void set_fastmem(FastmemSpace* fastmem);
+
+        uint64_t get_memory_usage();
+        TLB_Stats get_tlb_stats();
+        void reset_tlb_stats();
 
         void set_pu_permissions_ex(bool is_data, uint32_t value);
         void set_pu_region(int index, uint32_t value);
@@ -0,0 +1,113 @@
+#include <cstring>
+#include "page_map.hpp"
+
+uint8_t* PageMap::unmapped_leaf[LEAF_SIZE] = {};
+uint8_t* PageMap::mmio_leaf[LEAF_SIZE];
+bool PageMap::shared_leaves_init = PageMap::init_shared_leaves();
+
+bool PageMap::init_shared_leaves()
+{
+    //MMIO entries hold the offset from the virtual page to the physical one, so an identity mapping is all zeroes
+    for (int i = 0; i < LEAF_SIZE; i++)
+        mmio_leaf[i] = (uint8_t*)(0xFULL << 60ULL);
+    return true;
+}
+
+PageMap::PageMap()
+{
+    owned_leaves = 0;
+    for (int i = 0; i < LEAF_COUNT; i++)
+        leaves[i] = get_shared_leaf(LEAF_UNMAPPED);
+}
+
+PageMap::~PageMap()
+{
+    reset(LEAF_UNMAPPED);
+}
+
+uint8_t** PageMap::get_shared_leaf(SharedLeaf leaf)
+{
+    if (leaf == LEAF_MMIO)
+        return mmio_leaf;
+    return unmapped_leaf;
+}
+
+bool PageMap::is_shared(int index)
+{
+    return leaves[index] == unmapped_leaf || leaves[index] == mmio_leaf;
+}
+
+uint8_t** PageMap::get_own_leaf(int index)
+{
+    if (is_shared(index))
+    {
+        uint8_t** leaf = new uint8_t*[LEAF_SIZE];
+        memcpy(leaf, leaves[index], LEAF_SIZE * sizeof(uint8_t*));
+        leaves[index] = leaf;
+        owned_leaves++;
+    }
+    return leaves[index];
+}
+
+void PageMap::release_leaf(int index, uint8_t** shared)
+{
+    if (!is_shared(index))
+    {
+        delete[] leaves[index];
+        owned_leaves--;
+    }
+    leaves[index] = shared;
+}
+
+void PageMap::set(uint32_t page, uint8_t *value)
+{
+    int index = page >> LEAF_SHIFT;
+    int offset = page & (LEAF_SIZE - 1);
+
+    //Keeps clearing an unmapped region from allocating anything
+    if (leaves[index][offset] == value)
+        return;
+    get_own_leaf(index)[offset] = value;
+}
+
+void PageMap::fill(uint32_t page, uint32_t count, uint8_t *value)
+{
+    uint8_t** shared = nullptr;
+    if (value == get_shared_leaf(LEAF_UNMAPPED)[0])
+        shared = get_shared_leaf(LEAF_UNMAPPED);
+    else if (value == get_shared_leaf(LEAF_MMIO)[0])
+        shared = get_shared_leaf(LEAF_MMIO);
+
+    while (count)
+    {
+        int index = page >> LEAF_SHIFT;
+        int offset = page & (LEAF_SIZE - 1);
+        uint32_t size = LEAF_SIZE - offset;
+        if (size > count)
+            size = count;
+
+        //Whole leaves of a default value go back to the shared leaf, freeing their memory
+        if (shared && size == LEAF_SIZE)
+            release_leaf(index, shared);
+        else if (!is_shared(index) || leaves[index][0] != value)
+        {
+            uint8_t** leaf = get_own_leaf(index);
+            for (uint32_t i = 0; i < size; i++)
+                leaf[offset + i] = value;
+        }
+
+        page += size;
+        count -= size;
+    }
+}
+
+void PageMap::reset(SharedLeaf leaf)
+{
+    for (int i = 0; i < LEAF_COUNT; i++)
+        release_leaf(i, get_shared_leaf(leaf));
+}
+
+uint64_t PageMap::get_memory_usage()
+{
+    return sizeof(leaves) + (uint64_t)owned_leaves * LEAF_SIZE * sizeof(uint8_t*);
+}
@@ -0,0 +1,55 @@
+#ifndef PAGE_MAP_HPP
+#define PAGE_MAP_HPP
+#include <cstdint>
+
+/***
+ * Two-level table of 4 KB page entries covering the 32-bit address space, indexed like a flat array.
+ * Each leaf covers 4 MB. Leaves that hold nothing but a default value point at a leaf shared by every map, so a
+ * map only costs memory for the regions that have actually been mapped.
+ * The shared leaves are never written; set() and fill() give a region its own leaf first.
+***/
+
+class PageMap
+{
+    public:
+        constexpr static int LEAF_SHIFT = 10;
+        constexpr static int LEAF_SIZE = 1 << LEAF_SHIFT;
+        constexpr static int LEAF_COUNT = (1024 * 1024) / LEAF_SIZE;
+
+        //Defaults a region can fall back to without a leaf of its own
+        enum SharedLeaf
+        {
+            LEAF_UNMAPPED,
+            LEAF_MMIO
+        };
+    private:
+        static uint8_t* unmapped_leaf[LEAF_SIZE];
+        static uint8_t* mmio_leaf[LEAF_SIZE];
+        static bool shared_leaves_init;
+
+        uint8_t** leaves[LEAF_COUNT];
+        int owned_leaves;
+
+        static bool init_shared_leaves();
+        static uint8_t** get_shared_leaf(SharedLeaf leaf);
+        bool is_shared(int index);
+        uint8_t** get_own_leaf(int index);
+        void release_leaf(int index, uint8_t** shared);
+    public:
+        PageMap();
+        ~PageMap();
+
+        uint8_t* get(uint32_t page);
+        void set(uint32_t page, uint8_t* value);
+        void fill(uint32_t page, uint32_t count, uint8_t* value);
+        void reset(SharedLeaf leaf);
+
+        uint64_t get_memory_usage();
+};
+
+inline uint8_t* PageMap::get(uint32_t page)
+{
+    return leaves[page >> LEAF_SHIFT][page & (LEAF_SIZE - 1)];
+}
+
+#endif // PAGE_MAP_HPP
@@ -1,123 +1,15 @@
 #include <sstream>
 #include "arm.hpp"
+#include "arm_decode.hpp"
 #include "arm_disasm.hpp"
 
 using namespace std;
 
+static constexpr THUMB_DecodeTable thumb_decode_table = make_thumb_decode_table();
+
 THUMB_INSTR decode_thumb(uint16_t instr)
 {
-    if ((instr & 0xFF00) == 0xBA00)
-    {
-        switch ((instr >> 6) & 0x3)
-        {
-            case 0x00:
-                return THUMB_REV;
-            case 0x01:
-                return THUMB_REV16;
-            default:
-                return THUMB_UNDEFINED;
-        }
-    }
-    uint16_t instr13 = instr >> 13;
-    uint16_t instr12 = instr >> 12;
-    uint16_t instr11 = instr >> 11;
-    uint16_t instr10 = instr >> 10;
-    switch (instr11)
-    {
-        case 0x4:
-            return THUMB_MOV_IMM;
-        case 0x5:
-            return THUMB_CMP_IMM;
-        case 0x6:
-            return THUMB_ADD_IMM;
-        case 0x7:
-            return THUMB_SUB_IMM;
-        case 0x9:
-            return THUMB_PC_REL_LOAD;
-        case 0x10:
-            return THUMB_STORE_HALFWORD;
-        case 0x11:
-            return THUMB_LOAD_HALFWORD;
-        case 0x12:
-            return THUMB_SP_REL_STORE;
-        case 0x13:
-            return THUMB_SP_REL_LOAD;
-        case 0x18:
-            return THUMB_STORE_MULTIPLE;
-        case 0x19:
-            return THUMB_LOAD_MULTIPLE;
-        case 0x1C:
-            return THUMB_BRANCH;
-        case 0x1D:
-            return THUMB_LONG_BLX;
-    }
-    if (instr13 == 0)
-    {
-        if ((instr11 & 0x3) != 0x3)
-            return THUMB_MOV_SHIFT;
-        else
-        {
-            if ((instr & (1 << 9)) != 0)
-                return THUMB_SUB_REG;
-            return THUMB_ADD_REG;
-        }
-    }
-    if (instr10 == 0x10)
-        return THUMB_ALU_OP;
-    if (instr10 == 0x11)
-        return THUMB_HI_REG_OP;
-    if (instr12 == 0x5)
-    {
-        if ((instr & (1 << 9)) == 0)
-        {
-            if ((instr & (1 << 11)) == 0)
-                return THUMB_STORE_REG_OFFSET;
-            return THUMB_LOAD_REG_OFFSET;
-        }
-        return THUMB_LOAD_STORE_SIGN_HALFWORD;
-    }
-    if (instr13 == 0x3)
-    {
-        if ((instr & (1 << 11)) == 0)
-            return THUMB_STORE_IMM_OFFSET;
-        return THUMB_LOAD_IMM_OFFSET;
-    }
-    if (instr12 == 0xA)
-        return THUMB_LOAD_ADDRESS;
-    if (instr12 == 0xB)
-    {
-        if (((instr >> 9) & 0x3) == 0x2)
-        {
-            if ((instr & (1 << 11)) != 0)
-                return THUMB_POP;
-            return THUMB_PUSH;
-        }
-        if (instr & (1 << 9))
-        {
-            int op = (instr >> 6) & 0x3;
-            switch (op)
-            {
-                case 0:
-                    return THUMB_SXTH;
-                case 1:
-                    return THUMB_SXTB;
-                case 2:
-                    return THUMB_UXTH;
-                case 3:
-                    return THUMB_UXTB;
-            }
-        }
-        return THUMB_OFFSET_SP;
-    }
-    if (instr12 == 0xD)
-        return THUMB_COND_BRANCH;
-    if (instr12 == 0xF)
-    {
-        if ((instr & (1 << 11)) == 0)
-            return THUMB_LONG_BRANCH_PREP;
-        return THUMB_LONG_BRANCH;
-    }
-    return THUMB_UNDEFINED;
+    return (THUMB_INSTR)thumb_decode_table.entries[instr >> 6];
 }
 
 namespace ARM_Disasm
@@ -498,7 +390,9 @@ string thumb_pc_rel_load(ARM_CPU &cpu, uint16_t instr)
     uint32_t destination = (instr >> 8) & 0x7;
     uint32_t address = cpu.get_PC() + ((instr & 0xFF) << 2);
     address &= ~0x3;
-    output << "ldr " << ARM_CPU::get_reg_name(destination) << ", =0x" << std::hex << cpu.read32(address);
+    uint32_t value = 0;
+    cpu.try_read32(address, value);
+    output << "ldr " << ARM_CPU::get_reg_name(destination) << ", =0x" << std::hex << value;
     return output.str();
 }
 
@@ -625,7 +519,9 @@ string thumb_cond_branch(ARM_CPU& cpu, uint16_t instr)
 string thumb_long_branch(ARM_CPU &cpu, uint16_t instr)
 {
     stringstream output;
-    uint32_t long_instr = instr | (cpu.read16(cpu.get_PC() - 2) << 16);
+    uint16_t second_half = 0;
+    cpu.try_read16(cpu.get_PC() - 2, second_half);
+    uint32_t long_instr = instr | (second_half << 16);
     bool switch_ARM = (long_instr & (1 << 28)) == 0;
     uint32_t address = cpu.get_PC();
     int32_t offset = (int32_t)((long_instr & 0x7FF) << 21) >> 9;
@@ -1,129 +1,161 @@
 #include <cstdio>
 #include "arm.hpp"
 #include "arm_interpret.hpp"
+#include "arm_decode.hpp"
 #include "arm_disasm.hpp"
 #include "../common/common.hpp"
 
 namespace ARM_Interpreter
 {
 
-void interpret_thumb(ARM_CPU &cpu, uint16_t instr)
+template <ARM_CORE_TYPE core>
+static constexpr THUMB_Handler get_handler_for(THUMB_INSTR type)
 {
-    switch (decode_thumb(instr))
+    if (core == ARM_CORE_ARM9)
+    {
+        //ARMv6 instructions are undefined on the ARM9
+        switch (type)
+        {
+            case THUMB_SXTH:
+            case THUMB_SXTB:
+            case THUMB_UXTH:
+            case THUMB_UXTB:
+            case THUMB_REV:
+            case THUMB_REV16:
+                return thumb_undefined;
+            default:
+                break;
+        }
+    }
+
+    switch (type)
     {
         case THUMB_MOV_SHIFT:
-            thumb_move_shift(cpu, instr);
-            break;
+            return thumb_move_shift;
         case THUMB_ADD_REG:
-            thumb_add_reg(cpu, instr);
-            break;
+            return thumb_add_reg;
         case THUMB_SUB_REG:
-            thumb_sub_reg(cpu, instr);
-            break;
+            return thumb_sub_reg;
         case THUMB_MOV_IMM:
-            thumb_mov(cpu, instr);
-            break;
+            return thumb_mov;
         case THUMB_CMP_IMM:
-            thumb_cmp(cpu, instr);
-            break;
+            return thumb_cmp;
         case THUMB_ADD_IMM:
-            thumb_add(cpu, instr);
-            break;
+            return thumb_add;
         case THUMB_SUB_IMM:
-            thumb_sub(cpu, instr);
-            break;
+            return thumb_sub;
         case THUMB_ALU_OP:
-            thumb_alu(cpu, instr);
-            break;
+            return thumb_alu;
         case THUMB_HI_REG_OP:
-            thumb_hi_reg_op(cpu, instr);
-            break;
+            return thumb_hi_reg_op;
         case THUMB_LOAD_IMM_OFFSET:
-            thumb_load_imm(cpu, instr);
-            break;
+            return thumb_load_imm<core>;
         case THUMB_STORE_IMM_OFFSET:
-            thumb_store_imm(cpu, instr);
-            break;
+            return thumb_store_imm<core>;
         case THUMB_LOAD_REG_OFFSET:
-            thumb_load_reg(cpu, instr);
-            break;
+            return thumb_load_reg<core>;
         case THUMB_STORE_REG_OFFSET:
-            thumb_store_reg(cpu, instr);
-            break;
+            return thumb_store_reg<core>;
         case THUMB_LOAD_HALFWORD:
-            thumb_load_halfword(cpu, instr);
-            break;
+            return thumb_load_halfword;
         case THUMB_STORE_HALFWORD:
-            thumb_store_halfword(cpu, instr);
-            break;
+            return thumb_store_halfword<core>;
         case THUMB_LOAD_STORE_SIGN_HALFWORD:
-            thumb_load_store_signed(cpu, instr);
-            break;
+            return thumb_load_store_signed<core>;
         case THUMB_LOAD_MULTIPLE:
-            thumb_load_block(cpu, instr);
-            break;
+            return thumb_load_block;
         case THUMB_STORE_MULTIPLE:
-            thumb_store_block(cpu, instr);
-            break;
+            return thumb_store_block<core>;
         case THUMB_PUSH:
-            thumb_push(cpu, instr);
-            break;
+            return thumb_push<core>;
         case THUMB_POP:
-            thumb_pop(cpu, instr);
-            break;
+            return thumb_pop;
         case THUMB_PC_REL_LOAD:
-            thumb_pc_rel_load(cpu, instr);
-            break;
+            return thumb_pc_rel_load;
         case THUMB_LOAD_ADDRESS:
-            thumb_load_addr(cpu, instr);
-            break;
+            return thumb_load_addr;
         case THUMB_SP_REL_LOAD:
-            thumb_sp_rel_load(cpu, instr);
-            break;
+            return thumb_sp_rel_load;
         case THUMB_SP_REL_STORE:
-            thumb_sp_rel_store(cpu, instr);
-            break;
+            return thumb_sp_rel_store<core>;
         case THUMB_OFFSET_SP:
-            thumb_offset_sp(cpu, instr);
-            break;
+            return thumb_offset_sp;
         case THUMB_SXTH:
-            thumb_sxth(cpu, instr);
-            break;
+            return thumb_sxth;
         case THUMB_SXTB:
-            thumb_sxtb(cpu, instr);
-            break;
+            return thumb_sxtb;
         case THUMB_UXTH:
-            thumb_uxth(cpu, instr);
-            break;
+            return thumb_uxth;
         case THUMB_UXTB:
-            thumb_uxtb(cpu, instr);
-            break;
+            return thumb_uxtb;
         case THUMB_REV:
-            thumb_rev(cpu, instr);
-            break;
+            return thumb_rev;
         case THUMB_REV16:
-            thumb_rev16(cpu, instr);
-            break;
+            return thumb_rev16;
         case THUMB_BRANCH:
-            thumb_branch(cpu, instr);
-            break;
+            return thumb_branch;
         case THUMB_COND_BRANCH:
-            thumb_cond_branch(cpu, instr);
-            break;
+            return thumb_cond_branch;
         case THUMB_LONG_BRANCH_PREP:
-            thumb_long_branch_prep(cpu, instr);
-            break;
+            return thumb_long_branch_prep;
         case THUMB_LONG_BRANCH:
-            thumb_long_branch(cpu, instr);
-            break;
+            return thumb_long_branch;
         case THUMB_LONG_BLX:
-            thumb_long_blx(cpu, instr);
-            break;
+            return thumb_long_blx;
         default:
-            EmuException::die("[Thumb_Interpreter] Undefined Thumb instr $%04X\n", instr);
+            return thumb_undefined;
     }
 }
 
+struct THUMB_HandlerTable
+{
+    THUMB_Handler entries[THUMB_DECODE_TABLE_SIZE];
+};
+
+template <ARM_CORE_TYPE core>
+static constexpr THUMB_HandlerTable make_thumb_handler_table()
+{
+    THUMB_HandlerTable table = {};
+    for (int i = 0; i < THUMB_DECODE_TABLE_SIZE; i++)
+        table.entries[i] = get_handler_for<core>(decode_thumb_bits(i << 6));
+    return table;
+}
+
+static constexpr THUMB_HandlerTable arm9_thumb_handler_table = make_thumb_handler_table<ARM_CORE_ARM9>();
+static constexpr THUMB_HandlerTable arm11_thumb_handler_table = make_thumb_handler_table<ARM_CORE_ARM11>();
+
+THUMB_Handler get_thumb_handler(ARM_CORE_TYPE core, uint16_t instr)
+{
+    if (core == ARM_CORE_ARM9)
+        return arm9_thumb_handler_table.entries[instr >> 6];
+    return arm11_thumb_handler_table.entries[instr >> 6];
+}
+
+template <ARM_CORE_TYPE core>
+void interpret_thumb(ARM_CPU &cpu, uint16_t instr)
+{
+    if (core == ARM_CORE_ARM9)
+        arm9_thumb_handler_table.entries[instr >> 6](cpu, instr);
+    else
+        arm11_thumb_handler_table.entries[instr >> 6](cpu, instr);
+}
+
+void interpret_thumb(ARM_CPU &cpu, uint16_t instr)
+{
+    if (cpu.get_core_type() == ARM_CORE_ARM9)
+        interpret_thumb<ARM_CORE_ARM9>(cpu, instr);
+    else
+        interpret_thumb<ARM_CORE_ARM11>(cpu, instr);
+}
+
+template void interpret_thumb<ARM_CORE_ARM9>(ARM_CPU &cpu, uint16_t instr);
+template void interpret_thumb<ARM_CORE_ARM11>(ARM_CPU &cpu, uint16_t instr);
+
+void thumb_undefined(ARM_CPU&, uint16_t instr)
+{
+    EmuException::die("[Thumb_Interpreter] Undefined Thumb instr $%04X\n", instr);
+}
+
 void thumb_move_shift(ARM_CPU &cpu, uint16_t instr)
 {
     int opcode = (instr >> 11) & 0x3;
@@ -301,7 +333,7 @@ void thumb_alu(ARM_CPU &cpu, uint16_t instr)
             cpu.mvn(destination, cpu.get_register(source), true);
             break;
         default:
-            printf("Invalid thumb alu op %d\n", opcode);
+            LOG(LOG_ARM, LOG_WARN, "Invalid thumb alu op %d\n", opcode);
     }
 }
 
@@ -339,10 +371,11 @@ void thumb_hi_reg_op(ARM_CPU &cpu, uint16_t instr)
             cpu.jp(cpu.get_register(source), true);
             break;
         default:
-            printf("High-reg Thumb opcode $%02X not recognized\n", opcode);
+            LOG(LOG_ARM, LOG_WARN, "High-reg Thumb opcode $%02X not recognized\n", opcode);
     }
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_load_imm(ARM_CPU &cpu, uint16_t instr)
 {
     uint32_t destination = instr & 0x7;
@@ -356,7 +389,10 @@ void thumb_load_imm(ARM_CPU &cpu, uint16_t instr)
     {
         address += offset;
         //cpu.add_n16_data(address, 1);
-        cpu.set_register(destination, cpu.read8(address));
+        uint8_t byte = cpu.read8(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.set_register(destination, byte);
     }
     else
     {
@@ -364,14 +400,17 @@ void thumb_load_imm(ARM_CPU &cpu, uint16_t instr)
         address += offset;
         //cpu.add_n32_data(address, 1);
         uint32_t word;
-        if (cpu.get_id() < 11)
+        if (core == ARM_CORE_ARM9)
             word = cpu.rotr32(cpu.read32(address & ~0x3), (address & 0x3) * 8, false);
         else
             word = cpu.read32(address);
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.set_register(destination, word);
     }
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_store_imm(ARM_CPU &cpu, uint16_t instr)
 {
     uint32_t source = instr & 0x7;
@@ -386,7 +425,7 @@ void thumb_store_imm(ARM_CPU &cpu, uint16_t instr)
         address += offset;
         //cpu.add_n16_data(address, 1);
         cpu.write8(address, cpu.get_register(source) & 0xFF);
-        cpu.clear_global_exclusives(address);
+        cpu.clear_global_exclusives<core>(address);
     }
     else
     {
@@ -394,10 +433,11 @@ void thumb_store_imm(ARM_CPU &cpu, uint16_t instr)
         address += offset;
         //cpu.add_n32_data(address, 1);
         cpu.write32(address, cpu.get_register(source));
-        cpu.clear_global_exclusives(address);
+        cpu.clear_global_exclusives<core>(address);
     }
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_load_reg(ARM_CPU &cpu, uint16_t instr)
 {
     bool is_byte = (instr & (1 << 10)) != 0;
@@ -413,21 +453,27 @@ void thumb_load_reg(ARM_CPU &cpu, uint16_t instr)
     {
         //cpu.add_n16_data(address, 1);
         //cpu.add_internal_cycles(1);
-        cpu.set_register(destination, cpu.read8(address));
+        uint8_t byte = cpu.read8(address);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.set_register(destination, byte);
     }
     else
     {
         //cpu.add_n32_data(address, 1);
         //cpu.add_internal_cycles(1);
         uint32_t word;
-        if (cpu.get_id() < 11)
+        if (core == ARM_CORE_ARM9)
             word = cpu.rotr32(cpu.read32(address & ~0x3), (address & 0x3) * 8, false);
         else
             word = cpu.read32(address);
+        if (cpu.is_data_abort_pending())
+            return;
         cpu.set_register(destination, word);
     }
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_store_reg(ARM_CPU &cpu, uint16_t instr)
 {
     bool is_byte = (instr & (1 << 10)) != 0;
@@ -445,13 +491,13 @@ void thumb_store_reg(ARM_CPU &cpu, uint16_t instr)
     {
         //cpu.add_n16_data(address, 1);
         cpu.write8(address, source_contents & 0xFF);
-        cpu.clear_global_exclusives(address);
+        cpu.clear_global_exclusives<core>(address);
     }
     else
     {
         //cpu.add_n32_data(address, 1);
         cpu.write32(address, source_contents);
-        cpu.clear_global_exclusives(address);
+        cpu.clear_global_exclusives<core>(address);
     }
 }
 
@@ -464,9 +510,13 @@ void thumb_load_halfword(ARM_CPU &cpu, uint16_t instr)
     uint32_t address = cpu.get_register(base) + offset;
 
     //cpu.add_n16_data(address, 1);
-    cpu.set_register(destination, cpu.read16(address));
+    uint16_t halfword = cpu.read16(address);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(destination, halfword);
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_store_halfword(ARM_CPU &cpu, uint16_t instr)
 {
     uint32_t offset = ((instr >> 6) & 0x1F) << 1;
@@ -478,9 +528,10 @@ void thumb_store_halfword(ARM_CPU &cpu, uint16_t instr)
 
     //cpu.add_n16_data(address, 1);
     cpu.write16(address, value);
-    cpu.clear_global_exclusives(address);
+    cpu.clear_global_exclusives<core>(address);
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_load_store_signed(ARM_CPU &cpu, uint16_t instr)
 {
     uint32_t destination = instr & 0x7;
@@ -494,41 +545,50 @@ void thumb_load_store_signed(ARM_CPU &cpu, uint16_t instr)
     switch (opcode)
     {
         case 0:
-            if (cpu.get_id() == 9)
+            if (core == ARM_CORE_ARM9)
                 address &= ~0x1;
             cpu.write16(address, cpu.get_register(destination) & 0xFFFF);
-            cpu.clear_global_exclusives(address);
+            cpu.clear_global_exclusives<core>(address);
             //cpu.add_n32_data(address, 1);
             break;
         case 1:
         {
             uint32_t extended_byte = cpu.read8(address);
             extended_byte = (int32_t)(int8_t)extended_byte;
+            if (cpu.is_data_abort_pending())
+                return;
             cpu.set_register(destination, extended_byte);
             //cpu.add_internal_cycles(1);
             //cpu.add_n16_data(address, 1);
         }
             break;
         case 2:
-            if (cpu.get_id() == 9)
+        {
+            if (core == ARM_CORE_ARM9)
                 address &= ~0x1;
-            cpu.set_register(destination, cpu.read16(address));
+            uint16_t halfword = cpu.read16(address);
+            if (cpu.is_data_abort_pending())
+                return;
+            cpu.set_register(destination, halfword);
             //cpu.add_n16_data(address, 1);
             //cpu.add_internal_cycles(1);
+        }
             break;
         case 3:
         {
-            if (cpu.get_id() == 9)
+            if (core == ARM_CORE_ARM9)
                 address &= ~0x1;
             uint32_t extended_halfword = cpu.read16(address);
             extended_halfword = (int32_t)(int16_t)extended_halfword;
+            if (cpu.is_data_abort_pending())
+                return;
             cpu.set_register(destination, extended_halfword);
             //cpu.add_internal_cycles(1);
             //cpu.add_n16_data(address, 1);
         }
             break;
         default:
-            printf("\nSign extended opcode %d not recognized", opcode);
+            LOG(LOG_ARM, LOG_WARN, "\nSign extended opcode %d not recognized", opcode);
     }
 }
 
@@ -538,11 +598,14 @@ void thumb_load_block(ARM_CPU &cpu, uint16_t instr)
     uint32_t base = (instr >> 8) & 0x7;
 
     uint32_t address = cpu.get_register(base);
+    uint32_t old_base = address;
 
     int regs = 0;
     for (int reg = 0; reg < 8; reg++)
     {
         int bit = 1 << reg;
+        if (cpu.is_data_abort_pending())
+            break;
         if (reg_list & bit)
         {
             regs++;
@@ -551,6 +614,12 @@ void thumb_load_block(ARM_CPU &cpu, uint16_t instr)
         }
     }
 
+    if (cpu.is_data_abort_pending())
+    {
+        cpu.set_register(base, old_base);
+        return;
+    }
+
     //cpu.add_n32_data(address, 2);
     //if (regs > 1)
         //cpu.add_s32_data(address, regs - 2);
@@ -561,6 +630,7 @@ void thumb_load_block(ARM_CPU &cpu, uint16_t instr)
         cpu.set_register(base, address);
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_store_block(ARM_CPU &cpu, uint16_t instr)
 {
     uint8_t reg_list = instr & 0xFF;
@@ -576,17 +646,21 @@ void thumb_store_block(ARM_CPU &cpu, uint16_t instr)
         {
             regs++;
             cpu.write32(address, cpu.get_register(reg));
-            cpu.clear_global_exclusives(address);
+            cpu.clear_global_exclusives<core>(address);
             address += 4;
         }
     }
 
+    if (cpu.is_data_abort_pending())
+        return;
+
     //cpu.add_n32_data(address, 2);
     //if (regs > 2)
         //cpu.add_s32_data(address, regs - 2);
     cpu.set_register(base, address);
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_push(ARM_CPU &cpu, uint16_t instr)
 {
     int reg_list = instr & 0xFF;
@@ -598,7 +672,7 @@ void thumb_push(ARM_CPU &cpu, uint16_t instr)
         regs++;
         stack_pointer -= 4;
         cpu.write32(stack_pointer, cpu.get_register(REG_LR));
-        cpu.clear_global_exclusives(stack_pointer);
+        cpu.clear_global_exclusives<core>(stack_pointer);
     }
 
     for (int i = 7; i >= 0; i--)
@@ -609,7 +683,7 @@ void thumb_push(ARM_CPU &cpu, uint16_t instr)
             regs++;
             stack_pointer -= 4;
             cpu.write32(stack_pointer, cpu.get_register(i));
-            cpu.clear_global_exclusives(stack_pointer);
+            cpu.clear_global_exclusives<core>(stack_pointer);
         }
     }
 
@@ -617,6 +691,8 @@ void thumb_push(ARM_CPU &cpu, uint16_t instr)
     //if (regs > 2)
         //cpu.add_s32_data(stack_pointer, regs - 2);
 
+    if (cpu.is_data_abort_pending())
+        return;
     cpu.set_register(REG_SP, stack_pointer);
 }
 
@@ -639,7 +715,10 @@ void thumb_pop(ARM_CPU &cpu, uint16_t instr)
 
     if (instr & (1 << 8))
     {
-        cpu.jp(cpu.read32(stack_pointer), true);
+        uint32_t new_PC = cpu.read32(stack_pointer);
+        if (cpu.is_data_abort_pending())
+            return;
+        cpu.jp(new_PC, true);
 
         regs++;
         stack_pointer += 4;
@@ -649,6 +728,8 @@ void thumb_pop(ARM_CPU &cpu, uint16_t instr)
         cpu.add_s32_data(stack_pointer, regs - 1);
     cpu.add_n32_data(stack_pointer, 1);
     cpu.add_internal_cycles(1);*/
+    if (cpu.is_data_abort_pending())
+        return;
     cpu.set_register(REG_SP, stack_pointer);
 }
 
@@ -660,7 +741,10 @@ void thumb_pc_rel_load(ARM_CPU &cpu, uint16_t instr)
 
     //cpu.add_n32_data(address, 1);
     //cpu.add_internal_cycles(1);
-    cpu.set_register(destination, cpu.read32(address));
+    uint32_t word = cpu.read32(address);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(destination, word);
 }
 
 void thumb_load_addr(ARM_CPU &cpu, uint16_t instr)
@@ -688,9 +772,13 @@ void thumb_sp_rel_load(ARM_CPU &cpu, uint16_t instr)
 
     //cpu.add_n32_data(address, 1);
     //cpu.add_internal_cycles(1);
-    cpu.set_register(destination, cpu.read32(address));
+    uint32_t word = cpu.read32(address);
+    if (cpu.is_data_abort_pending())
+        return;
+    cpu.set_register(destination, word);
 }
 
+template <ARM_CORE_TYPE core>
 void thumb_sp_rel_store(ARM_CPU &cpu, uint16_t instr)
 {
     uint32_t source = (instr >> 8) & 0x7;
@@ -701,7 +789,7 @@ void thumb_sp_rel_store(ARM_CPU &cpu, uint16_t instr)
 
     //cpu.add_n32_data(address, 1);
     cpu.write32(address, cpu.get_register(source));
-    cpu.clear_global_exclusives(address);
+    cpu.clear_global_exclusives<core>(address);
 }
 
 void thumb_offset_sp(ARM_CPU &cpu, uint16_t instr)
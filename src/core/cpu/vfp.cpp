@@ -32,7 +32,7 @@ void VFP::set_fpexc(uint32_t value)
 
 void VFP::set_fpscr(uint32_t value)
 {
-    printf("[VFP] Write FPSCR: $%08X\n", value);
+    LOG(LOG_ARM, LOG_DEBUG, "[VFP] Write FPSCR: $%08X\n", value);
 
     fpscr.vector_len = (value >> 16) & 0x7;
     fpscr.vector_stride = (value >> 20) & 0x3;
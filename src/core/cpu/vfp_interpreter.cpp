@@ -78,6 +78,7 @@ void vfp_mov_sys_reg(ARM_CPU &cpu, VFP &vfp, uint32_t instr)
                     //FMSTAT - Modify CPSR flags
                     PSR_Flags* cpsr = cpu.get_CPSR();
 
+                    cpsr->resolve_flags();
                     cpsr->overflow = (fpscr >> 28) & 0x1;
                     cpsr->carry = (fpscr >> 29) & 0x1;
                     cpsr->zero = (fpscr >> 30) & 0x1;
@@ -329,6 +330,9 @@ void vfp_load_block(ARM_CPU& cpu, VFP &vfp, uint32_t instr)
         }
     }
 
+    if (cpu.is_data_abort_pending())
+        return;
+
     if (writeback)
         cpu.set_register(base, addr);
 }
@@ -385,6 +389,9 @@ void vfp_store_block(ARM_CPU& cpu, VFP &vfp, uint32_t instr)
         }
     }
 
+    if (cpu.is_data_abort_pending())
+        return;
+
     if (writeback)
         cpu.set_register(base, addr);
 }
@@ -0,0 +1,436 @@
+#include <cstring>
+#include "x64_emitter.hpp"
+
+X64Emitter::X64Emitter()
+{
+    block_start = nullptr;
+    cur = nullptr;
+}
+
+void X64Emitter::emit8(uint8_t value)
+{
+    *cur = value;
+    cur++;
+}
+
+void X64Emitter::emit32(uint32_t value)
+{
+    memcpy(cur, &value, sizeof(value));
+    cur += sizeof(value);
+}
+
+void X64Emitter::emit64(uint64_t value)
+{
+    memcpy(cur, &value, sizeof(value));
+    cur += sizeof(value);
+}
+
+void X64Emitter::rex(bool w, int reg, int index, int base, bool force)
+{
+    uint8_t prefix = 0x40;
+    prefix |= w << 3;
+    prefix |= ((reg >> 3) & 0x1) << 2;
+    prefix |= ((index >> 3) & 0x1) << 1;
+    prefix |= (base >> 3) & 0x1;
+
+    if (prefix != 0x40 || force)
+        emit8(prefix);
+}
+
+void X64Emitter::modrm_reg(int reg, int rm)
+{
+    emit8(0xC0 | ((reg & 0x7) << 3) | (rm & 0x7));
+}
+
+void X64Emitter::modrm_mem(int reg, X64_REG base, int32_t disp)
+{
+    //Always use the disp32 form; it keeps the encoder simple and the cost is a few bytes per access
+    emit8(0x80 | ((reg & 0x7) << 3) | (base & 0x7));
+
+    //RSP and R12 as a base require a SIB byte
+    if ((base & 0x7) == REG_RSP)
+        emit8(0x24);
+    emit32(disp);
+}
+
+void X64Emitter::alu32_reg_reg(uint8_t opcode, X64_REG dest, X64_REG source)
+{
+    rex(false, source, 0, dest);
+    emit8(opcode);
+    modrm_reg(source, dest);
+}
+
+void X64Emitter::shift32_imm(int ext, X64_REG reg, uint8_t shift)
+{
+    rex(false, 0, 0, reg);
+    emit8(0xC1);
+    modrm_reg(ext, reg);
+    emit8(shift);
+}
+
+void X64Emitter::sse_reg_reg(uint8_t prefix, uint8_t opcode, int dest, int source)
+{
+    //Mandatory prefixes go before REX
+    if (prefix)
+        emit8(prefix);
+    rex(false, dest, 0, source);
+    emit8(0x0F);
+    emit8(opcode);
+    modrm_reg(dest, source);
+}
+
+void X64Emitter::sse_reg_mem(uint8_t prefix, uint8_t opcode, int reg, X64_REG base, int32_t disp)
+{
+    if (prefix)
+        emit8(prefix);
+    rex(false, reg, 0, base);
+    emit8(0x0F);
+    emit8(opcode);
+    modrm_mem(reg, base, disp);
+}
+
+void X64Emitter::push(X64_REG reg)
+{
+    rex(false, 0, 0, reg);
+    emit8(0x50 + (reg & 0x7));
+}
+
+void X64Emitter::pop(X64_REG reg)
+{
+    rex(false, 0, 0, reg);
+    emit8(0x58 + (reg & 0x7));
+}
+
+void X64Emitter::ret()
+{
+    emit8(0xC3);
+}
+
+void X64Emitter::call_reg(X64_REG reg)
+{
+    rex(false, 0, 0, reg);
+    emit8(0xFF);
+    modrm_reg(2, reg);
+}
+
+void X64Emitter::add64_reg_reg(X64_REG dest, X64_REG source)
+{
+    rex(true, source, 0, dest);
+    emit8(0x01);
+    modrm_reg(source, dest);
+}
+
+void X64Emitter::add64_reg_imm8(X64_REG reg, int8_t imm)
+{
+    rex(true, 0, 0, reg);
+    emit8(0x83);
+    modrm_reg(0, reg);
+    emit8(imm);
+}
+
+void X64Emitter::sub64_reg_imm8(X64_REG reg, int8_t imm)
+{
+    rex(true, 0, 0, reg);
+    emit8(0x83);
+    modrm_reg(5, reg);
+    emit8(imm);
+}
+
+void X64Emitter::mov64_reg_reg(X64_REG dest, X64_REG source)
+{
+    rex(true, source, 0, dest);
+    emit8(0x89);
+    modrm_reg(source, dest);
+}
+
+void X64Emitter::mov64_reg_imm(X64_REG dest, uint64_t imm)
+{
+    rex(true, 0, 0, dest);
+    emit8(0xB8 + (dest & 0x7));
+    emit64(imm);
+}
+
+void X64Emitter::mov32_reg_reg(X64_REG dest, X64_REG source)
+{
+    alu32_reg_reg(0x89, dest, source);
+}
+
+void X64Emitter::mov32_reg_imm(X64_REG dest, uint32_t imm)
+{
+    rex(false, 0, 0, dest);
+    emit8(0xB8 + (dest & 0x7));
+    emit32(imm);
+}
+
+void X64Emitter::mov32_reg_mem(X64_REG dest, X64_REG base, int32_t disp)
+{
+    rex(false, dest, 0, base);
+    emit8(0x8B);
+    modrm_mem(dest, base, disp);
+}
+
+void X64Emitter::mov32_mem_reg(X64_REG base, int32_t disp, X64_REG source)
+{
+    rex(false, source, 0, base);
+    emit8(0x89);
+    modrm_mem(source, base, disp);
+}
+
+void X64Emitter::mov32_mem_imm(X64_REG base, int32_t disp, uint32_t imm)
+{
+    rex(false, 0, 0, base);
+    emit8(0xC7);
+    modrm_mem(0, base, disp);
+    emit32(imm);
+}
+
+void X64Emitter::mov16_mem_imm(X64_REG base, int32_t disp, uint16_t imm)
+{
+    emit8(0x66);
+    rex(false, 0, 0, base);
+    emit8(0xC7);
+    modrm_mem(0, base, disp);
+    emit8(imm & 0xFF);
+    emit8(imm >> 8);
+}
+
+void X64Emitter::mov8_mem_imm(X64_REG base, int32_t disp, uint8_t imm)
+{
+    rex(false, 0, 0, base);
+    emit8(0xC6);
+    modrm_mem(0, base, disp);
+    emit8(imm);
+}
+
+void X64Emitter::movzx8_reg_mem(X64_REG dest, X64_REG base, int32_t disp)
+{
+    rex(false, dest, 0, base);
+    emit8(0x0F);
+    emit8(0xB6);
+    modrm_mem(dest, base, disp);
+}
+
+void X64Emitter::add32_reg_reg(X64_REG dest, X64_REG source)
+{
+    alu32_reg_reg(0x01, dest, source);
+}
+
+void X64Emitter::sub32_reg_reg(X64_REG dest, X64_REG source)
+{
+    alu32_reg_reg(0x29, dest, source);
+}
+
+void X64Emitter::and32_reg_reg(X64_REG dest, X64_REG source)
+{
+    alu32_reg_reg(0x21, dest, source);
+}
+
+void X64Emitter::or32_reg_reg(X64_REG dest, X64_REG source)
+{
+    alu32_reg_reg(0x09, dest, source);
+}
+
+void X64Emitter::xor32_reg_reg(X64_REG dest, X64_REG source)
+{
+    alu32_reg_reg(0x31, dest, source);
+}
+
+void X64Emitter::cmp32_reg_reg(X64_REG dest, X64_REG source)
+{
+    alu32_reg_reg(0x39, dest, source);
+}
+
+void X64Emitter::cmp32_reg_imm(X64_REG reg, int32_t imm)
+{
+    rex(false, 0, 0, reg);
+    emit8(0x81);
+    modrm_reg(7, reg);
+    emit32(imm);
+}
+
+void X64Emitter::test32_reg_reg(X64_REG dest, X64_REG source)
+{
+    alu32_reg_reg(0x85, dest, source);
+}
+
+void X64Emitter::not32(X64_REG reg)
+{
+    rex(false, 0, 0, reg);
+    emit8(0xF7);
+    modrm_reg(2, reg);
+}
+
+void X64Emitter::add32_mem_imm(X64_REG base, int32_t disp, int32_t imm)
+{
+    rex(false, 0, 0, base);
+    emit8(0x81);
+    modrm_mem(0, base, disp);
+    emit32(imm);
+}
+
+void X64Emitter::cmp8_mem_imm(X64_REG base, int32_t disp, uint8_t imm)
+{
+    rex(false, 0, 0, base);
+    emit8(0x80);
+    modrm_mem(7, base, disp);
+    emit8(imm);
+}
+
+void X64Emitter::shl32_imm(X64_REG reg, uint8_t shift)
+{
+    shift32_imm(4, reg, shift);
+}
+
+void X64Emitter::shr32_imm(X64_REG reg, uint8_t shift)
+{
+    shift32_imm(5, reg, shift);
+}
+
+void X64Emitter::sar32_imm(X64_REG reg, uint8_t shift)
+{
+    shift32_imm(7, reg, shift);
+}
+
+void X64Emitter::ror32_imm(X64_REG reg, uint8_t shift)
+{
+    shift32_imm(1, reg, shift);
+}
+
+void X64Emitter::rcr32_1(X64_REG reg)
+{
+    rex(false, 0, 0, reg);
+    emit8(0xD1);
+    modrm_reg(3, reg);
+}
+
+void X64Emitter::bt32_imm(X64_REG reg, uint8_t bit)
+{
+    rex(false, 0, 0, reg);
+    emit8(0x0F);
+    emit8(0xBA);
+    modrm_reg(4, reg);
+    emit8(bit);
+}
+
+void X64Emitter::setcc_mem(X64_COND cond, X64_REG base, int32_t disp)
+{
+    rex(false, 0, 0, base);
+    emit8(0x0F);
+    emit8(0x90 + cond);
+    modrm_mem(0, base, disp);
+}
+
+void X64Emitter::movups_reg_mem(X64_XMM dest, X64_REG base, int32_t disp)
+{
+    sse_reg_mem(0, 0x10, dest, base, disp);
+}
+
+void X64Emitter::movups_mem_reg(X64_REG base, int32_t disp, X64_XMM source)
+{
+    sse_reg_mem(0, 0x11, source, base, disp);
+}
+
+void X64Emitter::movss_mem_reg(X64_REG base, int32_t disp, X64_XMM source)
+{
+    sse_reg_mem(0xF3, 0x11, source, base, disp);
+}
+
+void X64Emitter::movaps_reg_reg(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x28, dest, source);
+}
+
+void X64Emitter::shufps(X64_XMM dest, X64_XMM source, uint8_t select)
+{
+    sse_reg_reg(0, 0xC6, dest, source);
+    emit8(select);
+}
+
+void X64Emitter::addps(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x58, dest, source);
+}
+
+void X64Emitter::mulps(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x59, dest, source);
+}
+
+void X64Emitter::maxps(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x5F, dest, source);
+}
+
+void X64Emitter::andps(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x54, dest, source);
+}
+
+void X64Emitter::andnps(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x55, dest, source);
+}
+
+void X64Emitter::orps(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x56, dest, source);
+}
+
+void X64Emitter::xorps(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x57, dest, source);
+}
+
+void X64Emitter::cmpps(X64_XMM dest, X64_XMM source, X64_FCMP pred)
+{
+    sse_reg_reg(0, 0xC2, dest, source);
+    emit8(pred);
+}
+
+void X64Emitter::addss(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0xF3, 0x58, dest, source);
+}
+
+void X64Emitter::divss(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0xF3, 0x5E, dest, source);
+}
+
+void X64Emitter::sqrtss(X64_XMM dest, X64_XMM source)
+{
+    sse_reg_reg(0xF3, 0x51, dest, source);
+}
+
+void X64Emitter::movmskps(X64_REG dest, X64_XMM source)
+{
+    sse_reg_reg(0, 0x50, dest, source);
+}
+
+void X64Emitter::cvttss2si_reg_mem(X64_REG dest, X64_REG base, int32_t disp)
+{
+    sse_reg_mem(0xF3, 0x2C, dest, base, disp);
+}
+
+uint8_t* X64Emitter::jcc(X64_COND cond)
+{
+    emit8(0x0F);
+    emit8(0x80 + cond);
+    uint8_t* jump = cur;
+    emit32(0);
+    return jump;
+}
+
+uint8_t* X64Emitter::jmp()
+{
+    emit8(0xE9);
+    uint8_t* jump = cur;
+    emit32(0);
+    return jump;
+}
+
+void X64Emitter::set_jump_dest(uint8_t* jump, uint8_t* dest)
+{
+    int32_t offset = (int32_t)(dest - (jump + 4));
+    memcpy(jump, &offset, sizeof(offset));
+}
@@ -0,0 +1,192 @@
+#ifndef X64_EMITTER_HPP
+#define X64_EMITTER_HPP
+#include <cstdint>
+
+enum X64_REG
+{
+    REG_RAX,
+    REG_RCX,
+    REG_RDX,
+    REG_RBX,
+    REG_RSP,
+    REG_RBP,
+    REG_RSI,
+    REG_RDI,
+    REG_R8,
+    REG_R9,
+    REG_R10,
+    REG_R11,
+    REG_R12,
+    REG_R13,
+    REG_R14,
+    REG_R15
+};
+
+enum X64_XMM
+{
+    REG_XMM0,
+    REG_XMM1,
+    REG_XMM2,
+    REG_XMM3,
+    REG_XMM4,
+    REG_XMM5,
+    REG_XMM6,
+    REG_XMM7
+};
+
+//Predicates of CMPPS
+enum X64_FCMP
+{
+    FCMP_EQ,
+    FCMP_LT,
+    FCMP_LE,
+    FCMP_UNORD,
+    FCMP_NEQ,
+    FCMP_NLT,
+    FCMP_NLE,
+    FCMP_ORD
+};
+
+//Condition codes as encoded in the low nibble of Jcc/SETcc
+enum X64_COND
+{
+    COND_O,
+    COND_NO,
+    COND_B,
+    COND_AE,
+    COND_E,
+    COND_NE,
+    COND_BE,
+    COND_A,
+    COND_S,
+    COND_NS,
+    COND_P,
+    COND_NP,
+    COND_L,
+    COND_GE,
+    COND_LE,
+    COND_G
+};
+
+#ifdef _WIN32
+constexpr static X64_REG ABI_PARAM1 = REG_RCX;
+constexpr static X64_REG ABI_PARAM2 = REG_RDX;
+constexpr static X64_REG ABI_PARAM3 = REG_R8;
+constexpr static int ABI_SHADOW_SPACE = 32;
+#else
+constexpr static X64_REG ABI_PARAM1 = REG_RDI;
+constexpr static X64_REG ABI_PARAM2 = REG_RSI;
+constexpr static X64_REG ABI_PARAM3 = REG_RDX;
+constexpr static int ABI_SHADOW_SPACE = 0;
+#endif
+
+//Tiny x86-64 assembler. Only the handful of encodings the JIT actually needs are implemented.
+//All memory operands are of the form [base + disp32].
+class X64Emitter
+{
+    private:
+        uint8_t* block_start;
+        uint8_t* cur;
+
+        void rex(bool w, int reg, int index, int base, bool force = false);
+        void modrm_reg(int reg, int rm);
+        void modrm_mem(int reg, X64_REG base, int32_t disp);
+        void alu32_reg_reg(uint8_t opcode, X64_REG dest, X64_REG source);
+        void shift32_imm(int ext, X64_REG reg, uint8_t shift);
+        void sse_reg_reg(uint8_t prefix, uint8_t opcode, int dest, int source);
+        void sse_reg_mem(uint8_t prefix, uint8_t opcode, int reg, X64_REG base, int32_t disp);
+    public:
+        X64Emitter();
+
+        void set_block_pos(uint8_t* pos);
+        uint8_t* get_block_pos();
+        uint8_t* get_code_pos();
+
+        void emit8(uint8_t value);
+        void emit32(uint32_t value);
+        void emit64(uint64_t value);
+
+        void push(X64_REG reg);
+        void pop(X64_REG reg);
+        void ret();
+        void call_reg(X64_REG reg);
+
+        void add64_reg_reg(X64_REG dest, X64_REG source);
+        void add64_reg_imm8(X64_REG reg, int8_t imm);
+        void sub64_reg_imm8(X64_REG reg, int8_t imm);
+
+        void mov64_reg_reg(X64_REG dest, X64_REG source);
+        void mov64_reg_imm(X64_REG dest, uint64_t imm);
+        void mov32_reg_reg(X64_REG dest, X64_REG source);
+        void mov32_reg_imm(X64_REG dest, uint32_t imm);
+        void mov32_reg_mem(X64_REG dest, X64_REG base, int32_t disp);
+        void mov32_mem_reg(X64_REG base, int32_t disp, X64_REG source);
+        void mov32_mem_imm(X64_REG base, int32_t disp, uint32_t imm);
+        void mov16_mem_imm(X64_REG base, int32_t disp, uint16_t imm);
+        void mov8_mem_imm(X64_REG base, int32_t disp, uint8_t imm);
+        void movzx8_reg_mem(X64_REG dest, X64_REG base, int32_t disp);
+
+        void add32_reg_reg(X64_REG dest, X64_REG source);
+        void sub32_reg_reg(X64_REG dest, X64_REG source);
+        void and32_reg_reg(X64_REG dest, X64_REG source);
+        void or32_reg_reg(X64_REG dest, X64_REG source);
+        void xor32_reg_reg(X64_REG dest, X64_REG source);
+        void cmp32_reg_reg(X64_REG dest, X64_REG source);
+        void cmp32_reg_imm(X64_REG reg, int32_t imm);
+        void test32_reg_reg(X64_REG dest, X64_REG source);
+        void not32(X64_REG reg);
+        void add32_mem_imm(X64_REG base, int32_t disp, int32_t imm);
+        void cmp8_mem_imm(X64_REG base, int32_t disp, uint8_t imm);
+
+        void shl32_imm(X64_REG reg, uint8_t shift);
+        void shr32_imm(X64_REG reg, uint8_t shift);
+        void sar32_imm(X64_REG reg, uint8_t shift);
+        void ror32_imm(X64_REG reg, uint8_t shift);
+        void rcr32_1(X64_REG reg);
+        void bt32_imm(X64_REG reg, uint8_t bit);
+
+        void setcc_mem(X64_COND cond, X64_REG base, int32_t disp);
+
+        //SSE, on packed or scalar single-precision floats
+        void movups_reg_mem(X64_XMM dest, X64_REG base, int32_t disp);
+        void movups_mem_reg(X64_REG base, int32_t disp, X64_XMM source);
+        void movss_mem_reg(X64_REG base, int32_t disp, X64_XMM source);
+        void movaps_reg_reg(X64_XMM dest, X64_XMM source);
+        void shufps(X64_XMM dest, X64_XMM source, uint8_t select);
+        void addps(X64_XMM dest, X64_XMM source);
+        void mulps(X64_XMM dest, X64_XMM source);
+        void maxps(X64_XMM dest, X64_XMM source);
+        void andps(X64_XMM dest, X64_XMM source);
+        void andnps(X64_XMM dest, X64_XMM source);
+        void orps(X64_XMM dest, X64_XMM source);
+        void xorps(X64_XMM dest, X64_XMM source);
+        void cmpps(X64_XMM dest, X64_XMM source, X64_FCMP pred);
+        void addss(X64_XMM dest, X64_XMM source);
+        void divss(X64_XMM dest, X64_XMM source);
+        void sqrtss(X64_XMM dest, X64_XMM source);
+        void movmskps(X64_REG dest, X64_XMM source);
+        void cvttss2si_reg_mem(X64_REG dest, X64_REG base, int32_t disp);
+
+        //Jumps return the address of their rel32 field, which must later be patched with set_jump_dest
+        uint8_t* jcc(X64_COND cond);
+        uint8_t* jmp();
+        void set_jump_dest(uint8_t* jump, uint8_t* dest);
+};
+
+inline void X64Emitter::set_block_pos(uint8_t* pos)
+{
+    block_start = pos;
+    cur = pos;
+}
+
+inline uint8_t* X64Emitter::get_block_pos()
+{
+    return block_start;
+}
+
+inline uint8_t* X64Emitter::get_code_pos()
+{
+    return cur;
+}
+
+#endif // X64_EMITTER_HPP
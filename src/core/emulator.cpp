@@ -1,5 +1,8 @@
 #include <cstdio>
 #include <cstring>
+#ifdef __linux__
+#include <unistd.h>
+#endif
 #include "common/common.hpp"
 #include "emulator.hpp"
 
@@ -20,6 +23,8 @@ Emulator::Emulator() :
     CP15(2, &arm11[2], &arm11_mmu[2]),
     CP15(3, &arm11[3], &arm11_mmu[3]),
 },
+    arm9_io(this),
+    arm11_io(this),
     aes(&dma9, &int9),
     cartridge(&dma9, &int9),
     dma9(this, &int9, &scheduler),
@@ -32,7 +37,7 @@ Emulator::Emulator() :
     pxi(&mpcore_pmr, &int9),
     rsa(&int9),
     sha(&dma9),
-    timers(&int9, &mpcore_pmr, this),
+    timers(&int9, &mpcore_pmr, this, &scheduler),
     wifi(&cdma, &scheduler)
 {
     arm9_RAM = nullptr;
@@ -41,53 +46,72 @@ Emulator::Emulator() :
     dsp_mem = nullptr;
     vram = nullptr;
     qtm_ram = nullptr;
+
+    code_cache = nullptr;
+    parallel_arm11 = false;
+    fastmem_enabled = false;
+    adaptive_quantum = false;
+    core_count = 0;
+
+    vblank_start_event = scheduler.register_event("VBLANK start",
+        [this](uint64_t param) {mpcore_pmr.assert_hw_irq(0x2A); gpu.render_frame();});
+    vblank_end_event = scheduler.register_event("VBLANK end",
+        [this](uint64_t param) {mpcore_pmr.assert_hw_irq(0x2B); frame_ended = true;});
+    clockrate_event = scheduler.register_event("Clockrate change", [this](uint64_t param) {update_clockrate();});
 }
 
 Emulator::~Emulator()
 {
-    delete[] arm9_RAM;
-    delete[] axi_RAM;
-    delete[] fcram;
-    delete[] dsp_mem;
-    delete[] vram;
+    for (int i = 0; i < 4; i++)
+        arm11_fastmem[i].shutdown();
+
+    ram.free(arm9_RAM);
+    ram.free(axi_RAM);
+    ram.free(fcram);
+    ram.free(dsp_mem);
+    ram.free(vram);
+    ram.free(qtm_ram);
 }
 
 void Emulator::reset(bool cold_boot)
 {
+    //The core count may change, so the threads are started again on the next frame
+    arm11_threads.stop();
+
     is_n3ds = emmc.is_n3ds();
     if (is_n3ds)
     {
-        printf("[Emulator] Running as New3DS\n");
+        LOG(LOG_EMU, LOG_INFO, "[Emulator] Running as New3DS\n");
         core_count = 4;
         arm9_ram_size = 1024 * 1024 * 3 / 2;
         fcram_size = 1024 * 1024 * 256;
         qtm_size = 1024 * 1024 * 4;
-        delete[] qtm_ram;
-        qtm_ram = new uint8_t[qtm_size];
+        ram.free(qtm_ram);
+        qtm_ram = ram.alloc(qtm_size);
     }
     else
     {
-        printf("[Emulator] Running as Old3DS\n");
+        LOG(LOG_EMU, LOG_INFO, "[Emulator] Running as Old3DS\n");
         core_count = 2;
         arm9_ram_size = 1024 * 1024;
         fcram_size = 1024 * 1024 * 128;
         qtm_size = 0;
-        delete[] qtm_ram;
+        ram.free(qtm_ram);
         qtm_ram = nullptr;
     }
 
-    delete[] arm9_RAM;
-    delete[] fcram;
+    ram.free(arm9_RAM);
+    ram.free(fcram);
 
-    arm9_RAM = new uint8_t[arm9_ram_size];
-    fcram = new uint8_t[fcram_size];
+    arm9_RAM = ram.alloc(arm9_ram_size);
+    fcram = ram.alloc(fcram_size);
 
     if (!axi_RAM)
-        axi_RAM = new uint8_t[1024 * 512];
+        axi_RAM = ram.alloc(1024 * 512);
     if (!dsp_mem)
-        dsp_mem = new uint8_t[1024 * 512];
+        dsp_mem = ram.alloc(1024 * 512);
     if (!vram)
-        vram = new uint8_t[1024 * 1024 * 6];
+        vram = ram.alloc(1024 * 1024 * 6);
 
     mpcore_pmr.reset(core_count);
     timers.reset();
@@ -158,6 +182,14 @@ void Emulator::reset(bool cold_boot)
     config_cardctrl2 = 0;
     card_reset = 0;
 
+    //RAM was reallocated and its size depends on the model, so the IO tables are rebuilt too
+    map_arm9_io();
+    map_arm11_io();
+
+    //RAM was reallocated, so every host pointer the code caches know about is stale
+    jit.reset();
+    cached_interpreter.reset();
+
     arm9_pu.reset();
     arm9_pu.add_physical_mapping(arm9_RAM, 0x08000000, arm9_ram_size);
     arm9_pu.add_physical_mapping(dsp_mem, 0x1FF00000, 1024 * 512);
@@ -189,6 +221,8 @@ void Emulator::reset(bool cold_boot)
         arm11[i].reset();
     }
 
+    update_fastmem();
+
     scheduler.reset();
     scheduler.set_quantum_rate(ARM11_CLOCKRATE * 3);
     scheduler.set_clockrate_9(ARM9_CLOCKRATE);
@@ -196,38 +230,132 @@ void Emulator::reset(bool cold_boot)
     scheduler.set_clockrate_xtensa(XTENSA_CLOCKRATE);
 }
 
+void Emulator::set_cpu_backend(CPU_BACKEND backend)
+{
+    arm11_threads.stop();
+
+    switch (backend)
+    {
+        case BACKEND_JIT:
+            code_cache = &jit;
+            break;
+        case BACKEND_CACHED_INTERPRETER:
+            code_cache = &cached_interpreter;
+            break;
+        default:
+            code_cache = nullptr;
+            break;
+    }
+
+    arm9.set_code_cache(code_cache);
+    for (int i = 0; i < 4; i++)
+        arm11[i].set_code_cache(code_cache);
+
+    update_fastmem();
+}
+
+void Emulator::set_parallel_arm11(bool enabled)
+{
+    parallel_arm11 = enabled;
+    if (!enabled)
+        arm11_threads.stop();
+}
+
+void Emulator::set_fastmem(bool enabled)
+{
+    fastmem_enabled = enabled;
+    update_fastmem();
+}
+
+void Emulator::set_adaptive_quantum(bool enabled)
+{
+    adaptive_quantum = enabled;
+}
+
+//Number of host threads drawing triangles, including the emulation thread. The output doesn't depend on it.
+void Emulator::set_gpu_threads(int count)
+{
+    gpu.set_raster_threads(count);
+}
+
+void Emulator::set_shader_jit(bool enabled)
+{
+    gpu.set_shader_jit(enabled);
+}
+
+VertexCacheStats Emulator::get_vtx_cache_stats()
+{
+    return gpu.get_vtx_cache_stats();
+}
+
+void Emulator::update_fastmem()
+{
+    //The code caches rely on every RAM write going through a check_code_write, which fastmem would skip
+    bool use_fastmem = fastmem_enabled && !code_cache;
+    for (int i = 0; i < 4; i++)
+    {
+        if (use_fastmem && i < core_count && arm11_fastmem[i].init(&ram))
+        {
+            arm11_mmu[i].set_fastmem(&arm11_fastmem[i]);
+            arm11[i].set_fastmem(&arm11_fastmem[i]);
+        }
+        else
+        {
+            arm11_mmu[i].set_fastmem(nullptr);
+            arm11[i].set_fastmem(nullptr);
+            arm11_fastmem[i].shutdown();
+        }
+    }
+}
+
 void Emulator::run()
 {
+    //About 15 microseconds of ARM11 time
+    const static int64_t MAX_LONG_SLICE_CYCLES11 = 4096;
+
     i2c.update_time();
-    printf("FRAME %d\n", frames);
+    LOG(LOG_EMU, LOG_DEBUG, "FRAME %d\n", frames);
 
-    bool frame_ended = false;
+    frame_ended = false;
 
     //VBLANK start and end interrupts
-    scheduler.add_event([this](uint64_t param) {mpcore_pmr.assert_hw_irq(0x2A); gpu.render_frame();},
-        4000000, ARM11_CLOCKRATE);
-    scheduler.add_event([this, &frame_ended](uint64_t param) {mpcore_pmr.assert_hw_irq(0x2B); frame_ended = true;},
-        4400000, ARM11_CLOCKRATE);
+    scheduler.add_event(vblank_start_event, 4000000, ARM11_CLOCKRATE);
+    scheduler.add_event(vblank_end_event, 4400000, ARM11_CLOCKRATE);
     cartridge.save_check();
+
+    //The code caches are shared by every core, so only the interpreter can run the cores in parallel
+    if (parallel_arm11 && !code_cache && !arm11_threads.is_running())
+        arm11_threads.start(arm11, core_count);
+
     while (!frame_ended)
     {
-        scheduler.calculate_cycles_to_run();
+        //When nothing is running, the next event is the next thing that can wake anything up. Timer IRQs are events too.
+        if (is_idle())
+            scheduler.calculate_idle_cycles_to_run();
+        else if (adaptive_quantum && !needs_short_slices())
+            scheduler.calculate_long_cycles_to_run(MAX_LONG_SLICE_CYCLES11);
+        else
+            scheduler.calculate_cycles_to_run();
         int cycles11 = scheduler.get_cycles11_to_run();
         int cycles9 = scheduler.get_cycles9_to_run();
 
-        arm11[0].run(cycles11);
-        arm11[1].run(cycles11);
-
-        //TODO: Is it faster to always run the additional cores in Old3DS mode?
-        //Probably not, because the branch predictor should have an easy time with this
-        if (is_n3ds)
+        if (arm11_threads.is_running())
+            arm11_threads.run(cycles11);
+        else
         {
-            arm11[2].run(cycles11);
-            arm11[3].run(cycles11);
+            arm11[0].run(cycles11);
+            arm11[1].run(cycles11);
+
+            //TODO: Is it faster to always run the additional cores in Old3DS mode?
+            //Probably not, because the branch predictor should have an easy time with this
+            if (is_n3ds)
+            {
+                arm11[2].run(cycles11);
+                arm11[3].run(cycles11);
+            }
         }
 
         arm9.run(cycles9);
-        timers.run(cycles11, cycles9);
         dsp.run(cycles9);
         dma9.process_ndma_reqs();
         dma9.run_xdma();
@@ -237,11 +365,95 @@ void Emulator::run()
         wifi.run(xtensa_cycles);
         scheduler.process_events();
     }
+
+    for (int i = 0; i < core_count; i++)
+    {
+        TLB_Stats tlb_stats = arm11_mmu[i].get_tlb_stats();
+        LOG(LOG_EMU, LOG_DEBUG, "[ARM11_%d] TLB reloads: %llu ASID switches: %llu (%llu pages restored) Flushes: %llu\n",
+            i, (unsigned long long)tlb_stats.reloads, (unsigned long long)tlb_stats.asid_switches,
+            (unsigned long long)tlb_stats.restored_pages, (unsigned long long)tlb_stats.flushes);
+        arm11_mmu[i].reset_tlb_stats();
+    }
+
+    SliceStats slice_stats = scheduler.get_slice_stats();
+    static const char* slice_names[] = {"short", "long", "idle"};
+    for (int i = 0; i < SLICE_TYPE_COUNT; i++)
+    {
+        uint64_t count = slice_stats.count[i];
+        LOG(LOG_EMU, LOG_DEBUG, "[Scheduler] %s slices: %llu (%llu ARM11 cycles on average)\n", slice_names[i],
+            (unsigned long long)count, (unsigned long long)(count ? slice_stats.cycles11[i] / count : 0));
+    }
+    LOG(LOG_EMU, LOG_DEBUG, "[Scheduler] Longest slice: %llu ARM11 cycles, %llu slices ended by an event\n",
+        (unsigned long long)slice_stats.longest_cycles11, (unsigned long long)slice_stats.ended_by_event);
+    scheduler.reset_slice_stats();
+
+    print_io_stats("ARM9", arm9_io);
+    print_io_stats("ARM11", arm11_io);
     frames++;
 }
 
+void Emulator::print_io_stats(const char* cpu_name, IOTable& io)
+{
+    //The busiest pages of the frame, to show which peripherals are worth a faster path.
+    //Sorting the pages isn't free, so skip it when nobody will see the result.
+    if (LOG_ENABLED(LOG_EMU, LOG_DEBUG))
+    {
+        std::vector<IOPageStats> pages = io.get_hottest_pages(4);
+        for (IOPageStats& page : pages)
+        {
+            LOG(LOG_EMU, LOG_DEBUG, "[%s] IO page $%08X (%s): %llu accesses\n", cpu_name, page.addr, page.name,
+                (unsigned long long)page.accesses);
+        }
+    }
+    io.reset_stats();
+}
+
+void Emulator::update_clockrate()
+{
+    clock_ctrl |= 0x8000;
+    switch (clock_ctrl & 0x7)
+    {
+        case 0x1:
+            scheduler.set_clockrate_11(ARM11_CLOCKRATE);
+            LOG(LOG_EMU, LOG_INFO, "[ARM11] Set clockrate to 1x\n");
+            break;
+        case 0x3:
+            scheduler.set_clockrate_11(ARM11_CLOCKRATE * 2);
+            LOG(LOG_EMU, LOG_INFO, "[ARM11] Set clockrate to 2x\n");
+            break;
+        case 0x5:
+            scheduler.set_clockrate_11(ARM11_CLOCKRATE * 3);
+            LOG(LOG_EMU, LOG_INFO, "[ARM11] Set clockrate to 3x\n");
+            break;
+        default:
+            EmuException::die("[Emulator] Invalid clockrate $%02X given to MPCORE_CLKCNT", clock_ctrl & 0x7);
+    }
+    mpcore_pmr.assert_hw_irq(0x58);
+}
+
+bool Emulator::needs_short_slices()
+{
+    //Components signalling each other need to see the other side's response promptly, which long slices would delay.
+    //Check PXI first, as that also clears its activity flag for the next slice.
+    if (pxi.check_activity())
+        return true;
+    return dma9.is_active() || cdma.is_active() || !dsp.is_idle() || !wifi.is_idle();
+}
+
+bool Emulator::is_idle()
+{
+    for (int i = 0; i < core_count; i++)
+    {
+        if (!arm11[i].is_halted())
+            return false;
+    }
+    return arm9.is_halted() && dsp.is_idle() && wifi.is_idle() && !dma9.is_active() && !cdma.is_active();
+}
+
 void Emulator::print_state()
 {
+    //Get out whatever led up to this first
+    Log::flush();
     printf("--PRINTING STATE--\n");
     printf("ARM9 state\n");
     arm9.print_state();
@@ -255,6 +467,31 @@ void Emulator::print_state()
     printf("\n--END LOG--\n");
 }
 
+void Emulator::print_memory_usage()
+{
+    uint64_t guest_ram = arm9_ram_size + fcram_size + qtm_size;
+    guest_ram += (1024 * 512 * 2) + (1024 * 1024 * 6);
+
+    printf("--MEMORY USAGE--\n");
+    printf("Guest RAM: %llu KB\n", (unsigned long long)guest_ram / 1024);
+    printf("ARM9 PU tables: %llu KB\n", (unsigned long long)arm9_pu.get_memory_usage() / 1024);
+    for (int i = 0; i < core_count; i++)
+        printf("ARM11_%d MMU tables: %llu KB\n", i, (unsigned long long)arm11_mmu[i].get_memory_usage() / 1024);
+
+#ifdef __linux__
+    //Whole process, for comparison
+    unsigned long long size, resident;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm)
+    {
+        if (fscanf(statm, "%llu %llu", &size, &resident) == 2)
+            printf("Process RSS: %llu KB\n", resident * sysconf(_SC_PAGESIZE) / 1024);
+        fclose(statm);
+    }
+#endif
+    printf("--END LOG--\n");
+}
+
 void Emulator::dump()
 {
     std::ofstream hey("memdump.bin", std::ofstream::binary);
@@ -332,12 +569,12 @@ void Emulator::load_and_run_elf(uint8_t *elf, uint64_t size)
     uint16_t e_shnum = *(uint16_t*)&elf[0x30];
     uint16_t e_shstrndx = *(uint16_t*)&elf[0x32];
 
-    printf("Entry: $%08X\n", e_entry);
-    printf("Program header start: $%08X\n", e_phoff);
-    printf("Section header start: $%08X\n", e_shoff);
-    printf("Program header entries: %d\n", e_phnum);
-    printf("Section header entries: %d\n", e_shnum);
-    printf("Section header names index: %d\n", e_shstrndx);
+    LOG(LOG_EMU, LOG_DEBUG, "Entry: $%08X\n", e_entry);
+    LOG(LOG_EMU, LOG_DEBUG, "Program header start: $%08X\n", e_phoff);
+    LOG(LOG_EMU, LOG_DEBUG, "Section header start: $%08X\n", e_shoff);
+    LOG(LOG_EMU, LOG_DEBUG, "Program header entries: %d\n", e_phnum);
+    LOG(LOG_EMU, LOG_DEBUG, "Section header entries: %d\n", e_shnum);
+    LOG(LOG_EMU, LOG_DEBUG, "Section header names index: %d\n", e_shstrndx);
 
     for (unsigned int i = e_phoff; i < e_phoff + (e_phnum * 0x20); i += 0x20)
     {
@@ -345,13 +582,13 @@ void Emulator::load_and_run_elf(uint8_t *elf, uint64_t size)
         uint32_t p_paddr = *(uint32_t*)&elf[i + 0xC];
         uint32_t p_filesz = *(uint32_t*)&elf[i + 0x10];
         uint32_t p_memsz = *(uint32_t*)&elf[i + 0x14];
-        printf("\nProgram header\n");
-        printf("p_type: $%08X\n", *(uint32_t*)&elf[i]);
-        printf("p_offset: $%08X\n", p_offset);
-        printf("p_vaddr: $%08X\n", *(uint32_t*)&elf[i + 0x8]);
-        printf("p_paddr: $%08X\n", p_paddr);
-        printf("p_filesz: $%08X\n", p_filesz);
-        printf("p_memsz: $%08X\n", p_memsz);
+        LOG(LOG_EMU, LOG_DEBUG, "\nProgram header\n");
+        LOG(LOG_EMU, LOG_DEBUG, "p_type: $%08X\n", *(uint32_t*)&elf[i]);
+        LOG(LOG_EMU, LOG_DEBUG, "p_offset: $%08X\n", p_offset);
+        LOG(LOG_EMU, LOG_DEBUG, "p_vaddr: $%08X\n", *(uint32_t*)&elf[i + 0x8]);
+        LOG(LOG_EMU, LOG_DEBUG, "p_paddr: $%08X\n", p_paddr);
+        LOG(LOG_EMU, LOG_DEBUG, "p_filesz: $%08X\n", p_filesz);
+        LOG(LOG_EMU, LOG_DEBUG, "p_memsz: $%08X\n", p_memsz);
 
         int mem_w = p_paddr;
         for (unsigned int file_w = p_offset; file_w < (p_offset + p_filesz); file_w += 4)
@@ -371,1048 +608,1463 @@ void Emulator::load_and_run_elf(uint8_t *elf, uint64_t size)
     arm9.run(1024 * 1024);
 }
 
-uint8_t Emulator::arm9_read8(uint32_t addr)
+//For tests and benchmarks. The list is read from physical memory and runs to completion before this returns.
+void Emulator::run_gpu_command_list(uint32_t addr, uint32_t words)
 {
-    if (addr >= 0x08000000 && addr < 0x08000000 + arm9_ram_size)
-        return arm9_RAM[addr - 0x08000000];
-
-    if (addr >= 0x18000000 && addr < 0x18600000)
-        return gpu.read_vram<uint8_t>(addr);
-
-    if (addr >= 0x1000A040 && addr < 0x1000A080)
-        return sha.read_hash(addr);
-
-    if (addr >= 0x1000B000 && addr < 0x1000C000)
-        return rsa.read8(addr);
-
-    if (addr >= 0x10012000 && addr < 0x10012100)
-        return otp[addr & 0xFF];
-
-    if (addr >= 0x10144000 && addr < 0x10145000)
-        return i2c.read8(addr);
+    gpu.run_command_list(addr, words);
+}
 
-    if (addr >= 0x10148000 && addr < 0x10149000)
-        return i2c.read8(addr);
+void Emulator::map_arm9_io()
+{
+    arm9_io.reset();
 
-    if (addr >= 0x10160000 && addr < 0x10161000)
+    IODevice* unmapped = arm9_io.get_unmapped();
+    unmapped->read8 = [](Emulator*, int, uint32_t addr) -> uint8_t
     {
-        printf("[SPI2] Unrecognized read8 $%08X\n", addr);
+        EmuException::die("[ARM9] Invalid read8 $%08X\n", addr);
         return 0;
-    }
+    };
+    unmapped->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
+    {
+        EmuException::die("[ARM9] Invalid read16 $%08X\n", addr);
+        return 0;
+    };
+    unmapped->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        EmuException::die("[ARM9] Invalid read32 $%08X\n", addr);
+        return 0;
+    };
+    unmapped->write8 = [](Emulator*, int, uint32_t addr, uint8_t value)
+    {
+        EmuException::die("[ARM9] Invalid write8 $%08X: $%02X\n", addr, value);
+    };
+    unmapped->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
+    {
+        EmuException::die("[ARM9] Invalid write16 $%08X: $%04X\n", addr, value);
+    };
+    unmapped->write32 = [](Emulator*, int, uint32_t addr, uint32_t value)
+    {
+        EmuException::die("[ARM9] Invalid write32 $%08X: $%08X\n", addr, value);
+    };
 
-    if (addr >= 0x10161000 && addr < 0x10162000)
-        return i2c.read8(addr);
-
-    switch (addr)
-    {
-        case 0x10000000:
-            return sysprot9;
-        case 0x10000001:
-            return sysprot11;
-        case 0x10000002:
-            return 0; //Related to powering on ARM11?
-        case 0x10000008:
-            return 0; //AES related
-        case 0x1000000C:
-            return config_cardselect;
-        case 0x10000010:
+    IODevice* config_io = arm9_io.add_device("CONFIG9", 0x10000000, 0x1000);
+    config_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
+    {
+        switch (addr)
         {
-            uint8_t reg = config_cardctrl2;
-
-            if (!cartridge.card_inserted())
-                reg |= 1;
-
-            if (card_reset)
+            case 0x10000000:
+                return e->sysprot9;
+            case 0x10000001:
+                return e->sysprot11;
+            case 0x10000002:
+                return 0; //Related to powering on ARM11?
+            case 0x10000008:
+                return 0; //AES related
+            case 0x1000000C:
+                return e->config_cardselect;
+            case 0x10000010:
             {
-                card_reset--;
-                if (!card_reset)
-                    config_cardctrl2 = 0;
-            }
-
-            //printf("[ARM9] Read8 CARD_CFG2: $%02X\n", reg);
-            return reg;
-        }
-        case 0x10000200:
-            return 0; //New3DS memory hidden
-        case 0x10008000:
-            return pxi.read_sync9() & 0xFF;
-        case 0x10008003:
-            return pxi.read_sync9() >> 24;
-        case 0x10009011:
-            return aes.read_keycnt();
-        case 0x10010010:
-            return 0; //0=retail, 1=dev
-        case 0x10010014:
-            return 0;
-        case 0x10141200:
-            return 1;
-    }
-
-    EmuException::die("[ARM9] Invalid read8 $%08X\n", addr);
-    return 0;
-}
-
-uint16_t Emulator::arm9_read16(uint32_t addr)
-{
-    if (addr >= 0x10003000 && addr < 0x10004000)
-        return timers.arm9_read16(addr);
-
-    if (addr >= 0x10006000 && addr < 0x10007000)
-        return emmc.read16(addr);
+                uint8_t reg = e->config_cardctrl2;
 
-    //PRNG - TODO
-    if (addr >= 0x10011000 && addr < 0x10012000)
-    {
-        printf("[ARM9] Read16 PRNG\n");
-        return addr & 0xFFFF;
-    }
+                if (!e->cartridge.card_inserted())
+                    reg |= 1;
 
-    if (addr >= 0x10122000 && addr < 0x10123000)
-        return wifi.read16(addr);
+                if (e->card_reset)
+                {
+                    e->card_reset--;
+                    if (!e->card_reset)
+                        e->config_cardctrl2 = 0;
+                }
 
-    if (addr >= 0x10160000 && addr < 0x10161000)
+                //printf("[ARM9] Read8 CARD_CFG2: $%02X\n", reg);
+                return reg;
+            }
+            case 0x10000200:
+                return 0; //New3DS memory hidden
+        }
+        return e->arm9_io.get_unmapped()->read8(e, core, addr);
+    };
+    config_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
     {
-        printf("[SPI2] Unrecognized read16 $%08X\n", addr);
-        return 0;
-    }
-
-    if (addr >= 0x10164000 && addr < 0x10165000)
-        return cartridge.read16_ntr(addr);
-
-    switch (addr)
+        switch (addr)
+        {
+            case 0x10000004:
+                return 0; //debug control?
+            case 0x1000000C:
+                return e->config_cardselect; //card select
+            case 0x10000020:
+                return 0;
+            case 0x10000FFC:
+                return 0;
+        }
+        return e->arm9_io.get_unmapped()->read16(e, core, addr);
+    };
+    config_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        case 0x10000004:
-            return 0; //debug control?
-        case 0x1000000C:
-            return config_cardselect; //card select
-        case 0x10000020:
+        if (addr == 0x10000FFC)
             return 0;
-        case 0x10000FFC:
-            return 0;
-        case 0x10008004:
-            return pxi.read_cnt9();
-        case 0x10140FFC:
-            return 0x5 | (is_n3ds << 1);
-        case 0x10146000:
-            return HID_PAD; //bits on = keys not pressed
-    }
-
-    EmuException::die("[ARM9] Invalid read16 $%08X\n", addr);
-    return 0;
-}
-
-uint32_t Emulator::arm9_read32(uint32_t addr)
-{
-    if (addr >= 0x10142000 && addr < 0x10144000)
-        return spi.read32(addr);
-
-    if (addr >= 0x08000000 && addr < 0x08000000 + arm9_ram_size)
-        return *(uint32_t*)&arm9_RAM[addr - 0x08000000];
-
-    if (addr >= 0x18000000 && addr < 0x18600000)
-        return gpu.read_vram<uint32_t>(addr);
-
-    if (addr >= 0x10002000 && addr < 0x10003000)
-        return dma9.read32_ndma(addr);
-
-    if (addr >= 0x10004000 && addr < 0x10006000)
-        return cartridge.read32_ctr(addr);
-
-    if (addr >= 0x10006000 && addr < 0x10007000)
-        return emmc.read32(addr);
-
-    if (addr >= 0x10009000 && addr < 0x1000A000)
-        return aes.read32(addr);
-
-    if (addr >= 0x1000A000 && addr < 0x1000B000)
-        return sha.read32(addr);
-
-    if (addr >= 0x1000B000 && addr < 0x1000C000)
-        return rsa.read32(addr);
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
+    config_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
+    {
+        switch (addr)
+        {
+            case 0x10000000:
+                //Disable access to sensitive parts of boot ROM
+                if (value & 0x1)
+                {
+                    e->arm9_pu.remove_physical_mapping(0xFFFF0000, 1024 * 64);
+                    e->arm9_pu.add_physical_mapping(e->boot9_locked, 0xFFFF0000, 1024 * 64);
+                    if (e->code_cache)
+                        e->code_cache->flush_all_lookups();
+                }
 
-    if (addr >= 0x1000C000 && addr < 0x1000D000)
-        return dma9.read32_xdma(addr);
+                //Disable access to OTP
+                if (value & 0x2)
+                    e->otp = e->otp_locked;
 
-    if (addr >= 0x1000D800 && addr < 0x1000E000)
-        return cartridge.read32_spicard(addr);
+                e->sysprot9 = value;
+                return;
+            case 0x10000001:
+                if (value & 0x1)
+                {
+                    for (int i = 0; i < e->core_count; i++)
+                    {
+                        e->arm11_mmu[i].remove_physical_mapping(0, 1024 * 64);
+                        e->arm11_mmu[i].remove_physical_mapping(0x10000, 1024 * 64);
+
+                        e->arm11_mmu[i].add_physical_mapping(e->boot11_locked, 0, 1024 * 64);
+                        e->arm11_mmu[i].add_physical_mapping(e->boot11_locked, 0x10000, 1024 * 64);
+                    }
+                    if (e->code_cache)
+                        e->code_cache->flush_all_lookups();
+                }
 
-    if (addr >= 0x10011000 && addr < 0x10012000)
+                e->sysprot11 = value;
+                return;
+            case 0x10000002:
+                return;
+            case 0x10000008:
+                return;
+            case 0x10000010:
+                LOG(LOG_EMU, LOG_DEBUG, "[ARM9] Write8 CARD_CFG2: $%02X\n", value);
+                e->config_cardctrl2 = value;
+                if ((value & 0x0C) == 0x0C)
+                    e->card_reset = 10;
+                return;
+            case 0x10000200:
+                return; //supposed to control how much FCRAM N3DS has - ignore because we do O3DS for now
+        }
+        e->arm9_io.get_unmapped()->write8(e, core, addr, value);
+    };
+    config_io->write16 = [](Emulator* e, int core, uint32_t addr, uint16_t value)
     {
-        if (addr == 0x10011000)
-            return rand(); //TODO: Make a proper RNG out of this
-        printf("[ARM9] Unrecognized read32 from PRNG $%08X\n", addr);
-        return 0;
-    }
-
-    if (addr >= 0x10012000 && addr < 0x10012100)
-        return *(uint32_t*)&otp[addr & 0xFF];
-
-    if (addr >= 0x10122000 && addr < 0x10123000)
+        switch (addr)
+        {
+            case 0x10000004:
+                return;
+            case 0x1000000C:
+                LOG(LOG_EMU, LOG_DEBUG, "[CFG9] Write cardselect: $%04X\n", value);
+                e->config_cardselect = value;
+                return;
+            case 0x10000012:
+                return;
+            case 0x10000014:
+                return;
+            case 0x10000020:
+                return;
+        }
+        e->arm9_io.get_unmapped()->write16(e, core, addr, value);
+    };
+    config_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
     {
-        uint32_t value = wifi.read16(addr);
-        value |= wifi.read16(addr + 2) << 16;
-        return value;
-    }
-
-    if (addr >= 0x10164000 && addr < 0x10165000)
-        return cartridge.read32_ntr(addr);
-
-    if (addr >= 0x1FF80000 && addr < 0x20000000)
-        return *(uint32_t*)&axi_RAM[addr & 0x7FFFF];
+        if (addr == 0x10000020)
+        {
+            LOG(LOG_EMU, LOG_DEBUG, "[ARM9] Set SDMMCCTL: $%08X\n", value);
+            return;
+        }
+        e->arm9_io.get_unmapped()->write32(e, core, addr, value);
+    };
 
-    switch (addr)
+    IODevice* irq_io = arm9_io.add_device("IRQ9", 0x10001000, 0x1000);
+    irq_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        case 0x10000FFC:
-            return 0;
-        case 0x10001000:
-            return int9.read_ie();
-        case 0x10001004:
-            return int9.read_if();
-        case 0x10008000:
-            return pxi.read_sync9();
-        case 0x10008004:
-            return pxi.read_cnt9();
-        case 0x1000800C:
-            return pxi.read_msg9();
-        case 0x10010000:
-            return config_bootenv;
-        case 0x101401C0:
-            return 0; //SPI control
-        case 0x10140FFC:
-            return 0x5 | (is_n3ds << 1);
-        case 0x10141200:
-            return 0; //GPU power config
-        case 0x10146000:
-            return HID_PAD;
-    }
-
-    EmuException::die("[ARM9] Invalid read32 $%08X\n", addr);
-    return 0;
-}
+        switch (addr)
+        {
+            case 0x10001000:
+                return e->int9.read_ie();
+            case 0x10001004:
+                return e->int9.read_if();
+        }
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
+    irq_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
+    {
+        switch (addr)
+        {
+            case 0x10001000:
+                e->int9.write_ie(value);
+                return;
+            case 0x10001004:
+                e->int9.write_if(value);
+                return;
+        }
+        e->arm9_io.get_unmapped()->write32(e, core, addr, value);
+    };
 
-void Emulator::arm9_write8(uint32_t addr, uint8_t value)
-{
-    if (addr >= 0x18000000 && addr < 0x18600000)
+    IODevice* ndma_io = arm9_io.add_device("NDMA", 0x10002000, 0x1000);
+    ndma_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        gpu.write_vram<uint8_t>(addr, value);
-        return;
-    }
-    if (addr >= 0x10144000 && addr < 0x10145000)
+        return e->dma9.read32_ndma(addr);
+    };
+    ndma_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        i2c.write8(addr, value);
-        return;
-    }
-    if (addr >= 0x10160000 && addr < 0x10161000)
+        e->dma9.write32_ndma(addr, value);
+    };
+
+    IODevice* timer_io = arm9_io.add_device("TIMER9", 0x10003000, 0x1000);
+    timer_io->read16 = [](Emulator* e, int, uint32_t addr) -> uint16_t
     {
-        printf("[SPI2] Unrecognized write8 $%08X: $%02X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10164000 && addr < 0x10165000)
+        return e->timers.arm9_read16(addr);
+    };
+    timer_io->write16 = [](Emulator* e, int, uint32_t addr, uint16_t value)
     {
-        cartridge.write8_ntr(addr, value);
-        return;
-    }
-    if (addr >= 0x10004000 && addr < 0x10005000)
+        e->timers.arm9_write16(addr, value);
+    };
+    timer_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        cartridge.write8_ctr(addr, value);
-        return;
-    }
-    if (addr >= 0x1000B000 && addr < 0x1000C000)
+        e->timers.arm9_write16(addr, value & 0xFFFF);
+        e->timers.arm9_write16(addr + 2, value >> 16);
+    };
+
+    IODevice* ctrcard_io = arm9_io.add_device("CTRCARD", 0x10004000, 0x2000);
+    ctrcard_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        rsa.write8(addr, value);
-        return;
-    }
-    if (addr >= 0x10008000 && addr < 0x10008004)
-    {
-        uint32_t sync = pxi.read_sync9();
-        int shift = (addr & 0x3) * 8;
-        int mask = ~(0xFF << shift);
-        sync &= mask;
-        pxi.write_sync9(sync | (value << shift));
-        return;
-    }
-    switch (addr)
+        return e->cartridge.read32_ctr(addr);
+    };
+    ctrcard_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
     {
-        case 0x10000000:
-            //Disable access to sensitive parts of boot ROM
-            if (value & 0x1)
-            {
-                arm9_pu.remove_physical_mapping(0xFFFF0000, 1024 * 64);
-                arm9_pu.add_physical_mapping(boot9_locked, 0xFFFF0000, 1024 * 64);
-            }
-
-            //Disable access to OTP
-            if (value & 0x2)
-                otp = otp_locked;
-
-            sysprot9 = value;
-            return;
-        case 0x10000001:
-            if (value & 0x1)
-            {
-                for (int i = 0; i < core_count; i++)
-                {
-                    arm11_mmu[i].remove_physical_mapping(0, 1024 * 64);
-                    arm11_mmu[i].remove_physical_mapping(0x10000, 1024 * 64);
-
-                    arm11_mmu[i].add_physical_mapping(boot11_locked, 0, 1024 * 64);
-                    arm11_mmu[i].add_physical_mapping(boot11_locked, 0x10000, 1024 * 64);
-                }
-            }
-
-            sysprot11 = value;
-            return;
-        case 0x10000002:
-            return;
-        case 0x10000008:
-            return;
-        case 0x10000010:
-            printf("[ARM9] Write8 CARD_CFG2: $%02X\n", value);
-            config_cardctrl2 = value;
-            if ((value & 0x0C) == 0x0C)
-                card_reset = 10;
-            return;
-        case 0x10000200:
-            return; //supposed to control how much FCRAM N3DS has - ignore because we do O3DS for now
-        case 0x10009010:
-            aes.write_keysel(value);
-            return;
-        case 0x10009011:
-            aes.write_keycnt(value);
-            return;
-        case 0x10010014:
+        if (addr >= 0x10005000)
+        {
+            e->arm9_io.get_unmapped()->write8(e, core, addr, value);
             return;
-    }
-    EmuException::die("[ARM9] Invalid write8 $%08X: $%02X\n", addr, value);
-}
-
-void Emulator::arm9_write16(uint32_t addr, uint16_t value)
-{
-    if (addr >= 0x10003000 && addr < 0x10004000)
+        }
+        e->cartridge.write8_ctr(addr, value);
+    };
+    ctrcard_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        timers.arm9_write16(addr, value);
-        return;
-    }
-    if (addr >= 0x10006000 && addr < 0x10007000)
+        e->cartridge.write32_ctr(addr, value);
+    };
+
+    IODevice* emmc_io = arm9_io.add_device("EMMC", 0x10006000, 0x1000);
+    emmc_io->read16 = [](Emulator* e, int, uint32_t addr) -> uint16_t
     {
-        emmc.write16(addr, value);
-        return;
-    }
-    if (addr >= 0x10122000 && addr < 0x10123000)
+        return e->emmc.read16(addr);
+    };
+    emmc_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        wifi.write16(addr, value);
-        return;
-    }
-    if (addr >= 0x10144000 && addr < 0x10145000)
+        return e->emmc.read32(addr);
+    };
+    emmc_io->write16 = [](Emulator* e, int, uint32_t addr, uint16_t value)
     {
-        printf("[A9 I2C] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10148000 && addr < 0x10149000)
+        e->emmc.write16(addr, value);
+    };
+    emmc_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        printf("[A9 I2C] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10160000 && addr < 0x10161000)
+        e->emmc.write32(addr, value);
+    };
+
+    IODevice* pxi_io = arm9_io.add_device("PXI9", 0x10008000, 0x1000);
+    pxi_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
     {
-        printf("[SPI2] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10161000 && addr < 0x10162000)
+        switch (addr)
+        {
+            case 0x10008000:
+                return e->pxi.read_sync9() & 0xFF;
+            case 0x10008003:
+                return e->pxi.read_sync9() >> 24;
+        }
+        return e->arm9_io.get_unmapped()->read8(e, core, addr);
+    };
+    pxi_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
     {
-        printf("[A9 I2C] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10164000 && addr < 0x10165000)
+        if (addr == 0x10008004)
+            return e->pxi.read_cnt9();
+        return e->arm9_io.get_unmapped()->read16(e, core, addr);
+    };
+    pxi_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        cartridge.write16_ntr(addr, value);
-        return;
-    }
-    switch (addr)
+        switch (addr)
+        {
+            case 0x10008000:
+                return e->pxi.read_sync9();
+            case 0x10008004:
+                return e->pxi.read_cnt9();
+            case 0x1000800C:
+                return e->pxi.read_msg9();
+        }
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
+    pxi_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
     {
-        case 0x10000004:
+        if (addr < 0x10008004)
+        {
+            uint32_t sync = e->pxi.read_sync9();
+            int shift = (addr & 0x3) * 8;
+            int mask = ~(0xFF << shift);
+            sync &= mask;
+            e->pxi.write_sync9(sync | (value << shift));
             return;
-        case 0x1000000C:
-            printf("[CFG9] Write cardselect: $%04X\n", value);
-            config_cardselect = value;
-            return;
-        case 0x10000012:
-            return;
-        case 0x10000014:
-            return;
-        case 0x10000020:
-            return;
-        case 0x10008004:
-            pxi.write_cnt9(value);
-            return;
-        case 0x10009004:
-            aes.write_mac_count(value);
-            return;
-        case 0x10009006:
-            aes.write_block_count(value);
-            return;
-    }
-    EmuException::die("[ARM9] Invalid write16 $%08X: $%04X\n", addr, value);
-}
-
-void Emulator::arm9_write32(uint32_t addr, uint32_t value)
-{
-    if (addr >= 0x10003000 && addr < 0x10004000)
+        }
+        e->arm9_io.get_unmapped()->write8(e, core, addr, value);
+    };
+    pxi_io->write16 = [](Emulator* e, int core, uint32_t addr, uint16_t value)
     {
-        timers.arm9_write16(addr, value & 0xFFFF);
-        timers.arm9_write16(addr + 2, value >> 16);
-        return;
-    }
-    if (addr >= 0x08000000 && addr < 0x08000000 + arm9_ram_size)
+        if (addr == 0x10008004)
+        {
+            e->pxi.write_cnt9(value);
+            return;
+        }
+        e->arm9_io.get_unmapped()->write16(e, core, addr, value);
+    };
+    pxi_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
     {
-        *(uint32_t*)&arm9_RAM[addr - 0x08000000] = value;
-        return;
-    }
-    if (addr >= 0x1FF80000 && addr < 0x20000000)
+        switch (addr)
+        {
+            case 0x10008000:
+                e->pxi.write_sync9(value);
+                return;
+            case 0x10008004:
+                e->pxi.write_cnt9(value & 0xFFFF);
+                return;
+            case 0x10008008:
+                e->pxi.send_to_11(value);
+                return;
+        }
+        e->arm9_io.get_unmapped()->write32(e, core, addr, value);
+    };
+
+    IODevice* aes_io = arm9_io.add_device("AES", 0x10009000, 0x1000);
+    aes_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
     {
-        *(uint32_t*)&axi_RAM[addr & 0x7FFFF] = value;
-        return;
-    }
-    if (addr >= 0x18000000 && addr < 0x18600000)
+        if (addr == 0x10009011)
+            return e->aes.read_keycnt();
+        return e->arm9_io.get_unmapped()->read8(e, core, addr);
+    };
+    aes_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        gpu.write_vram<uint32_t>(addr, value);
-        return;
-    }
-    if (addr >= 0x10002000 && addr < 0x10003000)
+        return e->aes.read32(addr);
+    };
+    aes_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
     {
-        dma9.write32_ndma(addr, value);
-        return;
-    }
-    if (addr >= 0x10004000 && addr < 0x10006000)
+        switch (addr)
+        {
+            case 0x10009010:
+                e->aes.write_keysel(value);
+                return;
+            case 0x10009011:
+                e->aes.write_keycnt(value);
+                return;
+        }
+        e->arm9_io.get_unmapped()->write8(e, core, addr, value);
+    };
+    aes_io->write16 = [](Emulator* e, int core, uint32_t addr, uint16_t value)
     {
-        cartridge.write32_ctr(addr, value);
-        return;
-    }
-    if (addr >= 0x10006000 && addr < 0x10007000)
+        switch (addr)
+        {
+            case 0x10009004:
+                e->aes.write_mac_count(value);
+                return;
+            case 0x10009006:
+                e->aes.write_block_count(value);
+                return;
+        }
+        e->arm9_io.get_unmapped()->write16(e, core, addr, value);
+    };
+    aes_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        emmc.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x10009000 && addr < 0x1000A000)
+        e->aes.write32(addr, value);
+    };
+
+    IODevice* sha_io = arm9_io.add_device("SHA", 0x1000A000, 0x1000);
+    sha_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
     {
-        aes.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x1000A000 && addr < 0x1000B000)
+        if (addr >= 0x1000A040 && addr < 0x1000A080)
+            return e->sha.read_hash(addr);
+        return e->arm9_io.get_unmapped()->read8(e, core, addr);
+    };
+    sha_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        sha.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x1000B000 && addr < 0x1000C000)
+        return e->sha.read32(addr);
+    };
+    sha_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        rsa.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x1000C000 && addr < 0x1000D000)
+        e->sha.write32(addr, value);
+    };
+
+    IODevice* rsa_io = arm9_io.add_device("RSA", 0x1000B000, 0x1000);
+    rsa_io->read8 = [](Emulator* e, int, uint32_t addr) -> uint8_t
     {
-        dma9.write32_xdma(addr, value);
-        return;
-    }
-    if (addr >= 0x1000D800 && addr < 0x1000E000)
+        return e->rsa.read8(addr);
+    };
+    rsa_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        cartridge.write32_spicard(addr, value);
-        return;
-    }
-
-    if (addr >= 0x10012100 && addr < 0x10012108)
+        return e->rsa.read32(addr);
+    };
+    rsa_io->write8 = [](Emulator* e, int, uint32_t addr, uint8_t value)
     {
-        printf("TWL consoleid $%08X: $%08X\n", addr, value);
-        *(uint32_t*)&twl_consoleid[addr & 0x7] = value;
-        return;
-    }
-
-    if (addr >= 0x10122000 && addr < 0x10123000)
+        e->rsa.write8(addr, value);
+    };
+    rsa_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        wifi.write16(addr, value & 0xFFFF);
-        wifi.write16(addr + 2, value >> 16);
-        return;
-    }
-
-    if (addr >= 0x10160000 && addr < 0x10161000)
-        spi.write32(addr, value);
+        e->rsa.write32(addr, value);
+    };
 
-    if (addr >= 0x10164000 && addr < 0x10165000)
+    IODevice* xdma_io = arm9_io.add_device("XDMA", 0x1000C000, 0x1000);
+    xdma_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        cartridge.write32_ntr(addr, value);
-        return;
-    }
-
-    if (addr >= 0x1FF00000 && addr < 0x1FF80000)
+        return e->dma9.read32_xdma(addr);
+    };
+    xdma_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        *(uint32_t*)&dsp_mem[addr & 0x7FFFF] = value;
-        return;
-    }
+        e->dma9.write32_xdma(addr, value);
+    };
 
-    if (addr >= 0x20000000 && addr < 0x20000000 + fcram_size)
+    //SPICARD only takes up the upper half of its page
+    IODevice* spicard_io = arm9_io.add_device("SPICARD", 0x1000D000, 0x1000);
+    spicard_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        *(uint32_t*)&fcram[addr & (fcram_size - 1)] = value;
-        return;
-    }
-
-    switch (addr)
+        if (addr >= 0x1000D800)
+            return e->cartridge.read32_spicard(addr);
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
+    spicard_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
     {
-        case 0x10000020:
-            printf("[ARM9] Set SDMMCCTL: $%08X\n", value);
-            return;
-        case 0x10001000:
-            int9.write_ie(value);
-            return;
-        case 0x10001004:
-            int9.write_if(value);
-            return;
-        case 0x10008000:
-            pxi.write_sync9(value);
-            return;
-        case 0x10008004:
-            pxi.write_cnt9(value & 0xFFFF);
-            return;
-        case 0x10008008:
-            pxi.send_to_11(value);
-            return;
-        case 0x10010000:
-            config_bootenv = value;
+        if (addr >= 0x1000D800)
+        {
+            e->cartridge.write32_spicard(addr, value);
             return;
-    }
-    EmuException::die("[ARM9] Invalid write32 $%08X: $%08X\n", addr, value);
-}
-
-uint8_t Emulator::arm11_read8(int core, uint32_t addr)
-{
-    if (addr >= 0x10140000 && addr < 0x10140010)
-        return dsp_mem_config[addr & 0xF];
-    if (addr >= 0x10144000 && addr < 0x10145000)
-        return i2c.read8(addr);
-    if (addr >= 0x10147000 && addr < 0x10148000)
-    {
-        printf("[GPIO] Unrecognized read8 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x10148000 && addr < 0x10149000)
-        return i2c.read8(addr);
-    if (addr >= 0x10161000 && addr < 0x10162000)
-        return i2c.read8(addr);
-    if (addr >= 0x17E00000 && addr < 0x17E02000)
-        return mpcore_pmr.read8(core, addr);
-    if (addr >= 0x18000000 && addr < 0x18600000)
-        return gpu.read_vram<uint8_t>(addr);
-    if (addr >= 0x20000000 && addr < 0x20000000 + fcram_size)
-        return fcram[addr & (fcram_size - 1)];
-    if (addr >= 0x1FF80000 && addr < 0x20000000)
-        return axi_RAM[addr & 0x0007FFFF];
-    switch (addr)
-    {
-        case 0x1014010C:
-            return 0;
-        case 0x10140180:
-            return 0; //WiFi power
-        case 0x10140420:
-            return 0;
-        case 0x10141204:
-            return 1; //GPU power
-        case 0x10141208:
-            return 0; //Unk GPU power reg
-        case 0x10141220:
-            return 0; //Enable FCRAM?
-        case 0x10141224:
-            return 0; //Camera power
-        case 0x10141230:
-            return 0; //DSP power
-        case 0x10141310:
-        case 0x10141311:
-        case 0x10141312:
-        case 0x10141313:
-            return boot_ctrl[addr - 0x10141310];
-        case 0x10163000:
-        case 0x10163001:
-        case 0x10163002:
-        case 0x10163003:
-            return (pxi.read_sync11() >> ((addr & 0x3) * 8)) & 0xFF;
-    }
-    EmuException::die("[ARM11] Invalid read8 $%08X\n", addr);
-    return 0;
-}
+        }
+        e->arm9_io.get_unmapped()->write32(e, core, addr, value);
+    };
 
-uint16_t Emulator::arm11_read16(int core, uint32_t addr)
-{
-    if (addr >= 0x10103000 && addr < 0x10104000)
+    IODevice* config_ext_io = arm9_io.add_device("CONFIG9 ext", 0x10010000, 0x1000);
+    config_ext_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
     {
-        printf("[CSND] Unrecognized read16 $%08X\n", addr);
-        return 0;
-    }
-    if ((addr >= 0x10102000 && addr < 0x10103000) || (addr >= 0x10120000 && addr < 0x10122000))
-    {
-        printf("[Y2R] Unrecognized read16 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x10122000 && addr < 0x10123000)
-        return wifi.read16(addr);
-    if (addr >= 0x10145000 && addr < 0x10146000)
-    {
-        printf("[CODEC] Unrecognized read16 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x10147000 && addr < 0x10148000)
+        switch (addr)
+        {
+            case 0x10010010:
+                return 0; //0=retail, 1=dev
+            case 0x10010014:
+                return 0;
+        }
+        return e->arm9_io.get_unmapped()->read8(e, core, addr);
+    };
+    config_ext_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        printf("[GPIO] Unrecognized read16 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x10161000 && addr < 0x10162000)
+        if (addr == 0x10010000)
+            return e->config_bootenv;
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
+    config_ext_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
     {
-        printf("[I2C] Unrecognized read8 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x10162000 && addr < 0x10163000)
+        if (addr == 0x10010014)
+            return;
+        e->arm9_io.get_unmapped()->write8(e, core, addr, value);
+    };
+    config_ext_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
     {
-        printf("[MIC] Unrecognized read16 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x10203000 && addr < 0x10204000)
-        return dsp.read16(addr);
-    if (addr >= 0x20000000 && addr < 0x20000000 + fcram_size)
-        return *(uint16_t*)&fcram[addr & (fcram_size - 1)];
-    if (addr >= 0x18000000 && addr < 0x18600000)
-        return gpu.read_vram<uint16_t>(addr);
-    switch (addr)
-    {
-        case 0x101401C0:
-            return 0x7; //3DS/DS SPI switch
-        case 0x10140FFC:
-            return 0x5 | (is_n3ds << 1);
-        case 0x10141114:
-        case 0x10141116:
-            return 0;
-        case 0x10141300:
-            return clock_ctrl;
-        case 0x10141304:
-            return 0;
-        case 0x10146000:
-            return HID_PAD;
-        case 0x10163004:
-            return pxi.read_cnt11();
-    }
-    EmuException::die("[ARM11] Invalid read16 $%08X\n", addr);
-    return 0;
-}
+        if (addr == 0x10010000)
+        {
+            e->config_bootenv = value;
+            return;
+        }
+        e->arm9_io.get_unmapped()->write32(e, core, addr, value);
+    };
 
-uint32_t Emulator::arm11_read32(int core, uint32_t addr)
-{
-    if (addr >= 0x17E00000 && addr < 0x17E02000)
+    //PRNG - TODO
+    IODevice* prng_io = arm9_io.add_device("PRNG", 0x10011000, 0x1000);
+    prng_io->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
     {
-        //Bit of a hack: Since we do not handle accurate ARM11 timings, we shave off a cycle for MPR reads.
-        //At a 3x clock multipler, Kernel11 requires a 6 cycle difference between two timer reads, but there are
-        //only 5 instructions between the reads. Without handling this, threads will sleep for 0xFFFFFFFF cycles.
-        arm11[core].inc_cycle_count(1);
-        return mpcore_pmr.read32(core, addr);
-    }
-    if (addr >= 0x17E10000 && addr < 0x17E11000)
+        LOG(LOG_IO, LOG_DEBUG, "[ARM9] Read16 PRNG\n");
+        return addr & 0xFFFF;
+    };
+    prng_io->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
     {
-        printf("[L2C] Unrecognized read32 $%08X\n", addr);
+        if (addr == 0x10011000)
+            return rand(); //TODO: Make a proper RNG out of this
+        LOG(LOG_IO, LOG_WARN, "[ARM9] Unrecognized read32 from PRNG $%08X\n", addr);
         return 0;
-    }
-    if (addr >= 0x10103000 && addr < 0x10104000)
+    };
+
+    IODevice* otp_io = arm9_io.add_device("OTP", 0x10012000, 0x1000);
+    otp_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
     {
-        printf("[CSND] Unrecognized read32 $%08X\n", addr);
-        return 0;
-    }
-    if ((addr >= 0x10102000 && addr < 0x10103000) || (addr >= 0x10120000 && addr < 0x10122000))
+        if (addr < 0x10012100)
+            return e->otp[addr & 0xFF];
+        return e->arm9_io.get_unmapped()->read8(e, core, addr);
+    };
+    otp_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        printf("[Y2R] Unrecognized read32 $%08X\n", addr);
-        return 0;
-    }
-    if ((addr >= 0x10200000 && addr < 0x10201000) || (addr >= 0x10206000 && addr < 0x10207000))
-        return cdma.read32(addr);
-    if (addr >= 0x10400000 && addr < 0x10402000)
-        return gpu.read32(addr);
-    if (addr >= 0x18000000 && addr < 0x18600000)
-        return gpu.read_vram<uint32_t>(addr);
-    if (addr >= 0x10101000 && addr < 0x10102000)
-        return hash.read32(addr);
-    if (addr >= 0x10202000 && addr < 0x10203000)
-    {
-        printf("[LCD] Unrecognized read $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x10142800 && addr < 0x10144000)
-        return spi.read32(addr);
-    if (addr >= 0x10147000 && addr < 0x10148000)
+        if (addr < 0x10012100)
+            return *(uint32_t*)&e->otp[addr & 0xFF];
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
+    otp_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
     {
-        printf("[GPIO] Unrecognized read32 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x10160000 && addr < 0x10161000)
-        return spi.read32(addr);
-    if (addr >= 0x10162000 && addr < 0x10163000)
+        if (addr >= 0x10012100 && addr < 0x10012108)
+        {
+            LOG(LOG_EMU, LOG_DEBUG, "TWL consoleid $%08X: $%08X\n", addr, value);
+            *(uint32_t*)&e->twl_consoleid[addr & 0x7] = value;
+            return;
+        }
+        e->arm9_io.get_unmapped()->write32(e, core, addr, value);
+    };
+
+    IODevice* wifi_io = arm9_io.add_device("WIFI", 0x10122000, 0x1000);
+    wifi_io->read16 = [](Emulator* e, int, uint32_t addr) -> uint16_t
     {
-        printf("[MIC] Unrecognized read32 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x1020F000 && addr < 0x10210000)
+        return e->wifi.read16(addr);
+    };
+    wifi_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        printf("[AXI] Unrecognized read32 $%08X\n", addr);
-        return 0;
-    }
-    if (addr >= 0x20000000 && addr < 0x20000000 + fcram_size)
-        return *(uint32_t*)&fcram[addr & (fcram_size - 1)];
-    switch (addr)
+        uint32_t value = e->wifi.read16(addr);
+        value |= e->wifi.read16(addr + 2) << 16;
+        return value;
+    };
+    wifi_io->write16 = [](Emulator* e, int, uint32_t addr, uint16_t value)
     {
-        case 0x10140180:
-            return 1;
-        case 0x1014110C:
-            return 1; //WiFi related?
-        case 0x10141200:
-            return 0; //GPU power config
-        case 0x10146000:
-            return HID_PAD;
-        case 0x10163000:
-            return pxi.read_sync11();
-        case 0x10163004:
-            return pxi.read_cnt11();
-        case 0x10163008:
-            //3dslinux reads from SEND11 for some mysterious reason...
-            return 0;
-        case 0x1016300C:
-            return pxi.read_msg11();
-    }
-    EmuException::die("[ARM11] Invalid read32 $%08X\n", addr);
-    return 0;
-}
-
-void Emulator::arm11_write8(int core, uint32_t addr, uint8_t value)
-{
-    if (addr >= 0x17E00000 && addr < 0x17E02000)
+        e->wifi.write16(addr, value);
+    };
+    wifi_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        mpcore_pmr.write8(core, addr, value);
-        return;
-    }
+        e->wifi.write16(addr, value & 0xFFFF);
+        e->wifi.write16(addr + 2, value >> 16);
+    };
 
-    if (addr >= 0x10140000 && addr < 0x10140010)
+    IODevice* config11_io = arm9_io.add_device("CONFIG11", 0x10140000, 0x1000);
+    config11_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
     {
-        dsp_mem_config[addr & 0xF] = value;
-        return;
-    }
-
-    if (addr >= 0x10144000 && addr < 0x10145000)
+        if (addr == 0x10140FFC)
+            return 0x5 | (e->is_n3ds << 1);
+        return e->arm9_io.get_unmapped()->read16(e, core, addr);
+    };
+    config11_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        i2c.write8(addr, value);
-        return;
-    }
+        switch (addr)
+        {
+            case 0x101401C0:
+                return 0; //SPI control
+            case 0x10140FFC:
+                return 0x5 | (e->is_n3ds << 1);
+        }
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
 
-    if (addr >= 0x10161000 && addr < 0x10162000)
+    IODevice* pdn_io = arm9_io.add_device("PDN", 0x10141000, 0x1000);
+    pdn_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
     {
-        i2c.write8(addr, value);
-        return;
-    }
-
-    if (addr >= 0x10148000 && addr < 0x10149000)
+        if (addr == 0x10141200)
+            return 1;
+        return e->arm9_io.get_unmapped()->read8(e, core, addr);
+    };
+    pdn_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        i2c.write8(addr, value);
-        return;
-    }
+        if (addr == 0x10141200)
+            return 0; //GPU power config
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
 
-    if (addr >= 0x18000000 && addr < 0x18600000)
+    IODevice* spi_io = arm9_io.add_device("SPI", 0x10142000, 0x2000);
+    spi_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        gpu.write_vram<uint8_t>(addr, value);
-        return;
-    }
+        return e->spi.read32(addr);
+    };
 
-    if (addr >= 0x20000000 && addr < 0x20000000 + fcram_size)
+    IODevice* i2c_io = arm9_io.add_device("I2C", 0x10144000, 0x1000);
+    arm9_io.map(i2c_io, 0x10148000, 0x1000);
+    arm9_io.map(i2c_io, 0x10161000, 0x1000);
+    i2c_io->read8 = [](Emulator* e, int, uint32_t addr) -> uint8_t
     {
-        fcram[addr & (fcram_size - 1)] = value;
-        return;
-    }
-
-    switch (addr)
+        return e->i2c.read8(addr);
+    };
+    i2c_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
     {
-        case 0x10140104:
-            return;
-        case 0x1014010C:
-            return;
-        case 0x10140180:
-            return;
-        case 0x10140400:
-            return;
-        case 0x10140420:
-            return;
-        case 0x10141204:
-            return;
-        case 0x10141208:
-            return;
-        case 0x10141220:
-            return;
-        case 0x10141224:
-            return;
-        case 0x10141230:
-            return;
-        case 0x10141312:
-        case 0x10141313:
-            boot_ctrl[addr - 0x10141310] = value;
-            printf("BOOT: $%02X\n", value);
-            if ((value & 0x3) == 0x3)
-            {
-                arm11[addr - 0x10141310].unhalt();
-                arm11[addr - 0x10141310].jp(boot_overlay_addr, true);
-                boot_ctrl[addr - 0x10141310] = 0x30;
-            }
-            return;
-        case 0x10163001:
+        if (addr >= 0x10145000)
         {
-            uint32_t sync = pxi.read_sync11() & 0xFFFF00FF;
-            pxi.write_sync11(sync | (value << 8));
-        }
+            e->arm9_io.get_unmapped()->write8(e, core, addr, value);
             return;
-        case 0x10163003:
-        {
-            uint32_t sync = pxi.read_sync11() & 0x00FFFFFF;
-            pxi.write_sync11(sync | (value << 24));
         }
-            return;
-    }
-    EmuException::die("[ARM11] Invalid write8 $%08X: $%02X\n", addr, value);
-}
-
-void Emulator::arm11_write16(int core, uint32_t addr, uint16_t value)
-{
-    if (addr >= 0x17E00000 && addr < 0x17E02000)
+        e->i2c.write8(addr, value);
+    };
+    i2c_io->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
     {
-        mpcore_pmr.write16(core, addr, value);
-        return;
-    }
-    if (addr >= 0x10103000 && addr < 0x10104000)
+        LOG(LOG_IO, LOG_WARN, "[A9 I2C] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    };
+
+    IODevice* hid_io = arm9_io.add_device("HID", 0x10146000, 0x1000);
+    hid_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
     {
-        printf("[CSND] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if ((addr >= 0x10102000 && addr < 0x10103000) || (addr >= 0x10120000 && addr < 0x10122000))
+        if (addr == 0x10146000)
+            return e->HID_PAD; //bits on = keys not pressed
+        return e->arm9_io.get_unmapped()->read16(e, core, addr);
+    };
+    hid_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        printf("[Y2R] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10122000 && addr < 0x10123000)
+        if (addr == 0x10146000)
+            return e->HID_PAD;
+        return e->arm9_io.get_unmapped()->read32(e, core, addr);
+    };
+
+    IODevice* spi2_io = arm9_io.add_device("SPI2", 0x10160000, 0x1000);
+    spi2_io->read8 = [](Emulator*, int, uint32_t addr) -> uint8_t
     {
-        wifi.write16(addr, value);
-        return;
-    }
-    if (addr >= 0x10144000 && addr < 0x10145000)
+        LOG(LOG_IO, LOG_WARN, "[SPI2] Unrecognized read8 $%08X\n", addr);
+        return 0;
+    };
+    spi2_io->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
     {
-        printf("[I2C] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10145000 && addr < 0x10146000)
+        LOG(LOG_IO, LOG_WARN, "[SPI2] Unrecognized read16 $%08X\n", addr);
+        return 0;
+    };
+    spi2_io->write8 = [](Emulator*, int, uint32_t addr, uint8_t value)
     {
-        printf("[CODEC] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10147000 && addr < 0x10148000)
+        LOG(LOG_IO, LOG_WARN, "[SPI2] Unrecognized write8 $%08X: $%02X\n", addr, value);
+    };
+    spi2_io->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
     {
-        printf("[GPIO] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10161000 && addr < 0x10162000)
+        LOG(LOG_IO, LOG_WARN, "[SPI2] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    };
+    spi2_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        printf("[I2C] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10162000 && addr < 0x10163000)
+        e->spi.write32(addr, value);
+    };
+
+    IODevice* ntrcard_io = arm9_io.add_device("NTRCARD", 0x10164000, 0x1000);
+    ntrcard_io->read16 = [](Emulator* e, int, uint32_t addr) -> uint16_t
     {
-        printf("[MIC] Unrecognized write16 $%08X: $%04X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10203000 && addr < 0x10204000)
+        return e->cartridge.read16_ntr(addr);
+    };
+    ntrcard_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        dsp.write16(addr, value);
-        return;
-    }
-    if (addr >= 0x18000000 && addr < 0x18600000)
+        return e->cartridge.read32_ntr(addr);
+    };
+    ntrcard_io->write8 = [](Emulator* e, int, uint32_t addr, uint8_t value)
     {
-        gpu.write_vram<uint16_t>(addr, value);
-        return;
-    }
-    if (addr >= 0x20000000 && addr < 0x20000000 + fcram_size)
+        e->cartridge.write8_ntr(addr, value);
+    };
+    ntrcard_io->write16 = [](Emulator* e, int, uint32_t addr, uint16_t value)
     {
-        *(uint16_t*)&fcram[addr & (fcram_size - 1)] = value;
-        return;
-    }
-    switch (addr)
+        e->cartridge.write16_ntr(addr, value);
+    };
+    ntrcard_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        case 0x101401C0:
-            return;
-        case 0x10141114:
-        case 0x10141116:
-            return;
-        case 0x10141300:
-        {
-            clock_ctrl = value & ~0x8000;
-            auto update_clockrate = [this](uint64_t param)
-            {
-                clock_ctrl |= 0x8000;
-                switch (clock_ctrl & 0x7)
-                {
-                    case 0x1:
-                        scheduler.set_clockrate_11(ARM11_CLOCKRATE);
-                        printf("[ARM11] Set clockrate to 1x\n");
-                        break;
-                    case 0x3:
-                        scheduler.set_clockrate_11(ARM11_CLOCKRATE * 2);
-                        printf("[ARM11] Set clockrate to 2x\n");
-                        break;
-                    case 0x5:
-                        scheduler.set_clockrate_11(ARM11_CLOCKRATE * 3);
-                        printf("[ARM11] Set clockrate to 3x\n");
-                        break;
-                    default:
-                        EmuException::die("[Emulator] Invalid clockrate $%02X given to MPCORE_CLKCNT", clock_ctrl & 0x7);
-                }
-                mpcore_pmr.assert_hw_irq(0x58);
-            };
-            scheduler.add_event(update_clockrate, 32, ARM11_CLOCKRATE);
-        }
-            return;
-        case 0x10141304:
-            return;
-        case 0x10148002:
-            return;
-        case 0x10148004:
-            return;
-        case 0x10163004:
-            pxi.write_cnt11(value);
-            return;
-    }
-    EmuException::die("[ARM11] Invalid write16 $%08X: $%04X\n", addr, value);
-}
+        e->cartridge.write32_ntr(addr, value);
+    };
 
-void Emulator::arm11_write32(int core, uint32_t addr, uint32_t value)
-{
-    if (addr >= 0x17E00000 && addr < 0x17E02000)
-    {
-        mpcore_pmr.write32(core, addr, value);
-        return;
-    }
-    if (addr >= 0x17E10000 && addr < 0x17E11000)
+    IODevice* arm9_ram_io = arm9_io.add_device("ARM9 RAM", 0x08000000, arm9_ram_size);
+    arm9_ram_io->read8 = [](Emulator* e, int, uint32_t addr) -> uint8_t
     {
-        printf("[L2C] Unrecognized write32 $%08X: $%08X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10101000 && addr < 0x10102000)
+        return e->arm9_RAM[addr - 0x08000000];
+    };
+    arm9_ram_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        hash.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x10103000 && addr < 0x10104000)
+        return *(uint32_t*)&e->arm9_RAM[addr - 0x08000000];
+    };
+    arm9_ram_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        printf("[CSND] Unrecognized write32 $%08X: $%08X\n", addr, value);
-        return;
-    }
-    if ((addr >= 0x10102000 && addr < 0x10103000) || (addr >= 0x10120000 && addr < 0x10122000))
+        *(uint32_t*)&e->arm9_RAM[addr - 0x08000000] = value;
+        e->check_code_write(&e->arm9_RAM[(addr - 0x08000000) & ~0xFFF]);
+    };
+
+    IODevice* vram_io = arm9_io.add_device("VRAM", 0x18000000, 0x600000);
+    vram_io->read8 = [](Emulator* e, int, uint32_t addr) -> uint8_t
     {
-        printf("[Y2R] Unrecognized write32 $%08X: $%08X\n", addr, value);
-        return;
-    }
-    if ((addr >= 0x10200000 && addr < 0x10201000) || (addr >= 0x10206000 && addr < 0x10207000))
+        return e->gpu.read_vram<uint8_t>(addr);
+    };
+    vram_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
     {
-        cdma.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x10202000 && addr < 0x10203000)
+        return e->gpu.read_vram<uint32_t>(addr);
+    };
+    vram_io->write8 = [](Emulator* e, int, uint32_t addr, uint8_t value)
+    {
+        e->gpu.write_vram<uint8_t>(addr, value);
+    };
+    vram_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        e->gpu.write_vram<uint32_t>(addr, value);
+    };
+
+    IODevice* dsp_ram_io = arm9_io.add_device("DSP RAM", 0x1FF00000, 0x80000);
+    dsp_ram_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        *(uint32_t*)&e->dsp_mem[addr & 0x7FFFF] = value;
+        e->check_code_write(&e->dsp_mem[addr & 0x7F000]);
+    };
+
+    IODevice* axi_ram_io = arm9_io.add_device("AXI RAM", 0x1FF80000, 0x80000);
+    axi_ram_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
+    {
+        return *(uint32_t*)&e->axi_RAM[addr & 0x7FFFF];
+    };
+    axi_ram_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
     {
-        if (addr == 0x10202014)
+        *(uint32_t*)&e->axi_RAM[addr & 0x7FFFF] = value;
+        e->check_code_write(&e->axi_RAM[addr & 0x7F000]);
+    };
+
+    IODevice* fcram_io = arm9_io.add_device("FCRAM", 0x20000000, fcram_size);
+    fcram_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        *(uint32_t*)&e->fcram[addr & (e->fcram_size - 1)] = value;
+        e->check_code_write(&e->fcram[addr & (e->fcram_size - 1) & ~0xFFF]);
+    };
+}
+
+uint8_t Emulator::arm9_read8(uint32_t addr)
+{
+    return arm9_io.read8(0, addr);
+}
+
+uint16_t Emulator::arm9_read16(uint32_t addr)
+{
+    return arm9_io.read16(0, addr);
+}
+
+uint32_t Emulator::arm9_read32(uint32_t addr)
+{
+    return arm9_io.read32(0, addr);
+}
+
+void Emulator::arm9_write8(uint32_t addr, uint8_t value)
+{
+    arm9_io.write8(0, addr, value);
+}
+
+void Emulator::arm9_write16(uint32_t addr, uint16_t value)
+{
+    arm9_io.write16(0, addr, value);
+}
+
+void Emulator::arm9_write32(uint32_t addr, uint32_t value)
+{
+    arm9_io.write32(0, addr, value);
+}
+
+void Emulator::map_arm11_io()
+{
+    arm11_io.reset();
+
+    IODevice* unmapped = arm11_io.get_unmapped();
+    unmapped->read8 = [](Emulator*, int, uint32_t addr) -> uint8_t
+    {
+        EmuException::die("[ARM11] Invalid read8 $%08X\n", addr);
+        return 0;
+    };
+    unmapped->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
+    {
+        EmuException::die("[ARM11] Invalid read16 $%08X\n", addr);
+        return 0;
+    };
+    unmapped->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        EmuException::die("[ARM11] Invalid read32 $%08X\n", addr);
+        return 0;
+    };
+    unmapped->write8 = [](Emulator*, int, uint32_t addr, uint8_t value)
+    {
+        EmuException::die("[ARM11] Invalid write8 $%08X: $%02X\n", addr, value);
+    };
+    unmapped->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
+    {
+        EmuException::die("[ARM11] Invalid write16 $%08X: $%04X\n", addr, value);
+    };
+    unmapped->write32 = [](Emulator*, int, uint32_t addr, uint32_t value)
+    {
+        EmuException::die("[ARM11] Invalid write32 $%08X: $%08X\n", addr, value);
+    };
+
+    IODevice* hash_io = arm11_io.add_device("HASH", 0x10101000, 0x1000);
+    hash_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
+    {
+        return e->hash.read32(addr);
+    };
+    hash_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        e->hash.write32(addr, value);
+    };
+
+    IODevice* hash_fifo_io = arm11_io.add_device("HASH FIFO", 0x10301000, 0x1000);
+    hash_fifo_io->write32 = [](Emulator* e, int, uint32_t, uint32_t value)
+    {
+        e->hash.write_fifo(value);
+    };
+
+    IODevice* y2r_io = arm11_io.add_device("Y2R", 0x10102000, 0x1000);
+    arm11_io.map(y2r_io, 0x10120000, 0x2000);
+    y2r_io->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[Y2R] Unrecognized read16 $%08X\n", addr);
+        return 0;
+    };
+    y2r_io->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[Y2R] Unrecognized read32 $%08X\n", addr);
+        return 0;
+    };
+    y2r_io->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[Y2R] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    };
+    y2r_io->write32 = [](Emulator*, int, uint32_t addr, uint32_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[Y2R] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    };
+
+    IODevice* csnd_io = arm11_io.add_device("CSND", 0x10103000, 0x1000);
+    csnd_io->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[CSND] Unrecognized read16 $%08X\n", addr);
+        return 0;
+    };
+    csnd_io->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[CSND] Unrecognized read32 $%08X\n", addr);
+        return 0;
+    };
+    csnd_io->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[CSND] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    };
+    csnd_io->write32 = [](Emulator*, int, uint32_t addr, uint32_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[CSND] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    };
+
+    IODevice* wifi_io = arm11_io.add_device("WIFI", 0x10122000, 0x1000);
+    wifi_io->read16 = [](Emulator* e, int, uint32_t addr) -> uint16_t
+    {
+        return e->wifi.read16(addr);
+    };
+    wifi_io->write16 = [](Emulator* e, int, uint32_t addr, uint16_t value)
+    {
+        e->wifi.write16(addr, value);
+    };
+
+    IODevice* config11_io = arm11_io.add_device("CONFIG11", 0x10140000, 0x1000);
+    config11_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
+    {
+        if (addr < 0x10140010)
+            return e->dsp_mem_config[addr & 0xF];
+        switch (addr)
         {
-            //WARNING: LCD initialization is far more complicated than this.
-            //Since what actually happens is poorly understood, this will have to do for now.
-            gpu.set_lcd_init(value & 0x1);
-            return;
+            case 0x1014010C:
+                return 0;
+            case 0x10140180:
+                return 0; //WiFi power
+            case 0x10140420:
+                return 0;
         }
-        else if (addr == 0x10202204)
+        return e->arm11_io.get_unmapped()->read8(e, core, addr);
+    };
+    config11_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
+    {
+        switch (addr)
         {
-            gpu.set_screenfill(0, value);
-            return;
+            case 0x101401C0:
+                return 0x7; //3DS/DS SPI switch
+            case 0x10140FFC:
+                return 0x5 | (e->is_n3ds << 1);
         }
-        else if (addr == 0x10202A04)
+        return e->arm11_io.get_unmapped()->read16(e, core, addr);
+    };
+    config11_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
+    {
+        if (addr == 0x10140180)
+            return 1;
+        return e->arm11_io.get_unmapped()->read32(e, core, addr);
+    };
+    config11_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
+    {
+        if (addr < 0x10140010)
         {
-            gpu.set_screenfill(1, value);
+            e->dsp_mem_config[addr & 0xF] = value;
             return;
         }
-        printf("[LCD] Unrecognized write32 $%08X: $%08X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x1020F000 && addr < 0x10210000)
+        switch (addr)
+        {
+            case 0x10140104:
+                return;
+            case 0x1014010C:
+                return;
+            case 0x10140180:
+                return;
+            case 0x10140400:
+                return;
+            case 0x10140420:
+                return;
+        }
+        e->arm11_io.get_unmapped()->write8(e, core, addr, value);
+    };
+    config11_io->write16 = [](Emulator* e, int core, uint32_t addr, uint16_t value)
     {
-        printf("[AXI] Unrecognized write32 $%08X: $%08X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10301000 && addr < 0x10302000)
+        if (addr == 0x101401C0)
+            return;
+        e->arm11_io.get_unmapped()->write16(e, core, addr, value);
+    };
+    config11_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
     {
-        hash.write_fifo(value);
-        return;
-    }
-    if (addr >= 0x10400000 && addr < 0x10402000)
+        switch (addr)
+        {
+            case 0x10140140:
+                return; //GPUPROT
+            case 0x10140180:
+                return; //Enable WiFi subsystem
+            case 0x10140410:
+                return;
+            case 0x10140424:
+                e->boot_overlay_addr = value;
+                return;
+        }
+        e->arm11_io.get_unmapped()->write32(e, core, addr, value);
+    };
+
+    IODevice* pdn_io = arm11_io.add_device("PDN", 0x10141000, 0x1000);
+    pdn_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
     {
-        gpu.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x10142800 && addr < 0x10144000)
+        switch (addr)
+        {
+            case 0x10141204:
+                return 1; //GPU power
+            case 0x10141208:
+                return 0; //Unk GPU power reg
+            case 0x10141220:
+                return 0; //Enable FCRAM?
+            case 0x10141224:
+                return 0; //Camera power
+            case 0x10141230:
+                return 0; //DSP power
+            case 0x10141310:
+            case 0x10141311:
+            case 0x10141312:
+            case 0x10141313:
+                return e->boot_ctrl[addr - 0x10141310];
+        }
+        return e->arm11_io.get_unmapped()->read8(e, core, addr);
+    };
+    pdn_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
     {
-        spi.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x10147000 && addr < 0x10148000)
+        switch (addr)
+        {
+            case 0x10141114:
+            case 0x10141116:
+                return 0;
+            case 0x10141300:
+                return e->clock_ctrl;
+            case 0x10141304:
+                return 0;
+        }
+        return e->arm11_io.get_unmapped()->read16(e, core, addr);
+    };
+    pdn_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        printf("[GPIO] Unrecognized write32 $%08X: $%08X\n", addr, value);
-        return;
-    }
-    if (addr >= 0x10160000 && addr < 0x10161000)
+        switch (addr)
+        {
+            case 0x1014110C:
+                return 1; //WiFi related?
+            case 0x10141200:
+                return 0; //GPU power config
+        }
+        return e->arm11_io.get_unmapped()->read32(e, core, addr);
+    };
+    pdn_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
     {
-        spi.write32(addr, value);
-        return;
-    }
-    if (addr >= 0x18000000 && addr < 0x18600000)
+        switch (addr)
+        {
+            case 0x10141204:
+                return;
+            case 0x10141208:
+                return;
+            case 0x10141220:
+                return;
+            case 0x10141224:
+                return;
+            case 0x10141230:
+                return;
+            case 0x10141312:
+            case 0x10141313:
+                e->boot_ctrl[addr - 0x10141310] = value;
+                LOG(LOG_EMU, LOG_DEBUG, "BOOT: $%02X\n", value);
+                if ((value & 0x3) == 0x3)
+                {
+                    e->arm11[addr - 0x10141310].unhalt();
+                    e->arm11[addr - 0x10141310].jp(e->boot_overlay_addr, true);
+                    e->boot_ctrl[addr - 0x10141310] = 0x30;
+                }
+                return;
+        }
+        e->arm11_io.get_unmapped()->write8(e, core, addr, value);
+    };
+    pdn_io->write16 = [](Emulator* e, int core, uint32_t addr, uint16_t value)
     {
-        gpu.write_vram<uint32_t>(addr, value);
-        return;
-    }
-    if (addr >= 0x20000000 && addr < 0x20000000 + fcram_size)
+        switch (addr)
+        {
+            case 0x10141114:
+            case 0x10141116:
+                return;
+            case 0x10141300:
+            {
+                e->clock_ctrl = value & ~0x8000;
+                e->scheduler.add_event(e->clockrate_event, 32, ARM11_CLOCKRATE);
+            }
+                return;
+            case 0x10141304:
+                return;
+        }
+        e->arm11_io.get_unmapped()->write16(e, core, addr, value);
+    };
+    pdn_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
     {
-        *(uint32_t*)&fcram[addr & (fcram_size - 1)] = value;
-        return;
-    }
-    switch (addr)
+        switch (addr)
+        {
+            case 0x1014110C:
+                return;
+            case 0x10141200:
+                return;
+        }
+        e->arm11_io.get_unmapped()->write32(e, core, addr, value);
+    };
+
+    //The ARM11 only sees the upper part of the first page
+    IODevice* spi_io = arm11_io.add_device("SPI", 0x10142000, 0x2000);
+    arm11_io.map(spi_io, 0x10160000, 0x1000);
+    spi_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
     {
-        case 0x10140140:
-            return; //GPUPROT
-        case 0x10140180:
-            return; //Enable WiFi subsystem
-        case 0x10140410:
-            return;
-        case 0x10140424:
-            boot_overlay_addr = value;
-            return;
-        case 0x1014110C:
-            return;
-        case 0x10141200:
-            return;
-        case 0x10163000:
-            pxi.write_sync11(value);
-            return;
-        case 0x10163004:
-            pxi.write_cnt11(value & 0xFFFF);
+        if (addr >= 0x10142000 && addr < 0x10142800)
+            return e->arm11_io.get_unmapped()->read32(e, core, addr);
+        return e->spi.read32(addr);
+    };
+    spi_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
+    {
+        if (addr >= 0x10142000 && addr < 0x10142800)
+        {
+            e->arm11_io.get_unmapped()->write32(e, core, addr, value);
             return;
-        case 0x10163008:
-            //if (value == 0x10a9b8)
-                //arm9.set_disassembly(true);
-            pxi.send_to_9(value);
+        }
+        e->spi.write32(addr, value);
+    };
+
+    IODevice* i2c_io = arm11_io.add_device("I2C", 0x10144000, 0x1000);
+    arm11_io.map(i2c_io, 0x10148000, 0x1000);
+    arm11_io.map(i2c_io, 0x10161000, 0x1000);
+    i2c_io->read8 = [](Emulator* e, int, uint32_t addr) -> uint8_t
+    {
+        return e->i2c.read8(addr);
+    };
+    i2c_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
+    {
+        if (addr >= 0x10161000)
+        {
+            LOG(LOG_IO, LOG_WARN, "[I2C] Unrecognized read16 $%08X\n", addr);
+            return 0;
+        }
+        return e->arm11_io.get_unmapped()->read16(e, core, addr);
+    };
+    i2c_io->write8 = [](Emulator* e, int, uint32_t addr, uint8_t value)
+    {
+        e->i2c.write8(addr, value);
+    };
+    i2c_io->write16 = [](Emulator* e, int core, uint32_t addr, uint16_t value)
+    {
+        switch (addr)
+        {
+            case 0x10148002:
+                return;
+            case 0x10148004:
+                return;
+        }
+        if (addr >= 0x10148000 && addr < 0x10149000)
+        {
+            e->arm11_io.get_unmapped()->write16(e, core, addr, value);
             return;
-        case 0x10202014:
+        }
+        LOG(LOG_IO, LOG_WARN, "[I2C] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    };
+
+    IODevice* codec_io = arm11_io.add_device("CODEC", 0x10145000, 0x1000);
+    codec_io->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[CODEC] Unrecognized read16 $%08X\n", addr);
+        return 0;
+    };
+    codec_io->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[CODEC] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    };
+
+    IODevice* hid_io = arm11_io.add_device("HID", 0x10146000, 0x1000);
+    hid_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
+    {
+        if (addr == 0x10146000)
+            return e->HID_PAD;
+        return e->arm11_io.get_unmapped()->read16(e, core, addr);
+    };
+    hid_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
+    {
+        if (addr == 0x10146000)
+            return e->HID_PAD;
+        return e->arm11_io.get_unmapped()->read32(e, core, addr);
+    };
+
+    IODevice* gpio_io = arm11_io.add_device("GPIO", 0x10147000, 0x1000);
+    gpio_io->read8 = [](Emulator*, int, uint32_t addr) -> uint8_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[GPIO] Unrecognized read8 $%08X\n", addr);
+        return 0;
+    };
+    gpio_io->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[GPIO] Unrecognized read16 $%08X\n", addr);
+        return 0;
+    };
+    gpio_io->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[GPIO] Unrecognized read32 $%08X\n", addr);
+        return 0;
+    };
+    gpio_io->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[GPIO] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    };
+    gpio_io->write32 = [](Emulator*, int, uint32_t addr, uint32_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[GPIO] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    };
+
+    IODevice* mic_io = arm11_io.add_device("MIC", 0x10162000, 0x1000);
+    mic_io->read16 = [](Emulator*, int, uint32_t addr) -> uint16_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[MIC] Unrecognized read16 $%08X\n", addr);
+        return 0;
+    };
+    mic_io->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[MIC] Unrecognized read32 $%08X\n", addr);
+        return 0;
+    };
+    mic_io->write16 = [](Emulator*, int, uint32_t addr, uint16_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[MIC] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    };
+
+    IODevice* pxi_io = arm11_io.add_device("PXI11", 0x10163000, 0x1000);
+    pxi_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
+    {
+        if (addr < 0x10163004)
+            return (e->pxi.read_sync11() >> ((addr & 0x3) * 8)) & 0xFF;
+        return e->arm11_io.get_unmapped()->read8(e, core, addr);
+    };
+    pxi_io->read16 = [](Emulator* e, int core, uint32_t addr) -> uint16_t
+    {
+        if (addr == 0x10163004)
+            return e->pxi.read_cnt11();
+        return e->arm11_io.get_unmapped()->read16(e, core, addr);
+    };
+    pxi_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
+    {
+        switch (addr)
+        {
+            case 0x10163000:
+                return e->pxi.read_sync11();
+            case 0x10163004:
+                return e->pxi.read_cnt11();
+            case 0x10163008:
+                //3dslinux reads from SEND11 for some mysterious reason...
+                return 0;
+            case 0x1016300C:
+                return e->pxi.read_msg11();
+        }
+        return e->arm11_io.get_unmapped()->read32(e, core, addr);
+    };
+    pxi_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
+    {
+        switch (addr)
+        {
+            case 0x10163001:
+            {
+                uint32_t sync = e->pxi.read_sync11() & 0xFFFF00FF;
+                e->pxi.write_sync11(sync | (value << 8));
+            }
+                return;
+            case 0x10163003:
+            {
+                uint32_t sync = e->pxi.read_sync11() & 0x00FFFFFF;
+                e->pxi.write_sync11(sync | (value << 24));
+            }
+                return;
+        }
+        e->arm11_io.get_unmapped()->write8(e, core, addr, value);
+    };
+    pxi_io->write16 = [](Emulator* e, int core, uint32_t addr, uint16_t value)
+    {
+        if (addr == 0x10163004)
+        {
+            e->pxi.write_cnt11(value);
             return;
+        }
+        e->arm11_io.get_unmapped()->write16(e, core, addr, value);
+    };
+    pxi_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
+    {
+        switch (addr)
+        {
+            case 0x10163000:
+                e->pxi.write_sync11(value);
+                return;
+            case 0x10163004:
+                e->pxi.write_cnt11(value & 0xFFFF);
+                return;
+            case 0x10163008:
+                //if (value == 0x10a9b8)
+                    //arm9.set_disassembly(true);
+                e->pxi.send_to_9(value);
+                return;
+        }
+        e->arm11_io.get_unmapped()->write32(e, core, addr, value);
+    };
+
+    IODevice* cdma_io = arm11_io.add_device("CDMA", 0x10200000, 0x1000);
+    arm11_io.map(cdma_io, 0x10206000, 0x1000);
+    cdma_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
+    {
+        return e->cdma.read32(addr);
+    };
+    cdma_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        e->cdma.write32(addr, value);
+    };
+
+    IODevice* lcd_io = arm11_io.add_device("LCD", 0x10202000, 0x1000);
+    lcd_io->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[LCD] Unrecognized read $%08X\n", addr);
+        return 0;
+    };
+    lcd_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        switch (addr)
+        {
+            case 0x10202014:
+                //WARNING: LCD initialization is far more complicated than this.
+                //Since what actually happens is poorly understood, this will have to do for now.
+                e->gpu.set_lcd_init(value & 0x1);
+                return;
+            case 0x10202204:
+                e->gpu.set_screenfill(0, value);
+                return;
+            case 0x10202A04:
+                e->gpu.set_screenfill(1, value);
+                return;
+        }
+        LOG(LOG_IO, LOG_WARN, "[LCD] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    };
+
+    IODevice* dsp_io = arm11_io.add_device("DSP", 0x10203000, 0x1000);
+    dsp_io->read16 = [](Emulator* e, int, uint32_t addr) -> uint16_t
+    {
+        return e->dsp.read16(addr);
+    };
+    dsp_io->write16 = [](Emulator* e, int, uint32_t addr, uint16_t value)
+    {
+        e->dsp.write16(addr, value);
+    };
+
+    IODevice* axi_io = arm11_io.add_device("AXI", 0x1020F000, 0x1000);
+    axi_io->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[AXI] Unrecognized read32 $%08X\n", addr);
+        return 0;
+    };
+    axi_io->write32 = [](Emulator*, int, uint32_t addr, uint32_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[AXI] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    };
+
+    IODevice* gpu_io = arm11_io.add_device("GPU", 0x10400000, 0x2000);
+    gpu_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
+    {
+        return e->gpu.read32(addr);
+    };
+    gpu_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        e->gpu.write32(addr, value);
+    };
+
+    IODevice* mpcore_io = arm11_io.add_device("MPCORE PMR", 0x17E00000, 0x2000);
+    mpcore_io->read8 = [](Emulator* e, int core, uint32_t addr) -> uint8_t
+    {
+        return e->mpcore_pmr.read8(core, addr);
+    };
+    mpcore_io->read32 = [](Emulator* e, int core, uint32_t addr) -> uint32_t
+    {
+        //Bit of a hack: Since we do not handle accurate ARM11 timings, we shave off a cycle for MPR reads.
+        //At a 3x clock multipler, Kernel11 requires a 6 cycle difference between two timer reads, but there are
+        //only 5 instructions between the reads. Without handling this, threads will sleep for 0xFFFFFFFF cycles.
+        e->arm11[core].inc_cycle_count(1);
+        return e->mpcore_pmr.read32(core, addr);
+    };
+    mpcore_io->write8 = [](Emulator* e, int core, uint32_t addr, uint8_t value)
+    {
+        e->mpcore_pmr.write8(core, addr, value);
+    };
+    mpcore_io->write16 = [](Emulator* e, int core, uint32_t addr, uint16_t value)
+    {
+        e->mpcore_pmr.write16(core, addr, value);
+    };
+    mpcore_io->write32 = [](Emulator* e, int core, uint32_t addr, uint32_t value)
+    {
+        e->mpcore_pmr.write32(core, addr, value);
+    };
+
+    IODevice* l2c_io = arm11_io.add_device("L2C", 0x17E10000, 0x1000);
+    l2c_io->read32 = [](Emulator*, int, uint32_t addr) -> uint32_t
+    {
+        LOG(LOG_IO, LOG_WARN, "[L2C] Unrecognized read32 $%08X\n", addr);
+        return 0;
+    };
+    l2c_io->write32 = [](Emulator*, int, uint32_t addr, uint32_t value)
+    {
+        LOG(LOG_IO, LOG_WARN, "[L2C] Unrecognized write32 $%08X: $%08X\n", addr, value);
+    };
+
+    IODevice* vram_io = arm11_io.add_device("VRAM", 0x18000000, 0x600000);
+    vram_io->read8 = [](Emulator* e, int, uint32_t addr) -> uint8_t
+    {
+        return e->gpu.read_vram<uint8_t>(addr);
+    };
+    vram_io->read16 = [](Emulator* e, int, uint32_t addr) -> uint16_t
+    {
+        return e->gpu.read_vram<uint16_t>(addr);
+    };
+    vram_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
+    {
+        return e->gpu.read_vram<uint32_t>(addr);
+    };
+    vram_io->write8 = [](Emulator* e, int, uint32_t addr, uint8_t value)
+    {
+        e->gpu.write_vram<uint8_t>(addr, value);
+    };
+    vram_io->write16 = [](Emulator* e, int, uint32_t addr, uint16_t value)
+    {
+        e->gpu.write_vram<uint16_t>(addr, value);
+    };
+    vram_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        e->gpu.write_vram<uint32_t>(addr, value);
+    };
+
+    IODevice* axi_ram_io = arm11_io.add_device("AXI RAM", 0x1FF80000, 0x80000);
+    axi_ram_io->read8 = [](Emulator* e, int, uint32_t addr) -> uint8_t
+    {
+        return e->axi_RAM[addr & 0x0007FFFF];
+    };
+
+    IODevice* fcram_io = arm11_io.add_device("FCRAM", 0x20000000, fcram_size);
+    fcram_io->read8 = [](Emulator* e, int, uint32_t addr) -> uint8_t
+    {
+        return e->fcram[addr & (e->fcram_size - 1)];
+    };
+    fcram_io->read16 = [](Emulator* e, int, uint32_t addr) -> uint16_t
+    {
+        return *(uint16_t*)&e->fcram[addr & (e->fcram_size - 1)];
+    };
+    fcram_io->read32 = [](Emulator* e, int, uint32_t addr) -> uint32_t
+    {
+        return *(uint32_t*)&e->fcram[addr & (e->fcram_size - 1)];
+    };
+    fcram_io->write8 = [](Emulator* e, int, uint32_t addr, uint8_t value)
+    {
+        e->fcram[addr & (e->fcram_size - 1)] = value;
+        e->check_code_write(&e->fcram[addr & (e->fcram_size - 1) & ~0xFFF]);
+    };
+    fcram_io->write16 = [](Emulator* e, int, uint32_t addr, uint16_t value)
+    {
+        *(uint16_t*)&e->fcram[addr & (e->fcram_size - 1)] = value;
+        e->check_code_write(&e->fcram[addr & (e->fcram_size - 1) & ~0xFFF]);
+    };
+    fcram_io->write32 = [](Emulator* e, int, uint32_t addr, uint32_t value)
+    {
+        *(uint32_t*)&e->fcram[addr & (e->fcram_size - 1)] = value;
+        e->check_code_write(&e->fcram[addr & (e->fcram_size - 1) & ~0xFFF]);
+    };
+}
+
+uint8_t Emulator::arm11_read8(int core, uint32_t addr)
+{
+    std::unique_lock<std::recursive_mutex> lock = lock_io();
+    return arm11_io.read8(core, addr);
+}
+
+uint16_t Emulator::arm11_read16(int core, uint32_t addr)
+{
+    std::unique_lock<std::recursive_mutex> lock = lock_io();
+    return arm11_io.read16(core, addr);
+}
+
+uint32_t Emulator::arm11_read32(int core, uint32_t addr)
+{
+    std::unique_lock<std::recursive_mutex> lock = lock_io();
+    return arm11_io.read32(core, addr);
+}
+
+void Emulator::arm11_write8(int core, uint32_t addr, uint8_t value)
+{
+    std::unique_lock<std::recursive_mutex> lock = lock_io();
+    arm11_io.write8(core, addr, value);
+}
+
+void Emulator::arm11_write16(int core, uint32_t addr, uint16_t value)
+{
+    std::unique_lock<std::recursive_mutex> lock = lock_io();
+    arm11_io.write16(core, addr, value);
+}
+
+void Emulator::arm11_write32(int core, uint32_t addr, uint32_t value)
+{
+    std::unique_lock<std::recursive_mutex> lock = lock_io();
+    arm11_io.write32(core, addr, value);
+}
+
+//Host memory behind a range of VRAM or FCRAM the GPU reads from, or null if the range isn't all in one of them.
+//Safe to call from the rasterizer threads.
+uint8_t* Emulator::get_gpu_memory(uint32_t addr, uint32_t size)
+{
+    uint64_t end = (uint64_t)addr + size;
+    if (addr >= 0x18000000 && end <= 0x18600000)
+        return vram + (addr - 0x18000000);
+
+    if (addr >= 0x20000000 && end <= 0x20000000ULL + fcram_size)
+        return fcram + (addr - 0x20000000);
+    return nullptr;
+}
+
+//The same for a range the GPU is about to draw to.
+//The GPU writes the memory directly, so any code translated from those FCRAM pages is dropped here.
+uint8_t* Emulator::get_render_target(uint32_t addr, uint32_t size)
+{
+    uint8_t* target = get_gpu_memory(addr, size);
+    if (target && addr >= 0x20000000)
+    {
+        uint32_t offset = addr - 0x20000000;
+        for (uint32_t page = offset & ~0xFFF; page < offset + size; page += 0x1000)
+            check_code_write(&fcram[page]);
     }
-    EmuException::die("[ARM11] Invalid write32 $%08X: $%08X\n", addr, value);
+    return target;
 }
 
 void Emulator::arm11_send_events(int id)
 {
+    std::unique_lock<std::recursive_mutex> lock = lock_io();
     for (int i = 0; i < core_count; i++)
         arm11[i].send_event(id);
 }
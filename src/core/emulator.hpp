@@ -1,6 +1,7 @@
 #ifndef EMULATOR_HPP
 #define EMULATOR_HPP
 #include <cstdint>
+#include <mutex>
 #include "arm9/aes.hpp"
 #include "arm9/cartridge.hpp"
 #include "arm9/dma9.hpp"
@@ -16,11 +17,16 @@
 #include "arm11/wifi.hpp"
 
 #include "cpu/arm.hpp"
+#include "cpu/arm_cached_interpret.hpp"
+#include "cpu/arm_jit.hpp"
+#include "cpu/arm_thread_pool.hpp"
 #include "cpu/cp15.hpp"
+#include "cpu/fastmem.hpp"
 #include "cpu/mmu.hpp"
 #include "cpu/vfp.hpp"
 
 #include "i2c.hpp"
+#include "io_table.hpp"
 #include "pxi.hpp"
 #include "scheduler.hpp"
 #include "spi.hpp"
@@ -47,6 +53,9 @@ class Emulator
 
         uint8_t twl_consoleid[8];
 
+        //Guest RAM comes from here, so fastmem can map it into the ARM11 address spaces
+        FastmemRAM ram;
+
         uint8_t* arm9_RAM;
         uint8_t* axi_RAM;
         uint8_t* fcram;
@@ -58,6 +67,29 @@ class Emulator
         CP15 arm9_cp15, arm11_cp15[4];
         MMU arm9_pu, arm11_mmu[4];
         VFP vfp[4];
+        ARM_JIT jit;
+        ARM_CachedInterpreter cached_interpreter;
+
+        //Points to whichever of the above the CPUs are using, or null for the plain interpreter
+        ARM_CodeCache* code_cache;
+
+        //Optional mode running each ARM11 core on its own host thread. MMIO is serialized by io_lock while it runs.
+        bool parallel_arm11;
+        ARM_ThreadPool arm11_threads;
+        std::recursive_mutex io_lock;
+
+        //Optional mode mapping guest RAM into host address spaces, so ARM11 loads and stores skip the TLB
+        bool fastmem_enabled;
+        FastmemSpace arm11_fastmem[4];
+
+        //Optional mode stretching time slices whenever no components are talking to each other
+        bool adaptive_quantum;
+
+        //Physical address space of each CPU, one peripheral per 4 KB page
+        IOTable arm9_io, arm11_io;
+
+        //Constructed before the peripherals, so they can register their events with it
+        Scheduler scheduler;
 
         AES aes;
         Cartridge cartridge;
@@ -72,7 +104,6 @@ class Emulator
         MPCore_PMR mpcore_pmr;
         PXI pxi;
         RSA rsa;
-        Scheduler scheduler;
         SHA sha;
         SPI spi;
         Timers timers;
@@ -85,19 +116,40 @@ class Emulator
         int card_reset;
 
         int frames;
+        bool frame_ended;
+
+        int vblank_start_event, vblank_end_event, clockrate_event;
 
         uint8_t dsp_mem_config[16];
 
         uint16_t HID_PAD;
 
         uint8_t sysprot9, sysprot11;
+
+        void check_code_write(uint8_t* page);
+        void update_fastmem();
+        void map_arm9_io();
+        void map_arm11_io();
+        void print_io_stats(const char* cpu_name, IOTable& io);
+        void update_clockrate();
+        bool is_idle();
+        bool needs_short_slices();
+        std::unique_lock<std::recursive_mutex> lock_io();
     public:
         Emulator();
         ~Emulator();
 
         void reset(bool cold_boot = true);
+        void set_cpu_backend(CPU_BACKEND backend);
+        void set_parallel_arm11(bool enabled);
+        void set_fastmem(bool enabled);
+        void set_adaptive_quantum(bool enabled);
+        void set_gpu_threads(int count);
+        void set_shader_jit(bool enabled);
+        VertexCacheStats get_vtx_cache_stats();
         void run();
         void print_state();
+        void print_memory_usage();
         void dump();
         void memdump11(int id, uint64_t start, uint64_t size);
 
@@ -108,6 +160,7 @@ class Emulator
         bool mount_cartridge(std::string file_name);
 
         void load_and_run_elf(uint8_t* elf, uint64_t size);
+        void run_gpu_command_list(uint32_t addr, uint32_t words);
 
         uint8_t arm9_read8(uint32_t addr);
         uint16_t arm9_read16(uint32_t addr);
@@ -125,6 +178,9 @@ class Emulator
 
         void arm11_send_events(int id);
 
+        uint8_t* get_gpu_memory(uint32_t addr, uint32_t size);
+        uint8_t* get_render_target(uint32_t addr, uint32_t size);
+
         uint8_t* get_top_buffer();
         uint8_t* get_bottom_buffer();
         void set_pad(uint16_t pad);
@@ -136,4 +192,17 @@ class Emulator
         void home_button(bool pressed);
 };
 
+inline void Emulator::check_code_write(uint8_t *page)
+{
+    if (code_cache)
+        code_cache->check_code_write(page);
+}
+
+inline std::unique_lock<std::recursive_mutex> Emulator::lock_io()
+{
+    if (ARM_CPU::parallel_quantum)
+        return std::unique_lock<std::recursive_mutex>(io_lock);
+    return std::unique_lock<std::recursive_mutex>();
+}
+
 #endif // EMULATOR_HPP
@@ -11,7 +11,8 @@
 
 I2C::I2C(MPCore_PMR* pmr, Scheduler* scheduler) : pmr(pmr), scheduler(scheduler)
 {
-
+    transfer_event = scheduler->register_event("I2C transfer", [this](uint64_t param) {do_transfer(param);});
+    mcu_interrupt_event = scheduler->register_event("MCU interrupt", [this](uint64_t param) {mcu_interrupt(param);});
 }
 
 void I2C::reset()
@@ -50,7 +51,7 @@ uint8_t I2C::read8(uint32_t addr)
             reg = get_cnt(id);
             break;
         default:
-            printf("[I2C%d] Unrecognized read8 $%08X\n", id, addr);
+            LOG(LOG_I2C, LOG_WARN, "[I2C%d] Unrecognized read8 $%08X\n", id, addr);
     }
     return reg;
 }
@@ -63,14 +64,14 @@ void I2C::write8(uint32_t addr, uint8_t value)
     switch (addr)
     {
         case 0x000:
-            printf("[I2C%d] Write data: $%02X\n", id, value);
+            LOG(LOG_I2C, LOG_DEBUG, "[I2C%d] Write data: $%02X\n", id, value);
             data[id] = value;
             break;
         case 0x001:
             set_cnt(id, value);
             break;
         default:
-            printf("[I2C%d] Unrecognized write8 $%08X: $%02X\n", id, addr, value);
+            LOG(LOG_I2C, LOG_WARN, "[I2C%d] Unrecognized write8 $%08X: $%02X\n", id, addr, value);
     }
 }
 
@@ -97,7 +98,7 @@ uint8_t I2C::get_cnt(int id)
 
 void I2C::set_cnt(int id, uint8_t value)
 {
-    printf("[I2C%d] Set CNT: $%02X\n", id, value);
+    LOG(LOG_I2C, LOG_DEBUG, "[I2C%d] Set CNT: $%02X\n", id, value);
     cnt[id].stop = value & 0x1;
     cnt[id].start = value & 0x2;
     cnt[id].ack_flag &= ~((value & (1 << 4)) != 0);
@@ -108,7 +109,7 @@ void I2C::set_cnt(int id, uint8_t value)
     {
         cnt[id].ack_flag = true;
         cnt[id].busy = true;
-        scheduler->add_event([this](uint64_t param) { this->do_transfer(param);}, 20000, ARM11_CLOCKRATE, id);
+        scheduler->add_event(transfer_event, 20000, ARM11_CLOCKRATE, id);
     }
 }
 
@@ -121,7 +122,7 @@ void I2C::do_transfer(int id)
         if (!cnt[id].device_selected)
         {
             devices[id][dev].reg_selected = false;
-            printf("[I2C%d] Selecting device $%02X\n", id, dev);
+            LOG(LOG_I2C, LOG_DEBUG, "[I2C%d] Selecting device $%02X\n", id, dev);
         }
         cnt[id].device_selected = true;
         cnt[id].cur_device = dev;
@@ -134,7 +135,7 @@ void I2C::do_transfer(int id)
             devices[id][cur_dev].reg_selected = true;
             devices[id][cur_dev].cur_reg = data[id];
 
-            printf("[I2C%d] Selecting device $%02X reg $%02X\n", id, cur_dev, data[id]);
+            LOG(LOG_I2C, LOG_DEBUG, "[I2C%d] Selecting device $%02X reg $%02X\n", id, cur_dev, data[id]);
         }
         else
         {
@@ -206,7 +207,7 @@ uint8_t I2C::read_device(int id, uint8_t device)
         case 0x14A:
             return read_mcu(devices[id][device].cur_reg);
         default:
-            printf("[I2C%d] Unrecognized read device $%02X\n", id, device);
+            LOG(LOG_I2C, LOG_WARN, "[I2C%d] Unrecognized read device $%02X\n", id, device);
     }
     return reg;
 }
@@ -219,13 +220,13 @@ void I2C::write_device(int id, uint8_t device, uint8_t value)
         case 0x078:
         case 0x07A:
         case 0x178:
-            printf("[I2C_CAM] Unrecognized write register $%04X:%02X ($%02X)\n", device, devices[id][device].cur_reg, value);
+            LOG(LOG_I2C, LOG_WARN, "[I2C_CAM] Unrecognized write register $%04X:%02X ($%02X)\n", device, devices[id][device].cur_reg, value);
             break;
         case 0x14A:
             write_mcu(devices[id][device].cur_reg, value);
             break;
         default:
-            printf("[I2C%d] Unrecognized write device $%02X ($%02X)\n", id, device, value);
+            LOG(LOG_I2C, LOG_WARN, "[I2C%d] Unrecognized write device $%02X ($%02X)\n", id, device, value);
     }
 }
 
@@ -234,7 +235,7 @@ uint8_t I2C::read_camera(int device, uint8_t reg_id)
     switch (reg_id)
     {
         default:
-            printf("[I2C_CAM] Unrecognized read register $%04X:%02X\n", device, reg_id);
+            LOG(LOG_I2C, LOG_WARN, "[I2C_CAM] Unrecognized read register $%04X:%02X\n", device, reg_id);
             return 0xFF;
     }
 }
@@ -250,7 +251,7 @@ uint8_t I2C::read_mcu(uint8_t reg_id)
 
     if (reg_id >= 0x30 && reg_id < 0x37)
     {
-        printf("Read time: $%02X\n", mcu_time[reg_id - 0x30]);
+        LOG(LOG_I2C, LOG_DEBUG, "Read time: $%02X\n", mcu_time[reg_id - 0x30]);
         return mcu_time[reg_id - 0x30];
     }
 
@@ -278,7 +279,7 @@ uint8_t I2C::read_mcu(uint8_t reg_id)
         case 0x61:
             return 1; //WiFi disabled
         default:
-            printf("[I2C_MCU] Unrecognized read register $%02X\n", reg_id);
+            LOG(LOG_I2C, LOG_WARN, "[I2C_MCU] Unrecognized read register $%02X\n", reg_id);
     }
     return 0;
 }
@@ -310,12 +311,11 @@ void I2C::write_mcu(uint8_t reg_id, uint8_t value)
             for (int i = 0; i < 6; i++)
             {
                 if (value & (1 << i))
-                    scheduler->add_event([this](uint64_t param) { this->mcu_interrupt(param); }, 1000 * 1000,
-                        ARM11_CLOCKRATE, 24 + i);
+                    scheduler->add_event(mcu_interrupt_event, 1000 * 1000, ARM11_CLOCKRATE, 24 + i);
             }
             break;
         default:
-            printf("[I2C_MCU] Unrecognized write register $%02X\n", reg_id);
+            LOG(LOG_I2C, LOG_WARN, "[I2C_MCU] Unrecognized write register $%02X\n", reg_id);
     }
 }
 
@@ -324,7 +324,7 @@ void I2C::power_button()
     if (!power_pressed)
     {
         mcu_interrupt(0);
-        scheduler->add_event([this](uint64_t param) { mcu_interrupt(1);}, 5, 60);
+        scheduler->add_event(mcu_interrupt_event, 5, 60, 1);
     }
     power_pressed = true;
 }
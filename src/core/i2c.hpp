@@ -29,6 +29,7 @@ class I2C
     private:
         MPCore_PMR* pmr;
         Scheduler* scheduler;
+        int transfer_event, mcu_interrupt_event;
         I2C_CNT_REG cnt[3];
         I2C_Device devices[3][0x100];
         uint8_t data[3];
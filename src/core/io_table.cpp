@@ -0,0 +1,104 @@
+#include <algorithm>
+#include "common/exceptions.hpp"
+#include "io_table.hpp"
+
+IOTable::IOTable(Emulator* e) : e(e)
+{
+    unmapped = {"unmapped", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+    for (int i = 0; i < LEAF_COUNT; i++)
+        leaves[i] = &empty_leaf;
+    reset();
+}
+
+IOTable::~IOTable()
+{
+    reset();
+}
+
+void IOTable::reset()
+{
+    for (int i = 0; i < LEAF_COUNT; i++)
+    {
+        if (leaves[i] != &empty_leaf)
+            delete leaves[i];
+        leaves[i] = &empty_leaf;
+    }
+    devices.clear();
+
+    for (int i = 0; i < LEAF_SIZE; i++)
+    {
+        empty_leaf.devices[i] = &unmapped;
+        empty_leaf.accesses[i] = 0;
+    }
+}
+
+IODevice* IOTable::add_device(const char* name, uint32_t start, uint32_t size)
+{
+    //Widths the device doesn't set stay unmapped
+    IODevice device = unmapped;
+    device.name = name;
+    devices.push_back(device);
+
+    map(&devices.back(), start, size);
+    return &devices.back();
+}
+
+void IOTable::map(IODevice *device, uint32_t start, uint32_t size)
+{
+    const uint32_t PAGE_MASK = (1 << PAGE_SHIFT) - 1;
+    if ((start & PAGE_MASK) || (size & PAGE_MASK))
+        EmuException::die("[IOTable] %s mapped to unaligned range $%08X-$%08X", device->name, start, start + size);
+
+    //Later mappings win over earlier ones
+    for (uint64_t addr = start; addr < (uint64_t)start + size; addr += 1 << PAGE_SHIFT)
+    {
+        Leaf* leaf = get_leaf(addr);
+        if (leaf == &empty_leaf)
+        {
+            leaf = new Leaf;
+            for (int i = 0; i < LEAF_SIZE; i++)
+            {
+                leaf->devices[i] = &unmapped;
+                leaf->accesses[i] = 0;
+            }
+            leaves[addr >> (PAGE_SHIFT + LEAF_SHIFT)] = leaf;
+        }
+        leaf->devices[get_page(addr)] = device;
+    }
+}
+
+std::vector<IOPageStats> IOTable::get_hottest_pages(int count)
+{
+    std::vector<IOPageStats> pages;
+    for (int i = 0; i < LEAF_COUNT; i++)
+    {
+        //Unmapped accesses don't return, so the shared leaf has nothing worth reporting
+        if (leaves[i] == &empty_leaf)
+            continue;
+
+        for (int j = 0; j < LEAF_SIZE; j++)
+        {
+            if (leaves[i]->accesses[j])
+            {
+                uint32_t addr = ((i << LEAF_SHIFT) | j) << PAGE_SHIFT;
+                pages.push_back({addr, leaves[i]->devices[j]->name, leaves[i]->accesses[j]});
+            }
+        }
+    }
+
+    count = std::min(count, (int)pages.size());
+    std::partial_sort(pages.begin(), pages.begin() + count, pages.end(),
+                      [](const IOPageStats& a, const IOPageStats& b) {return a.accesses > b.accesses;});
+    pages.resize(count);
+    return pages;
+}
+
+void IOTable::reset_stats()
+{
+    for (int i = 0; i < LEAF_COUNT; i++)
+    {
+        if (leaves[i] != &empty_leaf)
+            std::fill(leaves[i]->accesses, leaves[i]->accesses + LEAF_SIZE, 0);
+    }
+    std::fill(empty_leaf.accesses, empty_leaf.accesses + LEAF_SIZE, 0);
+}
@@ -0,0 +1,143 @@
+#ifndef IO_TABLE_HPP
+#define IO_TABLE_HPP
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class Emulator;
+
+//Handlers for one peripheral. Widths the peripheral doesn't handle fall back to the table's unmapped handlers.
+struct IODevice
+{
+    const char* name;
+    uint8_t (*read8)(Emulator* e, int core, uint32_t addr);
+    uint16_t (*read16)(Emulator* e, int core, uint32_t addr);
+    uint32_t (*read32)(Emulator* e, int core, uint32_t addr);
+    void (*write8)(Emulator* e, int core, uint32_t addr, uint8_t value);
+    void (*write16)(Emulator* e, int core, uint32_t addr, uint16_t value);
+    void (*write32)(Emulator* e, int core, uint32_t addr, uint32_t value);
+};
+
+struct IOPageStats
+{
+    uint32_t addr;
+    const char* name;
+    uint64_t accesses;
+};
+
+/***
+ * Maps every 4 KB page of a CPU's physical address space to the peripheral handling it, so an access is one table
+ * lookup and one indirect call no matter how many peripherals there are.
+ * Like PageMap, the table has two levels. Leaves that nothing has been mapped into share one leaf pointing at the
+ * unmapped device. Each page also counts its accesses for profiling.
+***/
+
+class IOTable
+{
+    public:
+        constexpr static int PAGE_SHIFT = 12;
+        constexpr static int LEAF_SHIFT = 10;
+        constexpr static int LEAF_SIZE = 1 << LEAF_SHIFT;
+        constexpr static int LEAF_COUNT = (1 << (32 - PAGE_SHIFT)) / LEAF_SIZE;
+    private:
+        struct Leaf
+        {
+            IODevice* devices[LEAF_SIZE];
+            uint64_t accesses[LEAF_SIZE];
+        };
+
+        Emulator* e;
+
+        //A deque, so the pointers handed out by add_device stay valid
+        std::deque<IODevice> devices;
+        IODevice unmapped;
+
+        Leaf empty_leaf;
+        Leaf* leaves[LEAF_COUNT];
+
+        Leaf* get_leaf(uint32_t addr);
+        int get_page(uint32_t addr);
+    public:
+        IOTable(Emulator* e);
+        ~IOTable();
+
+        void reset();
+        IODevice* get_unmapped();
+        IODevice* add_device(const char* name, uint32_t start, uint32_t size);
+        void map(IODevice* device, uint32_t start, uint32_t size);
+
+        uint8_t read8(int core, uint32_t addr);
+        uint16_t read16(int core, uint32_t addr);
+        uint32_t read32(int core, uint32_t addr);
+        void write8(int core, uint32_t addr, uint8_t value);
+        void write16(int core, uint32_t addr, uint16_t value);
+        void write32(int core, uint32_t addr, uint32_t value);
+
+        std::vector<IOPageStats> get_hottest_pages(int count);
+        void reset_stats();
+};
+
+inline IODevice* IOTable::get_unmapped()
+{
+    return &unmapped;
+}
+
+inline IOTable::Leaf* IOTable::get_leaf(uint32_t addr)
+{
+    return leaves[addr >> (PAGE_SHIFT + LEAF_SHIFT)];
+}
+
+inline int IOTable::get_page(uint32_t addr)
+{
+    return (addr >> PAGE_SHIFT) & (LEAF_SIZE - 1);
+}
+
+inline uint8_t IOTable::read8(int core, uint32_t addr)
+{
+    Leaf* leaf = get_leaf(addr);
+    int page = get_page(addr);
+    leaf->accesses[page]++;
+    return leaf->devices[page]->read8(e, core, addr);
+}
+
+inline uint16_t IOTable::read16(int core, uint32_t addr)
+{
+    Leaf* leaf = get_leaf(addr);
+    int page = get_page(addr);
+    leaf->accesses[page]++;
+    return leaf->devices[page]->read16(e, core, addr);
+}
+
+inline uint32_t IOTable::read32(int core, uint32_t addr)
+{
+    Leaf* leaf = get_leaf(addr);
+    int page = get_page(addr);
+    leaf->accesses[page]++;
+    return leaf->devices[page]->read32(e, core, addr);
+}
+
+inline void IOTable::write8(int core, uint32_t addr, uint8_t value)
+{
+    Leaf* leaf = get_leaf(addr);
+    int page = get_page(addr);
+    leaf->accesses[page]++;
+    leaf->devices[page]->write8(e, core, addr, value);
+}
+
+inline void IOTable::write16(int core, uint32_t addr, uint16_t value)
+{
+    Leaf* leaf = get_leaf(addr);
+    int page = get_page(addr);
+    leaf->accesses[page]++;
+    leaf->devices[page]->write16(e, core, addr, value);
+}
+
+inline void IOTable::write32(int core, uint32_t addr, uint32_t value)
+{
+    Leaf* leaf = get_leaf(addr);
+    int page = get_page(addr);
+    leaf->accesses[page]++;
+    leaf->devices[page]->write32(e, core, addr, value);
+}
+
+#endif // IO_TABLE_HPP
@@ -3,6 +3,7 @@
 #include <fstream>
 #include "arm11/mpcore_pmr.hpp"
 #include "arm9/interrupt9.hpp"
+#include "common/log.hpp"
 #include "p9_hle.hpp"
 #include "pxi.hpp"
 
@@ -22,6 +23,7 @@ void PXI::reset()
 {
     ready_for_hle = false;
     sending_hle_cmd = false;
+    activity = false;
     if (!log.is_open())
         log.open("pxi_log.txt");
     memset(&sync9, 0, sizeof(sync9));
@@ -63,7 +65,7 @@ uint16_t PXI::read_cnt9()
     reg |= cnt9.recv_not_empty_irq << 10;
     reg |= cnt9.error << 14;
     reg |= cnt9.enable << 15;
-    printf("[PXI] Read CNT9: $%04X\n", reg);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI] Read CNT9: $%04X\n", reg);
     return reg;
 }
 
@@ -78,15 +80,16 @@ uint16_t PXI::read_cnt11()
     reg |= cnt11.recv_not_empty_irq << 10;
     reg |= cnt11.error << 14;
     reg |= cnt11.enable << 15;
-    printf("[PXI] Read CNT11: $%04X\n", reg);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI] Read CNT11: $%04X\n", reg);
     return reg;
 }
 
 void PXI::write_sync9(uint32_t value)
 {
-    printf("[PXI] Write sync9: $%08X\n", value);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI] Write sync9: $%08X\n", value);
     sync11.recv_data = (value >> 8) & 0xFF;
     sync9.local_irq = value & (1 << 31);
+    activity = true;
 
     if ((value & (1 << 29)) && sync11.local_irq)
         mpcore->assert_hw_irq(0x50);
@@ -94,9 +97,10 @@ void PXI::write_sync9(uint32_t value)
 
 void PXI::write_sync11(uint32_t value)
 {
-    printf("[PXI] Write sync11: $%08X\n", value);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI] Write sync11: $%08X\n", value);
     sync9.recv_data = (value >> 8) & 0xFF;
     sync11.local_irq = value & (1 << 31);
+    activity = true;
 
     if ((value & (1 << 30)) && sync9.local_irq)
     {
@@ -110,7 +114,7 @@ void PXI::write_sync11(uint32_t value)
 
 void PXI::write_cnt9(uint16_t value)
 {
-    printf("[PXI] Write CNT9: $%04X\n", value);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI] Write CNT9: $%04X\n", value);
 
     if (!cnt9.recv_not_empty_irq && (value & (1 << 10)))
     {
@@ -139,7 +143,7 @@ void PXI::write_cnt9(uint16_t value)
 
 void PXI::write_cnt11(uint16_t value)
 {
-    printf("[PXI] Write CNT11: $%04X\n", value);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI] Write CNT11: $%04X\n", value);
 
     if (!cnt11.recv_not_empty_irq && (value & (1 << 10)))
     {
@@ -192,7 +196,7 @@ uint32_t PXI::read_msg9()
         if (!recv9.size() && cnt11.send_empty_irq)
             mpcore->assert_hw_irq(0x52);
     }
-    printf("[PXI9] Read $%08X\n", last_recv9);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI9] Read $%08X\n", last_recv9);
     return last_recv9;
 }
 
@@ -206,23 +210,25 @@ uint32_t PXI::read_msg11()
             int9->assert_irq(13);
     }
     //log << "[PXI] Read from ARM9: " << std::hex << last_recv11 << std::endl;
-    printf("[PXI11] Read $%08X\n", last_recv11);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI11] Read $%08X\n", last_recv11);
     return last_recv11;
 }
 
 void PXI::send_to_9(uint32_t value)
 {
     //log << "[PXI] Send to ARM9: " << std::hex << value << std::endl;
-    printf("[PXI] Send to 9: $%08X (%ld)\n", value, recv9.size());
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI] Send to 9: $%08X (%ld)\n", value, recv9.size());
     recv9.push(value);
+    activity = true;
     if (recv9.size() == 1 && cnt9.recv_not_empty_irq)
         int9->assert_irq(14);
 }
 
 void PXI::send_to_11(uint32_t value)
 {
-    printf("[PXI] Send to 11: $%08X\n", value);
+    LOG(LOG_PXI, LOG_DEBUG, "[PXI] Send to 11: $%08X\n", value);
     recv11.push(value);
+    activity = true;
     if (recv11.size() == 1 && cnt11.recv_not_empty_irq)
         mpcore->assert_hw_irq(0x53);
 }
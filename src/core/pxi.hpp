@@ -37,6 +37,9 @@ class PXI
         std::queue<uint32_t> recv9, recv11;
 
         uint32_t last_recv9, last_recv11;
+
+        //Set whenever one side signals the other, so the emulator can keep time slices short during handshakes
+        bool activity;
     public:
         PXI(MPCore_PMR* mpcore, Interrupt9* int9);
         ~PXI();
@@ -57,6 +60,15 @@ class PXI
 
         void send_to_9(uint32_t value);
         void send_to_11(uint32_t value);
+
+        bool check_activity();
 };
 
+inline bool PXI::check_activity()
+{
+    bool active = activity || !recv9.empty() || !recv11.empty();
+    activity = false;
+    return active;
+}
+
 #endif // PXI_HPP
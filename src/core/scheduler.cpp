@@ -1,16 +1,31 @@
 #include <algorithm>
+#include <cstring>
+#include "common/exceptions.hpp"
 #include "scheduler.hpp"
 
+constexpr static int64_t NO_EVENT_TIME = 0x7FFFFFFFULL << 32ULL;
+
 Scheduler::Scheduler()
 {
-
+    //Enough for a busy boot, so the pool normally never grows
+    events.reserve(64);
+    free_events.reserve(64);
+    heap.reserve(64);
+    reset();
 }
 
 void Scheduler::reset()
 {
-    events.clear();
+    //Keep the registered types and the pool, but make every outstanding handle stale
+    while (!heap.empty())
+    {
+        int index = heap.back();
+        heap.pop_back();
+        free_event(index);
+    }
+    next_order = 0;
 
-    closest_event_time = 0;
+    closest_event_time = NO_EVENT_TIME;
 
     quantum.count = 0;
     quantum.remainder = 0;
@@ -23,6 +38,13 @@ void Scheduler::reset()
 
     xtensa_cycles.count = 0;
     xtensa_cycles.remainder = 0;
+
+    reset_slice_stats();
+}
+
+void Scheduler::reset_slice_stats()
+{
+    memset(&slice_stats, 0, sizeof(slice_stats));
 }
 
 void Scheduler::calculate_cycles_to_run()
@@ -35,53 +57,135 @@ void Scheduler::calculate_cycles_to_run()
 
     if (quantum.count + MAX_CYCLES <= closest_event_time)
         delta = MAX_CYCLES;
-    else
-    {
-        int64_t delta = closest_event_time - quantum.count;
-        if (delta < 0)
-            delta = 0;
-    }
+    else if (delta < 0)
+        delta = 0;
+
+    split_quantum(delta, SLICE_SHORT);
+}
+
+void Scheduler::calculate_long_cycles_to_run(int64_t max_cycles11)
+{
+    //For when nothing timing-sensitive is going on. The caller decides how far that can safely stretch.
+    split_quantum(get_bounded_delta(max_cycles11), SLICE_LONG);
+}
+
+void Scheduler::calculate_idle_cycles_to_run()
+{
+    //Nothing but events can happen, so run straight up to the next one
+    split_quantum(get_bounded_delta(cycles11.clockrate), SLICE_IDLE);
+}
+
+int64_t Scheduler::get_bounded_delta(int64_t max_cycles11)
+{
+    int64_t delta = closest_event_time - quantum.count;
+    if (delta < 0)
+        delta = 0;
+
+    //Keep the cycle counts handed to the components within an int
+    max_cycles11 = std::min(max_cycles11, (int64_t)cycles11.clockrate);
+    int64_t max_delta = (max_cycles11 * quantum.clockrate + cycles11.clockrate - 1) / cycles11.clockrate;
+    return std::min(delta, max_delta);
+}
 
+void Scheduler::split_quantum(int64_t delta, SLICE_TYPE type)
+{
     quantum_cycles = delta;
 
-    cycles11_to_run = delta * cycles11.clockrate / quantum.clockrate;
-    cycles11.remainder = delta * cycles11.clockrate % quantum.clockrate;
-    if (cycles11.remainder >= quantum.clockrate / cycles11.clockrate)
-    {
-        cycles11_to_run++;
-        cycles11.remainder -= quantum.clockrate / cycles11.clockrate;
-    }
+    cycles11_to_run = convert_from_quantum(cycles11, delta);
+    cycles9_to_run = convert_from_quantum(cycles9, delta);
+    xtensa_cycles_to_run = convert_from_quantum(xtensa_cycles, delta);
+
+    slice_stats.count[type]++;
+    slice_stats.cycles11[type] += cycles11_to_run;
+    slice_stats.longest_cycles11 = std::max(slice_stats.longest_cycles11, (uint64_t)cycles11_to_run);
+    if (quantum.count + delta == closest_event_time)
+        slice_stats.ended_by_event++;
+}
+
+int64_t Scheduler::convert_from_quantum(CycleCount &clock, int64_t delta)
+{
+    //Carry the fraction over to the next quantum, so the cycles handed out don't depend on how time is split up
+    int64_t total = delta * clock.clockrate + clock.remainder;
+    clock.remainder = total % quantum.clockrate;
+    return total / quantum.clockrate;
+}
 
-    cycles9_to_run = delta * cycles9.clockrate / quantum.clockrate;
-    cycles9.remainder = delta * cycles9.clockrate % quantum.clockrate;
-    if (cycles9.remainder >= quantum.clockrate / cycles9.clockrate)
+int64_t Scheduler::get_time_to_run(int64_t cycles, uint64_t clockrate)
+{
+    //Round up, so an event is never due before its cycles have passed on clocks that don't divide the quantum rate.
+    //Split up so long delays don't overflow.
+    int64_t whole = (cycles / clockrate) * quantum.clockrate;
+    int64_t part = ((cycles % clockrate) * quantum.clockrate + clockrate - 1) / clockrate;
+    return quantum.count + whole + part;
+}
+
+int Scheduler::register_event(const char* name, std::function<void(uint64_t)> func)
+{
+    types.push_back({name, func});
+    return types.size() - 1;
+}
+
+SchedulerHandle Scheduler::add_event(int type, int64_t cycles, uint64_t clockrate, uint64_t param)
+{
+    if (type < 0 || type >= (int)types.size())
+        EmuException::die("[Scheduler] Unregistered event type %d", type);
+
+    int index;
+    if (free_events.empty())
     {
-        cycles9_to_run++;
-        cycles9.remainder -= quantum.clockrate / cycles9.clockrate;
+        index = events.size();
+        events.push_back({});
+        events[index].generation = 0;
     }
-
-    xtensa_cycles_to_run = delta * xtensa_cycles.clockrate / quantum.clockrate;
-    xtensa_cycles.remainder = delta * xtensa_cycles.clockrate % quantum.clockrate;
-    if (xtensa_cycles.remainder >= quantum.clockrate / xtensa_cycles.clockrate)
+    else
     {
-        xtensa_cycles_to_run++;
-        xtensa_cycles.remainder -= quantum.clockrate / xtensa_cycles.clockrate;
+        index = free_events.back();
+        free_events.pop_back();
     }
+
+    SchedulerEvent& event = events[index];
+    event.time_registered = quantum.count;
+    event.time_to_run = get_time_to_run(cycles, clockrate);
+    event.order = next_order++;
+    event.param = param;
+    event.type = type;
+
+    event.heap_index = heap.size();
+    heap.push_back(index);
+    sift_up(event.heap_index);
+
+    update_closest_event();
+    return {index, event.generation};
 }
 
-void Scheduler::add_event(std::function<void(uint64_t)> func, int64_t cycles, uint64_t clockrate, uint64_t param)
+bool Scheduler::cancel_event(SchedulerHandle handle)
 {
-    SchedulerEvent event;
+    SchedulerEvent* event = get_event(handle);
+    if (!event)
+        return false;
 
-    event.func = func;
-    event.time_registered = -1; //TODO
+    remove_from_heap(event->heap_index);
+    free_event(handle.index);
+    update_closest_event();
+    return true;
+}
 
-    event.time_to_run = quantum.count + (cycles * (quantum.clockrate / clockrate));
-    event.param = param;
+bool Scheduler::reschedule_event(SchedulerHandle handle, int64_t cycles, uint64_t clockrate)
+{
+    SchedulerEvent* event = get_event(handle);
+    if (!event)
+        return false;
+
+    //Counts as added now, for the sake of ordering against other events due at the same time
+    event->time_registered = quantum.count;
+    event->time_to_run = get_time_to_run(cycles, clockrate);
+    event->order = next_order++;
 
-    closest_event_time = std::min(event.time_to_run, closest_event_time);
+    sift_up(event->heap_index);
+    sift_down(event->heap_index);
 
-    events.push_back(event);
+    update_closest_event();
+    return true;
 }
 
 void Scheduler::process_events()
@@ -90,22 +194,105 @@ void Scheduler::process_events()
     cycles11.count += cycles11_to_run;
     cycles9.count += cycles9_to_run;
     xtensa_cycles.count += xtensa_cycles_to_run;
-    if (quantum.count >= closest_event_time)
+
+    //Events added while running others are picked up as well if they're already due
+    while (!heap.empty() && events[heap[0]].time_to_run <= quantum.count)
     {
-        int64_t new_time = 0x7FFFFFFFULL << 32ULL;
-        for (auto it = events.begin(); it != events.end(); )
-        {
-            if (it->time_to_run <= closest_event_time)
-            {
-                it->func(it->param);
-                it = events.erase(it);
-            }
-            else
-            {
-                new_time = std::min(it->time_to_run, new_time);
-                it++;
-            }
-        }
-        closest_event_time = new_time;
+        int index = heap[0];
+        remove_from_heap(0);
+
+        //The callback may add events and grow the pool, so don't hold on to the slot
+        int type = events[index].type;
+        uint64_t param = events[index].param;
+        free_event(index);
+
+        types[type].func(param);
     }
+    update_closest_event();
+}
+
+SchedulerEvent* Scheduler::get_event(SchedulerHandle handle)
+{
+    if (handle.index < 0 || handle.index >= (int)events.size())
+        return nullptr;
+
+    SchedulerEvent* event = &events[handle.index];
+    if (event->heap_index < 0 || event->generation != handle.generation)
+        return nullptr;
+    return event;
+}
+
+bool Scheduler::event_before(int a, int b)
+{
+    if (events[a].time_to_run != events[b].time_to_run)
+        return events[a].time_to_run < events[b].time_to_run;
+    return events[a].order < events[b].order;
+}
+
+void Scheduler::sift_up(int pos)
+{
+    int index = heap[pos];
+    while (pos > 0)
+    {
+        int parent = (pos - 1) / 2;
+        if (!event_before(index, heap[parent]))
+            break;
+
+        heap[pos] = heap[parent];
+        events[heap[pos]].heap_index = pos;
+        pos = parent;
+    }
+    heap[pos] = index;
+    events[index].heap_index = pos;
+}
+
+void Scheduler::sift_down(int pos)
+{
+    int index = heap[pos];
+    int size = heap.size();
+    while (true)
+    {
+        int child = pos * 2 + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && event_before(heap[child + 1], heap[child]))
+            child++;
+        if (!event_before(heap[child], index))
+            break;
+
+        heap[pos] = heap[child];
+        events[heap[pos]].heap_index = pos;
+        pos = child;
+    }
+    heap[pos] = index;
+    events[index].heap_index = pos;
+}
+
+void Scheduler::remove_from_heap(int pos)
+{
+    int last = heap.back();
+    heap.pop_back();
+    if (pos == (int)heap.size())
+        return;
+
+    //Move the last event into the hole and let it settle in whichever direction it needs to
+    heap[pos] = last;
+    events[last].heap_index = pos;
+    sift_up(pos);
+    sift_down(events[last].heap_index);
+}
+
+void Scheduler::free_event(int index)
+{
+    events[index].heap_index = -1;
+    events[index].generation++;
+    free_events.push_back(index);
+}
+
+void Scheduler::update_closest_event()
+{
+    if (heap.empty())
+        closest_event_time = NO_EVENT_TIME;
+    else
+        closest_event_time = events[heap[0]].time_to_run;
 }
@@ -2,7 +2,7 @@
 #define SCHEDULER_HPP
 #include <cstdint>
 #include <functional>
-#include <list>
+#include <vector>
 
 //List of different frequencies
 constexpr static uint64_t ARM11_CLOCKRATE = 268111856; //268 MHz
@@ -16,18 +16,68 @@ struct CycleCount
     uint64_t clockrate;
 };
 
+enum SLICE_TYPE
+{
+    SLICE_SHORT,
+    SLICE_LONG,
+    SLICE_IDLE,
+    SLICE_TYPE_COUNT
+};
+
+//How the time between calls to process_events was split up, for tuning accuracy against speed
+struct SliceStats
+{
+    uint64_t count[SLICE_TYPE_COUNT];
+    uint64_t cycles11[SLICE_TYPE_COUNT];
+    uint64_t longest_cycles11;
+    uint64_t ended_by_event;
+};
+
+//Identifies one scheduled event. Goes stale once the event runs or is cancelled.
+struct SchedulerHandle
+{
+    int index;
+    uint32_t generation;
+};
+
+struct SchedulerEventType
+{
+    const char* name;
+    std::function<void(uint64_t)> func;
+};
+
 struct SchedulerEvent
 {
     int64_t time_registered;
     int64_t time_to_run;
+
+    //Breaks ties between events due at the same time, so they run in the order they were added
+    uint64_t order;
+
     uint64_t param;
-    std::function<void(uint64_t)> func;
+    int type;
+
+    //-1 while the event is free
+    int heap_index;
+    uint32_t generation;
 };
 
+/***
+ * Events are kept in a binary min-heap ordered by the time they're due, so adding, cancelling, or running one is
+ * O(log n) instead of a scan over everything pending.
+ * Components register the kinds of events they use once when they're constructed. Scheduling one then only fills in
+ * a slot from a pool that's reused, so nothing is allocated once the pool has grown to the usual number of events.
+ * Each event remembers its position in the heap, which is what lets a handle cancel or move it.
+***/
+
 class Scheduler
 {
     private:
-        std::list<SchedulerEvent> events;
+        std::vector<SchedulerEventType> types;
+        std::vector<SchedulerEvent> events;
+        std::vector<int> free_events;
+        std::vector<int> heap;
+        uint64_t next_order;
 
         int64_t closest_event_time;
 
@@ -40,21 +90,50 @@ class Scheduler
         int64_t cycles11_to_run;
         int64_t cycles9_to_run;
         int64_t xtensa_cycles_to_run;
+
+        SliceStats slice_stats;
+
+        int64_t get_bounded_delta(int64_t max_cycles11);
+        void split_quantum(int64_t delta, SLICE_TYPE type);
+        int64_t convert_from_quantum(CycleCount& clock, int64_t delta);
+        int64_t get_time_to_run(int64_t cycles, uint64_t clockrate);
+
+        SchedulerEvent* get_event(SchedulerHandle handle);
+        bool event_before(int a, int b);
+        void sift_up(int pos);
+        void sift_down(int pos);
+        void remove_from_heap(int pos);
+        void free_event(int index);
+        void update_closest_event();
     public:
         Scheduler();
 
         void calculate_cycles_to_run();
+        void calculate_long_cycles_to_run(int64_t max_cycles11);
+        void calculate_idle_cycles_to_run();
         int64_t get_cycles11_to_run();
         int64_t get_cycles9_to_run();
         int64_t get_xtensa_cycles_to_run();
+        int64_t get_cycles11_count();
+        int64_t get_cycles9_count();
         void reset();
 
+        SliceStats get_slice_stats();
+        void reset_slice_stats();
+
         void set_quantum_rate(uint64_t clock);
         void set_clockrate_11(uint64_t clock);
         void set_clockrate_9(uint64_t clock);
         void set_clockrate_xtensa(uint64_t clock);
-
-        void add_event(std::function<void(uint64_t)> func, int64_t cycles, uint64_t clockrate, uint64_t param = 0);
+        uint64_t get_clockrate_11();
+        uint64_t get_clockrate_9();
+
+        int register_event(const char* name, std::function<void(uint64_t)> func);
+        SchedulerHandle add_event(int type, int64_t cycles, uint64_t clockrate, uint64_t param = 0);
+        bool cancel_event(SchedulerHandle handle);
+        bool reschedule_event(SchedulerHandle handle, int64_t cycles, uint64_t clockrate);
+        bool is_scheduled(SchedulerHandle handle);
+        int get_pending_count();
         void process_events();
 };
 
@@ -73,6 +152,22 @@ inline int64_t Scheduler::get_xtensa_cycles_to_run()
     return xtensa_cycles_to_run;
 }
 
+//Cycles run up to the start of the current slice
+inline int64_t Scheduler::get_cycles11_count()
+{
+    return cycles11.count;
+}
+
+inline int64_t Scheduler::get_cycles9_count()
+{
+    return cycles9.count;
+}
+
+inline SliceStats Scheduler::get_slice_stats()
+{
+    return slice_stats;
+}
+
 inline void Scheduler::set_quantum_rate(uint64_t clock)
 {
     quantum.clockrate = clock;
@@ -93,4 +188,24 @@ inline void Scheduler::set_clockrate_xtensa(uint64_t clock)
     xtensa_cycles.clockrate = clock;
 }
 
+inline uint64_t Scheduler::get_clockrate_11()
+{
+    return cycles11.clockrate;
+}
+
+inline uint64_t Scheduler::get_clockrate_9()
+{
+    return cycles9.clockrate;
+}
+
+inline bool Scheduler::is_scheduled(SchedulerHandle handle)
+{
+    return get_event(handle) != nullptr;
+}
+
+inline int Scheduler::get_pending_count()
+{
+    return heap.size();
+}
+
 #endif // SCHEDULER_HPP
@@ -35,7 +35,7 @@ uint32_t SPI::read32(uint32_t addr)
     switch (reg)
     {
         case 0x00:
-            printf("[SPI] Read NSPI_CNT%d\n", bus);
+            LOG(LOG_SPI, LOG_DEBUG, "[SPI] Read NSPI_CNT%d\n", bus);
             return 0;
         case 0x03:
         {
@@ -49,7 +49,7 @@ uint32_t SPI::read32(uint32_t addr)
             return value;
         }
         default:
-            printf("[SPI] Unrecognized bus%d read32 $%08X\n", bus, addr);
+            LOG(LOG_SPI, LOG_WARN, "[SPI] Unrecognized bus%d read32 $%08X\n", bus, addr);
             return 0;
     }
 }
@@ -61,22 +61,22 @@ void SPI::write32(uint32_t addr, uint32_t value)
     switch (reg)
     {
         case 0x00:
-            printf("[SPI] Write NSPI_CNT%d: $%08X\n", bus, value);
+            LOG(LOG_SPI, LOG_DEBUG, "[SPI] Write NSPI_CNT%d: $%08X\n", bus, value);
             nspi_cnt[bus].bandwidth = value & 0x7;
             nspi_cnt[bus].device = (value >> 6) & 0x3;
             nspi_cnt[bus].busy = (value >> 15) & 0x1;
             break;
         case 0x01:
-            printf("[SPI] Write NSPI_DONE%d: $%08X\n", bus, value);
+            LOG(LOG_SPI, LOG_DEBUG, "[SPI] Write NSPI_DONE%d: $%08X\n", bus, value);
             if (!(value & 0x1))
                 nspi_cmd[bus] = 0;
             break;
         case 0x02:
-            printf("[SPI] Write NSPI_LEN%d: $%08X\n", bus, value);
+            LOG(LOG_SPI, LOG_DEBUG, "[SPI] Write NSPI_LEN%d: $%08X\n", bus, value);
             nspi_len[bus] = value;
             break;
         case 0x03:
-            printf("[SPI] Write NSPI_FIFO%d: $%08X\n", bus, value);
+            LOG(LOG_SPI, LOG_DEBUG, "[SPI] Write NSPI_FIFO%d: $%08X\n", bus, value);
             if (!nspi_cmd[bus])
             {
                 nspi_cmd[bus] = value;
@@ -98,7 +98,7 @@ void SPI::write32(uint32_t addr, uint32_t value)
             }
             break;
         default:
-            printf("[SPI] Unrecognized bus%d write32 $%08X: $%08X\n", bus, addr, value);
+            LOG(LOG_SPI, LOG_WARN, "[SPI] Unrecognized bus%d write32 $%08X: $%08X\n", bus, addr, value);
     }
 }
 
@@ -137,11 +137,11 @@ void SPI::process_cmd(int bus)
                     memcpy(nspi_buff[bus], temp_buff, 0x34);
                     break;
                 default:
-                    printf("[CODEC] Unrecognized command $%02X\n", nspi_cmd[bus]);
+                    LOG(LOG_SPI, LOG_WARN, "[CODEC] Unrecognized command $%02X\n", nspi_cmd[bus]);
             }
             break;
         default:
-            printf("[SPI] Unrecognized device $%02X\n", device);
+            LOG(LOG_SPI, LOG_WARN, "[SPI] Unrecognized device $%02X\n", device);
     }
 }
 
@@ -154,7 +154,7 @@ void SPI::set_touchscreen(uint16_t x, uint16_t y)
     touchscreen_x = bswp16(touchscreen_x);
     touchscreen_y = bswp16(touchscreen_y);
 
-    printf("TOUCH! %d %d\n", touchscreen_x, touchscreen_y);
+    LOG(LOG_SPI, LOG_DEBUG, "TOUCH! %d %d\n", touchscreen_x, touchscreen_y);
 }
 
 void SPI::clear_touchscreen()
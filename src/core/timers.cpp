@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include "common/common.hpp"
@@ -6,84 +7,181 @@
 #include "timers.hpp"
 #include "emulator.hpp"
 
-Timers::Timers(Interrupt9* int9, MPCore_PMR* pmr, Emulator* e) : int9(int9), pmr(pmr), e(e)
+Timers::Timers(Interrupt9* int9, MPCore_PMR* pmr, Emulator* e, Scheduler* scheduler) :
+    int9(int9), pmr(pmr), e(e), scheduler(scheduler)
 {
-
+    timer9_event = scheduler->register_event("Timer9 overflow", [this](uint64_t param) {timer9_overflow(param);});
+    timer11_event = scheduler->register_event("Timer11 overflow", [this](uint64_t param) {timer11_overflow(param);});
 }
 
 void Timers::reset()
 {
     memset(arm9_timers, 0, sizeof(arm9_timers));
     memset(arm11_timers, 0, sizeof(arm11_timers));
+    for (int i = 0; i < 4; i++)
+        arm9_timers[i].overflow_event = {-1, 0};
+    for (int i = 0; i < 8; i++)
+        arm11_timers[i].overflow_event = {-1, 0};
+}
+
+void Timers::timer9_overflow(uint64_t)
+{
+    //All four are caught up together, as the overflow may come from further down a count-up chain
+    update_arm9_timers();
+    schedule_arm9_timers();
+}
+
+void Timers::timer11_overflow(uint64_t id)
+{
+    update_arm11_timer(id);
+    schedule_arm11_timer(id);
 }
 
-void Timers::run(int cycles11, int cycles9)
+void Timers::update_arm9_timers()
 {
+    //Bring the counters up to the start of the current slice. Lower timers go first, so their overflows reach any
+    //count-up timers above them.
+    int64_t now = scheduler->get_cycles9_count();
     for (int i = 0; i < 4; i++)
     {
-        if (arm9_timers[i].enabled && !arm9_timers[i].countup)
-        {
-            arm9_timers[i].clocks += cycles9;
-            while (arm9_timers[i].clocks >= arm9_timers[i].prescalar)
-            {
-                arm9_timers[i].counter++;
-                arm9_timers[i].clocks -= arm9_timers[i].prescalar;
-                if (arm9_timers[i].counter >= 0x10000)
-                {
-                    handle_overflow(i);
-                }
-            }
-        }
+        Timer9& timer = arm9_timers[i];
+        if (!timer.enabled || timer.countup || now <= timer.start_time)
+            continue;
+
+        uint64_t ticks = (now - timer.start_time) / timer.prescalar;
+        timer.start_time += ticks * timer.prescalar;
+
+        uint64_t total = timer.counter + ticks;
+        timer.counter = total & 0xFFFF;
+        if (total >= 0x10000)
+            handle_overflow(i, total >> 16);
     }
-    for (int i = 0; i < 8; i++)
+}
+
+void Timers::schedule_arm9_timers()
+{
+    //Overflows nobody can observe until the next access don't need an event
+    int64_t now = scheduler->get_cycles9_count();
+    for (int i = 0; i < 4; i++)
     {
-        if (arm11_timers[i].enabled)
-        {
-            arm11_timers[i].clocks += cycles11;
-            while (arm11_timers[i].enabled && arm11_timers[i].clocks >= arm11_timers[i].prescalar)
-            {
-                arm11_timers[i].counter--;
-                arm11_timers[i].clocks -= arm11_timers[i].prescalar;
-                if (arm11_timers[i].counter == 0)
-                {
-                    if (arm11_timers[i].auto_reload)
-                        arm11_timers[i].counter = arm11_timers[i].load;
-                    else
-                        arm11_timers[i].enabled = false;
-
-                    arm11_timers[i].int_flag = true;
-                    if (arm11_timers[i].int_enabled)
-                    {
-                        pmr->set_pending_irq(i & 0x3, 29 + (i / 4));
-                    }
-                }
-            }
-        }
+        Timer9& timer = arm9_timers[i];
+        scheduler->cancel_event(timer.overflow_event);
+        if (!timer.enabled || timer.countup || !overflow_can_raise_irq(i))
+            continue;
+
+        int64_t cycles9 = (int64_t)(0x10000 - timer.counter) * timer.prescalar - (now - timer.start_time);
+        timer.overflow_event = scheduler->add_event(timer9_event, cycles9, scheduler->get_clockrate_9(), i);
     }
 }
 
-void Timers::handle_overflow(int index)
+bool Timers::overflow_can_raise_irq(int index)
+{
+    //Follow the chain of count-up timers, as any of them can overflow as a result
+    while (!arm9_timers[index].overflow_irq)
+    {
+        if (index == 3 || !arm9_timers[index + 1].enabled || !arm9_timers[index + 1].countup)
+            return false;
+        index++;
+    }
+    return true;
+}
+
+void Timers::handle_overflow(int index, uint64_t count)
 {
-    arm9_timers[index].counter -= 0x10000;
     //printf("[Timer9] Overflow on timer %d!\n", index);
     if (arm9_timers[index].overflow_irq)
         int9->assert_irq(8 + index);
 
-    arm9_timers[index].counter = 0;
-
     if (index != 3)
     {
-        if (arm9_timers[index + 1].countup && arm9_timers[index + 1].enabled)
+        Timer9& next = arm9_timers[index + 1];
+        if (next.countup && next.enabled)
         {
-            arm9_timers[index + 1].counter++;
-            if (arm9_timers[index + 1].counter >= 0x10000)
-                handle_overflow(index + 1);
+            uint64_t total = next.counter + count;
+            next.counter = total & 0xFFFF;
+            if (total >= 0x10000)
+                handle_overflow(index + 1, total >> 16);
         }
     }
 }
 
+uint32_t Timers::get_arm11_counter_at(Timer11& timer, int64_t time)
+{
+    if (!timer.enabled || time <= timer.start_time)
+        return timer.counter;
+
+    uint64_t ticks = (time - timer.start_time) / timer.prescalar;
+
+    //A counter of zero has to wrap all the way around before it reaches zero again
+    uint64_t ticks_to_zero = (timer.counter) ? timer.counter : 0x100000000ULL;
+    if (ticks < ticks_to_zero)
+        return timer.counter - ticks;
+
+    //The overflow itself is left to update_arm11_timer, this is only a peek
+    if (!timer.auto_reload)
+        return 0;
+
+    ticks -= ticks_to_zero;
+    uint64_t period = (timer.load) ? timer.load : 0x100000000ULL;
+    return (uint32_t)(period - (ticks % period));
+}
+
+void Timers::update_arm11_timer(int id)
+{
+    Timer11& timer = arm11_timers[id];
+    int64_t now = scheduler->get_cycles11_count();
+    if (!timer.enabled)
+    {
+        timer.start_time = now;
+        return;
+    }
+    if (now <= timer.start_time)
+        return;
+
+    uint64_t ticks = (now - timer.start_time) / timer.prescalar;
+    uint64_t ticks_to_zero = (timer.counter) ? timer.counter : 0x100000000ULL;
+    if (ticks < ticks_to_zero)
+    {
+        timer.counter -= ticks;
+        timer.start_time += ticks * timer.prescalar;
+        return;
+    }
+
+    timer.counter = get_arm11_counter_at(timer, now);
+    if (timer.auto_reload)
+        timer.start_time += ticks * timer.prescalar;
+    else
+    {
+        //The counter stops at zero
+        timer.enabled = false;
+        timer.start_time = now;
+    }
+
+    timer.int_flag = true;
+    if (timer.int_enabled)
+        pmr->set_pending_irq(id & 0x3, 29 + (id / 4));
+}
+
+void Timers::schedule_arm11_timer(int id)
+{
+    //Without the IRQ, the interrupt flag and a stopped one-shot counter can wait until they're read
+    Timer11& timer = arm11_timers[id];
+    scheduler->cancel_event(timer.overflow_event);
+    if (!timer.enabled || !timer.int_enabled)
+        return;
+
+    int64_t now = scheduler->get_cycles11_count();
+    int64_t ticks_to_zero = (timer.counter) ? timer.counter : 0x100000000LL;
+    int64_t cycles11 = ticks_to_zero * timer.prescalar - (now - timer.start_time);
+
+    //Lowering the prescalar can leave the overflow already due
+    cycles11 = std::max(cycles11, (int64_t)0);
+    timer.overflow_event = scheduler->add_event(timer11_event, cycles11, scheduler->get_clockrate_11(), id);
+}
+
 uint16_t Timers::arm9_read16(uint32_t addr)
 {
+    update_arm9_timers();
     switch (addr)
     {
         case 0x10003000:
@@ -103,40 +201,45 @@ uint16_t Timers::arm9_read16(uint32_t addr)
         case 0x1000300E:
             return get_control(3);
     }
-    printf("[Timer9] Unrecognized read16 $%08X\n", addr);
+    LOG(LOG_TIMER, LOG_WARN, "[Timer9] Unrecognized read16 $%08X\n", addr);
     return 0;
 }
 
 void Timers::arm9_write16(uint32_t addr, uint16_t value)
 {
+    //Settle everything under the old settings first. A write to one timer can change when another raises an IRQ.
+    update_arm9_timers();
     switch (addr)
     {
         case 0x10003000:
             set_counter(0, value);
-            return;
+            break;
         case 0x10003002:
             set_control(0, value);
-            return;
+            break;
         case 0x10003004:
             set_counter(1, value);
-            return;
+            break;
         case 0x10003006:
             set_control(1, value);
-            return;
+            break;
         case 0x10003008:
             set_counter(2, value);
-            return;
+            break;
         case 0x1000300A:
             set_control(2, value);
-            return;
+            break;
         case 0x1000300C:
             set_counter(3, value);
-            return;
+            break;
         case 0x1000300E:
             set_control(3, value);
+            break;
+        default:
+            LOG(LOG_TIMER, LOG_WARN, "[Timer9] Unrecognized write16 $%08X: $%04X\n", addr, value);
             return;
     }
-    printf("[Timer9] Unrecognized write16 $%08X: $%04X\n", addr, value);
+    schedule_arm9_timers();
 }
 
 uint16_t Timers::get_control(int index)
@@ -157,36 +260,28 @@ uint16_t Timers::get_control(int index)
     reg |= arm9_timers[index].countup << 2;
     reg |= arm9_timers[index].overflow_irq << 6;
     reg |= arm9_timers[index].enabled << 7;
-    printf("[Timer9] Get timer%d control: $%04X\n", index, reg);
+    LOG(LOG_TIMER, LOG_DEBUG, "[Timer9] Get timer%d control: $%04X\n", index, reg);
     return reg;
 }
 
 void Timers::set_counter(int index, uint16_t value)
 {
-    printf("[Timer9] Set timer%d reload: $%04X\n", index, value);
+    LOG(LOG_TIMER, LOG_DEBUG, "[Timer9] Set timer%d reload: $%04X\n", index, value);
     arm9_timers[index].counter = value;
-    arm9_timers[index].clocks = 0;
+    arm9_timers[index].start_time = scheduler->get_cycles9_count();
 }
 
 void Timers::set_control(int index, uint16_t value)
 {
-    printf("[Timer9] Set timer%d ctrl: $%04X\n", index, value);
+    LOG(LOG_TIMER, LOG_DEBUG, "[Timer9] Set timer%d ctrl: $%04X\n", index, value);
     const static int prescalar_values[] = {1, 64, 256, 1024};
-    arm9_timers[index].clocks = 0;
+    arm9_timers[index].start_time = scheduler->get_cycles9_count();
 
     //Multiply prescalar by 2 because timers run at half the speed of the ARM9
     arm9_timers[index].prescalar = prescalar_values[value & 0x3] << 1;
     arm9_timers[index].countup = value & (1 << 2);
     arm9_timers[index].overflow_irq = value & (1 << 6);
-
-    bool old_enabled = arm9_timers[index].enabled;
     arm9_timers[index].enabled = value & (1 << 7);
-
-    if (!old_enabled && arm9_timers[index].enabled)
-    {
-        arm9_timers[index].clocks = 0;
-        //arm9_timers[index].counter = arm9_timers[index].reload;
-    }
 }
 
 uint32_t Timers::arm11_get_load(int id)
@@ -196,16 +291,15 @@ uint32_t Timers::arm11_get_load(int id)
 
 uint32_t Timers::arm11_get_counter(int id, int delta)
 {
-    uint32_t counter = arm11_timers[id].counter;
-
-    if (arm11_timers[id].enabled)
-        counter -= delta / arm11_timers[id].prescalar;
+    //delta is how far the reading core is into the current slice. Other cores may be further along, so only peek.
+    uint32_t counter = get_arm11_counter_at(arm11_timers[id], scheduler->get_cycles11_count() + delta);
     //printf("[Timers] Read ARM11 timer%d counter: $%08X (%d)\n", id, counter, delta);
     return counter;
 }
 
 uint32_t Timers::arm11_get_control(int id)
 {
+    update_arm11_timer(id);
     uint32_t reg = 0;
     reg = arm11_timers[id].enabled;
     reg |= arm11_timers[id].auto_reload << 1;
@@ -217,35 +311,43 @@ uint32_t Timers::arm11_get_control(int id)
 
 uint32_t Timers::arm11_get_int_status(int id)
 {
+    update_arm11_timer(id);
     return arm11_timers[id].int_flag;
 }
 
 void Timers::arm11_set_load(int id, uint32_t value)
 {
     //printf("[Timers] Set ARM11 timer%d load: $%08X\n", id, value);
+    update_arm11_timer(id);
     arm11_timers[id].load = value;
     arm11_timers[id].counter = value;
+    schedule_arm11_timer(id);
 }
 
 void Timers::arm11_set_counter(int id, uint32_t value)
 {
     //printf("[Timers] Set ARM11 timer%d counter: $%08X\n", id, value);
+    update_arm11_timer(id);
     arm11_timers[id].counter = value;
+    schedule_arm11_timer(id);
 }
 
 void Timers::arm11_set_control(int id, uint32_t value)
 {
     //printf("[Timers] Set ARM11 timer%d control: $%08X\n", id, value);
+    update_arm11_timer(id);
     arm11_timers[id].enabled = value & 0x1;
     arm11_timers[id].auto_reload = (value >> 1) & 0x1;
     arm11_timers[id].int_enabled = (value >> 2) & 0x1;
     arm11_timers[id].prescalar = (value >> 8) & 0xFF;
     arm11_timers[id].prescalar++;
     arm11_timers[id].prescalar <<= 1;
+    schedule_arm11_timer(id);
 }
 
 void Timers::arm11_set_int_status(int id, uint32_t value)
 {
     //printf("[Timers] Set ARM11 timer%d status: $%08X\n", id, value);
+    update_arm11_timer(id);
     arm11_timers[id].int_flag &= ~(value & 0x1);
 }
@@ -1,53 +1,78 @@
 #ifndef TIMERS_HPP
 #define TIMERS_HPP
 #include <cstdint>
+#include "scheduler.hpp"
 
 struct Timer9
 {
+    //Value at start_time, in ARM9 cycles. Count-up timers only change on overflows, so they ignore start_time.
     uint32_t counter;
-    uint32_t clocks;
+    int64_t start_time;
     uint32_t prescalar;
     bool countup;
     bool overflow_irq;
     bool enabled;
+    SchedulerHandle overflow_event;
 };
 
 struct Timer11
 {
     uint32_t load;
-    uint32_t clocks;
+
+    //Value at start_time, in ARM11 cycles
     uint32_t counter;
+    int64_t start_time;
     uint32_t prescalar;
     bool int_enabled;
     bool watchdog_mode;
     bool auto_reload;
     bool enabled;
     bool int_flag;
+    SchedulerHandle overflow_event;
 };
 
 class Interrupt9;
 class MPCore_PMR;
 class Emulator;
 
+/***
+ * Timers don't tick. Each one remembers its counter at some point in time, and the counter at any later point is
+ * worked out from the prescalar when it's read. Overflows that can raise an IRQ are events on the scheduler; all
+ * other effects of an overflow are caught up on the next time the timer is accessed. A timer that's disabled, has
+ * its IRQ masked, or counts slowly costs nothing between accesses.
+***/
+
 class Timers
 {
     private:
         Interrupt9* int9;
         MPCore_PMR* pmr;
         Emulator* e;
+        Scheduler* scheduler;
         Timer9 arm9_timers[4];
         Timer11 arm11_timers[8];
 
+        int timer9_event, timer11_event;
+
         uint16_t get_control(int index);
         void set_counter(int index, uint16_t value);
         void set_control(int index, uint16_t value);
 
-        void handle_overflow(int index);
+        void timer9_overflow(uint64_t index);
+        void timer11_overflow(uint64_t id);
+
+        void update_arm9_timers();
+        void schedule_arm9_timers();
+        void handle_overflow(int index, uint64_t count);
+        bool overflow_can_raise_irq(int index);
+
+        uint32_t get_arm11_counter_at(Timer11& timer, int64_t time);
+        void update_arm11_timer(int id);
+        void schedule_arm11_timer(int id);
     public:
-        Timers(Interrupt9* int9, MPCore_PMR* pmr, Emulator* e);
+        Timers(Interrupt9* int9, MPCore_PMR* pmr, Emulator* e, Scheduler* scheduler);
 
         void reset();
-        void run(int cycles11, int cycles9);
 
         uint16_t arm9_read16(uint32_t addr);
         void arm9_write16(uint32_t addr, uint16_t value);
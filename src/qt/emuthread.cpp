@@ -109,6 +109,12 @@ bool EmuThread::boot_emulator(QString cart_path)
         return false;
     }
 
+    e.set_cpu_backend((CPU_BACKEND)Settings::cpu_backend);
+    e.set_parallel_arm11(Settings::parallel_arm11);
+    e.set_fastmem(Settings::fastmem);
+    e.set_adaptive_quantum(Settings::adaptive_quantum);
+    e.set_gpu_threads(Settings::gpu_threads);
+    e.set_shader_jit(Settings::shader_jit);
     e.reset();
 
     quit = false;
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <QApplication>
 #include <QCommandLineOption>
 #include <QCommandLineParser>
+#include "../core/common/log.hpp"
 #include "emuwindow.hpp"
 #include "settings.hpp"
 
@@ -21,7 +23,16 @@ int main(int argc, char** argv)
         {"nand", "NAND dump. Must be dumped from latest version of GodMode9.", "nand"},
         {"sd", "SD image dump. Optional, but required for sighaxed NANDs.", "sd"},
         {"autoload", "3DS cartridge. Starts emulation immediately.", "cart"},
-        {"autoload-nocart", "Starts emulation immediately without a cartridge."}
+        {"autoload-nocart", "Starts emulation immediately without a cartridge."},
+        {"jit", "Use the x86-64 recompiler instead of the interpreter for the ARM cores."},
+        {"cached-interpreter", "Use the block-caching interpreter for the ARM cores."},
+        {"interpreter", "Use the interpreter for the ARM cores."},
+        {"parallel-arm11", "Run each ARM11 core on its own thread. Only used with the interpreter."},
+        {"fastmem", "Map guest RAM into host memory for faster ARM11 accesses. Only used with the interpreter."},
+        {"adaptive-quantum", "Run longer time slices while no DMA or CPU handshakes are in flight. Less accurate."},
+        {"gpu-threads", "Number of threads drawing triangles. Defaults to 1.", "count"},
+        {"shader-interpreter", "Interpret PICA200 shaders instead of compiling them to x86-64."},
+        {"log", "Log levels per subsystem, such as \"gpu=debug,arm=trace\". \"all\" sets every subsystem.", "levels"}
     });
 
     parser.process(a.arguments());
@@ -45,6 +56,32 @@ int main(int argc, char** argv)
     if (!sd_path.isEmpty())
         Settings::sd_path = sd_path;
 
+    if (parser.isSet("jit"))
+        Settings::cpu_backend = BACKEND_JIT;
+    else if (parser.isSet("cached-interpreter"))
+        Settings::cpu_backend = BACKEND_CACHED_INTERPRETER;
+    else if (parser.isSet("interpreter"))
+        Settings::cpu_backend = BACKEND_INTERPRETER;
+
+    if (parser.isSet("parallel-arm11"))
+        Settings::parallel_arm11 = true;
+
+    if (parser.isSet("fastmem"))
+        Settings::fastmem = true;
+
+    if (parser.isSet("adaptive-quantum"))
+        Settings::adaptive_quantum = true;
+
+    if (parser.isSet("gpu-threads"))
+        Settings::gpu_threads = max(1, parser.value("gpu-threads").toInt());
+
+    if (parser.isSet("shader-interpreter"))
+        Settings::shader_jit = false;
+
+    QString log_levels = parser.value("log");
+    if (!log_levels.isEmpty() && !Log::parse_levels(log_levels.toStdString().c_str()))
+        printf("Invalid log levels: %s\n", log_levels.toStdString().c_str());
+
     //The order of this is important - we need to save settings before EmuWindow is constructed.
     //Otherwise, the settings window will have the old settings in the UI.
     Settings::save();
@@ -5,6 +5,13 @@ QString Settings::boot9_path;
 QString Settings::boot11_path;
 QString Settings::nand_path;
 QString Settings::sd_path;
+int Settings::cpu_backend;
+int Settings::gpu_threads;
+
+bool Settings::parallel_arm11 = false;
+bool Settings::fastmem = false;
+bool Settings::adaptive_quantum = false;
+bool Settings::shader_jit = true;
 
 namespace Settings
 {
@@ -17,6 +24,8 @@ void load()
     boot11_path = qset.value("system/boot11", "").toString();
     nand_path = qset.value("system/nand", "").toString();
     sd_path = qset.value("system/sd", "").toString();
+    cpu_backend = qset.value("cpu/backend", 0).toInt();
+    gpu_threads = qset.value("gpu/threads", 1).toInt();
 }
 
 void save()
@@ -27,6 +36,8 @@ void save()
     qset.setValue("system/boot11", boot11_path);
     qset.setValue("system/nand", nand_path);
     qset.setValue("system/sd", sd_path);
+    qset.setValue("cpu/backend", cpu_backend);
+    qset.setValue("gpu/threads", gpu_threads);
 }
 
 }
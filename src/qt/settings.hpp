@@ -10,6 +10,14 @@ extern QString boot9_path;
 extern QString boot11_path;
 extern QString nand_path;
 extern QString sd_path;
+extern int cpu_backend;
+extern int gpu_threads;
+
+//Session settings - set from the command line for this run only, never loaded or saved
+extern bool parallel_arm11;
+extern bool fastmem;
+extern bool adaptive_quantum;
+extern bool shader_jit;
 
 void load();
 void save();
@@ -0,0 +1,1688 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <random>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "../core/emulator.hpp"
+#include "../core/scheduler.hpp"
+#include "../core/common/exceptions.hpp"
+#include "../core/common/log.hpp"
+#include "../core/cpu/arm_decode.hpp"
+#include "../core/cpu/arm_interpret.hpp"
+
+using namespace std;
+
+//Keeps the compiler from optimizing away the work being measured
+static volatile uint64_t sink;
+
+template <typename Func>
+static double time_ms(Func func)
+{
+    auto start = chrono::steady_clock::now();
+    func();
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+static void report(const char* name, double ms, uint64_t count)
+{
+    printf("  %-28s %8.2f ms %10.1f M/s\n", name, ms, count / (ms * 1000.0));
+}
+
+//decode_arm as it was before the lookup table, kept to measure against
+static ARM_INSTR decode_arm_if_chain(uint32_t instr)
+{
+    if ((instr & 0xFE5D0F00) == 0xF84D0500)
+        return ARM_SRS;
+
+    if ((instr & 0xFE500F00) == 0xF8100A00)
+        return ARM_RFE;
+
+    if (instr == 0xF57FF01F)
+        return ARM_CLREX;
+
+    if ((instr & 0x0F000000) == 0x0A000000)
+        return ARM_B;
+
+    if ((instr & 0x0F000000) == 0x0B000000)
+        return ARM_BL;
+
+    if ((instr & 0x0FFFFFFF) == 0x0320F000)
+        return ARM_NOP;
+
+    if ((instr & 0x0FFFFFFF) == 0x0320F001)
+        return ARM_YIELD;
+
+    if ((instr & 0x0FFFFFFF) == 0x0320F002)
+        return ARM_WFE;
+
+    if ((instr & 0x0FFFFFFF) == 0x0320F003)
+        return ARM_WFI;
+
+    if ((instr & 0x0FFFFFFF) == 0x0320F004)
+        return ARM_SEV;
+
+    if (((instr >> 4) & 0x0FFFFFF) == 0x12FFF1)
+        return ARM_BX;
+
+    if (((instr >> 4) & 0x0FFFFFF) == 0x12FFF3)
+        return ARM_BLX;
+
+    if ((instr & 0x0F000000) == 0x0F000000)
+        return ARM_SWI;
+
+    if (((instr >> 16) & 0xFFF) == 0x16F)
+    {
+        if (((instr >> 4) & 0xFF) == 0xF1)
+            return ARM_CLZ;
+    }
+
+    if (((instr >> 4) & 0xFF) == 0x05)
+    {
+        if (((instr >> 24) & 0xF) == 0x1)
+        {
+            int op = (instr >> 20) & 0xF;
+            if (op == 0 || op == 2 || op == 4 || op == 6)
+                return ARM_SATURATED_OP;
+        }
+    }
+
+    if ((instr & 0xFFF000F0) == 0xE1200070)
+        return ARM_BKPT;
+
+    if ((instr & 0x0E000010) == 0x06000010)
+    {
+        if ((instr & 0x0FF000F0) == 0x06A00070)
+        {
+            if ((instr & 0x0FFF00F0) == 0x06AF0070)
+                return ARM_SXTB;
+            return ARM_SXTAB;
+        }
+
+        if ((instr & 0x0FF000F0) == 0x06B00070)
+        {
+            if ((instr & 0x0FFF00F0) == 0x06BF0070)
+                return ARM_SXTH;
+            return ARM_SXTAH;
+        }
+
+        if ((instr & 0x0FF000F0) == 0x06E00070)
+        {
+            if ((instr & 0x0FFF00F0) == 0x06EF0070)
+                return ARM_UXTB;
+            return ARM_UXTAB;
+        }
+
+        if ((instr & 0x0FF000F0) == 0x06F00070)
+        {
+            if ((instr & 0x0FFF00F0) == 0x06FF0070)
+                return ARM_UXTH;
+            return ARM_UXTAH;
+        }
+
+        if ((instr & 0x0FFF0FF0) == 0x06BF0F30)
+            return ARM_REV;
+
+        if ((instr & 0x0FFF0FF0) == 0x06BF0FB0)
+            return ARM_REV16;
+
+        if ((instr & 0x0FF00070) == 0x06800010)
+            return ARM_PKHBT;
+
+        if ((instr & 0x0FF00070) == 0x06800050)
+            return ARM_PKHTB;
+
+        if ((instr & 0x0FE00030) == 0x06E00010)
+            return ARM_USAT;
+
+        if ((instr & 0x0FE00030) == 0x06A00010)
+            return ARM_SSAT;
+
+        if ((instr & 0x0FF00FF0) == 0x06800FB0)
+            return ARM_SEL;
+
+        if ((instr & 0x0FF00FF0) == 0x06500F90)
+            return ARM_UADD8;
+
+        if ((instr & 0x0FF00FF0) == 0x06700F90)
+            return ARM_UHADD8;
+
+        if ((instr & 0x0FF00FF0) == 0x06500FF0)
+            return ARM_USUB8;
+
+        if ((instr & 0x0FF00FF0) == 0x06200FF0)
+            return ARM_QSUB8;
+
+        if ((instr & 0x0FF00F00) == 0x06600F00)
+        {
+            switch (instr & 0xF0)
+            {
+                case 0x90:
+                    return ARM_UQADD8;
+                case 0xF0:
+                    return ARM_UQSUB8;
+                default:
+                    return ARM_UNDEFINED;
+            }
+        }
+
+        return ARM_UNDEFINED;
+    }
+
+    if ((instr & 0xFD70F000) == 0xF550F000)
+        return ARM_PLD;
+
+    if ((instr & 0x0FF00FFF) == 0x01D00F9F)
+        return ARM_LOAD_EX_BYTE;
+
+    if ((instr & 0x0FF00FF0) == 0x01C00F90)
+        return ARM_STORE_EX_BYTE;
+
+    if ((instr & 0x0FF00FFF) == 0x01F00F9F)
+        return ARM_LOAD_EX_HALFWORD;
+
+    if ((instr & 0x0FF00FF0) == 0x01E00F90)
+        return ARM_STORE_EX_HALFWORD;
+
+    if ((instr & 0x0FF00FFF) == 0x01900F9F)
+        return ARM_LOAD_EX_WORD;
+
+    if ((instr & 0x0FF00FF0) == 0x01800F90)
+        return ARM_STORE_EX_WORD;
+
+    if ((instr & 0x0FF00FFF) == 0x01B00F9F)
+        return ARM_LOAD_EX_DOUBLEWORD;
+
+    if ((instr & 0x0FF00FF0) == 0x01A00F90)
+        return ARM_STORE_EX_DOUBLEWORD;
+
+    if (((instr >> 26) & 0x3) == 0)
+    {
+        if ((instr & (1 << 25)) == 0)
+        {
+            if (((instr >> 4) & 0xFF) == 0x9)
+            {
+                if (((instr >> 23) & 0x1F) == 0x2 && (((instr >> 20) & 0x3) == 0))
+                    return ARM_SWAP;
+            }
+            if ((instr & (1 << 7)) != 0 && (instr & (1 << 4)) == 0)
+            {
+                if ((instr & (1 << 20)) == 0 && ((instr >> 23) & 0x3) == 0x2)
+                    return ARM_SIGNED_HALFWORD_MULTIPLY;
+            }
+            if ((instr & (1 << 7)) != 0 && (instr & (1 << 4)) != 0)
+            {
+                if (((instr >> 4) & 0xF) == 0x9)
+                {
+                    if (((instr >> 22) & 0x3F) == 0)
+                        return ARM_MULTIPLY;
+                    else if (((instr >> 23) & 0x1F) == 1)
+                        return ARM_MULTIPLY_LONG;
+                    return ARM_UNDEFINED;
+                }
+                else if ((instr & (1 << 6)) == 0 && ((instr & (1 << 5)) != 0))
+                {
+                    if ((instr & (1 << 20)) != 0)
+                        return ARM_LOAD_HALFWORD;
+                    else
+                        return ARM_STORE_HALFWORD;
+                }
+                else if ((instr & (1 << 6)) != 0 && ((instr & (1 << 5))) == 0)
+                {
+                    if ((instr & (1 << 20)) != 0)
+                        return ARM_LOAD_SIGNED_BYTE;
+                    else
+                        return ARM_LOAD_DOUBLEWORD;
+                }
+                else if ((instr & (1 << 6)) != 0 && ((instr & (1 << 5))) != 0)
+                {
+                    if ((instr & (1 << 20)) != 0)
+                        return ARM_LOAD_SIGNED_HALFWORD;
+                    else
+                        return ARM_STORE_DOUBLEWORD;
+                }
+            }
+        }
+
+        if ((instr & 0x0E000000) == 0x02000000)
+            return ARM_DATA_PROCESSING;
+
+        if ((instr & 0x0E000010) == 0x00000000 || (instr & 0x0E000090) == 0x00000010)
+            return ARM_DATA_PROCESSING;
+
+        return ARM_UNDEFINED;
+    }
+
+    if ((instr & (0x0F000000)) >> 26 == 0x1)
+    {
+        if ((instr & (1 << 20)) == 0)
+        {
+            if ((instr & (1 << 22)) == 0)
+                return ARM_STORE_WORD;
+            else
+                return ARM_STORE_BYTE;
+        }
+        else
+        {
+            if ((instr & (1 << 22)) == 0)
+                return ARM_LOAD_WORD;
+            else
+                return ARM_LOAD_BYTE;
+        }
+    }
+    if (((instr >> 25) & 0x7) == 0x4)
+    {
+        if ((instr & (1 << 20)) == 0)
+            return ARM_STORE_BLOCK;
+        else
+            return ARM_LOAD_BLOCK;
+    }
+    if ((instr & 0x0E000000) == 0x0C000000)
+    {
+        return ARM_COP_LOAD_STORE;
+    }
+    if (((instr >> 24) & 0xF) == 0xE)
+    {
+        if ((instr & (1 << 4)) != 0)
+            return ARM_COP_REG_TRANSFER;
+        else
+            return ARM_COP_DATA_OP;
+    }
+    return ARM_UNDEFINED;
+}
+
+static void bench_decode(const char*)
+{
+    const int COUNT = 1 << 20;
+    const int PASSES = 16;
+    mt19937 rng(0x3D5);
+
+    //The table only covers conditional instructions, so keep the unconditional space out of the ARM set
+    vector<uint32_t> arm_instrs(COUNT);
+    vector<uint16_t> thumb_instrs(COUNT);
+    for (int i = 0; i < COUNT; i++)
+    {
+        arm_instrs[i] = (rng() & 0x0FFFFFFF) | ((rng() % 15) << 28);
+        thumb_instrs[i] = rng() & 0xFFFF;
+    }
+
+    uint64_t total = (uint64_t)COUNT * PASSES;
+    printf("decode: %d instructions x %d passes\n", COUNT, PASSES);
+
+    report("arm if-chain", time_ms([&] {
+        uint64_t sum = 0;
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            for (uint32_t instr : arm_instrs)
+                sum += decode_arm_if_chain(instr);
+        }
+        sink = sum;
+    }), total);
+
+    report("arm linear rule scan", time_ms([&] {
+        uint64_t sum = 0;
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            for (uint32_t instr : arm_instrs)
+                sum += scan_arm_decode_rules(instr, 0);
+        }
+        sink = sum;
+    }), total);
+
+    report("arm decode_arm (table)", time_ms([&] {
+        uint64_t sum = 0;
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            for (uint32_t instr : arm_instrs)
+                sum += decode_arm(instr);
+        }
+        sink = sum;
+    }), total);
+
+    report("arm get_arm_handler", time_ms([&] {
+        uint64_t sum = 0;
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            for (uint32_t instr : arm_instrs)
+                sum += (uint64_t)ARM_Interpreter::get_arm_handler(ARM_CORE_ARM11, instr);
+        }
+        sink = sum;
+    }), total);
+
+    report("thumb if-chain", time_ms([&] {
+        uint64_t sum = 0;
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            for (uint16_t instr : thumb_instrs)
+                sum += decode_thumb_bits(instr);
+        }
+        sink = sum;
+    }), total);
+
+    report("thumb decode_thumb (table)", time_ms([&] {
+        uint64_t sum = 0;
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            for (uint16_t instr : thumb_instrs)
+                sum += decode_thumb(instr);
+        }
+        sink = sum;
+    }), total);
+
+    report("thumb get_thumb_handler", time_ms([&] {
+        uint64_t sum = 0;
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            for (uint16_t instr : thumb_instrs)
+                sum += (uint64_t)ARM_Interpreter::get_thumb_handler(ARM_CORE_ARM11, instr);
+        }
+        sink = sum;
+    }), total);
+}
+
+//Builds a minimal ELF that loads code at 0x100000 and spins forever in a loop of flag-setting ALU ops
+static vector<uint8_t> make_alu_elf(bool thumb)
+{
+    //movs r1, #0x55, then: adds, subs, eors, cmp, lsls, ands, adc(s), bne to the adds, b to the adds
+    static const uint32_t arm_code[] =
+    {
+        0xE3B01055, 0xE0900001, 0xE2522001, 0xE0333000, 0xE1530002, 0x82844001,
+        0xE1B05180, 0xE0156001, 0xE0A77000, 0x1AFFFFF6, 0xEAFFFFF5
+    };
+    static const uint16_t thumb_code[] =
+    {
+        0x2155, 0x1840, 0x3A01, 0x4043, 0x4293, 0x00C5, 0x400D, 0x4147, 0xD1F7, 0xE7F6
+    };
+    const uint32_t CODE_OFFSET = 0x54;
+    const uint32_t CODE_ADDR = 0x100000;
+
+    uint32_t code_size = (thumb) ? sizeof(thumb_code) : sizeof(arm_code);
+    vector<uint8_t> elf(CODE_OFFSET + code_size, 0);
+    *(uint32_t*)&elf[0x18] = CODE_ADDR | thumb;
+    *(uint32_t*)&elf[0x1C] = 0x34;
+    *(uint16_t*)&elf[0x2C] = 1;
+
+    //Single loadable program header
+    *(uint32_t*)&elf[0x34] = 1;
+    *(uint32_t*)&elf[0x38] = CODE_OFFSET;
+    *(uint32_t*)&elf[0x3C] = CODE_ADDR;
+    *(uint32_t*)&elf[0x40] = CODE_ADDR;
+    *(uint32_t*)&elf[0x44] = code_size;
+    *(uint32_t*)&elf[0x48] = code_size;
+
+    memcpy(&elf[CODE_OFFSET], (thumb) ? (const void*)thumb_code : (const void*)arm_code, code_size);
+    return elf;
+}
+
+struct ELFTiming
+{
+    string name;
+    double ms[3];
+};
+
+static ELFTiming time_elf(Emulator& e, const string& name, vector<uint8_t>& elf, int passes)
+{
+    static const CPU_BACKEND backends[] = {BACKEND_INTERPRETER, BACKEND_CACHED_INTERPRETER, BACKEND_JIT};
+
+    ELFTiming timing;
+    timing.name = name;
+    for (int i = 0; i < 3; i++)
+    {
+        e.set_cpu_backend(backends[i]);
+        timing.ms[i] = time_ms([&] {
+            for (int pass = 0; pass < passes; pass++)
+            {
+                try
+                {
+                    e.load_and_run_elf(elf.data(), elf.size());
+                }
+                catch (EmuException::FatalError&)
+                {
+                    //Test ELFs can end on an instruction the core doesn't support
+                }
+            }
+        }) / passes;
+    }
+    return timing;
+}
+
+//Integer-heavy ELFs on each CPU backend. Every pass is one load_and_run_elf call, which resets the emulator and
+//runs a 1M instruction slice. An extra ELF such as armwrestler can be given as the argument.
+//The ELF loader logs as it goes, so the timings are reported at the end.
+static void bench_cpu(const char* elf_path)
+{
+    const int PASSES = 8;
+    Emulator* e = new Emulator;
+    vector<ELFTiming> timings;
+
+    vector<uint8_t> arm_elf = make_alu_elf(false);
+    vector<uint8_t> thumb_elf = make_alu_elf(true);
+    timings.push_back(time_elf(*e, "arm alu loop", arm_elf, PASSES));
+    timings.push_back(time_elf(*e, "thumb alu loop", thumb_elf, PASSES));
+
+    if (elf_path)
+    {
+        ifstream file(elf_path, ios::binary | ios::ate);
+        if (file.is_open())
+        {
+            vector<uint8_t> elf(file.tellg());
+            file.seekg(0);
+            file.read((char*)elf.data(), elf.size());
+            timings.push_back(time_elf(*e, elf_path, elf, PASSES));
+        }
+        else
+            printf("cpu: failed to open %s\n", elf_path);
+    }
+    delete e;
+
+    printf("cpu: ms per pass, %d passes\n", PASSES);
+    printf("  %-28s %12s %12s %12s\n", "", "interpreter", "cached", "jit");
+    for (ELFTiming& timing : timings)
+        printf("  %-28s %12.2f %12.2f %12.2f\n", timing.name.c_str(), timing.ms[0], timing.ms[1], timing.ms[2]);
+}
+
+//Memory footprint of one Emulator after running a short ELF
+static void bench_memory(const char*)
+{
+    Emulator* e = new Emulator;
+    vector<uint8_t> elf = make_alu_elf(false);
+    try
+    {
+        e->load_and_run_elf(elf.data(), elf.size());
+    }
+    catch (EmuException::FatalError&)
+    {
+
+    }
+    e->print_memory_usage();
+    delete e;
+}
+
+//Routing of physical accesses to memory and peripherals, on pages that the CPUs and the GPU hit most often.
+//HID is near the end of the old range checks, FCRAM and ARM9 RAM are hit by every GPU and DMA transfer.
+static void bench_io(const char*)
+{
+    const int COUNT = 1 << 22;
+    Emulator* e = new Emulator;
+    vector<uint8_t> elf = make_alu_elf(false);
+    try
+    {
+        e->load_and_run_elf(elf.data(), elf.size());
+    }
+    catch (EmuException::FatalError&)
+    {
+
+    }
+
+    printf("io: %d accesses each\n", COUNT);
+    report("arm11 fcram read32", time_ms([&] {
+        uint64_t sum = 0;
+        for (int i = 0; i < COUNT; i++)
+            sum += e->arm11_read32(0, 0x20000000 + ((i * 4) & 0xFFFFF));
+        sink = sum;
+    }), COUNT);
+
+    report("arm11 fcram write16", time_ms([&] {
+        for (int i = 0; i < COUNT; i++)
+            e->arm11_write16(0, 0x20000000 + ((i * 2) & 0xFFFFF), i);
+    }), COUNT);
+
+    report("arm11 vram read32", time_ms([&] {
+        uint64_t sum = 0;
+        for (int i = 0; i < COUNT; i++)
+            sum += e->arm11_read32(0, 0x18000000 + ((i * 4) & 0xFFFFF));
+        sink = sum;
+    }), COUNT);
+
+    report("arm11 hid read16", time_ms([&] {
+        uint64_t sum = 0;
+        for (int i = 0; i < COUNT; i++)
+            sum += e->arm11_read16(0, 0x10146000);
+        sink = sum;
+    }), COUNT);
+
+    //Hopping between pages defeats the branch predictor on the old range checks
+    static const uint32_t mixed_addrs[] = {0x20001000, 0x18001000, 0x10146000, 0x10140180, 0x20100000, 0x1014110C};
+    report("arm11 mixed read32", time_ms([&] {
+        uint64_t sum = 0;
+        uint32_t state = 1;
+        for (int i = 0; i < COUNT; i++)
+        {
+            state = state * 1103515245 + 12345;
+            sum += e->arm11_read32(0, mixed_addrs[(state >> 16) % 6]);
+        }
+        sink = sum;
+    }), COUNT);
+
+    report("arm9 ram read32", time_ms([&] {
+        uint64_t sum = 0;
+        for (int i = 0; i < COUNT; i++)
+            sum += e->arm9_read32(0x08000000 + ((i * 4) & 0xFFFFF));
+        sink = sum;
+    }), COUNT);
+
+    report("arm9 hid read16", time_ms([&] {
+        uint64_t sum = 0;
+        for (int i = 0; i < COUNT; i++)
+            sum += e->arm9_read16(0x10146000);
+        sink = sum;
+    }), COUNT);
+    delete e;
+}
+
+static void bench_log(const char*)
+{
+    const int FILTERED_COUNT = 1 << 24;
+    const int COUNT = 1 << 18;
+
+    //Written messages go to a scratch file so the console doesn't drown
+    FILE* file = tmpfile();
+    if (!file)
+        return;
+
+    printf("log: %d filtered messages, %d written messages\n", FILTERED_COUNT, COUNT);
+    Log::set_level(LOG_GPU, LOG_INFO);
+    report("LOG below runtime level", time_ms([&] {
+        for (int i = 0; i < FILTERED_COUNT; i++)
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write command $%04X ($%08X)\n", i & 0x3FF, i);
+    }), FILTERED_COUNT);
+
+    report("fprintf", time_ms([&] {
+        for (int i = 0; i < COUNT; i++)
+            fprintf(file, "[GPU] Write command $%04X ($%08X)\n", i & 0x3FF, i);
+        fflush(file);
+    }), COUNT);
+
+    //Only the writer's side is timed. The flusher thread does the file IO in the background.
+    Log::set_output(file);
+    Log::set_level(LOG_GPU, LOG_TRACE);
+    report("LOG into ring", time_ms([&] {
+        for (int i = 0; i < COUNT; i++)
+            LOG(LOG_GPU, LOG_DEBUG, "[GPU] Write command $%04X ($%08X)\n", i & 0x3FF, i);
+    }), COUNT);
+
+    Log::set_output(nullptr);
+    Log::set_level(LOG_GPU, LOG_INFO);
+    fclose(file);
+}
+
+//The scheduler as it was before events were registered: a list of std::functions, scanned whenever one is due
+class ListScheduler
+{
+    private:
+        struct Event
+        {
+            int64_t time_to_run;
+            uint64_t param;
+            function<void(uint64_t)> func;
+        };
+
+        list<Event> events;
+        int64_t closest_event_time;
+    public:
+        int64_t now;
+
+        ListScheduler() : closest_event_time(0x7FFFFFFFULL << 32ULL), now(0) {}
+
+        void add_event(function<void(uint64_t)> func, int64_t cycles, uint64_t clockrate, uint64_t param)
+        {
+            Event event;
+            event.func = func;
+            event.time_to_run = now + (cycles * ((ARM11_CLOCKRATE * 3) / clockrate));
+            event.param = param;
+            closest_event_time = min(event.time_to_run, closest_event_time);
+            events.push_back(event);
+        }
+
+        void run_slice()
+        {
+            int64_t delta = min((int64_t)256, max((int64_t)0, closest_event_time - now));
+            now += delta;
+            if (now >= closest_event_time)
+            {
+                int64_t new_time = 0x7FFFFFFFULL << 32ULL;
+                for (auto it = events.begin(); it != events.end(); )
+                {
+                    if (it->time_to_run <= closest_event_time)
+                    {
+                        it->func(it->param);
+                        it = events.erase(it);
+                    }
+                    else
+                    {
+                        new_time = min(it->time_to_run, new_time);
+                        it++;
+                    }
+                }
+                closest_event_time = new_time;
+            }
+        }
+};
+
+struct EventStream
+{
+    const char* name;
+    int64_t cycles;
+    uint64_t clockrate;
+};
+
+//The kinds of events a boot keeps the scheduler busy with. Each stream re-arms itself when it fires, with some jitter.
+static const EventStream boot_streams[] =
+{
+    {"VBLANK", 4000000, ARM11_CLOCKRATE},
+    {"NDMA request", 1, ARM9_CLOCKRATE},
+    {"I2C transfer", 20000, ARM11_CLOCKRATE},
+    {"GPU command list", 3000, ARM11_CLOCKRATE},
+    {"GPU transfer engine DMA", 1000, ARM11_CLOCKRATE},
+    {"GPU memfill", 0x4000, ARM11_CLOCKRATE},
+    {"MCU interrupt", 1000000, ARM11_CLOCKRATE},
+    {"Clockrate change", 32, ARM11_CLOCKRATE}
+};
+
+//Event queue alone, driven the way Emulator::run drives it. The argument multiplies the streams, for a deeper queue.
+static void bench_scheduler(const char* arg)
+{
+    const int SLICES = 1 << 21;
+    const int STREAM_COUNT = sizeof(boot_streams) / sizeof(EventStream);
+    int copies = (arg) ? max(1, atoi(arg)) : 1;
+    int pending = STREAM_COUNT * copies;
+
+    uint32_t state = 1;
+    auto jitter = [&state](int64_t cycles)
+    {
+        state = state * 1103515245 + 12345;
+        return cycles * (1 + ((state >> 16) & 0x3));
+    };
+
+    printf("scheduler: %d slices, %d pending events\n", SLICES, pending);
+
+    uint64_t list_fired = 0;
+    ListScheduler list_sched;
+    report("list + std::function", time_ms([&] {
+        function<void(uint64_t)> fire = [&](uint64_t param)
+        {
+            const EventStream& stream = boot_streams[param % STREAM_COUNT];
+            list_fired++;
+            list_sched.add_event(fire, jitter(stream.cycles), stream.clockrate, param);
+        };
+        for (int i = 0; i < pending; i++)
+            list_sched.add_event(fire, boot_streams[i % STREAM_COUNT].cycles, boot_streams[i % STREAM_COUNT].clockrate, i);
+        for (int i = 0; i < SLICES; i++)
+            list_sched.run_slice();
+    }), SLICES);
+
+    Scheduler* sched = new Scheduler;
+    sched->reset();
+    sched->set_quantum_rate(ARM11_CLOCKRATE * 3);
+    sched->set_clockrate_9(ARM9_CLOCKRATE);
+    sched->set_clockrate_11(ARM11_CLOCKRATE);
+    sched->set_clockrate_xtensa(XTENSA_CLOCKRATE);
+
+    uint64_t heap_fired = 0;
+    int types[STREAM_COUNT];
+    for (int i = 0; i < STREAM_COUNT; i++)
+    {
+        types[i] = sched->register_event(boot_streams[i].name, [&, i](uint64_t param)
+        {
+            heap_fired++;
+            sched->add_event(types[i], jitter(boot_streams[i].cycles), boot_streams[i].clockrate, param);
+        });
+    }
+
+    state = 1;
+    report("heap + registered types", time_ms([&] {
+        for (int i = 0; i < pending; i++)
+            sched->add_event(types[i % STREAM_COUNT], boot_streams[i % STREAM_COUNT].cycles,
+                             boot_streams[i % STREAM_COUNT].clockrate, i);
+        for (int i = 0; i < SLICES; i++)
+        {
+            sched->calculate_cycles_to_run();
+            sched->process_events();
+        }
+    }), SLICES);
+
+    //A timer that's pushed back every time anything fires, like a watchdog being kicked
+    sched->reset();
+    int timeout_type = sched->register_event("Timeout", [](uint64_t) {});
+    SchedulerHandle timeout = sched->add_event(timeout_type, 100000, ARM11_CLOCKRATE);
+    int kick_type = sched->register_event("Kick", [&](uint64_t param)
+    {
+        heap_fired++;
+        sched->reschedule_event(timeout, 100000, ARM11_CLOCKRATE);
+        sched->add_event(types[param % STREAM_COUNT], jitter(boot_streams[param % STREAM_COUNT].cycles),
+                         boot_streams[param % STREAM_COUNT].clockrate, param);
+    });
+    for (int i = 0; i < STREAM_COUNT; i++)
+        types[i] = kick_type;
+
+    uint64_t heap_only_fired = heap_fired;
+    state = 1;
+    report("heap + reschedule per event", time_ms([&] {
+        for (int i = 0; i < pending; i++)
+            sched->add_event(kick_type, boot_streams[i % STREAM_COUNT].cycles, boot_streams[i % STREAM_COUNT].clockrate, i);
+        for (int i = 0; i < SLICES; i++)
+        {
+            sched->calculate_cycles_to_run();
+            sched->process_events();
+        }
+    }), SLICES);
+
+    printf("  events fired: list %llu, heap %llu, heap + reschedule %llu\n", (unsigned long long)list_fired,
+           (unsigned long long)heap_only_fired, (unsigned long long)(heap_fired - heap_only_fired));
+    delete sched;
+}
+
+//The timers as they were before they became events: every running timer is stepped after every slice
+class TickingTimers
+{
+    private:
+        struct Timer
+        {
+            uint32_t load, counter, clocks, prescalar;
+            bool countup, auto_reload, irq, enabled;
+        };
+
+        Interrupt9* int9;
+        MPCore_PMR* pmr;
+    public:
+        Timer t9[4], t11[8];
+
+        TickingTimers(Interrupt9* int9, MPCore_PMR* pmr) : int9(int9), pmr(pmr)
+        {
+            memset(t9, 0, sizeof(t9));
+            memset(t11, 0, sizeof(t11));
+        }
+
+        void overflow9(int index, uint64_t count)
+        {
+            if (t9[index].irq)
+                int9->assert_irq(8 + index);
+            if (index != 3 && t9[index + 1].countup && t9[index + 1].enabled)
+            {
+                uint64_t total = t9[index + 1].counter + count;
+                t9[index + 1].counter = total & 0xFFFF;
+                if (total >= 0x10000)
+                    overflow9(index + 1, total >> 16);
+            }
+        }
+
+        void run(int cycles11, int cycles9)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                Timer& timer = t9[i];
+                if (!timer.enabled || timer.countup)
+                    continue;
+                timer.clocks += cycles9;
+                uint64_t total = timer.counter + timer.clocks / timer.prescalar;
+                timer.clocks %= timer.prescalar;
+                timer.counter = total & 0xFFFF;
+                if (total >= 0x10000)
+                    overflow9(i, total >> 16);
+            }
+            for (int i = 0; i < 8; i++)
+            {
+                Timer& timer = t11[i];
+                if (!timer.enabled)
+                    continue;
+                timer.clocks += cycles11;
+                uint64_t ticks = timer.clocks / timer.prescalar;
+                timer.clocks %= timer.prescalar;
+                if (ticks < timer.counter)
+                {
+                    timer.counter -= ticks;
+                    continue;
+                }
+                ticks -= timer.counter;
+                timer.counter = timer.load - (ticks % timer.load);
+                if (timer.irq)
+                    pmr->set_pending_irq(i & 0x3, 29 + (i / 4));
+            }
+        }
+};
+
+//Timers set up the way a running system keeps them: a 1 ms tick on each ARM11 core, both watchdogs counting down
+//with their IRQs masked, and a cascaded ARM9 pair used as a clock. Driven in short slices like Emulator::run, up to
+//the same cycle either way, after which both must have raised the same IRQs and stopped on the same counts.
+static void bench_timers(const char*)
+{
+    const int64_t RUN_CYCLES11 = ARM11_CLOCKRATE / 2;
+    const uint32_t TICK_LOAD = ARM11_CLOCKRATE / 2 / 1000;
+
+    ARM_CPU arm9(nullptr, 9, nullptr, nullptr);
+    ARM_CPU arm11[4] =
+    {
+        ARM_CPU(nullptr, 11, nullptr, nullptr),
+        ARM_CPU(nullptr, 12, nullptr, nullptr),
+        ARM_CPU(nullptr, 13, nullptr, nullptr),
+        ARM_CPU(nullptr, 14, nullptr, nullptr)
+    };
+    Interrupt9 int9(&arm9);
+    Scheduler* sched = new Scheduler;
+    MPCore_PMR* pmr = new MPCore_PMR(arm11, nullptr);
+    pmr->reset(2);
+    Timers* timers = new Timers(&int9, pmr, nullptr, sched);
+
+    //Slices otherwise end wherever the timer events split them, so make both runs stop on exactly the same cycle
+    bool finished = false;
+    int end_event = sched->register_event("BenchEnd", [&](uint64_t) {finished = true;});
+
+    auto init_sched = [&]
+    {
+        sched->reset();
+        sched->set_quantum_rate(ARM11_CLOCKRATE * 3);
+        sched->set_clockrate_9(ARM9_CLOCKRATE);
+        sched->set_clockrate_11(ARM11_CLOCKRATE);
+        sched->set_clockrate_xtensa(XTENSA_CLOCKRATE);
+        sched->add_event(end_event, RUN_CYCLES11, ARM11_CLOCKRATE);
+        finished = false;
+    };
+
+    //The tick IRQ is acknowledged after every slice, the way the kernel would, and counted.
+    //A slice is far shorter than the tick, so no IRQ can be lost by being raised twice before that.
+    int slices = 0;
+    int irqs = 0;
+    auto run_slices = [&](function<void()> step)
+    {
+        slices = 0;
+        irqs = 0;
+        while (!finished)
+        {
+            sched->calculate_cycles_to_run();
+            step();
+            sched->process_events();
+            slices++;
+
+            for (int core = 0; core < 2; core++)
+            {
+                if (pmr->read32(core, 0x17E01280) & (1 << 29))
+                {
+                    pmr->write32(core, 0x17E01280, 1 << 29);
+                    irqs++;
+                }
+            }
+        }
+    };
+
+    printf("timers: %lld ARM11 cycles\n", (long long)RUN_CYCLES11);
+
+    init_sched();
+    TickingTimers ticking(&int9, pmr);
+    for (int i = 0; i < 2; i++)
+        ticking.t11[i] = {TICK_LOAD, TICK_LOAD, 0, 2, false, true, true, true};
+    for (int i = 4; i < 6; i++)
+        ticking.t11[i] = {0xFFFFFFFF, 0xFFFFFFFF, 0, 512, false, true, false, true};
+    ticking.t9[0] = {0, 0, 0, 1024 * 2, false, false, false, true};
+    ticking.t9[1] = {0, 0, 0, 2, true, false, false, true};
+
+    double ms = time_ms([&] {
+        run_slices([&] { ticking.run(sched->get_cycles11_to_run(), sched->get_cycles9_to_run()); });
+    });
+    report("stepped every slice", ms, slices);
+    int stepped_irqs = irqs;
+
+    init_sched();
+    timers->reset();
+    for (int i = 0; i < 2; i++)
+    {
+        timers->arm11_set_load(i, TICK_LOAD);
+        timers->arm11_set_control(i, 0x7);
+    }
+    for (int i = 4; i < 6; i++)
+    {
+        timers->arm11_set_load(i, 0xFFFFFFFF);
+        timers->arm11_set_control(i, 0xFF03);
+    }
+    timers->arm9_write16(0x10003002, 0x83);
+    timers->arm9_write16(0x10003006, 0x84);
+
+    ms = time_ms([&] {
+        run_slices([] {});
+    });
+    report("overflow events", ms, slices);
+
+    bool counters_match = true;
+    for (int i = 0; i < 2; i++)
+    {
+        counters_match &= ticking.t11[i].counter == timers->arm11_get_counter(i, 0);
+        counters_match &= ticking.t11[i + 4].counter == timers->arm11_get_counter(i + 4, 0);
+        counters_match &= ticking.t9[i].counter == timers->arm9_read16(0x10003000 + i * 4);
+    }
+
+    printf("  %d tick IRQs stepped, %d with events%s\n", stepped_irqs, irqs,
+           (stepped_irqs == irqs) ? "" : ", IRQ counts do not match!");
+    printf("  counters: %08X %08X %04X%04X%s\n", timers->arm11_get_counter(0, 0), timers->arm11_get_counter(4, 0),
+           timers->arm9_read16(0x10003004), timers->arm9_read16(0x10003000),
+           counters_match ? "" : ", stepped counters do not match!");
+    delete pmr;
+    delete timers;
+    delete sched;
+}
+
+//Encodes a float the way the GPU takes it in registers and immediate-mode vertices: 1.7.16 with an exponent bias of 63
+static uint32_t to_float24(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+    if (!(bits & 0x7FFFFFFF))
+        return (bits >> 8) & 0x800000;
+
+    uint32_t sign = (bits >> 31) << 23;
+    uint32_t exponent = ((bits >> 23) & 0xFF) - 127 + 63;
+    uint32_t mantissa = (bits >> 7) & 0xFFFF;
+    return sign | (exponent << 16) | mantissa;
+}
+
+//GPU command list with one register write per entry, in the format the command engine reads
+struct GPUCommandList
+{
+    vector<uint32_t> words;
+
+    void write(uint16_t reg, uint32_t param)
+    {
+        words.push_back(param);
+        words.push_back(reg | (0xF << 16));
+    }
+
+    //Immediate-mode attribute, packed into three words as w, z, y, x
+    void attr(float x, float y, float z, float w)
+    {
+        uint32_t fx = to_float24(x), fy = to_float24(y), fz = to_float24(z), fw = to_float24(w);
+        write(0x233, (fw << 8) | (fz >> 16));
+        write(0x233, (fz << 16) | (fy >> 8));
+        write(0x233, (fy << 24) | fx);
+    }
+
+    void upload(Emulator* e, uint32_t addr)
+    {
+        for (unsigned int i = 0; i < words.size(); i++)
+            e->arm11_write32(0, addr + (i * 4), words[i]);
+    }
+};
+
+//Passthrough vertex shader and fixed-function state for drawing gouraud-shaded triangles with a repeating 64x64 RGBA8
+//texture into a 256x256 RGBA8 framebuffer with a D24S8 depth buffer. Depth maps z from [-1, 0] onto [1, 0].
+static void setup_gpu_state(GPUCommandList& list, uint32_t color_addr, uint32_t depth_addr, uint32_t tex_addr)
+{
+    const uint32_t MOV = 0x13 << 26;
+    const uint32_t END = 0x22 << 26;
+    list.write(0x2CB, 0);
+    list.write(0x2CC, MOV | (0 << 21) | (0 << 12));
+    list.write(0x2CC, MOV | (1 << 21) | (1 << 12));
+    list.write(0x2CC, MOV | (2 << 21) | (2 << 12));
+    list.write(0x2CC, END);
+
+    //All components written, no swizzling
+    list.write(0x2D5, 0);
+    list.write(0x2D6, 0xF | (0x1B << 5));
+    list.write(0x2BA, 0);
+
+    //Three inputs going to v0-v2, coming out as position, color and texcoord 0
+    list.write(0x242, 2);
+    list.write(0x2B9, 2);
+    list.write(0x2BB, 0x210);
+    list.write(0x24A, 2);
+    list.write(0x04F, 3);
+    list.write(0x050, 0x03020100);
+    list.write(0x051, 0x0B0A0908);
+    list.write(0x052, 0x1F1F0D0C);
+
+    list.write(0x041, to_float24(128.0f));
+    list.write(0x043, to_float24(128.0f));
+    list.write(0x068, 0);
+    list.write(0x04D, to_float24(-1.0f));
+    list.write(0x04E, 0);
+    list.write(0x06D, 1);
+
+    list.write(0x080, 0x1);
+    list.write(0x082, 64 | (64 << 16));
+    list.write(0x083, (2 << 8) | (2 << 12));
+    list.write(0x085, tex_addr >> 3);
+    list.write(0x08E, 0);
+
+    //Primary color times texture 0 in the first combiner, and the rest passing it along
+    list.write(0x0C0, 0x00300030);
+    list.write(0x0C1, 0);
+    list.write(0x0C2, 0x00010001);
+    for (uint16_t reg : {0x0C8, 0x0D0, 0x0D8, 0x0F0, 0x0F8})
+        list.write(reg, 0x000F000F);
+
+    //Logic op copy, depth test LEQUAL with depth and color writes
+    list.write(0x100, 0);
+    list.write(0x102, 3);
+    list.write(0x105, 0);
+    list.write(0x107, 0x1 | (0x5 << 4) | (0xF << 8) | (1 << 12));
+    list.write(0x115, 0x3);
+
+    list.write(0x116, 3);
+    list.write(0x117, 0);
+    list.write(0x11C, depth_addr >> 3);
+    list.write(0x11D, color_addr >> 3);
+    list.write(0x11E, 256 | (255 << 12));
+
+    list.write(0x25E, 0);
+    list.write(0x25F, 1);
+}
+
+//Full-screen quads stacked front to back, so every other layer fails the depth test
+static void add_gpu_layers(GPUCommandList& list, int layers)
+{
+    list.write(0x232, 0xF);
+    for (int i = 0; i < layers; i++)
+    {
+        float z = -(float)((i * 7) % layers + 1) / (layers + 1);
+        static const float corners[6][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, -1}, {1, 1}, {-1, 1}};
+        for (int v = 0; v < 6; v++)
+        {
+            list.attr(corners[v][0], corners[v][1], z, 1.0f);
+            list.attr((v & 1) ? 1.0f : 0.25f, (v & 2) ? 1.0f : 0.5f, (float)i / layers, 1.0f);
+            list.attr(corners[v][0] + 1.0f, corners[v][1] + 1.0f, 0.0f, 0.0f);
+        }
+    }
+}
+
+static uint64_t hash_memory(Emulator* e, uint32_t addr, uint32_t size)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (uint32_t i = 0; i < size; i += 4)
+        hash = (hash ^ e->arm11_read32(0, addr + i)) * 0x100000001B3ULL;
+    return hash;
+}
+
+//Rasterizer fill rate on full-screen textured quads, into VRAM with 1 to 16 rasterizer threads and into FCRAM with one.
+//The argument sets the number of layers. The color and depth buffers are hashed to check that the threads don't
+//change what's drawn, and so rasterizer changes can be checked against each other.
+static void bench_gpu(const char* arg)
+{
+    const int PASSES = 4;
+    const uint32_t LIST_ADDR = 0x20400000;
+    const uint32_t DRAW_ADDR = 0x20500000;
+    const uint32_t TEX_ADDR = 0x18200000;
+    int layers = (arg) ? max(1, atoi(arg)) : 16;
+
+    Emulator* e = new Emulator;
+    vector<uint8_t> elf = make_alu_elf(false);
+    try
+    {
+        e->load_and_run_elf(elf.data(), elf.size());
+    }
+    catch (EmuException::FatalError&)
+    {
+
+    }
+
+    GPUCommandList draw;
+    add_gpu_layers(draw, layers);
+    draw.upload(e, DRAW_ADDR);
+
+    for (uint32_t i = 0; i < 64 * 64 * 4; i += 4)
+        e->arm11_write32(0, TEX_ADDR + i, (i * 0x9E3779B1) | 0xFF);
+
+    uint64_t pixels = 256ULL * 256 * layers * PASSES;
+    printf("gpu: %d full-screen layers x %d passes, %u hardware threads\n", layers, PASSES,
+           thread::hardware_concurrency());
+
+    struct FillTest
+    {
+        const char* name;
+        uint32_t color_addr, depth_addr;
+        int threads;
+    };
+    static const FillTest tests[] =
+    {
+        {"vram fill, 1 thread", 0x18000000, 0x18100000, 1},
+        {"vram fill, 2 threads", 0x18000000, 0x18100000, 2},
+        {"vram fill, 4 threads", 0x18000000, 0x18100000, 4},
+        {"vram fill, 8 threads", 0x18000000, 0x18100000, 8},
+        {"vram fill, 16 threads", 0x18000000, 0x18100000, 16},
+        {"fcram fill, 1 thread", 0x20800000, 0x20900000, 1}
+    };
+
+    uint64_t first_hash = 0;
+    for (const FillTest& test : tests)
+    {
+        e->set_gpu_threads(test.threads);
+
+        GPUCommandList setup;
+        setup_gpu_state(setup, test.color_addr, test.depth_addr, TEX_ADDR);
+        setup.upload(e, LIST_ADDR);
+        e->run_gpu_command_list(LIST_ADDR, setup.words.size());
+
+        double ms = 0.0;
+        for (int pass = 0; pass < PASSES; pass++)
+        {
+            //Clear depth to the far plane
+            for (uint32_t i = 0; i < 256 * 256 * 4; i += 4)
+                e->arm11_write32(0, test.depth_addr + i, 0x00FFFFFF);
+            ms += time_ms([&] {
+                e->run_gpu_command_list(DRAW_ADDR, draw.words.size());
+            });
+        }
+        report(test.name, ms, pixels);
+
+        uint64_t hash = hash_memory(e, test.color_addr, 256 * 256 * 4) ^ hash_memory(e, test.depth_addr, 256 * 256 * 4);
+        if (!first_hash)
+        {
+            first_hash = hash;
+            printf("    frame hash %016llX\n", (unsigned long long)hash);
+        }
+        else if (hash != first_hash)
+            printf("    frame hash %016llX does not match!\n", (unsigned long long)hash);
+    }
+    delete e;
+}
+
+//How the rasterizer evaluated the edge functions before scan_edge_functions: orient2D in float24 for every pixel
+static int32_t reference_edge(const EdgeFunctions& edges, int i, int32_t x, int32_t y)
+{
+    float24 x0 = float24::FromFloat32(edges.x0[i]), y0 = float24::FromFloat32(edges.y0[i]);
+    float24 x1 = float24::FromFloat32(edges.x0[i] + edges.a[i]), y1 = float24::FromFloat32(edges.y0[i] + edges.b[i]);
+    float24 px = float24::FromFloat32(x), py = float24::FromFloat32(y);
+    return roundf(((x1 - x0) * (py - y0) - (px - x0) * (y1 - y0)).ToFloat32()) + edges.bias[i];
+}
+
+struct RasterSample
+{
+    int32_t x, y, w[3];
+
+    bool operator!=(const RasterSample& other) const
+    {
+        return memcmp(this, &other, sizeof(RasterSample)) != 0;
+    }
+};
+
+//Edge function evaluation on random triangles from a few pixels to several times the screen across, split into
+//32x32 bins the way the rasterizer does. Checks that scan_edge_functions covers exactly the same pixels with exactly
+//the same w as the old per-pixel float path, including triangles too large for the integer path.
+static void bench_raster(const char*)
+{
+    const int TRIS = 2000;
+    const int32_t FRAME_SIZE = 512 << 4;
+    const int32_t BIN = 32 << 4;
+    mt19937 rng(0x3D5);
+
+    vector<EdgeFunctions> tris;
+    vector<int32_t> boxes;
+    int exact_tris = 0;
+    while ((int)tris.size() < TRIS)
+    {
+        static const int scales[] = {16, 64, 256, 1024};
+        int32_t scale = scales[tris.size() % 4] << 4;
+        int32_t center_x = rng() % FRAME_SIZE, center_y = rng() % FRAME_SIZE;
+        int32_t x[3], y[3];
+        int bias[3];
+        for (int i = 0; i < 3; i++)
+        {
+            x[i] = center_x + (int32_t)(rng() % (scale * 2)) - scale;
+            y[i] = center_y + (int32_t)(rng() % (scale * 2)) - scale;
+            bias[i] = -(int)(rng() & 1);
+        }
+
+        int32_t min_x = max((min({x[0], x[1], x[2]}) & ~0xF) + 8, 8);
+        int32_t min_y = max((min({y[0], y[1], y[2]}) & ~0xF) + 8, 8);
+        int32_t max_x = min((max({x[0], x[1], x[2]}) + 0xF) & ~0xF, FRAME_SIZE);
+        int32_t max_y = min((max({y[0], y[1], y[2]}) + 0xF) & ~0xF, FRAME_SIZE);
+        if (min_x >= max_x || min_y >= max_y)
+            continue;
+
+        EdgeFunctions edges;
+        setup_edge_functions(edges, x, y, bias, min_x, min_y, max_x, max_y);
+        exact_tris += edges.exact;
+        tris.push_back(edges);
+        boxes.insert(boxes.end(), {min_x, min_y, max_x, max_y});
+    }
+
+    auto for_each_bin = [&](function<void(const EdgeFunctions&, int32_t, int32_t, int32_t, int32_t)> func)
+    {
+        for (unsigned int t = 0; t < tris.size(); t++)
+        {
+            const int32_t* box = &boxes[t * 4];
+            for (int32_t bin_y = (box[1] / BIN) * BIN; bin_y < box[3]; bin_y += BIN)
+            {
+                for (int32_t bin_x = (box[0] / BIN) * BIN; bin_x < box[2]; bin_x += BIN)
+                {
+                    func(tris[t], max(box[0], bin_x + 8), max(box[1], bin_y + 8),
+                         min(box[2], bin_x + BIN), min(box[3], bin_y + BIN));
+                }
+            }
+        }
+    };
+
+    printf("raster: %d triangles, %d on the integer path, %d lanes\n", TRIS, exact_tris, RasterLanes::COUNT);
+
+    vector<RasterSample> expected, covered;
+    uint64_t pixels = 0;
+    double ms = time_ms([&] {
+        for_each_bin([&](const EdgeFunctions& edges, int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y)
+        {
+            for (int32_t y = min_y; y < max_y; y += 0x10)
+            {
+                for (int32_t x = min_x; x < max_x; x += 0x10)
+                {
+                    RasterSample sample = {x, y, {}};
+                    for (int i = 0; i < 3; i++)
+                        sample.w[i] = reference_edge(edges, i, x, y);
+                    if ((sample.w[0] | sample.w[1] | sample.w[2]) >= 0)
+                        expected.push_back(sample);
+                    pixels++;
+                }
+            }
+        });
+    });
+    report("float24 per pixel", ms, pixels);
+
+    ms = time_ms([&] {
+        for_each_bin([&](const EdgeFunctions& edges, int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y)
+        {
+            scan_edge_functions(edges, min_x, min_y, max_x, max_y, [&](int32_t x, int32_t y,
+                                int32_t w1, int32_t w2, int32_t w3) {covered.push_back({x, y, {w1, w2, w3}});});
+        });
+    });
+    report("scan_edge_functions", ms, pixels);
+
+    size_t mismatches = (expected.size() > covered.size()) ? expected.size() - covered.size() :
+                                                             covered.size() - expected.size();
+    for (size_t i = 0; i < min(expected.size(), covered.size()); i++)
+        mismatches += expected[i] != covered[i];
+    printf("  %llu of %llu pixels covered, %llu mismatches\n", (unsigned long long)expected.size(),
+           (unsigned long long)pixels, (unsigned long long)mismatches);
+}
+
+//Vertex shader blending eight 4x4 matrices picked by the loop counter, as skinning does, then lighting the color with
+//rsq and max. Takes the same inputs and gives the same outputs as the shader from setup_gpu_state.
+static void setup_skinning_shader(GPUCommandList& list)
+{
+    auto alu = [](uint32_t op, uint32_t dest, uint32_t src1, uint32_t src2, uint32_t idx, uint32_t desc)
+    {
+        return (op << 26) | (dest << 21) | (idx << 19) | (src1 << 12) | (src2 << 7) | desc;
+    };
+    const uint32_t DP3 = 0x01, DP4 = 0x02, MUL = 0x08, MAX = 0x0C, RSQ = 0x0F, MOV = 0x13;
+    const uint32_t program[] =
+    {
+        alu(MOV, 0x10, 0x00, 0, 0, 0),
+        alu(MOV, 0x12, 0x28, 0, 0, 0),
+        (0x29u << 26) | (7 << 10),
+        alu(DP4, 0x11, 0x30, 0x10, 3, 1),
+        alu(DP4, 0x11, 0x31, 0x10, 3, 2),
+        alu(DP4, 0x11, 0x32, 0x10, 3, 3),
+        alu(DP4, 0x11, 0x33, 0x10, 3, 4),
+        (0x7u << 29) | (0x12 << 24) | (0x11 << 17) | (0x29 << 10) | (0x12 << 5),
+        alu(MOV, 0x00, 0x12, 0, 0, 0),
+        alu(DP3, 0x13, 0x02, 0x02, 0, 0),
+        alu(RSQ, 0x13, 0x13, 0, 0, 0),
+        alu(MUL, 0x14, 0x01, 0x13, 0, 0),
+        alu(MAX, 0x14, 0x2A, 0x14, 0, 0),
+        alu(MOV, 0x01, 0x14, 0, 0, 0),
+        alu(MOV, 0x02, 0x02, 0, 0, 0),
+        0x22u << 26
+    };
+    list.write(0x2CB, 0);
+    for (uint32_t instr : program)
+        list.write(0x2CC, instr);
+
+    //No swizzling, writing all of xyzw, then x, y, z, and w alone
+    const uint32_t NO_SWIZZLE = (0x1B << 5) | (0x1B << 14) | (0x1B << 23);
+    list.write(0x2D5, 0);
+    for (uint32_t mask : {0xF, 0x8, 0x4, 0x2, 0x1})
+        list.write(0x2D6, NO_SWIZZLE | mask);
+
+    //Eight iterations with the counter going up by 4, over the matrices in c16-c47
+    list.write(0x2B1, 7 | (0 << 8) | (4 << 16));
+    auto uniform = [&](int index, float x, float y, float z, float w)
+    {
+        list.write(0x2C0, index | (1u << 31));
+        for (float value : {w, z, y, x})
+        {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            list.write(0x2C1, bits);
+        }
+    };
+    uniform(8, 0.0f, 0.0f, 0.0f, 0.0f);
+    uniform(9, 0.125f, 0.125f, 0.125f, 0.125f);
+    uniform(10, 0.0f, 0.0f, 0.0f, 0.0f);
+    for (int bone = 0; bone < 8; bone++)
+    {
+        float shift = (bone - 3.5f) / 256.0f;
+        uniform(16 + bone * 4, 1.0f, 0.0f, 0.0f, shift);
+        uniform(17 + bone * 4, 0.0f, 1.0f, 0.0f, -shift);
+        uniform(18 + bone * 4, 0.0f, 0.0f, 1.0f, 0.0f);
+        uniform(19 + bone * 4, 0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+//The skinning shader run over small triangles with the shader interpreter and with the shader JIT, and the two frames
+//are compared. The argument sets the number of triangles.
+static void bench_shader(const char* arg)
+{
+    const uint32_t LIST_ADDR = 0x20400000;
+    const uint32_t DRAW_ADDR = 0x20500000;
+    const uint32_t TEX_ADDR = 0x18200000;
+    const uint32_t COLOR_ADDR = 0x18000000;
+    const uint32_t DEPTH_ADDR = 0x18100000;
+    int tris = (arg) ? max(1, atoi(arg)) : 20000;
+
+    Emulator* e = new Emulator;
+    vector<uint8_t> elf = make_alu_elf(false);
+    try
+    {
+        e->load_and_run_elf(elf.data(), elf.size());
+    }
+    catch (EmuException::FatalError&)
+    {
+
+    }
+
+    GPUCommandList setup;
+    setup_gpu_state(setup, COLOR_ADDR, DEPTH_ADDR, TEX_ADDR);
+    setup_skinning_shader(setup);
+    setup.upload(e, LIST_ADDR);
+
+    //Triangles a few pixels across, so the shader is what's being timed
+    GPUCommandList draw;
+    draw.write(0x232, 0xF);
+    mt19937 rng(0x5AD);
+    for (int i = 0; i < tris; i++)
+    {
+        float x = (int)(rng() % 1800) / 1000.0f - 0.9f;
+        float y = (int)(rng() % 1800) / 1000.0f - 0.9f;
+        float z = -(int)(rng() % 1000) / 1000.0f;
+        static const float corners[3][2] = {{0, 0}, {0.03f, 0}, {0, 0.03f}};
+        for (int v = 0; v < 3; v++)
+        {
+            draw.attr(x + corners[v][0], y + corners[v][1], z, 1.0f);
+            draw.attr((rng() % 256) / 255.0f, (rng() % 256) / 255.0f, (rng() % 256) / 255.0f, 1.0f);
+            draw.attr(0.5f + (rng() % 8) / 16.0f, 0.5f, 0.0f, 0.0f);
+        }
+    }
+    draw.upload(e, DRAW_ADDR);
+
+    for (uint32_t i = 0; i < 64 * 64 * 4; i += 4)
+        e->arm11_write32(0, TEX_ADDR + i, (i * 0x9E3779B1) | 0xFF);
+
+    printf("shader: %d triangles, %d instructions per vertex\n", tris, 3 + 8 * 5 + 7);
+
+    uint64_t hashes[2];
+    for (int jit = 0; jit < 2; jit++)
+    {
+        e->set_shader_jit(jit);
+        e->run_gpu_command_list(LIST_ADDR, setup.words.size());
+        for (uint32_t i = 0; i < 256 * 256 * 4; i += 4)
+        {
+            e->arm11_write32(0, COLOR_ADDR + i, 0);
+            e->arm11_write32(0, DEPTH_ADDR + i, 0x00FFFFFF);
+        }
+
+        double ms = time_ms([&] {
+            e->run_gpu_command_list(DRAW_ADDR, draw.words.size());
+        });
+        report((jit) ? "shader JIT" : "shader interpreter", ms, tris * 3ULL);
+        hashes[jit] = hash_memory(e, COLOR_ADDR, 256 * 256 * 4) ^ hash_memory(e, DEPTH_ADDR, 256 * 256 * 4);
+    }
+    printf("    frame hash %016llX%s\n", (unsigned long long)hashes[0],
+           (hashes[0] == hashes[1]) ? "" : ", JIT frame does not match!");
+    delete e;
+}
+
+//A grid mesh drawn through the skinning shader as an indexed triangle list, which shares most vertices between
+//triangles, and again as an array with every triangle's vertices written out. The frames are compared, and the
+//vertex cache's hits are counted on the indexed draw. The argument sets the number of quads across the grid.
+static void bench_mesh(const char* arg)
+{
+    const uint32_t LIST_ADDR = 0x20400000;
+    const uint32_t DRAW_ADDR = 0x20500000;
+    const uint32_t VTX_ADDR = 0x20600000;
+    const uint32_t TEX_ADDR = 0x18200000;
+    const uint32_t COLOR_ADDR = 0x18000000;
+    const uint32_t DEPTH_ADDR = 0x18100000;
+    int quads = (arg) ? min(max(1, atoi(arg)), 254) : 64;
+    int stride = quads + 1;
+
+    Emulator* e = new Emulator;
+    vector<uint8_t> elf = make_alu_elf(false);
+    try
+    {
+        e->load_and_run_elf(elf.data(), elf.size());
+    }
+    catch (EmuException::FatalError&)
+    {
+
+    }
+
+    GPUCommandList setup;
+    setup_gpu_state(setup, COLOR_ADDR, DEPTH_ADDR, TEX_ADDR);
+    setup_skinning_shader(setup);
+    setup.upload(e, LIST_ADDR);
+
+    //Position, color, and texcoord as floats in one buffer
+    const int VTX_FLOATS = 10;
+    mt19937 rng(0x3E5);
+    vector<float> grid;
+    for (int y = 0; y < stride; y++)
+    {
+        for (int x = 0; x < stride; x++)
+        {
+            float z = -(int)(rng() % 1000) / 1000.0f;
+            float vtx[VTX_FLOATS] =
+            {
+                x * 1.8f / quads - 0.9f, y * 1.8f / quads - 0.9f, z, 1.0f,
+                (rng() % 256) / 255.0f, (rng() % 256) / 255.0f, (rng() % 256) / 255.0f, 1.0f,
+                (float)x / quads, (float)y / quads
+            };
+            grid.insert(grid.end(), vtx, vtx + VTX_FLOATS);
+        }
+    }
+
+    vector<uint16_t> indices;
+    for (int y = 0; y < quads; y++)
+    {
+        for (int x = 0; x < quads; x++)
+        {
+            int corner = y * stride + x;
+            for (int offset : {0, 1, stride, 1, stride + 1, stride})
+                indices.push_back(corner + offset);
+        }
+    }
+
+    vector<float> unrolled;
+    for (uint16_t index : indices)
+        unrolled.insert(unrolled.end(), &grid[index * VTX_FLOATS], &grid[(index + 1) * VTX_FLOATS]);
+
+    uint32_t index_offs = grid.size() * sizeof(float);
+    uint32_t unrolled_offs = (index_offs + indices.size() * sizeof(uint16_t) + 0xF) & ~0xF;
+    auto upload = [&](uint32_t offs, const void* data, size_t size)
+    {
+        for (size_t i = 0; i < size; i += 4)
+        {
+            uint32_t word;
+            memcpy(&word, (const uint8_t*)data + i, sizeof(word));
+            e->arm11_write32(0, VTX_ADDR + offs + i, word);
+        }
+    };
+    upload(0, grid.data(), grid.size() * sizeof(float));
+    upload(index_offs, indices.data(), (indices.size() * sizeof(uint16_t) + 3) & ~3);
+    upload(unrolled_offs, unrolled.data(), unrolled.size() * sizeof(float));
+
+    for (uint32_t i = 0; i < 64 * 64 * 4; i += 4)
+        e->arm11_write32(0, TEX_ADDR + i, (i * 0x9E3779B1) | 0xFF);
+
+    printf("mesh: %dx%d quads, %d vertices, %d indices\n", quads, quads, stride * stride, (int)indices.size());
+
+    uint64_t hashes[2];
+    for (int indexed = 0; indexed < 2; indexed++)
+    {
+        //Three float attributes of four, four, and two components, all from buffer 0
+        GPUCommandList draw;
+        draw.write(0x200, VTX_ADDR >> 3);
+        draw.write(0x201, 0xF | (0xF << 4) | (0x7 << 8));
+        draw.write(0x202, 2 << 28);
+        draw.write(0x203, (indexed) ? 0 : unrolled_offs);
+        draw.write(0x204, 0x210);
+        draw.write(0x205, ((VTX_FLOATS * sizeof(float)) << 16) | (3 << 28));
+        draw.write(0x227, index_offs | (1u << 31));
+        draw.write(0x228, indices.size());
+        draw.write(0x22A, 0);
+        draw.write((indexed) ? 0x22F : 0x22E, 1);
+        draw.upload(e, DRAW_ADDR);
+
+        e->run_gpu_command_list(LIST_ADDR, setup.words.size());
+        for (uint32_t i = 0; i < 256 * 256 * 4; i += 4)
+        {
+            e->arm11_write32(0, COLOR_ADDR + i, 0);
+            e->arm11_write32(0, DEPTH_ADDR + i, 0x00FFFFFF);
+        }
+
+        double ms = time_ms([&] {
+            e->run_gpu_command_list(DRAW_ADDR, draw.words.size());
+        });
+        report((indexed) ? "indexed, vertex cache" : "unrolled vertices", ms, indices.size());
+        hashes[indexed] = hash_memory(e, COLOR_ADDR, 256 * 256 * 4) ^ hash_memory(e, DEPTH_ADDR, 256 * 256 * 4);
+    }
+
+    VertexCacheStats stats = e->get_vtx_cache_stats();
+    printf("    vertex cache: %u hits, %u misses (%.1f%%)\n", stats.hits, stats.misses,
+           100.0 * stats.hits / (stats.hits + stats.misses));
+    printf("    frame hash %016llX%s\n", (unsigned long long)hashes[0],
+           (hashes[0] == hashes[1]) ? "" : ", indexed frame does not match!");
+    delete e;
+}
+
+//Full-screen textured quads sampling a 64x64 texture in several formats. Each format's texture is then rewritten from
+//the CPU between command lists and drawn again, and then put back, to check that the frame follows what's in memory.
+//The argument sets the number of layers.
+static void bench_texture(const char* arg)
+{
+    const int PASSES = 4;
+    const uint32_t LIST_ADDR = 0x20400000;
+    const uint32_t DRAW_ADDR = 0x20500000;
+    const uint32_t TEX_ADDR = 0x18200000;
+    const uint32_t COLOR_ADDR = 0x18000000;
+    const uint32_t DEPTH_ADDR = 0x18100000;
+    int layers = (arg) ? max(1, atoi(arg)) : 16;
+
+    Emulator* e = new Emulator;
+    vector<uint8_t> elf = make_alu_elf(false);
+    try
+    {
+        e->load_and_run_elf(elf.data(), elf.size());
+    }
+    catch (EmuException::FatalError&)
+    {
+
+    }
+
+    GPUCommandList draw;
+    add_gpu_layers(draw, layers);
+    draw.upload(e, DRAW_ADDR);
+    e->set_gpu_threads(1);
+
+    uint64_t pixels = 256ULL * 256 * layers * PASSES;
+    printf("texture: %d full-screen layers x %d passes\n", layers, PASSES);
+
+    struct TextureTest
+    {
+        const char* name;
+        uint8_t format;
+        uint32_t bits;
+    };
+    static const TextureTest tests[] =
+    {
+        {"rgba8", 0x0, 32},
+        {"rgb565", 0x3, 16},
+        {"ia8", 0x7, 8},
+        {"etc1", 0xC, 4},
+        {"etc1a4", 0xD, 8}
+    };
+
+    auto fill_texture = [&](uint32_t bytes, uint32_t seed) {
+        for (uint32_t i = 0; i < bytes; i += 4)
+            e->arm11_write32(0, TEX_ADDR + i, (i + seed) * 0x9E3779B1);
+    };
+    auto draw_frame = [&] {
+        for (uint32_t i = 0; i < 256 * 256 * 4; i += 4)
+            e->arm11_write32(0, DEPTH_ADDR + i, 0x00FFFFFF);
+        return time_ms([&] {
+            e->run_gpu_command_list(DRAW_ADDR, draw.words.size());
+        });
+    };
+    auto frame_hash = [&] {
+        return hash_memory(e, COLOR_ADDR, 256 * 256 * 4);
+    };
+
+    for (const TextureTest& test : tests)
+    {
+        uint32_t bytes = (64 * 64 * test.bits) / 8;
+        fill_texture(bytes, 0);
+
+        GPUCommandList setup;
+        setup_gpu_state(setup, COLOR_ADDR, DEPTH_ADDR, TEX_ADDR);
+        setup.write(0x08E, test.format);
+        setup.upload(e, LIST_ADDR);
+        e->run_gpu_command_list(LIST_ADDR, setup.words.size());
+
+        double ms = 0.0;
+        for (int pass = 0; pass < PASSES; pass++)
+            ms += draw_frame();
+        report(test.name, ms, pixels);
+        uint64_t first_hash = frame_hash();
+
+        fill_texture(bytes, 1);
+        draw_frame();
+        uint64_t rewritten_hash = frame_hash();
+
+        fill_texture(bytes, 0);
+        draw_frame();
+        if (rewritten_hash == first_hash || frame_hash() != first_hash)
+            printf("    frame does not follow the texture in memory!\n");
+    }
+    delete e;
+}
+
+struct Benchmark
+{
+    const char* name;
+    void (*func)(const char* arg);
+};
+
+static const Benchmark benchmarks[] =
+{
+    {"decode", bench_decode},
+    {"cpu", bench_cpu},
+    {"memory", bench_memory},
+    {"io", bench_io},
+    {"log", bench_log},
+    {"scheduler", bench_scheduler},
+    {"timers", bench_timers},
+    {"gpu", bench_gpu},
+    {"raster", bench_raster},
+    {"shader", bench_shader},
+    {"mesh", bench_mesh},
+    {"texture", bench_texture}
+};
+
+int run_benchmarks(const string& name, const char* arg)
+{
+    bool found = false;
+    for (const Benchmark& bench : benchmarks)
+    {
+        if (name.empty() || name == bench.name)
+        {
+            bench.func(arg);
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        printf("Unknown benchmark %s\n", name.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+#include <string>
+
+//Microbenchmarks for hot paths in the core. An empty name runs all of them.
+//arg is an optional benchmark-specific argument, such as the ELF for "cpu".
+int run_benchmarks(const std::string& name, const char* arg);
+
+#endif // BENCH_HPP
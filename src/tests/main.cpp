@@ -1,6 +1,7 @@
 #include <fstream>
 #include "../core/emulator.hpp"
 #include "../core/common/exceptions.hpp"
+#include "bench.hpp"
 
 using namespace std;
 
@@ -15,6 +16,17 @@ int main(int argc, char** argv)
     if (argc < 2)
         return 1;
 
+    //"--bench [name] [arg]" runs the microbenchmarks instead of an ELF
+    if (string(argv[1]) == "--bench")
+        return run_benchmarks((argc >= 3) ? argv[2] : "", (argc >= 4) ? argv[3] : nullptr);
+
+    //Optional second argument selects the CPU backend, so all of them can be checked against the same test
+    CPU_BACKEND backend = BACKEND_INTERPRETER;
+    if (argc >= 3 && string(argv[2]) == "jit")
+        backend = BACKEND_JIT;
+    else if (argc >= 3 && string(argv[2]) == "cached")
+        backend = BACKEND_CACHED_INTERPRETER;
+
     ifstream test_elf_file(argv[1]);
     if (!test_elf_file.is_open())
         return 1;
@@ -28,6 +40,7 @@ int main(int argc, char** argv)
     test_elf_file.close();
 
     Emulator e;
+    e.set_cpu_backend(backend);
 
     e.load_and_run_elf(mem, size);
 
@@ -2,7 +2,7 @@ QT += core gui multimedia
 greaterThan(QT_MAJOR_VERSION, 4) : QT += widgets
 
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++14
 CONFIG -= app_bundle
 
 QMAKE_CFLAGS_RELEASE -= -O
@@ -11,11 +11,17 @@ QMAKE_CFLAGS_RELEASE *= -O2
 QMAKE_CFLAGS_RELEASE -= -O3
 
 SOURCES += main.cpp \
+    bench.cpp \
     ../core/emulator.cpp \
     ../core/cpu/arm.cpp \
     ../core/cpu/arm_interpret.cpp \
     ../core/cpu/arm_disasm.cpp \
+    ../core/cpu/arm_cached_interpret.cpp \
+    ../core/cpu/arm_code_cache.cpp \
+    ../core/cpu/arm_jit.cpp \
+    ../core/cpu/arm_thread_pool.cpp \
     ../core/cpu/cp15.cpp \
+    ../core/cpu/fastmem.cpp \
     ../core/cpu/thumb_disasm.cpp \
     ../core/cpu/thumb_interpret.cpp \
     ../core/arm9/rsa.cpp \
@@ -24,6 +30,8 @@ SOURCES += main.cpp \
     ../core/pxi.cpp \
     ../core/arm11/mpcore_pmr.cpp \
     ../core/arm11/gpu.cpp \
+    ../core/arm11/gpu_thread_pool.cpp \
+    ../core/arm11/shader_jit.cpp \
     ../core/arm9/aes.cpp \
     ../core/arm9/sha.cpp \
     ../core/common/bswp.cpp \
@@ -32,26 +40,41 @@ SOURCES += main.cpp \
     ../core/arm9/emmc.cpp \
     ../core/arm9/interrupt9.cpp \
     ../core/i2c.cpp \
+    ../core/io_table.cpp \
     ../core/common/exceptions.cpp \
+    ../core/common/log.cpp \
     ../core/cpu/mmu.cpp \
+    ../core/cpu/page_map.cpp \
     ../core/scheduler.cpp \
     ../core/cpu/vfp.cpp \
     ../core/cpu/vfp_disasm.cpp \
-    ../core/cpu/vfp_interpreter.cpp
+    ../core/cpu/vfp_interpreter.cpp \
+    ../core/cpu/x64_emitter.cpp
 
 HEADERS += \
+    bench.hpp \
     ../core/emulator.hpp \
     ../core/cpu/arm.hpp \
+    ../core/cpu/arm_decode.hpp \
     ../core/cpu/arm_disasm.hpp \
     ../core/cpu/arm_interpret.hpp \
+    ../core/cpu/arm_cached_interpret.hpp \
+    ../core/cpu/arm_code_cache.hpp \
+    ../core/cpu/arm_jit.hpp \
+    ../core/cpu/arm_thread_pool.hpp \
     ../core/common/rotr.hpp \
     ../core/cpu/cp15.hpp \
+    ../core/cpu/fastmem.hpp \
     ../core/arm9/rsa.hpp \
     ../core/timers.hpp \
     ../core/arm9/dma9.hpp \
     ../core/pxi.hpp \
     ../core/arm11/mpcore_pmr.hpp \
     ../core/arm11/gpu.hpp \
+    ../core/arm11/gpu_raster.hpp \
+    ../core/arm11/gpu_simd.hpp \
+    ../core/arm11/gpu_thread_pool.hpp \
+    ../core/arm11/shader_jit.hpp \
     ../core/arm9/aes.hpp \
     ../core/arm9/sha.hpp \
     ../core/common/bswp.hpp \
@@ -60,12 +83,16 @@ HEADERS += \
     ../core/arm9/emmc.hpp \
     ../core/arm9/interrupt9.hpp \
     ../core/i2c.hpp \
+    ../core/io_table.hpp \
     ../core/common/common.hpp \
     ../core/common/exceptions.hpp \
+    ../core/common/log.hpp \
     ../core/cpu/mmu.hpp \
+    ../core/cpu/page_map.hpp \
     ../core/scheduler.hpp \
-    ../core/cpu/vfp.hpp
+    ../core/cpu/vfp.hpp \
+    ../core/cpu/x64_emitter.hpp
 
 INCLUDEPATH += /usr/local/include
 
-LIBS += -L/usr/local/lib -lgmpxx -lgmp
+LIBS += -L/usr/local/lib -lgmpxx -lgmp -lpthread